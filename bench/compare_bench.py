@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+# This file is part of LatNet Builder.
+#
+# Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+"""Comparison of the microbenchmarks with a recorded baseline.
+
+`record` runs the microbenchmarks with repetitions and stores their results,
+with the fingerprint of the machine written by microbench, as the baseline:
+
+    bench/compare_bench.py record -o baseline.json -- -m 16 20 -s 5 -n 16
+
+`compare` runs them again with the same arguments, or reads the results of a
+previous run given by --current, and compares each benchmark with the
+baseline. A benchmark is slower when the one-sided Mann-Whitney U test of its
+repetitions rejects, at the level --alpha, that its times are not larger than
+those of the baseline, and when the ratio of the medians exceeds
+1 + --threshold. The comparisons are summarized by kernel (RankComputer,
+GaussMethod, CoordUniformInnerProdFast for the fast-CBC products,
+ConcreteCoordUniformState for the state updates, ...), that is, by the first
+component of the names of the benchmarks, and the exit status is 1 if a
+benchmark is slower.
+
+The test needs several repetitions on both sides (--repetitions, 10 by
+default); the times of different machines are not comparable, so a baseline
+recorded on another machine is reported, and rejected with
+--strict-fingerprint.
+"""
+
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+
+from search_bench import REPO_DIR
+
+# keys of the context of microbench that identify the machine and the build
+FINGERPRINT = ['host_name', 'cpu_model', 'num_cpus', 'compiler', 'library_version']
+
+
+def run_microbench(executable, repetitions, args):
+    """Runs microbench with repetitions and returns its JSON report."""
+    command = [executable, '--repetitions', str(repetitions)] + list(args)
+    proc = subprocess.run(command, stdout=subprocess.PIPE, universal_newlines=True)
+    if proc.returncode != 0:
+        raise RuntimeError('{} failed with status {}'.format(' '.join(command), proc.returncode))
+    report = json.loads(proc.stdout)
+    report['context']['arguments'] = list(args)
+    return report
+
+
+def samples(report):
+    """Returns the times in nanoseconds of the repetitions of each benchmark."""
+    out = {}
+    for b in report['benchmarks']:
+        if b.get('run_type', 'iteration') != 'iteration':
+            continue
+        out.setdefault(b['name'], []).append(b['real_time'])
+    return out
+
+
+def mann_whitney_greater(x, y):
+    """Returns the p-value of the one-sided Mann-Whitney U test that the
+    values of y tend to be larger than those of x.
+
+    The exact distribution of U is used when there are no ties and both
+    samples have at most 20 values, and the normal approximation with the tie
+    correction otherwise.
+    """
+    n1, n2 = len(x), len(y)
+    values = sorted([(v, 0) for v in x] + [(v, 1) for v in y])
+    # mid-ranks of the tied values
+    ranks = [0.0] * len(values)
+    ties = []
+    i = 0
+    while i < len(values):
+        j = i
+        while j + 1 < len(values) and values[j + 1][0] == values[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1
+        ties.append(j - i + 1)
+        i = j + 1
+    rank_sum = sum(r for r, (_, side) in zip(ranks, values) if side == 1)
+    u = rank_sum - n2 * (n2 + 1) / 2.0 # number of pairs with y > x
+
+    if max(ties) == 1 and n1 <= 20 and n2 <= 20:
+        # counts[k] = number of arrangements with U = k, by recurrence on
+        # the largest value, which comes from x or from y
+        table = {(0, 0): [1]}
+        def counts(a, b):
+            if (a, b) not in table:
+                c = [0] * (a * b + 1)
+                if a > 0:
+                    for k, v in enumerate(counts(a - 1, b)):
+                        c[k] += v
+                if b > 0:
+                    for k, v in enumerate(counts(a, b - 1)):
+                        c[k + a] += v
+                table[(a, b)] = c
+            return table[(a, b)]
+        dist = counts(n1, n2)
+        return sum(dist[int(round(u)):]) / float(sum(dist))
+
+    n = n1 + n2
+    mean = n1 * n2 / 2.0
+    variance = n1 * n2 / 12.0 * ((n + 1) - sum(t ** 3 - t for t in ties) / float(n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = (u - 0.5 - mean) / math.sqrt(variance) # continuity correction
+    return 0.5 * math.erfc(z / math.sqrt(2))
+
+
+def median(values):
+    s = sorted(values)
+    m = len(s) // 2
+    return s[m] if len(s) % 2 else (s[m - 1] + s[m]) / 2.0
+
+
+def compare(baseline, current, alpha, threshold):
+    """Returns the comparison of each benchmark present in both reports."""
+    base = samples(baseline)
+    cur = samples(current)
+    rows = []
+    for name in cur:
+        if name not in base:
+            continue
+        x, y = base[name], cur[name]
+        ratio = median(y) / median(x) if median(x) > 0 else float('inf')
+        row = {'name': name,
+               'kernel': name.split('/')[0],
+               'baseline_ns': median(x),
+               'current_ns': median(y),
+               'ratio': ratio,
+               'baseline_repetitions': len(x),
+               'current_repetitions': len(y)}
+        if len(x) < 2 or len(y) < 2:
+            row['status'] = 'too few repetitions'
+        else:
+            row['p_slower'] = mann_whitney_greater(x, y)
+            row['p_faster'] = mann_whitney_greater(y, x)
+            if row['p_slower'] < alpha and ratio > 1 + threshold:
+                row['status'] = 'SLOWER'
+            elif row['p_faster'] < alpha and ratio < 1 / (1 + threshold):
+                row['status'] = 'faster'
+            else:
+                row['status'] = 'same'
+        rows.append(row)
+    return rows
+
+
+def kernel_summary(rows):
+    """Returns, for each kernel, the geometric mean of the ratios and the
+    number of slower and faster benchmarks."""
+    kernels = {}
+    for row in rows:
+        k = kernels.setdefault(row['kernel'], {'kernel': row['kernel'], 'benchmarks': 0, 'slower': 0, 'faster': 0, 'log_ratio': 0.0})
+        k['benchmarks'] += 1
+        k['slower'] += row['status'] == 'SLOWER'
+        k['faster'] += row['status'] == 'faster'
+        k['log_ratio'] += math.log(row['ratio']) if 0 < row['ratio'] < float('inf') else 0.0
+    out = []
+    for k in kernels.values():
+        k['geomean_ratio'] = math.exp(k.pop('log_ratio') / k['benchmarks'])
+        out.append(k)
+    return sorted(out, key=lambda k: k['kernel'])
+
+
+def fingerprint_differences(baseline, current):
+    """Returns the keys of the fingerprint that differ between two reports."""
+    a, b = baseline.get('context', {}), current.get('context', {})
+    return [key for key in FINGERPRINT if a.get(key) != b.get(key)]
+
+
+def write_table(out, rows, kernels):
+    width = max([len(r['name']) for r in rows] + [9])
+    out.write('{:<{w}}  {:>12}  {:>12}  {:>7}  {:>9}  {}\n'.format('benchmark', 'baseline ns', 'current ns', 'ratio', 'p-value', 'status', w=width))
+    for r in rows:
+        p = '{:.2g}'.format(r['p_slower']) if 'p_slower' in r else '-'
+        out.write('{:<{w}}  {:>12.1f}  {:>12.1f}  {:>7.3f}  {:>9}  {}\n'.format(
+            r['name'], r['baseline_ns'], r['current_ns'], r['ratio'], p, r['status'], w=width))
+    out.write('\n')
+    width = max([len(k['kernel']) for k in kernels] + [6])
+    out.write('{:<{w}}  {:>10}  {:>6}  {:>6}  {:>7}\n'.format('kernel', 'benchmarks', 'slower', 'faster', 'geomean', w=width))
+    for k in kernels:
+        out.write('{:<{w}}  {:>10}  {:>6}  {:>6}  {:>7.3f}\n'.format(
+            k['kernel'], k['benchmarks'], k['slower'], k['faster'], k['geomean_ratio'], w=width))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0],
+                                     epilog='The arguments after -- are passed to microbench.')
+    parser.add_argument('command', choices=['record', 'compare'],
+                        help='record a baseline, or compare with a baseline')
+    parser.add_argument('--microbench', default=os.path.join(REPO_DIR, 'build', 'bench', 'microbench'),
+                        help='path of the microbench executable')
+    parser.add_argument('--repetitions', type=int, default=10,
+                        help='number of measurements of each benchmark (default: 10)')
+    parser.add_argument('--baseline', default=os.path.join(REPO_DIR, 'latnetbuilder_results', 'microbench_baseline.json'),
+                        help='JSON file of the baseline')
+    parser.add_argument('--current', default='',
+                        help='compare the results of this JSON file of microbench instead of running it')
+    parser.add_argument('--alpha', type=float, default=0.01,
+                        help='level of the statistical tests (default: 0.01)')
+    parser.add_argument('--threshold', type=float, default=0.05,
+                        help='smallest relative change of the median reported (default: 0.05)')
+    parser.add_argument('--strict-fingerprint', action='store_true',
+                        help='fail if the baseline was recorded on another machine or build')
+    parser.add_argument('--output', '-o', default='',
+                        help='JSON output file: the baseline for record, the comparison for compare')
+    argv = sys.argv[1:]
+    microbench_args = []
+    if '--' in argv:
+        microbench_args = argv[argv.index('--') + 1:]
+        argv = argv[:argv.index('--')]
+    args = parser.parse_args(argv)
+
+    if args.repetitions < 1:
+        parser.error('--repetitions must be positive')
+
+    if args.command == 'record':
+        report = run_microbench(args.microbench, args.repetitions, microbench_args)
+        output = args.output or args.baseline
+        with open(output, 'w') as f:
+            json.dump(report, f, indent=2)
+        sys.stderr.write('Baseline written to: {}\n'.format(output))
+        return 0
+
+    if not os.path.exists(args.baseline):
+        parser.error('no baseline {}: record it first'.format(args.baseline))
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+    if args.current:
+        with open(args.current) as f:
+            current = json.load(f)
+    else:
+        # same benchmarks as the baseline, unless others are given
+        arguments = microbench_args or baseline.get('context', {}).get('arguments', [])
+        current = run_microbench(args.microbench, args.repetitions, arguments)
+
+    differences = fingerprint_differences(baseline, current)
+    for key in differences:
+        sys.stderr.write('WARNING: {} differs from the baseline: {} instead of {}\n'.format(
+            key, current.get('context', {}).get(key), baseline.get('context', {}).get(key)))
+    if differences and args.strict_fingerprint:
+        sys.stderr.write('ERROR: the baseline was recorded on another machine or build\n')
+        return 2
+
+    rows = compare(baseline, current, args.alpha, args.threshold)
+    if not rows:
+        sys.stderr.write('ERROR: no benchmark in common with the baseline\n')
+        return 2
+    kernels = kernel_summary(rows)
+    write_table(sys.stdout, rows, kernels)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump({'baseline': baseline.get('context', {}),
+                       'current': current.get('context', {}),
+                       'fingerprint_differences': differences,
+                       'alpha': args.alpha,
+                       'threshold': args.threshold,
+                       'benchmarks': rows,
+                       'kernels': kernels}, f, indent=2)
+
+    return 1 if any(r['status'] == 'SLOWER' for r in rows) else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,476 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/*
+ * Microbenchmarks of the hot kernels of LatNet Builder.
+ *
+ * Each benchmark is run for every combination of the requested values of its
+ * parameters (m: number of rows and columns of the generating matrices,
+ * s: dimension, n: number of points of the lattices) and repeated until it
+ * has run for at least the minimum time, as many times as the requested
+ * number of repetitions. The results are written in the JSON format of Google
+ * Benchmark, one entry by repetition, with a fingerprint of the machine in
+ * the context, so that they can be compared with its tools or with
+ * bench/compare_bench.py.
+ */
+
+#include "netbuilder/Types.h"
+#include "netbuilder/GeneratingMatrix.h"
+#include "netbuilder/DigitalNet.h"
+#include "netbuilder/Helpers/RankComputer.h"
+#include "netbuilder/FigureOfMerit/TValueComputation.h"
+#include "netbuilder/FigureOfMerit/TValue.h"
+
+#include "latbuilder/Types.h"
+#include "latbuilder/Storage.h"
+#include "latbuilder/SizeParam.h"
+#include "latbuilder/Kernel/PAlpha.h"
+#include "latbuilder/GenSeq/CyclicGroup.h"
+#include "latbuilder/GenSeq/Creator.h"
+#include "latbuilder/MeritSeq/CoordUniformInnerProdFast.h"
+#include "latbuilder/MeritSeq/ConcreteCoordUniformState.h"
+
+#include "latticetester/ProductWeights.h"
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#ifndef LATNETBUILDER_VERSION
+#define LATNETBUILDER_VERSION "(unkown version)"
+#endif
+
+namespace {
+
+using NetBuilder::GeneratingMatrix;
+
+/*
+ * Value of a parameter of a benchmark.
+ */
+struct Param {
+   std::string name;
+   unsigned long value;
+};
+
+/*
+ * Result of a benchmark for a combination of parameters.
+ */
+struct Result {
+   std::string name;
+   std::vector<Param> params;
+   unsigned int repetition;
+   unsigned long long iterations;
+   double realTime; // nanoseconds per iteration
+   double cpuTime;  // nanoseconds per iteration
+};
+
+/*
+ * Prevents the compiler from discarding the computation of a value.
+ */
+volatile unsigned long long g_sink = 0;
+
+template <typename T>
+void keep(const T& value)
+{ g_sink = g_sink + (unsigned long long) value; }
+
+/*
+ * Runs \c body until at least \c minTime seconds have elapsed, doubling the
+ * number of iterations of each batch.
+ */
+Result measure(std::string name, std::vector<Param> params, unsigned int repetition, double minTime, const std::function<void()>& body)
+{
+   typedef std::chrono::steady_clock Clock;
+
+   if (repetition == 0)
+      body(); // warm-up
+
+   unsigned long long iterations = 0;
+   unsigned long long batch = 1;
+   double realTime = 0;
+   std::clock_t cpuStart = std::clock();
+   while (realTime < minTime) {
+      const auto start = Clock::now();
+      for (unsigned long long i = 0; i < batch; i++)
+         body();
+      realTime += std::chrono::duration<double>(Clock::now() - start).count();
+      iterations += batch;
+      batch *= 2;
+   }
+   const double cpuTime = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+   return Result{std::move(name), std::move(params), repetition, iterations, 1e9 * realTime / iterations, 1e9 * cpuTime / iterations};
+}
+
+/*
+ * Returns \c count square matrices of size \c m with independent uniform
+ * random bits, drawn from \c rng.
+ */
+std::vector<GeneratingMatrix> randomMatrices(unsigned int count, unsigned int m, std::mt19937_64& rng)
+{
+   std::vector<GeneratingMatrix> mats;
+   mats.reserve(count);
+   for (unsigned int k = 0; k < count; k++) {
+      GeneratingMatrix mat(m, m);
+      for (unsigned int i = 0; i < m; i++)
+         for (unsigned int j = 0; j < m; j++)
+            mat(i, j) = (rng() & 1) != 0;
+      mats.push_back(std::move(mat));
+   }
+   return mats;
+}
+
+/*
+ * Options of the benchmarks.
+ */
+struct Config {
+   std::vector<unsigned int> m;
+   std::vector<unsigned int> s;
+   std::vector<unsigned int> n; // base 2 logarithm of the number of points
+   std::string filter;
+   double minTime;
+   unsigned int repetitions;
+};
+
+class Suite {
+public:
+   explicit Suite(Config config):
+      m_config(std::move(config))
+   {}
+
+   const std::vector<Result>& results() const
+   { return m_results; }
+
+   unsigned int repetitions() const
+   { return m_config.repetitions; }
+
+   void run()
+   {
+      for (auto m : m_config.m) {
+         for (auto s : m_config.s) {
+            rankComputerAddRow(m, s);
+            rankComputerReplaceRow(m, s);
+            tValue<NetBuilder::GaussMethod>("GaussMethod/computeTValue", m, s);
+            tValue<NetBuilder::SchmidMethod>("SchmidMethod/computeTValue", m, s);
+            tValueFigure(m, s);
+         }
+      }
+      for (auto n : m_config.n) {
+         storageStride(n);
+         for (auto s : m_config.s)
+            coordUniformStateUpdate(n, s);
+         coordUniformInnerProdFast(n);
+      }
+   }
+
+private:
+   Config m_config;
+   std::vector<Result> m_results;
+
+   bool selected(const std::string& name) const
+   { return m_config.filter.empty() || name.find(m_config.filter) != std::string::npos; }
+
+   void add(std::string name, std::vector<Param> params, const std::function<void()>& body)
+   {
+      if (!selected(name))
+         return;
+      // the repetitions of a benchmark follow each other, with the same state
+      for (unsigned int k = 0; k < m_config.repetitions; k++) {
+         m_results.push_back(measure(name, params, k, m_config.minTime, body));
+         const auto& r = m_results.back();
+         std::cerr << r.name;
+         for (const auto& p : r.params)
+            std::cerr << "/" << p.name << ":" << p.value;
+         std::cerr << "  " << r.realTime << " ns" << std::endl;
+      }
+   }
+
+   /*
+    * Reduces an m-column matrix whose rows are taken in turn from s matrices,
+    * as done for the projections in the t-value computations.
+    */
+   void rankComputerAddRow(unsigned int m, unsigned int s)
+   {
+      std::mt19937_64 rng(m * 1000 + s);
+      auto mats = randomMatrices(s, m, rng);
+      NetBuilder::RankComputer computer(m);
+      add("RankComputer/addRow", {{"m", m}, {"s", s}}, [&]() {
+         computer.reset(m);
+         for (unsigned int i = 0; i < m; i++)
+            computer.addRow(mats[i % s], i / s);
+         keep(computer.computeRank());
+      });
+   }
+
+   /*
+    * Replaces in turn the rows of a reduced m-row matrix by rows of s other
+    * matrices, as done when enumerating the compositions of the Gauss method.
+    */
+   void rankComputerReplaceRow(unsigned int m, unsigned int s)
+   {
+      std::mt19937_64 rng(m * 1000 + s + 1);
+      auto mats = randomMatrices(s + 1, m, rng);
+      NetBuilder::RankComputer computer(m);
+      for (unsigned int i = 0; i < m; i++)
+         computer.addRow(mats[s], i);
+      unsigned long long step = 0;
+      add("RankComputer/replaceRow", {{"m", m}, {"s", s}}, [&]() {
+         const unsigned int row = (unsigned int) (step % m);
+         computer.replaceRow(row, mats[step % s], row);
+         keep(computer.computeRank());
+         ++step;
+      });
+   }
+
+   /*
+    * Computes the t-value of the projection given by s random m x m matrices.
+    */
+   template <typename METHOD>
+   void tValue(const std::string& name, unsigned int m, unsigned int s)
+   {
+      std::mt19937_64 rng(m * 1000 + s + 2);
+      const auto mats = randomMatrices(s, m, rng);
+      add(name, {{"m", m}, {"s", s}}, [&]() {
+         keep(METHOD::computeTValue(mats, 0, 0));
+      });
+   }
+
+   /*
+    * Evaluates the t-value figure of merit of an s-dimensional net with
+    * random m x m generating matrices.
+    */
+   void tValueFigure(unsigned int m, unsigned int s)
+   {
+      using namespace NetBuilder;
+      std::mt19937_64 rng(m * 1000 + s + 3);
+      DigitalNet<NetConstruction::EXPLICIT> net(s, {m, m}, randomMatrices(s, m, rng));
+      FigureOfMerit::TValue<EmbeddingType::UNILEVEL> figure;
+      auto evaluator = figure.evaluator();
+      add("TValue/evaluate", {{"m", m}, {"s", s}}, [&]() {
+         keep((*evaluator)(net));
+      });
+   }
+
+   typedef LatBuilder::Storage<LatBuilder::LatticeType::ORDINARY, LatBuilder::EmbeddingType::UNILEVEL, LatBuilder::Compress::SYMMETRIC> Storage;
+
+   /*
+    * Permutes the kernel values of a lattice with 2^n points with a stride.
+    */
+   void storageStride(unsigned int n)
+   {
+      Storage storage(LatBuilder::uInteger(1) << n);
+      const auto values = LatBuilder::Kernel::valuesVector(LatBuilder::Kernel::PAlpha(2), storage);
+      LatBuilder::uInteger stride = 1;
+      add("Storage/Stride", {{"n", n}}, [&]() {
+         stride = (stride + 2) % storage.sizeParam().numPoints(); // odd strides are coprime with 2^n
+         LatBuilder::RealVector permuted(storage.strided(values, stride));
+         keep(permuted.size());
+      });
+   }
+
+   /*
+    * Updates the product-weights state of a lattice with 2^n points, reset
+    * after s coordinates.
+    */
+   void coordUniformStateUpdate(unsigned int n, unsigned int s)
+   {
+      using namespace LatBuilder;
+      Storage storage(uInteger(1) << n);
+      LatticeTester::ProductWeights weights(0.7);
+      MeritSeq::ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::SYMMETRIC, PerLevelOrder::BASIC, LatticeTester::ProductWeights> state(storage, weights);
+      const auto values = Kernel::valuesVector(Kernel::PAlpha(2), storage);
+      const RealVector permuted(storage.strided(values, 3));
+      add("ConcreteCoordUniformState/update", {{"n", n}, {"s", s}}, [&]() {
+         if (state.dimension() == s)
+            state.reset();
+         state.update(permuted, 3);
+         keep(state.dimension());
+      });
+   }
+
+   /*
+    * Computes the inner products of a state vector with all the stride
+    * permutations of the kernel values of a lattice with 2^n points.
+    */
+   void coordUniformInnerProdFast(unsigned int n)
+   {
+      using namespace LatBuilder;
+      Storage storage(uInteger(1) << n);
+      const Kernel::PAlpha kernel(2);
+      MeritSeq::CoordUniformInnerProdFast<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::SYMMETRIC, PerLevelOrder::BASIC> innerProd(storage, kernel);
+      auto genSeq = GenSeq::Creator<GenSeq::CyclicGroup<LatticeType::ORDINARY, Compress::SYMMETRIC>>::create(storage.sizeParam());
+
+      LatticeTester::ProductWeights weights(0.7);
+      MeritSeq::ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::SYMMETRIC, PerLevelOrder::BASIC, LatticeTester::ProductWeights> state(storage, weights);
+      state.update(Kernel::valuesVector(kernel, storage), 1);
+      const RealVector vec = state.weightedState();
+
+      add("CoordUniformInnerProdFast/computeProdValues", {{"n", n}}, [&]() {
+         auto seq = innerProd.prodSeq(genSeq, vec); // computes the products
+         keep(seq.size());
+      });
+   }
+};
+
+std::string jsonString(const std::string& s)
+{
+   std::string out = "\"";
+   for (char c : s) {
+      if (c == '"' || c == '\\')
+         out += '\\';
+      out += c;
+   }
+   return out + "\"";
+}
+
+/*
+ * Returns the value of the first line of /proc/cpuinfo whose key is \c key,
+ * or an empty string.
+ */
+std::string cpuInfo(const std::string& key)
+{
+   std::ifstream file("/proc/cpuinfo");
+   std::string line;
+   while (std::getline(file, line)) {
+      const auto colon = line.find(':');
+      if (colon == std::string::npos || line.compare(0, key.size(), key) != 0)
+         continue;
+      const auto start = line.find_first_not_of(" \t", colon + 1);
+      return start == std::string::npos ? "" : line.substr(start);
+   }
+   return "";
+}
+
+std::string hostName()
+{
+   char name[256] = "";
+   if (gethostname(name, sizeof(name) - 1) != 0)
+      return "";
+   return name;
+}
+
+void writeJson(std::ostream& os, const std::vector<Result>& results, unsigned int repetitions)
+{
+   const std::time_t now = std::time(nullptr);
+   char date[32];
+   std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+   os << "{" << std::endl;
+   os << "  \"context\": {" << std::endl;
+   os << "    \"date\": " << jsonString(date) << "," << std::endl;
+   os << "    \"library_version\": " << jsonString(LATNETBUILDER_VERSION) << "," << std::endl;
+   os << "    \"host_name\": " << jsonString(hostName()) << "," << std::endl;
+   os << "    \"cpu_model\": " << jsonString(cpuInfo("model name")) << "," << std::endl;
+   os << "    \"compiler\": " << jsonString(__VERSION__) << "," << std::endl;
+   os << "    \"num_cpus\": " << std::thread::hardware_concurrency() << std::endl;
+   os << "  }," << std::endl;
+   os << "  \"benchmarks\": [" << std::endl;
+   for (size_t i = 0; i < results.size(); i++) {
+      const auto& r = results[i];
+      std::string name = r.name;
+      for (const auto& p : r.params)
+         name += "/" + p.name + ":" + std::to_string(p.value);
+      os << "    {" << std::endl;
+      os << "      \"name\": " << jsonString(name) << "," << std::endl;
+      os << "      \"run_name\": " << jsonString(name) << "," << std::endl;
+      os << "      \"run_type\": \"iteration\"," << std::endl;
+      os << "      \"repetitions\": " << repetitions << "," << std::endl;
+      os << "      \"repetition_index\": " << r.repetition << "," << std::endl;
+      for (const auto& p : r.params)
+         os << "      " << jsonString(p.name) << ": " << p.value << "," << std::endl;
+      os << "      \"iterations\": " << r.iterations << "," << std::endl;
+      os << "      \"real_time\": " << r.realTime << "," << std::endl;
+      os << "      \"cpu_time\": " << r.cpuTime << "," << std::endl;
+      os << "      \"time_unit\": \"ns\"" << std::endl;
+      os << "    }" << (i + 1 < results.size() ? "," : "") << std::endl;
+   }
+   os << "  ]" << std::endl;
+   os << "}" << std::endl;
+}
+
+}
+
+int main(int argc, const char* argv[])
+{
+   namespace po = boost::program_options;
+
+   Config config;
+   std::string output;
+
+   po::options_description desc("allowed options");
+   desc.add_options()
+      ("help,h", "produce help message")
+      ("matrix-size,m", po::value<std::vector<unsigned int>>(&config.m)->multitoken()->default_value({10, 16, 20}, "10 16 20"),
+       "numbers of rows and columns of the generating matrices")
+      ("dimension,s", po::value<std::vector<unsigned int>>(&config.s)->multitoken()->default_value({3, 5}, "3 5"),
+       "dimensions")
+      ("log-points,n", po::value<std::vector<unsigned int>>(&config.n)->multitoken()->default_value({10, 14, 18}, "10 14 18"),
+       "base 2 logarithms of the numbers of points of the lattices")
+      ("filter,f", po::value<std::string>(&config.filter)->default_value(""),
+       "only run the benchmarks whose name contains this string")
+      ("min-time", po::value<double>(&config.minTime)->default_value(0.5),
+       "minimum running time of each benchmark, in seconds")
+      ("repetitions,r", po::value<unsigned int>(&config.repetitions)->default_value(1),
+       "number of measurements of each benchmark")
+      ("output,o", po::value<std::string>(&output)->default_value(""),
+       "JSON output file (standard output if empty)");
+
+   po::variables_map opt;
+   try {
+      po::store(po::parse_command_line(argc, argv, desc), opt);
+      po::notify(opt);
+   }
+   catch (po::error& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+   }
+
+   if (opt.count("help")) {
+      std::cout << desc << std::endl;
+      return 0;
+   }
+
+   if (config.repetitions == 0) {
+      std::cerr << "ERROR: --repetitions must be positive" << std::endl;
+      return 1;
+   }
+
+   Suite suite(config);
+   suite.run();
+
+   if (output.empty()) {
+      writeJson(std::cout, suite.results(), suite.repetitions());
+   }
+   else {
+      std::ofstream file(output);
+      if (!file) {
+         std::cerr << "ERROR: cannot write to " << output << std::endl;
+         return 1;
+      }
+      writeJson(file, suite.results(), suite.repetitions());
+   }
+   return 0;
+}
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# This file is part of LatNet Builder.
+#
+# Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Scaling benchmarks of the searches across thread counts and problem sizes.
+
+Runs each configuration of latnetbuilder_results/scaling_benchmarks.json for
+every combination of its sizes and dimensions, with each number of threads,
+and reports as CSV the time, the point sets explored per second and per
+thread, the speedup and the parallel efficiency with respect to the smallest
+number of threads, and the peak resident set size.
+
+With --perf, latnetbuilder is run under `perf stat` and the memory traffic is
+estimated from the last-level cache misses, one cache line each; this is a
+lower bound of the bandwidth used, since prefetched lines are not counted.
+"""
+
+import argparse
+import csv
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+from search_bench import REPO_DIR, run_configuration
+
+CACHE_LINE_BYTES = 64
+
+COLUMNS = ['name', 'size', 'dimension', 'threads', 'seconds', 'explored', 'explored_per_second',
+           'explored_per_second_per_thread', 'speedup', 'efficiency', 'peak_rss_kib', 'llc_misses',
+           'bandwidth_gb_per_second']
+
+
+def default_thread_counts():
+    """Returns the powers of two up to the number of processors, and the number of processors."""
+    num_cpus = os.cpu_count() or 1
+    counts = []
+    p = 1
+    while p < num_cpus:
+        counts.append(p)
+        p *= 2
+    counts.append(num_cpus)
+    return counts
+
+
+def instantiate(config, size, dimension, threads):
+    """Returns the configuration with the placeholders of its arguments replaced."""
+    args = [a.replace('{size}', str(size)).replace('{dimension}', str(dimension)) for a in config['args']]
+    return {'name': config['name'], 'args': args + ['--threads', str(threads)]}
+
+
+def run_with_perf(executable, config):
+    """Runs a configuration under perf stat and adds the last-level cache misses to its measurements."""
+    with tempfile.NamedTemporaryFile(mode='r', suffix='.csv') as counters:
+        prefix = ['perf', 'stat', '-x', ',', '-e', 'LLC-load-misses,LLC-store-misses', '-o', counters.name, '--']
+        result = run_configuration(executable, config, prefix)
+        misses = 0
+        for line in counters:
+            fields = line.strip().split(',')
+            if len(fields) > 2 and fields[0].isdigit():
+                misses += int(fields[0])
+    result['llc_misses'] = misses
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--latnetbuilder', default=os.path.join(REPO_DIR, 'build', 'bin', 'latnetbuilder'),
+                        help='path of the latnetbuilder executable')
+    parser.add_argument('--configurations', default=os.path.join(REPO_DIR, 'latnetbuilder_results', 'scaling_benchmarks.json'),
+                        help='JSON file of the scaling configurations')
+    parser.add_argument('--filter', default='',
+                        help='only run the configurations whose name contains this string')
+    parser.add_argument('--threads', type=int, nargs='+', default=default_thread_counts(),
+                        help='numbers of threads (default: powers of two up to the number of processors)')
+    parser.add_argument('--sizes', nargs='+', default=None,
+                        help='sizes replacing those of the configurations')
+    parser.add_argument('--dimensions', type=int, nargs='+', default=None,
+                        help='dimensions replacing those of the configurations')
+    parser.add_argument('--repetitions', type=int, default=1,
+                        help='number of runs of each combination; the fastest run is reported')
+    parser.add_argument('--perf', action='store_true',
+                        help='estimate the memory bandwidth from the cache misses counted by perf stat')
+    parser.add_argument('--output', default='',
+                        help='CSV output file (standard output if empty)')
+    args = parser.parse_args()
+
+    with open(args.configurations) as f:
+        configurations = json.load(f)['configurations']
+    thread_counts = sorted(set(args.threads))
+
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+    writer = csv.DictWriter(out, fieldnames=COLUMNS)
+    writer.writeheader()
+
+    for config in configurations:
+        if args.filter not in config['name']:
+            continue
+        for size in args.sizes or config['sizes']:
+            for dimension in args.dimensions or config['dimensions']:
+                reference = None
+                for threads in thread_counts:
+                    instance = instantiate(config, size, dimension, threads)
+                    runs = []
+                    for _ in range(max(args.repetitions, 1)):
+                        runs.append(run_with_perf(args.latnetbuilder, instance) if args.perf
+                                    else run_configuration(args.latnetbuilder, instance))
+                    best = min(runs, key=lambda r: r['seconds'])
+                    if reference is None:
+                        reference = (threads, best['seconds'])
+                    # speedup with respect to the smallest number of threads, assumed to scale perfectly
+                    speedup = reference[0] * reference[1] / best['seconds'] if best['seconds'] > 0 else 0.0
+                    row = {'name': config['name'], 'size': size, 'dimension': dimension, 'threads': threads,
+                           'seconds': '{:.6f}'.format(best['seconds']),
+                           'explored': best['explored'],
+                           'explored_per_second': '{:.3f}'.format(best['explored_per_second']),
+                           'explored_per_second_per_thread': '{:.3f}'.format(best['explored_per_second'] / threads),
+                           'speedup': '{:.3f}'.format(speedup),
+                           'efficiency': '{:.3f}'.format(speedup / threads),
+                           'peak_rss_kib': best['peak_rss_kib'],
+                           'llc_misses': best.get('llc_misses', ''),
+                           'bandwidth_gb_per_second': '{:.3f}'.format(best['llc_misses'] * CACHE_LINE_BYTES / best['seconds'] / 1e9)
+                                                      if 'llc_misses' in best and best['seconds'] > 0 else ''}
+                    writer.writerow(row)
+                    out.flush()
+                    sys.stderr.write('{} {} s={} threads={}: {:.3f} s, speedup {:.2f}\n'.format(
+                        config['name'], size, dimension, threads, best['seconds'], speedup))
+
+    if args.output:
+        out.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+# This file is part of LatNet Builder.
+#
+# Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""End-to-end search benchmarks.
+
+Runs the reference configurations of latnetbuilder_results/benchmarks.json
+with the latnetbuilder executable and reports, for each of them, the number
+of point sets explored per second, the time spent on each coordinate and the
+peak resident set size of the process, as JSON.
+
+The coordinates are timed from the "End coordinate" lines printed by
+latnetbuilder with --verbose 1, so the time of the first coordinate includes
+the start-up of the process (loading of the data tables and of the kernel
+values).
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+END_COORDINATE = re.compile(r'End coordinate: (\d+)/(\d+) - (\d+) (?:nets?|lattices?) explored')
+
+
+def run_configuration(executable, config, prefix=()):
+    """Runs a configuration once and returns its measurements.
+
+    The command line is preceded by the arguments of prefix, for instance to
+    run latnetbuilder under a profiler.
+    """
+    args = list(prefix) + [executable] + config['args'] + ['--verbose', '1']
+    start = time.monotonic()
+    proc = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+
+    coordinates = []
+    tail = [] # last lines of the output, reported on failure
+    last = start
+    for line in proc.stdout:
+        tail = (tail + [line])[-20:]
+        match = END_COORDINATE.search(line)
+        if match:
+            now = time.monotonic()
+            coordinates.append({'coordinate': int(match.group(1)),
+                                'explored': int(match.group(3)),
+                                'seconds': now - last})
+            last = now
+
+    # wait4 gives the resource usage of this child only
+    _, status, usage = os.wait4(proc.pid, 0)
+    elapsed = time.monotonic() - start
+    proc.returncode = os.waitstatus_to_exitcode(status) if hasattr(os, 'waitstatus_to_exitcode') else (status >> 8)
+    if proc.returncode != 0:
+        raise RuntimeError('{} failed with status {}:\n{}'.format(config['name'], proc.returncode, ''.join(tail)))
+
+    explored = sum(c['explored'] for c in coordinates)
+    return {'seconds': elapsed,
+            'explored': explored,
+            'explored_per_second': explored / elapsed if elapsed > 0 else 0.0,
+            'peak_rss_kib': usage.ru_maxrss if sys.platform != 'darwin' else usage.ru_maxrss // 1024,
+            'coordinates': coordinates}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--latnetbuilder', default=os.path.join(REPO_DIR, 'build', 'bin', 'latnetbuilder'),
+                        help='path of the latnetbuilder executable')
+    parser.add_argument('--configurations', default=os.path.join(REPO_DIR, 'latnetbuilder_results', 'benchmarks.json'),
+                        help='JSON file of the reference configurations')
+    parser.add_argument('--filter', default='',
+                        help='only run the configurations whose name contains this string')
+    parser.add_argument('--repetitions', type=int, default=1,
+                        help='number of runs of each configuration; the fastest run is reported')
+    parser.add_argument('--output', default='',
+                        help='JSON output file (standard output if empty)')
+    args = parser.parse_args()
+
+    with open(args.configurations) as f:
+        configurations = json.load(f)['configurations']
+
+    results = []
+    for config in configurations:
+        if args.filter not in config['name']:
+            continue
+        runs = [run_configuration(args.latnetbuilder, config) for _ in range(max(args.repetitions, 1))]
+        best = min(runs, key=lambda r: r['seconds'])
+        best['name'] = config['name']
+        best['args'] = config['args']
+        best['repetitions'] = len(runs)
+        results.append(best)
+        sys.stderr.write('{}: {:.3f} s, {:.1f} explored/s, {} KiB\n'.format(
+            config['name'], best['seconds'], best['explored_per_second'], best['peak_rss_kib']))
+
+    report = {'context': {'date': time.strftime('%Y-%m-%dT%H:%M:%S'),
+                          'executable': args.latnetbuilder,
+                          'num_cpus': os.cpu_count()},
+              'benchmarks': results}
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+    else:
+        json.dump(report, sys.stdout, indent=2)
+        sys.stdout.write('\n')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,143 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks the device point layouts of LatBuilder::Device and NetBuilder::Device
+// against the host point generators, for a small shifted lattice and a small
+// Sobol' net.  Returns a nonzero status if any coordinate differs.
+
+#include "latbuilder/DevicePoints.h"
+#include "latbuilder/LFSR258.h"
+#include "netbuilder/DevicePoints.h"
+#include "netbuilder/DigitalNet.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace LatBuilder;
+
+/**
+ * Counts the coordinates of \c expected and \c actual which differ, and
+ * reports them under the name \c what.
+ */
+template <typename T>
+unsigned int compare(const std::string& what, const std::vector<T>& expected, const std::vector<T>& actual)
+{
+   unsigned int errors = 0;
+   for (size_t i = 0; i < expected.size(); i++) {
+      if (expected[i] != actual[i]) {
+         if (errors == 0)
+            std::cerr << what << ": value " << i << " is " << actual[i] << " instead of " << expected[i] << std::endl;
+         errors++;
+      }
+   }
+   std::cout << what << ": " << (errors ? "FAILED" : "OK") << std::endl;
+   return errors;
+}
+
+/**
+ * Generates the first \c count points of \c layout with the block function
+ * \c generateBlock, one block of \c blockSize points after the other.
+ */
+template <typename T, class LAYOUT, class GENERATE>
+std::vector<T> generateByBlocks(const LAYOUT& layout, uint64_t count, uint64_t blockSize, GENERATE generateBlock)
+{
+   std::vector<T> points(count * layout.dimension);
+   for (uint64_t first = 0; first < count; first += blockSize)
+      generateBlock(layout, first, std::min(blockSize, count - first), points.data() + first * layout.dimension);
+   return points;
+}
+
+unsigned int checkLattice()
+{
+   LFSR258 rng;
+   const LatticePointGenerator generator(101, {1, 27, 40}, Device::randomShift(3, rng));
+   const auto layout = Device::hostLayout(generator);
+   const uint64_t n = generator.numPoints();
+
+   std::vector<double> expected(n * generator.dimension());
+   generator.generate(0, n, expected.data());
+   std::vector<uint32_t> expected32(n * generator.dimension());
+   generator.generate(0, n, expected32.data());
+
+   std::vector<double> byIndex(n * layout.dimension);
+   for (uint64_t i = 0; i < n; i++)
+      for (uint32_t j = 0; j < layout.dimension; j++)
+         byIndex[i * layout.dimension + j] = Device::latticeCoordinate(layout, i, j);
+
+   unsigned int errors = 0;
+   errors += compare("lattice, by index", expected, byIndex);
+   errors += compare("lattice, by blocks", expected,
+         generateByBlocks<double>(layout, n, 16, Device::generateLatticePoints<double>));
+   errors += compare("lattice, by blocks, 32 bits", expected32,
+         generateByBlocks<uint32_t>(layout, n, 16, Device::generateLatticePoints<uint32_t>));
+   return errors;
+}
+
+unsigned int checkSobolNet()
+{
+   using namespace NetBuilder;
+   typedef NetConstructionTraits<NetConstruction::SOBOL>::GenValue GeneratingValue;
+   typedef NetConstructionTraits<NetConstruction::SOBOL>::SizeParameter SizeParameter;
+
+   const std::vector<GeneratingValue> genVals{GeneratingValue(0, {0}), GeneratingValue(1, {1}), GeneratingValue(2, {1, 3})};
+   const DigitalNet<NetConstruction::SOBOL> net(3, SizeParameter(8), genVals);
+   const DigitalNetPointGenerator generator(net);
+   const auto layout = Device::hostLayout(generator);
+   const uint64_t n = generator.numPoints();
+
+   std::vector<double> expected(n * generator.dimension());
+   generator.generate(0, n, expected.data());
+   std::vector<uint32_t> expected32(n * generator.dimension());
+   generator.generate(0, n, expected32.data());
+
+   std::vector<double> byIndex(n * layout.dimension);
+   std::vector<double> grayCode(n * layout.dimension);
+   for (uint64_t i = 0; i < n; i++) {
+      for (uint32_t j = 0; j < layout.dimension; j++) {
+         Device::storeDigits(Device::digits(layout, i, j), &byIndex[i * layout.dimension + j]);
+         Device::storeDigits(Device::grayCodeDigits(layout, i, j), &grayCode[i * layout.dimension + j]);
+      }
+   }
+
+   unsigned int errors = 0;
+   errors += compare("Sobol' net, by index", expected, byIndex);
+   errors += compare("Sobol' net, by blocks", expected,
+         generateByBlocks<double>(layout, n, 24, [](const Device::DigitalNetPointLayout& l, uint64_t first, uint64_t count, double* out)
+            { Device::generateDigitalNetPoints(l, first, count, out); }));
+   errors += compare("Sobol' net, by blocks, 32 bits", expected32,
+         generateByBlocks<uint32_t>(layout, n, 24, [](const Device::DigitalNetPointLayout& l, uint64_t first, uint64_t count, uint32_t* out)
+            { Device::generateDigitalNetPoints(l, first, count, out); }));
+   errors += compare("Sobol' net, Gray code, by blocks", grayCode,
+         generateByBlocks<double>(layout, n, 24, [](const Device::DigitalNetPointLayout& l, uint64_t first, uint64_t count, double* out)
+            { Device::generateDigitalNetPoints(l, first, count, out, true); }));
+   return errors;
+}
+
+int main()
+{
+   try {
+      const unsigned int errors = checkLattice() + checkSobolNet();
+      return errors ? 1 : 0;
+   }
+   catch (std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+   }
+}
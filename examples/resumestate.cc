@@ -0,0 +1,113 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks that a CBC search of digital nets which saves the states of its
+// evaluators with setStateFile(), then is extended from them with
+// setResumeStateFile(), selects the same net with the same merit value as an
+// uninterrupted search, for a coordinate-uniform figure and for a
+// projection-dependent figure.  Returns a nonzero status if they differ.
+
+#include "netbuilder/Types.h"
+#include "netbuilder/DigitalNet.h"
+#include "netbuilder/FigureOfMerit/CoordUniformFigureOfMerit.h"
+#include "netbuilder/FigureOfMerit/WeightedFigureOfMerit.h"
+#include "netbuilder/FigureOfMerit/TValueProjMerit.h"
+#include "netbuilder/Task/CBCSearch.h"
+#include "netbuilder/Task/CBCState.h"
+#include "netbuilder/Task/FullCBCExplorer.h"
+#include "latticetester/ProductWeights.h"
+
+#include "latbuilder/Kernel/PAlphaTilde.h"
+#include "latbuilder/Util.h"
+
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace NetBuilder;
+
+typedef NetConstructionTraits<NetConstruction::POLYNOMIAL>::SizeParameter SizeParameter;
+typedef Task::CBCSearch<NetConstruction::POLYNOMIAL, EmbeddingType::UNILEVEL, Task::FullCBCExplorer> Search;
+typedef Task::FullCBCExplorer<NetConstruction::POLYNOMIAL, EmbeddingType::UNILEVEL> Explorer;
+typedef std::function<std::unique_ptr<FigureOfMerit::CBCFigureOfMerit>()> FigureFactory;
+
+/**
+ * Searches a net of dimension \c dimension for the figure created by
+ * \c makeFigure, once without interruption and once in two runs, the first
+ * one saving the states of its evaluators after \c baseDimension coordinates,
+ * and reports under the name \c what whether both searches agree.
+ */
+unsigned int check(const std::string& what, const SizeParameter& size, Dimension dimension, Dimension baseDimension, const FigureFactory& makeFigure)
+{
+   const std::string stateFile = "resumestate.bin";
+
+   Search full(dimension, size, makeFigure(), std::make_unique<Explorer>(dimension, size));
+   full.execute();
+
+   Search first(baseDimension, size, makeFigure(), std::make_unique<Explorer>(baseDimension, size));
+   first.setStateFile(stateFile);
+   first.execute();
+
+   Search resumed(dimension, Task::readCBCStateNet<NetConstruction::POLYNOMIAL>(stateFile, size), makeFigure(), std::make_unique<Explorer>(dimension, size));
+   resumed.setResumeStateFile(stateFile);
+   resumed.execute();
+   std::remove(stateFile.c_str());
+
+   unsigned int errors = 0;
+   if (Task::formatCBCNet(resumed.bestNet()) != Task::formatCBCNet(full.bestNet())) {
+      std::cerr << what << ": the resumed search selected the net" << std::endl << resumed.bestNet().format()
+         << std::endl << "instead of" << std::endl << full.bestNet().format() << std::endl;
+      errors++;
+   }
+   if (resumed.bestMeritValue() != full.bestMeritValue()) {
+      std::cerr << what << ": the merit value of the resumed search is " << resumed.bestMeritValue()
+         << " instead of " << full.bestMeritValue() << std::endl;
+      errors++;
+   }
+   std::cout << what << ": " << (errors ? "FAILED" : "OK") << std::endl;
+   return errors;
+}
+
+int main()
+{
+   try {
+      const SizeParameter size = LatBuilder::PolynomialFromInt(1033);
+      unsigned int errors = 0;
+
+      errors += check("coordinate-uniform figure", size, 5, 3, []
+            {
+               return std::make_unique<FigureOfMerit::CoordUniformFigureOfMerit<LatBuilder::Kernel::PAlphaTilde, EmbeddingType::UNILEVEL>>(
+                     std::make_unique<LatticeTester::ProductWeights>(.7), LatBuilder::Kernel::PAlphaTilde(2));
+            });
+
+      errors += check("projection-dependent figure", size, 5, 3, []
+            {
+               return std::make_unique<FigureOfMerit::WeightedFigureOfMerit<FigureOfMerit::TValueProjMerit<EmbeddingType::UNILEVEL>>>(
+                     std::numeric_limits<Real>::infinity(), std::make_unique<LatticeTester::ProductWeights>(.7),
+                     std::make_unique<FigureOfMerit::TValueProjMerit<EmbeddingType::UNILEVEL>>(3));
+            });
+
+      return errors ? 1 : 0;
+   }
+   catch (std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+   }
+}
@@ -97,6 +97,28 @@ int main(int argc, char** argv)
                 auto task = std::make_unique<CBCSearch<NetConstruction::POLYNOMIAL, EmbeddingType::UNILEVEL, MixedCBCExplorer>>(s, size, std::move(figure), std::move(explorer));
                 //! [mixed-CBC_explorer]
 
+                std::cout << task->format();
+                task->execute();
+                std::cout << "Best net:" << std::endl;
+                std::cout << task->bestNet().format() << std::endl;
+                std::cout << "Merit value: " << task->bestMeritValue() << std::endl;
+                std::cout << "============================================================" << std::endl;
+        }
+
+        {
+                auto weights = std::make_unique<LatticeTester::ProductWeights>(.7);
+                auto projDepMerit = std::make_unique<TValueProjMerit<EmbeddingType::UNILEVEL>>(3);
+                auto figure = std::make_unique<WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::UNILEVEL>>>(std::numeric_limits<Real>::infinity(), std::move(weights), std::move(projDepMerit));
+                typedef typename NetConstructionTraits<NetConstruction::POLYNOMIAL>::SizeParameter SizeParameter;
+                SizeParameter size = PolynomialFromInt(1033);
+                Dimension s = 5;
+
+                //! [static_evaluator]
+                typedef ProjectionDependentEvaluator<TValueProjMerit<EmbeddingType::UNILEVEL>, StaticAccumulator<LatBuilder::Functor::Max>> Evaluator;
+                auto explorer = std::make_unique<FullCBCExplorer<NetConstruction::POLYNOMIAL, EmbeddingType::UNILEVEL>>(s, size);
+                auto task = std::make_unique<CBCSearch<NetConstruction::POLYNOMIAL, EmbeddingType::UNILEVEL, FullCBCExplorer, MinimumObserver, Evaluator>>(s, size, std::move(figure), std::move(explorer));
+                //! [static_evaluator]
+
                 std::cout << task->format();
                 task->execute();
                 std::cout << "Best net:" << std::endl;
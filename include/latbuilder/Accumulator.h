@@ -33,6 +33,12 @@ namespace LatBuilder {
  * [] operator), the operator OP is applied to each element of the vector
  * through the LatBuilder::Vectorize class template.
  *
+ * The values are combined in the order in which they are fed.  The evaluators
+ * that compute merits concurrently (see WeightedFigureOfMerit) still feed them
+ * in the order of the projections, so that the accumulated value does not
+ * depend on the number of threads; sums over chunks of a size that depends on
+ * it should use ExactSum instead.
+ *
  * \tparam OP              Class template that takes that provides the
  *                         implementation of a scalar binary operator.  Must
  *                         implement the static member functions \c name(),
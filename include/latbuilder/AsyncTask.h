@@ -0,0 +1,147 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Asynchronous and cancellable execution of the tasks.
+ */
+
+#ifndef LATBUILDER__ASYNC_TASK_H
+#define LATBUILDER__ASYNC_TASK_H
+
+#include "latbuilder/Execution.h"
+
+#include <chrono>
+#include <exception>
+#include <future>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace LatBuilder
+{
+
+/**
+ * Task executed by a thread of its own, with a handle to poll its progress,
+ * to cancel it and to wait for its result.
+ *
+ * The task is executed as by a call to its \c execute() function from the
+ * main thread: its parallel loops run on the shared thread pool, of which the
+ * thread of the task is the worker 0.  Its progress is reported by a function
+ * <tt>connectProgress(TASK&, std::shared_ptr<Execution>)</tt> found by
+ * argument-dependent lookup, which connects the signals of the task to
+ * Execution::select() (see LatBuilder::Task::connectProgress() and
+ * NetBuilder::Task::connectProgress()).
+ *
+ * The cancellation is cooperative (see Execution): the task stops at the next
+ * check of its budget, at the latest once the candidate being evaluated by each
+ * worker is done, and the result then throws Cancelled.
+ *
+ * The tasks executed concurrently by several instances share the process-wide
+ * settings, such as the thread pool and the budget.
+ *
+ * \tparam TASK   Type of the task, with an \c execute() function.
+ */
+template <class TASK>
+class AsyncTask {
+public:
+   /**
+    * Starts the execution of \c task.
+    */
+   explicit AsyncTask(std::unique_ptr<TASK> task):
+      m_execution(std::make_shared<Execution>())
+   {
+      connectProgress(*task, m_execution);
+      std::promise<std::unique_ptr<TASK>> promise;
+      m_result = promise.get_future();
+      m_thread = std::thread(run, m_execution, std::move(task), std::move(promise));
+   }
+
+   AsyncTask(AsyncTask&&) = default;
+
+   AsyncTask(const AsyncTask&) = delete;
+   AsyncTask& operator=(const AsyncTask&) = delete;
+
+   /**
+    * Cancels the task if it is still running, and waits for its thread.
+    */
+   ~AsyncTask()
+   {
+      if (m_thread.joinable()) {
+         cancel();
+         m_thread.join();
+      }
+   }
+
+   /**
+    * Returns the progress of the task.
+    */
+   Execution::Progress progress() const
+   { return m_execution->progress(); }
+
+   /**
+    * Requests the cancellation of the task.
+    */
+   void cancel()
+   { m_execution->cancel(); }
+
+   /**
+    * Returns \c true if the result is available, without waiting.
+    */
+   bool ready() const
+   { return m_result.valid() and m_result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+   /**
+    * Waits for the end of the task and returns it, with its result.  Can be
+    * called only once.
+    *
+    * \throws Cancelled if the task was cancelled, or the exception thrown by
+    * the task.
+    */
+   std::unique_ptr<TASK> get()
+   {
+      auto result = std::move(m_result);
+      result.wait();
+      if (m_thread.joinable())
+         m_thread.join();
+      return result.get();
+   }
+
+private:
+   std::shared_ptr<Execution> m_execution;
+   std::future<std::unique_ptr<TASK>> m_result;
+   std::thread m_thread;
+
+   static void run(std::shared_ptr<Execution> execution, std::unique_ptr<TASK> task, std::promise<std::unique_ptr<TASK>> promise)
+   {
+      try {
+         Execution::Scope scope(*execution);
+         task->execute();
+         // a search stopped by the cancellation returns the best candidate found so far
+         if (execution->cancelled())
+            throw Cancelled();
+         promise.set_value(std::move(task));
+      }
+      catch (...) {
+         promise.set_exception(std::current_exception());
+      }
+   }
+};
+
+}
+
+#endif
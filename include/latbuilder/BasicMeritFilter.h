@@ -19,6 +19,7 @@
 
 #include "latbuilder/Types.h"
 #include "latbuilder/LatDef.h"
+#include "latbuilder/LevelVector.h"
 
 namespace LatBuilder {
 
@@ -69,6 +70,57 @@ template <> struct MeritFilterTraits<EmbeddingType::MULTILEVEL> {
 };
 
 
+//========================================================================
+
+
+/**
+ * Specialization of BasicMeritFilter for the filters of per-level merit
+ * values.
+ *
+ * The filters can also be applied in place to a LevelVector, to avoid
+ * allocating a new vector for each candidate lattice.
+ */
+template <LatticeType LR>
+struct BasicMeritFilter<LR, EmbeddingType::MULTILEVEL, EmbeddingType::MULTILEVEL> {
+   typedef RealVector InputMeritValue;
+   typedef RealVector OutputMeritValue;
+   typedef LatBuilder::LatDef<LR, EmbeddingType::MULTILEVEL> LatDef;
+   virtual ~BasicMeritFilter() {}
+   virtual OutputMeritValue operator() (const InputMeritValue&, const LatDef&) const = 0;
+   virtual std::string name() const = 0;
+
+   /**
+    * Filters the per-level merit values \c merit in place.
+    *
+    * The default implementation goes through operator() on a RealVector copy.
+    */
+   virtual void apply(LevelVector& merit, const LatDef& lat) const
+   { merit.assign((*this)(merit.toRealVector(), lat)); }
+};
+
+/**
+ * Specialization of BasicMeritFilter for the combiners of per-level merit
+ * values.
+ */
+template <LatticeType LR>
+struct BasicMeritFilter<LR, EmbeddingType::MULTILEVEL, EmbeddingType::UNILEVEL> {
+   typedef RealVector InputMeritValue;
+   typedef Real OutputMeritValue;
+   typedef LatBuilder::LatDef<LR, EmbeddingType::MULTILEVEL> LatDef;
+   virtual ~BasicMeritFilter() {}
+   virtual OutputMeritValue operator() (const InputMeritValue&, const LatDef&) const = 0;
+   virtual std::string name() const = 0;
+
+   /**
+    * Combines the per-level merit values \c merit.
+    *
+    * The default implementation goes through operator() on a RealVector copy.
+    */
+   virtual Real apply(const LevelVector& merit, const LatDef& lat) const
+   { return (*this)(merit.toRealVector(), lat); }
+};
+
+
 
 }
 
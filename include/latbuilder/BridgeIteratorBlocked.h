@@ -0,0 +1,197 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__BRIDGE_ITERATOR_BLOCKED_H
+#define LATBUILDER__BRIDGE_ITERATOR_BLOCKED_H
+
+#include "latbuilder/Prefetcher.h"
+
+#include <boost/iterator/iterator_adaptor.hpp>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace LatBuilder {
+
+/**
+ * Bridge iterator with values computed by blocks.
+ *
+ * When it is dereferenced, the iterator computes the values of the current
+ * element and of the following ones, up to \c SEQ::blockSize elements, with a
+ * single call to the function of \c SEQ with the following signature:
+ * \code
+ * void elements(typename SEQ::Base::const_iterator first, size_type count, value_type* out) const;
+ * \endcode
+ * The block of values is shared by the copies of the iterator.
+ *
+ * If <tt>SEQ::prefetch() const</tt> returns \c true when a block is computed,
+ * the next block is computed by the background thread of Prefetcher while the
+ * current values are consumed.  Hence, \c elements() must then support
+ * concurrent calls.
+ */
+template <typename SEQ>
+class BridgeIteratorBlocked :
+   public boost::iterators::iterator_adaptor<
+      BridgeIteratorBlocked<SEQ>,
+      typename SEQ::Base::const_iterator,
+      const typename SEQ::value_type
+   >
+{
+   typedef BridgeIteratorBlocked<SEQ> self_type;
+
+public:
+   typedef typename SEQ::value_type value_type;
+   typedef typename SEQ::size_type size_type;
+
+   struct end_tag {};
+
+   BridgeIteratorBlocked():
+      self_type::iterator_adaptor_(),
+      m_seq(nullptr), m_pos(0)
+   {}
+
+   explicit BridgeIteratorBlocked(const SEQ& seq):
+      self_type::iterator_adaptor_(seq.base().begin()),
+      m_seq(&seq), m_pos(0)
+   {}
+
+   BridgeIteratorBlocked(const SEQ& seq, end_tag):
+      self_type::iterator_adaptor_(seq.base().end()),
+      m_seq(&seq), m_pos(0)
+   {}
+
+   const SEQ& seq() const
+   { return *m_seq; }
+
+   size_type index() const
+   { return this->base_reference().index(); }
+
+private:
+   friend class boost::iterators::iterator_core_access;
+
+   void increment()
+   {
+      ++this->base_reference();
+      if (m_block and ++m_pos == m_block->size()) {
+         m_block.reset();
+         m_pos = 0;
+      }
+   }
+
+   bool equal(const BridgeIteratorBlocked& other) const
+   { return m_seq == other.m_seq and this->base_reference() == other.base_reference(); }
+
+   const value_type& dereference() const
+   {
+      const auto end = m_seq->base().end();
+#ifndef NDEBUG
+      if (this->base_reference() == end)
+         throw std::runtime_error("BridgeIteratorBlocked: dereferencing past end of sequence");
+#endif
+      if (!m_block) {
+         std::shared_ptr<Block> block;
+         if (m_next and m_next->task->first().index() == index())
+            block = m_next->task; // prefetched, maybe not yet computed
+         else
+            block = std::make_shared<Block>(*m_seq, this->base_reference());
+         block->complete();
+         m_next.reset();
+         block->rethrow();
+         if (block->next() != end and m_seq->prefetch()) {
+            m_next = std::make_shared<Prefetched>(std::make_shared<Block>(*m_seq, block->next()));
+            Prefetcher::submit(m_next->task);
+         }
+         m_block = std::shared_ptr<const std::vector<value_type>>(block, &block->values());
+      }
+      return (*m_block)[m_pos];
+   }
+
+   ptrdiff_t distance_to(const BridgeIteratorBlocked& other) const
+   { return m_seq == other.m_seq ? other.base_reference() - this->base_reference() : std::numeric_limits<ptrdiff_t>::max(); }
+
+   typedef typename SEQ::Base::const_iterator BaseIterator;
+
+   // values of the elements from first to next, excluded
+   class Block : public Prefetcher::Task {
+   public:
+      Block(const SEQ& seq, BaseIterator first):
+         m_seq(seq), m_first(std::move(first)), m_next(m_first)
+      {
+         size_type count = 0;
+         for (const auto end = m_seq.base().end(); m_next != end and count < SEQ::blockSize; ++m_next)
+            ++count;
+         m_values.resize(count);
+      }
+
+      const BaseIterator& first() const
+      { return m_first; }
+
+      const BaseIterator& next() const
+      { return m_next; }
+
+      const std::vector<value_type>& values() const
+      { return m_values; }
+
+      void rethrow() const
+      {
+         if (m_error)
+            std::rethrow_exception(m_error);
+      }
+
+   protected:
+      void run()
+      {
+         try {
+            m_seq.elements(m_first, m_values.size(), m_values.data());
+         }
+         catch (...) {
+            m_error = std::current_exception();
+         }
+      }
+
+   private:
+      const SEQ& m_seq;
+      BaseIterator m_first;
+      BaseIterator m_next;
+      std::vector<value_type> m_values;
+      std::exception_ptr m_error;
+   };
+
+   // prefetched block, withdrawn or waited for when the last copy of the
+   // iterator is destroyed, before the sequence can be
+   struct Prefetched {
+      std::shared_ptr<Block> task;
+
+      explicit Prefetched(std::shared_ptr<Block> block):
+         task(std::move(block))
+      {}
+
+      ~Prefetched()
+      { task->cancel(); }
+   };
+
+private:
+   const SEQ* m_seq;
+   mutable std::shared_ptr<const std::vector<value_type>> m_block;
+   mutable size_t m_pos;
+   mutable std::shared_ptr<Prefetched> m_next;
+};
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Time and evaluation budgets of the searches.
+ */
+
+#ifndef LATBUILDER__BUDGET_H
+#define LATBUILDER__BUDGET_H
+
+#include "latbuilder/Types.h"
+
+#include <atomic>
+#include <chrono>
+#include <limits>
+
+namespace LatBuilder
+{
+
+/**
+ * Process-wide budget of the searches, in seconds of wall-clock time and in
+ * number of evaluated candidates.
+ *
+ * Once a budget is set with set(), the searches stop exploring when their
+ * share of the budget is exhausted and keep the best candidate found so far,
+ * so that they return a result whatever the budget.  A search visits at
+ * least one candidate per share.  The component-by-component searches ask
+ * for a share of the remaining budget at the start of each coordinate,
+ * divided evenly between the remaining coordinates, so that the budget left
+ * unused by a coordinate goes to the following ones.
+ *
+ * The shares given to a task executed asynchronously are also exhausted when
+ * its execution is cancelled (see Execution).
+ *
+ * A target merit value can also be set with setTarget(): the searches then
+ * stop exploring as soon as a candidate has a merit value below the target
+ * (see reach()), and the component-by-component searches move on to the next
+ * coordinate as soon as a candidate for the current one has a partial merit
+ * value below the target.  The target also seeds the bound of the early
+ * abortion of the evaluations, so that the candidates which cannot reach it
+ * are aborted from the start.
+ *
+ * The candidates are counted with count() by the observers of the searches.
+ * In an MPI job, each process counts the candidates it evaluates and
+ * measures its own time.
+ */
+class Budget {
+public:
+   typedef std::chrono::steady_clock Clock;
+
+   /**
+    * Share of the budget given to a part of a search.
+    *
+    * A default-constructed share is never exhausted.
+    */
+   class Share {
+   public:
+      Share():
+         m_deadline(Clock::time_point::max()),
+         m_maxEvaluations(std::numeric_limits<unsigned long long>::max()),
+         m_cancelled(nullptr),
+         m_targetEpoch(std::numeric_limits<unsigned long long>::max())
+      {}
+
+      /**
+       * Returns \c true if the time or the evaluations of the share are
+       * exhausted, if the target merit value was reached since the share was
+       * given, or if the execution it was given to is cancelled.  Can be
+       * called concurrently.
+       */
+      bool exhausted() const
+      {
+         return (m_cancelled and m_cancelled->load(std::memory_order_relaxed)) or
+            targetsReached() > m_targetEpoch or
+            evaluations() >= m_maxEvaluations or (m_deadline != Clock::time_point::max() and Clock::now() >= m_deadline);
+      }
+
+   private:
+      friend class Budget;
+
+      Clock::time_point m_deadline;
+      unsigned long long m_maxEvaluations;
+      const std::atomic<bool>* m_cancelled; // of the execution of the thread that asked for the share
+      unsigned long long m_targetEpoch; // number of times the target was reached when the share was given
+   };
+
+   /**
+    * Sets the budget to \c seconds of wall-clock time and \c evaluations
+    * candidates, starting from now.  An infinite number of seconds or zero
+    * evaluations means no limit.
+    */
+   static void set(Real seconds, unsigned long long evaluations);
+
+   /**
+    * Sets the target merit value to \c merit; an infinite value means no
+    * target.
+    */
+   static void setTarget(Real merit);
+
+   /**
+    * Removes the limits and the target merit value, as if neither set() nor
+    * setTarget() had been called, and restarts the clock.
+    */
+   static void clear();
+
+   /**
+    * Returns the target merit value, or infinity if no target is set.
+    */
+   static Real target();
+
+   /**
+    * Notifies that a candidate has the (possibly partial) merit value \c
+    * merit, so that the shares given so far are exhausted if it is below the
+    * target merit value.  Can be called concurrently.
+    */
+   static void reach(Real merit);
+
+   /**
+    * Returns the number of times a merit value below the target was notified
+    * with reach().
+    */
+   static unsigned long long targetsReached();
+
+   /**
+    * Restarts the clock and the count of evaluations, for instance before
+    * another run of a search.
+    */
+   static void restart();
+
+   /**
+    * Returns \c true if a time or an evaluation limit is set.
+    */
+   static bool limited();
+
+   /**
+    * Counts \c n evaluated candidates.  Can be called concurrently.
+    */
+   static void count(unsigned long long n = 1);
+
+   /**
+    * Returns the number of candidates evaluated since the budget was set or
+    * restarted.
+    */
+   static unsigned long long evaluations();
+
+   /**
+    * Returns the number of seconds elapsed since the budget was set or
+    * restarted.
+    */
+   static Real elapsed();
+
+   /**
+    * Returns the share of \c 1/parts of the remaining budget, from now on.
+    *
+    * \throws Cancelled if the execution of the calling thread is cancelled
+    * (see Execution).
+    */
+   static Share share(unsigned int parts = 1);
+};
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Checkpoint files of component-by-component searches.
+ */
+
+#ifndef LATBUILDER__CHECKPOINT_H
+#define LATBUILDER__CHECKPOINT_H
+
+#include "latbuilder/Types.h"
+
+#include <string>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * State of a component-by-component search after a completed coordinate.
+ *
+ * Checkpoints are written after each coordinate of a CBC search, so that an
+ * interrupted search can be resumed from the last completed coordinate
+ * instead of starting over.  The next coordinate to explore is always the
+ * first one of the explorer, so that the position of the explorer is given by
+ * the number of generating values.
+ *
+ * The file is a plain text file: two comment lines giving the number of
+ * completed coordinates and the merit value of the selected point set,
+ * followed by one line per coordinate containing its generating value, as
+ * formatted by the search.
+ */
+struct Checkpoint {
+   /// Merit value of the point set after the last completed coordinate.
+   Real merit;
+
+   /// Formatted generating values of the completed coordinates.
+   std::vector<std::string> genValues;
+
+   /**
+    * Returns the number of completed coordinates.
+    */
+   Dimension dimension() const
+   { return genValues.size(); }
+
+   /**
+    * Writes the checkpoint to \c fileName.
+    *
+    * The checkpoint is first written to a temporary file which is then renamed,
+    * so that an interruption while writing never corrupts the previous
+    * checkpoint.
+    */
+   void write(const std::string& fileName) const;
+
+   /**
+    * Reads a checkpoint written by write().
+    *
+    * \throws std::runtime_error if the file cannot be read or is not a valid
+    * checkpoint.
+    */
+   static Checkpoint read(const std::string& fileName);
+};
+
+}
+
+#endif
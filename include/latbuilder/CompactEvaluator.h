@@ -0,0 +1,144 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Allocation-free evaluation of small point sets.
+ */
+
+#ifndef LATBUILDER__COMPACT_EVALUATOR_H
+#define LATBUILDER__COMPACT_EVALUATOR_H
+
+#include "latbuilder/Types.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Low-latency evaluation of coordinate-uniform figures of merit for small
+ * point sets.
+ *
+ * The generic evaluation path builds a storage, a kernel, the states of the
+ * coordinate-uniform evaluator and the point set itself for each evaluation.
+ * This evaluator instead works on raw arrays of generating values or of
+ * generating matrices, for at most MaxPoints points in at most MaxDimension
+ * dimensions, and keeps its only buffer, the table of the kernel values,
+ * from one evaluation to the next.  Once the buffer has reached the size of
+ * the largest point set (see reserve()), the evaluations allocate no memory.
+ * The other state of an evaluation is held on the stack, so that an
+ * evaluation costs \f$O(ns)\f$ operations for product weights and
+ * \f$O(ns^2)\f$ for POD weights, without any virtual call.
+ *
+ * The weights are given as
+ * - \c productWeights: the weights \f$\gamma_j\f$ of the coordinates, or
+ *   \c nullptr for unit weights;
+ * - \c orderWeights: the weights \f$\Gamma_\ell\f$ of the orders \f$\ell =
+ *   0, \dots, s\f$, or \c nullptr for unit weights;
+ *
+ * and the weight of a nonempty projection \f$\mathfrak u\f$ is
+ * \f$\Gamma_{|\mathfrak u|} \prod_{j \in \mathfrak u} \gamma_j\f$, which
+ * covers the product, order-dependent and POD weights.  The weights are
+ * used as given, that is, already raised to the power of the norm, and the
+ * merit value is
+ * \f[
+ *    \sum_{\emptyset \neq \mathfrak u \subseteq \{1, \dots, s\}}
+ *    \Gamma_{|\mathfrak u|} \prod_{j \in \mathfrak u} \gamma_j
+ *    \frac{1}{n} \sum_{i=0}^{n-1} \prod_{j \in \mathfrak u} \omega(x_{i,j}),
+ * \f]
+ * the same value as the coordinate-uniform figure of merit with the same
+ * kernel and weights, up to rounding.
+ *
+ * An evaluator must not be shared by concurrent threads; local() returns an
+ * evaluator reserved to the calling thread.
+ */
+class CompactEvaluator {
+public:
+   /// Maximum number of points.
+   static constexpr uInteger MaxPoints = uInteger(1) << 16;
+
+   /// Maximum dimension.
+   static constexpr Dimension MaxDimension = 32;
+
+   /**
+    * Constructor.
+    */
+   CompactEvaluator();
+
+   /**
+    * Returns the evaluator of the calling thread.
+    */
+   static CompactEvaluator& local();
+
+   /**
+    * Allocates the buffer for point sets of up to \c numPoints points, so
+    * that the following evaluations allocate no memory.
+    */
+   void reserve(uInteger numPoints = MaxPoints);
+
+   /**
+    * Returns the \f$\mathcal P_\alpha\f$ merit value of the ordinary rank-1
+    * lattice with \c numPoints points and generating vector \c gen of
+    * dimension \c dimension.
+    *
+    * \param alpha   Value of \f$\alpha\f$ (2, 4, 6 or 8, see
+    *                Functor::PAlpha).
+    */
+   Real latticePAlpha(
+         uInteger numPoints,
+         const uInteger* gen,
+         Dimension dimension,
+         unsigned int alpha,
+         const Real* productWeights,
+         const Real* orderWeights = nullptr);
+
+   /**
+    * Returns the \f$\tilde{\mathcal P}_\alpha\f$ merit value of the digital
+    * net in base 2 with \f$2^m\f$ points and \c dimension generating
+    * matrices of size \f$m \times m\f$.
+    *
+    * The columns of the matrices are stored one after the other, so that
+    * <code>columns[j * m + c]</code> is the column \f$c\f$ of the matrix of
+    * coordinate \f$j\f$, the bit \f$m - 1 - r\f$ of which is the entry of
+    * row \f$r\f$.  The points are enumerated in Gray code order.
+    *
+    * \param alpha   Value of \f$\alpha > 1\f$ (see Functor::PAlphaTilde).
+    */
+   Real netPAlphaTilde(
+         unsigned int m,
+         const std::uint32_t* columns,
+         Dimension dimension,
+         unsigned int alpha,
+         const Real* productWeights,
+         const Real* orderWeights = nullptr);
+
+private:
+   // Checks the size of the point set, or throws std::invalid_argument.
+   static void checkSize(uInteger numPoints, Dimension dimension);
+
+   // Fills the table of the kernel values, unless it already holds them.
+   void prepareLattice(uInteger numPoints, unsigned int alpha);
+
+   std::vector<Real> m_kernel; // kernel values
+   uInteger m_kernelPoints; // number of points of the kernel table
+   unsigned int m_kernelAlpha; // alpha of the kernel table (0 if empty)
+};
+
+}
+
+#endif
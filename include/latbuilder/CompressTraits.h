@@ -65,6 +65,16 @@ struct CompressTraits<Compress::NONE> {
  * stored in memory, and when an component from the second half is accessed, it
  * is mapped to the identical element from the first half.  Modifying one
  * modifies the other.
+ *
+ * \remark This compression is only available for ordinary lattices.  It
+ * relies on the reflection \f$i \mapsto n - i\f$, which commutes with the
+ * stride permutations and under which symmetric kernels are invariant, so
+ * that the states inherit the symmetry.  For polynomial lattices and digital
+ * nets, the counterpart of this reflection is \f$h(z) \mapsto -h(z) = h(z)\f$
+ * in \f$\mathbb F_2[z]\f$, and the other maps commuting with the stride
+ * permutations are the multiplications by units of \f$\mathbb F_2[z]/P(z)\f$,
+ * which do not preserve the digital kernels; their vectors cannot be halved
+ * in this way.
  */
 template<>
 struct CompressTraits<Compress::SYMMETRIC> {
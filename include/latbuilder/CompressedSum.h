@@ -53,6 +53,31 @@ compressedSum(
 }
 
 
+/**
+ * Returns the weights \f$c_i\f$ of the elements \f$v_i\f$ of a (possibly
+ * compressed) vector in its sum, such that compressedSum() returns
+ * \f$\sum_i c_i v_i\f$.
+ */
+template <LatticeType LR, Compress COMPRESS, PerLevelOrder PLO>
+RealVector compressedSumWeights(
+      const Storage<LR, EmbeddingType::UNILEVEL, COMPRESS, PLO>& storage
+      )
+{
+   RealVector weights(storage.size(), 1.0);
+   if (LR == LatticeType::ORDINARY){
+      if (COMPRESS == Compress::SYMMETRIC) {
+         // compression ratio except first element
+         weights *= 2;
+         weights(0) -= 1;
+         // if even number of points, last element is not repeated
+         if (storage.sizeParam().numPoints() % 2 == 0)
+            weights(weights.size() - 1) -= 1;
+      }
+   }
+   return weights;
+}
+
+
 /**
  * Returns the per-level sums of the elements of the compressed multilevel
  * vector expression \c e.
@@ -75,7 +100,7 @@ compressedSum(
 
       boost::numeric::ublas::vector_range<const E> subvec(e(), range);
 
-      double sum = 0.0;
+      Real sum = 0.0;
       for (const auto& x : subvec)
          sum += x;
 
@@ -98,6 +123,30 @@ compressedSum(
    return out;
 }
 
+
+/**
+ * Returns the weights \f$c_i\f$ of the elements \f$v_i\f$ of a compressed
+ * multilevel vector in the sums of their levels, such that compressedSum()
+ * returns the cumulative sums of the \f$c_i v_i\f$ over the level ranges.
+ */
+template <LatticeType LR, Compress COMPRESS, PerLevelOrder PLO>
+RealVector compressedSumWeights(
+      const Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO>& storage
+      )
+{
+   RealVector weights(storage.size(), 1.0);
+   if (COMPRESS == Compress::SYMMETRIC) {
+      const Level first = storage.sizeParam().base() == LatticeTraits<LR>::TrivialModulus ? 2 : 1;
+      Level level = 0;
+      for (const auto& range : storage.levelRanges()) {
+         // compression ratio except if uncompressed level has only one element
+         if (level++ >= first)
+            boost::numeric::ublas::vector_range<RealVector>(weights, range) *= 2;
+      }
+   }
+   return weights;
+}
+
 }
 
 #endif
@@ -0,0 +1,131 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Runtime selection of the instruction sets used by the hot kernels.
+ */
+
+#ifndef LATBUILDER__CPU_DISPATCH_H
+#define LATBUILDER__CPU_DISPATCH_H
+
+#include <string>
+
+#if defined(LATNETBUILDER_CPU_DISPATCH) && defined(__GNUC__) && defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
+
+/**
+ * \def LATNETBUILDER_CPU_DISPATCH_ENABLED
+ * 1 if the kernels are compiled for several instruction sets and the best one
+ * is selected at run time on the host, 0 otherwise.
+ *
+ * Enabled with <code>waf configure --cpu-dispatch</code>, which defines \c
+ * LATNETBUILDER_CPU_DISPATCH, for the GCC-compatible compilers targeting
+ * x86-64 ELF platforms, where GNU indirect functions resolve the clones when
+ * the library is loaded, and AArch64 Linux, where the features of the host
+ * are read from the auxiliary vector.  This is meant for the binaries
+ * distributed to heterogeneous hosts, which cannot be built with
+ * <tt>-march=native</tt>.
+ */
+#if defined(LATNETBUILDER_CPU_DISPATCH) && defined(__GNUC__) && defined(__x86_64__) && defined(__ELF__)
+#define LATNETBUILDER_CPU_DISPATCH_ENABLED 1
+#elif defined(LATNETBUILDER_CPU_DISPATCH) && defined(__GNUC__) && defined(__aarch64__) && defined(__linux__)
+#define LATNETBUILDER_CPU_DISPATCH_ENABLED 1
+#else
+#define LATNETBUILDER_CPU_DISPATCH_ENABLED 0
+#endif
+
+/**
+ * \def LATNETBUILDER_TARGET_CLONES
+ * Marks a function whose loops are vectorized by the compiler, so that it is
+ * compiled once for each of AVX-512, AVX2, SSE4.2 and the baseline of the
+ * target, the best clone supported by the host being called.  Empty when
+ * #LATNETBUILDER_CPU_DISPATCH_ENABLED is 0 and on AArch64, where the kernels
+ * have explicit NEON and SVE implementations instead.
+ *
+ * The clones cannot be inlined: the marked functions must process whole
+ * blocks of values.
+ */
+
+/**
+ * \def LATNETBUILDER_TARGET(features)
+ * Marks a function compiled for the instruction sets \c features, which must
+ * only be called when cpuSupports() them.  Empty when
+ * #LATNETBUILDER_CPU_DISPATCH_ENABLED is 0.
+ */
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED && defined(__x86_64__)
+#define LATNETBUILDER_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "sse4.2", "default")))
+#define LATNETBUILDER_TARGET(features) __attribute__((target(features)))
+#elif LATNETBUILDER_CPU_DISPATCH_ENABLED
+#define LATNETBUILDER_TARGET_CLONES
+#define LATNETBUILDER_TARGET(features) __attribute__((target(features)))
+#else
+#define LATNETBUILDER_TARGET_CLONES
+#define LATNETBUILDER_TARGET(features)
+#endif
+
+namespace LatBuilder
+{
+
+/**
+ * Instruction sets used by the kernels: POPCNT to AVX512F on x86-64, PMULL
+ * (the polynomial multiplication of the cryptographic extension) and SVE on
+ * AArch64.
+ */
+enum class CpuFeature { POPCNT, SSE42, PCLMUL, BMI2, AVX2, AVX512F, PMULL, SVE };
+
+/**
+ * Returns \c true if the host supports the instruction set \c feature.
+ *
+ * Always \c false when #LATNETBUILDER_CPU_DISPATCH_ENABLED is 0 and for the
+ * instruction sets of the other architectures.
+ */
+inline bool cpuSupports(CpuFeature feature)
+{
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED && defined(__x86_64__)
+   switch (feature) {
+   case CpuFeature::POPCNT: return __builtin_cpu_supports("popcnt");
+   case CpuFeature::SSE42: return __builtin_cpu_supports("sse4.2");
+   case CpuFeature::PCLMUL: return __builtin_cpu_supports("pclmul");
+   case CpuFeature::BMI2: return __builtin_cpu_supports("bmi2");
+   case CpuFeature::AVX2: return __builtin_cpu_supports("avx2");
+   case CpuFeature::AVX512F: return __builtin_cpu_supports("avx512f");
+   default: return false;
+   }
+#elif LATNETBUILDER_CPU_DISPATCH_ENABLED
+   // bits of HWCAP_PMULL and HWCAP_SVE in <asm/hwcap.h>
+   static const unsigned long hwcap = getauxval(AT_HWCAP);
+   switch (feature) {
+   case CpuFeature::PMULL: return (hwcap >> 4) & 1;
+   case CpuFeature::SVE: return (hwcap >> 22) & 1;
+   default: return false;
+   }
+#endif
+   (void) feature;
+   return false;
+}
+
+/**
+ * Returns a description of the instruction sets used by the kernels on the
+ * host, either selected at run time or fixed at compile time.
+ */
+std::string cpuDispatchDescription();
+
+}
+
+#endif
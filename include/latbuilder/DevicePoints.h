@@ -0,0 +1,186 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Index-based generation of the points of rank-1 lattices, callable from device code.
+ */
+
+#ifndef LATBUILDER__DEVICE_POINTS_H
+#define LATBUILDER__DEVICE_POINTS_H
+
+#include "latbuilder/PointGenerator.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Qualifier of the functions that are compiled both for the host and for the
+ * device when the file is included in a CUDA or HIP translation unit.
+ */
+#if defined(__CUDACC__) || defined(__HIPCC__)
+#define LATBUILDER_HOST_DEVICE __host__ __device__
+#else
+#define LATBUILDER_HOST_DEVICE
+#endif
+
+namespace LatBuilder { namespace Device {
+
+/**
+ * Description of a rank-1 lattice point set that can be copied as is to the
+ * memory of a device.
+ *
+ * The arrays are not owned: \c gen and \c shift point to
+ * <code>dimension</code> values each, in the memory of the processor that
+ * generates the points.  A null \c shift means no shift.  The generating
+ * vector must be reduced modulo \c numPoints and the shift modulo 1, as
+ * returned by LatticePointGenerator::generatingVector() and
+ * LatticePointGenerator::shift().  The shift has the type \c Real of the
+ * generator, so that device code needs a build with <code>--real
+ * double</code> or <code>--real float</code>.
+ */
+struct LatticePointLayout {
+   uint64_t numPoints;
+   uint32_t dimension;
+   const uint64_t* gen;
+   const Real* shift;
+};
+
+/**
+ * Returns the layout of the points of \c generator, with arrays that point to
+ * the memory of \c generator.
+ *
+ * To generate the points on a device, copy the \c gen and \c shift arrays
+ * (<code>dimension</code> values each) to the device and replace the pointers
+ * of the layout with the device addresses; the points themselves are then
+ * produced directly in device buffers.
+ */
+inline LatticePointLayout hostLayout(const LatticePointGenerator& generator)
+{
+   static_assert(sizeof(uInteger) == sizeof(uint64_t), "the generating vector is stored as 64-bit integers");
+   return LatticePointLayout{
+      uint64_t(generator.numPoints()),
+      uint32_t(generator.dimension()),
+      reinterpret_cast<const uint64_t*>(generator.generatingVector().data()),
+      generator.shift().empty() ? nullptr : generator.shift().data()};
+}
+
+/**
+ * Returns <code>(x + y) mod n</code> for <code>x, y < n</code>, without overflow.
+ */
+LATBUILDER_HOST_DEVICE inline uint64_t addMod(uint64_t x, uint64_t y, uint64_t n)
+{ return x >= n - y ? x - (n - y) : x + y; }
+
+/**
+ * Returns <code>(x * y) mod n</code> without overflow.
+ */
+LATBUILDER_HOST_DEVICE inline uint64_t mulMod(uint64_t x, uint64_t y, uint64_t n)
+{
+   uint64_t res = 0;
+   x %= n;
+   for (; y; y >>= 1) {
+      if (y & 1)
+         res = addMod(res, x, n);
+      x = addMod(x, x, n);
+   }
+   return res;
+}
+
+/**
+ * Converts a coordinate in \f$[0,1)\f$ to its first 32 binary digits, as
+ * LatticePointGenerator does.
+ */
+LATBUILDER_HOST_DEVICE inline uint32_t toUInt32(double x)
+{
+   const double twoPow32 = 4294967296.0;
+   const double y = floor(x * twoPow32);
+   return y >= twoPow32 ? uint32_t(0xFFFFFFFFu) : uint32_t(y);
+}
+
+/// Stores the coordinate \c x as a double-precision number.
+LATBUILDER_HOST_DEVICE inline void storeCoordinate(double x, double* out)
+{ *out = x; }
+
+/// Stores the first 32 binary digits of the coordinate \c x.
+LATBUILDER_HOST_DEVICE inline void storeCoordinate(double x, uint32_t* out)
+{ *out = toUInt32(x); }
+
+/**
+ * Returns the coordinate \c j of the shifted point of index \c i.
+ *
+ * The point depends on its index only, so that each thread of a device can
+ * compute its own points; the value is identical to the one produced by
+ * LatticePointGenerator.
+ */
+LATBUILDER_HOST_DEVICE inline double latticeCoordinate(const LatticePointLayout& layout, uint64_t i, uint32_t j)
+{
+   double x = mulMod(i, layout.gen[j], layout.numPoints) * (1.0 / layout.numPoints);
+   if (layout.shift) {
+      x += layout.shift[j];
+      if (x >= 1.0)
+         x -= 1.0;
+   }
+   return x;
+}
+
+/**
+ * Writes the coordinates of the points of indices \c first to
+ * <code>first + count - 1</code> to \c out, one point after the other.
+ *
+ * Only the first point is computed from its index; the numerators of the
+ * next ones are obtained by one modular addition by coordinate, which makes
+ * this the preferred entry point for a thread that processes a block of
+ * consecutive points.  The coordinates are processed one after the other, so
+ * that no per-coordinate state has to be allocated on the device.
+ * \c T is \c double or \c uint32_t.
+ */
+template <typename T>
+LATBUILDER_HOST_DEVICE void generateLatticePoints(const LatticePointLayout& layout, uint64_t first, uint64_t count, T* out)
+{
+   const double invN = 1.0 / layout.numPoints;
+   for (uint32_t j = 0; j < layout.dimension; ++j) {
+      uint64_t numerator = mulMod(first, layout.gen[j], layout.numPoints);
+      T* dest = out + j;
+      for (uint64_t i = 0; i < count; ++i, dest += layout.dimension) {
+         double x = numerator * invN;
+         if (layout.shift) {
+            x += layout.shift[j];
+            if (x >= 1.0)
+               x -= 1.0;
+         }
+         storeCoordinate(x, dest);
+         numerator = addMod(numerator, layout.gen[j], layout.numPoints);
+      }
+   }
+}
+
+/**
+ * Draws a random shift modulo 1 with \c dimension coordinates, uniformly in
+ * \f$[0,1)^s\f$, from the 64-bit generator \c rng (for instance LFSR258).
+ */
+template <class RNG>
+std::vector<Real> randomShift(Dimension dimension, RNG& rng)
+{
+   std::vector<Real> shift(dimension);
+   for (auto& delta : shift)
+      delta = std::ldexp(double(uint64_t(rng()) >> 11), -53);
+   return shift;
+}
+
+}}
+
+#endif
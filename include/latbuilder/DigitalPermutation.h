@@ -0,0 +1,83 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__DIGITAL_PERMUTATION_H
+#define LATBUILDER__DIGITAL_PERMUTATION_H
+
+#include "latbuilder/Types.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace LatBuilder {
+
+/**
+ * Gray-code permutation of the point indices of a digital net.
+ *
+ * Stores the kernel index \f$M \boldsymbol i'\f$ of each point \f$i\f$, where
+ * \f$\boldsymbol i'\f$ is the Gray code of \f$i\f$, as computed by the Stride
+ * permutations of the digital storages.  The indices are stored on 32 bits
+ * whenever the reversed columns of \f$M\f$ fit on 32 bits, which is always
+ * the case for nets with at most \f$2^{32}\f$ points; this halves the memory
+ * footprint and the bandwidth of the gathers made through the permutation.
+ */
+class DigitalPermutation {
+public:
+   typedef uInteger size_type;
+
+   /**
+    * Constructor.
+    *
+    * \param size    Number of points.
+    * \param cols    Reversed columns of the generating matrix, as returned by
+    *                NetBuilder::GeneratingMatrix::getColsReverse().
+    */
+   DigitalPermutation(size_type size, const std::vector<unsigned long>& cols):
+      m_size(size)
+   {
+      const bool narrow = std::all_of(cols.begin(), cols.end(),
+            [](unsigned long col) { return col <= std::numeric_limits<uint32_t>::max(); });
+      if (narrow)
+         fill(m_narrow, cols);
+      else
+         fill(m_wide, cols);
+   }
+
+   size_type operator[](size_type i) const
+   { return m_narrow.empty() ? m_wide[i] : m_narrow[i]; }
+
+   size_type size() const
+   { return m_size; }
+
+private:
+   template <typename INDEX>
+   void fill(std::vector<INDEX>& perm, const std::vector<unsigned long>& cols) const
+   {
+      perm.assign(m_size, 0);
+      for (size_type i = 1; i < m_size; ++i)
+         perm[i] = perm[i-1] ^ static_cast<INDEX>(cols[NetBuilder::lowestSetBit(i)]); // the Gray codes of i-1 and i differ by the lowest set bit of i
+   }
+
+   size_type m_size;
+   std::vector<uint32_t> m_narrow;
+   std::vector<size_type> m_wide;
+};
+
+}
+
+#endif
@@ -0,0 +1,133 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Distribution of CBC explorations over the processes of an MPI job.
+ */
+
+#ifndef LATBUILDER__DISTRIBUTED_H
+#define LATBUILDER__DISTRIBUTED_H
+
+#include "latbuilder/Types.h"
+
+#include <limits>
+#include <string>
+
+namespace LatBuilder
+{
+
+/**
+ * Processes of an MPI job sharing the exploration of each coordinate of the
+ * CBC searches.
+ *
+ * All processes enumerate the same candidates in the same order.  The
+ * candidate of index \f$i\f$ is evaluated by the process of rank \f$i \bmod
+ * p\f$, where \f$p\f$ is the number of processes, and the best candidate of
+ * the coordinate is then found by a reduction over the processes: the smallest
+ * merit value wins, and ties are resolved in favor of the smallest index, as
+ * in a serial search.  Its generating value is finally broadcast by the
+ * process which evaluated it, so that all processes extend the same point set.
+ *
+ * Only the CBC searches whose candidates are evaluated one by one are shared
+ * in this way; the fast CBC searches, which evaluate all the candidates of a
+ * coordinate at once, are run in full by every process (see
+ * Task::detail::Distributes).
+ *
+ * MPI is used only if LatNet Builder is configured with the \c --mpi option,
+ * which defines \c LATNETBUILDER_MPI.  Otherwise, or if MPI was not
+ * initialized, there is a single process and all the functions below are
+ * trivial.
+ */
+class Distributed
+{
+public:
+   /**
+    * Initializes MPI on construction and finalizes it on destruction.
+    *
+    * An instance must live in \c main() as long as the searches run.
+    */
+   class Session
+   {
+   public:
+      Session();
+      ~Session();
+      Session(const Session&) = delete;
+      Session& operator=(const Session&) = delete;
+   private:
+      bool m_owner;
+   };
+
+   /**
+    * Best candidate of a process, at the end of the exploration of a
+    * coordinate.
+    */
+   struct Candidate {
+      /// Index used for processes which have not selected any candidate.
+      static constexpr unsigned long long none = std::numeric_limits<unsigned long long>::max();
+
+      Real merit = std::numeric_limits<Real>::infinity();
+      unsigned long long index = none;
+   };
+
+   /**
+    * Returns the rank of the current process.
+    */
+   static unsigned int rank();
+
+   /**
+    * Returns the number of processes.
+    */
+   static unsigned int size();
+
+   /**
+    * Returns \c true for the process in charge of the outputs.
+    */
+   static bool isRoot()
+   { return rank() == 0; }
+
+   /**
+    * Returns the rank of the process which evaluates the candidate of index
+    * \c index.
+    */
+   static unsigned int owner(unsigned long long index)
+   { return (unsigned int) (index % size()); }
+
+   /**
+    * Returns \c true if the current process evaluates the candidate of index
+    * \c index.
+    */
+   static bool owns(unsigned long long index)
+   { return owner(index) == rank(); }
+
+   /**
+    * Returns the best of the candidates of all processes.
+    *
+    * Must be called by all processes.
+    */
+   static Candidate minimum(const Candidate& local);
+
+   /**
+    * Returns the string \c value of the process of rank \c root.
+    *
+    * Must be called by all processes.
+    */
+   static std::string broadcast(const std::string& value, unsigned int root);
+};
+
+}
+
+#endif
@@ -0,0 +1,122 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Estimates of the memory and of the time of a search, without executing it.
+ */
+
+#ifndef LATBUILDER__DRY_RUN_H
+#define LATBUILDER__DRY_RUN_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/Memory.h"
+#include "latbuilder/Parser/CommandLine.h"
+
+#include <array>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Estimates of the resources of the search of a command line (\c --dry-run).
+ *
+ * The estimates are computed from the size parameter, the dimension, the
+ * weights, the figure of merit and the exploration method only: neither the
+ * kernel values nor the states are computed.  The peak memory of each
+ * component (see Memory) is the sum of the largest vectors alive at once:
+ * - storage: the index tables of the embedded storages;
+ * - kernel values: one vector of kernel values by coordinate-uniform figure;
+ * - states: the rows of the states (one for product weights, one by order
+ *   for order-dependent and POD weights, one by projection prefix for
+ *   projection-dependent weights), for each search executed concurrently;
+ * - FFT buffers: the transforms of the kernel values and the work buffers of
+ *   each thread of the fast constructions;
+ * - other: the merit values of the candidates of a coordinate.
+ *
+ * The time is the number of elementary operations of the coordinate-uniform
+ * evaluations times the time of a gathered multiply-add measured on this
+ * machine by calibrate(), divided by the number of threads.  It is not
+ * estimated for the figures of merit which are not coordinate-uniform.
+ */
+class DryRun {
+public:
+   /// Estimated resources of a search.
+   struct Estimate {
+      /// Number of points.
+      double numPoints = 0;
+      /// Number of elements of the vectors of the storage.
+      size_t storageSize = 0;
+      /// Whether the storage uses the symmetric compression.
+      bool symmetric = false;
+      /// Number of candidate generating values by coordinate.
+      double numGeneratingValues = 0;
+      /// Number of rows of the states.
+      size_t stateRows = 0;
+      /// Estimated peak number of bytes of each component.
+      std::array<double, Memory::NUM_COMPONENTS> bytes{};
+      /// Number of lattices evaluated by all the runs.
+      double evaluations = 0;
+      /// Number of elementary operations of all the runs, or 0 if unknown.
+      double operations = 0;
+      /// Measured time of an elementary operation, in seconds.
+      double secondsPerOperation = 0;
+      /// Number of threads.
+      unsigned int numThreads = 1;
+      /// Remarks on the assumptions of the estimates.
+      std::vector<std::string> notes;
+
+      /// Returns the estimated peak number of bytes of all the components.
+      double totalBytes() const;
+
+      /// Returns the estimated wall-clock time in seconds, or 0 if unknown.
+      double seconds() const;
+   };
+
+   /**
+    * Estimates the resources of the search of \c cmd, with embedding type
+    * \c ET, executed \c repeat times on \c numThreads threads.
+    *
+    * \throws Parser::ParserError if the size parameter, the dimension or the
+    * weights cannot be parsed.
+    */
+   template <LatticeType LR, EmbeddingType ET>
+   static Estimate estimate(
+         const Parser::CommandLine<LR, EmbeddingType::MULTILEVEL>& cmd,
+         unsigned int numThreads,
+         unsigned int repeat);
+
+   /**
+    * Returns the time in seconds of a multiply-add of the elements of a
+    * vector of \c size elements with those of another one gathered with a
+    * stride, as in the evaluation of a coordinate-uniform candidate.
+    */
+   static double calibrate(size_t size);
+
+   /**
+    * Writes the report of \c estimate to \c os.
+    */
+   static void write(std::ostream& os, const Estimate& estimate);
+};
+
+}
+
+#endif
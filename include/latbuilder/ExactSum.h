@@ -0,0 +1,130 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LATBUILDER__EXACT_SUM_H
+#define LATBUILDER__EXACT_SUM_H
+
+#include "latbuilder/Types.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace LatBuilder {
+
+/**
+ * Exact sum of floating-point values.
+ *
+ * The values are added without rounding into a fixed-point superaccumulator
+ * covering the whole range of \c double, by digits of 32 bits held in 64-bit
+ * integers, so that the sum does not depend on the order in which the values
+ * are added or in which partial sums are combined with merge().  The sum is
+ * rounded only once, by value().
+ *
+ * Hence, a reduction which splits its terms into chunks that depend on the
+ * number of threads, adds each chunk into its own ExactSum and merges them,
+ * returns the same bits for every number of threads.  Reductions which
+ * already combine their terms in a fixed order (such as
+ * ThreadPool::parallelReduce() and Accumulator) do not need it.
+ *
+ * Values of type <code>long double</code> are split into a sum of two \c
+ * double values and value() rounds the exact sum in two steps, so that the
+ * precision of both types is preserved within the range of \c double.
+ */
+class ExactSum {
+public:
+   /**
+    * Constructor for a sum of zero.
+    */
+   ExactSum();
+
+   /**
+    * Adds \c x to the sum.
+    */
+   ExactSum& operator+=(Real x)
+   {
+      const double hi = static_cast<double>(x);
+      add(hi);
+      if (sizeof(Real) > sizeof(double) and std::isfinite(hi))
+         add(static_cast<double>(x - hi));
+      return *this;
+   }
+
+   /**
+    * Adds the sum \c other to this sum.
+    */
+   ExactSum& merge(const ExactSum& other);
+
+   /**
+    * Returns the sum rounded to the nearest value of type Real.
+    *
+    * Returns a NaN if a NaN or infinities of both signs were added, and an
+    * infinity if only infinities of one sign were.
+    */
+   Real value() const;
+
+private:
+   // weight of the lowest digit: below every bit of the subnormal doubles
+   static constexpr int LowestExponent = -1152;
+   // 36 digits below 1, 32 up to the largest double and 2 for the carries
+   static constexpr int NumDigits = 70;
+   // number of additions after which the digits must be normalized
+   static constexpr std::uint32_t MaxPending = 1u << 28;
+
+   void add(double x)
+   {
+      if (x == 0.0)
+         return;
+      if (not std::isfinite(x)) {
+         addSpecial(x);
+         return;
+      }
+      int exponent;
+      const double fraction = std::frexp(x, &exponent);
+      // x = mantissa * 2^(exponent - 53), exactly
+      const std::int64_t mantissa = static_cast<std::int64_t>(std::ldexp(fraction, 53));
+      const int offset = exponent - 53 - LowestExponent;
+      const int digit = offset / 32;
+      const int shift = offset % 32;
+      const std::uint64_t magnitude = static_cast<std::uint64_t>(mantissa < 0 ? -mantissa : mantissa);
+      const std::uint64_t low = (magnitude & 0xffffffffu) << shift;
+      const std::uint64_t high = (magnitude >> 32) << shift;
+      const std::int64_t sign = mantissa < 0 ? -1 : 1;
+      m_digits[digit] += sign * static_cast<std::int64_t>(low & 0xffffffffu);
+      m_digits[digit + 1] += sign * static_cast<std::int64_t>((low >> 32) + (high & 0xffffffffu));
+      m_digits[digit + 2] += sign * static_cast<std::int64_t>(high >> 32);
+      if (++m_pending == MaxPending)
+         normalize();
+   }
+
+   void addSpecial(double x);
+
+   // propagates the carries so that every digit but the highest is in [0, 2^32)
+   void normalize();
+
+   // rounds the sum to the nearest double and subtracts the rounded value
+   double extract();
+
+   std::int64_t m_digits[NumDigits];
+   std::uint32_t m_pending;
+   bool m_nan;
+   bool m_positiveInfinity;
+   bool m_negativeInfinity;
+};
+
+}
+
+#endif
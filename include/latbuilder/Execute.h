@@ -0,0 +1,208 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Execution of the lattice searches of the command line, by construction.
+ */
+
+#ifndef LATBUILDER__EXECUTE_H
+#define LATBUILDER__EXECUTE_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/TextStream.h"
+#include "latbuilder/Parser/CommandLine.h"
+#include "latbuilder/PointGenerator.h"
+#include "latbuilder/ParallelRepeats.h"
+#include "latbuilder/Shard.h"
+#include "latbuilder/Task/CBCBasedSearch.h"
+#include "latbuilder/DryRun.h"
+#include "latbuilder/Memory.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Options of the command line which do not depend on the construction.
+ */
+struct ExecuteOptions {
+   /// Verbosity level.
+   int verbose = 0;
+   /// Number of runs of the search.
+   unsigned int repeat = 1;
+   /// Whether the runs are executed concurrently (see ParallelRepeats).
+   bool parallelRepeats = false;
+   /// Output folder, or an empty string.
+   std::string outputFolder;
+   /// Output file of the points of the selected lattice, or an empty string.
+   std::string outputPoints;
+   /// Format of the output points.
+   PointFormat pointFormat = PointFormat::FLOAT64;
+   /// Whether the search resumes from its checkpoint.
+   bool resume = false;
+   /// Number of significant digits of the merit values, or 0 for the default.
+   unsigned int meritDigitsDisplayed = 0;
+   /// Output style of the polynomial lattices.
+   std::string outputStyle;
+   /// Original command line, which is echoed in the output files.
+   std::string originalCommandLine;
+   /// Whether the resources of the search are estimated instead of executing it.
+   bool dryRun = false;
+};
+
+/**
+ * Entry points of the modules of the lattice types (see Module), which parse
+ * and execute the search of the command line \c opt.
+ */
+extern "C" {
+typedef void ExecuteFunction(const boost::program_options::variables_map& opt, const ExecuteOptions& options);
+ExecuteFunction latbuilder_execute_ordinary;
+ExecuteFunction latbuilder_execute_polynomial;
+}
+
+/**
+ * Reports the end of a coordinate of the search \c s.
+ */
+template <LatticeType LR, EmbeddingType ET>
+void onLatticeSelected(const Task::Search<LR, ET>& s, unsigned int meritDigitsDisplayed)
+   {
+     Dimension currentDim = s.bestLattice().dimension();
+     Dimension totalDim = s.dimension();
+      unsigned int old_precision = (unsigned int) std::cout.precision();
+      if (meritDigitsDisplayed){
+        std::cout.precision(meritDigitsDisplayed);
+      }
+      std::string lattice;
+      if (s.minObserver().totalCount() == 1){
+        lattice = " lattice";
+      }
+      else{
+        lattice = " lattices";
+      }
+      
+       std::cout << "End coordinate: " << currentDim << "/" << totalDim << " - "
+       << s.minObserver().totalCount() << lattice  << " explored (" << s.minObserver().acceptedCount() << " accepted)"
+       << " - partial merit value: " << s.bestMeritValue() << std::endl;
+     
+      if (meritDigitsDisplayed){
+        std::cout.precision(old_precision);
+      }
+      if (currentDim < totalDim){
+        std::cout << "Begin coordinate " << currentDim+1 << "/" << totalDim << std::endl;
+      }
+   }
+
+/**
+ * Writes the estimates of the resources of the search of \c cmd with
+ * embedding type \c embedding, without executing it (see DryRun).
+ */
+template <LatticeType LR>
+void writeDryRun(const Parser::CommandLine<LR, EmbeddingType::MULTILEVEL>& cmd, EmbeddingType embedding, const ExecuteOptions& options)
+{
+   const unsigned int numThreads = ThreadPool::global().size();
+   if (embedding == EmbeddingType::UNILEVEL)
+      DryRun::write(std::cout, DryRun::estimate<LR, EmbeddingType::UNILEVEL>(cmd, numThreads, options.repeat));
+   else
+      DryRun::write(std::cout, DryRun::estimate<LR, EmbeddingType::MULTILEVEL>(cmd, numThreads, options.repeat));
+}
+
+/**
+ * Writes the peak memory of each component (see Memory) at the verbosity
+ * level 1 and above.
+ */
+inline void writePeakMemory(int verbose)
+{
+   if (verbose < 1)
+      return;
+   std::cout << "Peak memory:" << std::endl;
+   Memory::writePeaks(std::cout);
+   std::cout << std::endl;
+}
+
+template <class GENERATOR>
+void writePointsFile(const GENERATOR& generator, const std::string& fileName, PointFormat format)
+{
+   std::ofstream outFile(fileName, std::ios::binary);
+   if (!outFile)
+      throw std::runtime_error("cannot open " + fileName);
+   writePoints(generator, outFile, format);
+   std::cout << "Points written to: " << fileName << std::endl << std::endl;
+}
+
+template <LatticeType LR, EmbeddingType ET>
+void setCheckpoint(Task::Search<LR, ET>& search, const std::string& outputFolder, bool resume)
+{
+   if (outputFolder == "")
+      return;
+   const std::string fileName = outputFolder + "/checkpoint.txt";
+   if (resume){
+      search.resumeFrom(fileName);
+      std::cout << "Resuming from checkpoint: " << fileName << std::endl;
+   }
+   search.setCheckpointFile(fileName);
+}
+
+/// Writes the best lattice of the shard of the process to shard.txt in \c outputFolder (see Shard).
+template <LatticeType LR, EmbeddingType ET>
+void writeShardResult(const Task::Search<LR, ET>& search, const std::string& outputFolder)
+{
+   if (outputFolder == "" || !Shard::active())
+      return;
+   Shard::Result result;
+   result.index = Shard::index();
+   result.count = Shard::count();
+   result.merit = search.bestMeritValue();
+   for (const auto& gen : search.bestLattice().gen())
+      result.genValues.push_back(Task::detail::formatCheckpointValue(gen));
+   result.write(outputFolder + "/shard.txt");
+}
+
+template <LatticeType LR, EmbeddingType ET>
+std::unique_ptr<Task::Search<LR, ET>> executeParallelRepeats(const Parser::CommandLine<LR, ET>& cmd, std::unique_ptr<Task::Search<LR, ET>> first, unsigned int repeat)
+{
+   typedef Task::Search<LR, ET> Search;
+
+   // the first search was constructed with the default seed, that is, stream 0
+   ParallelRepeats repeats(repeat);
+   auto best = repeats.execute<Search>(
+         [&](unsigned int run)
+         {
+            auto search = run == 0 ? std::move(first) : cmd.parse();
+            search->execute();
+            return search;
+         },
+         [](const Search& search) { return search.bestMeritValue(); });
+
+   std::cout << std::endl;
+   std::cout << "====================\n      Summary\n====================\n" << repeats;
+   return best;
+}
+
+}
+
+#endif
@@ -0,0 +1,149 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Cooperative cancellation and progress of the tasks executed asynchronously.
+ */
+
+#ifndef LATBUILDER__EXECUTION_H
+#define LATBUILDER__EXECUTION_H
+
+#include "latbuilder/Types.h"
+
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+namespace LatBuilder
+{
+
+/**
+ * Exception thrown by the searches whose execution is cancelled.
+ */
+class Cancelled : public std::runtime_error {
+public:
+   Cancelled():
+      std::runtime_error("the task was cancelled")
+   {}
+};
+
+/**
+ * Cancellation flag and progress of the execution of a task (see AsyncTask).
+ *
+ * The thread which executes the task declares it with a Scope.  The shares of
+ * the budget given to the task from that thread (see Budget::share()) are then
+ * exhausted as soon as the execution is cancelled, so that the explorations
+ * and the evaluation loops stop at their next check of the budget, whichever
+ * worker of the thread pool runs them, and Budget::share() throws Cancelled,
+ * so that the component-by-component searches do not start another
+ * coordinate.  The checkpoints and the state files of a cancelled search are
+ * not written (see check()).
+ *
+ * The progress is made of the number of coordinates and the merit value of
+ * the best point set selected so far, reported with select() by the signals
+ * of the task, and of the number of candidates evaluated since the execution
+ * started, counted by Budget::count().  The counts of the tasks executed
+ * concurrently are thus added together.
+ */
+class Execution {
+public:
+   /// Progress of an execution.
+   struct Progress {
+      /// Number of coordinates of the best point set selected so far.
+      Dimension coordinate = 0;
+
+      /// Number of candidates evaluated since the execution started.
+      unsigned long long count = 0;
+
+      /// Merit value of the best point set selected so far.
+      Real bestMerit = std::numeric_limits<Real>::infinity();
+   };
+
+   /**
+    * Declares that the calling thread executes \c execution until the end
+    * of the scope.
+    */
+   class Scope {
+   public:
+      explicit Scope(Execution& execution);
+      ~Scope();
+
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+   private:
+      Execution* m_previous;
+   };
+
+   Execution();
+
+   Execution(const Execution&) = delete;
+   Execution& operator=(const Execution&) = delete;
+
+   /**
+    * Requests the cancellation of the execution.  Can be called from any
+    * thread.
+    */
+   void cancel()
+   { m_cancelled.store(true, std::memory_order_relaxed); }
+
+   /**
+    * Returns \c true if the cancellation of the execution was requested.
+    */
+   bool cancelled() const
+   { return m_cancelled.load(std::memory_order_relaxed); }
+
+   /**
+    * Returns the cancellation flag, polled by the shares of the budget.
+    */
+   const std::atomic<bool>& cancelFlag() const
+   { return m_cancelled; }
+
+   /**
+    * Reports that the task selected a point set of \c coordinate coordinates
+    * and of merit value \c merit.
+    */
+   void select(Dimension coordinate, Real merit);
+
+   /**
+    * Returns the progress of the execution.  Can be called from any thread.
+    */
+   Progress progress() const;
+
+   /**
+    * Returns the execution of the calling thread, or \c nullptr.
+    */
+   static Execution* current();
+
+   /**
+    * Throws Cancelled if the execution of the calling thread is cancelled.
+    */
+   static void check();
+
+private:
+   std::atomic<bool> m_cancelled;
+   unsigned long long m_firstEvaluation;
+   mutable std::mutex m_mutex;
+   Dimension m_coordinate;
+   Real m_bestMerit;
+};
+
+}
+
+#endif
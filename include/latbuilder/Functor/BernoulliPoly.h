@@ -18,6 +18,7 @@
 #define LATBUILDER__FUNCTOR__BERNOULLI_POLY_H
 
 #include "latbuilder/Types.h"
+#include "latbuilder/CpuDispatch.h"
 
 namespace LatBuilder { namespace Functor {
 
@@ -68,6 +69,22 @@ DEFINE_BERNOULLI_POLY(8, ((((x - 4.0) * x + (14.0 / 3.0)) * x * x - (7.0 / 3.0))
 
 #undef DEFINE_BERNOULLI_POLY
 
+/**
+ * Evaluates \c scaling times the Bernoulli polynomial of degree \c DEGREE at
+ * the \c n values pointed to by \c x, and stores the results in \c values.
+ *
+ * The loop has neither branches nor indirect calls, so that it is vectorized
+ * by the compiler, for each of the instruction sets selected at run time (see
+ * LATNETBUILDER_TARGET_CLONES).
+ */
+template <unsigned int DEGREE>
+LATNETBUILDER_TARGET_CLONES
+void applyBernoulliPoly(const Real* x, Real* values, size_t n, Real scaling)
+{
+   for (size_t i = 0; i < n; i++)
+      values[i] = scaling * BernoulliPoly<DEGREE>::apply(x[i]);
+}
+
 }}
 
 #endif
@@ -84,6 +84,20 @@ public:
       }
    }
 
+   /**
+    * Evaluates the one-dimensional function at the \c n values pointed to by
+    * \c x, and stores the results in \c values.
+    */
+   template <typename MODULUS>
+   void apply(const value_type* x, result_type* values, size_t n, const MODULUS&) const
+   {
+      // the power of two is computed exactly from the exponent of x
+      const result_type c = intPow(2.0, m_min) - 1.0;
+      const int factor = (int) m_min - 1;
+      for (size_t i = 0; i < n; i++)
+         values[i] = (x[i] < std::numeric_limits<double>::epsilon()) ? 1.0 / m_denom : (1.0 - std::ldexp(c, factor * std::ilogb(x[i]))) / m_denom;
+   }
+
    std::string name() const
    { std::ostringstream os; os << "IA - alpha: " << alpha() << " - interlacing: " << interlacingFactor() ; return os.str(); }
 
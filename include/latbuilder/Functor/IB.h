@@ -75,6 +75,20 @@ public:
       }
    }
 
+   /**
+    * Evaluates the one-dimensional function at the \c n values pointed to by
+    * \c x, and stores the results in \c values.
+    */
+   template <typename MODULUS>
+   void apply(const value_type* x, result_type* values, size_t n, const MODULUS&) const
+   {
+      // the power of two is computed exactly from the exponent of x
+      const result_type c = intPow(2.0, m_interlacingFactor) - 1.0;
+      const int factor = (int) m_interlacingFactor - 1;
+      for (size_t i = 0; i < n; i++)
+         values[i] = (x[i] < std::numeric_limits<double>::epsilon()) ? m_factor : m_factor * (1.0 - std::ldexp(c, factor * std::ilogb(x[i])));
+   }
+
    std::string name() const
    { std::ostringstream os; os << "IB" << " - interlacing: " << interlacingFactor() ; return os.str(); }
 
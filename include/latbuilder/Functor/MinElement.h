@@ -18,13 +18,42 @@
 #define LATBUILDER__FUNCTOR__MIN_ELEMENT
 
 #include "latbuilder/Functor/AllOf.h"
+#include "latbuilder/BridgeIteratorCached.h"
+#include "latbuilder/ThreadPool.h"
 
 #include <limits>
+#include <type_traits>
+#include <vector>
 #include <boost/signals2.hpp>
 #include <iostream>
 
 namespace LatBuilder { namespace Functor {
 
+namespace detail {
+   /**
+    * Whether the elements of the sequence \c SEQ can be computed concurrently,
+    * as stated by the static member \c SEQ::concurrentElements.
+    */
+   template <class SEQ, class = void>
+   struct ConcurrentElements : std::false_type {};
+
+   template <class SEQ>
+   struct ConcurrentElements<SEQ, decltype(void(SEQ::concurrentElements))> :
+      std::integral_constant<bool, SEQ::concurrentElements> {};
+
+   /**
+    * Whether the iterator \c IT, of a bridge sequence such as
+    * MeritFilterList::Seq, points to a base sequence whose elements can be
+    * computed concurrently.
+    */
+   template <class IT>
+   struct ConcurrentBase : std::false_type {};
+
+   template <class SEQ>
+   struct ConcurrentBase<BridgeIteratorCached<SEQ>> :
+      ConcurrentElements<typename SEQ::Base> {};
+}
+
 /**
  * Minimum element functor.
  *
@@ -59,6 +88,17 @@ public:
     */
    template <typename ForwardIterator>
    ForwardIterator operator()(ForwardIterator first, ForwardIterator last, size_t maxAcceptedCount, int verbose = 0) const
+   {
+      return find(first, last, maxAcceptedCount, verbose,
+            std::integral_constant<bool, detail::ConcurrentBase<ForwardIterator>::value>());
+   }
+
+private:
+   /**
+    * Finds the minimum element serially.
+    */
+   template <typename ForwardIterator>
+   ForwardIterator find(ForwardIterator first, ForwardIterator last, size_t maxAcceptedCount, int verbose, std::false_type) const
    {
       if (maxAcceptedCount == std::numeric_limits<size_t>::max()){
         onStart()( std::distance(first, last));
@@ -115,6 +155,70 @@ public:
       return itmin;
    }
 
+   /**
+    * Finds the minimum element, computing the elements of the base sequence
+    * concurrently with the shared thread pool if it has more than one worker.
+    *
+    * The base merit values are computed by blocks of a few elements per
+    * worker, then the block is visited in order as by the serial search: the
+    * filters are applied and the signals are emitted in the calling thread,
+    * so that the minimum found is the first one in the sequence and the
+    * search stops at the same element.  The evaluations of a block only see
+    * the minimum found before the block, which can only let more of them run
+    * to completion than in the serial search.
+    */
+   template <typename ForwardIterator>
+   ForwardIterator find(ForwardIterator first, ForwardIterator last, size_t maxAcceptedCount, int verbose, std::true_type) const
+   {
+      ThreadPool& pool = ThreadPool::global();
+      if (pool.size() <= 1)
+         return find(first, last, maxAcceptedCount, verbose, std::false_type());
+
+      onStart()(maxAcceptedCount == std::numeric_limits<size_t>::max() ? static_cast<size_t>(std::distance(first, last)) : maxAcceptedCount);
+
+      const size_t blockSize = 4 * static_cast<size_t>(pool.size());
+      std::vector<ForwardIterator> block;
+      block.reserve(blockSize);
+
+      bool found = false;
+      T min = T();
+      ForwardIterator itmin = last;
+
+      while (first != last) {
+         block.clear();
+         for (; first != last and block.size() < blockSize; ++first)
+            block.push_back(first);
+
+         // the base iterators cache their values
+         pool.parallelFor(block.size(), [&](unsigned int, size_t i) { *block[i].base(); });
+
+         for (const auto& it : block) {
+            const bool updated = !found or *it < min;
+            if (updated) {
+               found = true;
+               min = *it;
+               itmin = it;
+               this->onMinUpdated()(min);
+            }
+
+            if (verbose > 0){
+               std::cout << "Current merit: " << *it << (updated ? " (best)" : " (rejected)") << " with lattice:" << std::endl;
+               std::cout << *it.base().base() << std::endl;
+            }
+
+            if (!onElementVisited()(*it)) {
+               onStop()();
+               return itmin;
+            }
+         }
+      }
+
+      onStop()();
+
+      return itmin;
+   }
+
+public:
    /**
     * Start signal.
     *
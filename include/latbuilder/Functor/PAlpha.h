@@ -83,6 +83,21 @@ public:
    result_type operator()(const value_type& x, uInteger n = 0) const
    { return m_scaling * m_bernoulli(x); }
 
+   /**
+    * Evaluates the one-dimensional function at the \c n values pointed to by
+    * \c x, and stores the results in \c values.
+    */
+   template <typename MODULUS>
+   void apply(const value_type* x, result_type* values, size_t n, const MODULUS&) const
+   {
+      switch (m_alpha) {
+         case 2: applyBernoulliPoly<2>(x, values, n, m_scaling); break;
+         case 4: applyBernoulliPoly<4>(x, values, n, m_scaling); break;
+         case 6: applyBernoulliPoly<6>(x, values, n, m_scaling); break;
+         case 8: applyBernoulliPoly<8>(x, values, n, m_scaling); break;
+      }
+   }
+
    std::string name() const
    { std::ostringstream os; os << "P" << alpha(); return os.str(); }
 
@@ -69,6 +69,20 @@ public:
    result_type operator()(const value_type& x, unsigned long) const
    { return m_mu - std::pow(  (Real)(2), (1+ std::floor(std::log2(x)))*(m_alpha-1)  )*( 1 + m_mu) ;}
 
+   /**
+    * Evaluates the one-dimensional function at the \c n values pointed to by
+    * \c x, and stores the results in \c values.
+    */
+   template <typename MODULUS>
+   void apply(const value_type* x, result_type* values, size_t n, const MODULUS&) const
+   {
+      // 2^((1 + floor(log2(x))) (alpha - 1)) is computed exactly from the exponent of x
+      const int factor = (int) m_alpha - 1;
+      const result_type scaling = 1 + m_mu;
+      for (size_t i = 0; i < n; i++)
+         values[i] = x[i] > 0 ? m_mu - std::ldexp(scaling, (1 + std::ilogb(x[i])) * factor) : m_mu;
+   }
+
    std::string name() const
    { std::ostringstream os; os << "P" << alpha() << "_PLR"; return os.str(); }
 
@@ -78,6 +78,18 @@ public:
     return (x < std::numeric_limits<double>::epsilon()) ? (1 + m/2.0) : (-std::floor(std::log2(x))/2.0) ;
   }
 
+   /**
+    * Evaluates the one-dimensional function at the \c n values pointed to by
+    * \c x, and stores the results in \c values.
+    */
+   template <typename MODULUS>
+   void apply(const value_type* x, result_type* values, size_t n, const MODULUS& modulus) const
+   {
+      const result_type zeroValue = (*this)(0.0, modulus);
+      for (size_t i = 0; i < n; i++)
+         values[i] = (x[i] < std::numeric_limits<double>::epsilon()) ? zeroValue : -std::ilogb(x[i]) / 2.0;
+   }
+
    std::string name() const
    { std::ostringstream os; os << "R-PLR"; return os.str(); }
 
@@ -157,6 +157,17 @@ public:
     */
    value_type operator[](size_type i) const;
 
+   /**
+    * Calls \c f(i, x) for the elements \c x of indices \c i from \c first to
+    * \c last - 1, in increasing order.
+    *
+    * Only the first element is computed by modular exponentiation; the next
+    * ones are obtained by successive multiplications by the generator, so that
+    * distinct ranges can be enumerated concurrently.
+    */
+   template <class F>
+   void forEachElement(size_type first, size_type last, F&& f) const;
+
    /**
     * Returns the group generated by the inverse generator.
     */
@@ -177,11 +188,17 @@ public:
     * \param checkPrime    If \c true, checks if the base is actually prime.
     *
     * The algorithm is described in \cite mCOH93a .
+    *
+    * The generators found with \c checkPrime set to \c true are cached, so
+    * that the groups of the same base are constructed without factoring
+    * \f$b-1\f$ again.
     */
    static value_type smallestGenerator(Modulus base, Level power, bool checkPrime = true);
 
 
 private:
+   static value_type findSmallestGenerator(Modulus base, Level power, bool checkPrime);
+
    template <LatticeType, LatBuilder::Compress, class, GroupOrder> friend class CyclicGroup;
 
    /**
@@ -212,6 +229,10 @@ private:
 #include "latbuilder/Util.h"
 #include "latticetester/IntFactor.h"
 
+#include <map>
+#include <mutex>
+#include <utility>
+
 namespace LatBuilder { namespace GenSeq {
 
 //================================================================================
@@ -219,6 +240,31 @@ namespace LatBuilder { namespace GenSeq {
 template < Compress COMPRESS, class TRAV, GroupOrder ORDER>
 typename CyclicGroup<LatticeType::ORDINARY,COMPRESS, TRAV, ORDER>::value_type 
 CyclicGroup<LatticeType::ORDINARY,COMPRESS, TRAV, ORDER>::smallestGenerator(Modulus base, Level power, bool checkPrime) 
+{
+   if (not checkPrime)
+      return findSmallestGenerator(base, power, false);
+
+   // the generator depends on the power only through whether it is 1
+   static std::mutex mutex;
+   static std::map<std::pair<Modulus, bool>, value_type> cache;
+   const auto key = std::make_pair(base, power == 1);
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      const auto it = cache.find(key);
+      if (it != cache.end())
+         return it->second;
+   }
+   const value_type g = findSmallestGenerator(base, power, true);
+   std::lock_guard<std::mutex> lock(mutex);
+   cache.emplace(key, g);
+   return g;
+}
+
+//================================================================================
+
+template < Compress COMPRESS, class TRAV, GroupOrder ORDER>
+typename CyclicGroup<LatticeType::ORDINARY,COMPRESS, TRAV, ORDER>::value_type 
+CyclicGroup<LatticeType::ORDINARY,COMPRESS, TRAV, ORDER>::findSmallestGenerator(Modulus base, Level power, bool checkPrime) 
 {
    if (base == 2) {
       return 5;
@@ -329,6 +375,30 @@ auto CyclicGroup<LatticeType::ORDINARY, COMPRESS, TRAV, ORDER>::operator[](size_
    return Compress::compressIndex(k, m);
 }
 
+//================================================================================
+
+template <Compress COMPRESS, class TRAV, GroupOrder ORDER>
+template <class F>
+void CyclicGroup<LatticeType::ORDINARY, COMPRESS, TRAV, ORDER>::forEachElement(size_type first, size_type last, F&& f) const
+{
+   if (first >= last)
+      return;
+
+   const auto m = modulus();
+   const size_type half = size() / 2;
+   value_type k = first == 0 ? 1 : modularPow(generator(), first, m);
+
+   for (size_type i = first; i < last; i++) {
+      if (i == 0)
+         f(i, value_type(1));
+      else if (base() == 2 and i >= half)
+         f(i, Compress::compressIndex(k * (m - 1) % m, m));
+      else
+         f(i, Compress::compressIndex(k, m));
+      k = k * generator() % m;
+   }
+}
+
 }} // namespace
 
 #endif
\ No newline at end of file
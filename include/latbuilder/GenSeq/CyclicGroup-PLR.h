@@ -18,6 +18,7 @@
 #define LATBUILDER__GENSEQ__CYCLIC_GROUP_PLR_H
 
 #include "latbuilder/GenSeq/CyclicGroup.h"
+#include "latbuilder/PolynomialWord.h"
 
 
 
@@ -30,8 +31,13 @@ namespace LatBuilder { namespace GenSeq {
     typedef LatticeTraits<LatticeType::POLYNOMIAL>::Modulus Modulus;
       static void increment(value_type& currentValue, size_type& index, const value_type& generator, const Modulus& modulus, const size_type& size){
       index ++;
-      currentValue = (currentValue * generator) % modulus ;
-      
+      if (PolynomialWordModulus::fits(modulus) and deg(generator) < deg(modulus) and deg(currentValue) < deg(modulus)) {
+         const PolynomialWordModulus& wordModulus = PolynomialWordModulus::cached(modulus);
+         fromPolynomialWord(currentValue, wordModulus.multiply(toPolynomialWord(currentValue), toPolynomialWord(generator)));
+      }
+      else {
+         currentValue = (currentValue * generator) % modulus ;
+      }
       }
   };
 
@@ -154,6 +160,17 @@ public:
     */
    value_type operator[](size_type i) const;
 
+   /**
+    * Calls \c f(i, x) for the elements \c x of indices \c i from \c first to
+    * \c last - 1, in increasing order.
+    *
+    * Only the first element is computed by modular exponentiation; the next
+    * ones are obtained by successive multiplications by the generator, so that
+    * distinct ranges can be enumerated concurrently.
+    */
+   template <class F>
+   void forEachElement(size_type first, size_type last, F&& f) const;
+
    /**
     * Returns the group generated by the inverse generator.
     */
@@ -174,11 +191,17 @@ public:
     * \param checkPrime    If \c true, checks if the base is actually prime.
     *
     * \remark Recall that  \f$m\f$ must be set to 1.
+    *
+    * The generators found with \c checkPrime set to \c true are cached, so
+    * that the groups of the same base are constructed without factoring
+    * \f$2^{\deg(b)}-1\f$ again.
     */
    static value_type smallestGenerator(Modulus base, Level power, bool checkPrime = true);
 
 
 private:
+   static value_type findSmallestGenerator(Modulus base, Level power, bool checkPrime);
+
    template <LatticeType, LatBuilder::Compress, class, GroupOrder> friend class CyclicGroup;
 
    /**
@@ -210,6 +233,10 @@ private:
 // #include "latticetester/IntFactor.h"
 #include <NTL/GF2XFactoring.h>
 
+#include <mutex>
+#include <utility>
+#include <vector>
+
 namespace LatBuilder { namespace GenSeq {
 
 //================================================================================
@@ -217,6 +244,31 @@ namespace LatBuilder { namespace GenSeq {
 template < Compress COMPRESS, class TRAV, GroupOrder ORDER>
 typename CyclicGroup<LatticeType::POLYNOMIAL,COMPRESS, TRAV, ORDER>::value_type 
 CyclicGroup<LatticeType::POLYNOMIAL,COMPRESS, TRAV, ORDER>::smallestGenerator(Modulus base, Level power, bool checkPrime)
+{
+   if (not checkPrime or power != 1)
+      return findSmallestGenerator(base, power, checkPrime);
+
+   // few distinct bases are used in a run, so a linear search is enough
+   static std::mutex mutex;
+   static std::vector<std::pair<Modulus, value_type>> cache;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (const auto& entry : cache) {
+         if (entry.first == base)
+            return entry.second;
+      }
+   }
+   const value_type g = findSmallestGenerator(base, power, true);
+   std::lock_guard<std::mutex> lock(mutex);
+   cache.emplace_back(base, g);
+   return g;
+}
+
+//================================================================================
+
+template < Compress COMPRESS, class TRAV, GroupOrder ORDER>
+typename CyclicGroup<LatticeType::POLYNOMIAL,COMPRESS, TRAV, ORDER>::value_type 
+CyclicGroup<LatticeType::POLYNOMIAL,COMPRESS, TRAV, ORDER>::findSmallestGenerator(Modulus base, Level power, bool checkPrime)
 {
    if (IsZero(base))
       throw std::invalid_argument("smallestGenerator(): base must be non zero");
@@ -312,6 +364,27 @@ auto CyclicGroup<LatticeType::POLYNOMIAL, COMPRESS, TRAV, ORDER>::operator[](siz
    return Compress::compressIndex(k, m);
 }
 
+//================================================================================
+
+template <Compress COMPRESS, class TRAV, GroupOrder ORDER>
+template <class F>
+void CyclicGroup<LatticeType::POLYNOMIAL, COMPRESS, TRAV, ORDER>::forEachElement(size_type first, size_type last, F&& f) const
+{
+   if (first >= last)
+      return;
+
+   const auto m = modulus();
+   value_type k = modularPow(generator(), first, m);
+
+   for (size_type i = first; i < last; i++) {
+      f(i, Compress::compressIndex(k, m));
+      if (i + 1 < last) {
+         size_type index = i;
+         CyclicGroupTraversalTraits<CyclicGroupTraversal<LatticeType::POLYNOMIAL>>::increment(k, index, generator(), m, size());
+      }
+   }
+}
+
 }} // namespace
 
 #endif
\ No newline at end of file
@@ -214,6 +214,16 @@ namespace LatBuilder { namespace Traversal {
       const_iterator end() const
       { return const_iterator(seq(), std::min(this->size(), (size_type)seq().size())); }
 
+      /**
+       * Returns \c k copies of \c seq with forward traversals of consecutive
+       * ranges that together cover the traversal of \c seq (see
+       * Policy<SEQ, Forward>::split()).  The elements of the parts are computed
+       * by index instead of by successive multiplications by the generator.
+       */
+      template <class S = Seq>
+      std::vector<typename S::template RebindTraversal<Forward>::Type> split(size_type k) const
+      { return seq().rebind(Forward(0, std::min(this->size(), (size_type)seq().size()))).split(k); }
+
    private:
       const Seq& seq() const
       { return static_cast<const Seq&>(*this); }
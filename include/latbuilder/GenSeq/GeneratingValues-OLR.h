@@ -22,6 +22,7 @@
 
 
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 #include <limits>
 
@@ -175,7 +176,22 @@ public:
     */
    value_type operator[](size_type i) const;
 
+   /**
+    * Returns the index of the element \c value, that is, the index \f$i\f$
+    * such that <tt>(*this)[i] == value</tt>.
+    *
+    * The digits of the index are obtained from the residues of \c value
+    * modulo the prime powers \f$n_j\f$, in time proportional to the number of
+    * prime factors of the modulus.
+    *
+    * \throws std::invalid_argument If \c value is not coprime with the modulus.
+    */
+   size_type indexOf(value_type value) const;
+
 private:
+   // index of value in the sequence without compression
+   size_type fullIndexOf(value_type value) const;
+
    template <LatBuilder::LatticeType,LatBuilder::Compress , class > friend class GeneratingValues;
 
    Modulus m_modulus;
@@ -230,6 +246,33 @@ auto GeneratingValues<LatticeType::ORDINARY, COMPRESS, TRAV>::operator[](size_ty
    return Compress::compressIndex(ret % modulus(), modulus());
 }
 
+template <Compress COMPRESS, class TRAV>
+auto GeneratingValues<LatticeType::ORDINARY, COMPRESS, TRAV>::fullIndexOf(value_type value) const -> size_type
+{
+   size_type index = 0;
+   size_type stride = 1;
+   for (const auto& e : m_basis) {
+      const auto base = e.leap + 1;
+      const auto k = value % (e.totient / e.leap * base);
+      if (k % base == 0)
+         throw std::invalid_argument("indexOf(): value must be coprime with the modulus");
+      index += (k - k / base - 1) * stride;
+      stride *= e.totient;
+   }
+   return index;
+}
+
+template <Compress COMPRESS, class TRAV>
+auto GeneratingValues<LatticeType::ORDINARY, COMPRESS, TRAV>::indexOf(value_type value) const -> size_type
+{
+   value %= modulus();
+   const size_type index = fullIndexOf(value);
+   // with symmetric compression, either value or modulus() - value is in the first half
+   if (index < size() or modulus() <= 2)
+      return index;
+   return fullIndexOf(modulus() - value);
+}
+
 }}
 
 #endif
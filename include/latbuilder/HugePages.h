@@ -0,0 +1,126 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Allocation of the large vectors on huge pages.
+ */
+
+#ifndef LATBUILDER__HUGE_PAGES_H
+#define LATBUILDER__HUGE_PAGES_H
+
+#include <cstddef>
+#include <new>
+
+namespace LatBuilder
+{
+
+/**
+ * Allocation policy of the large vectors: the state vectors, the kernel values
+ * and the FFT buffers of the constructions for large numbers of points, which
+ * take hundreds of megabytes each and are traversed as a whole for each
+ * candidate, so that with the default 4 KiB pages most of their pages miss
+ * the TLB.
+ *
+ * The allocations of at least #threshold bytes are aligned on #alignment, the
+ * usual size of huge pages, and on Linux they are marked with
+ * <tt>madvise(MADV_HUGEPAGE)</tt>, so that the kernel backs them with
+ * transparent huge pages even when those are only enabled on request (the \c
+ * madvise mode of <tt>/sys/kernel/mm/transparent_hugepage/enabled</tt>).
+ * The smaller allocations are left to the global operator new.  The
+ * allocations of at least #threshold bytes are charged to the components of
+ * Memory.
+ *
+ * The pages of a vector are placed on the NUMA node of the thread which first
+ * writes them.  With the workers of the ThreadPool pinned to their processors
+ * (see ThreadPool::setPinning()), the vectors filled by parallel loops are thus
+ * spread over the nodes of the workers; the placement of the whole process can
+ * otherwise be chosen with <tt>numactl</tt>, e.g. <tt>numactl
+ * --interleave=all</tt>.
+ */
+class HugePages {
+public:
+   /// Minimum size, in bytes, of the allocations placed on huge pages.
+   static constexpr size_t threshold = size_t(1) << 22;
+
+   /// Alignment, in bytes, of the allocations placed on huge pages.
+   static constexpr size_t alignment = size_t(1) << 21;
+
+   /**
+    * Sets whether the allocations of at least #threshold bytes are marked for
+    * huge pages, which is the case by default.  They are aligned on
+    * #alignment in any case.
+    */
+   static void setEnabled(bool enabled);
+
+   /**
+    * Returns \c true if the large allocations are marked for huge pages.
+    */
+   static bool enabled();
+
+   /**
+    * Allocates \c bytes bytes.
+    * Throws \c std::bad_alloc if the memory cannot be allocated.
+    */
+   static void* allocate(size_t bytes);
+
+   /**
+    * Frees the memory at \c p allocated by allocate() with the same size \c
+    * bytes.
+    */
+   static void deallocate(void* p, size_t bytes) noexcept;
+
+   /**
+    * STL allocator of the large vectors, allocating with HugePages::allocate().
+    */
+   template <typename Tp>
+   class Allocator
+   {
+   public:
+      typedef size_t     size_type;
+      typedef ptrdiff_t  difference_type;
+      typedef Tp*        pointer;
+      typedef const Tp*  const_pointer;
+      typedef Tp&        reference;
+      typedef const Tp&  const_reference;
+      typedef Tp         value_type;
+
+      template<typename Tp1> struct rebind { typedef Allocator<Tp1> other; };
+
+      Allocator() throw() { }
+      Allocator(const Allocator&) throw() { }
+      template<typename Tp1> Allocator(const Allocator<Tp1>&) throw() { }
+      ~Allocator() throw() { }
+
+      pointer allocate(size_type n, const void* = 0)
+      { return static_cast<Tp*>(HugePages::allocate(n * sizeof(Tp))); }
+
+      void deallocate(pointer p, size_type n) { HugePages::deallocate(p, n * sizeof(Tp)); }
+
+      constexpr size_type max_size() const throw() { return size_t(-1) / sizeof(Tp); }
+
+      void construct(pointer p) { ::new((void *)p) Tp(); }
+      void construct(pointer p, const Tp& val) { ::new((void *)p) Tp(val); }
+      void destroy(pointer p) { p->~Tp(); }
+
+      bool operator==(const Allocator&) const throw() { return true; }
+      bool operator!=(const Allocator&) const throw() { return false; }
+   };
+};
+
+}
+
+#endif
@@ -20,6 +20,8 @@
 #include <boost/iterator/iterator_facade.hpp>
 #include <latbuilder/UniformUIntDistribution.h>
 
+#include <array>
+
 namespace LatBuilder {
 
 /**
@@ -79,6 +81,12 @@ private:
    void increment()
    { ++m_index; updateValue(); }
 
+   void decrement()
+   { --m_index; updateValue(); }
+
+   void advance(ptrdiff_t n)
+   { m_index += n; updateValue(); }
+
    bool equal(const Forward& other) const
    { return m_seq == other.m_seq and index() == other.index(); }
 
@@ -98,9 +106,13 @@ private:
 /**
  * Immutable random indexed iterator.
  *
+ * The random indices are drawn by batches of #BATCH_SIZE (see
+ * UniformUIntDistribution), in the same order as one at a time.
+ *
  * \tparam SEQ Type of sequence to which the iterator points.  Must implement
  *             value_type operator[](SEQ::size_type).
- * \tparam RAND     Random generator type.
+ * \tparam RAND     Random generator type.  Must implement
+ *             <code>void fill(result_type* out, size_t n)</code>.
  */
 template <typename SEQ, typename RAND>
 class Random : public boost::iterators::iterator_facade<
@@ -114,6 +126,11 @@ public:
    typedef typename Seq::size_type size_type;
    typedef RAND RandomGenerator;
 
+   /**
+    * Number of random indices drawn at once.
+    */
+   static constexpr size_t BATCH_SIZE = 32;
+
    struct end_tag {};
 
    explicit Random(
@@ -124,7 +141,8 @@ public:
       m_count(0),
       m_index(0),
       m_unif(0, m_seq->size() - 1),
-      m_rand(std::move(rand))
+      m_rand(std::move(rand)),
+      m_next(BATCH_SIZE)
    { increment(); }
 
       // this constructor should not be used
@@ -132,7 +150,8 @@ public:
       Random::iterator_facade_(),
       m_seq(&seq),
       m_count(end + 1),
-      m_index(0)
+      m_index(0),
+      m_next(BATCH_SIZE)
    { }
 
       // this constructor should not be used
@@ -140,7 +159,8 @@ public:
       Random::iterator_facade_(),
       m_seq(nullptr),
       m_count(0),
-      m_index(0)
+      m_index(0),
+      m_next(BATCH_SIZE)
    { }
 
    /**
@@ -163,7 +183,15 @@ private:
    { m_value = index() < seq().size() ? seq()[index()] : value_type(); }
 
    void increment()
-   { ++m_count; m_index = m_unif(m_rand); updateValue(); }
+   {
+      if (m_next == BATCH_SIZE) {
+         m_unif(m_rand, m_indices.data(), BATCH_SIZE);
+         m_next = 0;
+      }
+      ++m_count;
+      m_index = m_indices[m_next++];
+      updateValue();
+   }
 
    bool equal(const Random& other) const
    { return m_seq == other.m_seq and m_count == other.m_count; }
@@ -181,6 +209,8 @@ private:
    size_type m_index;
    UniformUIntDistribution<size_type, RandomGenerator> m_unif;
    RandomGenerator m_rand;
+   std::array<size_type, BATCH_SIZE> m_indices;
+   size_t m_next;
    value_type m_value;
 };
 
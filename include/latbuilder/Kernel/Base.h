@@ -18,11 +18,29 @@
 #define LATBUILDER__KERNEL__BASE_H
 
 #include "latbuilder/Storage.h"
+#include "latbuilder/Kernel/ValueCache.h"
+#include "latbuilder/Kernel/OnTheFly.h"
 
 #include <boost/numeric/ublas/vector.hpp>
 
+#include <functional>
+#include <sstream>
+#include <typeinfo>
+
 namespace LatBuilder { namespace Kernel {
 
+/**
+ * Function computing kernel values on the fly, returned by
+ * Base::stridedValues().
+ *
+ * Called as <code>values(stride, first, last, out)</code>, it stores in
+ * <code>out[0], ..., out[last - first - 1]</code> the elements \c first to \c
+ * last - 1 of <code>storage.strided(kernel.valuesVector(storage),
+ * stride)</code>.
+ */
+template <LatticeType LR>
+using StridedValues = std::function<void(const typename LatticeTraits<LR>::GenValue&, size_t, size_t, Real*)>;
+
 /**
  * Base base class for factories of kernel values.
  */
@@ -41,13 +59,46 @@ public:
     *- \f$\omega(i/n)\f$ in the case of an ordinary lattice with modulus \f$n\f$.
     *-  \f$\omega((\nu_m(\frac{i(z)}{P(z)}))\f$ in the case of a polynomial lattice of modulus \f$P(z)\f$ (\f$ i(z) = \sum a_iz^i\f$ where \f$i =\sum a_i2^i\f$).
     *
+    * The vectors are shared through ValueCache by all kernels with the same
+    * type and key (see key()) applied to storages of the same type and size
+    * parameter.
+    *
     * \return The newly created vector.
     */
    template <LatticeType LR, EmbeddingType L, Compress C, PerLevelOrder P > 
    RealVector valuesVector(
          const Storage<LR, L, C, P>& storage
          ) const
-   { return derived().valuesVector(storage); }
+   {
+      std::ostringstream key;
+      key << typeid(DERIVED).name() << ':' << derived().key() << ':'
+         << typeid(Storage<LR, L, C, P>).name() << ':' << storage.sizeParam() << ':' << storage.size();
+      return ValueCache::get(key.str(), [&]() { return derived().valuesVector(storage); });
+   }
+
+   /**
+    * Returns a function computing the permuted kernel values directly, or an
+    * empty function if they must be gathered from valuesVector().
+    *
+    * The function is empty unless the on-the-fly evaluation is enabled with
+    * OnTheFly::setEnabled() and the kernel implements it for \c storage.
+    * It holds copies of the kernel and of the storage.
+    */
+   template <LatticeType LR, EmbeddingType L, Compress C, PerLevelOrder P >
+   StridedValues<LR> stridedValues(
+         const Storage<LR, L, C, P>& storage
+         ) const
+   { return OnTheFly::enabled() ? derived().stridedValuesOnTheFly(storage) : StridedValues<LR>(); }
+
+   /**
+    * Default implementation of the on-the-fly evaluation, for the kernels that
+    * do not implement it: returns an empty function.
+    */
+   template <LatticeType LR, EmbeddingType L, Compress C, PerLevelOrder P >
+   StridedValues<LR> stridedValuesOnTheFly(
+         const Storage<LR, L, C, P>& storage
+         ) const
+   { return StridedValues<LR>(); }
 
    /**
     * Returns \c true if the kernel takes the same value at points \f$x\f$ and
@@ -62,6 +113,19 @@ public:
    std::string name() const
    { return derived().name(); }
 
+   /**
+    * Returns a string identifying the values of the kernel, which is used as
+    * the key of ValueCache.
+    *
+    * Two kernels of the same type have the same key only if their parameters
+    * are exactly equal.  This default implementation returns name(), which is
+    * enough for the kernels whose parameters are integers; the kernels with
+    * real parameters write them with std::numeric_limits<Real>::max_digits10
+    * digits, which identify them exactly.
+    */
+   std::string key() const
+   { return name(); }
+
    DERIVED& derived()
    { return static_cast<DERIVED&>(*this); }
 
@@ -69,6 +133,14 @@ public:
    { return static_cast<const DERIVED&>(*this); }
 };
 
+/**
+ * Returns the vector of values of \c kernel for \c storage through
+ * Base::valuesVector(), even if the concrete kernel class hides it.
+ */
+template <class K, LatticeType LR, EmbeddingType L, Compress C, PerLevelOrder P>
+RealVector valuesVector(const Base<K>& kernel, const Storage<LR, L, C, P>& storage)
+{ return kernel.valuesVector(storage); }
+
 /**
  * Formats \c functor and outputs it on \c os.
  */
@@ -18,8 +18,12 @@
 #define LATBUILDER__KERNEL__FUNCTOR_ADAPTOR_H
 
 #include "latbuilder/Kernel/Base.h"
+#include "latbuilder/CompressTraits.h"
+#include "latbuilder/ThreadPool.h"
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 namespace LatBuilder { namespace Kernel {
 
@@ -27,7 +31,10 @@ namespace LatBuilder { namespace Kernel {
  * Generic kernel for functors.
  *
  * This class allows for polymorphism while inlining the functor calls in the
- * loop that initializes new vectors.
+ * loop that initializes new vectors.  The functor must provide, besides the
+ * evaluation at a single point, a member function
+ * <code>apply(const Real* x, Real* values, size_t n, modulus)</code> which
+ * evaluates it at \c n points at once.
  *
  * \tparam FUNCTOR      Type of functor.
  */
@@ -73,14 +80,80 @@ public:
       const auto modulus = storage.sizeParam().modulus();
 
       RealVector vec(storage.size());
-      auto proxy = storage.unpermuted(vec);
+      if (vec.size() == 0)
+         return vec;
 
-      for (size_t i = 0; i < vec.size(); i++)
-         proxy(i) = m_functor(Real(LatticeTraits<LR>::ToKernelIndex(i,modulus)) / numPoints, modulus);
+      // evaluate the functor over distinct ranges of points concurrently,
+      // each range at once, then permute the values
+      auto proxy = storage.unpermuted(vec);
+      const size_t size = vec.size();
+      ThreadPool& pool = ThreadPool::global();
+      const size_t numChunks = std::min<size_t>(std::max<size_t>(size / 4096, 1), 4 * pool.size());
+      pool.parallelFor(numChunks, [&] (unsigned int, size_t chunk) {
+         const size_t first = chunk * size / numChunks;
+         const size_t last = (chunk + 1) * size / numChunks;
+         std::vector<Real> points(last - first);
+         for (size_t i = first; i < last; i++)
+            points[i - first] = Real(LatticeTraits<LR>::ToKernelIndex(i,modulus)) / numPoints;
+
+         std::vector<Real> values(points.size());
+         m_functor.apply(points.data(), values.data(), values.size(), modulus);
+
+         for (size_t i = first; i < last; i++)
+            proxy(i) = values[i - first];
+      });
 
       return vec;
    }
 
+   /**
+    * Stores in <code>values[0], ..., values[n - 1]</code> the values of the
+    * kernel at the points <code>x[0], ..., x[n - 1]</code> of a lattice with
+    * modulus \c modulus.
+    */
+   template <typename MODULUS>
+   void pointValues(const Real* x, Real* values, size_t n, const MODULUS& modulus) const
+   { m_functor.apply(x, values, n, modulus); }
+
+   using Base<FunctorAdaptor<FUNCTOR>>::stridedValuesOnTheFly;
+
+   /**
+    * On-the-fly evaluation of the kernel values for ordinary lattices with
+    * flat storage (see Base::stridedValues()).
+    *
+    * The points of the stride permutation are computed incrementally,
+    * without divisions, and the functor is applied to them block by block,
+    * so that the returned values are identical to the permuted elements of
+    * valuesVector().
+    *
+    * \remark Checks that the functor and the compression are compatible, or
+    * throws a <code>std::logic_error</code>.
+    */
+   template <Compress C, PerLevelOrder P>
+   StridedValues<LatticeType::ORDINARY> stridedValuesOnTheFly(
+         const Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, C, P>& storage
+         ) const
+   {
+      if (storage.symmetric() and not m_functor.symmetric())
+        throw std::logic_error("functor must be symmetric in order to use symmetric compression");
+
+      const Functor functor = m_functor;
+      const uInteger modulus = storage.sizeParam().modulus();
+      const uInteger numPoints = storage.virtualSize();
+
+      return [functor, modulus, numPoints] (const uInteger& stride, size_t first, size_t last, Real* out) {
+         const uInteger step = stride % modulus;
+         uInteger index = uInteger(first) % modulus * step % modulus;
+         for (size_t i = first; i < last; i++) {
+            out[i - first] = Real(CompressTraits<C>::compressIndex(index, numPoints)) / numPoints;
+            index += step;
+            if (index >= modulus)
+               index -= modulus;
+         }
+         functor.apply(out, out, last - first, modulus);
+      };
+   }
+
    /**
     * Returns \c true if the kernel takes the same value at points \f$x\f$ and
     * \f$1 - x\f$ for \f$x \in [0,1)\f$.
@@ -0,0 +1,149 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LATBUILDER__KERNEL__LINEAR_COMBINATION_H
+#define LATBUILDER__KERNEL__LINEAR_COMBINATION_H
+
+#include "latbuilder/Kernel/Base.h"
+#include "latbuilder/Kernel/PAlpha.h"
+#include "latbuilder/Kernel/RAlpha.h"
+#include "latbuilder/Kernel/PAlphaTilde.h"
+#include "latbuilder/Kernel/RPLR.h"
+
+#include <boost/numeric/ublas/vector.hpp>
+
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace LatBuilder { namespace Kernel {
+
+/**
+ * Linear combination of kernels, evaluated as a single kernel.
+ *
+ * A coordinate-uniform figure of merit is linear in its kernel, so that the
+ * linear combination \f$\sum_k c_k \mathcal D_k^2\f$ of the figures of merit
+ * with kernels \f$\omega_k\f$ and the same weights is the figure of merit with
+ * the kernel \f$\sum_k c_k \omega_k\f$.  The combined figure thus costs a
+ * single vector of kernel values, a single state and a single inner product
+ * (or FFT) per coordinate, instead of one for each figure.
+ *
+ * The kernels of the combination are of the types \c K1 and \c K2, which have
+ * the same norm type.  The vector of kernel values is the linear combination
+ * of the vectors of values of the kernels, which are shared with the searches
+ * that use them alone through ValueCache.
+ */
+template <class K1, class K2>
+class LinearCombination : public Base<LinearCombination<K1, K2>> {
+public:
+   static_assert(K1::CUPower == K2::CUPower, "the combined kernels must have the same norm type");
+
+   /**
+    * Constructor.
+    *
+    * \param terms1  Coefficients and kernels of type \c K1 of the combination.
+    * \param terms2  Coefficients and kernels of type \c K2 of the combination.
+    */
+   LinearCombination(std::vector<std::pair<Real, K1>> terms1, std::vector<std::pair<Real, K2>> terms2 = std::vector<std::pair<Real, K2>>()):
+      m_terms1(std::move(terms1)),
+      m_terms2(std::move(terms2))
+   {
+      if (m_terms1.empty() and m_terms2.empty())
+         throw std::invalid_argument("LinearCombination: the combination has no kernels");
+   }
+
+   /**
+    * Creates a new vector of kernel values (see Base::valuesVector()).
+    */
+   template <LatticeType LR, EmbeddingType L, Compress C, PerLevelOrder P >
+   RealVector valuesVector(
+         const Storage<LR, L, C, P>& storage
+         ) const
+   {
+      RealVector vec = boost::numeric::ublas::zero_vector<Real>(storage.size());
+      for (const auto& term : m_terms1)
+         vec += term.first * Kernel::valuesVector(term.second, storage);
+      for (const auto& term : m_terms2)
+         vec += term.first * Kernel::valuesVector(term.second, storage);
+      return vec;
+   }
+
+   /**
+    * Returns \c true if all the kernels of the combination are symmetric.
+    */
+   bool symmetric() const
+   {
+      for (const auto& term : m_terms1)
+         if (not term.second.symmetric())
+            return false;
+      for (const auto& term : m_terms2)
+         if (not term.second.symmetric())
+            return false;
+      return true;
+   }
+
+   static constexpr Compress suggestedCompression()
+   { return K1::suggestedCompression() == K2::suggestedCompression() ? K1::suggestedCompression() : Compress::NONE; }
+
+   std::string name() const
+   {
+      std::ostringstream os;
+      bool first = true;
+      auto format = [&] (Real coefficient, const std::string& name) {
+         os << (first ? "" : "+") << coefficient << "*" << name;
+         first = false;
+      };
+      for (const auto& term : m_terms1)
+         format(term.first, term.second.name());
+      for (const auto& term : m_terms2)
+         format(term.first, term.second.name());
+      return os.str();
+   }
+
+   /**
+    * Returns the key of the combination (see Base::key()), made of the exact
+    * values of the coefficients and of the keys of the kernels.
+    */
+   std::string key() const
+   {
+      std::ostringstream os;
+      os.precision(std::numeric_limits<Real>::max_digits10);
+      for (const auto& term : m_terms1)
+         os << term.first << "*" << term.second.key() << ";";
+      for (const auto& term : m_terms2)
+         os << term.first << "*" << term.second.key() << ";";
+      return os.str();
+   }
+
+   static constexpr Real CUPower = K1::CUPower;
+
+private:
+   std::vector<std::pair<Real, K1>> m_terms1;
+   std::vector<std::pair<Real, K2>> m_terms2;
+};
+
+/// Linear combination of the kernels of ordinary lattices.
+typedef LinearCombination<PAlpha, RAlpha> OrdinaryCombination;
+
+/// Linear combination of the kernels of polynomial lattices.
+typedef LinearCombination<PAlphaTilde, RPLR> PolynomialCombination;
+
+}}
+
+#endif
@@ -0,0 +1,51 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__KERNEL__ON_THE_FLY_H
+#define LATBUILDER__KERNEL__ON_THE_FLY_H
+
+namespace LatBuilder { namespace Kernel {
+
+/**
+ * Process-wide switch of the on-the-fly evaluation of the kernel values.
+ *
+ * By default, the coordinate-uniform CBC constructions store the kernel values
+ * at all points in a vector (see Base::valuesVector()) and gather from it the
+ * values permuted by each candidate generator value.  For large numbers of
+ * points, that vector does not fit in cache and each gathered value is a cache
+ * miss.  When the on-the-fly evaluation is enabled, the kernels which are
+ * cheap to evaluate, such as the \f$\mathcal P_\alpha\f$ kernels, are instead
+ * evaluated directly at the permuted points (see Base::stridedValues()), and
+ * the vector is not created.
+ */
+class OnTheFly {
+public:
+   /**
+    * Sets whether the kernel values are evaluated on the fly when the kernel
+    * supports it.  Disabled by default.
+    */
+   static void setEnabled(bool enabled);
+
+   /**
+    * Returns \c true if the kernel values are evaluated on the fly when the
+    * kernel supports it.
+    */
+   static bool enabled();
+};
+
+}}
+
+#endif
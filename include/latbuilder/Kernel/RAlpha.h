@@ -25,6 +25,7 @@
 
 #include <sstream>
 #include <cmath>
+#include <limits>
 
 namespace LatBuilder { namespace Kernel {
 
@@ -149,6 +150,18 @@ public:
    std::string name() const
    { std::ostringstream os; os << "R" << alpha(); return os.str(); }
 
+   /**
+    * Returns the key of the kernel (see Base::key()), with the exact value
+    * of \f$\alpha\f$.
+    */
+   std::string key() const
+   {
+      std::ostringstream os;
+      os.precision(std::numeric_limits<Real>::max_digits10);
+      os << "R" << alpha();
+      return os.str();
+   }
+
    static constexpr Real CUPower = 2;
 
 private:
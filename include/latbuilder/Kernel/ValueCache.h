@@ -0,0 +1,73 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__KERNEL__VALUE_CACHE_H
+#define LATBUILDER__KERNEL__VALUE_CACHE_H
+
+#include "latbuilder/Types.h"
+
+#include <functional>
+#include <string>
+
+namespace LatBuilder { namespace Kernel {
+
+/**
+ * Process-wide cache of the vectors of kernel values.
+ *
+ * The vectors are identified by a key describing the kernel, the storage type
+ * and the size parameter (see Base::valuesVector()), so that the searches,
+ * their repetitions and the levels of the multilevel searches which use the
+ * same kernel values compute them only once.
+ *
+ * The cached vectors are kept in memory up to a total size given by
+ * setCapacity(); the oldest ones are evicted first.  If a directory is set
+ * with setDirectory(), the vectors are also stored there as binary files,
+ * which are memory-mapped when they are read by later processes.
+ */
+class ValueCache {
+public:
+   /**
+    * Returns the vector of kernel values identified by \c key, computed with \c
+    * compute if it is neither in memory nor in the cache directory.
+    */
+   static RealVector get(const std::string& key, const std::function<RealVector()>& compute);
+
+   /**
+    * Sets the directory where the vectors of kernel values are stored as
+    * files.  The files are not used if \c directory is empty (the default).
+    */
+   static void setDirectory(const std::string& directory);
+
+   /**
+    * Sets the maximum total size in bytes of the vectors kept in memory.
+    * Defaults to 1 GiB; no vector is kept if \c capacity is zero.
+    */
+   static void setCapacity(size_t capacity);
+
+   /**
+    * Returns the total size in bytes of the vectors kept in memory.
+    */
+   static size_t size();
+
+   /**
+    * Removes all vectors kept in memory.
+    */
+   static void clear();
+};
+
+}}
+
+#endif
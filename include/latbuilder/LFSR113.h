@@ -20,6 +20,7 @@
 #include <limits>
 #include <array>
 #include <stdexcept>
+#include <cstddef>
 #include <cstdint>
 
 namespace LatBuilder {
@@ -36,6 +37,12 @@ public:
 
    static const seed_type default_seed;
 
+   /**
+    * Binary logarithm of the number of iterations between the starting points
+    * of consecutive streams (see nextStream()).
+    */
+   static constexpr unsigned int STREAM_LOG_LENGTH = 56;
+
    /**
     * Constructor.
     *
@@ -58,10 +65,49 @@ public:
    }
 
    /**
-    * Jumps 2^100 iterations past the current state.
+    * Jumps 2^55 iterations past the current state.
     */
    void jump();
 
+   /**
+    * Jumps to the start of the next stream, \f$2^{56}\f$ iterations past the
+    * current state (see #STREAM_LOG_LENGTH).
+    */
+   void nextStream()
+   { jumpPowerOfTwo(STREAM_LOG_LENGTH); }
+
+   /**
+    * Jumps \f$2^e\f$ iterations past the current state.
+    *
+    * The jump is computed with precomputed jump matrices, in a time which does
+    * not depend on \c e, and gives exactly the state after as many calls to
+    * operator()().
+    */
+   void jumpPowerOfTwo(unsigned int e);
+
+   /**
+    * Jumps \c n iterations past the current state, as \c n calls to
+    * operator()() would.
+    */
+   void discard(unsigned long long n);
+
+   /**
+    * Returns a generator whose state is the current state, and jumps to the
+    * start of the next stream (see nextStream()).
+    *
+    * The generators returned by successive calls produce non-overlapping
+    * streams, which can be given to different threads or processes.
+    */
+   LFSR113 split();
+
+   /**
+    * Stores the next \c n random numbers of the sequence in \c out.
+    *
+    * This is equivalent to \c n calls to operator()(), with the state kept in
+    * local variables for the whole loop.
+    */
+   void fill(result_type* out, size_t n);
+
    /**
     * Returns the smallest value in the output range.
     */
@@ -20,6 +20,7 @@
 #include <limits>
 #include <array>
 #include <stdexcept>
+#include <cstddef>
 #include <cstdint>
 
 namespace LatBuilder {
@@ -36,12 +37,25 @@ public:
 
    static const seed_type default_seed;
 
+   /**
+    * Binary logarithm of the number of iterations between the starting points
+    * of consecutive streams (see nextStream()).
+    */
+   static constexpr unsigned int STREAM_LOG_LENGTH = 112;
+
    /**
     * Constructor.
     *
-    * \tparam s   Optional seed.
+    * The seed is the thread default seed (see setThreadDefaultSeed()).
     */
-   LFSR258(seed_type s = default_seed) { seed(std::move(s)); }
+   LFSR258() { seed(threadDefaultSeed()); }
+
+   /**
+    * Constructor.
+    *
+    * \tparam s   Seed.
+    */
+   LFSR258(seed_type s) { seed(std::move(s)); }
 
    /**
     * Returns the current seed.
@@ -58,10 +72,71 @@ public:
    }
 
    /**
-    * Jumps 2^100 iterations past the current state.
+    * Jumps ahead by a fixed number of iterations past the current state.
+    *
+    * This is the hand-coded jump of the original implementation, which the
+    * random searches use between coordinates.  Its components are advanced
+    * by \f$2^{11}\f$, \f$2^{35}\f$, \f$2^{44}\f$, \f$2^{12}\f$ and
+    * \f$2^{36}\f$ iterations modulo their periods, rather than by the
+    * \f$2^{100}\f$ iterations it was documented to jump; it is kept as is so
+    * that the searches give the same results.
     */
    void jump();
 
+   /**
+    * Jumps to the start of the next stream, \f$2^{112}\f$ iterations past the
+    * current state (see #STREAM_LOG_LENGTH).
+    */
+   void nextStream()
+   { jumpPowerOfTwo(STREAM_LOG_LENGTH); }
+
+   /**
+    * Returns the seed of the generators default-constructed by the calling
+    * thread; this is \c default_seed unless setThreadDefaultSeed() was called.
+    */
+   static const seed_type& threadDefaultSeed();
+
+   /**
+    * Sets the seed of the generators default-constructed from now on by the
+    * calling thread.
+    *
+    * This gives independent random streams to tasks which are constructed
+    * concurrently in different threads.
+    */
+   static void setThreadDefaultSeed(seed_type s);
+
+   /**
+    * Jumps \f$2^e\f$ iterations past the current state.
+    *
+    * The jump is computed with precomputed jump matrices, in a time which does
+    * not depend on \c e, and gives exactly the state after as many calls to
+    * operator()().
+    */
+   void jumpPowerOfTwo(unsigned int e);
+
+   /**
+    * Jumps \c n iterations past the current state, as \c n calls to
+    * operator()() would.
+    */
+   void discard(unsigned long long n);
+
+   /**
+    * Returns a generator whose state is the current state, and jumps to the
+    * start of the next stream (see nextStream()).
+    *
+    * The generators returned by successive calls produce non-overlapping
+    * streams, which can be given to different threads or processes.
+    */
+   LFSR258 split();
+
+   /**
+    * Stores the next \c n random numbers of the sequence in \c out.
+    *
+    * This is equivalent to \c n calls to operator()(), with the state kept in
+    * local variables for the whole loop.
+    */
+   void fill(result_type* out, size_t n);
+
    /**
     * Returns the smallest value in the output range.
     */
@@ -17,8 +17,47 @@
 #ifndef LATBUILDER_H
 #define LATBUILDER_H
 
+#include "latbuilder/Types.h"
+#include "latbuilder/Parser/CommandLine.h"
+
+#include <boost/program_options/variables_map.hpp>
+
+#include <string>
+
 namespace LatBuilder{
     int main(int argc, const char *argv[]);
+
+    /**
+     * Same as main(), but reports the errors by throwing exceptions instead
+     * of exiting, so that several commands can be run in the same process.
+     */
+    int run(int argc, const char *argv[]);
+
+    /**
+     * Parses the command-line arguments accepted by main(), where \c argv[0]
+     * is the program name.
+     * If \c --help is given, the help message is printed and the other
+     * arguments are not checked.
+     */
+    boost::program_options::variables_map parseOptions(int argc, const char *argv[]);
+
+    /**
+     * Applies the process-wide settings of the options \c opt returned by
+     * parseOptions() (threads, caches, budget, target merit value, shard,
+     * transforms).  The settings whose option is absent are reset to their
+     * defaults, so that the commands run in the same process do not inherit
+     * the settings of the previous ones.
+     */
+    void applySettings(const boost::program_options::variables_map& opt);
+
+    /**
+     * Returns the arguments of the search described by the options \c opt,
+     * for lattices of type \c LR.
+     * For unilevel lattices, the returned command line can be used through its
+     * base class.
+     */
+    template <LatticeType LR>
+    Parser::CommandLine<LR, EmbeddingType::MULTILEVEL> makeCommandLine(const boost::program_options::variables_map& opt, const std::string& originalCommandLine);
 }
 
 #endif
\ No newline at end of file
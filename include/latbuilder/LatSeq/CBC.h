@@ -19,15 +19,21 @@
 
 #include "latbuilder/Types.h"
 #include "latbuilder/LatDef.h"
+#include "latbuilder/LatView.h"
 
 #include <boost/iterator/iterator_adaptor.hpp>
 
+#include <vector>
+
 namespace LatBuilder { namespace LatSeq {
 
 /**
  * Sequence of lattice definitions obtained by appending a variable component to
  * a base genrating vector.
  *
+ * The elements are lattice views on the base lattice of the sequence (see
+ * LatView), so that the iterators only hold the appended component.
+ *
  * \tparam ET       Type of lattice.
  * \tparam GENSEQ    Type of sequences of generator values.
  * 
@@ -37,7 +43,7 @@ class CBC {
 public:
 
    typedef GENSEQ GenSeq;
-   typedef LatDef<LR, ET> value_type;
+   typedef LatView<LR, ET> value_type;
    typedef size_t size_type;
 
    /**
@@ -63,6 +69,20 @@ public:
    const LatDef<LR, ET>& baseLat() const
    { return m_baseLat; }
 
+   /**
+    * Returns \c k CBC sequences with the same base lattice, whose appended
+    * components are taken from consecutive parts of the sequence of generator
+    * values, as split by GENSEQ::split().
+    */
+   std::vector<CBC> split(size_type k) const
+   {
+      std::vector<CBC> parts;
+      parts.reserve(k);
+      for (auto& genSeq : m_genSeq.split(k))
+         parts.push_back(CBC(m_baseLat, std::move(genSeq)));
+      return parts;
+   }
+
 private:
    LatDef<LR, ET> m_baseLat;
    GenSeq m_genSeq;
@@ -83,14 +103,12 @@ public:
          const_iterator::iterator_adaptor_(seq.genSeq().begin()),
          m_seq(&seq),
          m_value(m_seq->baseLat())
-      {
-         if (this->base_reference() != m_seq->genSeq().end())
-            m_value.gen().push_back(*this->base_reference());
-      }
+      { updateValue(); }
 
       const_iterator(const CBC& seq, end_tag):
          const_iterator::iterator_adaptor_(seq.genSeq().end()),
-         m_seq(&seq)
+         m_seq(&seq),
+         m_value(m_seq->baseLat())
       { }
 
       const CBC& seq() const
@@ -100,12 +118,18 @@ public:
       friend class boost::iterators::iterator_core_access;
 
       void increment()
+      { ++this->base_reference(); updateValue(); }
+
+      void decrement()
+      { --this->base_reference(); updateValue(); }
+
+      void advance(typename const_iterator::difference_type n)
+      { this->base_reference() += n; updateValue(); }
+
+      void updateValue()
       {
-         const auto end = m_seq->genSeq().end();
-         if (++this->base_reference() != end)
-            m_value.gen().back() = *this->base_reference();
-         else
-            m_value.gen().back() = 0;
+         if (this->base_reference() != m_seq->genSeq().end())
+            m_value.last() = *this->base_reference();
       }
 
       bool equal(const const_iterator& other) const
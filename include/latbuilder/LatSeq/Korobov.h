@@ -58,6 +58,24 @@ public:
             makeGenSeqs(sizeParam, genSeq, latDimension))
    {}
 
+   /**
+    * Returns \c k Korobov sequences whose generator values are consecutive
+    * parts of the sequence of generator values of this sequence, as split by
+    * GENSEQ::split(), so that they together cover this sequence.
+    */
+   std::vector<Korobov> split(size_t k) const
+   {
+      std::vector<Korobov> parts;
+      parts.reserve(k);
+      if (this->latDimension() == 0) {
+         parts.push_back(*this);
+         return parts;
+      }
+      for (auto& genSeq : this->base().seqs().front().base().split(k))
+         parts.push_back(Korobov(this->sizeParam(), genSeq, this->latDimension()));
+      return parts;
+   }
+
 private:
    static std::vector<GenSeq::PowerSeq<GENSEQ>> makeGenSeqs(
          const SizeParam<LR, ET>& sizeParam,
@@ -0,0 +1,173 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Lattice definition made of a base lattice and one appended component.
+ */
+
+#ifndef LATBUILDER__LAT_VIEW_H
+#define LATBUILDER__LAT_VIEW_H
+
+#include "latbuilder/LatDef.h"
+
+namespace LatBuilder
+{
+
+/**
+ * Lattice definition obtained by appending a component to the generating
+ * vector of a base lattice, without copying it.
+ *
+ * This is the type of the elements of LatSeq::CBC: the candidate lattices of
+ * a CBC exploration only differ by their last component, so that copying an
+ * element only copies that component.  The evaluators of the CBC merit
+ * sequences accept it wherever they accept a LatDef, and a LatDef is only
+ * constructed, with #latDef(), for the selected lattice.  A view converts
+ * implicitly to a LatDef, so that the code using the elements of the
+ * sequence as lattice definitions is unchanged.
+ *
+ * The base lattice is kept as a reference, no copy made.
+ *
+ * \tparam LR  Type of lattice.
+ * \tparam ET  Type of embedding.
+ */
+template <LatticeType LR, EmbeddingType ET>
+class LatView {
+public:
+   typedef LatBuilder::LatDef<LR, ET> LatDef;
+   typedef typename LatticeTraits<LR>::GenValue GenValue;
+
+   /**
+    * Generating vector of a lattice view, indexed as a
+    * LatDef::GeneratingVector.
+    */
+   class GeneratingVector {
+   public:
+      GeneratingVector(const LatView& lat):
+         m_lat(&lat)
+      {}
+
+      /**
+       * Returns the number of components.
+       */
+      size_t size() const
+      { return m_lat->dimension(); }
+
+      /**
+       * Returns the component of index \c j.
+       */
+      const GenValue& operator[](size_t j) const
+      { return j < m_lat->base().dimension() ? m_lat->base().gen()[j] : m_lat->last(); }
+
+      /**
+       * Returns the appended component.
+       */
+      const GenValue& back() const
+      { return m_lat->last(); }
+
+   private:
+      const LatView* m_lat;
+   };
+
+   /**
+    * Constructor.
+    *
+    * \param base    Base lattice.  Kept as a reference, no copy made.
+    * \param last    Component appended to the generating vector of \c base.
+    */
+   LatView(const LatDef& base, GenValue last = GenValue()):
+      m_base(&base),
+      m_last(std::move(last))
+   {}
+
+   /**
+    * Returns the base lattice.
+    */
+   const LatDef& base() const
+   { return *m_base; }
+
+   /**
+    * Returns the appended component.
+    */
+   const GenValue& last() const
+   { return m_last; }
+
+   /// \copydoc last()
+   GenValue& last()
+   { return m_last; }
+
+   /**
+    * Returns the size parameter of the lattice.
+    */
+   const SizeParam<LR, ET>& sizeParam() const
+   { return base().sizeParam(); }
+
+   /**
+    * Returns the generating vector of the lattice.
+    */
+   GeneratingVector gen() const
+   { return GeneratingVector(*this); }
+
+   /**
+    * Returns the dimension of the lattice.
+    */
+   Dimension dimension() const
+   { return base().dimension() + 1; }
+
+   /**
+    * Stores the lattice in \c lat, reusing the storage of its generating
+    * vector.
+    */
+   void assignTo(LatDef& lat) const
+   {
+      lat.sizeParam() = sizeParam();
+      lat.gen().assign(base().gen().begin(), base().gen().end());
+      lat.gen().push_back(last());
+   }
+
+   /**
+    * Returns the lattice as a lattice definition.
+    */
+   LatDef latDef() const
+   {
+      LatDef lat;
+      assignTo(lat);
+      return lat;
+   }
+
+   /**
+    * Converts the view to a lattice definition, so that the elements of
+    * LatSeq::CBC can be used wherever a LatDef is expected.
+    */
+   operator LatDef() const
+   { return latDef(); }
+
+private:
+   const LatDef* m_base;
+   GenValue m_last;
+};
+
+/**
+ * Formats \c lat and outputs it to \c os, as the equivalent lattice
+ * definition.
+ */
+template <LatticeType LR, EmbeddingType ET>
+std::ostream& operator<< (std::ostream& os, const LatView<LR, ET>& lat)
+{ return os << lat.latDef(); }
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__LEVEL_VECTOR_H
+#define LATBUILDER__LEVEL_VECTOR_H
+
+#include "latbuilder/Types.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace LatBuilder {
+
+/**
+ * Per-level merit values of an embedded lattice, stored in place.
+ *
+ * Same role as the RealVector merit values of embedded lattices, but with a
+ * fixed capacity and no heap allocation, so that the filters and the combiner
+ * of MeritFilterList can be applied to each candidate lattice on the stack.
+ * The values are contiguous, so that the per-level loops of the filters can
+ * be vectorized.
+ */
+class LevelVector {
+public:
+   typedef Real value_type;
+   typedef std::size_t size_type;
+   typedef Real* iterator;
+   typedef const Real* const_iterator;
+
+   /// Maximum number of levels.
+   static constexpr size_type Capacity = 64;
+
+   /**
+    * Returns \c true if \c size levels fit in a LevelVector.
+    */
+   static constexpr bool fits(size_type size)
+   { return size <= Capacity; }
+
+   /**
+    * Constructor.
+    *
+    * \param size    Number of levels; must satisfy fits().
+    */
+   explicit LevelVector(size_type size = 0):
+      m_size(size)
+   {}
+
+   /**
+    * Copies the per-level values \c merit, which must satisfy fits().
+    */
+   explicit LevelVector(const RealVector& merit):
+      m_size(merit.size())
+   { std::copy(merit.begin(), merit.end(), m_values); }
+
+   size_type size() const
+   { return m_size; }
+
+   Real& operator[](size_type level)
+   { return m_values[level]; }
+
+   const Real& operator[](size_type level) const
+   { return m_values[level]; }
+
+   Real* data()
+   { return m_values; }
+
+   const Real* data() const
+   { return m_values; }
+
+   iterator begin()
+   { return m_values; }
+
+   iterator end()
+   { return m_values + m_size; }
+
+   const_iterator begin() const
+   { return m_values; }
+
+   const_iterator end() const
+   { return m_values + m_size; }
+
+   /**
+    * Sets all the per-level values to \c value.
+    */
+   void fill(Real value)
+   { std::fill(begin(), end(), value); }
+
+   /**
+    * Returns a copy of the per-level values as a RealVector.
+    */
+   RealVector toRealVector() const
+   {
+      RealVector out(m_size);
+      std::copy(begin(), end(), out.begin());
+      return out;
+   }
+
+   /**
+    * Replaces the per-level values with those of \c merit, which must satisfy
+    * fits().
+    */
+   void assign(const RealVector& merit)
+   {
+      m_size = merit.size();
+      std::copy(merit.begin(), merit.end(), m_values);
+   }
+
+private:
+   size_type m_size;
+   Real m_values[Capacity];
+};
+
+}
+
+#endif
@@ -0,0 +1,91 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Memory-mapped binary tables of the data folder.
+ */
+
+#ifndef LATBUILDER__MAPPED_TABLE_H
+#define LATBUILDER__MAPPED_TABLE_H
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace LatBuilder
+{
+
+/**
+ * Read-only table of rows of unsigned integers of variable lengths, mapped in
+ * memory from a binary file of the data folder.
+ *
+ * The binary tables are generated at build time from the CSV files of the
+ * data folder (see <code>data/wscript</code>), so that the program does not
+ * have to parse the whole CSV file, and to keep it in memory, to access a few
+ * rows.  A file consists of the magic string <code>LNBTABL1</code>, the number
+ * of rows \f$r\f$, the \f$r+1\f$ offsets of the rows in the values and the
+ * values, all of them as 64-bit unsigned integers in native representation.
+ * A row is thus located in constant time.
+ */
+class MappedTable {
+public:
+   /**
+    * Maps the table stored in \c fileName.
+    *
+    * Returns a null pointer if the file does not exist or is not a valid
+    * binary table, in which case the caller should fall back to the CSV file.
+    */
+   static std::unique_ptr<MappedTable> open(const std::string& fileName);
+
+   MappedTable(const MappedTable&) = delete;
+   MappedTable& operator=(const MappedTable&) = delete;
+
+   /**
+    * Returns the number of rows of the table.
+    */
+   size_t size() const
+   { return m_numRows; }
+
+   /**
+    * Returns the number of values in row \c i.
+    */
+   size_t rowSize(size_t i) const
+   { return static_cast<size_t>(m_offsets[i + 1] - m_offsets[i]); }
+
+   /**
+    * Returns a pointer to the first value of row \c i.
+    */
+   const std::uint64_t* row(size_t i) const
+   { return m_values + m_offsets[i]; }
+
+private:
+   MappedTable() = default;
+
+   boost::interprocess::file_mapping m_file;
+   boost::interprocess::mapped_region m_region;
+   size_t m_numRows = 0;
+   const std::uint64_t* m_offsets = nullptr;
+   const std::uint64_t* m_values = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,209 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Process-wide accounting of the memory of the large data structures.
+ */
+
+#ifndef LATBUILDER__MEMORY_H
+#define LATBUILDER__MEMORY_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace LatBuilder
+{
+
+/**
+ * Process-wide accounting of the memory of the large data structures of the
+ * searches, by component.
+ *
+ * The components are:
+ * - storage: the index tables of the embedded storages;
+ * - kernel values: the tables of kernel values of the coordinate-uniform
+ *   figures of merit;
+ * - states: the vectors of the coordinate-uniform states (CoordUniformState);
+ * - FFT buffers: the transforms of the kernel values and the work buffers of
+ *   the fast CBC constructions;
+ * - projections: the nodes of the projection-dependent evaluators of NetBuilder;
+ * - other: the other large vectors.
+ *
+ * The large vectors (RealVector and the FFT vectors) are allocated by
+ * HugePages, which reports the allocations of at least HugePages::threshold
+ * bytes, and only those, to allocated() and deallocated().  They are charged
+ * to the component of the innermost Scope of the allocating thread; the
+ * ThreadPool runs the loop bodies in the component of the thread which calls
+ * parallelFor().  The structures which do not allocate through HugePages
+ * report their size with a Usage member instead.  The memory-mapped files of
+ * StateMatrix are not counted, as their pages are reclaimed by the operating
+ * system.
+ *
+ * The accounting is always on: it costs a few atomic operations by large
+ * allocation.
+ */
+class Memory {
+public:
+   /// Accounted components.
+   enum class Component { STORAGE, KERNEL_VALUES, STATES, FFT_BUFFERS, PROJECTIONS, OTHER };
+
+   static constexpr unsigned int NUM_COMPONENTS = 6;
+
+   /**
+    * Charges the large allocations of the calling thread to \c component
+    * until the end of the enclosing scope.
+    */
+   class Scope {
+   public:
+      explicit Scope(Component component);
+      ~Scope();
+
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+   private:
+      Component m_previous;
+   };
+
+   /**
+    * Number of bytes of a data structure charged to a component, for the
+    * members of the structures which do not allocate through HugePages.  The
+    * bytes are released by the destructor, and charged again by the copies.
+    */
+   class Usage {
+   public:
+      explicit Usage(Component component):
+         m_component(component),
+         m_bytes(0)
+      {}
+
+      Usage(const Usage& other):
+         m_component(other.m_component),
+         m_bytes(0)
+      { set(other.m_bytes); }
+
+      Usage& operator=(const Usage& other)
+      {
+         if (this != &other) {
+            set(0);
+            m_component = other.m_component;
+            set(other.m_bytes);
+         }
+         return *this;
+      }
+
+      ~Usage()
+      { set(0); }
+
+      /**
+       * Sets the number of bytes of the structure.
+       */
+      void set(size_t bytes)
+      {
+         if (bytes > m_bytes)
+            Memory::add(m_component, bytes - m_bytes);
+         else if (bytes < m_bytes)
+            Memory::remove(m_component, m_bytes - bytes);
+         m_bytes = bytes;
+      }
+
+      /**
+       * Returns the number of bytes of the structure.
+       */
+      size_t bytes() const
+      { return m_bytes; }
+
+   private:
+      Component m_component;
+      size_t m_bytes;
+   };
+
+   /**
+    * Returns the component charged with the large allocations of the calling
+    * thread.
+    */
+   static Component current();
+
+   /**
+    * Charges the allocation of \c bytes bytes at \c p to the current()
+    * component.
+    */
+   static void allocated(const void* p, size_t bytes);
+
+   /**
+    * Releases the \c bytes bytes at \c p charged by allocated().
+    */
+   static void deallocated(const void* p, size_t bytes) noexcept;
+
+   /**
+    * Charges \c bytes bytes to \c component.
+    */
+   static void add(Component component, size_t bytes);
+
+   /**
+    * Releases \c bytes bytes charged to \c component.
+    */
+   static void remove(Component component, size_t bytes) noexcept;
+
+   /**
+    * Returns the number of bytes currently charged to \c component.
+    */
+   static size_t bytes(Component component);
+
+   /**
+    * Returns the largest number of bytes charged to \c component since the
+    * last resetPeaks().
+    */
+   static size_t peakBytes(Component component);
+
+   /**
+    * Returns the number of bytes currently charged to all the components.
+    */
+   static size_t totalBytes();
+
+   /**
+    * Returns the largest number of bytes charged to all the components at
+    * once since the last resetPeaks().
+    */
+   static size_t peakTotalBytes();
+
+   /**
+    * Sets the peaks to the current numbers of bytes.
+    */
+   static void resetPeaks();
+
+   /**
+    * Returns the name of \c component in the reports.
+    */
+   static std::string name(Component component);
+
+   /**
+    * Returns \c bytes as a human-readable string ("1.5 GiB").
+    */
+   static std::string format(double bytes);
+
+   /**
+    * Writes to \c os the peak number of bytes of each component and of the
+    * total, one by line.
+    */
+   static void writePeaks(std::ostream& os);
+};
+
+}
+
+#endif
@@ -65,6 +65,17 @@ public:
       return acc.value();
    }
 
+   /**
+    * Returns the accumulated merit value for \c merit.
+    */
+   Real apply(const LevelVector& merit, const LatDef& lat) const
+   {
+      LatBuilder::Accumulator<ACC, Real> acc(0.0);
+      for (const auto x : merit)
+         acc.accumulate(x);
+      return acc.value();
+   }
+
    std::string name() const
    { return LatBuilder::Accumulator<ACC, Real>::name(); }
 };
@@ -89,6 +100,12 @@ public:
    Real operator() (const RealVector& merit, const LatDef<LR, EmbeddingType::MULTILEVEL>&) const
    { return merit[m_level]; }
 
+   /**
+    * Calls the functor.
+    */
+   Real apply(const LevelVector& merit, const LatDef<LR, EmbeddingType::MULTILEVEL>&) const
+   { return merit[m_level]; }
+
    std::string name() const
    { return "select level " + boost::lexical_cast<std::string>(m_level); }
 
@@ -70,6 +70,16 @@ public:
       return out;
    }
 
+   /**
+    * Filters the per-level merit values \c merit in place, for embedded
+    * lattices.
+    */
+   void apply(LevelVector& merit, const LatDef& lat) const
+   {
+      if (not applyFilter<LevelVector>(merit, nullptr))
+         throw LatticeRejectedException();
+   }
+
    std::string name() const
    { return m_name; }
 
@@ -19,6 +19,7 @@
 
 #include "latbuilder/BridgeSeq.h"
 #include "latbuilder/LatDef.h"
+#include "latbuilder/LatView.h"
 #include "latbuilder/BasicMeritFilter.h"
 
 #include <boost/signals2.hpp>
@@ -216,6 +217,7 @@ public:
 
    private:
       const MeritFilterList& m_parent;
+      mutable LatDef<LR, ET> m_lat; // the last lattice view filtered, copied
 
       template <class IT>
       value_type element(const typename Base::const_iterator& it, const IT& it2) const
@@ -228,6 +230,15 @@ public:
       template <class IT, EmbeddingType L>
       value_type element(const typename Base::const_iterator& it, const IT& it2, const LatDef<LR, L>&) const
       { return m_parent.applyFilters(*it, *it2); }
+
+      // the filters are virtual functions of lattice definitions: the view is
+      // copied to the same lattice definition for all the elements
+      template <class IT>
+      value_type element(const typename Base::const_iterator& it, const IT&, const LatView<LR, ET>& lat) const
+      {
+         lat.assignTo(m_lat);
+         return m_parent.applyFilters(*it, m_lat);
+      }
    };
 
    /**
@@ -242,6 +253,21 @@ public:
    template <class MERITSEQ>
    Seq<MERITSEQ> apply(MERITSEQ meritSeq) const
    { return Seq<MERITSEQ>(*this, std::move(meritSeq)); }
+
+   /**
+    * Applies the filters to the merit value \c merit of the lattice \c lat.
+    *
+    * The filters may cache values that depend on the size and dimension of
+    * the lattices, so concurrent calls must be serialized by the caller.
+    */
+   template <typename MERIT>
+   Real apply(const MERIT& merit, const LatDef<LR, ET>& lat) const
+   { return this->applyFilters(merit, lat); }
+
+   /// \copydoc apply(const MERIT&, const LatDef<LR, ET>&) const
+   template <typename MERIT>
+   Real apply(const MERIT& merit, const LatView<LR, ET>& lat) const
+   { return this->applyFilters(merit, lat.latDef()); }
 };
 
 
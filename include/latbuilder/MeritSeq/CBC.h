@@ -22,6 +22,7 @@
 #include "latbuilder/BridgeSeq.h"
 #include "latbuilder/BridgeIteratorCached.h"
 #include "latbuilder/LatSeq/CBC.h"
+#include "latbuilder/ProjectionMerits.h"
 
 #include "latticetester/CoordinateSets.h"
 
@@ -41,6 +42,12 @@ namespace LatBuilder { namespace MeritSeq {
  *      current dimension by one. </li>
  * <li> Repeat from step 2 until desired dimension is reached. </li>
  * </ol>
+ *
+ * If the projection-dependent figure of merit is bounded by its
+ * subprojections (see ProjDepMerit::Base::boundedBySubProjections()), the
+ * merit values of the projections of the selected lattices are kept, so that
+ * the evaluator can bound the projections of the candidates for the next
+ * coordinate by their subprojections over the coordinates already selected.
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO , class PROJDEP, template <typename> class ACC>
 class CBC
@@ -68,7 +75,8 @@ public:
       m_figureOfMerit(std::move(figure)),
       m_eval(this->figureOfMerit().evaluator(this->storage())),
       m_baseLat(LatDef(this->storage().sizeParam())),
-      m_baseMerit(this->storage().createMeritValue(0.0))
+      m_baseMerit(this->storage().createMeritValue(0.0)),
+      m_projections(projections(), this->figureOfMerit().weights())
    {}
 
    /**
@@ -78,6 +86,39 @@ public:
    {
       m_baseLat = LatDef(storage().sizeParam());
       m_baseMerit = storage().createMeritValue(0.0);
+      m_projections = WeightedProjections(projections(), figureOfMerit().weights());
+      m_committedMerits.clear();
+   }
+
+   /**
+    * State of the algorithm for its base lattice.
+    *
+    * A state returned by #state() can be given back to #restore() after other
+    * components were selected, so that a depth-first exploration comes back
+    * to a base lattice without selecting its components again.
+    */
+   struct State {
+      LatDef baseLat;
+      MeritValue baseMerit;
+      WeightedProjections projections;
+      ProjectionMerits committedMerits;
+   };
+
+   /**
+    * Returns the state of the algorithm for the current base lattice.
+    */
+   State state() const
+   { return State{m_baseLat, m_baseMerit, m_projections, m_committedMerits}; }
+
+   /**
+    * Restores the state \c state returned by #state().
+    */
+   void restore(const State& state)
+   {
+      m_baseLat = state.baseLat;
+      m_baseMerit = state.baseMerit;
+      m_projections = state.projections;
+      m_committedMerits = state.committedMerits;
    }
 
    /**
@@ -133,6 +174,22 @@ public:
       return Projections{{0, maxOrder, 0, maxCoord}, newCoord};
    }
 
+   /**
+    * Returns the projections of #projections() which contribute to the figure
+    * of merit, with their weights.  They are enumerated once by dimension,
+    * when the base lattice changes, rather than for each lattice of the
+    * sequence.
+    */
+   const WeightedProjections& weightedProjections() const
+   { return m_projections; }
+
+   /**
+    * Returns the projection-dependent merit values of the projections of the
+    * base lattice which are kept to bound the ones of the next coordinate.
+    */
+   const ProjectionMerits& committedMerits() const
+   { return m_committedMerits; }
+
    /**
     * Output sequence of merit values.
     *
@@ -166,6 +223,12 @@ public:
          m_parent(parent)
       { }
 
+      /**
+       * The merit values are computed by the constant evaluator of the parent,
+       * so Functor::MinElement may compute them concurrently.
+       */
+      static constexpr bool concurrentElements = true;
+
       /**
        * Computes and returns the value of the figure of merit for the generator
        * value pointed to by \c it.
@@ -174,8 +237,9 @@ public:
       {
          return m_parent.evaluator()(
                *it,
-               m_parent.projections(),
-               m_parent.baseMerit()
+               m_parent.weightedProjections(),
+               m_parent.baseMerit(),
+               &m_parent.committedMerits()
                );
       }
 
@@ -205,7 +269,9 @@ public:
    void select(const IT& it)
    {
       m_baseMerit = *it;
-      m_baseLat = *it.base();
+      m_baseLat = it.base()->latDef();
+      evaluator().recordMerits(m_baseLat, m_projections, m_committedMerits);
+      m_projections = WeightedProjections(projections(), figureOfMerit().weights());
    }
 
 private:
@@ -214,6 +280,8 @@ private:
    Evaluator m_eval;
    LatDef m_baseLat;
    MeritValue m_baseMerit;
+   WeightedProjections m_projections; // projections of the next coordinate
+   ProjectionMerits m_committedMerits; // of the projections of the base lattice
 };
 
 /// Creates a CBC algorithm.
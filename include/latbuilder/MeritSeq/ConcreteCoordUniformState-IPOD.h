@@ -19,6 +19,8 @@
 
 #include "latbuilder/MeritSeq/CoordUniformState.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/Memory.h"
+#include "latbuilder/StateMatrix.h"
 
 #include "latbuilder/Interlaced/IPODWeights.h"
 
@@ -36,6 +38,13 @@ template <LatticeType LR, EmbeddingType ET, Compress COMPRESS , PerLevelOrder PL
  *  \boldsymbol p_{j,l} = \sum_{\substack{\mathfrak{u} \subset \{1, \dots, jd\} \\ |w(u)|=l }} \delta_\mathfrak{u} \gamma_\mathfrak{u} \boldsymbol p_\mathfrak{u}.
    \f]
  * Recall that \f$d\f$ is the interlacing factor and \f$ s \f$ the dimension of the point set.
+ *
+ * The vectors \f$\boldsymbol p_{j,l}\f$ are the rows of a StateMatrix.  Each
+ * update is a single pass over the points by blocks, shared by the workers of
+ * the ThreadPool: the kernel values of the new component are gathered once per
+ * block, and on the last component of a coordinate the elementary symmetric
+ * polynomials, the vectors of all orders and the partial weighted state are
+ * updated together while the block is in cache.
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 class ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatBuilder::Interlaced::IPODWeights<LatBuilder::Kernel::IAAlpha>> :
@@ -89,7 +98,20 @@ public:
     * Returns a copy of this instance.
     */
    std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>> clone() const
-   { return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this)); }
+   {
+      Memory::Scope memory(Memory::Component::STATES);
+      return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this));
+   }
+
+   /**
+    * Writes the state to \c os after the data of CoordUniformState::save().
+    */
+   void save(std::ostream& os) const;
+
+   /**
+    * Restores the state written by save().
+    */
+   void load(std::istream& is);
 
 private:
    const LatBuilder::Interlaced::IPODWeights<LatBuilder::Kernel::IAAlpha>& m_weights;
@@ -98,7 +120,7 @@ private:
    RealVector m_elemPolySum;
    RealVector m_partialWeightedState;
    RealVector m_waitingKernelValues;
-   std::vector<RealVector> m_state;
+   StateMatrix m_state; // m_state.row(order)[i]
 };
 
 
@@ -116,7 +138,12 @@ public:
    void update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen);
    RealVector weightedState() const;
    std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>> clone() const
-   { return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this)); }
+   {
+      Memory::Scope memory(Memory::Component::STATES);
+      return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this));
+   }
+   void save(std::ostream& os) const;
+   void load(std::istream& is);
 
 private:
    const LatBuilder::Interlaced::IPODWeights<LatBuilder::Kernel::IB>& m_weights;
@@ -124,7 +151,7 @@ private:
 
    RealVector m_elemPolySum; // equals the left sum in the formula for the weighted state q
    RealVector m_partialWeightedState; // equals the right sum in the formula for the weighted state q
-   std::vector<RealVector> m_state;
+   StateMatrix m_state; // m_state.row(order)[i]
 };
 
 
@@ -142,7 +169,12 @@ public:
    void update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen);
    RealVector weightedState() const;
    std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>> clone() const
-   { return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this)); }
+   {
+      Memory::Scope memory(Memory::Component::STATES);
+      return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this));
+   }
+   void save(std::ostream& os) const;
+   void load(std::istream& is);
 
 private:
    const LatBuilder::Interlaced::IPODWeights<LatBuilder::Kernel::ICAlpha>& m_weights;
@@ -150,7 +182,7 @@ private:
 
    RealVector m_elemPolySum; // equals the left sum in the formula for the weighted state q
    RealVector m_partialWeightedState; // equals the right sum in the formula for the weighted state q
-   std::vector<RealVector> m_state;
+   StateMatrix m_state; // m_state.row(order)[i]
 };
 
 
@@ -19,11 +19,10 @@
 
 #include "latbuilder/MeritSeq/CoordUniformState.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/StateMatrix.h"
 
 #include "latticetester/OrderDependentWeights.h"
 
-#include <vector>
-
 namespace LatBuilder { namespace MeritSeq {
 
 // forward declaration
@@ -58,6 +57,10 @@ template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO
  *    \boldsymbol p_{s,\ell} =
  *       \boldsymbol p_{s-1,\ell} + \boldsymbol\omega_s \odot \boldsymbol p_{s-1,\ell-1}.
  * \f]
+ *
+ * As for the POD weights, the vectors for all orders are the rows of a
+ * StateMatrix, updated in place in one sweep over the points, block by block,
+ * on the shared ThreadPool.
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 class ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::OrderDependentWeights> :
@@ -115,11 +118,21 @@ public:
    std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>> clone() const
    { return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this)); }
 
+   /**
+    * Writes the state to \c os after the data of CoordUniformState::save().
+    */
+   void save(std::ostream& os) const;
+
+   /**
+    * Restores the state written by save().
+    */
+   void load(std::istream& is);
+
 private:
    const LatticeTester::OrderDependentWeights& m_weights;
 
-   // m_state[level](i)
-   std::vector<RealVector> m_state;
+   // m_state.row(order)[i]
+   StateMatrix m_state;
 };
 
 extern template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC,      LatticeTester::OrderDependentWeights>;
@@ -19,6 +19,7 @@
 
 #include "latbuilder/MeritSeq/CoordUniformState.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/Memory.h"
 
 #include "latticetester/ProductWeights.h"
 
@@ -54,6 +55,9 @@ template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO
  *    \boldsymbol p_s =
  *       (\boldsymbol 1 + \gamma_s \boldsymbol\omega_s) \odot \boldsymbol p_{s-1}.
  * \f]
+ *
+ * The state vector is updated in place, block by block on the shared
+ * ThreadPool, in a single pass over the points.
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO >
 class ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProductWeights> :
@@ -109,7 +113,20 @@ public:
     * Returns a copy of this instance.
     */
    std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>> clone() const
-   { return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this)); }
+   {
+      Memory::Scope memory(Memory::Component::STATES);
+      return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this));
+   }
+
+   /**
+    * Writes the state to \c os after the data of CoordUniformState::save().
+    */
+   void save(std::ostream& os) const;
+
+   /**
+    * Restores the state written by save().
+    */
+   void load(std::istream& is);
 
 private:
    const LatticeTester::ProductWeights& m_weights;
@@ -19,11 +19,14 @@
 
 #include "latbuilder/MeritSeq/CoordUniformState.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/StateMatrix.h"
 
 #include "latticetester/ProjectionDependentWeights.h"
 #include "latticetester/Coordinates.h"
 
 #include <map>
+#include <utility>
+#include <vector>
 
 
 namespace LatBuilder { namespace MeritSeq {
@@ -64,6 +67,23 @@ template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO
  *
  * See CoordUniformCBC for the definition of
  * \f$\boldsymbol \omega_s\f$.
+ *
+ * Only the vectors \f$\boldsymbol p_{\mathfrak u}\f$ needed by some
+ * projection \f$\mathfrak u \cup \{L\}\f$ with a nonzero weight, directly or
+ * through the chain of projections from which it is built, are computed; the
+ * projections \f$\mathfrak u\f$ of the same largest coordinate are updated
+ * together, in one sweep over the points.  As soon as the vector of
+ * \f$\mathfrak u\f$ is no longer needed to build other vectors, it is
+ * dropped if all its extensions are behind, or merged into the partial
+ * weighted state vectors
+ * \f[
+ *    \boldsymbol q_L \mathrel{+}= \gamma_{\mathfrak u \cup \{L\}} \,
+ *    \boldsymbol p_{\mathfrak u}
+ * \f]
+ * of its remaining extensions, unless that would create more than one new
+ * partial vector.  The vectors are the rows of a single StateMatrix whose
+ * freed rows are reused, so that the memory is bounded by the largest number
+ * of live vectors rather than by the number of weights.
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 class ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights> :
@@ -127,24 +147,57 @@ public:
    std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>> clone() const
    { return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this)); }
 
+   /**
+    * Writes the state to \c os after the data of CoordUniformState::save().
+    */
+   void save(std::ostream& os) const;
+
+   /**
+    * Restores the state written by save().
+    */
+   void load(std::istream& is);
+
 private:
    const LatticeTester::ProjectionDependentWeights& m_weights;
 
-   // m_state[projection](i)
-   // declared mutable because it is updated transparently by #getStateVector()
-   std::map<LatticeTester::Coordinates, RealVector> m_state;
+   struct Projection {
+      // one plus the largest coordinate of the projections built from this
+      // one, or 0 if there are none
+      Dimension childrenEnd = 0;
+      // nonzero weights of the extensions u \cup \{L\}, by increasing L
+      std::vector<std::pair<Dimension, Real>> extensions;
+   };
 
-   // keep track of the selected generator values to be able to generate state
-   // vectors on demand
-   GeneratingVector m_gen;
+   // projections whose state vector is needed, independent of the generator
+   // values
+   std::map<LatticeTester::Coordinates, Projection> m_projections;
+
+   // nonempty projections of m_projections by largest coordinate
+   std::vector<std::vector<LatticeTester::Coordinates>> m_byLargestCoordinate;
+
+   // rows of p_u for the projections u still needed, and of the partial
+   // weighted state vectors q_L for the coordinates L not reached yet
+   StateMatrix m_rows;
+   std::vector<size_t> m_freeRows;
+   std::map<LatticeTester::Coordinates, size_t> m_stateRows;
+   std::map<Dimension, size_t> m_mergedRows;
 
    /**
-    * Creates and stores the state vector for \c projection if it has not been
-    * created yet.
-    *
-    * \return A reference to the state vector.
+    * Computes #m_projections and #m_byLargestCoordinate from the weights.
+    */
+   void plan();
+
+   /**
+    * Returns a free row of #m_rows.
+    */
+   size_t allocateRow();
+
+   /**
+    * Drops or merges the state vectors that are no longer needed to build
+    * other ones at the current dimension, and frees the partial weighted
+    * state vectors of the coordinates already reached.
     */
-   const RealVector& createStateVector(const LatticeTester::Coordinates& projection, const RealVector& kernelValues);
+   void collect();
 };
 
 
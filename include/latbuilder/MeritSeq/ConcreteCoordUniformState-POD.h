@@ -19,11 +19,10 @@
 
 #include "latbuilder/MeritSeq/CoordUniformState.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/StateMatrix.h"
 
 #include "latticetester/PODWeights.h"
 
-#include <vector>
-
 namespace LatBuilder { namespace MeritSeq {
 
 // forward declaration
@@ -31,6 +30,16 @@ template <LatticeType LR, EmbeddingType ET, Compress COMPRESS , PerLevelOrder PL
 
 /**
  * Implementation of CoordUniformState for POD weights.
+ *
+ * The vectors \f$\boldsymbol p_{s,\ell}\f$ for all orders \f$\ell\f$ are
+ * stored as the rows of a single contiguous and aligned matrix, so that
+ * update() and weightedState() process all orders in one sweep over the
+ * points, block by block, with loops over contiguous memory that the compiler
+ * can vectorize.  The permuted kernel values are gathered only once per
+ * update.  The blocks are independent, so they are distributed among the
+ * workers of the shared ThreadPool.  The matrix is a StateMatrix, so it is
+ * kept in a memory-mapped file when a directory is set with
+ * StateMatrix::setDirectory().
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 class ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::PODWeights> :
@@ -88,11 +97,24 @@ public:
    std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>> clone() const
    { return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this)); }
 
+   /**
+    * Writes the state to \c os after the data of CoordUniformState::save().
+    */
+   void save(std::ostream& os) const;
+
+   /**
+    * Restores the state written by save().
+    */
+   void load(std::istream& is);
+
 private:
    const LatticeTester::PODWeights& m_weights;
 
-   // m_state[level](i)
-   std::vector<RealVector> m_state;
+   // m_state.row(order)[i]
+   StateMatrix m_state;
+
+   size_t numOrders() const
+   { return m_state.numRows(); }
 };
 
 
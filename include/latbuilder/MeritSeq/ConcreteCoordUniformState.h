@@ -109,7 +109,9 @@ public:
 
       using LatticeTester::Coordinates;
 
-      auto stridedKernelValues = this->storage().strided(kernelValues, gen);
+      // the permuted kernel values are read once for each known projection
+      RealVector stridedKernelValues;
+      this->storage().gather(kernelValues, gen, stridedKernelValues);
 
       const auto newCoordinate = this->dimension() - 1;
 
@@ -174,6 +176,24 @@ public:
    std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>> clone() const
    { return std::unique_ptr<CoordUniformState<LR, ET, COMPRESS, PLO>>(new ConcreteCoordUniformState(*this)); }
 
+   /**
+    * Writes the state to \c os after the data of CoordUniformState::save().
+    */
+   void save(std::ostream& os) const
+   {
+      CoordUniformState<LR, ET, COMPRESS, PLO>::save(os);
+      StateIO::write(os, m_state);
+   }
+
+   /**
+    * Restores the state written by save().
+    */
+   void load(std::istream& is)
+   {
+      CoordUniformState<LR, ET, COMPRESS, PLO>::load(is);
+      StateIO::read(is, m_state);
+   }
+
 private:
    const WEIGHTS& m_weights;
 
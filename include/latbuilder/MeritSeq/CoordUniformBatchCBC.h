@@ -0,0 +1,262 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__MERIT_SEQ__COORD_UNIFORM_BATCH_CBC_H
+#define LATBUILDER__MERIT_SEQ__COORD_UNIFORM_BATCH_CBC_H
+
+#include "latbuilder/CoordUniformFigureOfMerit.h"
+#include "latbuilder/MeritSeq/CoordUniformStateCreator.h"
+#include "latbuilder/CompressedSum.h"
+#include "latbuilder/LatDef.h"
+#include "latbuilder/Storage.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Memory.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace LatBuilder { namespace MeritSeq {
+
+/**
+ * Several coordinate-uniform CBC algorithms, one for each of a list of
+ * figures of merit which share the same kernel but not the same weights,
+ * advanced in lockstep over the same sequences of generator values.
+ *
+ * For each candidate generator value, the merit value of each algorithm is
+ * the inner product of its weighted state vector with the kernel values
+ * permuted by the stride of the candidate, as in CoordUniformCBC.  The
+ * permuted kernel values only depend on the candidate, so that they are
+ * gathered once for all the algorithms: the weighted state vectors are stored
+ * interleaved, and each gathered kernel value is multiplied by the elements of
+ * all of them at once.
+ *
+ * Only unilevel lattices are supported, since the candidates of each
+ * algorithm are compared by their merit values.
+ *
+ * \tparam LR           Type of lattice.
+ * \tparam COMPRESS     Type of compression.
+ * \tparam PLO          Type of per-level order.
+ * \tparam KERNEL       Kernel of the coordinate-uniform figures of merit.
+ */
+template <LatticeType LR, Compress COMPRESS, PerLevelOrder PLO, class KERNEL>
+class CoordUniformBatchCBC
+{
+public:
+   typedef LatBuilder::Storage<LR, EmbeddingType::UNILEVEL, COMPRESS, PLO> Storage;
+   typedef LatBuilder::LatDef<LR, EmbeddingType::UNILEVEL> LatDef;
+   typedef CoordUniformFigureOfMerit<KERNEL> FigureOfMerit;
+   typedef CoordUniformStateList<LR, EmbeddingType::UNILEVEL, COMPRESS, PLO> StateList;
+   typedef typename LatticeTraits<LR>::GenValue GenValue;
+
+   /**
+    * Maximum number of generator values whose inner products are computed
+    * together.
+    */
+   static constexpr size_t blockSize = 8;
+
+   /**
+    * Constructor.
+    *
+    * \param storage       Storage configuration.
+    * \param figures       Coordinate-uniform figures of merit, which must not
+    *                      be empty and must have the same kernel.  Kept as
+    *                      references, no copy made.
+    */
+   CoordUniformBatchCBC(
+         Storage storage,
+         const std::vector<const FigureOfMerit*>& figures
+         ):
+      m_storage(std::move(storage)),
+      m_figures(figures)
+   {
+      if (m_figures.empty())
+         throw std::runtime_error("CoordUniformBatchCBC: empty list of figures of merit");
+      {
+         Memory::Scope memory(Memory::Component::KERNEL_VALUES);
+         m_kernelValues = m_figures.front()->kernel().valuesVector(this->storage());
+      }
+      for (const auto figure : m_figures)
+         m_states.push_back(CoordUniformStateCreator::create(this->storage(), figure->weights()));
+      reset();
+   }
+
+   /**
+    * Resets the state of the CBC algorithms to dimension 0.
+    */
+   void reset()
+   {
+      m_baseLats.assign(size(), LatDef(storage().sizeParam()));
+      m_baseMerits.assign(size(), 0.0);
+      for (auto& states : m_states) {
+         for (auto& state : states)
+            state->reset();
+      }
+   }
+
+   /**
+    * Returns the number of CBC algorithms.
+    */
+   size_t size() const
+   { return m_figures.size(); }
+
+   /**
+    * Returns the storage configuration instance.
+    */
+   const Storage& storage() const
+   { return m_storage; }
+
+   /**
+    * Returns the figure of merit of the CBC algorithm \c i.
+    */
+   const FigureOfMerit& figureOfMerit(size_t i) const
+   { return *m_figures[i]; }
+
+   /**
+    * Returns the lattice selected so far by the CBC algorithm \c i.
+    */
+   const LatDef& baseLat(size_t i) const
+   { return m_baseLats[i]; }
+
+   /**
+    * Returns the merit value of the lattice selected so far by the CBC
+    * algorithm \c i.
+    */
+   Real baseMerit(size_t i) const
+   { return m_baseMerits[i]; }
+
+   /**
+    * Appends to the generating vector of the lattice of each CBC algorithm
+    * the value of \c genSeq which minimizes its merit value, the first one in
+    * case of ties.  The blocks of candidates are shared by the workers of the
+    * global ThreadPool, and their best candidates are combined in order with
+    * ThreadPool::parallelReduce().
+    *
+    * \param genSeq    Sequence of generator values.
+    */
+   template <typename GENSEQ>
+   void select(const GENSEQ& genSeq)
+   {
+      const std::vector<GenValue> gens(genSeq.begin(), genSeq.end());
+      if (gens.empty())
+         throw std::runtime_error("CoordUniformBatchCBC: empty sequence of generator values");
+
+      const size_t numSearches = size();
+      const size_t n = storage().size();
+
+      // the weighted states, with the compression weights, interleaved by index
+      const RealVector sumWeights = compressedSumWeights(storage());
+      std::vector<Real> weights(n * numSearches);
+      for (size_t j = 0; j < numSearches; j++) {
+         const RealVector state = weightedState(j);
+         if (state.size() != n)
+            throw std::logic_error("invalid size of weighted state vector");
+         for (size_t i = 0; i < n; i++)
+            weights[i * numSearches + j] = state[i] * sumWeights[i];
+      }
+
+      // best candidate of each search, for each block, combined in the order of the blocks
+      typedef std::pair<std::vector<Real>, std::vector<size_t>> Best;
+      const Best none(std::vector<Real>(numSearches, std::numeric_limits<Real>::infinity()), std::vector<size_t>(numSearches, gens.size()));
+
+      const Best best = ThreadPool::global().parallelReduce(gens.size(), blockSize, none,
+            [&](unsigned int, size_t first, size_t last)
+            {
+               const size_t count = last - first;
+               std::vector<Stride> strides;
+               strides.reserve(count);
+               for (size_t k = 0; k < count; k++)
+                  strides.emplace_back(storage(), gens[first + k]);
+
+               std::vector<Real> sums(count * numSearches, 0.0);
+               for (size_t i = 0; i < n; i++) {
+                  const Real* w = &weights[i * numSearches];
+                  for (size_t k = 0; k < count; k++) {
+                     const Real value = m_kernelValues[strides[k](i)];
+                     Real* s = &sums[k * numSearches];
+                     for (size_t j = 0; j < numSearches; j++)
+                        s[j] += w[j] * value;
+                  }
+               }
+
+               Best blockBest = none;
+               for (size_t k = 0; k < count; k++) {
+                  for (size_t j = 0; j < numSearches; j++) {
+                     Real merit = sums[k * numSearches + j];
+                     storage().sizeParam().normalize(merit);
+                     merit += m_baseMerits[j];
+                     // the first candidate of the block in case of ties
+                     if (merit < blockBest.first[j]) {
+                        blockBest.first[j] = merit;
+                        blockBest.second[j] = first + k;
+                     }
+                  }
+               }
+               return blockBest;
+            },
+            [&](Best acc, const Best& blockBest)
+            {
+               // the earlier blocks come first in case of ties
+               for (size_t j = 0; j < numSearches; j++) {
+                  if (blockBest.first[j] < acc.first[j]) {
+                     acc.first[j] = blockBest.first[j];
+                     acc.second[j] = blockBest.second[j];
+                  }
+               }
+               return acc;
+            });
+
+      for (size_t j = 0; j < numSearches; j++) {
+         const Real bestMerit = best.first[j];
+         const size_t bestIndex = best.second[j];
+         if (bestIndex == gens.size())
+            throw std::runtime_error("CoordUniformBatchCBC: no finite merit value"); // all the merit values are infinite or NaN
+         const GenValue& gen = gens[bestIndex];
+         m_baseMerits[j] = bestMerit;
+         m_baseLats[j].gen().push_back(gen);
+         for (auto& state : m_states[j])
+            state->update(m_kernelValues, gen);
+      }
+   }
+
+private:
+   typedef typename Storage::Stride Stride;
+
+   Storage m_storage;
+   std::vector<const FigureOfMerit*> m_figures;
+   RealVector m_kernelValues;
+   std::vector<StateList> m_states;
+   std::vector<LatDef> m_baseLats;
+   std::vector<Real> m_baseMerits;
+
+   // total weighted state of the CBC algorithm j
+   RealVector weightedState(size_t j) const
+   {
+      auto it = m_states[j].begin();
+      if (it == m_states[j].end())
+         throw std::runtime_error("CoordUniformBatchCBC: empty list of states");
+      auto out = (*it)->weightedState();
+      while (++it != m_states[j].end())
+         out += (*it)->weightedState();
+      return out;
+   }
+};
+
+}}
+
+#endif
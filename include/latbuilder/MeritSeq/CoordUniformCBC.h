@@ -99,6 +99,31 @@ public:
          state->reset();
    }
 
+   /**
+    * State of the algorithm for its base lattice.
+    *
+    * Copying the list of states copies each of them (see ClonePtr).
+    *
+    * \copydetails CBC::State
+    */
+   struct State {
+      LatDef baseLat;
+      MeritValue baseMerit;
+      StateList states;
+   };
+
+   //! \copydoc CBC::state()
+   State state() const
+   { return State{m_baseLat, m_baseMerit, m_states}; }
+
+   //! \copydoc CBC::restore()
+   void restore(const State& state)
+   {
+      m_baseLat = state.baseLat;
+      m_baseMerit = state.baseMerit;
+      m_states = state.states;
+   }
+
    /**
     * Returns the storage configuration instance.
     */
@@ -314,10 +339,10 @@ public:
    void select(const IT& it)
    {
       m_baseMerit = *it;
-      m_baseLat = *it.base(); 
+      m_baseLat = it.base()->latDef();
       GenValue gen = *it.base().base();
       for (auto& state : m_states)
-         state->update(m_innerProd.kernelValues(), gen);
+         m_innerProd.updateState(*state, gen);
    }
 
 private:
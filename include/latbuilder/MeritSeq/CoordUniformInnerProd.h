@@ -19,7 +19,8 @@
 
 #include "latbuilder/MeritSeq/CoordUniformStateCreator.h"
 #include "latbuilder/BridgeSeq.h"
-#include "latbuilder/BridgeIteratorCached.h"
+#include "latbuilder/BridgeIteratorBlocked.h"
+#include "latbuilder/Prefetcher.h"
 #include "latbuilder/Kernel/Base.h"
 #include "latbuilder/Storage.h"
 #include "latbuilder/CompressedSum.h"
@@ -27,11 +28,27 @@
 #include <boost/numeric/ublas/expression_types.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 namespace LatBuilder { namespace MeritSeq {
 
 /**
  * Standard implementation of the inner product for a sequence of vector with a
  * single vector.
+ *
+ * The inner products are computed by blocks of consecutive generator values,
+ * so that each element of the weighted state vector is loaded once for all
+ * the candidates of the block.  This inner product is used by the CBC
+ * constructions which do not compute the products of all the generator
+ * values at once with FFT's (see CoordUniformInnerProdFast and
+ * CoordUniformInnerProdGroup).
+ *
+ * If the kernel supports it and the on-the-fly evaluation is enabled (see
+ * Kernel::OnTheFly), the permuted kernel values are computed block by block
+ * by the function returned by Kernel::Base::stridedValues() instead of being
+ * gathered from a stored vector, and that vector is not created.
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO >
 class CoordUniformInnerProd {
@@ -39,6 +56,13 @@ public:
    typedef Storage<LR, ET, COMPRESS, PLO> InternalStorage;
    typedef CoordUniformStateList<LR, ET, COMPRESS, PLO> StateList;
    typedef typename Storage<LR, ET, COMPRESS, PLO>::MeritValue MeritValue;
+   typedef typename LatticeTraits<LR>::GenValue GenValue;
+
+   /**
+    * Second operand of the inner products, with the compression weights
+    * applied, shared by the sequences of inner products created from it.
+    */
+   typedef std::shared_ptr<const RealVector> WeightedVector;
 
    /**
     * Constructor.
@@ -54,7 +78,9 @@ public:
          const Kernel::Base<K>& kernel
          ):
       m_storage(std::move(storage)),
-      m_kernelValues(kernel.valuesVector(this->internalStorage()))
+      m_stridedValues(kernel.stridedValues(this->internalStorage())),
+      m_kernelValues(m_stridedValues ? RealVector() : kernel.valuesVector(this->internalStorage())),
+      m_sumWeights(compressedSumWeights(this->internalStorage()))
    {}
 
    /**
@@ -71,10 +97,43 @@ public:
 
    /**
     * Returns the vector of kernel values.
+    *
+    * The vector is empty if the kernel values are evaluated on the fly.
     */
    const RealVector& kernelValues() const
    { return m_kernelValues; }
 
+   /**
+    * Returns \c true if the kernel values are evaluated on the fly.
+    */
+   bool onTheFly() const
+   { return static_cast<bool>(m_stridedValues); }
+
+   /**
+    * Updates \c state with the kernel values permuted by the generator value
+    * \c gen, computing them on the fly if needed.
+    */
+   void updateState(CoordUniformState<LR, ET, COMPRESS, PLO>& state, GenValue gen) const
+   { updateState(internalStorage(), state, gen); }
+
+   /**
+    * Returns the second operand \c vec of the inner products with the
+    * compression weights applied.
+    *
+    * The sequences created by prodSeq() from the returned vector share it, so
+    * that a caller computing several sequences with the same operand, such as
+    * one sequence for each candidate, prepares it only once.
+    */
+   template <typename E>
+   WeightedVector weightedVector(const boost::numeric::ublas::vector_expression<E>& vec) const
+   {
+      if (vec().size() != internalStorage().size())
+         throw std::logic_error("invalid size of weighted state vector");
+      auto out = std::make_shared<RealVector>(vec());
+      boost::numeric::ublas::noalias(*out) = boost::numeric::ublas::element_prod(*out, m_sumWeights);
+      return out;
+   }
+
 
 public:
    /**
@@ -88,7 +147,7 @@ public:
          Seq<GENSEQ>,                           // self type
          GENSEQ,                                // base type
          MeritValue,                            // value type
-         BridgeIteratorCached> {
+         BridgeIteratorBlocked> {
 
    public:
 
@@ -112,23 +171,75 @@ public:
          ):
          Seq::BridgeSeq_(std::move(genSeq)),
          m_parent(parent),
-         m_constVec(vec())
-      { 
-         const auto size = m_parent.internalStorage().size();
-         if (m_constVec.size() != size)
-            throw std::logic_error("invalid size of weighted state vector");
-      }
+         m_weightedVec(parent.weightedVector(vec))
+      {}
+
+      /**
+       * Constructor.
+       *
+       * \param parent     Parent inner product instance.
+       * \param genSeq     Sequence of generator sequences that determines the
+       *                   order of the permutations of \c baseVec.
+       * \param vec        Second operand in the inner product, as returned by
+       *                   weightedVector().  Shared, no copy made.
+       */
+      Seq(
+            const CoordUniformInnerProd& parent,
+            GenSeq genSeq,
+            WeightedVector vec
+         ):
+         Seq::BridgeSeq_(std::move(genSeq)),
+         m_parent(parent),
+         m_weightedVec(std::move(vec))
+      {}
+
+      /**
+       * Maximum number of generator values of which the inner products are
+       * computed together.
+       */
+      static constexpr size_type blockSize = 8;
+
+      /**
+       * Smallest storage size for which the next block of inner products is
+       * computed in the background (see Prefetcher), so that a block is worth
+       * the hand-off to the background thread.
+       */
+      static constexpr size_type prefetchSize = size_type(1) << 14;
+
+      /**
+       * Returns \c true if the next block of inner products is to be
+       * computed in the background while the current one is consumed.
+       */
+      bool prefetch() const
+      { return m_parent.internalStorage().size() >= prefetchSize and Prefetcher::enabled(); }
 
       MeritValue element(const typename Base::const_iterator& it) const
+      {
+         MeritValue merit;
+         elements(it, 1, &merit);
+         return merit;
+      }
+
+      /**
+       * Computes the inner products for the \c count generator values
+       * starting at \c first, and stores them in \c out.
+       */
+      void elements(typename Base::const_iterator first, size_type count, MeritValue* out) const
       {
          const auto& st = m_parent.internalStorage();
-         return compressedSum(
-               st,
-               boost::numeric::ublas::element_prod(
-                  m_constVec,
-                  st.strided(m_parent.m_kernelValues, *it)
-                  )
-               );
+         if (m_parent.onTheFly()) {
+            std::vector<GenValue> gens;
+            gens.reserve(count);
+            for (size_type k = 0; k < count; ++k, ++first)
+               gens.push_back(*first);
+            m_parent.sums(st, *m_weightedVec, gens, out);
+            return;
+         }
+         std::vector<Stride> strides;
+         strides.reserve(count);
+         for (size_type k = 0; k < count; ++k, ++first)
+            strides.emplace_back(st, *first);
+         m_parent.sums(st, *m_weightedVec, strides, out);
       }
 
       /**
@@ -139,7 +250,7 @@ public:
 
    private:
       const CoordUniformInnerProd& m_parent;
-      const RealVector m_constVec;
+      WeightedVector m_weightedVec;
    };
 
    /**
@@ -157,13 +268,112 @@ public:
          ) const
    { return Seq<GENSEQ>(*this, genSeq, vec); }
 
+   /**
+    * Creates a new sequence of inner product values with the second operand
+    * \c vec returned by weightedVector().
+    *
+    * \param genSeq     Sequence of generator values.
+    * \param vec        Second operand in the inner product.  Shared, no copy
+    *                   made.
+    */
+   template <typename GENSEQ>
+   Seq<GENSEQ> prodSeq(
+         const GENSEQ& genSeq,
+         WeightedVector vec
+         ) const
+   { return Seq<GENSEQ>(*this, genSeq, std::move(vec)); }
+
 
 private:
    template <class> friend class Seq;
 
+   typedef typename InternalStorage::Stride Stride;
+
+   // number of kernel values computed at once by m_stridedValues
+   static constexpr size_t onTheFlyBlockSize = 256;
+
+   /**
+    * Adds to \c sums the sums over the indices \c i from \c first to \c
+    * last - 1 of <code>weights[i]</code> times the kernel value at the
+    * index given by each element of \c strides.
+    */
+   void accumulate(const RealVector& weights, const std::vector<Stride>& strides, size_t first, size_t last, Real* sums) const
+   {
+      const auto numStrides = strides.size();
+      for (size_t i = first; i < last; i++) {
+         const Real w = weights[i];
+         for (size_t k = 0; k < numStrides; k++)
+            sums[k] += w * m_kernelValues[strides[k](i)];
+      }
+   }
+
+   /**
+    * Same as above, with the kernel values at the indices given by the stride
+    * permutation of each element of \c gens computed on the fly.  The sums
+    * are accumulated in the same order.
+    */
+   void accumulate(const RealVector& weights, const std::vector<GenValue>& gens, size_t first, size_t last, Real* sums) const
+   {
+      Real values[onTheFlyBlockSize];
+      for (size_t begin = first; begin < last; begin += onTheFlyBlockSize) {
+         const size_t end = std::min(begin + onTheFlyBlockSize, last);
+         for (size_t k = 0; k < gens.size(); k++) {
+            m_stridedValues(gens[k], begin, end, values);
+            Real sum = sums[k];
+            for (size_t i = begin; i < end; i++)
+               sum += weights[i] * values[i - begin];
+            sums[k] = sum;
+         }
+      }
+   }
+
+   template <Compress C, PerLevelOrder P>
+   void updateState(const Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, C, P>& storage, CoordUniformState<LR, ET, COMPRESS, PLO>& state, GenValue gen) const
+   {
+      if (!onTheFly()) {
+         state.update(m_kernelValues, gen);
+         return;
+      }
+      // the values are already permuted: the state applies the identity
+      // permutation of stride 1 to them
+      RealVector values(storage.size());
+      if (values.size() > 0)
+         m_stridedValues(gen, 0, values.size(), &values[0]);
+      state.update(values, 1);
+   }
+
+   template <class STORAGE>
+   void updateState(const STORAGE&, CoordUniformState<LR, ET, COMPRESS, PLO>& state, GenValue gen) const
+   { state.update(m_kernelValues, gen); }
+
+   template <Compress C, PerLevelOrder P, class STRIDE>
+   void sums(const Storage<LR, EmbeddingType::UNILEVEL, C, P>& storage, const RealVector& weights, const std::vector<STRIDE>& strides, MeritValue* out) const
+   {
+      std::fill(out, out + strides.size(), 0.0);
+      accumulate(weights, strides, 0, storage.size(), out);
+   }
+
+   template <Compress C, PerLevelOrder P, class STRIDE>
+   void sums(const Storage<LR, EmbeddingType::MULTILEVEL, C, P>& storage, const RealVector& weights, const std::vector<STRIDE>& strides, MeritValue* out) const
+   {
+      const auto ranges = storage.levelRanges();
+      std::vector<Real> cumulative(strides.size(), 0.0);
+      for (size_t k = 0; k < strides.size(); k++)
+         out[k] = RealVector(ranges.size());
+      Level level = 0;
+      for (const auto& range : ranges) {
+         accumulate(weights, strides, range.start(), range.start() + range.size(), cumulative.data());
+         for (size_t k = 0; k < strides.size(); k++)
+            out[k](level) = cumulative[k];
+         ++level;
+      }
+   }
+
 private:
    Storage<LR, ET, COMPRESS, PLO> m_storage;
+   Kernel::StridedValues<LR> m_stridedValues;
    RealVector m_kernelValues;
+   RealVector m_sumWeights;
 };
 
 }}
@@ -0,0 +1,248 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__MERIT_SEQ__INNER_PROD_CYCLIC_H
+#define LATBUILDER__MERIT_SEQ__INNER_PROD_CYCLIC_H
+
+#include "latbuilder/MeritSeq/CoordUniformStateCreator.h"
+#include "latbuilder/BridgeSeq.h"
+#include "latbuilder/BridgeIteratorCached.h"
+#include "latbuilder/Kernel/Base.h"
+#include "latbuilder/Storage.h"
+#include "latbuilder/CompressedSum.h"
+
+#include <boost/numeric/ublas/expression_types.hpp>
+#include <boost/numeric/ublas/vector_proxy.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace LatBuilder { namespace MeritSeq {
+
+/**
+ * Inner product for a sequence of vectors with a single vector, on the
+ * kernel values stored in the inverse-cyclic per-level order.
+ *
+ * For an integer power of a prime base, the points of each level are stored
+ * in the order of the powers of a generator of the group of units, so that
+ * the stride permutation of a generator value is a cyclic shift of each level
+ * (of each half of the level in base 2 without symmetric compression).  The
+ * inner product with the permuted kernel values is thus computed over a few
+ * runs of consecutive elements of both vectors, without index tables nor
+ * random accesses, for any sequence of generator values.  This is the
+ * product of the Korobov constructions which evaluate a few candidates
+ * exhaustively, for which computing the products of the whole group of units
+ * with CoordUniformInnerProdFast would be wasted.
+ *
+ * The values of the unilevel constructions are those of the highest level.
+ */
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+class CoordUniformInnerProdCyclic {
+public:
+   typedef Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PerLevelOrder::CYCLIC> InternalStorage;
+   typedef CoordUniformStateList<LR, EmbeddingType::MULTILEVEL, COMPRESS, PerLevelOrder::CYCLIC> StateList;
+   typedef typename Storage<LR, ET, COMPRESS>::MeritValue MeritValue;
+   typedef typename LatticeTraits<LR>::GenValue GenValue;
+
+   /**
+    * Second operand of the inner products, with the compression weights
+    * applied, shared by the sequences of inner products created from it.
+    */
+   typedef std::shared_ptr<const RealVector> WeightedVector;
+
+   /**
+    * Constructor.
+    *
+    * \param storage       Storage configuration.
+    * \param kernel        Kernel.  Used to create a sequence of
+    *                      permuatations of the kernel values evaluated at every
+    *                      one-dimensional lattice point.
+    */
+   template <class K>
+   CoordUniformInnerProdCyclic(
+         Storage<LR, ET, COMPRESS, PLO> storage,
+         const Kernel::Base<K>& kernel
+         ):
+      m_storage(std::move(storage)),
+      m_internalStorage(asIntenalStorage(this->storage())),
+      m_kernelValues(kernel.valuesVector(this->internalStorage())),
+      m_sumWeights(compressedSumWeights(this->internalStorage()))
+   {}
+
+   /**
+    * Returns the storage configuration instance.
+    */
+   const Storage<LR, ET, COMPRESS, PLO>& storage() const
+   { return m_storage; }
+
+   /**
+    * Returns the internal storage configuration instance.
+    */
+   const InternalStorage& internalStorage() const
+   { return m_internalStorage; }
+
+   /**
+    * Returns the vector of kernel values.
+    */
+   const RealVector& kernelValues() const
+   { return m_kernelValues; }
+
+   /**
+    * Updates \c state with the kernel values permuted by the generator value
+    * \c gen.
+    */
+   void updateState(CoordUniformState<LR, EmbeddingType::MULTILEVEL, COMPRESS, PerLevelOrder::CYCLIC>& state, GenValue gen) const
+   { state.update(m_kernelValues, gen); }
+
+   /**
+    * Returns the second operand \c vec of the inner products with the
+    * compression weights applied.
+    */
+   template <typename E>
+   WeightedVector weightedVector(const boost::numeric::ublas::vector_expression<E>& vec) const
+   {
+      if (vec().size() != internalStorage().size())
+         throw std::logic_error("invalid size of weighted state vector");
+      auto out = std::make_shared<RealVector>(vec());
+      boost::numeric::ublas::noalias(*out) = boost::numeric::ublas::element_prod(*out, m_sumWeights);
+      return out;
+   }
+
+public:
+   /**
+    * Sequence of inner product values.
+    *
+    * \tparam GENSEQ    Type of sequence of generator values.
+    */
+   template <class GENSEQ>
+   class Seq :
+      public BridgeSeq<
+         Seq<GENSEQ>,                           // self type
+         GENSEQ,                                // base type
+         MeritValue,                            // value type
+         BridgeIteratorCached> {
+
+   public:
+
+      typedef GENSEQ GenSeq;
+      typedef typename Seq::Base Base;
+      typedef typename Seq::size_type size_type;
+
+      /**
+       * Constructor.
+       *
+       * \param parent     Parent inner product instance.
+       * \param genSeq     Sequence of generator sequences that determines the
+       *                   order of the permutations of \c baseVec.
+       * \param vec        Second operand in the inner product.
+       */
+      template <typename E>
+      Seq(
+            const CoordUniformInnerProdCyclic& parent,
+            GenSeq genSeq,
+            const boost::numeric::ublas::vector_expression<E>& vec
+         ):
+         Seq::BridgeSeq_(std::move(genSeq)),
+         m_parent(parent),
+         m_weightedVec(parent.weightedVector(vec))
+      {}
+
+      /**
+       * Returns the parent inner product of this sequence.
+       */
+      const CoordUniformInnerProdCyclic& innerProd() const
+      { return m_parent; }
+
+      MeritValue element(const typename Base::const_iterator& it) const
+      {
+         MeritValue merit = m_parent.storage().createMeritValue(0.0);
+         return storeMeritValue(merit, m_parent.sums(*m_weightedVec, *it));
+      }
+
+   private:
+      const CoordUniformInnerProdCyclic& m_parent;
+      WeightedVector m_weightedVec;
+
+      Real& storeMeritValue(Real& dest, const RealVector& src) const
+      { return dest = src(src.size() - 1); }
+
+      RealVector& storeMeritValue(RealVector& dest, RealVector src) const
+      { return dest = std::move(src); }
+   };
+
+   /**
+    * Creates a new sequence of inner product values by applying a stride
+    * permutation based on \c genSeq to the vector of kernel values, then by
+    * computing the inner product with \c vec.
+    *
+    * \param genSeq     Sequence of generator values.
+    * \param vec        Second operand in the inner product.
+    */
+   template <typename GENSEQ, typename E>
+   Seq<GENSEQ> prodSeq(
+         const GENSEQ& genSeq,
+         const boost::numeric::ublas::vector_expression<E>& vec
+         ) const
+   { return Seq<GENSEQ>(*this, genSeq, vec); }
+
+private:
+   template <class> friend class Seq;
+
+   typedef typename InternalStorage::Stride Stride;
+
+   /**
+    * Returns the cumulative per-level sums of <code>weights[i]</code> times
+    * the kernel value at the index of \c i in the stride permutation of \c
+    * gen.
+    */
+   RealVector sums(const RealVector& weights, GenValue gen) const
+   {
+      const Stride map(internalStorage(), gen);
+      const auto ranges = internalStorage().levelRanges();
+      RealVector out(ranges.size());
+      const Real* const w = &weights[0];
+      const Real* const k = &m_kernelValues[0];
+      Real cumulative = 0.0;
+      Level level = 0;
+      for (const auto& range : ranges) {
+         map.forEachRun(range.start(), range.start() + range.size(), [&] (size_t i, size_t j, size_t len) {
+               Real sum = 0.0;
+               for (size_t t = 0; t < len; t++)
+                  sum += w[i + t] * k[j + t];
+               cumulative += sum;
+               });
+         out(level++) = cumulative;
+      }
+      return out;
+   }
+
+   InternalStorage asIntenalStorage(const InternalStorage& s)
+   { return s; }
+
+   template <EmbeddingType L, Compress C, PerLevelOrder P>
+   InternalStorage asIntenalStorage(const Storage<LR, L, C, P>& s)
+   { return InternalStorage(s.sizeParam().modulus()); }
+
+private:
+   Storage<LR, ET, COMPRESS, PLO> m_storage;
+   InternalStorage m_internalStorage;
+   RealVector m_kernelValues;
+   RealVector m_sumWeights;
+};
+
+}}
+
+#endif
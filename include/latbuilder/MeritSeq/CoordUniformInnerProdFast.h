@@ -24,11 +24,18 @@
 #include "latbuilder/CachedSeq.h"
 #include "latbuilder/IndexMap.h"
 #include "latbuilder/fftw++.h"
+#include "latbuilder/NTTConvolution.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Memory.h"
+#include "latbuilder/Trace.h"
 
 #include <boost/numeric/ublas/expression_types.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace LatBuilder { namespace MeritSeq {
@@ -48,6 +55,14 @@ namespace detail {
  * vector with a single vector.
  *
  * Implemented for integer powers of prime bases, as proposed in \cite rCOO06a .
+ * In base 2 without symmetric compression, the group of units is not cyclic
+ * and each level consists of two circulant half-blocks, which are multiplied
+ * separately.
+ *
+ * If NTTConvolution is enabled when the instance is created, the products
+ * are computed with exact integer transforms instead of the FFT (see
+ * NTTConvolution::setEnabled), which bounds their rounding errors
+ * independently of the number of points.
  *
  * Computes the inner product with a second vector for all vectors in the
  * sequence at once.
@@ -81,7 +96,9 @@ public:
       m_internalStorage(asIntenalStorage(this->storage())),
       m_kernelValues(kernel.valuesVector(this->internalStorage())),
       m_levelRanges(cacheLevelRanges()),
-      m_circulantFFT(computeCirculantFFT())
+      m_circulantFFT(NTTConvolution::enabled() ? std::vector<std::vector<FFTComplexVector>>() : computeCirculantFFT()),
+      m_circulantNTT(NTTConvolution::enabled() ? computeCirculantNTT() : std::vector<std::vector<NTTConvolution>>()),
+      m_workBuffers(std::make_shared<WorkBuffers>())
    {}
 
    /**
@@ -102,6 +119,13 @@ public:
    const RealVector& kernelValues() const
    { return m_kernelValues; }
 
+   /**
+    * Updates \c state with the kernel values permuted by the generator value
+    * \c gen.
+    */
+   void updateState(CoordUniformState<LR, EmbeddingType::MULTILEVEL, COMPRESS, PerLevelOrder::CYCLIC>& state, typename LatticeTraits<LR>::GenValue gen) const
+   { state.update(m_kernelValues, gen); }
+
    /**
     * Returns the vector of per-level ranges of indices.
     */
@@ -109,14 +133,28 @@ public:
    { return m_levelRanges; }
 
    /**
-    * Returns the FFT's of the first column of each circulant submatrix in the
-    * horizontal block-circulant matrix.
+    * Returns, for each level, the FFT's of the first column of each circulant
+    * submatrix in the horizontal block-circulant matrix: one per level, or two
+    * half-blocks per level of size at least 2 in base 2 without symmetric
+    * compression.
     */
-   const std::vector<FFTComplexVector>& circulantFFT() const
+   const std::vector<std::vector<FFTComplexVector>>& circulantFFT() const
    { return m_circulantFFT; }
 
 
 private:
+   /**
+    * FFT-compatible work buffers of each worker, kept across the calls to
+    * computeProdValues() so that they are allocated for the largest level
+    * once instead of for every coordinate.
+    */
+   struct WorkBuffers {
+      std::mutex mutex;
+      std::vector<FFTRealVector> rvecs;
+      std::vector<FFTComplexVector> cvecs;
+      std::vector<FFTComplexVector> cvecs2;
+   };
+
    std::vector<boost::numeric::ublas::range> cacheLevelRanges() const
    {
       const auto ranges = m_internalStorage.levelRanges();
@@ -125,74 +163,267 @@ private:
       return out;
    }
 
+   /**
+    * Returns \c true if the levels consist of two circulant half-blocks
+    * instead of a single circulant block, which is the case in base 2 without
+    * symmetric compression for levels of size at least 2.
+    */
+   bool halfBlocks() const
+   {
+      return LR == LatticeType::ORDINARY and not internalStorage().symmetric()
+         and internalStorage().sizeParam().base() == 2;
+   }
+
+   /**
+    * Returns the index, in the level of size \c levelSize, of the merit value
+    * associated to the generator value at index \c i in the sequence of
+    * generator values of the maximal level, of size \c seqSize.
+    *
+    * With half-blocks, the first and the second halves of the level are
+    * associated to the first and the second halves of the generator values.
+    */
+   size_t levelIndex(size_t i, size_t seqSize, size_t levelSize) const
+   {
+      if (halfBlocks() and levelSize >= 2) {
+         const size_t half = levelSize / 2;
+         return (i >= seqSize / 2 ? half : 0) + i % half;
+      }
+      return i % levelSize;
+   }
+
+   /**
+    * Stores in \c dest the \c n values at \c values plus the \c tileSize
+    * values at \c tile repeated periodically, that is, <tt>dest[i] =
+    * values[i] + tile[i % tileSize]</tt>, one whole tile at a time so that
+    * the inner loop has no modulo.  \c dest may be equal to \c values.
+    */
+   static void addTiled(const Real* values, Real* dest, size_t n, const Real* tile, size_t tileSize)
+   {
+      for (size_t start = 0; start < n; start += tileSize) {
+         const size_t len = std::min(tileSize, n - start);
+         const Real* const v = values + start;
+         Real* const d = dest + start;
+         for (size_t j = 0; j < len; j++)
+            d[j] = v[j] + tile[j];
+      }
+   }
+
+   /**
+    * Stores in the elements <tt>[begin, begin + n)</tt> of level \c level of
+    * \c out the \c n values at \c values plus the contributions from the
+    * lower levels, which must already be included in level <tt>level -
+    * 1</tt> of \c out.
+    *
+    * With half-blocks, the elements must lie in a single half of the level,
+    * because the half of the generator values must be preserved on the lower
+    * level (see #levelIndex).
+    */
+   void addLowerLevel(const Real* values, size_t level, size_t begin, size_t n, RealVector& out) const
+   {
+      const auto& range = levelRanges()[level];
+      const auto& lower = levelRanges()[level - 1];
+      const Real* tile = &out[lower.start()];
+      size_t tileSize = lower.size();
+      if (halfBlocks() and range.size() >= 2 and tileSize >= 2) {
+         tileSize /= 2;
+         if (begin >= range.size() / 2)
+            tile += tileSize;
+      }
+      addTiled(values, &out[range.start() + begin], n, tile, tileSize);
+   }
+
+   /**
+    * Returns the ratio of the number of natural elements to the number of
+    * internal elements on level \c level.
+    */
+   Real compressionRatio(size_t level) const
+   {
+      if(LR == LatticeType::ORDINARY){
+        if (internalStorage().symmetric() and level >= (internalStorage().sizeParam().base() == 2 ? 2u : 1u)) {
+           // compressionRatio except if uncompressed level has only one element
+           return 2;
+        }
+      }
+      return 1;
+   }
+
+   /**
+    * Stores in \c out the products on level \c level, computed with the exact
+    * convolutions.
+    */
+   template <class V>
+   void exactProdValues(const V& vec, size_t level, RealVector& out) const
+   {
+      using namespace boost::numeric::ublas;
+
+      const auto& range = levelRanges()[level];
+      const auto& circulant = m_circulantNTT[level];
+      const size_t size = circulant[0].size();
+
+      vector_range<const V> subvec(vec, range);
+      std::vector<Real> in(subvec.begin(), subvec.end());
+      std::vector<Real> prod(size);
+      Real* const dest = &out[range.start()];
+
+      if (circulant.size() == 2) {
+         // same products as with the FFT's of the half-blocks
+         const Real* const v0 = in.data();
+         const Real* const v1 = in.data() + size;
+         circulant[0].apply(v0, dest);
+         circulant[1].apply(v1, prod.data());
+         for (size_t i = 0; i < size; i++)
+            dest[i] += prod[i];
+         circulant[1].apply(v0, dest + size);
+         circulant[0].apply(v1, prod.data());
+         for (size_t i = 0; i < size; i++)
+            dest[size + i] += prod[i];
+         return;
+      }
+
+      circulant[0].apply(in.data(), dest);
+      const Real ratio = compressionRatio(level);
+      if (ratio != 1)
+         for (size_t i = 0; i < size; i++)
+            dest[i] *= ratio;
+   }
+
    template <class E>
    RealVector computeProdValues(
          const boost::numeric::ublas::vector_expression<E>& ve
          ) const
    {
-      if(LR == LatticeType::ORDINARY){
-        // in base 2, on each level, we have 2 circulant half-blocks instead of
-        // a single circulant block
-        if (not internalStorage().symmetric() and internalStorage().sizeParam().base() == 2)
-           throw std::logic_error("not implemented for non-symmetric vectors in base 2");
-       }
-
       const auto& vec = ve();
       using namespace boost::numeric::ublas;
+      Memory::Scope memory(Memory::Component::FFT_BUFFERS);
 
-      auto itRange = levelRanges().begin();
-      auto itRangePrev = itRange;
-      auto itCirculantFFT = circulantFFT().begin();
+      const size_t numLevels = levelRanges().size();
+      const bool exact = not m_circulantNTT.empty();
+      if ((exact ? m_circulantNTT.size() : circulantFFT().size()) < numLevels)
+         throw std::logic_error("circulant FFT's have too few levels");
 
       RealVector out(vec.size());
 
-      while (itRange != levelRanges().end()) {
+      size_t maxLevelSize = 0;
+      for (const auto& range : levelRanges())
+         maxLevelSize = std::max(maxLevelSize, range.size());
+
+      // The levels are independent until the contributions from the lower
+      // levels are added, so their products are computed concurrently, each
+      // worker reusing its own FFT-compatible buffers.  The buffers are kept
+      // from one call to the next; a call made while another one is using
+      // them falls back to buffers of its own.
+      ThreadPool& pool = ThreadPool::global();
+      std::unique_lock<std::mutex> lock(m_workBuffers->mutex, std::try_to_lock);
+      WorkBuffers ownBuffers;
+      WorkBuffers& buffers = lock.owns_lock() ? *m_workBuffers : ownBuffers;
+      if (buffers.rvecs.size() < pool.size()) {
+         buffers.rvecs.resize(pool.size());
+         buffers.cvecs.resize(pool.size());
+         buffers.cvecs2.resize(pool.size());
+      }
+
+      // With a single worker, the levels are computed in increasing order, so
+      // the contributions from the lower levels are added while the products
+      // are copied out of the FFT buffers, instead of in a second pass.
+      const bool fused = not exact and pool.size() == 1;
+      auto store = [&] (const FFTRealVector& values, size_t level, size_t begin) {
+         if (fused and level > 0)
+            addLowerLevel(&values[0], level, begin, values.size(), out);
+         else
+            std::copy(values.begin(), values.end(), &out[levelRanges()[level].start() + begin]);
+      };
+
+      pool.parallelFor(numLevels, [&] (unsigned int worker, size_t level) {
+
+         Profiler::Scope scope(Profiler::Timer::FFT);
+         Trace::Span span("fft", "fft", "level", level);
+         if (exact) {
+            exactProdValues(vec, level, out);
+            return;
+         }
+
+         const auto& range = levelRanges()[level];
+         FFTRealVector& rvec = buffers.rvecs[worker];
+         FFTComplexVector& cvec = buffers.cvecs[worker];
+         if (rvec.capacity() < maxLevelSize) {
+            rvec.reserve(maxLevelSize);
+            cvec.reserve(maxLevelSize / 2 + 1);
+         }
 
-         if (itCirculantFFT == circulantFFT().end())
-            throw std::logic_error("circulant FFT's have too few levels");
+         const auto& circulant = circulantFFT()[level];
+
+         if (circulant.size() == 2) {
+            // The merit values of the first half of the generator values are
+            // C0 v0 + C1 v1 and those of the second half are C1 v0 + C0 v1,
+            // where v0 and v1 are the halves of the level and C0 and C1 are
+            // the circulant half-blocks.
+            const size_t half = range.size() / 2;
+            FFTComplexVector& cvec2 = buffers.cvecs2[worker];
+            vector_range<const RealVector> subvec0(vec, boost::numeric::ublas::range(range.start(), range.start() + half));
+            vector_range<const RealVector> subvec1(vec, boost::numeric::ublas::range(range.start() + half, range.start() + range.size()));
+
+            rvec.assign(subvec0.begin(), subvec0.end());
+            cvec.resize(fftw<Real>::fft_size(rvec));
+            fftw<Real>::fft(rvec, cvec);
+
+            rvec.assign(subvec1.begin(), subvec1.end());
+            cvec2.resize(cvec.size());
+            fftw<Real>::fft(rvec, cvec2);
+
+            for (size_t i = 0; i < cvec.size(); i++) {
+               const auto x0 = cvec[i];
+               const auto x1 = cvec2[i];
+               cvec[i] = x0 * circulant[0][i] + x1 * circulant[1][i];
+               cvec2[i] = x0 * circulant[1][i] + x1 * circulant[0][i];
+            }
+
+            fftw<Real>::ifft(cvec, rvec, true);
+            store(rvec, level, 0);
+            fftw<Real>::ifft(cvec2, rvec, true);
+            store(rvec, level, half);
+            return;
+         }
 
          // select vector range
-         vector_range<const RealVector> subvec(vec, *itRange);
+         vector_range<const RealVector> subvec(vec, range);
 
          // convert to FFT-compatible vectors
-         FFTRealVector rvec(subvec.begin(), subvec.end());
+         rvec.assign(subvec.begin(), subvec.end());
+         cvec.resize(fftw<Real>::fft_size(rvec));
 
          // compute FFT
-         FFTComplexVector cvec = fftw<Real>::fft(rvec);
+         fftw<Real>::fft(rvec, cvec);
 
          // ratio of the number or natural elements to the number of internal
          // elements, multiplied by normalization
-         size_t compressionRatio = 1;
-         if(LR == LatticeType::ORDINARY){
-           if (internalStorage().symmetric() and (itRange - levelRanges().begin()) >= (internalStorage().sizeParam().base() == 2 ? 2 : 1)) {
-              // compressionRatio except if uncompressed level has only one element
-              compressionRatio = 2;
-           }
-         }
+         const Real ratio = compressionRatio(level);
 
          // multiply in Fourier space
          for (size_t i = 0; i < cvec.size(); i++)
-            cvec[i] *= compressionRatio * (*itCirculantFFT)[i];
+            cvec[i] *= ratio * circulant[0][i];
 
          // inverse transform
          fftw<Real>::ifft(cvec, rvec, true);
 
          // export to the output vector
-         std::copy(rvec.begin(), rvec.end(), &out[itRange->start()]);
-
-         // add contributions from lower levels
-         if (itRange != itRangePrev) {
-            typedef typename vector_range<RealVector>::size_type size_type;
-            vector_range<RealVector> curLevel(out, *itRange);
-            vector_range<const RealVector> prevLevel(out, *itRangePrev);
-            for (size_type i = 0; i < curLevel.size(); i++)
-               curLevel[i] += prevLevel[i % prevLevel.size()];
+         store(rvec, level, 0);
+      });
+
+      if (fused)
+         return out;
+
+      // add contributions from lower levels
+      for (size_t level = 1; level < numLevels; level++) {
+         const auto& range = levelRanges()[level];
+         Real* const curLevel = &out[range.start()];
+         if (halfBlocks() and range.size() >= 2) {
+            const size_t half = range.size() / 2;
+            addLowerLevel(curLevel, level, 0, half, out);
+            addLowerLevel(curLevel + half, level, half, range.size() - half, out);
+         }
+         else {
+            addLowerLevel(curLevel, level, 0, range.size(), out);
          }
-
-         itRangePrev = itRange;
-
-         ++itCirculantFFT;
-         ++itRange;
       }
 
       return out;
@@ -250,13 +481,15 @@ public:
       MeritValue element(const typename Base::const_iterator& it) const
       {
          RealVector mlMerit(m_parent.levelRanges().size());
+         const size_t index = it - it.seq().begin();
+         const size_t seqSize = m_parent.levelRanges().back().size();
          for (
                auto itRange = m_parent.levelRanges().begin();
                itRange != m_parent.levelRanges().end();
                ++itRange
                ) {
             boost::numeric::ublas::vector_range<const RealVector> curLevel(m_values, *itRange);
-            mlMerit[itRange - m_parent.levelRanges().begin()] = curLevel[(it - it.seq().begin()) % curLevel.size()];
+            mlMerit[itRange - m_parent.levelRanges().begin()] = curLevel[m_parent.levelIndex(index, seqSize, curLevel.size())];
          }
 
          MeritValue merit = m_parent.storage().createMeritValue(0.0);
@@ -296,22 +529,24 @@ private:
     * Computes the FFT's of the first column of each circulant submatrix in the
     * horizontal block-circulant matrix.
     */
-   std::vector<FFTComplexVector> computeCirculantFFT() const
+   std::vector<std::vector<FFTComplexVector>> computeCirculantFFT() const
    {
+      Profiler::Scope scope(Profiler::Timer::KERNEL_SETUP);
+      Memory::Scope memory(Memory::Component::FFT_BUFFERS);
       const auto ranges = levelRanges();
 
-      std::vector<FFTComplexVector> result(ranges.size());
+      std::vector<std::vector<FFTComplexVector>> result(ranges.size());
 
-      for (
-            auto itRange = ranges.begin();
-            itRange != ranges.end();
-            ++itRange
-            ) {
+      // the blocks are independent, so their FFT's are computed concurrently
+      const auto blocks = allCirculantBlocks();
+      for (const auto& block : blocks)
+         result[block.level].resize(block.rank + 1);
 
+      ThreadPool::global().parallelFor(blocks.size(), [&] (unsigned int, size_t i) {
          // select level
          boost::numeric::ublas::vector_range<const RealVector> lvec(
                kernelValues(),
-               *itRange
+               blocks[i].range
                );
 
          // apply circulant-transpose
@@ -321,13 +556,81 @@ private:
          FFTRealVector rvec(tvec.begin(), tvec.begin() + tvec.size());
 
          // compute FFT
-         result[itRange - ranges.begin()] =
-            fftw<Real>::fft(rvec);
-      }
+         result[blocks[i].level][blocks[i].rank] = fftw<Real>::fft(rvec);
+      });
+
+      return result;
+   }
+
+   /**
+    * Prepares the exact convolutions with the first column of each circulant
+    * submatrix, in the same layout as computeCirculantFFT().
+    */
+   std::vector<std::vector<NTTConvolution>> computeCirculantNTT() const
+   {
+      Profiler::Scope scope(Profiler::Timer::KERNEL_SETUP);
+      Memory::Scope memory(Memory::Component::FFT_BUFFERS);
+      const auto ranges = levelRanges();
+
+      std::vector<std::vector<NTTConvolution>> result(ranges.size());
+
+      const auto blocks = allCirculantBlocks();
+      for (const auto& block : blocks)
+         result[block.level].resize(block.rank + 1);
+
+      ThreadPool::global().parallelFor(blocks.size(), [&] (unsigned int, size_t i) {
+         boost::numeric::ublas::vector_range<const RealVector> lvec(
+               kernelValues(),
+               blocks[i].range
+               );
+         const auto tvec = circulantTranspose(lvec);
+         const std::vector<Real> values(tvec.begin(), tvec.begin() + tvec.size());
+         result[blocks[i].level][blocks[i].rank] = NTTConvolution(values.data(), values.size());
+      });
 
       return result;
    }
 
+   // circulant block of rank \c rank in level \c level
+   struct CirculantBlock {
+      size_t level;
+      size_t rank;
+      boost::numeric::ublas::range range;
+   };
+
+   /**
+    * Returns the circulant blocks of all levels, level by level, as
+    * independent units of work for the thread pool.
+    */
+   std::vector<CirculantBlock> allCirculantBlocks() const
+   {
+      const auto ranges = levelRanges();
+      std::vector<CirculantBlock> blocks;
+      for (size_t level = 0; level < ranges.size(); level++) {
+         size_t rank = 0;
+         for (const auto& block : circulantBlocks(ranges[level]))
+            blocks.push_back(CirculantBlock{level, rank++, block});
+      }
+      return blocks;
+   }
+
+   /**
+    * Returns the ranges of the circulant blocks of the level with range \c
+    * range: the whole level, or its two halves with half-blocks.
+    */
+   std::vector<boost::numeric::ublas::range> circulantBlocks(const boost::numeric::ublas::range& range) const
+   {
+      std::vector<boost::numeric::ublas::range> blocks;
+      if (halfBlocks() and range.size() >= 2) {
+         const size_t half = range.size() / 2;
+         blocks.emplace_back(range.start(), range.start() + half);
+         blocks.emplace_back(range.start() + half, range.start() + range.size());
+      }
+      else
+         blocks.push_back(range);
+      return blocks;
+   }
+
    InternalStorage asIntenalStorage(const InternalStorage& s)
    { return s; }
 
@@ -364,7 +667,9 @@ private:
    InternalStorage m_internalStorage;
    RealVector m_kernelValues;
    std::vector<boost::numeric::ublas::range> m_levelRanges;
-   std::vector<FFTComplexVector> m_circulantFFT;
+   std::vector<std::vector<FFTComplexVector>> m_circulantFFT;
+   std::vector<std::vector<NTTConvolution>> m_circulantNTT;
+   std::shared_ptr<WorkBuffers> m_workBuffers;
 };
 
 
@@ -0,0 +1,430 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__MERIT_SEQ__INNER_PROD_GROUP_H
+#define LATBUILDER__MERIT_SEQ__INNER_PROD_GROUP_H
+
+#include "latbuilder/MeritSeq/CoordUniformStateCreator.h"
+#include "latbuilder/BridgeSeq.h"
+#include "latbuilder/BridgeIteratorCached.h"
+#include "latbuilder/Kernel/Base.h"
+#include "latbuilder/Storage.h"
+#include "latbuilder/CompressTraits.h"
+#include "latbuilder/GenSeq/CyclicGroup.h"
+#include "latbuilder/fftw++.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Memory.h"
+#include "latbuilder/Util.h"
+
+#include <boost/numeric/ublas/expression_types.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace LatBuilder { namespace MeritSeq {
+
+/**
+ * FFT-based implementation of the inner product for a sequence of vectors
+ * with a single vector, for ordinary unilevel lattices of any number of
+ * points.
+ *
+ * The indices \f$i \in \mathbb Z_n\f$ are partitioned into orbits according
+ * to their greatest common divisor \f$d\f$ with \f$n\f$: \f$i = d j\f$, where
+ * \f$j\f$ is a unit of \f$\mathbb Z_{n/d}\f$, and the stride permutation of a
+ * generator value \f$a\f$ maps each orbit onto itself, as the multiplication
+ * of \f$j\f$ by \f$a \bmod n/d\f$.  By the Chinese remainder theorem, the
+ * group of units \f$\mathbb Z_{n/d}^*\f$ is the direct product of the groups
+ * of units of the prime powers dividing \f$n/d\f$, which are cyclic, except
+ * that of \f$2^e\f$ for \f$e \geq 3\f$, which is generated by \f$-1\f$ and
+ * \f$5\f$.  With the units indexed by their exponents of these generators,
+ * the products of an orbit for all the generator values form a
+ * multidimensional circulant product, computed with a multidimensional FFT,
+ * and the inner product for \f$a\f$ is the sum over the orbits of the product
+ * of the orbit at the index of \f$a \bmod n/d\f$.  The orbits sum to \f$n\f$
+ * elements, hence the cost is that of FFT's of \f$n\f$ elements overall, for
+ * every number of points.
+ *
+ * This is the product of the fast CBC constructions of the numbers of points
+ * which are not prime powers, for which CoordUniformInnerProdFast does not
+ * apply.  The products are looked up by generator value, so that any
+ * sequence of generator values coprime with \f$n\f$ can be used.
+ */
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+class CoordUniformInnerProdGroup {
+
+   static_assert(LR == LatticeType::ORDINARY and ET == EmbeddingType::UNILEVEL,
+         "the group of units product is implemented only for ordinary unilevel lattices");
+
+protected:
+   typedef typename fftw<Real>::real_vector FFTRealVector;
+   typedef typename fftw<Real>::complex_vector FFTComplexVector;
+
+public:
+   typedef Storage<LR, ET, COMPRESS, PLO> InternalStorage;
+   typedef CoordUniformStateList<LR, ET, COMPRESS, PLO> StateList;
+   typedef typename Storage<LR, ET, COMPRESS, PLO>::MeritValue MeritValue;
+   typedef typename LatticeTraits<LR>::GenValue GenValue;
+
+   /**
+    * Constructor.
+    *
+    * \param storage       Storage configuration.
+    * \param kernel        Kernel.  Used to create a sequence of
+    *                      permuatations of the kernel values evaluated at every
+    *                      one-dimensional lattice point.
+    */
+   template <class K>
+   CoordUniformInnerProdGroup(
+         Storage<LR, ET, COMPRESS, PLO> storage,
+         const Kernel::Base<K>& kernel
+         ):
+      m_storage(std::move(storage)),
+      m_kernelValues(kernel.valuesVector(this->internalStorage())),
+      m_orbits(computeOrbits())
+   {}
+
+   /**
+    * Returns the storage configuration instance.
+    */
+   const Storage<LR, ET, COMPRESS, PLO>& storage() const
+   { return m_storage; }
+
+   /**
+    * Returns the storage configuration instance.
+    */
+   const Storage<LR, ET, COMPRESS, PLO>& internalStorage() const
+   { return m_storage; }
+
+   /**
+    * Returns the vector of kernel values.
+    */
+   const RealVector& kernelValues() const
+   { return m_kernelValues; }
+
+   /**
+    * Updates \c state with the kernel values permuted by the generator value
+    * \c gen.
+    */
+   void updateState(CoordUniformState<LR, ET, COMPRESS, PLO>& state, GenValue gen) const
+   { state.update(m_kernelValues, gen); }
+
+   /**
+    * Returns the number of orbits of the indices, that is, the number of
+    * divisors of the number of points.
+    */
+   size_t numOrbits() const
+   { return m_orbits.size(); }
+
+   /**
+    * Sequence of inner product values.
+    *
+    * \tparam GENSEQ    Type of sequence of generator values, which must be
+    *                   coprime with the number of points.
+    */
+   template <class GENSEQ>
+   class Seq :
+      public BridgeSeq<
+         Seq<GENSEQ>,                           // self type
+         GENSEQ,                                // base type
+         MeritValue,                            // value type
+         BridgeIteratorCached> {
+
+   public:
+
+      typedef GENSEQ GenSeq;
+      typedef typename Seq::Base Base;
+      typedef typename Seq::size_type size_type;
+
+      /**
+       * Constructor.
+       *
+       * \param parent     Parent inner product instance.
+       * \param genSeq     Sequence of generator sequences that determines the
+       *                   order of the permutations of \c baseVec.
+       * \param vec        Second operand in the inner product.
+       */
+      template <class E>
+      Seq(
+            const CoordUniformInnerProdGroup& parent,
+            GenSeq genSeq,
+            const boost::numeric::ublas::vector_expression<E>& vec
+            ):
+         Seq::BridgeSeq_(std::move(genSeq)),
+         m_parent(parent),
+         m_values(parent.computeProdValues(vec()))
+      {}
+
+      /**
+       * Returns the parent inner product of this sequence.
+       */
+      const CoordUniformInnerProdGroup& innerProd() const
+      { return m_parent; }
+
+      MeritValue element(const typename Base::const_iterator& it) const
+      { return m_values[m_parent.unitIndex(*it)]; }
+
+   private:
+      const CoordUniformInnerProdGroup& m_parent;
+      RealVector m_values;
+   };
+
+   /**
+    * Creates a new sequence of inner product values by applying a stride
+    * permutation based on \c genSeq to the vector of kernel values, then by
+    * computing the inner product with \c vec.
+    *
+    * \param genSeq     Sequence of generator values.
+    * \param vec        Second operand in the inner product.
+    */
+   template <class GENSEQ, class E>
+   Seq<GENSEQ> prodSeq(
+         const GENSEQ& genSeq,
+         const boost::numeric::ublas::vector_expression<E>& vec
+         ) const
+   { return Seq<GENSEQ>(*this, genSeq, vec); }
+
+private:
+   typedef CompressTraits<COMPRESS> Compress;
+
+   /**
+    * Orbit of the indices \f$d j\f$, for the units \f$j\f$ of \f$\mathbb Z_m\f$,
+    * where \f$m = n/d\f$.
+    */
+   struct Orbit {
+      uInteger modulus;                   // m
+      uInteger multiplier;                // d
+      std::vector<int> dims;              // orders of the cyclic factors of the group of units
+      std::vector<uInteger> units;        // units, in row-major order of their exponents
+      std::vector<uint32_t> inverses;     // index of the inverse of each unit
+      std::vector<uint32_t> indices;      // index of each unit, by residue modulo m
+      Real kernelValue;                   // kernel value of the orbit, if it has a single unit
+      FFTComplexVector kernelFFT;         // FFT of the kernel values of the orbit, otherwise
+   };
+
+   /**
+    * Returns the generators of the cyclic factors of the group of units of the
+    * integers modulo \c modulus, with their orders.
+    */
+   static std::vector<std::pair<uInteger, int>> unitGenerators(uInteger modulus)
+   {
+      std::vector<std::pair<uInteger, int>> gens;
+      for (const auto& factor : primeFactorsMap(modulus)) {
+         const uInteger base = factor.first;
+         const Level power = static_cast<Level>(factor.second);
+         const uInteger primePower = intPow(base, power);
+         const uInteger order = primePower / base * (base - 1);
+
+         // generators modulo the prime power
+         std::vector<std::pair<uInteger, int>> local;
+         if (base == 2) {
+            if (power >= 2)
+               local.emplace_back(primePower - 1, 2);
+            if (power >= 3)
+               local.emplace_back(5, static_cast<int>(primePower / 4));
+         }
+         else {
+            local.emplace_back(GenSeq::CyclicGroup<LatticeType::ORDINARY, LatBuilder::Compress::NONE>::smallestGenerator(base, power), static_cast<int>(order));
+         }
+
+         // lifted to the generators congruent to 1 modulo the other prime powers
+         const uInteger rest = modulus / primePower;
+         const uInteger restInverse = modularPow(rest % primePower, order - 1, primePower);
+         for (const auto& gen : local) {
+            const uInteger lift = (gen.first + primePower - 1) % primePower * restInverse % primePower;
+            gens.emplace_back((1 + lift * rest) % modulus, gen.second);
+         }
+      }
+      return gens;
+   }
+
+   /**
+    * Returns the orbit of the divisor \c modulus of the number of points, with
+    * the FFT of its kernel values.
+    */
+   Orbit computeOrbit(uInteger modulus) const
+   {
+      const uInteger numPoints = storage().sizeParam().numPoints();
+      const auto gens = unitGenerators(modulus);
+      const size_t rank = gens.size();
+
+      Orbit orbit;
+      orbit.modulus = modulus;
+      orbit.multiplier = numPoints / modulus;
+      size_t size = 1;
+      for (const auto& gen : gens) {
+         orbit.dims.push_back(gen.second);
+         size *= gen.second;
+      }
+      orbit.units.resize(size);
+      orbit.inverses.resize(size);
+      orbit.indices.assign(modulus, 0);
+
+      std::vector<size_t> strides(rank, 1);
+      for (size_t i = rank; i-- > 1; )
+         strides[i - 1] = strides[i] * orbit.dims[i];
+
+      // enumerate the exponents in row-major order: partial[i] is the product
+      // of the first i generators raised to their exponents
+      std::vector<int> exponents(rank, 0);
+      std::vector<uInteger> partial(rank + 1, 1 % modulus);
+      for (size_t k = 0; k < size; k++) {
+         const uInteger unit = partial[rank];
+         orbit.units[k] = unit;
+         orbit.indices[unit] = static_cast<uint32_t>(k);
+         size_t inverse = 0;
+         for (size_t i = 0; i < rank; i++)
+            inverse += (orbit.dims[i] - exponents[i]) % orbit.dims[i] * strides[i];
+         orbit.inverses[k] = static_cast<uint32_t>(inverse);
+         for (size_t i = rank; i-- > 0; ) {
+            if (++exponents[i] < orbit.dims[i]) {
+               partial[i + 1] = partial[i + 1] * gens[i].first % modulus;
+               for (size_t j = i + 2; j <= rank; j++)
+                  partial[j] = partial[i + 1];
+               break;
+            }
+            exponents[i] = 0;
+         }
+      }
+
+      if (size == 1) {
+         orbit.kernelValue = kernelValue(orbit.multiplier * orbit.units[0]);
+         return orbit;
+      }
+      orbit.kernelValue = 0.0;
+      FFTRealVector rvec(size);
+      for (size_t k = 0; k < size; k++)
+         rvec[k] = kernelValue(orbit.multiplier * orbit.units[k]);
+      orbit.kernelFFT.resize(fftw<Real>::fft_size(orbit.dims));
+      fftw<Real>::fft(orbit.dims, rvec, orbit.kernelFFT);
+      return orbit;
+   }
+
+   /**
+    * Returns the orbits of all the divisors of the number of points, in
+    * increasing order of their moduli, so that the last one is the orbit of
+    * the units of the number of points.
+    */
+   std::vector<Orbit> computeOrbits() const
+   {
+      Profiler::Scope scope(Profiler::Timer::KERNEL_SETUP);
+      Memory::Scope memory(Memory::Component::FFT_BUFFERS);
+      const uInteger numPoints = storage().sizeParam().numPoints();
+      if (numPoints > UINT32_MAX)
+         throw std::invalid_argument("CoordUniformInnerProdGroup: too many points");
+
+      std::vector<uInteger> moduli;
+      for (uInteger d = 1; d * d <= numPoints; d++) {
+         if (numPoints % d == 0) {
+            moduli.push_back(d);
+            if (d * d != numPoints)
+               moduli.push_back(numPoints / d);
+         }
+      }
+      std::sort(moduli.begin(), moduli.end());
+
+      std::vector<Orbit> orbits(moduli.size());
+      ThreadPool::global().parallelFor(moduli.size(), [&] (unsigned int, size_t i) {
+            orbits[i] = computeOrbit(moduli[i]);
+         });
+      return orbits;
+   }
+
+   /**
+    * Returns the kernel value at the uncompressed index \c i.
+    */
+   Real kernelValue(uInteger i) const
+   { return m_kernelValues[Compress::compressIndex(i, storage().sizeParam().numPoints())]; }
+
+   /**
+    * Returns the index of the generator value \c gen in the vector returned by
+    * computeProdValues().
+    */
+   size_t unitIndex(GenValue gen) const
+   {
+      const Orbit& units = m_orbits.back();
+      return units.indices[gen % units.modulus];
+   }
+
+   /**
+    * Returns the inner products of the kernel values permuted by each unit of
+    * the number of points with the compressed vector \c vec, in the order of
+    * the units of the last orbit.
+    */
+   template <class V>
+   RealVector computeProdValues(const V& vec) const
+   {
+      if (vec.size() != internalStorage().size())
+         throw std::logic_error("invalid size of state vector");
+
+      Memory::Scope memory(Memory::Component::FFT_BUFFERS);
+      const uInteger numPoints = storage().sizeParam().numPoints();
+      auto value = [&] (uInteger i) { return vec[Compress::compressIndex(i, numPoints)]; };
+
+      // circulant product of each orbit: the products of the units u are the sums
+      // over the units j of K(d u j) v(d j), that is, the convolutions of the
+      // kernel values with the values of the vector at the inverse units
+      std::vector<FFTRealVector> products(m_orbits.size());
+      ThreadPool& pool = ThreadPool::global();
+      pool.parallelFor(m_orbits.size(), [&] (unsigned int, size_t o) {
+            Profiler::Scope scope(Profiler::Timer::FFT);
+            const Orbit& orbit = m_orbits[o];
+            const size_t size = orbit.units.size();
+            FFTRealVector& rvec = products[o];
+            rvec.resize(size);
+            for (size_t k = 0; k < size; k++)
+               rvec[orbit.inverses[k]] = value(orbit.multiplier * orbit.units[k]);
+            if (size == 1) {
+               rvec[0] *= orbit.kernelValue;
+               return;
+            }
+            FFTComplexVector cvec(orbit.kernelFFT.size());
+            fftw<Real>::fft(orbit.dims, rvec, cvec);
+            for (size_t i = 0; i < cvec.size(); i++)
+               cvec[i] *= orbit.kernelFFT[i];
+            fftw<Real>::ifft(orbit.dims, cvec, rvec, true);
+         });
+
+      // sum of the products of the orbits at the residues of each unit
+      const Orbit& units = m_orbits.back();
+      RealVector out(units.units.size());
+      constexpr size_t grain = 1 << 12;
+      pool.parallelFor((out.size() + grain - 1) / grain, [&] (unsigned int, size_t block) {
+            const size_t end = std::min(out.size(), (block + 1) * grain);
+            for (size_t k = block * grain; k < end; k++) {
+               const uInteger unit = units.units[k];
+               Real sum = 0.0;
+               for (size_t o = 0; o < m_orbits.size(); o++) {
+                  const Orbit& orbit = m_orbits[o];
+                  sum += products[o][orbit.indices[unit % orbit.modulus]];
+               }
+               out[k] = sum;
+            }
+         });
+      return out;
+   }
+
+   Storage<LR, ET, COMPRESS, PLO> m_storage;
+   RealVector m_kernelValues;
+   std::vector<Orbit> m_orbits;
+};
+
+}}
+
+#endif
@@ -19,8 +19,11 @@
 
 #include "latbuilder/Types.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/StateIO.h"
 
+#include <istream>
 #include <memory>
+#include <ostream>
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -94,6 +97,34 @@ public:
     */
    virtual std::unique_ptr<CoordUniformState> clone() const = 0;
 
+   /**
+    * Writes the state to \c os, as described in StateIO, so that a search
+    * extending the point set can restore it with load() instead of updating a
+    * new state with all its coordinates.
+    *
+    * The derived classes write their vectors after calling this function,
+    * which writes the dimension and the number of points.
+    */
+   virtual void save(std::ostream& os) const
+   {
+      StateIO::write(os, m_dimension);
+      StateIO::writeSize(os, m_storage.size());
+   }
+
+   /**
+    * Replaces the state by the one written to \c is by save(), for the same
+    * storage configuration and weights.
+    *
+    * \throws std::runtime_error if the state was saved for another number of
+    * points or cannot be read.
+    */
+   virtual void load(std::istream& is)
+   {
+      StateIO::read(is, m_dimension);
+      if (StateIO::readSize(is) != m_storage.size())
+         throw std::runtime_error("the saved coordinate-uniform state has another number of points");
+   }
+
 private:
    Storage<LR, ET, COMPRESS, PLO> m_storage;
    Dimension m_dimension;
@@ -19,11 +19,14 @@
 
 #include "latbuilder/BridgeSeq.h"
 #include "latbuilder/BridgeIteratorCached.h"
+#include "latbuilder/SharedMinimum.h"
 #include "latbuilder/Traversal.h"
 
+#include <atomic>
 #include <type_traits>
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -34,6 +37,23 @@ namespace LatBuilder { namespace MeritSeq {
  * by applying the CBC algorithm for each component, but considering only the
  * current generator value instead of all values from a sequence of generator
  * values like in the original CBC algorithm. 
+ *
+ * The components selected for a lattice are kept in the CBC algorithm for the
+ * next lattice of the same sequence, as long as they are shared by both
+ * lattices: in a Cartesian product of generator sequences, where the last
+ * component varies the fastest, most lattices cost the evaluation of their
+ * last component only.  The CBC algorithm is thus not reset between lattices,
+ * and the instances of the sequence of merit values created from the same
+ * LatSeqOverCBC instance must not be iterated concurrently.
+ *
+ * If a shared minimum is set with setSharedMinimum(), the partial merit value
+ * of the components selected so far is compared with the minimum before each
+ * component is selected, and the computation is abandoned as soon as it
+ * exceeds the minimum, since the merit value of a lattice only grows with its
+ * components: the partial merit value is then returned.  For Korobov lattices,
+ * whose components all differ from one lattice to the next, most lattices
+ * are thus discarded after a few components.  The minimum is ignored for
+ * embedded lattices.
  * 
  * \tparam CBC		Type of CBC algorithm.
  */
@@ -42,6 +62,15 @@ class LatSeqOverCBC
 {
    typedef LatSeqOverCBC<CBC> self_type;
 
+   /**
+    * Indices of the generator values selected in the CBC algorithm, and
+    * identifier of the sequence of merit values they belong to (0 if none).
+    */
+   struct Selection {
+      size_t seq = 0;
+      std::vector<size_t> indices;
+   };
+
 public:
    /**
     * Constructor.
@@ -49,12 +78,23 @@ public:
     * \param cbc  Instance of the CBC algorithm to be used.
     */
    LatSeqOverCBC(CBC cbc):
-      m_cbc(new CBC(std::move(cbc)))
+      m_cbc(new CBC(std::move(cbc))),
+      m_selection(new Selection),
+      m_minimum(nullptr)
    {}
 
    const CBC& cbc() const
    { return *m_cbc; }
 
+   /**
+    * Sets the shared minimum against which the partial merit values of the
+    * lattices of the sequences created afterwards are compared after each
+    * component, or disables the comparisons if \c minimum is \c nullptr (the
+    * default).
+    */
+   void setSharedMinimum(const SharedMinimum* minimum)
+   { m_minimum = minimum; }
+
    /**
     * Output sequence of merit values.
     *
@@ -80,11 +120,16 @@ public:
        * Constructor.
        *
        * \param cbc        Instance of the CBC algorithm.
+       * \param selection  Components selected in the CBC algorithm.
+       * \param minimum    Shared minimum, or \c nullptr.
        * \param base       Base lattice sequence.
        */
-      Seq(CBC& cbc, Base base):
+      Seq(CBC& cbc, Selection& selection, const SharedMinimum* minimum, Base base):
          self_type::BridgeSeq_(std::move(base)),
-         m_cbc(cbc)
+         m_cbc(cbc),
+         m_selection(selection),
+         m_minimum(minimum),
+         m_id(nextId())
       {}
 
       /**
@@ -93,30 +138,75 @@ public:
        */
       value_type element(const typename Base::const_iterator& it) const
       {
-         m_cbc.reset();
-
          if (m_cbc.baseLat().sizeParam() != it->sizeParam())
             throw std::logic_error("inconsistent lattice size");
 
-         for (
-               auto genIt = it.base().seqIterators().begin();
-               genIt != it.base().seqIterators().end();
-               ++genIt
-               ) {
+         const auto& genIts = it.base().seqIterators();
+         if (genIts.empty()) {
+            m_cbc.reset();
+            m_selection.seq = 0;
+            return m_cbc.baseMerit();
+         }
 
-            // rebind the base generator sequence to a sequence of unit size
-            // starting at the current generator index
-            auto genSeq = genIt->seq().rebind(
-                  Traversal::Forward(genIt->index(), 1));
+         // keep the components selected for the previous lattice up to the
+         // first one that differs
+         auto& selected = m_selection.indices;
+         size_t common = 0;
+         if (m_selection.seq == m_id) {
+            while (common < selected.size() and common + 1 < genIts.size() and selected[common] == genIts[common].index())
+               common++;
+         }
+         if (m_selection.seq != m_id or common < selected.size()) {
+            m_cbc.reset();
+            selected.clear();
+         }
 
-            m_cbc.select(m_cbc.meritSeq(genSeq).begin());
+         // the selection is invalid until all components are selected
+         m_selection.seq = 0;
+         for (size_t j = selected.size(); j + 1 < genIts.size(); j++) {
+            if (exceeds(m_cbc.baseMerit())) {
+               // the remaining components can only increase the merit value
+               m_selection.seq = m_id;
+               return m_cbc.baseMerit();
+            }
+            m_cbc.select(m_cbc.meritSeq(unitSeq(genIts[j])).begin());
+            selected.push_back(genIts[j].index());
          }
+         m_selection.seq = m_id;
 
-         return m_cbc.baseMerit();
+         // the last component is evaluated but not selected
+         return *m_cbc.meritSeq(unitSeq(genIts.back())).begin();
       }
 
    private:
       CBC& m_cbc;
+      Selection& m_selection;
+      const SharedMinimum* m_minimum;
+      size_t m_id;
+
+      bool exceeds(Real merit) const
+      { return m_minimum and not m_minimum->accepts(merit); }
+
+      template <typename MERIT>
+      bool exceeds(const MERIT&) const
+      { return false; }
+
+      /**
+       * Rebinds the base generator sequence to a sequence of unit size
+       * starting at the current generator index.
+       */
+      template <typename GENIT>
+      static auto unitSeq(const GENIT& genIt) -> decltype(genIt.seq().rebind(Traversal::Forward()))
+      { return genIt.seq().rebind(Traversal::Forward(genIt.index(), 1)); }
+
+      /**
+       * Returns a new identifier, shared by the copies of the sequence.
+       */
+      static size_t nextId()
+      {
+         static std::atomic<size_t> last(0);
+         return ++last;
+      }
    };
 
    /**
@@ -127,10 +217,12 @@ public:
     */
    template <typename LATSEQ>
    Seq<LATSEQ> meritSeq(LATSEQ latSeq) const
-   { return Seq<LATSEQ>(*m_cbc, std::move(latSeq)); }
+   { return Seq<LATSEQ>(*m_cbc, *m_selection, m_minimum, std::move(latSeq)); }
 
 private:
    std::unique_ptr<CBC> m_cbc;
+   std::unique_ptr<Selection> m_selection;
+   const SharedMinimum* m_minimum;
 };
 
 /// Creates a search algorithm on top of a CBC algorithm.
@@ -0,0 +1,98 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__MERIT_SEQ__STATE_BLOCKS_H
+#define LATBUILDER__MERIT_SEQ__STATE_BLOCKS_H
+
+#include "latbuilder/StateMatrix.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Types.h"
+
+#include <algorithm>
+
+namespace LatBuilder { namespace MeritSeq { namespace detail {
+
+/**
+ * Number of points of the coordinate-uniform states processed at once, so
+ * that the permuted kernel values of a block and the corresponding slices of
+ * the state vectors stay in cache.
+ */
+constexpr size_t STATE_BLOCK_SIZE = 512;
+
+/**
+ * Number of points of the coordinate-uniform states given at once to a worker
+ * of the shared thread pool.
+ */
+constexpr size_t STATE_CHUNK_SIZE = 64 * STATE_BLOCK_SIZE;
+
+/**
+ * Calls \c body(begin, end) for consecutive blocks of at most
+ * STATE_BLOCK_SIZE points covering <tt>[0, n)</tt>.  The blocks are
+ * independent, so they are processed by chunks on the shared thread pool.
+ */
+template <class BODY>
+void forEachStateBlock(size_t n, const BODY& body)
+{
+   const size_t numChunks = (n + STATE_CHUNK_SIZE - 1) / STATE_CHUNK_SIZE;
+   ThreadPool::global().parallelFor(numChunks, [&] (unsigned int, size_t chunk) {
+      const size_t chunkEnd = std::min((chunk + 1) * STATE_CHUNK_SIZE, n);
+      for (size_t begin = chunk * STATE_CHUNK_SIZE; begin < chunkEnd; begin += STATE_BLOCK_SIZE)
+         body(begin, std::min(begin + STATE_BLOCK_SIZE, chunkEnd));
+   });
+}
+
+/**
+ * Same as above, for the blocks of the rows of \c state.  Each worker asks
+ * for the points of its next chunk in \c state to be read ahead while it
+ * processes the current one.
+ */
+template <class BODY>
+void forEachStateBlock(size_t n, const StateMatrix& state, const BODY& body)
+{
+   const size_t numChunks = (n + STATE_CHUNK_SIZE - 1) / STATE_CHUNK_SIZE;
+   const size_t numWorkers = ThreadPool::global().size();
+   ThreadPool::global().parallelFor(numChunks, [&] (unsigned int, size_t chunk) {
+      const size_t chunkEnd = std::min((chunk + 1) * STATE_CHUNK_SIZE, n);
+      if (chunk + numWorkers < numChunks)
+         state.prefetch((chunk + numWorkers) * STATE_CHUNK_SIZE, (chunk + numWorkers + 1) * STATE_CHUNK_SIZE);
+      for (size_t begin = chunk * STATE_CHUNK_SIZE; begin < chunkEnd; begin += STATE_BLOCK_SIZE)
+         body(begin, std::min(begin + STATE_BLOCK_SIZE, chunkEnd));
+   });
+}
+
+/**
+ * \name Block kernels
+ *
+ * Loops over the \c n values of a block of the states, compiled for each of
+ * the instruction sets selected at run time (see LATNETBUILDER_TARGET_CLONES).
+ */
+//@{
+/// <tt>out[i] += a[i] * b[i]</tt>.
+void addProduct(Real* out, const Real* a, const Real* b, size_t n);
+
+/// <tt>out[i] += weight * in[i]</tt>.
+void addScaled(Real* out, Real weight, const Real* in, size_t n);
+
+/// <tt>out[i] = a[i] * in[i]</tt>.
+void multiply(Real* out, const Real* a, const Real* in, size_t n);
+
+/// <tt>out[i] *= weight</tt>.
+void scale(Real* out, Real weight, size_t n);
+//@}
+
+}}}
+
+#endif
@@ -0,0 +1,117 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Shared modules of the constructions, loaded on demand.
+ */
+
+#ifndef LATBUILDER__MODULE_H
+#define LATBUILDER__MODULE_H
+
+#include <string>
+#include <utility>
+
+// In modular builds (configured with --modular), the core library is
+// complemented by a shared module per lattice type and per net construction,
+// each compiled from the instantiation units with one of the following macros
+// defined, so that it only instantiates the tasks of its construction.  In
+// monolithic builds, none of them is defined and every construction is
+// instantiated.
+#if defined(LATBUILDER_MODULE_LATTICE_ORDINARY)
+#define LATBUILDER_WITH_LATTICE_ORDINARY 1
+#define LATBUILDER_WITH_LATTICE_POLYNOMIAL 0
+#elif defined(LATBUILDER_MODULE_LATTICE_POLYNOMIAL)
+#define LATBUILDER_WITH_LATTICE_ORDINARY 0
+#define LATBUILDER_WITH_LATTICE_POLYNOMIAL 1
+#else
+#define LATBUILDER_WITH_LATTICE_ORDINARY 1
+#define LATBUILDER_WITH_LATTICE_POLYNOMIAL 1
+#endif
+
+/**
+ * Returns a pointer to the entry point \c function of the module \c module.
+ *
+ * In modular builds, the module is loaded by Module::load() the first time
+ * one of its entry points is needed.  Otherwise, the entry point is linked in
+ * and this is simply its address.  The entry points are declared
+ * <code>extern "C"</code>, so that their symbol is their name.
+ */
+#ifdef LATNETBUILDER_MODULAR
+#define LATNETBUILDER_MODULE_ENTRY(module, function) \
+   (LatBuilder::Module::load(module).entry<decltype(function)>(#function))
+#else
+#define LATNETBUILDER_MODULE_ENTRY(module, function) (&function)
+#endif
+
+namespace LatBuilder
+{
+
+/**
+ * Shared module of a modular build.
+ *
+ * The module named \c name is the shared library
+ * <code>liblatnetbuilder-<name>.so</code> of the module directory, given by
+ * the environment variable \c LATNETBUILDER_MODULE_PATH or else by the
+ * installation directory of the modules.  A module is loaded at most once and
+ * stays loaded until the program exits.
+ */
+class Module {
+public:
+   /**
+    * Returns the module named \c name, loading it if it is not loaded yet.
+    *
+    * Throws a <code>std::runtime_error</code> if the module cannot be loaded,
+    * or a <code>std::logic_error</code> if the build is not modular.
+    */
+   static const Module& load(const std::string& name);
+
+   /**
+    * Returns the directory in which the modules are looked for.
+    */
+   static std::string directory();
+
+   /**
+    * Returns the entry point \c symbol of the module, of type \c FUNCTION.
+    *
+    * Throws a <code>std::runtime_error</code> if the module has no such entry
+    * point.
+    */
+   template <typename FUNCTION>
+   FUNCTION* entry(const std::string& symbol) const
+   { return reinterpret_cast<FUNCTION*>(address(symbol)); }
+
+   /**
+    * Returns the name of the file of the module.
+    */
+   const std::string& fileName() const
+   { return m_fileName; }
+
+private:
+   Module(std::string fileName, void* handle):
+      m_fileName(std::move(fileName)),
+      m_handle(handle)
+   {}
+
+   void* address(const std::string& symbol) const;
+
+   std::string m_fileName;
+   void* m_handle;
+};
+
+}
+
+#endif
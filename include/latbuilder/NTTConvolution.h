@@ -0,0 +1,103 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Exact cyclic convolutions of fixed-point vectors.
+ */
+
+#ifndef LATBUILDER__NTT_CONVOLUTION_H
+#define LATBUILDER__NTT_CONVOLUTION_H
+
+#include "latbuilder/Types.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Cyclic convolution with a fixed vector, computed exactly with
+ * number-theoretic transforms.
+ *
+ * Both operands are rounded to fixed-point vectors, with integer mantissas
+ * of at most 45 bits, sign included, and a binary exponent common to the
+ * elements of a vector.  Their cyclic convolution is then computed exactly,
+ * with number-theoretic transforms modulo two primes of the form
+ * \f$c 2^{50} + 1\f$ and the Chinese remainder theorem.  Unlike with the
+ * floating-point FFT, the error on the output does not grow with the size of
+ * the vectors: it only depends on the rounding of the operands to 44
+ * significant bits relative to their largest element.  The size of the
+ * vectors is limited to \f$2^{32}\f$.
+ *
+ * The vectors whose size is not a power of two are padded with zeros to twice
+ * their size, and the linear convolution is folded back.
+ *
+ * Used by the fast CBC construction instead of the FFT if enabled with
+ * #setEnabled (see MeritSeq::CoordUniformInnerProdFast).
+ */
+class NTTConvolution {
+public:
+   NTTConvolution() = default;
+
+   /**
+    * Prepares the convolutions with the vector of the \c size elements
+    * starting at \c values.
+    */
+   NTTConvolution(const Real* values, size_t size);
+
+   /**
+    * Returns the size of the vectors.
+    */
+   size_t size() const
+   { return m_size; }
+
+   /**
+    * Stores in \c out the cyclic convolution of the vector \c vec with the
+    * fixed vector \f$\boldsymbol c\f$, that is,
+    * \f$\mathtt{out}_i = \sum_j \mathtt{vec}_j c_{(i - j) \bmod n}\f$, where \f$n\f$
+    * is size().
+    */
+   void apply(const Real* vec, Real* out) const;
+
+   /**
+    * Returns true if the fast CBC construction uses the exact convolutions.
+    */
+   static bool enabled()
+   { return s_enabled.load(std::memory_order_relaxed); }
+
+   /**
+    * Selects the exact convolutions, instead of the FFT, for the fast CBC
+    * constructions created afterwards.
+    */
+   static void setEnabled(bool value)
+   { s_enabled.store(value, std::memory_order_relaxed); }
+
+private:
+   static std::atomic<bool> s_enabled;
+
+   size_t m_size = 0;
+   size_t m_transformSize = 0;
+   int m_exponent = 0;
+   std::vector<std::uint64_t> m_transforms[2];
+};
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__NORM__BOUND_CACHE_H
+#define LATBUILDER__NORM__BOUND_CACHE_H
+
+#include "latbuilder/Types.h"
+
+#include "latticetester/Weights.h"
+
+#include <functional>
+#include <string>
+
+namespace LatBuilder { namespace Norm {
+
+/**
+ * Process-wide cache of the values of the bounds used for normalization.
+ *
+ * The values are identified by a key describing the bound, its smoothness and
+ * norm type, the weights, the size parameter, the dimension and the
+ * per-level normalization (see NormAlphaBase::operator()), so that the
+ * normalizers of the repeated searches, and the normalizers which share a
+ * bound, minimize it only once for each lattice size and dimension.
+ *
+ * If a file is set with setFile(), the values it contains are loaded and the
+ * values computed afterwards are appended to it, so that later processes
+ * reuse them.
+ */
+class BoundCache {
+public:
+   /**
+    * Returns the bound value identified by \c key, computed with \c compute if
+    * it is not in the cache.
+    */
+   static Real get(const std::string& key, const std::function<Real()>& compute);
+
+   /**
+    * Returns a short digest of \c weights, which identifies them in the keys.
+    */
+   static std::string digest(const LatticeTester::Weights& weights);
+
+   /**
+    * Loads the bound values stored in \c fileName, if it exists, and appends
+    * the values computed afterwards to it.  No file is used if \c fileName is
+    * empty (the default).
+    */
+   static void setFile(const std::string& fileName);
+
+   /**
+    * Removes all values from the cache.
+    */
+   static void clear();
+};
+
+}}
+
+#endif
@@ -19,11 +19,17 @@
 
 #include "latbuilder/Types.h"
 #include "latbuilder/SizeParam.h"
+#include "latbuilder/Norm/BoundCache.h"
+
+#include "latticetester/Weights.h"
 
 #include <boost/math/tools/minima.hpp>
 
 #include <limits>
 #include <functional>
+#include <sstream>
+#include <string>
+#include <typeinfo>
 
 namespace LatBuilder { namespace Norm {
 
@@ -43,11 +49,13 @@ public:
     * Constructor.
     * 
     * \param alpha         Smoothness level \f$\alpha\f$ of the class of functions.
+    * \param weights       Weights of the bound, which identify its values in
+    *                      the BoundCache.
     * \param normType      Type of cross-projection norm used by the figure of
     *                      merit.
     */
-   NormAlphaBase(unsigned int alpha, Real normType):
-      m_alpha(alpha), m_normType(normType)
+   NormAlphaBase(unsigned int alpha, const LatticeTester::Weights& weights, Real normType):
+      m_alpha(alpha), m_normType(normType), m_weightsDigest(BoundCache::digest(weights))
    {
       // bounds for minimization domain
       m_minExp = 1.0 / m_alpha * (1.0 + std::numeric_limits<Real>::epsilon());
@@ -86,6 +94,9 @@ public:
    /**
     * Returns the smallest value of the bound for dimension \c dimension.
     *
+    * The value is read from the BoundCache if the same bound was minimized
+    * before, with the same weights and parameters.
+    *
     * \param sizeParam  Size parameter for the lattices.
     * \param dimension  Dimension.
     * \param norm       Additional normalization \f$ c \f$.
@@ -96,7 +107,14 @@ public:
          Dimension dimension,
          Real norm = 1.0
          ) const
-   { return minimum(sizeParam, dimension, norm); }
+   {
+      std::ostringstream key;
+      key.precision(std::numeric_limits<Real>::max_digits10);
+      key << typeid(DERIVED).name() << ':' << derived().name() << ':' << alpha() << ':' << normType() << ':'
+         << m_weightsDigest << ':' << typeid(SizeParam<LR, L>).name() << ':' << sizeParam << ':'
+         << dimension << ':' << norm;
+      return BoundCache::get(key.str(), [&]() { return minimum(sizeParam, dimension, norm); });
+   }
 
    /**
     * Returns the minimum value of the bound function.
@@ -126,6 +144,7 @@ public:
 private:
    const unsigned m_alpha;
    Real m_normType;
+   std::string m_weightsDigest;
 
    Real m_minExp;
    Real m_maxExp;
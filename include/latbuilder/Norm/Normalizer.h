@@ -18,6 +18,7 @@
 #define LATBUILDER__NORM__NORMALIZER_H
 
 #include "latbuilder/MeritFilterList.h"
+#include "latbuilder/ThreadPool.h"
 
 #include <limits>
 #include <memory>
@@ -112,6 +113,11 @@ public:
     */
    MeritValue operator()(const MeritValue& merit, const LatDef& lat) const;
 
+   /**
+    * Normalizes the values in \c merit in place.
+    */
+   void apply(LevelVector& merit, const LatDef& lat) const;
+
    const Norm& norm() const
    { return m_norm; }
 
@@ -202,6 +208,25 @@ RealVector Normalizer<LR, EmbeddingType::MULTILEVEL, NORM>::operator()(
    return out;
 }
 
+template <LatticeType LR, class NORM>
+void Normalizer<LR, EmbeddingType::MULTILEVEL, NORM>::apply(
+      LevelVector& merit,
+      const LatDef& lat) const
+{
+   updateCache(lat.sizeParam(), lat.dimension());
+
+   if (merit.size() > m_levelWeights.size())
+      throw std::invalid_argument("Normalizer::apply(): "
+            "merit has more levels than the per-level weights");
+
+   // contiguous arrays on both sides: the loop is vectorized
+   const Real* const norm = m_cachedNorm.data().begin();
+   Real* const out = merit.data();
+   const LevelVector::size_type n = merit.size();
+   for (LevelVector::size_type j = 0; j < n; j++)
+      out[j] *= norm[j];
+}
+
 //================================================================================
 
 template <LatticeType LR, class NORM>
@@ -237,9 +262,11 @@ void Normalizer<LR, EmbeddingType::MULTILEVEL, NORM>::updateCache(
 
    m_cachedNorm.resize(m_levelWeights.size());
 
-   // pre-compute normalization factors
+   // pre-compute normalization factors; the bounds of the levels are
+   // minimized independently, hence concurrently
 
-   for (Level level = 0; level < m_cachedNorm.size(); level++) {
+   ThreadPool::global().parallelFor(m_cachedNorm.size(), [&] (unsigned int, size_t i) {
+      const Level level = Level(i);
 
       SizeParam<LR, EmbeddingType::MULTILEVEL> levelSizeParam(
             sizeParam.base(),
@@ -257,7 +284,7 @@ void Normalizer<LR, EmbeddingType::MULTILEVEL, NORM>::updateCache(
                dimension,
                m_levelWeights[level]
                );
-   }
+   });
 
    m_cachedSizeParam = sizeParam;
    m_cachedDimension = dimension;
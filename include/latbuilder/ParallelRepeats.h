@@ -0,0 +1,155 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Concurrent execution of independent repetitions of a randomized task.
+ */
+
+#ifndef LATBUILDER__PARALLEL_REPEATS_H
+#define LATBUILDER__PARALLEL_REPEATS_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/LFSR258.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Independent runs of a randomized task, executed concurrently on the shared
+ * thread pool (see ThreadPool::global()).
+ *
+ * Each run constructs its own task.  The task of run \f$i\f$ is constructed
+ * with stream \f$i\f$ of LFSR258 as the thread default seed (stream 0 starts
+ * at LFSR258::default_seed and stream \f$i+1\f$ is obtained from stream
+ * \f$i\f$ with LFSR258::nextStream()), so that the random generators of the
+ * runs do not overlap and the results do not depend on the number of threads.
+ * Run 0 thus gives the same result as the first run of a sequential loop.
+ */
+class ParallelRepeats
+{
+public:
+   /**
+    * Constructor.
+    * \param numRuns    Number of runs.
+    */
+   explicit ParallelRepeats(unsigned int numRuns);
+
+   /**
+    * Executes the runs and returns the task of the best run, that is, the run
+    * with the smallest merit value (or the first of them in case of ties).
+    *
+    * \param run     Function constructing and executing the task of the run
+    *                whose index it receives.  It is called concurrently.
+    * \param merit   Function returning the merit value of an executed task.
+    */
+   template <class TASK>
+   std::unique_ptr<TASK> execute(
+         const std::function<std::unique_ptr<TASK> (unsigned int)>& run,
+         const std::function<Real (const TASK&)>& merit);
+
+   /**
+    * Returns the number of runs.
+    */
+   unsigned int numRuns() const
+   { return (unsigned int) m_seeds.size(); }
+
+   /**
+    * Returns the merit values of the runs, in the order of the runs.
+    */
+   const std::vector<Real>& merits() const
+   { return m_merits; }
+
+   /**
+    * Returns the index of the best run.
+    */
+   unsigned int bestRun() const
+   { return m_bestRun; }
+
+   /**
+    * Returns the quantile of order \c p of the merit values, interpolated
+    * linearly between the order statistics.
+    */
+   Real quantile(Real p) const;
+
+   /**
+    * Returns the mean of the merit values.
+    */
+   Real mean() const;
+
+private:
+   /**
+    * Sets the thread default seed of LFSR258 for the lifetime of the object.
+    */
+   class SeedScope
+   {
+   public:
+      explicit SeedScope(const LFSR258::seed_type& seed);
+      ~SeedScope();
+   private:
+      LFSR258::seed_type m_previous;
+   };
+
+   std::vector<LFSR258::seed_type> m_seeds;
+   std::vector<Real> m_merits;
+   unsigned int m_bestRun;
+};
+
+/**
+ * Formats the merit values of the runs and their statistics, and outputs them
+ * on \c os.
+ */
+std::ostream& operator<<(std::ostream& os, const ParallelRepeats& repeats);
+
+template <class TASK>
+std::unique_ptr<TASK> ParallelRepeats::execute(
+      const std::function<std::unique_ptr<TASK> (unsigned int)>& run,
+      const std::function<Real (const TASK&)>& merit)
+{
+   m_merits.assign(numRuns(), Real(0));
+   m_bestRun = 0;
+
+   std::mutex mutex;
+   std::unique_ptr<TASK> best;
+   ThreadPool::global().parallelFor(numRuns(), [&](unsigned int, size_t i)
+   {
+      std::unique_ptr<TASK> task;
+      {
+         SeedScope scope(m_seeds[i]);
+         task = run((unsigned int) i);
+      }
+      const Real value = merit(*task);
+
+      std::lock_guard<std::mutex> lock(mutex);
+      m_merits[i] = value;
+      if (!best || value < m_merits[m_bestRun] || (value == m_merits[m_bestRun] && i < m_bestRun)) {
+         best = std::move(task);
+         m_bestRun = (unsigned int) i;
+      }
+   });
+   return best;
+}
+
+}
+
+#endif
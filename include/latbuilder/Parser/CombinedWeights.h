@@ -32,22 +32,48 @@ namespace LatBuilder { namespace Parser {
  */
 struct CombinedWeights {
    /**
-    * Parses a string specifying a file containing a description of combined weights.
+    * Parses a string specifying a text file containing a description of combined weights.
     *
     * Adds projection-dependent and order-dependent weights to an existing
-    * CombinedWeights instance.
+    * CombinedWeights instance.  The file consists of lines
+    * <code>coordinates: weight</code>, <code>order k: weight</code>,
+    * <code>default: weight</code> and comments starting with <code>#</code>,
+    * or of weights specifications as on the command line (see
+    * Parser::Weights::parse()), separated by whitespace.  It is memory-mapped
+    * and parsed in a single pass, without copying its lines.
     *
     * Example strings: <code>file:filename</code>
     *
-    * \return \c true on success; \c false on failure
+    * \return \c true on success; \c false if \c arg does not specify a file.
+    * \throws BadWeights if the file cannot be read or parsed.
     */
    static bool
    parseFile(const std::string& arg, LatBuilder::CombinedWeights& weights, Real powerScale);
 
+   /**
+    * Parses a string specifying a binary file containing order-dependent and
+    * projection-dependent weights.
+    *
+    * The file consists of 64-bit words in native representation: the magic
+    * string <code>LNBWGHT1</code>, the default order-dependent weight, the
+    * number \f$m\f$ of orders with explicit weights, the weights of the
+    * orders \f$1,\dots,m\f$, the number of projections with explicit
+    * weights, then for each of them its order \f$k\f$, its \f$k\f$
+    * coordinates, starting from 0, and its weight; the weights are IEEE
+    * double-precision numbers.
+    *
+    * Example strings: <code>bin:filename</code>
+    *
+    * \return \c true on success; \c false if \c arg does not specify a binary file.
+    * \throws BadWeights if the file cannot be read or is not valid.
+    */
+   static bool
+   parseBinaryFile(const std::string& arg, LatBuilder::CombinedWeights& weights, Real powerScale);
+
    /**
     * Parses a vector of strings specifying weights.
     *
-    * For example strings, see #parseFile(),
+    * For example strings, see #parseFile(), #parseBinaryFile(),
     * Parser::Weights::parseProjectionDependent(),
     * Parser::Weights::parseOrderDependent() and
     * Parser::Weights::parseProduct().
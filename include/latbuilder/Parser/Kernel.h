@@ -25,9 +25,17 @@
 #include "latbuilder/Kernel/IAAlpha.h"
 #include "latbuilder/Kernel/IB.h"
 #include "latbuilder/Kernel/ICAlpha.h"
+#include "latbuilder/Kernel/LinearCombination.h"
 
 #include "latbuilder/Interlaced/WeightsInterlacer.h"
 
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace LatBuilder { namespace Parser {
 
 /**
@@ -40,6 +48,30 @@ public:
    {}
 };
 
+namespace detail {
+   // splits the linear combination c1*K1+c2*K2+... of kernels into the
+   // coefficients and the strings of the kernels; a missing coefficient is 1
+   inline std::vector<std::pair<Real, std::string>> splitLinearCombination(const std::string& str)
+   {
+      std::vector<std::string> terms;
+      boost::split(terms, str, boost::is_any_of("+"));
+      std::vector<std::pair<Real, std::string>> out;
+      for (const auto& term : terms) {
+         const auto star = term.find('*');
+         if (star == std::string::npos)
+            out.emplace_back(Real(1), term);
+         else
+            out.emplace_back(boost::lexical_cast<Real>(term.substr(0, star)), term.substr(star + 1));
+         if (out.back().second.empty())
+            throw BadKernel(str);
+      }
+      return out;
+   }
+
+   inline bool isLinearCombination(const std::string& str)
+   { return str.find_first_of("+*") != std::string::npos; }
+}
+
 /**
  * Parser for kernels for coordinate-uniform figures of merit.
  */
@@ -53,6 +85,10 @@ struct Kernel
     *
     * Example strings: <code>P2</code>, <code>P4</code>, <code>P6</code>, <code>R1</code>, <code>R1.5</code>, <code>R2</code>
     *
+    * A linear combination of kernels, like <code>0.5*P2+0.5*P4</code>, is
+    * parsed as a single kernel (see LatBuilder::Kernel::LinearCombination),
+    * except for the kernels of interlaced polynomial lattices.
+    *
     * \return A shared pointer to a newly created object or \c nullptr on failure.
     */
    template <typename FUNC, typename... ARGS>
@@ -65,6 +101,20 @@ template <typename FUNC, typename... ARGS>
    void Kernel<LatticeType::ORDINARY>::parse(const std::string& str, unsigned int interlacingFactor, std::unique_ptr<LatticeTester::Weights> weights, FUNC&& func, ARGS&&... args)
    {
       try {
+             if (detail::isLinearCombination(str)) {
+                std::vector<std::pair<Real, LatBuilder::Kernel::PAlpha>> pterms;
+                std::vector<std::pair<Real, LatBuilder::Kernel::RAlpha>> rterms;
+                for (const auto& term : detail::splitLinearCombination(str)) {
+                   if (term.second[0] == 'P')
+                      pterms.emplace_back(term.first, LatBuilder::Kernel::PAlpha(boost::lexical_cast<unsigned int>(term.second.substr(1))));
+                   else if (term.second[0] == 'R')
+                      rterms.emplace_back(term.first, LatBuilder::Kernel::RAlpha(boost::lexical_cast<Real>(term.second.substr(1))));
+                   else
+                      throw BadKernel(str);
+                }
+                func(LatBuilder::Kernel::OrdinaryCombination(std::move(pterms), std::move(rterms)), std::move(weights), std::forward<ARGS>(args)...);
+                return;
+             }
              if (str[0] == 'P') {
                 auto alpha = boost::lexical_cast<unsigned int>(str.substr(1));
                 func(LatBuilder::Kernel::PAlpha(alpha), std::move(weights), std::forward<ARGS>(args)...);
@@ -92,6 +142,20 @@ template <typename FUNC, typename... ARGS>
    void Kernel<LatticeType::POLYNOMIAL>::parse(const std::string& str, unsigned int interlacingFactor, std::unique_ptr<LatticeTester::Weights> weights, FUNC&& func, ARGS&&... args)
    {
       try {
+             if (detail::isLinearCombination(str)) {
+                std::vector<std::pair<Real, LatBuilder::Kernel::PAlphaTilde>> pterms;
+                std::vector<std::pair<Real, LatBuilder::Kernel::RPLR>> rterms;
+                for (const auto& term : detail::splitLinearCombination(str)) {
+                   if (term.second[0] == 'P')
+                      pterms.emplace_back(term.first, LatBuilder::Kernel::PAlphaTilde(boost::lexical_cast<unsigned int>(term.second.substr(1))));
+                   else if (term.second[0] == 'R')
+                      rterms.emplace_back(term.first, LatBuilder::Kernel::RPLR());
+                   else
+                      throw BadKernel(str);
+                }
+                func(LatBuilder::Kernel::PolynomialCombination(std::move(pterms), std::move(rterms)), std::move(weights), std::forward<ARGS>(args)...);
+                return;
+             }
              if (str[0] == 'P') {
                 auto alpha = boost::lexical_cast<unsigned int>(str.substr(1));
                 func(LatBuilder::Kernel::PAlphaTilde(alpha), std::move(weights), std::forward<ARGS>(args)...);
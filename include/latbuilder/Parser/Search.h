@@ -23,9 +23,12 @@
 #include "latbuilder/Task/FastCBC.h"
 #include "latbuilder/Task/RandomCBC.h"
 #include "latbuilder/Task/Eval.h"
+#include "latbuilder/Task/EvalLevels.h"
 #include "latbuilder/Task/Exhaustive.h"
+#include "latbuilder/Task/DepthFirst.h"
 #include "latbuilder/Task/Random.h"
 #include "latbuilder/Task/Korobov.h"
+#include "latbuilder/Task/FastKorobov.h"
 #include "latbuilder/Task/RandomKorobov.h"
 #include "latbuilder/Task/Extend.h"
 #include "latbuilder/Storage.h"
@@ -51,7 +54,8 @@ public:
    /**
     * Parses a string specifying a construction method.
     *
-    * Example strings: <code>full-CBC</code>, <code>fast-CBC</code>, <code>random-CBC:30</code>
+    * Example strings: <code>full-CBC</code>, <code>fast-CBC</code>, <code>fast-Korobov</code>, <code>random-CBC:30</code>,
+    * <code>evaluation-levels:1,433,229</code>
     *
     * \return A pointer to a Search instance.
     */
@@ -101,17 +105,29 @@ public:
          return;
       }
       if (str == "fast-CBC") {
-         func(Task::fastCBC(std::move(storage), dimension, std::move(figure)), std::forward<ARGS>(args)...);
+         fastCBC(std::move(storage), dimension, std::move(figure),
+               std::integral_constant<bool, LR == LatticeType::ORDINARY and ET == LatBuilder::EmbeddingType::UNILEVEL>(),
+               std::forward<FUNC>(func), std::forward<ARGS>(args)...);
          return;
       }
       if (str == "Korobov") {
          func(Task::korobov(std::move(storage), dimension, std::move(figure)), std::forward<ARGS>(args)...);
          return;
       }
+      if (str == "fast-Korobov") {
+         fastKorobov(std::move(storage), dimension, std::move(figure),
+               std::integral_constant<bool, LR == LatticeType::ORDINARY>(),
+               std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+         return;
+      }
       if (str == "exhaustive") {
          func(Task::exhaustive(std::move(storage), dimension, std::move(figure)), std::forward<ARGS>(args)...);
          return;
       }
+      if (str == "exhaustive-DFS") {
+         func(Task::depthFirst(std::move(storage), dimension, std::move(figure)), std::forward<ARGS>(args)...);
+         return;
+      }
 
       try {
          auto nrand = boost::lexical_cast<unsigned int>(strSplit[1]);
@@ -132,7 +148,7 @@ public:
 
       
       int splitSizeWithoutFile;
-      if (strSplit[0] == "evaluation"){
+      if (strSplit[0] == "evaluation" || strSplit[0] == "evaluation-levels"){
          splitSizeWithoutFile = 2;
       }
       else if (strSplit[0] == "extend"){
@@ -176,6 +192,12 @@ public:
          return;
       }
 
+      if (strSplit[0] == "evaluation-levels") {
+         auto genVec = LatticeParametersParseHelper<LR>::ParseGeneratingVector(genVecString);
+         evalLevels(storage.sizeParam(), dimension, std::move(figure), std::move(genVec), std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+         return;
+      }
+
       if (strSplit[0] == "extend") {
          auto sizeParam = Parser::SizeParam<LR, ET>::parse(strSplit[1]);
          auto genVec =  LatticeParametersParseHelper<LR>::ParseGeneratingVector(genVecString);
@@ -192,6 +214,60 @@ private:
    static Storage<LR, ET, COMPRESS, PLO> createStorage(LatBuilder::SizeParam<LR, ET> size)
    { return Storage<LR, ET, COMPRESS, PLO>(std::move(size)); }
 
+   // the fast CBC search of ordinary unilevel lattices whose number of points
+   // is not a prime power runs over the orbits of the group of units
+   template <class STORAGE, class FIGURE, class FUNC, typename... ARGS>
+   static void fastCBC(STORAGE storage, LatBuilder::Dimension dimension, FIGURE figure, std::true_type, FUNC&& func, ARGS&&... args)
+   {
+      if (primeFactorsMap(storage.sizeParam().numPoints()).size() > 1)
+         func(Task::fastGroupCBC(std::move(storage), dimension, std::move(figure)), std::forward<ARGS>(args)...);
+      else
+         func(Task::fastCBC(std::move(storage), dimension, std::move(figure)), std::forward<ARGS>(args)...);
+   }
+
+   template <class STORAGE, class FIGURE, class FUNC, typename... ARGS>
+   static void fastCBC(STORAGE storage, LatBuilder::Dimension dimension, FIGURE figure, std::false_type, FUNC&& func, ARGS&&... args)
+   { func(Task::fastCBC(std::move(storage), dimension, std::move(figure)), std::forward<ARGS>(args)...); }
+
+   // the fast Korobov search relies on the cyclic group of units of the
+   // integers modulo a prime power
+   template <class STORAGE, class FIGURE, class FUNC, typename... ARGS>
+   static void fastKorobov(STORAGE storage, LatBuilder::Dimension dimension, FIGURE figure, std::true_type, FUNC&& func, ARGS&&... args)
+   { func(Task::fastKorobov(std::move(storage), dimension, std::move(figure)), std::forward<ARGS>(args)...); }
+
+   template <class STORAGE, class FIGURE, class FUNC, typename... ARGS>
+   static void fastKorobov(STORAGE, LatBuilder::Dimension, FIGURE, std::false_type, FUNC&&, ARGS&&...)
+   { throw ParserError("fast-Korobov is implemented only for ordinary lattices"); }
+
+   // the single-pass evaluation at every level evaluates the kernel of a
+   // coordinate-uniform figure of merit directly at the points of an ordinary
+   // multilevel lattice
+   template <class F>
+   static std::true_type isFunctorKernel(const LatBuilder::Kernel::FunctorAdaptor<F>*);
+
+   static std::false_type isFunctorKernel(const void*);
+
+   template <class KERNEL, class GENVEC, class FUNC, typename... ARGS>
+   static void evalLevels(const LatBuilder::SizeParam<LR, ET>& size, LatBuilder::Dimension dimension, LatBuilder::CoordUniformFigureOfMerit<KERNEL> figure, GENVEC genVec, FUNC&& func, ARGS&&... args)
+   {
+      typedef decltype(isFunctorKernel(static_cast<const KERNEL*>(nullptr))) FunctorKernel;
+      createEvalLevels(size, dimension, std::move(figure), std::move(genVec),
+            std::integral_constant<bool, LR == LatticeType::ORDINARY and ET == LatBuilder::EmbeddingType::MULTILEVEL and FunctorKernel::value>(),
+            std::forward<FUNC>(func), std::forward<ARGS>(args)...);
+   }
+
+   template <class FIGURE, class GENVEC, class FUNC, typename... ARGS>
+   static void evalLevels(const LatBuilder::SizeParam<LR, ET>&, LatBuilder::Dimension, FIGURE, GENVEC, FUNC&&, ARGS&&...)
+   { throw ParserError("evaluation-levels is implemented only for coordinate-uniform figures of merit"); }
+
+   template <class KERNEL, class GENVEC, class FUNC, typename... ARGS>
+   static void createEvalLevels(const LatBuilder::SizeParam<LR, ET>& size, LatBuilder::Dimension dimension, LatBuilder::CoordUniformFigureOfMerit<KERNEL> figure, GENVEC genVec, std::true_type, FUNC&& func, ARGS&&... args)
+   { func(Task::EvalLevels(size, dimension, std::move(figure), std::move(genVec)), std::forward<ARGS>(args)...); }
+
+   template <class KERNEL, class GENVEC, class FUNC, typename... ARGS>
+   static void createEvalLevels(const LatBuilder::SizeParam<LR, ET>&, LatBuilder::Dimension, LatBuilder::CoordUniformFigureOfMerit<KERNEL>, GENVEC, std::false_type, FUNC&&, ARGS&&...)
+   { throw ParserError("evaluation-levels is implemented only for multilevel ordinary lattices and the P-alpha kernels"); }
+
    struct ToPtr {
       LatBuilder::Task::Search<LR, ET>* ptr;
       LatBuilder::Task::Search<LR, ET>* operator()() const
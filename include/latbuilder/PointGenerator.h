@@ -0,0 +1,186 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Generation of the points of rank-1 lattices and export of point sets to binary files.
+ */
+
+#ifndef LATBUILDER__POINT_GENERATOR_H
+#define LATBUILDER__POINT_GENERATOR_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/LatDef.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Binary formats of the coordinates of the points.
+ * - FLOAT64: coordinates in \f$[0,1)\f$ as native double-precision numbers;
+ * - UINT32: coordinates multiplied by \f$2^{32}\f$ and truncated, as native 32-bit unsigned integers.
+ */
+enum class PointFormat { FLOAT64, UINT32 };
+
+/**
+ * Generator of the points of an ordinary rank-1 lattice, with an optional random shift
+ * modulo 1.
+ *
+ * The point of index \f$i\f$ is \f$\boldsymbol x_i = (i \boldsymbol a / n + \boldsymbol \Delta) \bmod 1\f$
+ * where \f$\boldsymbol a\f$ is the generating vector, \f$n\f$ the number of points and \f$\boldsymbol \Delta\f$ the shift.
+ * The numerators \f$i a_j \bmod n\f$ are computed by exact integer additions from one point to the next.
+ *
+ * Point generators write the points of a range of indices, one point after the other (row-major order),
+ * into buffers provided by the caller. See generatePoints() and writePoints() to process the whole point set
+ * with the shared thread pool.
+ */
+class LatticePointGenerator
+{
+public:
+   /**
+    * Constructor.
+    * \param numPoints  Number of points \f$n\f$ of the lattice.
+    * \param gen        Generating vector.
+    * \param shift      Shift modulo 1 of the points, with one value by coordinate, or empty for no shift.
+    */
+   LatticePointGenerator(uInteger numPoints, std::vector<uInteger> gen, std::vector<Real> shift = std::vector<Real>());
+
+   /**
+    * Constructor from a lattice definition.
+    * \param lat        Lattice.
+    * \param shift      Shift modulo 1 of the points, with one value by coordinate, or empty for no shift.
+    */
+   template <EmbeddingType ET>
+   LatticePointGenerator(const LatDef<LatticeType::ORDINARY, ET>& lat, std::vector<Real> shift = std::vector<Real>()):
+      LatticePointGenerator(lat.sizeParam().numPoints(), lat.gen(), std::move(shift))
+   {}
+
+   /**
+    * Returns the number of points.
+    */
+   uInteger numPoints() const
+   { return m_numPoints; }
+
+   /**
+    * Returns the number of coordinates of the points.
+    */
+   Dimension dimension() const
+   { return m_gen.size(); }
+
+   /**
+    * Returns the generating vector, reduced modulo the number of points.
+    */
+   const std::vector<uInteger>& generatingVector() const
+   { return m_gen; }
+
+   /**
+    * Returns the shift, reduced modulo 1, or an empty vector for no shift.
+    */
+   const std::vector<Real>& shift() const
+   { return m_shift; }
+
+   /**
+    * Writes the coordinates of the points of indices \c first to <code>first + count - 1</code> to \c out,
+    * which must have room for <code>count * dimension()</code> values.
+    */
+   void generate(uInteger first, uInteger count, double* out) const;
+
+   /// \copydoc generate()
+   void generate(uInteger first, uInteger count, uint32_t* out) const;
+
+private:
+   uInteger m_numPoints;
+   std::vector<uInteger> m_gen;
+   std::vector<Real> m_shift;
+
+   template <typename T, typename CONVERT>
+   void generateImpl(uInteger first, uInteger count, T* out, CONVERT convert) const;
+};
+
+/**
+ * Writes all the points of \c generator to \c out, which must have room for
+ * <code>generator.numPoints() * generator.dimension()</code> values. The points are split in
+ * chunks of \c chunkSize points which are generated concurrently by the shared thread pool.
+ * \tparam GENERATOR Point generator, for instance LatticePointGenerator or NetBuilder::DigitalNetPointGenerator.
+ * \tparam T         Type of the coordinates: \c double or \c uint32_t.
+ */
+template <class GENERATOR, typename T>
+void generatePoints(const GENERATOR& generator, T* out, uInteger chunkSize = 1 << 14)
+{
+   const uInteger n = generator.numPoints();
+   const size_t numChunks = (n + chunkSize - 1) / chunkSize;
+   ThreadPool::global().parallelFor(numChunks, [&](unsigned int, size_t chunk)
+         {
+            const uInteger first = chunk * chunkSize;
+            generator.generate(first, std::min(chunkSize, n - first), out + first * generator.dimension());
+         });
+}
+
+/**
+ * Writes all the points of \c generator to the binary stream \c os as values of type \c T,
+ * one point after the other, without any header. Up to one chunk of \c chunkSize points by worker of the
+ * shared thread pool is held in memory: the chunks of a batch are generated concurrently, then written in order.
+ * \tparam GENERATOR Point generator, for instance LatticePointGenerator or NetBuilder::DigitalNetPointGenerator.
+ * \tparam T         Type of the coordinates: \c double or \c uint32_t.
+ * \throws std::runtime_error if the points cannot be written.
+ */
+template <typename T, class GENERATOR>
+void writePoints(const GENERATOR& generator, std::ostream& os, uInteger chunkSize = 1 << 14)
+{
+   ThreadPool& pool = ThreadPool::global();
+   const uInteger n = generator.numPoints();
+   std::vector<std::vector<T>> buffers(pool.size(), std::vector<T>(chunkSize * generator.dimension()));
+
+   for (uInteger batchFirst = 0; batchFirst < n; batchFirst += chunkSize * pool.size()) {
+      const size_t numChunks = std::min<uInteger>(pool.size(), (n - batchFirst + chunkSize - 1) / chunkSize);
+      pool.parallelFor(numChunks, [&](unsigned int, size_t chunk)
+            {
+               const uInteger first = batchFirst + chunk * chunkSize;
+               generator.generate(first, std::min(chunkSize, n - first), buffers[chunk].data());
+            });
+      for (size_t chunk = 0; chunk < numChunks; ++chunk) {
+         const uInteger first = batchFirst + chunk * chunkSize;
+         const uInteger count = std::min(chunkSize, n - first);
+         os.write(reinterpret_cast<const char*>(buffers[chunk].data()), count * generator.dimension() * sizeof(T));
+      }
+      if (!os)
+         throw std::runtime_error("cannot write the points");
+   }
+}
+
+/**
+ * Writes all the points of \c generator to the binary stream \c os in the format \c format.
+ * See writePoints(const GENERATOR&, std::ostream&, uInteger).
+ */
+template <class GENERATOR>
+void writePoints(const GENERATOR& generator, std::ostream& os, PointFormat format, uInteger chunkSize = 1 << 14)
+{
+   if (format == PointFormat::FLOAT64)
+      writePoints<double>(generator, os, chunkSize);
+   else
+      writePoints<uint32_t>(generator, os, chunkSize);
+}
+
+}
+
+#endif
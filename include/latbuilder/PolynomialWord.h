@@ -0,0 +1,255 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Arithmetic on the polynomials of \f$\mathbb{Z}_2[z]\f$ of small degree, packed in machine words.
+ */
+
+#ifndef LATBUILDER__POLYNOMIAL_WORD_H
+#define LATBUILDER__POLYNOMIAL_WORD_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/CpuDispatch.h"
+
+#include <cstdint>
+
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_AES) || defined(__ARM_FEATURE_CRYPTO))
+#include <arm_neon.h>
+#define LATBUILDER__POLYNOMIAL_WORD_PMULL
+#endif
+
+namespace LatBuilder
+{
+
+/**
+ * Polynomial of \f$\mathbb{Z}_2[z]\f$ of degree at most 63, whose bit \f$i\f$ is
+ * the coefficient of \f$z^i\f$, as in IndexOfPolynomial().
+ */
+typedef std::uint64_t PolynomialWord;
+
+/**
+ * Returns the coefficients of degree smaller than 64 of \c p.
+ */
+inline PolynomialWord toPolynomialWord(const Polynomial& p)
+{
+   unsigned char bytes[8];
+   NTL::BytesFromGF2X(bytes, p, 8);
+   PolynomialWord word = 0;
+   for (int i = 7; i >= 0; i--)
+      word = (word << 8) | bytes[i];
+   return word;
+}
+
+/**
+ * Stores the polynomial \c word in \c p.
+ */
+inline void fromPolynomialWord(Polynomial& p, PolynomialWord word)
+{
+   unsigned char bytes[8];
+   for (int i = 0; i < 8; i++)
+      bytes[i] = (unsigned char) (word >> (8 * i));
+   NTL::GF2XFromBytes(p, bytes, 8);
+}
+
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED && !defined(__PCLMUL__) && !defined(LATBUILDER__POLYNOMIAL_WORD_PMULL)
+/**
+ * Same as carrylessMultiply(), with the carry-less multiplication
+ * instruction, which the host must support.
+ */
+void carrylessMultiplyInstruction(PolynomialWord a, PolynomialWord b, PolynomialWord& low, PolynomialWord& high);
+#endif
+
+/**
+ * Stores in \c low and \c high the coefficients of degrees 0 to 63 and 64 to
+ * 127 of the product of \c a and \c b.
+ *
+ * Uses the carry-less multiplication instruction (PCLMULQDQ on x86-64, PMULL
+ * on AArch64) when the compiler targets it (for instance with \c -mpclmul,
+ * <tt>-march=armv8-a+crypto</tt> or \c -march=native), or when the host
+ * supports it if the instruction sets are selected at run time (see
+ * #LATNETBUILDER_CPU_DISPATCH_ENABLED), and shifts and XORs otherwise.
+ */
+inline void carrylessMultiply(PolynomialWord a, PolynomialWord b, PolynomialWord& low, PolynomialWord& high)
+{
+#ifdef __PCLMUL__
+   const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long) a), _mm_cvtsi64_si128((long long) b), 0);
+   low = (PolynomialWord) _mm_cvtsi128_si64(product);
+   high = (PolynomialWord) _mm_cvtsi128_si64(_mm_unpackhi_epi64(product, product));
+#elif defined(LATBUILDER__POLYNOMIAL_WORD_PMULL)
+   const uint64x2_t product = vreinterpretq_u64_p128(vmull_p64((poly64_t) a, (poly64_t) b));
+   low = vgetq_lane_u64(product, 0);
+   high = vgetq_lane_u64(product, 1);
+#else
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED
+   if (cpuSupports(CpuFeature::PCLMUL) or cpuSupports(CpuFeature::PMULL)) {
+      carrylessMultiplyInstruction(a, b, low, high);
+      return;
+   }
+#endif
+   low = a & (PolynomialWord) -(PolynomialWord) (b & 1);
+   high = 0;
+   for (unsigned int i = 1; i < 64; i++) {
+      const PolynomialWord mask = (PolynomialWord) -(PolynomialWord) ((b >> i) & 1);
+      low ^= (a << i) & mask;
+      high ^= (a >> (64 - i)) & mask;
+   }
+#endif
+}
+
+/**
+ * Modulus of degree \f$1 \leq m \leq 63\f$ for the arithmetic on polynomial
+ * words.
+ *
+ * The products are reduced with Barrett's method: with \f$\mu = \lfloor
+ * z^{2m} / P(z) \rfloor\f$, the quotient of a polynomial \f$c(z)\f$ of degree
+ * smaller than \f$2m\f$ by \f$P(z)\f$ is exactly \f$\lfloor \lfloor c(z) / z^m
+ * \rfloor \mu / z^m \rfloor\f$, so that a modular product takes three
+ * carry-less multiplications and no division.
+ *
+ * A word modulus is an arithmetic context: it holds all the data precomputed
+ * from the modulus, it is never modified once constructed and none of its
+ * member functions uses NTL, so that a single instance can be shared by
+ * concurrent workers, or passed to them, and reused for all the candidates of
+ * a search instead of being rebuilt from the modulus for each of them.
+ */
+class PolynomialWordModulus {
+public:
+   /**
+    * Largest degree of a modulus.
+    */
+   static constexpr long maxDegree = 63;
+
+   /**
+    * Returns \c true if the arithmetic modulo \c modulus can be carried out on
+    * polynomial words.
+    */
+   static bool fits(const Polynomial& modulus)
+   { return deg(modulus) >= 1 and deg(modulus) <= maxDegree; }
+
+   /**
+    * Returns the word modulus of \c modulus, which must fit, reusing the one
+    * built by the previous call from the same thread if \c modulus did not
+    * change.
+    */
+   static const PolynomialWordModulus& cached(const Polynomial& modulus);
+
+   /**
+    * Constructs an invalid modulus.
+    */
+   PolynomialWordModulus():
+      m_modulus(0), m_degree(0), m_mask(0), m_mu(0), m_feedback(0)
+   {}
+
+   /**
+    * Constructor.
+    *
+    * \param modulus    Modulus, whose degree must be between 1 and #maxDegree.
+    */
+   explicit PolynomialWordModulus(const Polynomial& modulus);
+
+   /**
+    * Returns the modulus.
+    */
+   PolynomialWord modulus() const
+   { return m_modulus; }
+
+   /**
+    * Returns the degree of the modulus.
+    */
+   unsigned int degree() const
+   { return m_degree; }
+
+   /**
+    * Returns \c true if \c a is reduced modulo the modulus.
+    */
+   bool isReduced(PolynomialWord a) const
+   { return (a & ~m_mask) == 0; }
+
+   /**
+    * Returns \c a modulo the modulus.
+    */
+   PolynomialWord reduce(PolynomialWord a) const
+   { return isReduced(a) ? a : remainder(a); }
+
+   /**
+    * Returns the product of \c a and \c b modulo the modulus.  Both must be
+    * reduced.
+    */
+   PolynomialWord multiply(PolynomialWord a, PolynomialWord b) const
+   {
+      PolynomialWord low, high;
+      carrylessMultiply(a, b, low, high);
+      return reduce(low, high);
+   }
+
+   /**
+    * Returns \c base raised to the power \c exponent modulo the modulus.
+    */
+   PolynomialWord power(PolynomialWord base, uInteger exponent) const;
+
+   /**
+    * Returns \c true if \c a and the modulus are coprime.
+    */
+   bool isCoprime(PolynomialWord a) const;
+
+   /**
+    * Returns the coefficients of the modulus involved in the recurrence of the
+    * coefficients of the expansion of a fraction in powers of \f$1/z\f$: the
+    * bit \f$d - 1\f$ is the coefficient of degree \f$m - d\f$ of the modulus,
+    * for \f$1 \leq d \leq m\f$.
+    */
+   PolynomialWord feedback() const
+   { return m_feedback; }
+
+   /**
+    * Returns \f$2^m \nu_m(h(z) / P(z))\f$ (see Vm()), the integer whose bits,
+    * from the most significant, are the \f$m\f$ first coefficients of the
+    * expansion of \f$h(z) / P(z)\f$ in powers of \f$1/z\f$.  Only the
+    * coefficients of degree smaller than \f$m\f$ of \c h are used.
+    */
+   uInteger expansion(PolynomialWord h) const;
+
+private:
+   PolynomialWord m_modulus; // including the coefficient of degree m
+   unsigned int m_degree;
+   PolynomialWord m_mask; // coefficients of degree smaller than m
+   PolynomialWord m_mu; // floor(z^{2m} / modulus)
+   PolynomialWord m_feedback; // bit d - 1 is the coefficient of degree m - d
+
+   // remainder of a by the modulus, by long division
+   PolynomialWord remainder(PolynomialWord a) const;
+
+   // floor(c / z^m) for the polynomial c of coefficients low and high, if its degree is smaller than 64 + m
+   PolynomialWord shiftRight(PolynomialWord low, PolynomialWord high) const
+   { return (low >> m_degree) | (high << (64 - m_degree)); }
+
+   // remainder of the polynomial of coefficients low and high, of degree smaller than 2m, by the modulus
+   PolynomialWord reduce(PolynomialWord low, PolynomialWord high) const
+   {
+      PolynomialWord qlow, qhigh;
+      carrylessMultiply(shiftRight(low, high), m_mu, qlow, qhigh);
+      const PolynomialWord quotient = shiftRight(qlow, qhigh);
+      carrylessMultiply(quotient, m_modulus, qlow, qhigh);
+      return (low ^ qlow) & m_mask;
+   }
+};
+
+}
+
+#endif
@@ -0,0 +1,115 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Background computation of the next block of values of a sequence.
+ */
+
+#ifndef LATBUILDER__PREFETCHER_H
+#define LATBUILDER__PREFETCHER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace LatBuilder
+{
+
+/**
+ * Background thread computing blocks of values ahead of their consumer.
+ *
+ * A block is submitted as a Prefetcher::Task, which is run either by the
+ * background thread or, if the consumer needs it before the thread has started
+ * it, by the consumer itself in Task::complete(), so that a busy thread never
+ * delays the consumer by more than the computation of one block.  The thread
+ * is created on the first submission and shared by the whole process.
+ *
+ * The prefetching only pays off when the consumer does not already use all
+ * the processors, so enabled() is \c false when the shared ThreadPool has more
+ * than one worker.
+ */
+class Prefetcher
+{
+public:
+   /**
+    * Block of values to be computed by the background thread.
+    */
+   class Task
+   {
+   public:
+      virtual ~Task() {}
+
+      /**
+       * Runs the task in the calling thread if the background thread has not
+       * started it yet, or waits until the background thread is done with it.
+       */
+      void complete();
+
+      /**
+       * Withdraws the task if the background thread has not started it yet,
+       * or waits until the background thread is done with it.
+       *
+       * Must be called before the data used by run() is destroyed.
+       */
+      void cancel();
+
+   protected:
+      /**
+       * Computes the values.  Called at most once, by the background thread
+       * or by complete().  Must not throw: the exceptions are to be kept for
+       * the consumer.
+       */
+      virtual void run() = 0;
+
+   private:
+      friend class Prefetcher;
+
+      enum class State { PENDING, RUNNING, DONE };
+
+      std::mutex m_mutex;
+      std::condition_variable m_done;
+      State m_state = State::PENDING;
+
+      bool start();
+      void finish();
+   };
+
+   /**
+    * Returns \c true if the blocks should be prefetched: the prefetching was
+    * not disabled with setEnabled(), the processor has more than one hardware
+    * thread, and the shared ThreadPool runs serially.
+    */
+   static bool enabled();
+
+   /**
+    * Enables or disables the prefetching for the sequences iterated
+    * afterwards.
+    */
+   static void setEnabled(bool enabled);
+
+   /**
+    * Queues \c task for the background thread.
+    */
+   static void submit(std::shared_ptr<Task> task);
+
+private:
+   class Worker;
+};
+
+}
+
+#endif
@@ -0,0 +1,228 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Process-wide timers and counters of the phases of the searches.
+ */
+
+#ifndef LATBUILDER__PROFILER_H
+#define LATBUILDER__PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+namespace LatBuilder
+{
+
+/**
+ * Process-wide timers and counters of the phases of the searches.
+ *
+ * The profiler is disabled by default, in which case each instrumentation
+ * point only costs the test of a flag.  Once enabled with #setEnabled, the
+ * timers accumulate the wall-clock time and the number of calls of the
+ * instrumented sections, and the counters the number of events, over all the
+ * threads and tasks of the process until #reset is called.
+ *
+ * The times of nested sections are inclusive: for instance, the evaluation
+ * time of a fast CBC search includes the time of its FFT's.  Sections timed
+ * concurrently by several threads add up, so that the total time of a
+ * section may exceed the elapsed time of the task.
+ *
+ * The instrumented sections and events are:
+ * - kernel setup: the computation (or the loading) of the tables of kernel
+ *   values of the coordinate-uniform figures of merit;
+ * - candidate construction: the construction of the candidate nets of the
+ *   CBC searches of NetBuilder (the lattices of LatBuilder are constructed as
+ *   they are evaluated, so their construction is part of their evaluation);
+ * - evaluation: the computation of the merit values of the candidates;
+ * - FFT: the FFT-based products of the fast CBC construction;
+ * - candidates: the number of point sets of which the merit value was
+ *   computed;
+ * - early aborts: the number of evaluations stopped by early abortion;
+ * - rank operations: the number of rows added to or replaced in the
+ *   Gaussian eliminations of the t-value computations.
+ * - screened out: the number of candidates of the CBC searches of NetBuilder
+ *   discarded by their screening figure before being evaluated;
+ * - cache hits and misses: the number of lookups answered or not by the
+ *   caches of the kernel values (Kernel::ValueCache), of the FFTW plans, of
+ *   the t-values of the projections (NetBuilder::TValueCache) and of the task
+ *   results (NetBuilder::ResultCache).
+ *
+ * Besides the values since the last #reset, the profiler keeps their totals
+ * since the start of the process, which are reported to the monitoring tools
+ * of a long-lived process by #writeMetrics.
+ *
+ * The reports also include the current and the peak sizes of the components
+ * accounted by Memory, whose peaks are reset by #reset.
+ */
+class Profiler {
+public:
+   /// Timed sections.
+   enum class Timer { KERNEL_SETUP, CANDIDATE_CONSTRUCTION, EVALUATION, FFT };
+
+   /// Counted events.
+   enum class Counter {
+      CANDIDATES, EARLY_ABORTS, RANK_OPERATIONS, SCREENED_OUT,
+      KERNEL_CACHE_HITS, KERNEL_CACHE_MISSES, PLAN_CACHE_HITS, PLAN_CACHE_MISSES,
+      TVALUE_CACHE_HITS, TVALUE_CACHE_MISSES, RESULT_CACHE_HITS, RESULT_CACHE_MISSES
+   };
+
+   static constexpr unsigned int NUM_TIMERS = 4;
+   static constexpr unsigned int NUM_COUNTERS = 12;
+
+   /**
+    * Times the enclosing scope with \c timer, if the profiler is enabled when
+    * the scope is entered.
+    */
+   class Scope {
+   public:
+      explicit Scope(Timer timer):
+         m_timer(timer),
+         m_running(Profiler::enabled())
+      { if (m_running) m_start = Clock::now(); }
+
+      ~Scope()
+      { if (m_running) Profiler::add(m_timer, Clock::now() - m_start); }
+
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+   private:
+      Timer m_timer;
+      bool m_running;
+      std::chrono::steady_clock::time_point m_start;
+   };
+
+   /**
+    * Returns true if the profiler is enabled.
+    */
+   static bool enabled()
+   { return s_enabled.load(std::memory_order_relaxed); }
+
+   /**
+    * Enables or disables the profiler.  The accumulated values are kept.
+    */
+   static void setEnabled(bool value);
+
+   /**
+    * Keeps the profiler enabled whatever #setEnabled is given, if \c value is
+    * \c true, so that the totals reported by #writeMetrics count all the
+    * tasks of the process.
+    */
+   static void setMonitored(bool value);
+
+   /**
+    * Adds \c n events to \c counter if the profiler is enabled.
+    */
+   static void count(Counter counter, unsigned long long n = 1)
+   { if (enabled()) add(counter, n); }
+
+   /**
+    * Returns the number of calls of the sections timed with \c timer.
+    */
+   static unsigned long long calls(Timer timer);
+
+   /**
+    * Returns the total time, in seconds, of the sections timed with \c timer.
+    */
+   static double seconds(Timer timer);
+
+   /**
+    * Returns the number of events of \c counter.
+    */
+   static unsigned long long value(Counter counter);
+
+   /**
+    * Returns the number of calls of the sections timed with \c timer since
+    * the start of the process.
+    */
+   static unsigned long long totalCalls(Timer timer);
+
+   /**
+    * Returns the total time, in seconds, of the sections timed with \c timer
+    * since the start of the process.
+    */
+   static double totalSeconds(Timer timer);
+
+   /**
+    * Returns the number of events of \c counter since the start of the
+    * process.
+    */
+   static unsigned long long totalValue(Counter counter);
+
+   /**
+    * Returns the name of \c timer in the reports.
+    */
+   static std::string name(Timer timer);
+
+   /**
+    * Returns the name of \c counter in the reports.
+    */
+   static std::string name(Counter counter);
+
+   /**
+    * Resets all the timers and counters to zero, and the peaks of Memory to
+    * the current sizes.  The totals since the start of the process are kept.
+    */
+   static void reset();
+
+   /**
+    * Writes the timers and the counters to \c os as a JSON object.
+    */
+   static void writeJson(std::ostream& os);
+
+   /**
+    * Writes the timers and the counters to \c os as CSV lines
+    * <CODE>name,calls,seconds</CODE>; the seconds of the counters are empty.
+    */
+   static void writeCsv(std::ostream& os);
+
+   /**
+    * Writes the totals of the timers and the counters since the start of the
+    * process to \c os in the text exposition format of Prometheus, followed
+    * by the ratio of early aborts to candidates and by the hit ratio of each
+    * cache.
+    *
+    * The metrics are named <CODE>latnetbuilder_<name>_total</CODE> for the
+    * counters, and <CODE>latnetbuilder_phase_calls_total</CODE> and
+    * <CODE>latnetbuilder_phase_seconds_total</CODE> with a \c phase label
+    * for the timers.
+    */
+   static void writeMetrics(std::ostream& os);
+
+   /**
+    * Writes the report to \c fileName, as CSV if its extension is \c .csv and
+    * as JSON otherwise.
+    *
+    * \throws std::runtime_error if the file cannot be written.
+    */
+   static void write(const std::string& fileName);
+
+private:
+   typedef std::chrono::steady_clock Clock;
+
+   static std::atomic<bool> s_enabled;
+
+   static void add(Timer timer, Clock::duration duration);
+   static void add(Counter counter, unsigned long long n);
+};
+
+}
+
+#endif
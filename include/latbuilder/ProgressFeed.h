@@ -0,0 +1,117 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Progress of the searches, written periodically as JSON lines.
+ */
+
+#ifndef LATBUILDER__PROGRESS_FEED_H
+#define LATBUILDER__PROGRESS_FEED_H
+
+#include "latbuilder/Types.h"
+
+#include <string>
+
+namespace LatBuilder
+{
+
+/**
+ * Process-wide progress of the searches, written to a file by a background
+ * thread, for monitoring tools which would otherwise parse the verbose output.
+ *
+ * The searches only store their counters in atomic variables, without
+ * locking nor output, so that the feed costs nothing to the search whether it
+ * is written or not.  Once started with start(), a background thread writes
+ * one JSON object per line at most every \c period seconds, and only if the
+ * counters changed:
+ * \code
+ * {"seq": 3, "elapsed": 1.5, "coordinate": 3, "dimension": 100, "candidate": 400, "candidates": 1024, "evaluated": 2448, "best_merit": 0.25, "done": false}
+ * \endcode
+ * where \c seq numbers the records, \c elapsed is the time since start() in
+ * seconds, \c coordinate and \c dimension are the coordinate explored by the
+ * component-by-component searches and the number of coordinates (0 for the
+ * other searches), \c candidate and \c candidates are the number of
+ * candidates visited for the current coordinate and their number (0 if
+ * unknown), \c evaluated is the number of candidates evaluated since the
+ * budget was restarted (see Budget::evaluations()) and \c best_merit is the
+ * merit value of the best point set selected so far (\c null before the first
+ * one).  The counters \c seq, \c elapsed and \c evaluated never decrease.
+ * A last record with \c done set to \c true is written by stop().
+ *
+ * The file may be a named pipe, or a file descriptor opened by the parent
+ * process, such as <tt>/dev/fd/3</tt>.
+ */
+class ProgressFeed {
+public:
+   /**
+    * Starts writing the progress to \c fileName, at most every \c period
+    * seconds.
+    *
+    * \throws std::runtime_error if the file cannot be opened or if the feed is
+    * already started.
+    */
+   static void start(const std::string& fileName, Real period);
+
+   /**
+    * Writes the last record and stops the background thread.  Does nothing if
+    * the feed is not started.
+    */
+   static void stop();
+
+   /**
+    * Starts the feed on construction if \c fileName is not empty, and stops it
+    * on destruction.
+    */
+   class Session {
+   public:
+      Session(const std::string& fileName, Real period);
+      ~Session();
+
+      Session(const Session&) = delete;
+      Session& operator=(const Session&) = delete;
+
+   private:
+      bool m_started;
+   };
+
+   /**
+    * Sets the coordinate explored by a component-by-component search, among
+    * \c dimension coordinates.
+    */
+   static void setCoordinate(Dimension coordinate, Dimension dimension);
+
+   /**
+    * Sets the number of candidates to visit, and the number of candidates
+    * visited to 0.
+    */
+   static void setCandidates(unsigned long long candidates);
+
+   /**
+    * Sets the number of candidates visited.
+    */
+   static void setCandidate(unsigned long long candidate);
+
+   /**
+    * Sets the merit value of the best point set selected so far.
+    */
+   static void setBestMerit(Real merit);
+};
+
+}
+
+#endif
@@ -62,6 +62,30 @@ public:
    bool symmetric() const
    { return derived().symmetric(); }
 
+   /**
+    * Returns \c true if the evaluation of a single projection is expensive
+    * enough for the projections of a lattice to be evaluated concurrently by
+    * the shared ThreadPool.  The evaluator must then be safe to call from
+    * several threads at once.
+    */
+   bool concurrent() const
+   { return derived().concurrent(); }
+
+   /**
+    * Returns \c true if the evaluator of the figure of merit bounds the value
+    * of a projection from below by the value of any of its subprojections,
+    * with a member function
+    * \code
+    * Real subProjectionBound(const LatticeTester::Coordinates& projection, const LatticeTester::Coordinates& subProjection, Real subMerit) const
+    * \endcode
+    * which returns the lower bound given the value \c subMerit of \c
+    * subProjection.  The evaluator of WeightedFigureOfMerit then aborts the
+    * evaluation of a lattice as soon as these bounds exceed the shared
+    * minimum.
+    */
+   bool boundedBySubProjections() const
+   { return derived().boundedBySubProjections(); }
+
    /**
     * Creates an evaluator for the projection-dependent figure of merit.
     */
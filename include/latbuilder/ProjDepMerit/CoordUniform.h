@@ -19,6 +19,7 @@
 
 #include "latbuilder/ProjDepMerit/Base.h"
 #include "latbuilder/CompressedSum.h"
+#include "latbuilder/Kernel/Base.h"
 #include "latbuilder/Types.h"
 #include "latbuilder/LatDef.h"
 
@@ -66,6 +67,12 @@ public:
    bool symmetric() const
    { return kernel().symmetric(); }
 
+   bool concurrent() const
+   { return false; }
+
+   bool boundedBySubProjections() const
+   { return false; }
+
    static constexpr Compress suggestedCompression()
    { return KERNEL::suggestedCompression(); }
 
@@ -83,7 +90,7 @@ public:
     */
    template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
    Evaluator<CoordUniform, LR, ET, COMPRESS, PLO> evaluator(Storage<LR, ET, COMPRESS, PLO> storage) const
-   { return Evaluator<CoordUniform, LR, ET, COMPRESS, PLO>(std::move(storage), kernel().valuesVector(storage)); }
+   { return Evaluator<CoordUniform, LR, ET, COMPRESS, PLO>(std::move(storage), Kernel::valuesVector(kernel(), storage)); }
 
 private:
    KERNEL m_kernel;
@@ -106,11 +113,23 @@ public:
    {}
 
    /**
-    * Computes the value of the figure of merit of lattice \c lat for projection
-    * \c projection.
+    * Returns 0: the merit values of the subprojections do not bound the ones
+    * of the projections.
+    */
+   Real subProjectionBound(
+         const LatticeTester::Coordinates& projection,
+         const LatticeTester::Coordinates& subProjection,
+         Real subMerit
+         ) const
+   { return 0.0; }
+
+   /**
+    * Computes the value of the figure of merit of lattice \c lat, a LatDef or
+    * a LatView, for projection \c projection.
     */
+   template <class LAT>
    MeritValue operator() (
-         const LatDef<LR, ET>& lat,
+         const LAT& lat,
          const LatticeTester::Coordinates& projection
          ) const
    {
@@ -126,11 +145,16 @@ public:
       if (m_storage.sizeParam() != lat.sizeParam())
          throw std::logic_error("storage and lattice size parameters do not match");
 
-      RealVector prod(m_storage.size(), 1.0);
+      // the product is accumulated in place, one gathered coordinate at a time
+      auto coord = projection.begin();
+      RealVector prod;
+      m_storage.gather(m_kernelValues, lat.gen()[*coord], prod);
 
-      for (const auto coord : projection) {
-         const auto stridedKernel = m_storage.strided(m_kernelValues, lat.gen()[coord]);
-         prod = boost::numeric::ublas::element_prod(prod, stridedKernel);
+      RealVector stridedKernel;
+      while (++coord != projection.end()) {
+         m_storage.gather(m_kernelValues, lat.gen()[*coord], stridedKernel);
+         for (size_t i = 0; i < prod.size(); i++)
+            prod[i] *= stridedKernel[i];
       }
 
       auto merit = compressedSum(m_storage, prod);
@@ -25,9 +25,16 @@
 #include "latticetester/Rank1Lattice.h"
 #include "latticetester/Reducer.h"
 
+#include <NTL/ZZ.h>
+
+#include <algorithm>
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <cmath>
+#include <vector>
 
 namespace LatBuilder { namespace ProjDepMerit {
 
@@ -63,6 +70,14 @@ public:
    bool symmetric() const
    { return true; }
 
+   /// The shortest vector searches are independent, and the cache of the evaluator is thread-safe.
+   bool concurrent() const
+   { return true; }
+
+   /// The dual of a projection contains the dual vectors of its subprojections, padded with zeros.
+   bool boundedBySubProjections() const
+   { return true; }
+
    static constexpr Compress suggestedCompression()
    { return Compress::SYMMETRIC; }
 
@@ -91,57 +106,168 @@ private:
 };
 
 namespace detail {
-   template <class NORM, Compress COMPRESS, EmbeddingType ET>
-   Real spectralEval(
-            const Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS>& storage,
-            const LatDef<LatticeType::ORDINARY, ET>& lat,
+
+   /**
+    * Merit values of the projections of rank-1 lattices, shared by the copies
+    * of a spectral evaluator.
+    *
+    * The rank-1 lattice generated by a vector \f$\boldsymbol a\f$ modulo
+    * \f$n\f$ is also generated by \f$u \boldsymbol a\f$ for any unit \f$u\f$
+    * modulo \f$n\f$, and changing the sign of its coordinates or permuting them
+    * are isometries, so that none of these changes the length of the shortest
+    * vector of the dual lattice.  The projections are thus identified by their
+    * number of points and by the sorted absolute values, modulo \f$n\f$, of
+    * their generating vector scaled so that its first invertible component is
+    * 1; the basis reduction is only performed once for each of them, on the
+    * lattice generated by the key itself.  For instance, all the projections
+    * of a Korobov lattice on the same number of successive coordinates share a
+    * single reduction.
+    *
+    * The normalization constants are also kept for each number of points and
+    * dimension, instead of constructing a normalizer for each projection.
+    */
+   class SpectralCache {
+   public:
+      typedef std::vector<std::int64_t> Key;
+
+      /// Maximal number of merit values kept; the cache is cleared when it is full.
+      static constexpr size_t CAPACITY = size_t(1) << 16;
+
+      /**
+       * Returns the key of the projection \c projection of the lattice with
+       * \c numPoints points and generating vector \c gen.
+       */
+      template <class GEN>
+      static Key key(std::int64_t numPoints, const GEN& gen, const LatticeTester::Coordinates& projection)
+      {
+         Key key;
+         key.reserve(projection.size() + 1);
+         key.push_back(numPoints);
+         for (const auto& coord : projection)
+            key.push_back(static_cast<std::int64_t>(gen[coord] % numPoints));
+
+         // scale by the inverse of the first invertible component
+         const auto unit = std::find_if(key.begin() + 1, key.end(),
+               [numPoints] (std::int64_t a) { return NTL::GCD(static_cast<long>(a), static_cast<long>(numPoints)) == 1; });
+         if (unit != key.end()) {
+            const long inverse = NTL::InvMod(static_cast<long>(*unit), static_cast<long>(numPoints));
+            for (auto it = key.begin() + 1; it != key.end(); ++it)
+               *it = NTL::MulMod(static_cast<long>(*it), inverse, static_cast<long>(numPoints));
+         }
+
+         for (auto it = key.begin() + 1; it != key.end(); ++it)
+            *it = std::min(*it, numPoints - *it);
+         std::sort(key.begin() + 1, key.end());
+         return key;
+      }
+
+      /**
+       * Looks for the merit value of the projection identified by \c key.
+       * Returns true and sets \c merit if it is in the cache.
+       */
+      bool find(const Key& key, Real& merit) const
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         const auto it = m_merits.find(key);
+         if (it == m_merits.end())
+            return false;
+         merit = it->second;
+         return true;
+      }
+
+      /**
+       * Stores the merit value of the projection identified by \c key.
+       */
+      void insert(Key key, Real merit)
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         if (m_merits.size() >= CAPACITY)
+            m_merits.clear();
+         m_merits.emplace(std::move(key), merit);
+      }
+
+      /**
+       * Returns the squared length to which the squared length of the shortest
+       * dual vector is compared, for \c numPoints points in dimension \c
+       * dimension.
+       */
+      template <class NORM>
+      Real normalization(std::int64_t numPoints, int dimension)
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         const auto key = std::make_pair(numPoints, dimension);
+         const auto it = m_normalizations.find(key);
+         if (it != m_normalizations.end())
+            return it->second;
+
+         // Ref:
+         //   P. L'Ecuyer and C. Lemieux.
+         //   Variance Reduction via Lattice Rules.
+         //   Management Science, 46, 9 (2000), 1214-1235.
+         Real logDensity = log(numPoints);
+         NORM normalizer(
+               logDensity,
+               // 1 /* lattice rank */,
+               dimension);
+
+         if (normalizer.getNorm () != LatticeTester::L2NORM)
+            // this is the L2NORM implementation
+            throw std::invalid_argument ("norm of normalizer must be L2NORM");
+
+         const Real sqlength0 = normalizer.getGamma(dimension) * std::pow(numPoints, 2.0 / dimension);
+         m_normalizations.emplace(key, sqlength0);
+         return sqlength0;
+      }
+
+   private:
+      mutable std::mutex m_mutex;
+      std::map<Key, Real> m_merits;
+      std::map<std::pair<std::int64_t, int>, Real> m_normalizations;
+   };
+
+   /**
+    * Returns the merit value of the projection \c projection of the lattice
+    * with \c numPoints points and generating vector \c gen.
+    */
+   template <class NORM, class GEN>
+   Real spectralMerit(
+            std::int64_t numPoints,
+            const GEN& gen,
             const LatticeTester::Coordinates& projection,
-            Real power
+            Real power,
+            SpectralCache& cache
             )
    {
       typedef NORM Normalizer;
 
-      // Ref:
-      //   P. L'Ecuyer and C. Lemieux.
-      //   Variance Reduction via Lattice Rules.
-      //   Management Science, 46, 9 (2000), 1214-1235.
-      Real logDensity = log(lat.sizeParam().numPoints());
-      Normalizer normalizer(
-            logDensity,
-            // 1 /* lattice rank */,
-            static_cast<int>(projection.size()));
-      // idea: we could cache the normalizer values for each projection size
-      // (check in the profiler first if this is worth it)
-
-      if (normalizer.getNorm () != LatticeTester::L2NORM)
-         // this is the L2NORM implementation
-         throw std::invalid_argument ("norm of normalizer must be L2NORM");
-
       // if (projection.size() <= 1)
       // throw std::invalid_argument("projection order must be >= 2");
 
-      // extract projection of the generating vector
-      NTL::vector<std::int64_t> gen(projection.size());
-      {
-         // first component is not used
-         size_t j = 0;
-         for (const auto& coord : projection){
-               gen(j) = lat.gen()[coord];
-                  j++;
-         }   
-      }
+      auto key = SpectralCache::key(numPoints, gen, projection);
+      Real merit;
+      if (cache.find(key, merit))
+         return Real(pow(merit, power));
+
+      // the lattice is generated by the key, so that the merit value does not
+      // depend on which projection of its class is reduced first
+      NTL::vector<std::int64_t> keyGen(projection.size());
+      for (size_t j = 0; j < projection.size(); j++)
+         keyGen(j) = key[j + 1];
 
 #ifdef DEBUG
       using TextStream::operator<<;
-      std::cout << "      projected generator: " << gen << std::endl;
+      std::cout << "      projected generator: " << keyGen << std::endl;
 #endif
 
+      // normalization
+      Real sqlength0 = cache.normalization<Normalizer>(numPoints, static_cast<int>(projection.size()));
+
       // prepare lattice and basis reduction
       LatticeTester::Rank1Lattice<std::int64_t, std::int64_t, Real, Real> lattice(
-            lat.sizeParam().numPoints(),
-            gen,
+            numPoints,
+            keyGen,
             static_cast<int>(projection.size()),
-            normalizer.getNorm());
+            LatticeTester::L2NORM);
       lattice.buildBasis (static_cast<int>(projection.size()));
       lattice.dualize ();
 
@@ -161,13 +287,8 @@ namespace detail {
       // square length
       Real sqlength = lattice.getVecNorm(0); 
 
-      // normalization
-      Real sqlength0 =
-         normalizer.getGamma(static_cast<int>(projection.size())) * std::pow(
-                           lat.sizeParam().numPoints(),
-               2.0 / projection.size());
-
-      Real merit = std::sqrt (sqlength0 / sqlength);
+      merit = std::sqrt (sqlength0 / sqlength);
+      cache.insert(std::move(key), merit);
 
 #ifdef DEBUG
       std::cout << "      value: "
@@ -181,26 +302,30 @@ namespace detail {
       return Real(pow(merit, power));
    }
 
-   template <class NORM, Compress COMPRESS, EmbeddingType ET>
+   template <class NORM, Compress COMPRESS, class LAT>
+   Real spectralEval(
+            const Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS>& storage,
+            const LAT& lat,
+            const LatticeTester::Coordinates& projection,
+            Real power,
+            SpectralCache& cache
+            )
+   { return spectralMerit<NORM>(lat.sizeParam().numPoints(), lat.gen(), projection, power, cache); }
+
+   template <class NORM, Compress COMPRESS, class LAT>
    RealVector spectralEval(
             const Storage<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL, COMPRESS>& storage,
-            const LatDef<LatticeType::ORDINARY, ET>& lat,
+            const LAT& lat,
             const LatticeTester::Coordinates& projection,
-            Real power
+            Real power,
+            SpectralCache& cache
             )
    {
       RealVector out(storage.sizeParam().maxLevel() + 1, 0.0);
       auto itOut = out.begin();
 
       for (Level level = 0; level <= storage.sizeParam().maxLevel(); level++) {
-
-         typename Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS>::SizeParam osize(storage.sizeParam().numPointsOnLevel(level));
-         Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS> ostorage(osize);
-
-         auto olat = createLatDef(osize, lat.gen());
-
-         *itOut = spectralEval<NORM>(ostorage, olat, projection, power);
-
+         *itOut = spectralMerit<NORM>(storage.sizeParam().numPointsOnLevel(level), lat.gen(), projection, power, cache);
          ++itOut;
       }
       return out;
@@ -220,15 +345,17 @@ public:
       Real power
       ):
       m_storage(std::move(storage)),
-      m_power(std::move(power))
+      m_power(std::move(power)),
+      m_cache(std::make_shared<detail::SpectralCache>())
    {}
 
    /**
-    * Computes the value of the figure of merit of lattice \c lat for projection
-    * \c projection.
+    * Computes the value of the figure of merit of lattice \c lat, a LatDef or
+    * a LatView, for projection \c projection.
     */
+   template <class LAT>
    MeritValue operator() (
-         const LatDef<LatticeType::ORDINARY, ET>& lat,
+         const LAT& lat,
          const LatticeTester::Coordinates& projection
          ) const
    {
@@ -244,12 +371,37 @@ public:
       if (m_storage.sizeParam() != lat.sizeParam())
          throw std::logic_error("storage and lattice size parameters do not match");
 
-      return detail::spectralEval<NORM>(m_storage, lat, projection, m_power);
+      return detail::spectralEval<NORM>(m_storage, lat, projection, m_power, *m_cache);
+   }
+
+   /**
+    * Returns a lower bound on the value of the figure of merit for the
+    * projection \c projection, given its value \c subMerit for the
+    * subprojection \c subProjection.
+    *
+    * The shortest dual vector of \c projection is at most as long as the one
+    * of \c subProjection, since the latter padded with zeros belongs to the
+    * dual of \c projection; only the normalizations differ.  The bound is
+    * lowered by a few ulps against the rounding errors.
+    */
+   Real subProjectionBound(
+         const LatticeTester::Coordinates& projection,
+         const LatticeTester::Coordinates& subProjection,
+         Real subMerit
+         ) const
+   {
+      if (not (subMerit < std::numeric_limits<Real>::infinity()))
+         return 0.0; // the reduction failed
+      const std::int64_t numPoints = m_storage.sizeParam().numPoints();
+      const Real sqlength0 = m_cache->normalization<NORM>(numPoints, static_cast<int>(projection.size()));
+      const Real subSqlength0 = m_cache->normalization<NORM>(numPoints, static_cast<int>(subProjection.size()));
+      return subMerit * Real(pow(sqlength0 / subSqlength0, m_power / 2)) * (1 - 8 * std::numeric_limits<Real>::epsilon());
    }
 
 private:
    Storage<LatticeType::ORDINARY, ET, COMPRESS> m_storage;
    Real m_power;
+   std::shared_ptr<detail::SpectralCache> m_cache; // shared by the copies of the evaluator
 };
 
 }}
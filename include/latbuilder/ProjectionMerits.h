@@ -0,0 +1,82 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Projection-dependent merit values of a lattice, by projection.
+ */
+
+#ifndef LATBUILDER__PROJECTION_MERITS_H
+#define LATBUILDER__PROJECTION_MERITS_H
+
+#include "latbuilder/Types.h"
+
+#include "latticetester/Coordinates.h"
+
+#include <map>
+#include <utility>
+
+namespace LatBuilder
+{
+
+/**
+ * Projection-dependent merit values of a lattice, by projection.
+ *
+ * MeritSeq::CBC keeps those of the coordinates selected so far, so that the
+ * evaluator of a WeightedFigureOfMerit can bound the merit values of the
+ * projections of the candidate lattices by the ones of their subprojections
+ * (see ProjDepMerit::Base::boundedBySubProjections()).
+ */
+class ProjectionMerits {
+public:
+   /**
+    * Looks for the merit value of the projection \c projection.
+    * Returns \c true and sets \c merit if it is known.
+    */
+   bool find(const LatticeTester::Coordinates& projection, Real& merit) const
+   {
+      const auto it = m_merits.find(projection);
+      if (it == m_merits.end())
+         return false;
+      merit = it->second;
+      return true;
+   }
+
+   /**
+    * Stores the merit value \c merit of the projection \c projection.
+    */
+   void insert(LatticeTester::Coordinates projection, Real merit)
+   { m_merits[std::move(projection)] = merit; }
+
+   /**
+    * Returns the number of projections whose merit value is known.
+    */
+   size_t size() const
+   { return m_merits.size(); }
+
+   /**
+    * Forgets all the merit values.
+    */
+   void clear()
+   { m_merits.clear(); }
+
+private:
+   std::map<LatticeTester::Coordinates, Real> m_merits;
+};
+
+}
+
+#endif
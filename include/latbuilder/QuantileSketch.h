@@ -0,0 +1,130 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Streaming quantiles of merit values.
+ */
+
+#ifndef LATBUILDER__QUANTILE_SKETCH_H
+#define LATBUILDER__QUANTILE_SKETCH_H
+
+#include "latbuilder/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Approximate quantiles of a stream of values, in bounded memory.
+ *
+ * The sketch is the KLL sketch of Karnin, Lang and Liberty (2016).  The
+ * values are stored in levels, a value of level \f$h\f$ standing for
+ * \f$2^h\f$ values of the stream.  When the sketch is full, the lowest level
+ * exceeding its capacity is sorted and one value out of two is promoted to
+ * the next level, starting from a random offset.  The capacity of the levels
+ * decreases geometrically from the top one, of capacity \c k, with a factor
+ * \f$2/3\f$; the sketch thus stores \f$O(k + \log n)\f$ values for a stream
+ * of \f$n\f$ values, and the error on the rank of a quantile is of the order
+ * of \f$n/k\f$.  The random offsets are drawn from a fixed seed, so that the
+ * quantiles are reproducible.
+ *
+ * The minimum and the maximum values are exact.
+ */
+class QuantileSketch {
+public:
+   /**
+    * Constructor.
+    * \param k Capacity of the top level, which sets the accuracy of the sketch.
+    */
+   explicit QuantileSketch(unsigned int k = 200);
+
+   /**
+    * Adds \c value to the stream.
+    */
+   void insert(Real value);
+
+   /**
+    * Adds the values of the stream of \c other to the stream.
+    */
+   void merge(const QuantileSketch& other);
+
+   /**
+    * Forgets all the values.
+    */
+   void clear();
+
+   /**
+    * Returns the number of values of the stream.
+    */
+   unsigned long long count() const
+   { return m_count; }
+
+   /**
+    * Returns the number of values stored by the sketch.
+    */
+   size_t storedValues() const
+   { return m_size; }
+
+   /**
+    * Returns the smallest value of the stream, or infinity if it is empty.
+    */
+   Real min() const
+   { return m_min; }
+
+   /**
+    * Returns the largest value of the stream, or minus infinity if it is
+    * empty.
+    */
+   Real max() const
+   { return m_max; }
+
+   /**
+    * Returns the approximate quantile of probability \c p, that is, the
+    * smallest stored value whose weighted rank is at least \f$p n\f$.
+    * Returns min() for \f$p \leq 0\f$ and max() for \f$p \geq 1\f$.
+    */
+   Real quantile(Real p) const;
+
+   /**
+    * Returns the approximate fraction of the values of the stream which do not
+    * exceed \c value.
+    */
+   Real cdf(Real value) const;
+
+private:
+   unsigned int m_k;
+   std::vector<std::vector<Real>> m_levels;
+   size_t m_size;
+   std::vector<size_t> m_capacities;
+   size_t m_totalCapacity;
+   unsigned long long m_count;
+   Real m_min;
+   Real m_max;
+   std::uint64_t m_randomState;
+
+   void updateCapacity();
+   void compress();
+   bool randomBit();
+};
+
+}
+
+#endif
@@ -0,0 +1,82 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Keyed pseudo-random permutations of ranges of indices.
+ */
+
+#ifndef LATBUILDER__RANDOM_PERMUTATION_H
+#define LATBUILDER__RANDOM_PERMUTATION_H
+
+#include <cstdint>
+
+namespace LatBuilder {
+
+/**
+ * Pseudo-random permutation of the indices <tt>[0, size)</tt>, selected by a
+ * 64-bit key, whose values are computed one by one in constant memory.
+ *
+ * The permutation is a balanced Feistel network of #rounds rounds on the
+ * smallest range of \f$2^{2h}\f$ indices which contains <tt>[0, size)</tt>,
+ * restricted to <tt>[0, size)</tt> by cycle walking: an index is permuted again
+ * until it falls in the range, which takes fewer than four rounds of the network
+ * on average.  Drawing the images of \f$0, 1, \dots\f$ thus samples the
+ * indices without replacement, and the images of disjoint ranges of indices
+ * under the same key are disjoint.
+ */
+class RandomPermutation {
+public:
+   /// Number of rounds of the Feistel network.
+   static constexpr unsigned int rounds = 4;
+
+   /**
+    * Constructor.
+    *
+    * \param size    Number of indices; must be positive.
+    * \param key     Key selecting the permutation.
+    */
+   RandomPermutation(uint64_t size = 1, uint64_t key = 0);
+
+   /**
+    * Returns the number of indices.
+    */
+   uint64_t size() const
+   { return m_size; }
+
+   /**
+    * Returns the image of index \c i, which must be smaller than size().
+    */
+   uint64_t operator()(uint64_t i) const
+   {
+      do {
+         i = encrypt(i);
+      } while (i >= m_size);
+      return i;
+   }
+
+private:
+   uint64_t m_size;
+   unsigned int m_halfBits;
+   uint64_t m_halfMask;
+   uint64_t m_keys[rounds];
+
+   uint64_t encrypt(uint64_t x) const;
+};
+
+}
+
+#endif
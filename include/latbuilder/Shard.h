@@ -0,0 +1,174 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Splitting of a search into independent jobs.
+ */
+
+#ifndef LATBUILDER__SHARD_H
+#define LATBUILDER__SHARD_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/LFSR258.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Shard of a search split into independent jobs, which neither communicate
+ * nor share a coordinator, unlike the processes of Distributed.
+ *
+ * The search of shard \f$i\f$ of \f$N\f$ (with \f$0 \leq i < N\f$) explores
+ * the contiguous range of the candidates returned by begin() and end(), in the
+ * order of the serial search, and writes its best candidate to a Result file.
+ * The results of all the shards are then combined by merge(), which any job
+ * may run: the smallest merit value wins, and ties are resolved in favor of
+ * the smallest shard, which is the first in the order of the serial search.
+ * The merged result is thus that of the serial search.
+ *
+ * The random searches draw their samples from stream \f$i\f$ of LFSR258 (see
+ * randomGenerator()), and each shard draws its share of the samples: the
+ * merged result is that of a search of the same number of samples, but not
+ * of the serial search.  The CBC searches are split one coordinate at a
+ * time: the shards of a coordinate extend the same base point set, the
+ * merged result of the previous coordinate.
+ *
+ * By default, there is a single shard.
+ */
+class Shard {
+public:
+   /**
+    * Best candidate of a shard.
+    *
+    * The file is a plain text file with the same layout as a Checkpoint: comment
+    * lines giving the shard, the number of coordinates and the merit value,
+    * followed by one line per coordinate containing its generating value, as
+    * formatted in the checkpoints.
+    */
+   struct Result {
+      /// Index of the shard.
+      unsigned int index = 0;
+
+      /// Number of shards.
+      unsigned int count = 1;
+
+      /// Merit value of the candidate, infinite if the shard has no candidate.
+      Real merit = 0;
+
+      /// Formatted generating values of the candidate, empty if the shard has
+      /// no candidate.
+      std::vector<std::string> genValues;
+
+      /**
+       * Writes the result to \c fileName, through a temporary file which is
+       * then renamed.
+       */
+      void write(const std::string& fileName) const;
+
+      /**
+       * Reads a result written by write().
+       *
+       * \throws std::runtime_error if the file cannot be read or is not a
+       * valid result.
+       */
+      static Result read(const std::string& fileName);
+   };
+
+   /**
+    * Sets the shard of the process to shard \c index of \c count.
+    *
+    * \throws std::runtime_error if \c index is not smaller than \c count.
+    */
+   static void set(unsigned int index, unsigned int count);
+
+   /**
+    * Sets the shard of the process from a specification
+    * <tt>\<index\>/\<count\></tt>.
+    *
+    * \throws std::runtime_error if the specification is invalid.
+    */
+   static void parse(const std::string& spec);
+
+   /**
+    * Sets the shard of the process back to the whole search (shard 0 of 1).
+    */
+   static void clear();
+
+   /**
+    * Returns the index of the shard of the process.
+    */
+   static unsigned int index();
+
+   /**
+    * Returns the number of shards.
+    */
+   static unsigned int count();
+
+   /**
+    * Returns \c true if the search is split into several shards.
+    */
+   static bool active()
+   { return count() > 1; }
+
+   /**
+    * Returns the index of the first of the \c total candidates explored by
+    * the shard of the process.
+    */
+   static uInteger begin(uInteger total)
+   { return rangeBegin(index(), total); }
+
+   /**
+    * Returns the index past the last of the \c total candidates explored by
+    * the shard of the process.
+    */
+   static uInteger end(uInteger total)
+   { return rangeBegin(index() + 1, total); }
+
+   /**
+    * Returns \c true if the shard of the process explores the candidate of
+    * index \c candidate among \c total candidates.
+    */
+   static bool owns(uInteger candidate, uInteger total)
+   { return candidate >= begin(total) && candidate < end(total); }
+
+   /**
+    * Returns a generator starting at stream index() of LFSR258, counted from
+    * the thread default seed.
+    */
+   static LFSR258 randomGenerator();
+
+   /**
+    * Returns the best of the results of all the shards of a search.
+    *
+    * \throws std::runtime_error if the results are not those of one search,
+    * with each shard exactly once.
+    */
+   static Result merge(const std::vector<Result>& results);
+
+private:
+   static uInteger rangeBegin(unsigned int shard, uInteger total)
+   { return total / count() * shard + std::min<uInteger>(shard, total % count()); }
+};
+
+}
+
+#endif
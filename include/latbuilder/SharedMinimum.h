@@ -0,0 +1,97 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Lock-free cell holding the smallest merit value found by a search.
+ */
+
+#ifndef LATBUILDER__SHARED_MINIMUM_H
+#define LATBUILDER__SHARED_MINIMUM_H
+
+#include "latbuilder/Types.h"
+
+#include <atomic>
+#include <limits>
+
+namespace LatBuilder
+{
+
+/**
+ * Smallest merit value observed so far by a search, shared by the threads
+ * which evaluate candidates concurrently.
+ *
+ * Evaluators of figures of merit poll the cell after each contribution to the
+ * merit value of a candidate, and abort the computation as soon as the partial
+ * value exceeds the current minimum, so that a bound found by any thread
+ * is seen by all the others right away.  Reads and writes are lock-free
+ * atomic operations; since the minimum only decreases, relaxed loads can only
+ * delay the abortion of a computation, never abort it wrongly.
+ *
+ * A partial value equal to the minimum is accepted, so that the candidate
+ * selected by a serial search, which keeps the first candidate reaching the
+ * minimum, is never aborted whatever the order of the evaluations.
+ */
+class SharedMinimum
+{
+public:
+   /**
+    * Constructor.
+    * \param value Initial value of the minimum.
+    */
+   explicit SharedMinimum(Real value = std::numeric_limits<Real>::infinity()):
+      m_value(value)
+   {}
+
+   SharedMinimum(const SharedMinimum&) = delete;
+   SharedMinimum& operator=(const SharedMinimum&) = delete;
+
+   /**
+    * Returns the current minimum.
+    */
+   Real value() const
+   { return m_value.load(std::memory_order_relaxed); }
+
+   /**
+    * Returns \c true if the partial merit value \c merit does not exceed the
+    * current minimum.
+    */
+   bool accepts(Real merit) const
+   { return merit <= value(); }
+
+   /**
+    * Lowers the minimum to \c merit if it is smaller.
+    */
+   void lower(Real merit)
+   {
+      Real current = value();
+      while (merit < current && !m_value.compare_exchange_weak(current, merit, std::memory_order_relaxed))
+      {}
+   }
+
+   /**
+    * Sets the minimum to \c value, by default to infinity.
+    */
+   void reset(Real value = std::numeric_limits<Real>::infinity())
+   { m_value.store(value, std::memory_order_relaxed); }
+
+private:
+   std::atomic<Real> m_value;
+};
+
+}
+
+#endif
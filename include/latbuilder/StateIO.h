@@ -0,0 +1,206 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Binary serialization of the states of the component-by-component searches.
+ */
+
+#ifndef LATBUILDER__STATE_IO_H
+#define LATBUILDER__STATE_IO_H
+
+#include "latbuilder/Types.h"
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Writing and reading of the states of the evaluators of the
+ * component-by-component searches, so that a search extending a point set
+ * starts from the state saved after its construction instead of evaluating
+ * its coordinates again.
+ *
+ * The values are written in the native binary representation, and the sizes
+ * of the containers as 64-bit integers: the states can only be read on the
+ * same architecture, by the same version of the program.  The read()
+ * functions throw \c std::runtime_error if the stream ends or fails.
+ */
+namespace StateIO
+{
+   /// Writes the arithmetic or enumeration value \c value.
+   template <typename T>
+   typename std::enable_if<std::is_arithmetic<T>::value or std::is_enum<T>::value>::type
+   write(std::ostream& os, const T& value)
+   { os.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+
+   /// Reads an arithmetic or enumeration value written by write().
+   template <typename T>
+   typename std::enable_if<std::is_arithmetic<T>::value or std::is_enum<T>::value>::type
+   read(std::istream& is, T& value)
+   {
+      if (not is.read(reinterpret_cast<char*>(&value), sizeof(T)))
+         throw std::runtime_error("unexpected end of state");
+   }
+
+   /// Writes the size of a container.
+   inline void writeSize(std::ostream& os, size_t size)
+   { write(os, static_cast<std::uint64_t>(size)); }
+
+   /// Reads the size of a container written by writeSize().
+   inline size_t readSize(std::istream& is)
+   {
+      std::uint64_t size;
+      read(is, size);
+      return static_cast<size_t>(size);
+   }
+
+   /// Writes the elements of the array of \c size values at \c data.
+   template <typename T>
+   void writeArray(std::ostream& os, const T* data, size_t size)
+   {
+      static_assert(std::is_arithmetic<T>::value, "only arrays of numbers are written at once");
+      os.write(reinterpret_cast<const char*>(data), size * sizeof(T));
+   }
+
+   /// Reads \c size values written by writeArray() to \c data.
+   template <typename T>
+   void readArray(std::istream& is, T* data, size_t size)
+   {
+      static_assert(std::is_arithmetic<T>::value, "only arrays of numbers are read at once");
+      if (not is.read(reinterpret_cast<char*>(data), size * sizeof(T)))
+         throw std::runtime_error("unexpected end of state");
+   }
+
+   // the containers of containers find each other
+   template <typename T> void write(std::ostream& os, const std::vector<T>& vec);
+   template <typename T> void read(std::istream& is, std::vector<T>& vec);
+   template <typename T> void write(std::ostream& os, const std::set<T>& set);
+   template <typename T> void read(std::istream& is, std::set<T>& set);
+   template <typename K, typename V> void write(std::ostream& os, const std::map<K, V>& map);
+   template <typename K, typename V> void read(std::istream& is, std::map<K, V>& map);
+
+   inline void write(std::ostream& os, const std::string& str)
+   {
+      writeSize(os, str.size());
+      os.write(str.data(), str.size());
+   }
+
+   inline void read(std::istream& is, std::string& str)
+   {
+      str.resize(readSize(is));
+      if (not str.empty() and not is.read(&str[0], str.size()))
+         throw std::runtime_error("unexpected end of state");
+   }
+
+   inline void write(std::ostream& os, const RealVector& vec)
+   {
+      writeSize(os, vec.size());
+      if (vec.size() > 0)
+         writeArray(os, &vec[0], vec.size());
+   }
+
+   inline void read(std::istream& is, RealVector& vec)
+   {
+      vec.resize(readSize(is), false);
+      if (vec.size() > 0)
+         readArray(is, &vec[0], vec.size());
+   }
+
+   template <typename T>
+   void write(std::ostream& os, const std::vector<T>& vec)
+   {
+      writeSize(os, vec.size());
+      for (const auto& x : vec)
+         write(os, x);
+   }
+
+   template <typename T>
+   void read(std::istream& is, std::vector<T>& vec)
+   {
+      vec.resize(readSize(is));
+      for (auto& x : vec)
+         read(is, x);
+   }
+
+   template <typename T>
+   void write(std::ostream& os, const std::set<T>& set)
+   {
+      writeSize(os, set.size());
+      for (const auto& x : set)
+         write(os, x);
+   }
+
+   template <typename T>
+   void read(std::istream& is, std::set<T>& set)
+   {
+      set.clear();
+      for (size_t n = readSize(is); n > 0; n--) {
+         T x;
+         read(is, x);
+         set.insert(set.end(), x);
+      }
+   }
+
+   template <typename K, typename V>
+   void write(std::ostream& os, const std::map<K, V>& map)
+   {
+      writeSize(os, map.size());
+      for (const auto& kv : map) {
+         write(os, kv.first);
+         write(os, kv.second);
+      }
+   }
+
+   template <typename K, typename V>
+   void read(std::istream& is, std::map<K, V>& map)
+   {
+      map.clear();
+      for (size_t n = readSize(is); n > 0; n--) {
+         K key;
+         V value;
+         read(is, key);
+         read(is, value);
+         map.emplace_hint(map.end(), std::move(key), std::move(value));
+      }
+   }
+
+   /**
+    * Reads a value written by write() and throws \c std::runtime_error with
+    * the message \c what if it differs from \c expected.
+    */
+   template <typename T>
+   void expect(std::istream& is, const T& expected, const std::string& what)
+   {
+      T value;
+      read(is, value);
+      if (value != expected)
+         throw std::runtime_error("invalid state: " + what);
+   }
+}
+
+}
+
+#endif
@@ -0,0 +1,162 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Rows of the coordinate-uniform states, in memory or in memory-mapped files.
+ */
+
+#ifndef LATBUILDER__STATE_MATRIX_H
+#define LATBUILDER__STATE_MATRIX_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/Memory.h"
+
+#include <boost/align/aligned_allocator.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Matrix of floating-point values stored row by row, to which rows are
+ * appended, for the vectors of the coordinate-uniform states of all orders.
+ *
+ * The matrix is kept in memory, unless a directory is set with
+ * setDirectory(), in which case the matrices of at least one row of
+ * HugePages::threshold bytes are kept in temporary files of that directory,
+ * mapped in memory, so that the states of constructions for numbers of points
+ * beyond the available memory are paged in and out by the operating system.
+ * The states are traversed block of points by block of points, rows
+ * interleaved, so the traversals call prefetch() on the points of the next
+ * blocks.  The multilevel storages store the points level by level, so that
+ * these blocks also go through the levels in order.
+ *
+ * The rows are padded to a multiple of 32 bytes and aligned on 32 bytes.
+ * The matrices kept in memory are charged to the states component of Memory.
+ */
+class StateMatrix {
+public:
+   /**
+    * Sets the directory of the files of the matrices created or reset
+    * afterwards.  The matrices are kept in memory if \c directory is empty
+    * (the default).  If the directory does not exist, it is created.
+    */
+   static void setDirectory(const std::string& directory);
+
+   /**
+    * Returns the directory of the files of the matrices.
+    */
+   static std::string directory();
+
+   StateMatrix();
+   StateMatrix(const StateMatrix& other);
+   StateMatrix& operator=(const StateMatrix& other);
+   ~StateMatrix();
+
+   /**
+    * Assigns to the matrix a single row of \c numColumns elements equal to \c
+    * value.
+    */
+   void reset(size_t numColumns, Real value);
+
+   /**
+    * Appends a row of elements equal to \c value.
+    */
+   void appendRow(Real value);
+
+   /**
+    * Returns the number of elements of the rows.
+    */
+   size_t numColumns() const
+   { return m_numColumns; }
+
+   /**
+    * Returns the distance between the first elements of consecutive rows.
+    */
+   size_t rowSize() const
+   { return m_rowSize; }
+
+   /**
+    * Returns the number of rows.
+    */
+   size_t numRows() const
+   { return m_numRows; }
+
+   /**
+    * Returns the first element of row \c row.
+    */
+   Real* row(size_t row)
+   { return m_data + row * m_rowSize; }
+
+   /// \copydoc row()
+   const Real* row(size_t row) const
+   { return m_data + row * m_rowSize; }
+
+   /**
+    * Returns \c true if the matrix is kept in a memory-mapped file.
+    */
+   bool mapped() const
+   { return !m_fileName.empty(); }
+
+   /**
+    * Tells the operating system that the elements of the columns <tt>[begin,
+    * end)</tt> of all rows will be accessed soon, so that it reads them
+    * ahead if the matrix is kept in a file.  Does nothing otherwise.
+    */
+   void prefetch(size_t begin, size_t end) const;
+
+   /**
+    * Writes the rows of the matrix to \c os, as described in StateIO.
+    */
+   void save(std::ostream& os) const;
+
+   /**
+    * Replaces the matrix by the one written to \c is by save().  The matrix
+    * is kept in memory or in a file as after reset().
+    */
+   void load(std::istream& is);
+
+private:
+   size_t m_numColumns;
+   size_t m_rowSize;
+   size_t m_numRows;
+   Real* m_data;
+
+   std::vector<Real, boost::alignment::aligned_allocator<Real, 32>> m_memory;
+
+   std::string m_fileName;
+   boost::interprocess::file_mapping m_file;
+   boost::interprocess::mapped_region m_region;
+
+   Memory::Usage m_usage;
+
+   void resize(size_t numRows, Real value);
+   void createFile(const std::string& dir);
+   void mapFile(size_t bytes);
+   void removeFile();
+   void account();
+};
+
+}
+
+#endif
@@ -20,12 +20,37 @@
 #include "latbuilder/SizeParam.h"
 #include "latbuilder/GenSeq/CyclicGroup.h"
 #include "latbuilder/GenSeq/GeneratingValues.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Memory.h"
 
+#include <algorithm>
+
+#include <cstdint>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 namespace LatBuilder {
 
+namespace detail {
+   // calls f(i, group[i]) for the indices i from first to last - 1
+   template <class GROUP, class F>
+   void forEachGroupElement(const GROUP& group, size_t first, size_t last, const F& f)
+   {
+      for (size_t i = first; i < last; i++)
+         f(i, group[i]);
+   }
+
+   // cyclic groups avoid the modular exponentiation per element
+   template <LatticeType LR, Compress COMPRESS, class TRAV, GenSeq::GroupOrder ORDER, class F>
+   void forEachGroupElement(const GenSeq::CyclicGroup<LR, COMPRESS, TRAV, ORDER>& group, size_t first, size_t last, const F& f)
+   { group.forEachElement(first, last, f); }
+}
+
 template <PerLevelOrder, LatticeType LR, Compress COMPRESS>
 struct PerLevelOrderTraits;
 
@@ -93,91 +118,33 @@ struct StorageTraits<Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO>> {
 
    /**
     * Unpermuted permutation.
+    *
+    * The storage addresses of the indices are read from the table of
+    * Storage::addresses(), which is shared by the storages of the same size
+    * parameter.
     */
    class Unpermute {
    public:
       typedef StorageTraits::size_type size_type;
-      typedef std::pair<boost::numeric::ublas::range, size_type> AddressType;
       typedef StorageTraits::value_type value_type;
       Unpermute(Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO> storage):
-         m_storage(std::move(storage))
-      {
-         // initialize addresses
-         m_indexToAddress[value_type(0)] = std::make_pair(boost::numeric::ublas::range{0, 1}, 0);
-         size_t start = 1;
-         typename GroupType::value_type mult = m_storage.sizeParam().modulus();
-         for (Level level = 1; level <= m_storage.sizeParam().maxLevel(); level++) {
-            mult /= m_storage.sizeParam().base();
-            const auto& subgroup = m_storage.indices(level);
-            typename GroupType::size_type i = 0;
-            boost::numeric::ublas::range range{start, start + subgroup.size()};
-            for (const auto g : subgroup)
-               m_indexToAddress[mult * g] = std::make_pair(range, i++);
-            start += subgroup.size();
-         }
-      }
+         m_storage(std::move(storage)),
+         m_addresses(&m_storage.addresses())
+      {}
 
       size_type operator() (size_type i) const
       {
-         const auto where = indexToAddress( LatticeTraits<LR>::ToGenValue(i));
-         return where.first.start() + where.second;
+         if (i >= m_addresses->size())
+            throw std::out_of_range("index is too large");
+         return (*m_addresses)[i];
       }
 
       size_type size() const
       { return m_storage.virtualSize(); }
 
    private:
-      typedef std::map< value_type, AddressType> MapType;
-
       Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO > m_storage;
-      MapType m_indexToAddress;
-
-      /**
-       * Returns the address of the element at index \c i.
-       *
-       * The address is a pair of which the first element is a range on the
-       * elements indices for the level, and the sub-index on that level.
-       */
-      const AddressType& indexToAddress(value_type i) const
-      {
-         i = Compress::compressIndex(i, m_storage.sizeParam().modulus());
-         typename MapType::const_iterator it = m_indexToAddress.find(i);
-         if (it == m_indexToAddress.end())
-            throw std::out_of_range("index is too large");
-         return it->second;
-#if 0
-         using boost::numeric::ublas::range;
-
-         if (i == 0)
-            return std::pair<range, size_t>{{0, 1}, 0};
-
-         if (i >= m_storage.sizeParam().numPoints())
-            throw std::out_of_range("index is too large");
-
-         const uInteger base = m_storage.sizeParam().base();
-
-         i = Compress::compressIndex(i, m_storage.sizeParam().numPoints());
-
-         size_t end = m_storage.sizeParam().numPoints();
-         Level level = m_storage.sizeParam().maxLevel();
-         while (i % base == 0) {
-            i /= base;
-            end /= base;
-            level--;
-         }
-
-         // level start
-         const size_t begin = end / base;
-
-         // permute on-level index
-         i = m_indexToAddress[level].indexToAddress(i)->second;
-
-         //GenSeq::CyclicGroup<Compress, GenSeq::GroupOrder::INVERSE> indices(base, level);
-         //i = group.find(i) - group.begin();
-
-         return std::pair<range, size_t>{{Compress::size(begin), Compress::size(end)}, i};
-#endif
-      }
+      const std::vector<std::uint32_t>* m_addresses; // owned by the tables of m_storage
    };
 
    /**
@@ -227,6 +194,9 @@ struct StorageTraits<Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO>> {
       typedef StorageTraits::size_type size_type;
       typedef StorageTraits::value_type value_type;
 
+      /// \c true if forEachRun() produces runs of more than one index.
+      static constexpr bool contiguousRuns = PLO == PerLevelOrder::CYCLIC;
+
       Stride(Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO> storage, value_type stride):
          m_storage(std::move(storage)),
          m_stride(stride),
@@ -298,32 +268,77 @@ struct StorageTraits<Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO>> {
       size_type size() const
       { return m_storage.size(); }
 
+      /**
+       * Calls <tt>f(i, j, n)</tt> for runs of consecutive indices of the
+       * permutation restricted to the indices \c first to <tt>last - 1</tt>,
+       * such that the indices \c i to <tt>i + n - 1</tt> are mapped to \c j to
+       * <tt>j + n - 1</tt>, in increasing order of \c i.
+       *
+       * With the inverse-cyclic per-level order, the stride shifts each
+       * circulant block, so that each level consists of two runs (four with
+       * the half-blocks of base 2), and the permuted elements can be read as
+       * contiguous vectors.  Otherwise, each run has a single index.
+       */
+      template <class F>
+      void forEachRun(size_type first, size_type last, const F& f) const
+      {
+         forEachRun(first, last, f, std::integral_constant<bool, PLO == PerLevelOrder::CYCLIC>());
+      }
+
    private:
       Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO> m_storage;
       value_type m_stride;
       size_type m_row;
 
+      template <class F>
+      void forEachRun(size_type first, size_type last, const F& f, std::false_type) const
+      {
+         for (size_type i = first; i < last; i++)
+            f(i, (*this)(i), 1);
+      }
+
+      template <class F>
+      void forEachRun(size_type first, size_type last, const F& f, std::true_type) const
+      {
+         // the indices i to i + n - 1 restricted to [first, last)
+         auto run = [&] (size_type i, size_type j, size_type n) {
+            const size_type begin = std::max(i, first);
+            const size_type end = std::min(i + n, last);
+            if (begin < end)
+               f(begin, j + (begin - i), end - begin);
+         };
+         const size_type seqsize = m_storage.indices().size();
+         size_type start = 0;
+         for (Level level = 0; start < last; level++) {
+            const size_type size = m_storage.indices(level).size();
+            // same blocks as operator()
+            const bool halves = LR == LatticeType::ORDINARY and not Compress::symmetric()
+               and m_storage.sizeParam().base() == (value_type)(2) and size >= 2;
+            const size_type numBlocks = halves ? 2 : 1;
+            const size_type blockSize = size / numBlocks;
+            const size_type reverse = halves and m_row >= seqsize / 2 ? 1 : 0;
+            const size_type shift = (seqsize - m_row) % blockSize;
+            for (size_type block = 0; block < numBlocks; block++) {
+               const size_type dest = start + block * blockSize;
+               const size_type src = start + (block ^ reverse) * blockSize;
+               run(dest, src + shift, blockSize - shift);
+               run(dest + blockSize - shift, src, shift);
+            }
+            start += size;
+         }
+      }
+
       /**
        * Returns the row on which the generator value \c stride can be found.
        */
       size_type findRow(value_type stride) const
       {
-#if 0
-         return std::find(
-               m_storage.indices().begin(),
-               m_storage.indices().end(),
-               stride)
-            - m_storage.indices().begin();
-#else
-         if(PLO == PerLevelOrder::CYCLIC)
-            return std::find(
-               m_storage.generators().begin(),
-               m_storage.generators().end(),
-               Compress::compressIndex(stride, m_storage.sizeParam().modulus()))
-            - m_storage.generators().begin();
-        else if (PLO == PerLevelOrder::BASIC) // no nedd to compute the row of the stride 
+         if (PLO == PerLevelOrder::BASIC) // no need to compute the row of the stride
             return 0;
-#endif
+         // the generator values which are not found are mapped past the last row
+         const auto& rows = m_storage.generatorRows();
+         const uInteger i = LatticeTraits<LR>::ToIndex(Compress::compressIndex(stride, m_storage.sizeParam().modulus()));
+         return i < rows.size() ? rows[i] : m_storage.generators().size();
       }
    };
 
@@ -347,6 +362,11 @@ struct StorageTraits<Storage<LR, EmbeddingType::MULTILEVEL, COMPRESS, PLO>> {
  * - PerLevelOrder::BASIC corresponds to the "natural order".
  * more details in Storage.
  *
+ * The groups of indices of the levels and the index tables derived from them
+ * are immutable and shared by all the storages of the same size parameter, so
+ * that copying a storage into the merit sequences, states and permutations
+ * costs no memory.
+ *
  * \tparam COMPRESS     Compression type (either None or Symmetric).
  *                      If Compress::SYMMETRIC, the permuted indices are
  *                      compressed by assuming that the vector components at
@@ -380,24 +400,19 @@ public:
 
    Storage(const Storage& other):
       BasicStorage<Storage>(other.sizeParam()),
-      m_groups(other.m_groups),
-      m_genGroup(other.m_genGroup)
+      m_tables(other.m_tables)
    {
       // This constructor should not be written explicitly.
       // This is a workaround for a bug in LLVM.
    }
 
    Storage(SizeParam sizeParam):
-      BasicStorage<Storage>(std::move(sizeParam)),
-      m_groups(this->sizeParam().maxLevel() + 1)
-      
+      BasicStorage<Storage>(std::move(sizeParam))
    {
       if(COMPRESS == LatBuilder::Compress::SYMMETRIC && (LR == LatticeType::POLYNOMIAL || LR == LatticeType::DIGITAL))
-        throw std::invalid_argument("Storage(): No symmetric kernel implemented for polynomial");
+        throw std::invalid_argument("Storage(): symmetric compression is only available for ordinary lattices");
 
-    
-      PerLevelOrderTraits<PLO, LR, COMPRESS>::initializeGroups(this->sizeParam().base(), this->sizeParam().maxLevel(),m_groups, m_genGroup);
-      
+      m_tables = sharedTables(this->sizeParam());
    }
 
    size_type virtualSize() const
@@ -407,13 +422,40 @@ public:
    { return RealVector(this->sizeParam().maxLevel() + 1, value); }
 
    const GroupType& indices() const
-   { return m_groups.back(); }
+   { return m_tables->groups.back(); }
 
    const GroupType& indices(Level i) const
-   { return m_groups[i]; }
+   { return m_tables->groups[i]; }
 
    const GenGroupType& generators() const
-   { return m_genGroup; }
+   { return m_tables->genGroup; }
+
+   /**
+    * Returns the table of the storage addresses of the indices, in the
+    * natural order, of the vectors of virtualSize() elements.
+    *
+    * The table is computed on the first call and shared by the storages of
+    * the same size parameter.
+    */
+   const std::vector<std::uint32_t>& addresses() const
+   {
+      std::call_once(m_tables->addressesFlag, [this] { computeAddresses(m_tables->addresses); m_tables->account(); });
+      return m_tables->addresses;
+   }
+
+   /**
+    * Returns the table of the positions in generators() of the generator
+    * values, indexed by LatticeTraits::ToIndex().  The values that are not
+    * generators are mapped to the size of generators().
+    *
+    * The table is computed on the first call and shared by the storages of
+    * the same size parameter.
+    */
+   const std::vector<std::uint32_t>& generatorRows() const
+   {
+      std::call_once(m_tables->generatorRowsFlag, [this] { computeGeneratorRows(m_tables->generatorRows); m_tables->account(); });
+      return m_tables->generatorRows;
+   }
 
    /**
     * Sequence of ranges of indices corresponding to embedded levels.
@@ -535,8 +577,121 @@ public:
    { return LevelRanges(this->sizeParam()); }
 
 private:
-   std::vector<GroupType> m_groups;
-   GenGroupType m_genGroup;
+   /**
+    * Groups and index tables, shared by the storages of the same size
+    * parameter and immutable once computed.
+    */
+   struct Tables {
+      Tables(const SizeParam& sizeParam):
+         groups(sizeParam.maxLevel() + 1)
+      { PerLevelOrderTraits<PLO, LR, COMPRESS>::initializeGroups(sizeParam.base(), sizeParam.maxLevel(), groups, genGroup); }
+
+      std::vector<GroupType> groups;
+      GenGroupType genGroup;
+      std::once_flag addressesFlag;
+      std::once_flag generatorRowsFlag;
+      std::vector<std::uint32_t> addresses;
+      std::vector<std::uint32_t> generatorRows;
+      Memory::Usage memory{Memory::Component::STORAGE};
+
+      // charges the index tables to the storage component of Memory
+      void account()
+      {
+         std::lock_guard<std::mutex> lock(memoryMutex);
+         memory.set((addresses.capacity() + generatorRows.capacity()) * sizeof(std::uint32_t));
+      }
+
+   private:
+      std::mutex memoryMutex;
+   };
+
+   std::shared_ptr<Tables> m_tables;
+
+   /**
+    * Returns the tables for \c sizeParam, which are computed only if no other
+    * storage with the same size parameter exists.  The tables of the last size
+    * parameter are kept after its storages are destroyed, so that the
+    * consecutive searches of a process (see the --server and --jobs modes of
+    * latnetbuilder) with the same size parameter compute them only once.
+    */
+   static std::shared_ptr<Tables> sharedTables(const SizeParam& sizeParam)
+   {
+      static std::mutex mutex;
+      static std::map<std::pair<uInteger, Level>, std::weak_ptr<Tables>> cache;
+      static std::shared_ptr<Tables> last;
+      const auto key = std::make_pair(baseIndex(sizeParam.base()), sizeParam.maxLevel());
+      std::lock_guard<std::mutex> lock(mutex);
+      auto& entry = cache[key];
+      auto tables = entry.lock();
+      if (!tables) {
+         tables = std::make_shared<Tables>(sizeParam);
+         entry = tables;
+      }
+      last = tables;
+      return tables;
+   }
+
+   // index of the base in the cache of the tables; digital bases have no ToIndex()
+   static uInteger baseIndex(uInteger base)
+   { return base; }
+
+   static uInteger baseIndex(const Polynomial& base)
+   { return LatticeTraits<LatticeType::POLYNOMIAL>::ToIndex(base); }
+
+   static void checkTableSize(size_type n)
+   {
+      if (n - 1 > std::numeric_limits<std::uint32_t>::max())
+         throw std::length_error("Storage: too many points for the index tables");
+   }
+
+   /**
+    * Calls \c f(i, x) for the elements \c x of indices \c i of \c group,
+    * enumerating distinct ranges of indices concurrently on the shared thread
+    * pool; \c f must then only write to distinct locations.
+    */
+   template <class GROUP, class F>
+   static void forEachElement(const GROUP& group, const F& f)
+   {
+      const size_type size = group.size();
+      ThreadPool& pool = ThreadPool::global();
+      const size_type numChunks = std::min<size_type>(std::max<size_type>(size / 1024, 1), 4 * pool.size());
+      pool.parallelFor(numChunks, [&](unsigned int, size_t chunk) {
+            detail::forEachGroupElement(group, chunk * size / numChunks, (chunk + 1) * size / numChunks, f);
+            });
+   }
+
+   void computeAddresses(std::vector<std::uint32_t>& addresses) const
+   {
+      const size_type n = virtualSize();
+      checkTableSize(n);
+      addresses.assign(n, 0);
+      // level k consists of the indices b^(m-k) g for the elements g of the subgroup of level k
+      size_type start = 1;
+      typename StorageTraits<self_type>::value_type mult = this->sizeParam().modulus();
+      for (Level level = 1; level <= this->sizeParam().maxLevel(); level++) {
+         mult /= this->sizeParam().base();
+         const auto& subgroup = indices(level);
+         forEachElement(subgroup, [&](size_type i, const typename GroupType::value_type& g) {
+               addresses[Compress::compressIndex(LatticeTraits<LR>::ToIndex(mult * g), n)] = static_cast<std::uint32_t>(start + i);
+               });
+         start += subgroup.size();
+      }
+      // the symmetric indices share the address of their representative
+      if (Compress::symmetric()) {
+         for (size_type i = n / 2 + 1; i < n; i++)
+            addresses[i] = addresses[Compress::compressIndex(i, n)];
+      }
+   }
+
+   void computeGeneratorRows(std::vector<std::uint32_t>& rows) const
+   {
+      const size_type n = virtualSize();
+      checkTableSize(n);
+      rows.assign(n, static_cast<std::uint32_t>(generators().size()));
+      forEachElement(generators(), [&](size_type i, const typename GenGroupType::value_type& g) {
+            rows[LatticeTraits<LR>::ToIndex(g)] = static_cast<std::uint32_t>(i);
+            });
+   }
 };
 
 }
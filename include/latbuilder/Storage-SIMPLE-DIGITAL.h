@@ -19,10 +19,14 @@
 
 #include "latbuilder/Storage.h"
 #include "latbuilder/CompressTraits.h"
+#include "latbuilder/DigitalPermutation.h"
 #include "latbuilder/SizeParam.h"
 #include "latbuilder/Types.h"
 #include "latbuilder/Util.h"
 
+#include <memory>
+#include <vector>
+
 namespace LatBuilder {
 
 
@@ -64,23 +68,15 @@ struct StorageTraits<Storage<LatticeType::DIGITAL, EmbeddingType::UNILEVEL, COMP
       typedef StorageTraits::size_type size_type;
       typedef StorageTraits::value_type value_type;
 
-      Stride(Storage<LatticeType::DIGITAL, EmbeddingType::UNILEVEL, COMPRESS> storage, value_type stride):
-         m_storage(std::move(storage)),
-         m_stride(stride),
-         m_permutation(m_storage.virtualSize(), 0)
+      Stride(Storage<LatticeType::DIGITAL, EmbeddingType::UNILEVEL, COMPRESS> storage, const value_type& stride):
+         m_storage(std::move(storage))
       {
-        std::vector<unsigned long> cols = m_stride.getColsReverse();
-        for(size_type i=m_graycode.size(); i < m_permutation.size(); i++){
-          m_graycode.push_back(getmsb(((i >> 1) ^ i)^(((i+1) >> 1) ^ (i+1))));
-        }
-        for (size_type i=1; i<m_permutation.size(); ++i){
-          m_permutation[i] = m_permutation[i-1] ^ cols[m_graycode[i-1]];
-        }
+        m_permutation = std::make_shared<const DigitalPermutation>(m_storage.virtualSize(), stride.getColsReverse());
       }
 
       size_type operator() (size_type i) const
       {
-         return Compress::compressIndex(m_permutation[i], m_storage.virtualSize());
+         return Compress::compressIndex((*m_permutation)[i], m_storage.virtualSize());
       }
 
       size_type size() const
@@ -88,31 +84,11 @@ struct StorageTraits<Storage<LatticeType::DIGITAL, EmbeddingType::UNILEVEL, COMP
 
    private:
       Storage<LatticeType::DIGITAL, EmbeddingType::UNILEVEL, COMPRESS> m_storage;
-      value_type m_stride;
-      std::vector<size_type> m_permutation;
-
-      static std::vector<size_type> m_graycode;
-
-      static unsigned int
-      getmsb (unsigned long long x)
-      {
-          unsigned int r = 0;
-          if (x < 1) return 0;
-          while (x >>= 1) r++;
-          return r;
-      }
+      std::shared_ptr<const DigitalPermutation> m_permutation; // shared by the copies made by the vector proxies
    };
 
 };
 
-// template
-
-template <Compress COMPRESS> std::vector<uInteger> StorageTraits<Storage<LatticeType::DIGITAL, EmbeddingType::UNILEVEL, COMPRESS>>::Stride::m_graycode = std::vector<uInteger>();
-// StorageTraits< = std::vector<size_type>()
-
-// template<> std::vector<uInteger> StorageTraits<Storage<LatticeType::DIGITAL, EmbeddingType::UNILEVEL, Compress::NONE>>::Stride::m_graycode = std::vector<uInteger>();
-// template<> std::vector<uInteger> StorageTraits<Storage<LatticeType::DIGITAL, EmbeddingType::UNILEVEL, Compress::SYMMETRIC>>::Stride::m_graycode = std::vector<uInteger>();
-
 }
 
 #endif
@@ -20,6 +20,7 @@
 #include "latbuilder/Storage.h"
 #include "latbuilder/CompressTraits.h"
 #include "latbuilder/SizeParam.h"
+#include "latbuilder/PolynomialWord.h"
 
 namespace LatBuilder {
 
@@ -84,7 +85,7 @@ struct StorageTraits<Storage<LR, EmbeddingType::UNILEVEL, COMPRESS>> {
       {
          const auto modulus = m_storage.sizeParam().modulus();
          const auto numPoints = m_storage.sizeParam().numPoints();
-         return Compress::compressIndex(LatticeTraits<LR>::ToIndex(m_stride * LatticeTraits<LR>::ToGenValue(i) % modulus), numPoints);
+         return Compress::compressIndex(stridedIndex(m_stride, i, modulus), numPoints);
       }
 
       size_type size() const
@@ -93,6 +94,19 @@ struct StorageTraits<Storage<LR, EmbeddingType::UNILEVEL, COMPRESS>> {
    private:
       Storage<LR, EmbeddingType::UNILEVEL, COMPRESS> m_storage;
       value_type m_stride;
+
+      static uInteger stridedIndex(uInteger stride, uInteger i, uInteger modulus)
+      { return stride * i % modulus; }
+
+      static uInteger stridedIndex(const Polynomial& stride, uInteger i, const Polynomial& modulus)
+      {
+         if (PolynomialWordModulus::fits(modulus) and deg(stride) < deg(modulus)) {
+            const PolynomialWordModulus& wordModulus = PolynomialWordModulus::cached(modulus);
+            if (wordModulus.isReduced(i))
+               return wordModulus.multiply(toPolynomialWord(stride), i);
+         }
+         return LatticeTraits<LatticeType::POLYNOMIAL>::ToIndex(stride * LatticeTraits<LatticeType::POLYNOMIAL>::ToGenValue(i) % modulus);
+      }
    };
 
 };
@@ -127,7 +141,7 @@ public:
       if(PLO == PerLevelOrder::CYCLIC) 
         throw std::invalid_argument("Storage(): Trying to instantiate Storage<EmbeddingType::UNILEVEL, PerLevelOrder::Cyclic>");
       if(COMPRESS == Compress::SYMMETRIC && (LR == LatticeType::POLYNOMIAL || LR == LatticeType::DIGITAL))
-        throw std::invalid_argument("Storage(): No symmetric kernel implemented for polynomial");
+        throw std::invalid_argument("Storage(): symmetric compression is only available for ordinary lattices");
    }
 
    size_type virtualSize() const
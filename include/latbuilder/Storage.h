@@ -22,11 +22,21 @@
 
 #include <boost/numeric/ublas/vector_proxy.hpp>
 
+#include <algorithm>
 #include <string>
+#include <type_traits>
 
 namespace LatBuilder {
 
+namespace detail {
+   // true if the stride permutation STRIDE maps runs of consecutive indices
+   // to runs of consecutive indices, enumerated by STRIDE::forEachRun()
+   template <class STRIDE, class = void>
+   struct ContiguousRuns : std::false_type {};
 
+   template <class STRIDE>
+   struct ContiguousRuns<STRIDE, typename std::enable_if<STRIDE::contiguousRuns>::type> : std::true_type {};
+}
 
 /**
  *  default per level value depending on the lattice (ordinary/polynomial) and the lattice type (ordinary/embedded).
@@ -211,9 +221,102 @@ public:
             );
    }
 
+   /**
+    * Stores in \c out the elements of \c vec with a periodic jump of \c
+    * stride across the elements, in the same order as strided().
+    *
+    * The permuted index of each element is computed only once, so that \c out
+    * can then be read as a plain contiguous vector.  This is preferable to
+    * strided() whenever the permuted elements are read more than once.
+    *
+    * \param vec       Vector to permute.
+    * \param stride    Stride parameter.
+    * \param out       Output vector, resized to the size of the storage.
+    */
+   template <class V, class OUT>
+   void gather(
+         const boost::numeric::ublas::vector_container<V>& vec,
+         value_type stride,
+         OUT& out
+         ) const
+   {
+      const Stride map(derived(), stride);
+      const size_type n = map.size();
+      const V& in = vec();
+      out.resize(n);
+      if (detail::ContiguousRuns<Stride>::value) {
+         forEachRun(map, 0, n, [&] (size_type i, size_type j, size_type len) {
+               for (size_type k = 0; k < len; k++)
+                  out[i + k] = in[j + k];
+               });
+         return;
+      }
+      for (size_type i = 0; i < n; i++)
+         out[i] = in[map(i)];
+   }
+
+   /**
+    * Stores in <code>out[0], ..., out[last - first - 1]</code> the elements
+    * \c first to <code>last - 1</code> of strided(vec, stride).
+    *
+    * The permuted indices are computed by groups, then the elements are read
+    * with software prefetching a few indices ahead, so that the loads from a
+    * vector too large for the cache overlap instead of stalling one after the
+    * other.  If the stride permutation maps runs of consecutive indices to
+    * runs of consecutive indices, as for the inverse-cyclic per-level order,
+    * the runs are copied instead.
+    */
+   template <class V>
+   void gather(
+         const boost::numeric::ublas::vector_container<V>& vec,
+         value_type stride,
+         size_type first,
+         size_type last,
+         typename V::value_type* out
+         ) const
+   {
+      const size_type groupSize = 64;
+      const size_type distance = 8;
+      const Stride map(derived(), stride);
+      const V& in = vec();
+      if (detail::ContiguousRuns<Stride>::value) {
+         forEachRun(map, first, last, [&] (size_type i, size_type j, size_type len) {
+               typename V::value_type* const dest = out + (i - first);
+               for (size_type k = 0; k < len; k++)
+                  dest[k] = in[j + k];
+               });
+         return;
+      }
+      size_type index[groupSize];
+      for (size_type begin = first; begin < last; begin += groupSize) {
+         const size_type count = std::min(groupSize, last - begin);
+         for (size_type j = 0; j < count; j++)
+            index[j] = map(begin + j);
+         for (size_type j = 0; j < count; j++) {
+#if defined(__GNUC__)
+            if (j + distance < count)
+               __builtin_prefetch(&in[index[j + distance]]);
+#endif
+            out[begin - first + j] = in[index[j]];
+         }
+      }
+   }
+
 private:
    SizeParam m_sizeParam;
 
+   template <class F>
+   static void forEachRun(const Stride& map, size_type first, size_type last, const F& f)
+   { forEachRun(map, first, last, f, detail::ContiguousRuns<Stride>()); }
+
+   template <class F>
+   static void forEachRun(const Stride& map, size_type first, size_type last, const F& f, std::true_type)
+   { map.forEachRun(first, last, f); }
+
+   template <class F>
+   static void forEachRun(const Stride&, size_type, size_type, const F&, std::false_type)
+   {}
+
    DERIVED& derived()
    { return static_cast<DERIVED&>(*this); }
 
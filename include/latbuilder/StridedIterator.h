@@ -0,0 +1,121 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__STRIDED_ITERATOR_H
+#define LATBUILDER__STRIDED_ITERATOR_H
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace LatBuilder {
+
+/**
+ * Forward iterator visiting one element out of \c stride of a sequence,
+ * starting from the element of index \c offset.
+ *
+ * The elements which are skipped are never dereferenced, so that the values
+ * of lazy sequences such as the sequences of merit values are not computed
+ * for them.
+ *
+ * \tparam IT  Forward iterator on the sequence.
+ */
+template <class IT>
+class StridedIterator :
+   public boost::iterators::iterator_facade<
+      StridedIterator<IT>,
+      typename std::remove_cv<typename std::remove_reference<decltype(*std::declval<const IT&>())>::type>::type,
+      boost::iterators::forward_traversal_tag,
+      decltype(*std::declval<const IT&>())>
+{
+public:
+   typedef decltype(*std::declval<const IT&>()) Reference;
+
+   /**
+    * Constructor for the first element.
+    *
+    * \param first   Iterator pointing to the first element of the sequence.
+    * \param last    Iterator pointing past the last element of the sequence.
+    * \param offset  Index of the first visited element.
+    * \param stride  Distance between visited elements.
+    */
+   StridedIterator(IT first, IT last, size_t offset, size_t stride):
+      m_it(std::move(first)),
+      m_last(std::move(last)),
+      m_index(0),
+      m_stride(stride)
+   { advance(offset); }
+
+   /**
+    * Constructor for the past-the-end iterator.
+    */
+   explicit StridedIterator(IT last):
+      m_it(last),
+      m_last(std::move(last)),
+      m_index(std::numeric_limits<size_t>::max()),
+      m_stride(0)
+   {}
+
+   /**
+    * Returns the index of the current element in the sequence.
+    */
+   size_t index() const
+   { return m_index; }
+
+   /**
+    * Returns the iterator on the current element of the sequence.
+    */
+   const IT& underlying() const
+   { return m_it; }
+
+   /**
+    * Returns the base iterator of the current element of the sequence.
+    */
+   auto base() const -> decltype(std::declval<const IT&>().base())
+   { return m_it.base(); }
+
+private:
+   friend class boost::iterators::iterator_core_access;
+
+   IT m_it;
+   IT m_last;
+   size_t m_index;
+   size_t m_stride;
+
+   void advance(size_t n)
+   {
+      for (size_t k = 0; k < n && m_it != m_last; k++) {
+         ++m_it;
+         ++m_index;
+      }
+   }
+
+   void increment()
+   { advance(m_stride); }
+
+   bool equal(const StridedIterator& other) const
+   { return m_it == other.m_it; }
+
+   Reference dereference() const
+   { return *m_it; }
+};
+
+}
+
+#endif
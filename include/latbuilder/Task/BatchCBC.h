@@ -0,0 +1,184 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__TASK__BATCH_CBC_H
+#define LATBUILDER__TASK__BATCH_CBC_H
+
+#include "latbuilder/Task/Task.h"
+
+#include "latbuilder/MeritSeq/CoordUniformBatchCBC.h"
+#include "latbuilder/GenSeq/GeneratingValues.h"
+#include "latbuilder/GenSeq/VectorCreator.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Util.h"
+
+#include <boost/signals2.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace LatBuilder { namespace Task {
+
+/**
+ * Batch of CBC explorations of unilevel lattices, one for each of several
+ * weighted coordinate-uniform figures of merit with the same kernel.
+ *
+ * The explorations visit the same generator values for each coordinate and
+ * are advanced in lockstep by MeritSeq::CoordUniformBatchCBC, which gathers
+ * the permuted kernel values of each candidate once for all of them.  Each
+ * exploration selects the same lattice as a CBC task with its figure of
+ * merit, without filters.  The lattices selected are emitted together, with
+ * a single ResultsSelected signal, once all the coordinates are explored.
+ *
+ * \tparam LR           Type of lattice.
+ * \tparam COMPRESS     Type of compression.
+ * \tparam PLO          Type of per-level order.
+ * \tparam KERNEL       Kernel of the coordinate-uniform figures of merit.
+ */
+template <LatticeType LR, Compress COMPRESS, PerLevelOrder PLO, class KERNEL>
+class BatchCBC : public Task {
+public:
+   typedef MeritSeq::CoordUniformBatchCBC<LR, COMPRESS, PLO, KERNEL> CBC;
+   typedef typename CBC::Storage Storage;
+   typedef typename CBC::FigureOfMerit FigureOfMerit;
+   typedef typename CBC::LatDef LatDef;
+   typedef typename Storage::SizeParam SizeParam;
+   typedef GenSeq::GeneratingValues<LR, COMPRESS> GenSeqType;
+   typedef boost::signals2::signal<void (const BatchCBC&)> OnResultsSelected;
+
+   /**
+    * Constructor.
+    *
+    * \param storage       Storage configuration.
+    * \param dimension     Dimension of the lattices.
+    * \param figures       Coordinate-uniform figures of merit, one for each
+    *                      exploration, with the same kernel.
+    */
+   BatchCBC(
+         Storage storage,
+         Dimension dimension,
+         std::vector<FigureOfMerit> figures
+         ):
+      m_dimension(dimension),
+      m_figures(std::move(figures)),
+      m_cbc(new CBC(std::move(storage), figurePointers())),
+      m_onResultsSelected(new OnResultsSelected)
+   {}
+
+   BatchCBC(BatchCBC&&) = default;
+
+   virtual ~BatchCBC() {}
+
+   /**
+    * Returns the number of explorations.
+    */
+   size_t size() const
+   { return m_figures.size(); }
+
+   /**
+    * Returns the dimension of the lattices.
+    */
+   Dimension dimension() const
+   { return m_dimension; }
+
+   /**
+    * Returns the figure of merit of the exploration \c i.
+    */
+   const FigureOfMerit& figureOfMerit(size_t i) const
+   { return m_figures[i]; }
+
+   /**
+    * Returns the lattice selected by the exploration \c i.
+    */
+   const LatDef& bestLattice(size_t i) const
+   { return m_cbc->baseLat(i); }
+
+   /**
+    * Returns the merit value of the lattice selected by the exploration \c i.
+    */
+   Real bestMeritValue(size_t i) const
+   { return m_cbc->baseMerit(i); }
+
+   /**
+    * Results-selected signal, emitted once by execute() when the lattices of
+    * all the explorations are selected.
+    */
+   OnResultsSelected& onResultsSelected()
+   { return *m_onResultsSelected; }
+
+   virtual void execute()
+   {
+      m_cbc->reset();
+      auto genSeqs = GenSeq::VectorCreator<GenSeqType>::create(m_cbc->storage().sizeParam(), dimension());
+      genSeqs[0] = GenSeq::Creator<GenSeqType>::create(SizeParam(LatticeTraits<LR>::TrivialModulus));
+      {
+         Profiler::Scope scope(Profiler::Timer::EVALUATION);
+         for (const auto& genSeq : genSeqs)
+            m_cbc->select(genSeq);
+      }
+      onResultsSelected()(*this);
+   }
+
+   /**
+    * Outputs the lattice selected by each exploration and its merit value.
+    */
+   void formatResults(std::ostream& os) const
+   {
+      for (size_t i = 0; i < size(); i++) {
+         os << "Figure of merit " << i + 1 << ": " << figureOfMerit(i) << std::endl;
+         os << "Lattice: " << bestLattice(i);
+         os << "Merit: " << bestMeritValue(i) << std::endl;
+      }
+   }
+
+protected:
+   virtual void format(std::ostream& os) const
+   {
+      os << "Task: LatBuilder Search for " << to_string(LR) << " lattices" << std::endl;
+      os << "Exploration method: CBC - Full Explorer, batch of " << size() << " figures of merit" << std::endl;
+      os << "Dimension: " << dimension() << std::endl;
+      os << "Modulus: " << m_cbc->storage().sizeParam() << std::endl;
+      for (size_t i = 0; i < size(); i++)
+         os << "Figure of merit " << i + 1 << ": " << figureOfMerit(i) << std::endl;
+   }
+
+private:
+   Dimension m_dimension;
+   std::vector<FigureOfMerit> m_figures;
+   std::unique_ptr<CBC> m_cbc;
+   std::unique_ptr<OnResultsSelected> m_onResultsSelected;
+
+   std::vector<const FigureOfMerit*> figurePointers() const
+   {
+      std::vector<const FigureOfMerit*> pointers;
+      for (const auto& figure : m_figures)
+         pointers.push_back(&figure);
+      return pointers;
+   }
+};
+
+/// Batch of CBC explorations.
+template <LatticeType LR, Compress COMPRESS, PerLevelOrder PLO, class KERNEL>
+BatchCBC<LR, COMPRESS, PLO, KERNEL> batchCBC(
+      Storage<LR, EmbeddingType::UNILEVEL, COMPRESS, PLO> storage,
+      Dimension dimension,
+      std::vector<CoordUniformFigureOfMerit<KERNEL>> figures
+      )
+{ return BatchCBC<LR, COMPRESS, PLO, KERNEL>(std::move(storage), dimension, std::move(figures)); }
+
+}}
+
+#endif
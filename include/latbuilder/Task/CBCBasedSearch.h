@@ -22,6 +22,16 @@
 #include "latbuilder/Types.h"
 #include "latbuilder/Storage.h"
 #include "latbuilder/MeritFilterList.h"
+#include "latbuilder/Budget.h"
+#include "latbuilder/Checkpoint.h"
+#include "latbuilder/Distributed.h"
+#include "latbuilder/Execution.h"
+#include "latbuilder/StridedIterator.h"
+#include "latbuilder/Util.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <type_traits>
 
 namespace LatBuilder { namespace Task {
 
@@ -35,9 +45,46 @@ namespace LatBuilder { namespace Task {
 template <class>
 struct CBCBasedSearchTraits;
 
+namespace detail {
+   inline std::string formatCheckpointValue(uInteger gen)
+   { return std::to_string(gen); }
+
+   inline std::string formatCheckpointValue(const Polynomial& gen)
+   { return std::to_string(IndexOfPolynomial(gen)); }
+
+   inline void parseCheckpointValue(const std::string& str, uInteger& gen)
+   { gen = boost::lexical_cast<uInteger>(str); }
+
+   inline void parseCheckpointValue(const std::string& str, Polynomial& gen)
+   { gen = PolynomialFromInt(boost::lexical_cast<uInteger>(str)); }
+
+   /**
+    * Tells whether the processes of an MPI job share the candidate lattices of
+    * each coordinate of the search tagged \c TAG.
+    *
+    * Specialized to \c std::false_type for the searches whose merit sequences
+    * compute the merit values of all candidates at once, for which visiting a
+    * slice of the candidates saves nothing.
+    */
+   template <class TAG>
+   struct Distributes : std::true_type {};
+}
+
 /**
  * Component-by-component search task.
  *
+ * If a checkpoint file is set, the selected generating vector is written to it
+ * after each coordinate.  A search resumed from a checkpoint selects the
+ * recorded generating values for the first coordinates, computing only their
+ * merit values, then explores the remaining coordinates as usual.  The
+ * sequences of generating values are the same as for an uninterrupted search,
+ * so that both return the same lattice.
+ *
+ * In an MPI job, the candidate lattices of each coordinate are shared by the
+ * processes as described in Distributed, unless detail::Distributes is false
+ * for \c TAG, in which case every process runs the whole search.  Only the
+ * root process writes the checkpoints.
+ *
  * \tparam TAG Tag class.
  */
 template <class TAG>
@@ -47,6 +94,7 @@ public:
    typedef typename Traits::Storage Storage;
    typedef typename Traits::CBC CBC;
    typedef typename CBC::FigureOfMerit FigureOfMerit;
+   typedef typename CBC::LatDef::GeneratingVector GeneratingVector;
 
    CBCBasedSearch(
          Storage storage,
@@ -66,7 +114,9 @@ public:
       m_storage(std::move(other.m_storage)),
       m_figure(other.m_figure.release()),
       m_cbc(other.m_cbc.release()),
-      m_traits(std::move(other.m_traits))
+      m_traits(std::move(other.m_traits)),
+      m_checkpointFile(std::move(other.m_checkpointFile)),
+      m_resumeGen(std::move(other.m_resumeGen))
    {}
 
    virtual ~CBCBasedSearch() {}
@@ -75,6 +125,7 @@ public:
    {
       CBCBasedSearchTraits<TAG>::Search::reset();
       m_cbc->reset();
+      m_resumeGen.clear();
    }
 
    virtual void execute()
@@ -82,14 +133,47 @@ public:
       auto genSeqs = m_traits.genSeqs(storage().sizeParam(), this->dimension());
       this->setObserverTotalDim(this->dimension());
 
+      if (m_resumeGen.size() > genSeqs.size())
+         throw std::runtime_error("the checkpoint has more coordinates than the search");
+
       // iterate through dimension
-      for (const auto& genSeq : genSeqs) {
-         auto seq = cbc().meritSeq(genSeq);
+      for (Dimension coord = 0; coord < genSeqs.size(); coord++) {
+         auto seq = cbc().meritSeq(genSeqs[coord]);
+         if (coord < m_resumeGen.size()) {
+            this->minObserver().start(1); // no threshold from the previous coordinate
+            selectGenValue(seq, m_resumeGen[coord], coord);
+            continue;
+         }
+         // the remaining budget is divided between the remaining coordinates
+         this->minObserver().setBudgetShare(Budget::share(genSeqs.size() - coord));
          auto fseq = this->filters().apply(seq);
-         const auto itmin = this->minElement()(fseq.begin(), fseq.end(), this->minObserver().maxAcceptedCount(), this->verbose());
-         cbc().select(itmin.base());
-         this->selectBestLattice(cbc().baseLat(), *itmin, false);
+         {
+            Profiler::Scope scope(Profiler::Timer::EVALUATION);
+            if (detail::Distributes<TAG>::value && Distributed::size() > 1) {
+               selectDistributed(seq, fseq, coord);
+            }
+            else {
+               const auto itmin = this->minElement()(fseq.begin(), fseq.end(), this->minObserver().maxAcceptedCount(), this->verbose());
+               cbc().select(itmin.base());
+               this->selectBestLattice(cbc().baseLat(), *itmin, false);
+            }
+         }
+         writeCheckpoint();
       }
+      m_resumeGen.clear();
+   }
+
+   virtual void setCheckpointFile(std::string fileName)
+   { m_checkpointFile = std::move(fileName); }
+
+   virtual void resumeFrom(const std::string& fileName)
+   {
+      const auto checkpoint = Checkpoint::read(fileName);
+      if (checkpoint.dimension() > this->dimension())
+         throw std::runtime_error("the checkpoint " + fileName + " has more coordinates than the search");
+      m_resumeGen.resize(checkpoint.dimension());
+      for (Dimension coord = 0; coord < checkpoint.dimension(); coord++)
+         detail::parseCheckpointValue(checkpoint.genValues[coord], m_resumeGen[coord]);
    }
 
    /**
@@ -124,6 +208,67 @@ private:
    std::unique_ptr<FigureOfMerit> m_figure;
    std::unique_ptr<CBC> m_cbc;
    Traits m_traits;
+   std::string m_checkpointFile;
+   GeneratingVector m_resumeGen; // generating values of the coordinates recorded in the checkpoint
+
+   /**
+    * Selects the generating value \c gen for coordinate \c coord, which must
+    * belong to the sequence of merit values \c seq.  Only the merit value of
+    * the selected lattice is computed.
+    */
+   template <class SEQ, typename GENVALUE>
+   void selectGenValue(const SEQ& seq, const GENVALUE& gen, Dimension coord)
+   {
+      auto it = seq.begin();
+      while (it != seq.end() && (*it.base()).gen().back() != gen)
+         ++it;
+      if (it == seq.end())
+         throw std::runtime_error("the generating value " + detail::formatCheckpointValue(gen) + " of coordinate " + std::to_string(coord + 1) + " cannot be selected by the search");
+      cbc().select(it);
+      this->selectBestLattice(cbc().baseLat(), this->filters().apply(*it, *it.base()), false);
+   }
+
+   /**
+    * Finds the best lattice of the filtered sequence \c fseq with the other
+    * processes of the MPI job, each process visiting its own slice of the
+    * sequence, then selects it in the unfiltered sequence \c seq.
+    */
+   template <class SEQ, class FSEQ>
+   void selectDistributed(const SEQ& seq, const FSEQ& fseq, Dimension coord)
+   {
+      typedef StridedIterator<typename FSEQ::const_iterator> Iterator;
+      const Iterator first(fseq.begin(), fseq.end(), Distributed::rank(), Distributed::size());
+      const Iterator last(fseq.end());
+      const auto itmin = this->minElement()(first, last, this->minObserver().maxAcceptedCount(), this->verbose());
+
+      Distributed::Candidate local;
+      if (itmin != last) {
+         local.merit = *itmin;
+         local.index = itmin.index();
+      }
+      const auto best = Distributed::minimum(local);
+      if (best.index == Distributed::Candidate::none)
+         throw std::runtime_error("no lattice was found for coordinate " + std::to_string(coord + 1));
+
+      std::string genString;
+      if (Distributed::owns(best.index))
+         genString = detail::formatCheckpointValue((*itmin.base().base()).gen().back());
+      typename GeneratingVector::value_type gen;
+      detail::parseCheckpointValue(Distributed::broadcast(genString, Distributed::owner(best.index)), gen);
+      selectGenValue(seq, gen, coord);
+   }
+
+   void writeCheckpoint() const
+   {
+      Execution::check(); // the coordinate may not be fully explored
+      if (m_checkpointFile.empty() || !Distributed::isRoot())
+         return;
+      Checkpoint checkpoint;
+      checkpoint.merit = this->bestMeritValue();
+      for (const auto& gen : this->bestLattice().gen())
+         checkpoint.genValues.push_back(detail::formatCheckpointValue(gen));
+      checkpoint.write(m_checkpointFile);
+   }
 };
 
 }}
@@ -0,0 +1,260 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LATBUILDER__TASK__DEPTH_FIRST_H
+#define LATBUILDER__TASK__DEPTH_FIRST_H
+
+#include "latbuilder/Task/Search.h"
+#include "latbuilder/Task/macros.h"
+
+#include "latbuilder/MeritSeq/CBC.h"
+#include "latbuilder/GenSeq/GeneratingValues.h"
+#include "latbuilder/GenSeq/Creator.h"
+#include "latbuilder/GenSeq/VectorCreator.h"
+#include "latbuilder/SizeParam.h"
+#include "latbuilder/LatDef.h"
+#include "latbuilder/Budget.h"
+#include "latbuilder/ProgressFeed.h"
+#include "latbuilder/Util.h"
+
+#include <limits>
+#include <vector>
+
+namespace LatBuilder { namespace Task {
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
+class DepthFirst;
+
+
+/// Depth-first exhaustive search.
+template <class FIGURE, LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+DepthFirst<LR, ET, COMPRESS, PLO, FIGURE> depthFirst(
+      Storage<LR, ET, COMPRESS, PLO> storage,
+      Dimension dimension,
+      FIGURE figure
+      )
+{ return DepthFirst<LR, ET, COMPRESS, PLO, FIGURE>(std::move(storage), dimension, std::move(figure)); }
+
+
+/**
+ * Exhaustive search explored depth first, by branch and bound.
+ *
+ * The generating vectors of the exhaustive search are explored as a tree
+ * whose nodes of depth \f$d\f$ are the lattices of the first \f$d\f$
+ * components, in the order of the Cartesian product of the exhaustive search.
+ * The CBC algorithm selects the component of each node in the state of its
+ * parent, which is saved before the children are explored and restored after
+ * each of them (see MeritSeq::CBC::state()), so that each node costs a single
+ * update of the state instead of one for each of its components.
+ *
+ * The merit value of a lattice cannot be smaller than the partial merit value
+ * of its first components, so that, if no filter is applied to the merit
+ * values, the lattices of a node whose partial merit value is not below the
+ * best one found so far are skipped.  The lattice selected is thus the same as
+ * with the exhaustive search.  With filters, which may normalize the merit
+ * values by the dimension, and for embedded lattices, every lattice is
+ * evaluated.
+ *
+ * The nodes are explored serially, since each of them is pruned according to
+ * the lattices found before it.
+ *
+ * \tparam ET, COMPRESS Type of storage.
+ * \tparam FIGURE Type of figure of merit.
+ */
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
+class DepthFirst : public Search<LR, ET> {
+public:
+   typedef LatBuilder::Storage<LR, ET, COMPRESS, PLO> Storage;
+   typedef typename CBCSelector<LR, ET, COMPRESS, PLO, FIGURE>::CBC CBC;
+   typedef typename CBC::FigureOfMerit FigureOfMerit;
+   typedef typename Storage::SizeParam SizeParam;
+
+   DepthFirst(
+         Storage storage,
+         Dimension dimension,
+         FigureOfMerit figure
+         ):
+      Search<LR, ET>(dimension),
+      m_storage(std::move(storage)),
+      m_figure(new FigureOfMerit(std::move(figure))),
+      m_cbc(new CBC(this->storage(), this->figureOfMerit()))
+   {}
+
+   DepthFirst(DepthFirst&& other):
+      Search<LR, ET>(std::move(other)),
+      m_storage(std::move(other.m_storage)),
+      m_figure(other.m_figure.release()),
+      m_cbc(other.m_cbc.release())
+   {}
+
+   virtual ~DepthFirst() {}
+
+   virtual void execute()
+   {
+      this->setObserverTotalDim(1);
+      this->minObserver().setBudgetShare(Budget::share());
+      // the partial merit values are compared with the best one only without filters
+      m_prune = this->filters().empty();
+      connectCBCProgress(cbc(), this->minObserver(), m_prune);
+
+      const auto& sizeParam = storage().sizeParam();
+      m_genSeqs = GenSeq::VectorCreator<GenSeqType>::create(sizeParam, this->dimension());
+      if (not m_genSeqs.empty())
+         m_genSeqs[0] = GenSeq::Creator<GenSeqType>::create(SizeParam(LatticeTraits<LR>::TrivialModulus));
+
+      // number of lattices of the subtrees of each depth
+      m_subtreeSizes.assign(m_genSeqs.size() + 1, 1);
+      for (size_t coord = m_genSeqs.size(); coord > 0; coord--)
+         m_subtreeSizes[coord - 1] = m_subtreeSizes[coord] * m_genSeqs[coord - 1].size();
+
+      m_found = false;
+      m_minMerit = std::numeric_limits<Real>::infinity();
+      m_explored = 0;
+      m_cbc->reset();
+      this->minObserver().start(m_subtreeSizes[0]);
+      {
+         Profiler::Scope scope(Profiler::Timer::EVALUATION);
+         if (not m_genSeqs.empty())
+            explore(0);
+      }
+      this->minObserver().stop();
+      m_genSeqs.clear();
+
+      if (not m_found)
+         throw std::runtime_error("DepthFirst: empty sequence of lattices");
+      this->selectBestLattice(m_minLat, m_minMerit, true);
+   }
+
+   /**
+    * Returns a pointer to the storage configuration instance.
+    */
+   const Storage& storage() const
+   { return m_storage; }
+
+   /**
+    * Returns the figure of merit.
+    */
+   const FigureOfMerit& figureOfMerit() const
+   { return *m_figure; }
+
+   /**
+    * Returns the internal CBC instance.
+    */
+   const CBC& cbc() const
+   { return *m_cbc; }
+
+protected:
+   virtual void format(std::ostream& os) const
+   {
+      os << "Task: LatBuilder Search for " << to_string(LR) << " lattices" << std::endl;
+      os << "Exploration method: Exhaustive (depth first, branch and bound)" << std::endl;
+      Search<LR, ET>::format(os);
+      os << "Modulus: " << storage().sizeParam() << std::endl;
+      os << "Figure of merit: " << figureOfMerit() << std::endl;
+   }
+
+private:
+   typedef GenSeq::GeneratingValues<LR, COMPRESS> GenSeqType;
+
+   Storage m_storage;
+   std::unique_ptr<FigureOfMerit> m_figure;
+   std::unique_ptr<CBC> m_cbc;
+
+   // state of the exploration
+   std::vector<GenSeqType> m_genSeqs;
+   std::vector<uInteger> m_subtreeSizes;
+   bool m_prune = false;
+   bool m_found = false;
+   LatDef<LR, ET> m_minLat;
+   Real m_minMerit = 0;
+   uInteger m_explored = 0;
+
+   /**
+    * Explores the children of the base lattice of the CBC algorithm, whose
+    * dimension is \c coord.  Returns \c false if the search must stop.
+    */
+   bool explore(Dimension coord)
+   {
+      const bool leaf = coord + 1 == m_genSeqs.size();
+      setTruncateSum(leaf or m_found);
+      auto seq = m_cbc->meritSeq(m_genSeqs[coord]);
+
+      if (leaf) {
+         for (auto it = seq.begin(); it != seq.end(); ++it) {
+            const Real value = this->filters().apply(*it, *it.base());
+            m_explored++;
+            if (not m_found or value < m_minMerit) {
+               m_found = true;
+               m_minLat = it.base()->latDef();
+               m_minMerit = value;
+               this->minObserver().minUpdated(value);
+            }
+            const bool more = this->minObserver().visited(value);
+            ProgressFeed::setCandidate(m_explored);
+            if (not more)
+               return false;
+         }
+         return true;
+      }
+
+      // the merit values of the sequence are computed in the state of the
+      // base lattice, which is restored after each child
+      const auto state = m_cbc->state();
+      for (auto it = seq.begin(); it != seq.end(); ++it) {
+         if (dominated(*it)) {
+            m_explored += m_subtreeSizes[coord + 1];
+            ProgressFeed::setCandidate(m_explored);
+            continue;
+         }
+         m_cbc->select(it);
+         const bool more = explore(coord + 1);
+         m_cbc->restore(state);
+         if (not more)
+            return false;
+         setTruncateSum(m_found);
+      }
+      return true;
+   }
+
+   /**
+    * Lets the evaluator truncate the sum over projections at the current
+    * minimum if \c value is \c true and if no filters are applied.
+    *
+    * The partial merit values of the selected components must be complete, so
+    * the sum is truncated for them only once a lattice was found, the minimum
+    * being then at most the best merit value.
+    */
+   void setTruncateSum(bool value)
+   { setCBCSharedMinimum(cbc(), m_prune and value ? &this->minObserver().sharedMinimum() : nullptr); }
+
+   /**
+    * Returns \c true if no lattice whose first components have the partial
+    * merit value \c merit can be better than the best lattice found so far.
+    */
+   bool dominated(Real merit) const
+   { return m_prune and m_found and not (merit < m_minMerit); }
+
+   template <typename MERIT>
+   bool dominated(const MERIT&) const
+   { return false; }
+};
+
+TASK_FOR_ALL(TASK_EXTERN_TEMPLATE1, DepthFirst, NOTAG);
+
+}}
+
+#endif
@@ -0,0 +1,139 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LATBUILDER__TASK__EVAL_LEVELS_H
+#define LATBUILDER__TASK__EVAL_LEVELS_H
+
+#include "latbuilder/Task/Search.h"
+#include "latbuilder/CoordUniformFigureOfMerit.h"
+#include "latbuilder/Kernel/FunctorAdaptor.h"
+#include "latbuilder/LatDef.h"
+#include "latbuilder/ExactSum.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace LatBuilder { namespace Task {
+
+/**
+ * Evaluation of an extensible ordinary lattice at every level of embedding, in
+ * a single pass over its points.
+ *
+ * The points of the lattice embedded at level \f$k\f$ in base \f$b\f$ are the
+ * points \f$i \boldsymbol a / b^M \bmod 1\f$ of the lattice at the maximum
+ * level \f$M\f$ such that \f$b^{M-k}\f$ divides \f$i\f$.  The points are
+ * visited by chunks of consecutive indices, concurrently, and the
+ * contribution of each point to the coordinate-uniform figure of merit is
+ * added to the sum of its lowest level, so that the merit value at level
+ * \f$k\f$ is obtained from the merit value at level \f$k-1\f$ by adding the
+ * sum of the points of level \f$k\f$.  The memory used does not depend on the
+ * number of points: no storage of size \f$b^M\f$ is allocated, contrary to
+ * Eval with a multilevel storage.
+ *
+ * The kernel is evaluated directly at the points, so the figure of merit must
+ * have a kernel adapted from a functor (see Kernel::FunctorAdaptor::pointValues()), and
+ * product, order-dependent or product and order-dependent weights, or a
+ * combination of them.
+ */
+class EvalLevels : public Search<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL> {
+public:
+   typedef LatBuilder::SizeParam<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL> SizeParam;
+   typedef LatticeTraits<LatticeType::ORDINARY>::GeneratingVector GeneratingVector;
+
+   /**
+    * Function storing in <code>values[0], ..., values[n - 1]</code> the
+    * values of the kernel at the points <code>x[0], ..., x[n - 1]</code>.
+    */
+   typedef std::function<void(const Real* x, Real* values, size_t n)> PointValues;
+
+   /**
+    * Constructor.
+    *
+    * \param sizeParam     Size parameter of the lattice at the maximum level.
+    * \param dimension     Dimension of the lattice.
+    * \param figure        Coordinate-uniform figure of merit.
+    * \param genVec        Generating vector.
+    *
+    * \throws std::invalid_argument if the weights are not supported.
+    */
+   template <class KERNEL>
+   EvalLevels(
+         SizeParam sizeParam,
+         Dimension dimension,
+         CoordUniformFigureOfMerit<KERNEL> figure,
+         GeneratingVector genVec
+         ):
+      Search<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>(dimension),
+      m_sizeParam(std::move(sizeParam)),
+      m_genVec(std::move(genVec))
+   {
+      const auto* concrete = new CoordUniformFigureOfMerit<KERNEL>(std::move(figure));
+      m_figure.reset(concrete);
+      const auto kernel = concrete->kernel();
+      const uInteger modulus = m_sizeParam.modulus();
+      m_pointValues = [kernel, modulus] (const Real* x, Real* values, size_t n) { kernel.pointValues(x, values, n, modulus); };
+      init(concrete->weights());
+   }
+
+   EvalLevels(EvalLevels&&) = default;
+
+   virtual ~EvalLevels() {}
+
+   virtual const FigureOfMerit& figureOfMerit() const
+   { return *m_figure; }
+
+   /**
+    * Returns the merit values at the levels \f$0, \dots, M\f$ computed by the
+    * last call to execute(), before the filters are applied.
+    */
+   const RealVector& levelMerits() const
+   { return m_levelMerits; }
+
+   virtual void execute();
+
+   virtual void reset();
+
+protected:
+   virtual void format(std::ostream& os) const;
+
+private:
+   /**
+    * Product and order-dependent weights \f$\gamma_{\mathfrak u} = \Gamma_{|\mathfrak u|} \prod_{j \in \mathfrak u} \gamma_j\f$.
+    */
+   struct Term {
+      std::vector<Real> coordWeights;  // \gamma_j, by coordinate
+      std::vector<Real> orderWeights;  // \Gamma_\ell, by order minus one
+      bool product;                    // \Gamma_\ell = 1 for all orders
+   };
+
+   SizeParam m_sizeParam;
+   GeneratingVector m_genVec;
+   std::unique_ptr<FigureOfMerit> m_figure;
+   PointValues m_pointValues;
+   std::vector<Term> m_terms;
+   RealVector m_levelMerits;
+
+   void init(const LatticeTester::Weights& weights);
+
+   // adds the contributions of the points first to last - 1 to sums, by lowest level
+   void accumulate(uInteger first, uInteger last, ExactSum* sums) const;
+};
+
+}}
+
+#endif
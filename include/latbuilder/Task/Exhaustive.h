@@ -55,6 +55,7 @@ struct LatSeqBasedSearchTraits<ExhaustiveTag<LR, ET, COMPRESS, PLO, FIGURE>> {
    typedef typename CBCSelector<LR, ET, COMPRESS, PLO, FIGURE>::CBC CBC;
    typedef GenSeq::GeneratingValues<LR, COMPRESS> GenSeqType;
    typedef LatSeq::Combiner<LR, ET, GenSeqType, CartesianProduct> LatSeqType;
+   typedef std::true_type Chunked;
 
    virtual ~LatSeqBasedSearchTraits() {}
 
@@ -65,6 +66,22 @@ struct LatSeqBasedSearchTraits<ExhaustiveTag<LR, ET, COMPRESS, PLO, FIGURE>> {
       return LatSeqType(sizeParam, std::move(vec));
    }
 
+   size_t numChunkIndices(const SizeParam& sizeParam, Dimension dimension) const
+   { return dimension > 1 ? GenSeq::Creator<GenSeqType>::create(sizeParam).size() : 1; }
+
+   /**
+    * The second coordinate is the slowest-varying non-trivial one in the
+    * Cartesian product; its values are restricted to \c chunk.
+    */
+   LatSeqType latSeq(const SizeParam& sizeParam, Dimension dimension, Traversal::Forward chunk) const
+   {
+      auto vec = GenSeq::VectorCreator<GenSeqType>::create(sizeParam, dimension);
+      vec[0] = GenSeq::Creator<GenSeqType>::create(SizeParam(LatticeTraits<LR>::TrivialModulus));
+      if (dimension > 1)
+         vec[1] = vec[1].rebind(std::move(chunk));
+      return LatSeqType(sizeParam, std::move(vec));
+   }
+
    std::string name() const
    { return "Task: LatBuilder Search for " + to_string(LR)  + " lattices\nExploration method: Exhaustive";}
 
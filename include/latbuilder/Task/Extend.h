@@ -27,8 +27,17 @@
 #include "latbuilder/GenSeq/VectorCreator.h"
 #include "latbuilder/SizeParam.h"
 #include "latbuilder/LatDef.h"
+#include "latbuilder/Budget.h"
+#include "latbuilder/SharedMinimum.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Traversal.h"
 #include "latbuilder/Util.h"
 
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <vector>
+
 namespace LatBuilder { namespace Task {
 
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
@@ -48,6 +57,13 @@ Extend<LR, ET, COMPRESS, PLO, FIGURE> extend(
 /**
  * Search task that extends the number of points of a lattice.
  *
+ * The lattices that extend the base lattice are explored as a Cartesian
+ * product of the lifts of each component.  If the shared thread pool
+ * ThreadPool::global() has more than one worker, the lifts of the second
+ * component are split in chunks which are explored concurrently, each worker
+ * with its own instance of the CBC algorithm, as in LatSeqBasedSearch.  The
+ * lattice selected is the same as with a serial search.
+ *
  * \tparam ET, COMPRESS Type of storage.
  * \tparam FIGURE Type of figure of merit.
  */
@@ -83,24 +99,12 @@ public:
 
    virtual void execute()
    {
-      typedef GenSeq::Extend<LR> GenSeqType;
-      typedef LatSeq::Combiner<LR, ET, GenSeqType, CartesianProduct> LatSeqType;
       this->setObserverTotalDim(1);
-
-      std::vector<GenSeqType> gens(this->dimension());
-      gens[0] = GenSeqType(LatticeTraits<LR>::TrivialModulus, LatticeTraits<LR>::TrivialModulus, typename LatticeTraits<LR>::GenValue(1));
-      for (size_t j = 1; j < gens.size(); j++)
-         gens[j] = GenSeqType(
-               storage().sizeParam().modulus(),
-               baseLat().sizeParam().modulus(),
-               baseLat().gen()[j]
-               );
-
-      LatSeqType latSeq(storage().sizeParam(), std::move(gens));
-
-      auto fseq = this->filters().apply(latSeqOverCBC().meritSeq(std::move(latSeq)));
-      const auto itmin = this->minElement()(fseq.begin(), fseq.end(), this->minObserver().maxAcceptedCount(), this->verbose());
-      this->selectBestLattice(*itmin.base().base(), *itmin, true);
+      this->minObserver().setBudgetShare(Budget::share());
+      if (ThreadPool::global().size() > 1 and this->dimension() > 1)
+         executeChunked();
+      else
+         executeSerial();
    }
 
    /**
@@ -145,6 +149,103 @@ protected:
    }
 
 private:
+   typedef GenSeq::Extend<LR> GenSeqType;
+   typedef LatSeq::Combiner<LR, ET, GenSeqType, CartesianProduct> LatSeqType;
+
+   /**
+    * Returns the sequences of the lifts of each component of the base
+    * lattice.
+    */
+   std::vector<GenSeqType> lifts() const
+   {
+      std::vector<GenSeqType> gens(this->dimension());
+      gens[0] = GenSeqType(LatticeTraits<LR>::TrivialModulus, LatticeTraits<LR>::TrivialModulus, typename LatticeTraits<LR>::GenValue(1));
+      for (size_t j = 1; j < gens.size(); j++)
+         gens[j] = GenSeqType(
+               storage().sizeParam().modulus(),
+               baseLat().sizeParam().modulus(),
+               baseLat().gen()[j]
+               );
+      return gens;
+   }
+
+   void executeSerial()
+   {
+      LatSeqType latSeq(storage().sizeParam(), lifts());
+
+      auto fseq = this->filters().apply(latSeqOverCBC().meritSeq(std::move(latSeq)));
+      const auto itmin = this->minElement()(fseq.begin(), fseq.end(), this->minObserver().maxAcceptedCount(), this->verbose());
+      this->selectBestLattice(*itmin.base().base(), *itmin, true);
+   }
+
+   void executeChunked()
+   {
+      typedef typename CBC::LatDef LatDef;
+
+      ThreadPool& pool = ThreadPool::global();
+      const auto gens = lifts();
+      // the second component is the slowest-varying non-trivial one
+      const size_t numIndices = gens[1].size();
+      const size_t numChunks = std::max<size_t>(1, std::min<size_t>(numIndices, 16 * pool.size()));
+      const bool truncateSum = this->filters().empty();
+
+      SharedMinimum threshold(Budget::target()); // seeded with the target merit value, if any
+      std::vector<std::unique_ptr<MeritSeq::LatSeqOverCBC<CBC>>> workers;
+      for (unsigned int worker = 0; worker < pool.size(); worker++) {
+         workers.emplace_back(new MeritSeq::LatSeqOverCBC<CBC>(CBC(this->storage(), this->figureOfMerit())));
+         setCBCSharedMinimum(workers.back()->cbc(), truncateSum ? &threshold : nullptr);
+      }
+
+      // best lattice, with its position (chunk, rank in chunk) in the serial order
+      std::mutex mutex;
+      bool found = false;
+      LatDef bestLat;
+      Real bestMerit = std::numeric_limits<Real>::infinity();
+      size_t bestChunk = 0;
+      size_t bestRank = 0;
+
+      this->minObserver().start(numIndices);
+      const Budget::Share& budget = this->minObserver().budgetShare();
+
+      pool.parallelFor(numChunks, [&] (unsigned int worker, size_t chunk) {
+         const size_t first = chunk * numIndices / numChunks;
+         const size_t last = (chunk + 1) * numIndices / numChunks;
+         auto chunkGens = gens;
+         chunkGens[1] = gens[1].rebind(LatBuilder::Traversal::Forward(first, last - first));
+         auto mseq = workers[worker]->meritSeq(LatSeqType(storage().sizeParam(), std::move(chunkGens)));
+
+         size_t rank = 0;
+         for (auto it = mseq.begin(); it != mseq.end(); ++it, ++rank) {
+            // the first lattice of the first chunk is always evaluated
+            if ((chunk > 0 || rank > 0) && budget.exhausted())
+               break;
+            const auto merit = *it;
+            const LatDef& lat = *it.base();
+            Profiler::count(Profiler::Counter::CANDIDATES); // the minimum observer is bypassed
+            Budget::count();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            // the filters are not thread-safe
+            const Real value = this->filters().apply(merit, lat);
+            if (!found || value < bestMerit || (value == bestMerit && (chunk < bestChunk || (chunk == bestChunk && rank < bestRank)))) {
+               found = true;
+               bestLat = lat;
+               bestMerit = value;
+               bestChunk = chunk;
+               bestRank = rank;
+               threshold.lower(value);
+               Budget::reach(value);
+            }
+         }
+      });
+
+      this->minObserver().stop();
+
+      if (!found)
+         throw std::runtime_error("Extend: empty sequence of lattices");
+      this->selectBestLattice(bestLat, bestMerit, true);
+   }
+
    Storage m_storage;
    std::unique_ptr<FigureOfMerit> m_figure;
    std::unique_ptr<MeritSeq::LatSeqOverCBC<CBC>> m_latSeqOverCBC;
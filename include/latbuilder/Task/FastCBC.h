@@ -22,7 +22,9 @@
 
 #include "latbuilder/CoordUniformFigureOfMerit.h"
 #include "latbuilder/MeritSeq/CoordUniformInnerProdFast.h"
+#include "latbuilder/MeritSeq/CoordUniformInnerProdGroup.h"
 #include "latbuilder/GenSeq/CyclicGroup.h"
+#include "latbuilder/GenSeq/GeneratingValues.h"
 #include "latbuilder/GenSeq/VectorCreator.h"
 #include "latbuilder/Util.h"
 
@@ -96,7 +98,91 @@ struct CBCBasedSearchTraits<FastCBCTag<LR, ET, COMPRESS, PLO, FIGURE>> {
    { throw std::runtime_error("fast CBC is implemented only for coordinate-uniform figures of merit"); }
 };
 
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
+struct FastGroupCBCTag {};
+
+
+/**
+ * Fast CBC exploration of ordinary unilevel lattices whose number of points is
+ * not a prime power, based on CoordUniformInnerProdGroup.
+ */
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE> using FastGroupCBC =
+   CBCBasedSearch<FastGroupCBCTag<LR, ET, COMPRESS, PLO, FIGURE>>;
+
+
+/// Fast CBC exploration of ordinary unilevel lattices of any number of points.
+template <class FIGURE, LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+FastGroupCBC<LR, ET, COMPRESS, PLO, FIGURE> fastGroupCBC(
+      Storage<LR, ET, COMPRESS, PLO> storage,
+      Dimension dimension,
+      FIGURE figure
+      )
+{ return FastGroupCBC<LR, ET, COMPRESS, PLO, FIGURE>(std::move(storage), dimension, std::move(figure)); }
+
+// specialization for coordinate-uniform figures of merit
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class KERNEL>
+struct CBCBasedSearchTraits<FastGroupCBCTag<LR, ET, COMPRESS, PLO, CoordUniformFigureOfMerit<KERNEL>>> {
+   typedef LatBuilder::Task::Search<LR, ET> Search;
+   typedef LatBuilder::Storage<LR, ET, COMPRESS, PLO> Storage;
+   typedef typename LatBuilder::Storage<LR, ET, COMPRESS, PLO>::SizeParam SizeParam;
+   typedef MeritSeq::CoordUniformCBC<LR, ET, COMPRESS, PLO, KERNEL, MeritSeq::CoordUniformInnerProdGroup> CBC;
+   typedef typename CBC::FigureOfMerit FigureOfMerit;
+   typedef GenSeq::GeneratingValues<LR, COMPRESS> GenSeqType;
+
+   std::vector<GenSeqType> genSeqs(const SizeParam& sizeParam, Dimension dimension) const
+   {
+      auto vec = GenSeq::VectorCreator<GenSeqType>::create(sizeParam, dimension);
+      vec[0] = GenSeq::Creator<GenSeqType>::create(SizeParam(LatticeTraits<LR>::TrivialModulus));
+      return vec;
+   }
+
+   std::string name() const
+   {  return "Task: LatBuilder Search for " + to_string(LR)  + " lattices\nExploration method: CBC - Fast Explorer";}
+
+   void init(LatBuilder::Task::FastGroupCBC<LR, ET, COMPRESS, PLO, FigureOfMerit>& search) const
+   { connectCBCProgress(search.cbc(), search.minObserver(), search.filters().empty()); }
+};
+
+// specialization for other figures of merit
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
+struct CBCBasedSearchTraits<FastGroupCBCTag<LR, ET, COMPRESS, PLO, FIGURE>> {
+   typedef LatBuilder::Task::Search<LR, ET> Search;
+   typedef LatBuilder::Storage<LR, ET, COMPRESS, PLO> Storage;
+   typedef FIGURE FigureOfMerit;
+   typedef typename LatBuilder::Storage<LR, ET, COMPRESS, PLO>::SizeParam SizeParam;
+   typedef typename CBCSelector<LR, ET, COMPRESS, PLO, FIGURE>::CBC CBC;
+   typedef GenSeq::GeneratingValues<LR, COMPRESS> GenSeqType;
+
+   virtual ~CBCBasedSearchTraits() {}
+
+   std::vector<GenSeqType> genSeqs(const SizeParam& sizeParam, Dimension dimension) const
+   {
+      auto vec = GenSeq::VectorCreator<GenSeqType>::create(sizeParam, dimension);
+      vec[0] = GenSeq::Creator<GenSeqType>::create(SizeParam(LatticeTraits<LR>::TrivialModulus));
+      return vec;
+   }
+
+   std::string name() const
+   { return "unimplemented fast CBC"; }
+
+   void init(LatBuilder::Task::FastGroupCBC<LR, ET, COMPRESS, PLO, FIGURE>& search) const
+   { throw std::runtime_error("fast CBC is implemented only for coordinate-uniform figures of merit"); }
+};
+
+namespace detail {
+   // the fast CBC merit sequences compute the merit values of all candidates
+   // with an FFT when they are created, so that every process would compute
+   // all of them: each process runs the whole search instead
+   template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
+   struct Distributes<FastCBCTag<LR, ET, COMPRESS, PLO, FIGURE>> : std::false_type {};
+
+   template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
+   struct Distributes<FastGroupCBCTag<LR, ET, COMPRESS, PLO, FIGURE>> : std::false_type {};
+}
+
 TASK_FOR_ALL_COORDSYM(TASK_EXTERN_TEMPLATE, CBCBasedSearch, FastCBC);
+TASK_FOR_ALL_COORDSYM_LATTICE_ORDINARY_UNILEVEL(TASK_EXTERN_TEMPLATE, CBCBasedSearch, FastGroupCBC);
 
 }}
 
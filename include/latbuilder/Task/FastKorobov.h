@@ -0,0 +1,135 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__TASK__FAST_KOROBOV_H
+#define LATBUILDER__TASK__FAST_KOROBOV_H
+
+#include "latbuilder/Task/LatSeqBasedSearch.h"
+#include "latbuilder/Task/macros.h"
+
+#include "latbuilder/CoordUniformFigureOfMerit.h"
+#include "latbuilder/MeritSeq/CoordUniformInnerProdCyclic.h"
+#include "latbuilder/LatSeq/Korobov.h"
+#include "latbuilder/GenSeq/CyclicGroup.h"
+#include "latbuilder/GenSeq/GeneratingValues.h"
+#include "latbuilder/GenSeq/Creator.h"
+#include "latbuilder/SizeParam.h"
+#include "latbuilder/Util.h"
+
+namespace LatBuilder { namespace Task {
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
+struct FastKorobovTag {};
+
+
+/**
+ * Fast Korobov search.
+ *
+ * Same candidates as the Korobov search, for an integer power of a prime
+ * base, but visited in the order of the powers of a generator of the group of
+ * units, with the kernel values stored in the inverse-cyclic per-level order,
+ * so that their permutation for each candidate and each coordinate reduces to
+ * cyclic shifts (see MeritSeq::CoordUniformInnerProdCyclic).  Implemented for
+ * coordinate-uniform figures of merit.
+ */
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE> using FastKorobov =
+   LatSeqBasedSearch<FastKorobovTag<LR, ET, COMPRESS, PLO, FIGURE>>;
+
+
+/// Fast Korobov search.
+template <class FIGURE, LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+FastKorobov<LR, ET, COMPRESS, PLO, FIGURE> fastKorobov(
+      Storage<LR, ET, COMPRESS, PLO> storage,
+      Dimension dimension,
+      FIGURE figure
+      )
+{ return FastKorobov<LR, ET, COMPRESS, PLO, FIGURE>(std::move(storage), dimension, std::move(figure)); }
+
+// specialization for coordinate-uniform figures of merit
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class KERNEL>
+struct LatSeqBasedSearchTraits<FastKorobovTag<LR, ET, COMPRESS, PLO, CoordUniformFigureOfMerit<KERNEL>>> {
+   typedef LatBuilder::Task::Search<LR, ET> Search;
+   typedef LatBuilder::Storage<LR, ET, COMPRESS, PLO> Storage;
+   typedef typename LatBuilder::Storage<LR, ET, COMPRESS, PLO>::SizeParam SizeParam;
+   typedef MeritSeq::CoordUniformCBC<LR, ET, COMPRESS, PLO, KERNEL, MeritSeq::CoordUniformInnerProdCyclic> CBC;
+   typedef GenSeq::CyclicGroup<LR, COMPRESS, Traversal::Forward> GenSeqType;
+   typedef LatSeq::Korobov<LR, ET, GenSeqType> LatSeqType;
+   typedef std::true_type Chunked;
+
+   virtual ~LatSeqBasedSearchTraits() {}
+
+   LatSeqType latSeq(const SizeParam& sizeParam, Dimension dimension) const
+   {
+      return LatSeqType(
+            sizeParam,
+            GenSeq::Creator<GenSeqType>::create(sizeParam),
+            dimension
+            );
+   }
+
+   size_t numChunkIndices(const SizeParam& sizeParam, Dimension dimension) const
+   { return GenSeq::Creator<GenSeqType>::create(sizeParam).size(); }
+
+   LatSeqType latSeq(const SizeParam& sizeParam, Dimension dimension, Traversal::Forward chunk) const
+   {
+      return LatSeqType(
+            sizeParam,
+            GenSeq::Creator<GenSeqType>::create(sizeParam).rebind(std::move(chunk)),
+            dimension
+            );
+   }
+
+   std::string name() const
+   { return "Task: LatBuilder Search for " + to_string(LR)  + " lattices\nExploration method: Korobov - Fast Explorer"; }
+
+   void init(LatBuilder::Task::FastKorobov<LR, ET, COMPRESS, PLO, CoordUniformFigureOfMerit<KERNEL>>& search) const
+   { connectCBCProgress(search.cbc(), search.minObserver(), search.filters().empty()); }
+};
+
+// specialization for other figures of merit
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
+struct LatSeqBasedSearchTraits<FastKorobovTag<LR, ET, COMPRESS, PLO, FIGURE>> {
+   typedef LatBuilder::Task::Search<LR, ET> Search;
+   typedef LatBuilder::Storage<LR, ET, COMPRESS, PLO> Storage;
+   typedef typename LatBuilder::Storage<LR, ET, COMPRESS, PLO>::SizeParam SizeParam;
+   typedef typename CBCSelector<LR, ET, COMPRESS, PLO, FIGURE>::CBC CBC;
+   typedef GenSeq::GeneratingValues<LR, COMPRESS> GenSeqType;
+   typedef LatSeq::Korobov<LR, ET, GenSeqType> LatSeqType;
+   typedef std::false_type Chunked;
+
+   virtual ~LatSeqBasedSearchTraits() {}
+
+   LatSeqType latSeq(const SizeParam& sizeParam, Dimension dimension) const
+   {
+      return LatSeqType(
+            sizeParam,
+            GenSeq::Creator<GenSeqType>::create(sizeParam),
+            dimension
+            );
+   }
+
+   std::string name() const
+   { return "unimplemented fast Korobov"; }
+
+   void init(LatBuilder::Task::FastKorobov<LR, ET, COMPRESS, PLO, FIGURE>& search) const
+   { throw std::runtime_error("fast Korobov is implemented only for coordinate-uniform figures of merit"); }
+};
+
+TASK_FOR_ALL_COORDSYM_LATTICE_ORDINARY(TASK_EXTERN_TEMPLATE, LatSeqBasedSearch, FastKorobov);
+
+}}
+
+#endif
@@ -55,6 +55,7 @@ struct LatSeqBasedSearchTraits<KorobovTag<LR, ET, COMPRESS, PLO, FIGURE>> {
    typedef typename CBCSelector<LR, ET, COMPRESS, PLO, FIGURE>::CBC CBC;
    typedef GenSeq::GeneratingValues<LR, COMPRESS> GenSeqType;
    typedef LatSeq::Korobov<LR, ET, GenSeqType> LatSeqType;
+   typedef std::true_type Chunked;
 
    virtual ~LatSeqBasedSearchTraits() {}
 
@@ -67,6 +68,18 @@ struct LatSeqBasedSearchTraits<KorobovTag<LR, ET, COMPRESS, PLO, FIGURE>> {
             );
    }
 
+   size_t numChunkIndices(const SizeParam& sizeParam, Dimension dimension) const
+   { return GenSeq::Creator<GenSeqType>::create(sizeParam).size(); }
+
+   LatSeqType latSeq(const SizeParam& sizeParam, Dimension dimension, Traversal::Forward chunk) const
+   {
+      return LatSeqType(
+            sizeParam,
+            GenSeq::Creator<GenSeqType>::create(sizeParam).rebind(std::move(chunk)),
+            dimension
+            );
+   }
+
    std::string name() const
    { return "Task: LatBuilder Search for " + to_string(LR)  + " lattices\nExploration method: Korobov"; }
 
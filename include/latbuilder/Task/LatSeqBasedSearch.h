@@ -23,6 +23,17 @@
 #include "latbuilder/Storage.h"
 #include "latbuilder/MeritFilterList.h"
 #include "latbuilder/MeritSeq/LatSeqOverCBC.h"
+#include "latbuilder/Budget.h"
+#include "latbuilder/SharedMinimum.h"
+#include "latbuilder/Shard.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Traversal.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 namespace LatBuilder { namespace Task {
 
@@ -32,6 +43,15 @@ namespace LatBuilder { namespace Task {
  * A specialization for the CBCBasedSearchTraits class
  * must define the \c Storage and \c CBC types, together with the static \c
  * init(), \c latSeq() and \c name() functions.
+ *
+ * It must also define the \c Chunked type as \c std::true_type if the
+ * sequence of lattices can be split in contiguous chunks, in which case it
+ * must implement the \c numChunkIndices() function, returning the number of
+ * values \f$N\f$ of the index that varies the slowest in the lattice sequence,
+ * and a \c latSeq() overload that takes a Traversal::Forward instance on
+ * \f$\{0, \dots, N-1\}\f$ as its third argument and that returns the
+ * subsequence of the lattices whose slowest index is in that range.
+ * Otherwise, \c Chunked is \c std::false_type.
  */
 template <class>
 struct LatSeqBasedSearchTraits;
@@ -39,6 +59,22 @@ struct LatSeqBasedSearchTraits;
 /**
  * Search task based on a sequence of lattices.
  *
+ * If the lattice sequence can be split in chunks (see
+ * LatSeqBasedSearchTraits) and the shared thread pool ThreadPool::global() has
+ * more than one worker, the chunks are explored concurrently, each worker with
+ * its own instance of the CBC algorithm and of the figure of merit evaluator.
+ * The smallest merit value found so far is shared by all chunks, so that the
+ * computation of the figure of merit is interrupted as soon as its partial
+ * sum/max exceeds it, whichever chunk it was found in, and, after each
+ * component, as soon as the partial merit value of the components already
+ * evaluated exceeds it (see MeritSeq::LatSeqOverCBC).  The lattice selected
+ * is the same as with a serial search; the merit values of the visited
+ * lattices are not displayed, whatever the verbosity level.
+ *
+ * If the search is split into shards (see Shard), the lattice sequence must
+ * be split in chunks, and only the values of the slowest index in the range of
+ * the shard are explored, as chunks even with a single worker.
+ *
  * \tparam TAG Tag class.
  */
 template <class TAG>
@@ -75,12 +111,9 @@ public:
       
    virtual void execute()
    {
-      auto latSeq = m_traits.latSeq(storage().sizeParam(), this->dimension());
       this->setObserverTotalDim(1);
-
-      auto fseq = this->filters().apply(latSeqOverCBC().meritSeq(std::move(latSeq)));
-      const auto itmin = this->minElement()(fseq.begin(), fseq.end(), this->minObserver().maxAcceptedCount(), this->verbose());
-      this->selectBestLattice(*itmin.base().base(), *itmin, true);
+      this->minObserver().setBudgetShare(Budget::share());
+      execute(typename Traits::Chunked());
    }
 
    /**
@@ -117,6 +150,108 @@ protected:
    }
 
 private:
+   void execute(std::false_type)
+   { executeSerial(); }
+
+   // a member template, so that the explicit instantiations of the tasks
+   // whose sequences cannot be split do not instantiate executeChunked()
+   template <class T = Traits>
+   void execute(std::true_type)
+   {
+      if (ThreadPool::global().size() > 1 || Shard::active())
+         executeChunked<T>();
+      else
+         executeSerial();
+   }
+
+   void executeSerial()
+   {
+      // the lattices are discarded as soon as their partial merit exceeds the minimum
+      m_latSeqOverCBC->setSharedMinimum(this->filters().empty() ? &this->minObserver().sharedMinimum() : nullptr);
+      auto latSeq = m_traits.latSeq(storage().sizeParam(), this->dimension());
+
+      auto fseq = this->filters().apply(latSeqOverCBC().meritSeq(std::move(latSeq)));
+      Profiler::Scope scope(Profiler::Timer::EVALUATION);
+      const auto itmin = this->minElement()(fseq.begin(), fseq.end(), this->minObserver().maxAcceptedCount(), this->verbose());
+      this->selectBestLattice(*itmin.base().base(), *itmin, true);
+   }
+
+   template <class T>
+   void executeChunked()
+   {
+      typedef typename CBC::LatDef LatDef;
+
+      ThreadPool& pool = ThreadPool::global();
+      const auto& sizeParam = storage().sizeParam();
+      // the values of the slowest index of the shard
+      const size_t total = m_traits.numChunkIndices(sizeParam, this->dimension());
+      const size_t offset = Shard::begin(total);
+      const size_t numIndices = Shard::end(total) - offset;
+      if (numIndices == 0)
+         throw std::runtime_error("LatSeqBasedSearch: the shard has no lattice; use at most " + std::to_string(total) + " shards");
+      const size_t numChunks = std::max<size_t>(1, std::min<size_t>(numIndices, 16 * pool.size()));
+      const bool truncateSum = this->filters().empty();
+
+      // one instance of the CBC algorithm, hence of the evaluator, by worker;
+      // the evaluators poll the smallest merit value found in any chunk
+      SharedMinimum threshold(Budget::target()); // seeded with the target merit value, if any
+      std::vector<std::unique_ptr<MeritSeq::LatSeqOverCBC<CBC>>> workers;
+      for (unsigned int worker = 0; worker < pool.size(); worker++) {
+         workers.emplace_back(new MeritSeq::LatSeqOverCBC<CBC>(CBC(this->storage(), this->figureOfMerit())));
+         setCBCSharedMinimum(workers.back()->cbc(), truncateSum ? &threshold : nullptr);
+         workers.back()->setSharedMinimum(truncateSum ? &threshold : nullptr);
+      }
+
+      // best lattice, with its position (chunk, rank in chunk) in the serial order
+      std::mutex mutex;
+      bool found = false;
+      LatDef bestLat;
+      Real bestMerit = std::numeric_limits<Real>::infinity();
+      size_t bestChunk = 0;
+      size_t bestRank = 0;
+
+      this->minObserver().start(numIndices);
+      const Budget::Share& budget = this->minObserver().budgetShare();
+      Profiler::Scope scope(Profiler::Timer::EVALUATION);
+
+      pool.parallelFor(numChunks, [&] (unsigned int worker, size_t chunk) {
+         const size_t first = offset + chunk * numIndices / numChunks;
+         const size_t last = offset + (chunk + 1) * numIndices / numChunks;
+         auto latSeq = m_traits.latSeq(sizeParam, this->dimension(), LatBuilder::Traversal::Forward(first, last - first));
+         auto mseq = workers[worker]->meritSeq(std::move(latSeq));
+
+         size_t rank = 0;
+         for (auto it = mseq.begin(); it != mseq.end(); ++it, ++rank) {
+            // the first lattice of the first chunk is always evaluated
+            if ((chunk > 0 || rank > 0) && budget.exhausted())
+               break;
+            const auto merit = *it;
+            const LatDef& lat = *it.base();
+            Profiler::count(Profiler::Counter::CANDIDATES); // the minimum observer is bypassed
+            Budget::count();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            // the filters are not thread-safe
+            const Real value = this->filters().apply(merit, lat);
+            if (!found || value < bestMerit || (value == bestMerit && (chunk < bestChunk || (chunk == bestChunk && rank < bestRank)))) {
+               found = true;
+               bestLat = lat;
+               bestMerit = value;
+               bestChunk = chunk;
+               bestRank = rank;
+               threshold.lower(value);
+               Budget::reach(value);
+            }
+         }
+      });
+
+      this->minObserver().stop();
+
+      if (!found)
+         throw std::runtime_error("LatSeqBasedSearch: empty sequence of lattices");
+      this->selectBestLattice(bestLat, bestMerit, true);
+   }
+
    Storage m_storage;
    std::unique_ptr<FigureOfMerit> m_figure;
    std::unique_ptr<MeritSeq::LatSeqOverCBC<CBC>> m_latSeqOverCBC;
@@ -28,6 +28,7 @@
 #include "latbuilder/Traversal.h"
 #include "latbuilder/Util.h"
 #include "latbuilder/LFSR258.h"
+#include "latbuilder/Shard.h"
 
 #include <boost/lexical_cast.hpp>
 
@@ -63,9 +64,12 @@ struct LatSeqBasedSearchTraits<RandomTag<LR, ET, COMPRESS, PLO, FIGURE>> {
    typedef LatBuilder::Traversal::Random<RandomGenerator> Traversal;
    typedef GenSeq::GeneratingValues<LR, COMPRESS, Traversal> GenSeqType;
    typedef LatSeq::Combiner<LR, ET, GenSeqType, Zip> LatSeqType;
+   typedef std::false_type Chunked;
 
+   // the shards of a search draw from distinct streams
    LatSeqBasedSearchTraits(unsigned int numRand_):
-      numRand(numRand_)
+      numRand(numRand_),
+      rand(Shard::randomGenerator())
    {}
 
    virtual ~LatSeqBasedSearchTraits() {}
@@ -94,7 +98,11 @@ struct LatSeqBasedSearchTraits<RandomTag<LR, ET, COMPRESS, PLO, FIGURE>> {
    void init(LatBuilder::Task::Random<LR, ET, COMPRESS, PLO, FIGURE>& search) const
    {
       connectCBCProgress(search.cbc(), search.minObserver(), search.filters().empty());
-      search.minObserver().setMaxAcceptedCount(numRand);
+      // the shards share the samples
+      const size_t shardRand = Shard::end(numRand) - Shard::begin(numRand);
+      if (shardRand == 0)
+         throw std::runtime_error("the shard has no random sample; use at most " + std::to_string(numRand) + " shards");
+      search.minObserver().setMaxAcceptedCount(shardRand);
    }
 
    unsigned int numRand;
@@ -22,6 +22,11 @@
 #include "latbuilder/MeritFilterList.h"
 #include "latbuilder/Functor/MinElement.h"
 #include "latbuilder/Functor/LowPass.h"
+#include "latbuilder/SharedMinimum.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Budget.h"
+#include "latbuilder/Execution.h"
+#include "latbuilder/ProgressFeed.h"
 
 // for CBCSelector
 #include "latbuilder/WeightedFigureOfMerit.h"
@@ -34,6 +39,9 @@
 
 #include <boost/signals2.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <memory>
 
 using namespace std::placeholders;
@@ -57,6 +65,9 @@ public:
     * truncating the sum over projections if, during its term-by-term
     * evaluation, the partial sum reaches a value superior to the current
     * minimum value.  The default behavior is not to truncate the sum.
+    *
+    * It also stops the search when the share of the budget given with
+    * setBudgetShare() is exhausted (see Budget).
     */
    class MinObserver {
    public:
@@ -80,6 +91,18 @@ public:
       void setMaxTotalCount(size_t maxCount)
       { m_maxTotalCount = maxCount; }
 
+      /**
+       * Sets the share of the budget of the next searches of the minimum.
+       */
+      void setBudgetShare(Budget::Share share)
+      { m_budget = share; }
+
+      /**
+       * Returns the share of the budget of the searches of the minimum.
+       */
+      const Budget::Share& budgetShare() const
+      { return m_budget; }
+
       /**
        * Sets the truncate-sum flag to \c value.
        *
@@ -89,17 +112,30 @@ public:
       { m_truncateSum = value; }
 
       void start(const size_t& n_totToBeVisited)
-      { stop(); m_dimension++; m_totalCount = 0; m_rejectedCount = 0; m_nTotToBeVisited = n_totToBeVisited;}
+      {
+         stop(); m_dimension++; m_totalCount = 0; m_rejectedCount = 0; m_nTotToBeVisited = n_totToBeVisited;
+         if (m_totalDim > 1)
+            ProgressFeed::setCoordinate(m_dimension - 1, m_totalDim);
+         ProgressFeed::setCandidates(n_totToBeVisited);
+      }
 
       /**
-       * Reset the low-pass filter when min-element stops.
+       * Reset the low-pass filter when min-element stops, to the target
+       * merit value if one is set (see Budget::setTarget()).
        */
       void stop()
-      { m_lowPass.setThreshold(std::numeric_limits<Real>::max()); }
+      {
+         const Real target = Budget::target();
+         m_lowPass.setThreshold(std::isinf(target) ? std::numeric_limits<Real>::max() : target);
+         m_sharedMinimum.reset(target);
+      }
 
       bool visited(const Real& r)
       {
          m_totalCount++;
+         Profiler::count(Profiler::Counter::CANDIDATES);
+         Budget::count();
+         ProgressFeed::setCandidate(m_totalCount);
          if (m_verbose > 0 && ((m_nTotToBeVisited > 100 && m_totalCount % 100 == 0) || (m_totalCount % 10 == 0))){
                if (m_totalDim > 1){
                 std::cout << "Coordinate " << m_dimension-1 << "/" << m_totalDim <<  " - lattice ";
@@ -110,7 +146,8 @@ public:
               std::cout << m_totalCount << "/" << m_nTotToBeVisited << std::endl;
          }
          return acceptedCount() < maxAcceptedCount() and
-            totalCount() < maxTotalCount();
+            totalCount() < maxTotalCount() and
+            not m_budget.exhausted();
       }
 
       template <LatticeType LA, EmbeddingType L>
@@ -119,10 +156,16 @@ public:
 
       /**
        * Updates the threshold of the low-pass filter with the new observed
-       * minimum value.
+       * minimum value, unless the target merit value is smaller, and stops
+       * the search if the minimum is below the target.
        */
       void minUpdated(const Real& newMin)
-      { m_lowPass.setThreshold(newMin); }
+      {
+         const Real threshold = std::min(newMin, Budget::target());
+         m_lowPass.setThreshold(threshold);
+         m_sharedMinimum.reset(threshold);
+         Budget::reach(newMin);
+      }
 
       void setVerbosity(int verbose){
         m_verbose = verbose;
@@ -164,6 +207,14 @@ public:
       const Functor::LowPass<Real>& lowPass() const
       { return m_lowPass; }
 
+      /**
+       * Returns the current minimum value as a shared minimum, to be polled
+       * by the figure of merit evaluators instead of connecting their progress
+       * signal to progress().
+       */
+      const SharedMinimum& sharedMinimum() const
+      { return m_sharedMinimum; }
+
    private:
       Dimension m_dimension;
       int m_verbose;
@@ -174,6 +225,7 @@ public:
       size_t m_rejectedCount;
       size_t m_nTotToBeVisited;
       Dimension m_totalDim;
+      Budget::Share m_budget;
 
       /**
        * Low-pass filter whose threshold is continuously updated with the
@@ -186,6 +238,12 @@ public:
        */
       Functor::LowPass<Real> m_lowPass;
 
+      /**
+       * Copy of the threshold of the low-pass filter that can be read
+       * without any signal dispatch.
+       */
+      SharedMinimum m_sharedMinimum;
+
    };
 
    Search(Dimension dimension):
@@ -295,6 +353,27 @@ public:
       m_bestMerit = 0.0;
    }
 
+   /**
+    * Sets the file to which the search writes a checkpoint after each
+    * completed coordinate.
+    *
+    * Only component-by-component searches write checkpoints; the other
+    * searches ignore the file.
+    */
+   virtual void setCheckpointFile(std::string fileName)
+   {}
+
+   /**
+    * Resumes the search from the checkpoint written in \c fileName.
+    *
+    * The next call to execute() starts from the coordinates recorded in the
+    * checkpoint.
+    *
+    * \throws std::runtime_error if the search is not component-by-component.
+    */
+   virtual void resumeFrom(const std::string& fileName)
+   { throw std::runtime_error("only CBC explorations can be resumed from a checkpoint"); }
+
 protected:
 
    virtual void format(std::ostream& os) const
@@ -310,6 +389,7 @@ protected:
    {
       m_bestLat = lattice;
       m_bestMerit = merit;
+      ProgressFeed::setBestMerit(merit);
       if (! quiet){
         onLatticeSelected()(*this);
       }
@@ -411,27 +491,38 @@ struct CBCSelector<LR, ET, COMPRESS, PLO, CoordUniformFigureOfMerit<KERNEL>> {
 
 
 /**
- * Connects WeightedFigureOfMerit::OnProgress with an Search::MinObserver::progress
- * function and activates Search::MinObserver::setTruncateSum().
+ * Lets the evaluator of WeightedFigureOfMerit poll the shared minimum \c
+ * minimum after each projection, or restores its progress signal if \c
+ * minimum is \c nullptr.
+ */
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class PROJDEP, template <class> class ACC>
+void setCBCSharedMinimum(const MeritSeq::CBC<LR, ET, COMPRESS, PLO, PROJDEP, ACC>& cbc, const SharedMinimum* minimum) {
+   cbc.evaluator().setSharedMinimum(minimum);
+}
+
+/**
+ * Does nothing.
+ */
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class KERNEL, template <LatticeType, EmbeddingType, Compress, PerLevelOrder> class PROD>
+void setCBCSharedMinimum(const MeritSeq::CoordUniformCBC<LR, ET, COMPRESS, PLO, KERNEL, PROD>& cbc, const SharedMinimum* minimum) {
+   // nothing to do with coordinate-uniform CBC
+}
+
+/**
+ * Lets the evaluator of WeightedFigureOfMerit poll Search::MinObserver::sharedMinimum()
+ * and activates Search::MinObserver::setTruncateSum().
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class PROJDEP, template <class> class ACC, class OBSERVER>
 void connectCBCProgress(const MeritSeq::CBC<LR, ET, COMPRESS, PLO, PROJDEP, ACC>& cbc, OBSERVER& obs, bool truncateSum) {
-   typedef typename Storage<LR, ET, COMPRESS, PLO>::MeritValue MeritValue;
-   typedef bool (OBSERVER::*ProgressCallback)(const MeritValue&) const;
-   ProgressCallback progress = &OBSERVER::progress;
-
    // We want to interrupt the evaluation of the figure of merit when it
-   // reaches a value larger than that threshold, so we pass the partial
-   // sum/max through the low-pass filter.
-   //
-   // Connect the onProgress signal to the function that checks that the
-   // current minimum value is greater than the partial sum/max.
+   // reaches a value larger than the current minimum value, so the evaluator
+   // compares the partial sum/max with the minimum after each projection.
    //
    // NOTE: this doesn't work for embedded lattices.
-   cbc.evaluator().onProgress().connect(boost::bind(progress, &obs, boost::placeholders::_1));
-
+   //
    // truncate the sum over projections only if no filters are applied
    // downstream
+   setCBCSharedMinimum(cbc, truncateSum ? &obs.sharedMinimum() : nullptr);
    obs.setTruncateSum(truncateSum);
 }
 
@@ -443,6 +534,17 @@ void connectCBCProgress(const MeritSeq::CoordUniformCBC<LR, ET, COMPRESS, PLO, K
    // nothing to do with coordinate-uniform CBC
 }
 
+/**
+ * Reports the lattices selected by \c search to the progress of \c execution
+ * (see AsyncTask).
+ */
+template <LatticeType LR, EmbeddingType ET>
+void connectProgress(Search<LR, ET>& search, std::shared_ptr<Execution> execution)
+{
+   search.onLatticeSelected().connect([execution] (const Search<LR, ET>& s)
+         { execution->select(s.bestLattice().dimension(), s.bestMeritValue()); });
+}
+
 }}
 
 #endif
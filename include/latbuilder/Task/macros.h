@@ -20,6 +20,7 @@
 // helper macros for instatiating all task variants
 
 #include "latbuilder/Types.h"
+#include "latbuilder/Module.h"
 #include "latbuilder/WeightedFigureOfMerit.h"
 #include "latbuilder/CoordUniformFigureOfMerit.h"
 #include "latbuilder/ProjDepMerit/Spectral.h"
@@ -29,18 +30,34 @@
 #include "latbuilder/Kernel/PAlphaTilde.h"
 #include "latbuilder/Kernel/RAlpha.h"
 #include "latbuilder/Kernel/RPLR.h"
+#include "latbuilder/Kernel/LinearCombination.h"
 #include "latbuilder/Functor/binary.h"
 
+// the variants of a lattice type are only listed in the units of its module
+// in modular builds (see Module.h)
+#if LATBUILDER_WITH_LATTICE_ORDINARY
 #define TASK_ADD_ARG_PARAMETERS_LATTICE_ORDINARY(func, ...) \
    func(__VA_ARGS__,LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC); \
    func(__VA_ARGS__,LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::SYMMETRIC, PerLevelOrder::BASIC); \
    func(__VA_ARGS__,LatticeType::ORDINARY, EmbeddingType::MULTILEVEL, Compress::NONE, PerLevelOrder::CYCLIC); \
    func(__VA_ARGS__,LatticeType::ORDINARY, EmbeddingType::MULTILEVEL, Compress::SYMMETRIC, PerLevelOrder::CYCLIC)
 
+#define TASK_ADD_ARG_PARAMETERS_LATTICE_ORDINARY_UNILEVEL(func, ...) \
+   func(__VA_ARGS__,LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC); \
+   func(__VA_ARGS__,LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::SYMMETRIC, PerLevelOrder::BASIC)
+#else
+#define TASK_ADD_ARG_PARAMETERS_LATTICE_ORDINARY(func, ...)
+#define TASK_ADD_ARG_PARAMETERS_LATTICE_ORDINARY_UNILEVEL(func, ...)
+#endif
+
+#if LATBUILDER_WITH_LATTICE_POLYNOMIAL
 #define TASK_ADD_ARG_PARAMETERS_LATTICE_POLYNOMIAL(func, ...) \
    func(__VA_ARGS__,LatticeType::POLYNOMIAL, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC); \
    func(__VA_ARGS__,LatticeType::POLYNOMIAL, EmbeddingType::MULTILEVEL, Compress::NONE, PerLevelOrder::BASIC); \
    func(__VA_ARGS__,LatticeType::POLYNOMIAL, EmbeddingType::MULTILEVEL, Compress::NONE, PerLevelOrder::CYCLIC)
+#else
+#define TASK_ADD_ARG_PARAMETERS_LATTICE_POLYNOMIAL(func, ...)
+#endif
 
 
 
@@ -59,11 +76,13 @@
 
 #define TASK_ADD_ARG_KERNEL_LATTICE_ORDINARY(func, ...) \
    func(__VA_ARGS__, Kernel::PAlpha); \
-   func(__VA_ARGS__, Kernel::RAlpha)
+   func(__VA_ARGS__, Kernel::RAlpha); \
+   func(__VA_ARGS__, Kernel::OrdinaryCombination)
 
 #define TASK_ADD_ARG_KERNEL_LATTICE_POLYNOMIAL(func, ...) \
    func(__VA_ARGS__, Kernel::PAlphaTilde); \
-   func(__VA_ARGS__, Kernel::RPLR)
+   func(__VA_ARGS__, Kernel::RPLR); \
+   func(__VA_ARGS__, Kernel::PolynomialCombination)
 
 #define TASK_INDIRECT(func, ...) \
 	func(__VA_ARGS__)
@@ -98,6 +117,13 @@
 		   TASK_ADD_COORDSYM_FIGURE, \
 		   func, __VA_ARGS__)
 
+#define TASK_FOR_ALL_COORDSYM_LATTICE_ORDINARY_UNILEVEL(func, ...) \
+   TASK_INDIRECT( \
+		   TASK_ADD_ARG_KERNEL_LATTICE_ORDINARY, \
+		   TASK_ADD_ARG_PARAMETERS_LATTICE_ORDINARY_UNILEVEL, \
+		   TASK_ADD_COORDSYM_FIGURE, \
+		   func, __VA_ARGS__)
+
 #define TASK_FOR_ALL_COORDSYM_LATTICE_POLYNOMIAL(func, ...) \
    TASK_INDIRECT( \
          TASK_ADD_ARG_KERNEL_LATTICE_POLYNOMIAL, \
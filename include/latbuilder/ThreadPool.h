@@ -0,0 +1,225 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Fixed-size pool of worker threads for data-parallel loops.
+ */
+
+#ifndef LATBUILDER__THREAD_POOL_H
+#define LATBUILDER__THREAD_POOL_H
+
+#include "latbuilder/Memory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Fixed-size pool of worker threads executing indexed loops.
+ *
+ * The threads are created once by the constructor and are reused by every call
+ * to parallelFor(), so that the pool can be used in the inner loops of
+ * searches without paying the thread creation cost each time.
+ * The calling thread takes part in the computation as worker 0, so that a pool
+ * of size 1 does not create any thread and runs the loop serially.
+ *
+ * A call to parallelFor() made from within a loop body of any pool, or while
+ * the pool is already running a loop for another thread, runs its loop
+ * serially in the calling thread with worker index 0; per-worker data used by
+ * such nested loops must therefore be local to the call.  Hence, code which
+ * uses the global() pool can be called from the loops of another pool
+ * without oversubscribing the processors.
+ *
+ * The components of the library do not create pools of their own: they use
+ * the global() pool, or the process-wide pool of a given size returned by
+ * shared(), so that all of them run on the same threads.
+ */
+class ThreadPool
+{
+public:
+   /// Type of the loop bodies: called with the worker index and the loop index.
+   typedef std::function<void (unsigned int, size_t)> Body;
+
+   /**
+    * Constructor.
+    * \param numThreads Number of workers (including the calling thread). A
+    *                   value of 0 selects the number of hardware threads.
+    */
+   explicit ThreadPool(unsigned int numThreads = 0);
+
+   /**
+    * Destructor. Joins all worker threads.
+    */
+   ~ThreadPool();
+
+   ThreadPool(const ThreadPool&) = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   /**
+    * Returns the number of workers, including the calling thread.
+    */
+   unsigned int size() const
+   { return m_size; }
+
+   /**
+    * Returns \c true if the threads of the pool are pinned to their processors
+    * (see setPinning()).
+    */
+   bool pinned() const
+   { return m_pinned; }
+
+   /**
+    * Calls \c body(worker, i) for every \c i in <tt>[0, n)</tt>.
+    *
+    * Loop indices are dispensed dynamically to the workers, in increasing
+    * order. The worker index is in <tt>[0, size())</tt> and can be used to
+    * address per-worker data without locking.
+    * Blocks until all iterations are done. If some iterations throw, the
+    * remaining iterations are skipped and the first exception is rethrown in the
+    * calling thread.
+    * The large allocations of the iterations are charged to the Memory
+    * component of the calling thread.
+    */
+   void parallelFor(size_t n, const Body& body);
+
+   /**
+    * Returns the reduction of the values of the consecutive blocks of \c grain
+    * indices covering <tt>[0, n)</tt>: \c map(worker, begin, end) is called
+    * concurrently for each block <tt>[begin, end)</tt>, and its values are
+    * combined in the calling thread, in increasing order of the blocks, as
+    * <tt>init = combine(init, value)</tt>.
+    *
+    * The blocks only depend on \c n and \c grain, so that the result does not
+    * depend on the number of workers nor on the order in which the blocks are
+    * computed, even if \c combine is not associative, as with floating-point
+    * sums.
+    */
+   template <typename T, class MAP, class COMBINE>
+   T parallelReduce(size_t n, size_t grain, T init, const MAP& map, const COMBINE& combine)
+   {
+      grain = grain > 0 ? grain : 1;
+      const size_t numBlocks = (n + grain - 1) / grain;
+      std::vector<T> values(numBlocks, init);
+      parallelFor(numBlocks, [&](unsigned int worker, size_t block)
+            {
+               const size_t begin = block * grain;
+               values[block] = map(worker, begin, std::min(begin + grain, n));
+            });
+      for (auto& value : values)
+         init = combine(std::move(init), std::move(value));
+      return init;
+   }
+
+   /**
+    * Returns the number of workers to use for a requested number of threads:
+    * the number of hardware threads if \c numThreads is 0, \c numThreads
+    * otherwise.
+    */
+   static unsigned int resolveNumThreads(unsigned int numThreads);
+
+   /**
+    * Returns the number of threads requested by the environment variable \c
+    * LATNETBUILDER_THREADS, to use when no number of threads is given on the
+    * command line: its value if it is a nonnegative integer (0 meaning the
+    * number of hardware threads, see resolveNumThreads()), 1 otherwise.
+    */
+   static unsigned int defaultNumThreads();
+
+   /**
+    * Returns the pool shared by the parallel parts of the lattice
+    * constructions.  It has defaultNumThreads() workers, hence runs its loops
+    * serially unless \c LATNETBUILDER_THREADS is set, until it is resized with
+    * setGlobalSize().
+    */
+   static ThreadPool& global();
+
+   /**
+    * Returns the process-wide pool of \c numThreads workers (0 for the number
+    * of hardware threads), which is created on the first request and kept
+    * until the end of the process, as the pools of setGlobalSize().  The
+    * searches which run their own loops with a given number of workers use it
+    * instead of creating threads of their own, so that it is the global() pool
+    * when they are given the number of threads of the process.
+    */
+   static ThreadPool& shared(unsigned int numThreads);
+
+   /**
+    * Sets the number of workers of the shared pool.
+    * May be called while other tasks of the process use the shared pool: the
+    * pool of each size is created on the first request and kept until the
+    * end of the process, so that the references returned before by global()
+    * stay valid, and the later calls to global() return the pool of the new
+    * size.
+    * \param numThreads Number of workers, or 0 for the number of hardware threads.
+    */
+   static void setGlobalSize(unsigned int numThreads);
+
+   /**
+    * Sets whether the threads of the pools created afterwards, including the
+    * shared pool resized by the next calls to setGlobalSize(), are pinned to
+    * processors.  If so, the worker of index \f$w \geq 1\f$ runs on the
+    * processor of index \f$w\f$ modulo \f$p\f$ among the \f$p\f$
+    * processors the process may run on; the calling thread, worker 0, keeps its
+    * own affinity.  Pinning keeps each worker on the NUMA node, and in the
+    * caches, where it first wrote its part of the state vectors.  Only
+    * supported on Linux; ignored elsewhere.
+    */
+   static void setPinning(bool pinned);
+
+   /**
+    * Returns \c true if the pools created from now on pin their threads.
+    */
+   static bool pinning();
+
+private:
+   void work(unsigned int worker);
+   void run(unsigned int worker);
+
+   unsigned int m_size;
+   bool m_pinned;
+   std::vector<int> m_processors;
+   std::vector<std::thread> m_threads;
+
+   std::mutex m_mutex;
+   std::condition_variable m_wakeUp;
+   std::condition_variable m_done;
+
+   const Body* m_body;
+   Memory::Component m_component;
+   size_t m_n;
+   std::atomic<size_t> m_next;
+   unsigned long m_generation;
+   unsigned int m_busy;
+   bool m_stop;
+   std::exception_ptr m_exception;
+   std::atomic<bool> m_running;
+};
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Timeline of the phases of the searches, in the trace-event format of Chrome.
+ */
+
+#ifndef LATBUILDER__TRACE_H
+#define LATBUILDER__TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace LatBuilder
+{
+
+/**
+ * Process-wide timeline of the phases of the searches, exported in the
+ * trace-event format of Chrome, which is read by <tt>chrome://tracing</tt>
+ * and by Perfetto.
+ *
+ * Where the profiler (see Profiler) only adds up the time of each phase, the
+ * trace records each instrumented section as a span, with its thread, its
+ * start and its duration, so that the idle times of the workers of the
+ * parallel loops appear on the timeline.
+ *
+ * The trace is disabled by default, in which case each instrumentation point
+ * only costs the test of a flag.  Once started with #start, each thread
+ * appends its spans to a buffer of its own, without synchronization with the
+ * other threads, and the buffers are merged by #write once the traced tasks
+ * are done.
+ *
+ * The instrumented sections, by category, are:
+ * - \c task: the setup of the task, its execution and the writing of its
+ *   output;
+ * - \c search: the coordinates of the component-by-component searches, and
+ *   the batches of candidates evaluated by each worker;
+ * - \c evaluation: the evaluation of the projections of a candidate by
+ *   NetBuilder::FigureOfMerit::ProjectionDependentEvaluator;
+ * - \c fft: the FFT-based products of the fast CBC construction;
+ * - \c executor: the parallel loops of ThreadPool, and the share of each
+ *   worker in them.
+ */
+class Trace {
+public:
+   /**
+    * Records the enclosing scope as a span named \c name of the category \c
+    * category, if the trace is enabled when the scope is entered.
+    *
+    * The name and the category must be string literals, since only their
+    * addresses are recorded.  The span may carry an integer argument, such as
+    * a coordinate or a number of candidates, named \c argName.
+    */
+   class Span {
+   public:
+      Span(const char* name, const char* category, const char* argName = nullptr, long long arg = 0):
+         m_name(name),
+         m_category(category),
+         m_argName(argName),
+         m_arg(arg),
+         m_running(Trace::enabled())
+      { if (m_running) m_start = Clock::now(); }
+
+      ~Span()
+      { if (m_running) Trace::add(m_name, m_category, m_argName, m_arg, m_start, Clock::now()); }
+
+      Span(const Span&) = delete;
+      Span& operator=(const Span&) = delete;
+
+   private:
+      const char* m_name;
+      const char* m_category;
+      const char* m_argName;
+      long long m_arg;
+      bool m_running;
+      std::chrono::steady_clock::time_point m_start;
+   };
+
+   /**
+    * Returns true if the trace is enabled.
+    */
+   static bool enabled()
+   { return s_enabled.load(std::memory_order_relaxed); }
+
+   /**
+    * Discards the recorded spans and starts recording.
+    */
+   static void start();
+
+   /**
+    * Stops recording.  The recorded spans are kept until the next #start.
+    */
+   static void stop();
+
+   /**
+    * Names the calling thread \c name in the trace.
+    */
+   static void setThreadName(const std::string& name);
+
+   /**
+    * Writes the recorded spans to \c fileName as a JSON object in the
+    * trace-event format, with the times in microseconds since #start.
+    *
+    * \throws std::runtime_error if the file cannot be written.
+    */
+   static void write(const std::string& fileName);
+
+private:
+   typedef std::chrono::steady_clock Clock;
+
+   static std::atomic<bool> s_enabled;
+
+   static void add(const char* name, const char* category, const char* argName, long long arg,
+         Clock::time_point start, Clock::time_point end);
+};
+
+}
+
+#endif
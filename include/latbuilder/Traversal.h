@@ -17,7 +17,9 @@
 #ifndef LATBUILDER__TRAVERSAL_H
 #define LATBUILDER__TRAVERSAL_H
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "latbuilder/IndexedIterator.h"
 
@@ -52,6 +54,12 @@ public:
       m_last(offset + size)
    {}
 
+   /**
+    * Returns the index of the first element in the range.
+    */
+   size_type offset() const
+   { return m_first; }
+
    /**
     * Returns the traversal size.
     */
@@ -169,6 +177,26 @@ public:
    const_iterator end() const
    { return const_iterator(seq(), std::min(m_last, (size_type)seq().size())); }
 
+   /**
+    * Returns \c k copies of \c seq whose traversals are consecutive ranges, of
+    * sizes differing by at most one, that together cover the traversal of
+    * \c seq, e.g., to hand disjoint parts of a search to worker threads.
+    * Each part is obtained in constant time from the parameters of \c seq,
+    * and its elements are accessed by index.
+    */
+   std::vector<SEQ> split(size_type k) const
+   {
+      const size_type last = std::min(m_last, (size_type)seq().size());
+      const size_type count = last > m_first ? last - m_first : 0;
+      std::vector<SEQ> parts;
+      parts.reserve(k);
+      for (size_type j = 0; j < k; j++) {
+         const size_type first = m_first + j * count / k;
+         parts.push_back(seq().rebind(Forward(first, m_first + (j + 1) * count / k - first)));
+      }
+      return parts;
+   }
+
 private:
    const SEQ& seq() const
    { return static_cast<const SEQ&>(*this); }
@@ -26,6 +26,7 @@
 #include <boost/numeric/ublas/vector.hpp>
 #include <NTL/GF2X.h>
 #include "latbuilder/ntlwrap.h"
+#include "latbuilder/HugePages.h"
 #include "netbuilder/GeneratingMatrix.h"
 
 
@@ -39,11 +40,30 @@ namespace LatBuilder
 typedef unsigned long uInteger;
 const int LENGTH_UINTEGER = 64;
 
-/// Scalar floating-point type.
+/**
+ * Scalar floating-point type.
+ *
+ * Selected at configure time with <code>waf configure --real</code>, which
+ * defines \c LATNETBUILDER_REAL_FLOAT or \c LATNETBUILDER_REAL_LONG_DOUBLE
+ * and links the FFTW library of the same precision; \c double by default.
+ * Single precision halves the memory used by the states of the fast CBC
+ * constructions, and long double serves to validate the results.
+ */
+#if defined(LATNETBUILDER_REAL_FLOAT)
+typedef float Real;
+#elif defined(LATNETBUILDER_REAL_LONG_DOUBLE)
+typedef long double Real;
+#else
 typedef double Real;
+#endif
 
-/// Vector of floating-point values.
-typedef boost::numeric::ublas::vector<Real> RealVector;
+/**
+ * Vector of floating-point values.
+ *
+ * The vectors of large numbers of points are allocated on huge pages (see
+ * HugePages).
+ */
+typedef boost::numeric::ublas::vector<Real, boost::numeric::ublas::unbounded_array<Real, HugePages::Allocator<Real>>> RealVector;
 
 /// Scalar integer type for level of embedding.
 typedef RealVector::size_type Level;
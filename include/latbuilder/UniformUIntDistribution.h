@@ -18,8 +18,10 @@
 #define LATBUILDER__UNIFORM_UINT_DISTRIBUTION_H
 
 #include <limits>
+#include <algorithm>
 #include <array>
 #include <stdexcept>
+#include <cstddef>
 #include <cstdint>
 
 namespace LatBuilder {
@@ -53,6 +55,39 @@ class UniformUIntDistribution
             }
         }
 
+        /**
+         * Stores in \c out \c n random values, the same as \c n successive
+         * calls to operator()().
+         *
+         * The random words are drawn by batches with \c RAND::fill(), and the
+         * rejected words are skipped without a branch, so that the loop over
+         * a batch can be vectorized when the range is a power of two.
+         */
+        void operator()(RAND& rand, UINTTYPE* out, size_t n)
+        {
+            if (m_range == 0)
+            {
+                std::fill(out, out + n, m_upper);
+                return;
+            }
+            const UINTTYPE reject_limit = rand.max() % m_range;
+            const bool powerOfTwo = (m_range & (m_range - 1)) == 0;
+            std::array<typename RAND::result_type, 64> words;
+            size_t count = 0;
+            while (count < n)
+            {
+                // at most one value per word, so that out is not overrun
+                const size_t size = std::min(n - count, words.size());
+                rand.fill(words.data(), size);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    const UINTTYPE w = words[i];
+                    out[count] = (powerOfTwo ? (w & (m_range - 1)) : (w % m_range)) + m_lower;
+                    count += (w > reject_limit);
+                }
+            }
+        }
+
         void setLowerBound(UINTTYPE a)
         {
             setBounds(a, m_upper);
@@ -93,6 +93,12 @@ T modularPow(T base, uInteger exponent, T modulus)
    return result;
 }
 
+/**
+ * Modular exponentiation of polynomials, carried out on polynomial words (see
+ * PolynomialWordModulus) when the degree of \c modulus is at most 63.
+ */
+Polynomial modularPow(const Polynomial& base, uInteger exponent, const Polynomial& modulus);
+
 /**
  * Prime factorization using the naive "trial division" algorithm.
  *
@@ -135,7 +141,8 @@ uInteger log2Int(unsigned int n);
  * Polynomials will be primitive and irreducible for degree superior to \f$2\f$,
  * irreducible for degree \f$1\f$ and equal to \f$1\f$ for degree \f$0\f$.
  * The current default list goes up to degree 32.
- * Modify <code>data/default_poly.csv</code> to change the default polynomials.
+ * Modify <code>data/default_polys.csv</code> to change the default polynomials;
+ * its binary table <code>default_polys.bin</code> is generated again by the build.
  * @param degree Degree of the default polynomial.
  */ 
 std::string getDefaultPolynomial(unsigned int degree);
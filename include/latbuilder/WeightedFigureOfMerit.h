@@ -22,13 +22,22 @@
 
 #include "latbuilder/Types.h"
 #include "latbuilder/LatDef.h"
+#include "latbuilder/LatView.h"
 #include "latbuilder/Accumulator.h"
 #include "latbuilder/ProjDepMerit/Base.h"
 #include "latbuilder/Functor/AllOf.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/SharedMinimum.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/WeightedProjections.h"
+#include "latbuilder/ProjectionMerits.h"
 
 #include <boost/signals2.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
 #include <vector>
 #include <memory>
 
@@ -95,6 +104,7 @@ public:
          ):
       m_normType(normType),
       m_weights(std::move(weights)),
+      m_weightTable(*m_weights),
       m_projDepMerit(std::move(projdep))
    {}
 
@@ -112,6 +122,13 @@ public:
    const LatticeTester::Weights& weights() const
    { return *m_weights; }
 
+   /**
+    * Returns the precomputed table of the weights of the figure, to look up
+    * the weights of the projections without virtual calls.
+    */
+   const WeightTable& weightTable() const
+   { return m_weightTable; }
+
    /**
     * Returns the projection-dependent figure of merit \f$D_{\mathfrak u}\f$.
     */
@@ -144,6 +161,7 @@ public:
 private:
    Real m_normType;
    std::unique_ptr<LatticeTester::Weights> m_weights;
+   WeightTable m_weightTable;
    PROJDEP m_projDepMerit;
 
    std::ostream& format(std::ostream& os) const
@@ -163,6 +181,24 @@ private:
  * Using an evaluator allows for the WeightedFigureOfMerit object to be
  * instantiated without prior knowledge of the storage class to be used during
  * the evaluation.
+ *
+ * When the projection-dependent figure of merit is concurrent (see
+ * ProjDepMerit::Base::concurrent()) and the shared ThreadPool has more than one
+ * worker, the projections are evaluated concurrently by blocks of a few
+ * projections per worker; the merits of a block are then accumulated in the
+ * usual order, so that the result and the early abortions do not depend on the
+ * number of threads.
+ *
+ * When a shared minimum is set for unilevel lattices and the
+ * projection-dependent figure of merit is bounded by its subprojections (see
+ * ProjDepMerit::Base::boundedBySubProjections()), the merit value of each
+ * projection is first bounded from below by the ones of its subprojections of
+ * one less coordinate, whether they belong to the projections already
+ * evaluated for the same lattice or to the merit values given for the
+ * coordinates selected before (see MeritSeq::CBC).  The evaluation is aborted
+ * without computing the merit values of the next projections, or of the next
+ * block of projections when they are evaluated concurrently, as soon as the
+ * bounds cannot be accepted by the shared minimum.
  */
 template <class FIGURE, LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO >
 class WeightedFigureOfMeritEvaluator
@@ -182,6 +218,7 @@ public:
          ):
       m_onProgress(new OnProgress),
       m_onAbort(new OnAbort),
+      m_sharedMinimum(nullptr),
       m_figure(figure),
       m_storage(std::move(storage)),
       m_eval(m_figure.projDepMerit().evaluator(m_storage))
@@ -214,20 +251,103 @@ public:
    { return *m_onAbort; }
    //@}
 
+   /**
+    * Sets the shared minimum merit value polled after each
+    * projection-dependent contribution to the weighted figure of merit.
+    *
+    * The computation of the figure of merit is aborted as soon as its
+    * cumulative value exceeds the shared minimum, and the progress signal is
+    * no longer emitted.  A \c nullptr restores the progress signal.
+    * Like the signal slots, this is a setting of the evaluator rather than
+    * part of its state, so it can be changed on a constant instance.
+    */
+   void setSharedMinimum(const SharedMinimum* minimum) const
+   { m_sharedMinimum = minimum; }
+
    /**
     * Returns the <strong>square</strong> value of the figure of merit applied
     * to the projections \c projections of the lattice \c lat.
     *
-    * \param lat     Lattice for which the figure of merit will be computed.
+    * \param lat     Lattice for which the figure of merit will be computed,
+    *                 a LatDef or a LatView.
     * \param projections  Set of projections \f$\mathcal J\f$ (see LatticeTester::CoordinateSets).
     * \param initialValue  Initial value to put in the accumulator.
     */
-   template <class CSETS>
+   template <class LAT, class CSETS>
    MeritValue operator() (
-         const LatDef<LR, ET>& lat,
+         const LAT& lat,
          const CSETS& projections,
          MeritValue initialValue
          ) const
+   { return (*this)(lat, WeightedProjections(projections, m_figure.weightTable()), std::move(initialValue)); }
+
+   /**
+    * Returns the <strong>square</strong> value of the figure of merit applied
+    * to the weighted projections \c projections of the lattice \c lat.
+    *
+    * Enumerating the projections once for many lattices, as MeritSeq::CBC
+    * does, saves the lookups of their weights.
+    *
+    * \param lat     Lattice for which the figure of merit will be computed.
+    * \param projections  Projections of nonzero weight, with their weights
+    *                      (computed with the weights of the figure).
+    * \param initialValue  Initial value to put in the accumulator.
+    * \param committedMerits  Projection-dependent merit values of the
+    *                      projections of \c lat which are not in \c
+    *                      projections, used to bound the others, or \c nullptr.
+    */
+   MeritValue operator() (
+         const LatDef<LR, ET>& lat,
+         const WeightedProjections& projections,
+         MeritValue initialValue,
+         const ProjectionMerits* committedMerits = nullptr
+         ) const
+   { return evaluate(lat, projections, std::move(initialValue), committedMerits); }
+
+   /**
+    * Same as above, for a candidate lattice of a CBC exploration, which is
+    * not copied to a lattice definition unless the evaluation is aborted
+    * while the abort signal has slots.
+    */
+   MeritValue operator() (
+         const LatView<LR, ET>& lat,
+         const WeightedProjections& projections,
+         MeritValue initialValue,
+         const ProjectionMerits* committedMerits = nullptr
+         ) const
+   { return evaluate(lat, projections, std::move(initialValue), committedMerits); }
+
+   /**
+    * Stores in \c merits the projection-dependent merit values of the
+    * projections \c projections of the lattice \c lat, if they bound the
+    * ones of the projections of more coordinates (see operator()); does
+    * nothing otherwise.
+    */
+   void recordMerits(
+         const LatDef<LR, ET>& lat,
+         const WeightedProjections& projections,
+         ProjectionMerits& merits
+         ) const
+   {
+      if (not std::is_same<MeritValue, Real>::value or not m_figure.projDepMerit().boundedBySubProjections())
+         return;
+      for (const auto& weightedProj : projections)
+         storeMerit(merits, weightedProj.first, m_eval(lat, weightedProj.first));
+   }
+
+private:
+   /**
+    * Returns the <strong>square</strong> value of the figure of merit applied
+    * to the weighted projections \c projections of the lattice \c lat, a
+    * LatDef or a LatView (see operator()).
+    */
+   template <class LAT>
+   MeritValue evaluate(
+         const LAT& lat,
+         const WeightedProjections& projections,
+         MeritValue initialValue,
+         const ProjectionMerits* committedMerits
+         ) const
    {
    //#define DEBUG
       using namespace LatticeTester;
@@ -239,21 +359,24 @@ public:
 
       auto acc = m_figure.accumulator(std::move(initialValue));
 
-      for (auto cit = projections.begin (); cit != projections.end (); ++cit) {
+      if (boundsProjections()) {
+         evaluateBounded(lat, projections, committedMerits, acc, std::is_same<MeritValue, Real>());
+         return acc.value();
+      }
+
+      if (m_figure.projDepMerit().concurrent() and ThreadPool::global().size() > 1) {
+         evaluateConcurrently(lat, projections, acc);
+         return acc.value();
+      }
+
+      for (const auto& weightedProj : projections) {
 
-         const Coordinates& proj = *cit;
+         const Coordinates& proj = weightedProj.first;
+         const Real weight = weightedProj.second;
 
          if (*proj.rbegin() >= lat.dimension())
             throw std::invalid_argument("WeightedFigureOfMerit: no such projection");
 
-         Real weight = m_figure.weights().getWeight(proj);
-
-         if (weight == 0.0) {
-#ifdef DEBUG
-            std::cout << "  skipping projection: " << proj << std::endl;
-#endif
-            continue;
-         }
 #ifdef DEBUG
          std::cout << "  processing projection: " << proj << std::endl;
          std::cout << "    weight:    " << weight << std::endl;
@@ -269,9 +392,10 @@ public:
          // divide q by the normType of the kernel
          acc.accumulate(weight, merit, m_figure.normType() / m_figure.projDepMerit().power());
 
-         if (!onProgress()(acc.value())) {
+         if (!continueEvaluation(acc.value())) {
             acc.accumulate(std::numeric_limits<Real>::infinity(), merit, m_figure.normType() / m_figure.projDepMerit().power());
-            onAbort()(lat);
+            emitAbort(lat);
+            Profiler::count(Profiler::Counter::EARLY_ABORTS);
 #ifdef DEBUG
             std::cout << "    aborting" << std::endl;
 #endif
@@ -291,9 +415,203 @@ public:
       return acc.value();
    }
 
-private:
+   /**
+    * Returns whether the merit values of the projections are bounded by the
+    * ones of their subprojections before being computed.
+    */
+   bool boundsProjections() const
+   { return std::is_same<MeritValue, Real>::value and m_sharedMinimum and m_figure.projDepMerit().boundedBySubProjections(); }
+
+   static void storeMerit(ProjectionMerits& merits, const LatticeTester::Coordinates& proj, const Real& merit)
+   { merits.insert(proj, merit); }
+
+   static void storeMerit(ProjectionMerits&, const LatticeTester::Coordinates&, const RealVector&)
+   {}
+
+   /**
+    * Returns the largest lower bound on the merit value of the projection \c
+    * proj given by its subprojections of one less coordinate whose merit
+    * value is in \c merits or in \c committedMerits, or 0 if there is none.
+    */
+   Real subProjectionsBound(
+         const LatticeTester::Coordinates& proj,
+         const ProjectionMerits& merits,
+         const ProjectionMerits* committedMerits
+         ) const
+   {
+      Real bound = 0.0;
+      if (proj.size() < 2)
+         return bound;
+      for (const auto coord : proj) {
+         LatticeTester::Coordinates subProj = proj;
+         subProj.erase(coord);
+         Real subMerit;
+         if (merits.find(subProj, subMerit) or (committedMerits and committedMerits->find(subProj, subMerit)))
+            bound = std::max(bound, m_eval.subProjectionBound(proj, subProj, subMerit));
+      }
+      return bound;
+   }
+
+   /**
+    * Accumulates in \c acc the weighted merits of the projections \c
+    * projections of the lattice \c lat, by blocks of projections computed
+    * concurrently by the shared thread pool, or one by one, after checking
+    * that the lower bounds on the merits of each block given by their
+    * subprojections are accepted by the shared minimum (see operator()).
+    */
+   template <class LAT, class ACCUMULATOR>
+   void evaluateBounded(
+         const LAT& lat,
+         const WeightedProjections& projections,
+         const ProjectionMerits* committedMerits,
+         ACCUMULATOR& acc,
+         std::true_type
+         ) const
+   {
+      ThreadPool& pool = ThreadPool::global();
+      const bool concurrent = m_figure.projDepMerit().concurrent() and pool.size() > 1;
+      const size_t blockSize = concurrent ? 4 * static_cast<size_t>(pool.size()) : 1;
+      // divide q by the normType of the kernel
+      const Real power = m_figure.normType() / m_figure.projDepMerit().power();
+
+      ProjectionMerits merits; // of the projections of lat already evaluated
+      std::vector<MeritValue> blockMerits;
+
+      auto blockBegin = projections.begin();
+      while (blockBegin != projections.end()) {
+
+         const auto blockEnd = blockBegin + std::min<size_t>(blockSize, projections.end() - blockBegin);
+         auto bounded = acc;
+         for (auto cit = blockBegin; cit != blockEnd; ++cit) {
+            if (*cit->first.rbegin() >= lat.dimension())
+               throw std::invalid_argument("WeightedFigureOfMerit: no such projection");
+            bounded.accumulate(cit->second, subProjectionsBound(cit->first, merits, committedMerits), power);
+         }
+         if (!continueEvaluation(bounded.value())) {
+            acc.value() = std::numeric_limits<Real>::infinity();
+            emitAbort(lat);
+            Profiler::count(Profiler::Counter::EARLY_ABORTS);
+            return;
+         }
+
+         blockMerits.resize(blockEnd - blockBegin);
+         if (concurrent) {
+            pool.parallelFor(blockMerits.size(), [&](unsigned int, size_t i)
+                  { blockMerits[i] = m_eval(lat, blockBegin[i].first); });
+         }
+         else {
+            blockMerits[0] = m_eval(lat, blockBegin->first);
+         }
+
+         for (size_t i = 0; i < blockMerits.size(); i++) {
+            acc.accumulate(blockBegin[i].second, blockMerits[i], power);
+
+            if (!continueEvaluation(acc.value())) {
+               acc.accumulate(std::numeric_limits<Real>::infinity(), blockMerits[i], power);
+               emitAbort(lat);
+               Profiler::count(Profiler::Counter::EARLY_ABORTS);
+               return;
+            }
+            storeMerit(merits, blockBegin[i].first, blockMerits[i]);
+         }
+         blockBegin = blockEnd;
+      }
+   }
+
+   /**
+    * Never called: the merit values of embedded lattices are not bounded.
+    */
+   template <class LAT, class ACCUMULATOR>
+   void evaluateBounded(
+         const LAT&,
+         const WeightedProjections&,
+         const ProjectionMerits*,
+         ACCUMULATOR&,
+         std::false_type
+         ) const
+   {}
+
+   /**
+    * Accumulates in \c acc the weighted merits of the projections \c
+    * projections of the lattice \c lat, computed concurrently with the shared
+    * thread pool.
+    * The projections are evaluated by blocks, and the cumulative value is
+    * checked after each projection of a block as in the serial evaluation; at
+    * most one block is computed in vain when the evaluation is aborted.
+    */
+   template <class LAT, class ACCUMULATOR>
+   void evaluateConcurrently(
+         const LAT& lat,
+         const WeightedProjections& projections,
+         ACCUMULATOR& acc
+         ) const
+   {
+      ThreadPool& pool = ThreadPool::global();
+      const size_t blockSize = 4 * static_cast<size_t>(pool.size());
+
+      std::vector<MeritValue> merits;
+
+      auto blockBegin = projections.begin();
+      while (blockBegin != projections.end()) {
+
+         const auto blockEnd = blockBegin + std::min<size_t>(blockSize, projections.end() - blockBegin);
+         for (auto cit = blockBegin; cit != blockEnd; ++cit) {
+            if (*cit->first.rbegin() >= lat.dimension())
+               throw std::invalid_argument("WeightedFigureOfMerit: no such projection");
+         }
+
+         merits.resize(blockEnd - blockBegin);
+         pool.parallelFor(merits.size(), [&](unsigned int, size_t i)
+               { merits[i] = m_eval(lat, blockBegin[i].first); });
+
+         for (size_t i = 0; i < merits.size(); i++) {
+            // divide q by the normType of the kernel
+            acc.accumulate(blockBegin[i].second, merits[i], m_figure.normType() / m_figure.projDepMerit().power());
+
+            if (!continueEvaluation(acc.value())) {
+               acc.accumulate(std::numeric_limits<Real>::infinity(), merits[i], m_figure.normType() / m_figure.projDepMerit().power());
+               emitAbort(lat);
+               Profiler::count(Profiler::Counter::EARLY_ABORTS);
+               return;
+            }
+         }
+         blockBegin = blockEnd;
+      }
+   }
+
+   /**
+    * Emits the abort signal for the lattice \c lat.
+    */
+   void emitAbort(const LatDef<LR, ET>& lat) const
+   { onAbort()(lat); }
+
+   /**
+    * Emits the abort signal for the lattice \c lat, which is only copied to
+    * a lattice definition if the signal has slots.
+    */
+   void emitAbort(const LatView<LR, ET>& lat) const
+   {
+      if (not onAbort().empty())
+         onAbort()(lat.latDef());
+   }
+
+   /**
+    * Returns whether the computation must go on with the cumulative value \c
+    * merit, according to the shared minimum if one is set, to the slots of
+    * the progress signal otherwise.
+    */
+   bool continueEvaluation(const Real& merit) const
+   { return m_sharedMinimum ? m_sharedMinimum->accepts(merit) : onProgress()(merit); }
+
+   /**
+    * Emits the progress signal: the shared minimum does not apply to embedded lattices.
+    */
+   bool continueEvaluation(const RealVector& merit) const
+   { return onProgress()(merit); }
+
    std::unique_ptr<OnProgress> m_onProgress;
    std::unique_ptr<OnAbort> m_onAbort;
+   mutable const SharedMinimum* m_sharedMinimum;
 
    const FIGURE& m_figure;
    Storage<LR, ET, COMPRESS, PLO> m_storage;
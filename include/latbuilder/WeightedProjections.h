@@ -0,0 +1,117 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Projections of a weighted figure of merit, with their weights.
+ */
+
+#ifndef LATBUILDER__WEIGHTED_PROJECTIONS_H
+#define LATBUILDER__WEIGHTED_PROJECTIONS_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/WeightTable.h"
+
+#include "latticetester/Coordinates.h"
+#include "latticetester/Weights.h"
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace LatBuilder
+{
+
+/**
+ * Projections of a set of coordinate sets which contribute to a weighted
+ * figure of merit, with their weights.
+ *
+ * The weights are looked up once, when the projections are enumerated, and
+ * the projections of zero weight are dropped, so that the projections can be
+ * evaluated for many lattices without any further lookup (see
+ * WeightedFigureOfMeritEvaluator).
+ *
+ * If a cutoff \f$\epsilon > 0\f$ is set with #setCutoff, the projections of
+ * smallest weights are also dropped, as long as the sum of their weights does
+ * not exceed \f$\epsilon\f$ times the sum of all the weights.  If the
+ * projection-dependent merits are bounded by \f$D\f$, the dropped
+ * contributions are then at most \f$\epsilon D\f$ times the total weight.
+ * The order of the other projections is kept.
+ */
+class WeightedProjections {
+public:
+   typedef std::pair<LatticeTester::Coordinates, Real> value_type;
+   typedef std::vector<value_type>::const_iterator const_iterator;
+
+   WeightedProjections() = default;
+
+   /**
+    * Enumerates the projections \c projections and their weights \c weights.
+    */
+   template <class CSETS>
+   WeightedProjections(const CSETS& projections, const LatticeTester::Weights& weights):
+      WeightedProjections(projections, WeightTable(weights))
+   {}
+
+   /**
+    * Enumerates the projections \c projections and their weights in the
+    * table \c weights, without virtual calls for the usual types of weights.
+    */
+   template <class CSETS>
+   WeightedProjections(const CSETS& projections, const WeightTable& weights)
+   {
+      for (auto cit = projections.begin(); cit != projections.end(); ++cit) {
+         const LatticeTester::Coordinates& proj = *cit;
+         const Real weight = weights.weight(proj);
+         if (weight != 0.0)
+            m_projections.emplace_back(proj, weight);
+      }
+      applyCutoff(cutoff());
+   }
+
+   const_iterator begin() const
+   { return m_projections.begin(); }
+
+   const_iterator end() const
+   { return m_projections.end(); }
+
+   size_t size() const
+   { return m_projections.size(); }
+
+   /**
+    * Returns the relative cutoff of the weights.
+    */
+   static Real cutoff()
+   { return s_cutoff.load(std::memory_order_relaxed); }
+
+   /**
+    * Sets the relative cutoff of the weights for the projections enumerated
+    * afterwards; 0 keeps all the projections of nonzero weight.
+    */
+   static void setCutoff(Real value)
+   { s_cutoff.store(value, std::memory_order_relaxed); }
+
+private:
+   static std::atomic<Real> s_cutoff;
+
+   std::vector<value_type> m_projections;
+
+   void applyCutoff(Real cutoff);
+};
+
+}
+
+#endif
@@ -0,0 +1,108 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__DETAIL__LFSR_JUMP_H
+#define LATBUILDER__DETAIL__LFSR_JUMP_H
+
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace LatBuilder { namespace detail {
+
+/**
+ * Jump-ahead matrices of a component of a combined Tausworthe generator.
+ *
+ * The component with parameters \f$(k, q, s)\f$ has the recurrence
+ * \code
+ * b = ((z << q) ^ z) >> (k - s);
+ * z = ((z & mask) << s) ^ b;
+ * \endcode
+ * where \c mask keeps the \f$k\f$ most significant bits of \c z.  This
+ * transformation of the state is linear over \f$\mathbb F_2\f$; its matrix
+ * \f$T\f$ is stored as the images of the unit vectors, and the matrices
+ * \f$T^{2^e}\f$ are computed by repeated squaring for \f$0 \leq e < k\f$.
+ * Since the characteristic polynomial of the recurrence is primitive of
+ * degree \f$k\f$, \f$T^{2^e} = T^{2^{e \bmod k}}\f$, so that these matrices
+ * are enough to jump \f$2^e\f$ iterations for any \f$e\f$.  Unlike the
+ * hand-coded jumps of the generators, the jumps also give the correct values
+ * of the bits of the state ignored by the recurrence.
+ */
+template <typename UINT>
+class LFSRJump {
+public:
+   static constexpr unsigned int BITS = std::numeric_limits<UINT>::digits;
+
+   typedef std::array<UINT, BITS> Matrix;
+
+   LFSRJump(unsigned int k, unsigned int q, unsigned int s):
+      m_k(k), m_q(q), m_s(s),
+      m_mask(~UINT(0) << (BITS - k)),
+      m_powers(k)
+   {
+      for (unsigned int i = 0; i < BITS; i++)
+         m_powers[0][i] = step(UINT(1) << i);
+      for (unsigned int e = 1; e < k; e++) {
+         for (unsigned int i = 0; i < BITS; i++)
+            m_powers[e][i] = apply(m_powers[e - 1], m_powers[e - 1][i]);
+      }
+   }
+
+   /**
+    * Returns the state \f$2^e\f$ iterations past \c z.
+    */
+   UINT jumpPowerOfTwo(UINT z, unsigned int e) const
+   { return apply(m_powers[e % m_k], z); }
+
+   /**
+    * Returns the state \c n iterations past \c z.
+    */
+   UINT discard(UINT z, unsigned long long n) const
+   {
+      for (unsigned int e = 0; n; e++, n >>= 1) {
+         if (n & 1)
+            z = jumpPowerOfTwo(z, e);
+      }
+      return z;
+   }
+
+private:
+   unsigned int m_k;
+   unsigned int m_q;
+   unsigned int m_s;
+   UINT m_mask;
+   std::vector<Matrix> m_powers;
+
+   UINT step(UINT z) const
+   {
+      const UINT b = ((z << m_q) ^ z) >> (m_k - m_s);
+      return ((z & m_mask) << m_s) ^ b;
+   }
+
+   static UINT apply(const Matrix& m, UINT z)
+   {
+      UINT y = 0;
+      for (unsigned int i = 0; z; i++, z >>= 1) {
+         if (z & 1)
+            y ^= m[i];
+      }
+      return y;
+   }
+};
+
+}}
+
+#endif
@@ -24,17 +24,24 @@
 
 #ifdef FFTWXX_USE_BOOST_VECTOR
 #include <boost/numeric/ublas/vector.hpp>
-#else
-#include <vector>
 #endif
 
 #include <stdexcept>
 #include <complex>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
 #include <fftw3.h>
 
+#include "latbuilder/HugePages.h"
+#include "latbuilder/Profiler.h"
+
 
 /**
- * Wrapper for a subset of FFTW: FFT's for real functions in one dimension.
+ * Wrapper for a subset of FFTW: FFT's for real functions in one or several
+ * dimensions.
  */
 template <typename T>
 struct fftw
@@ -42,7 +49,9 @@ struct fftw
    /**
     * STL allocator replacement using FFTW's memory allocation functions.
     * They ensure proper memory alignment for the use of SIMD processor
-    * instructions.
+    * instructions.  The buffers of at least LatBuilder::HugePages::threshold
+    * bytes are allocated on huge pages instead, whose alignment is also
+    * suitable for FFTW.
     */
    template <typename Tp>
    class allocator
@@ -64,9 +73,21 @@ struct fftw
       ~allocator() throw() { }
 
       pointer allocate(size_type n, const void* = 0)
-      { return static_cast<Tp*>(c_api::malloc(n * sizeof(Tp))); }
+      {
+         const size_t bytes = n * sizeof(Tp);
+         if (bytes >= LatBuilder::HugePages::threshold)
+            return static_cast<Tp*>(LatBuilder::HugePages::allocate(bytes));
+         return static_cast<Tp*>(c_api::malloc(bytes));
+      }
 
-      void deallocate(pointer p, size_type) { c_api::free(p); }
+      void deallocate(pointer p, size_type n)
+      {
+         const size_t bytes = n * sizeof(Tp);
+         if (bytes >= LatBuilder::HugePages::threshold)
+            LatBuilder::HugePages::deallocate(p, bytes);
+         else
+            c_api::free(p);
+      }
 
       constexpr size_type max_size() const throw() { return size_t(-1) / sizeof(Tp); }
 
@@ -113,13 +134,16 @@ struct fftw
       if (result.size() < fft_size(v))
          throw std::invalid_argument("fftw::fft(): result must have size v.size() / 2 + 1");
       // the transform is performed out-of-place, hence the const_cast is safe
-      typename c_api::plan p = c_api::plan_dft_r2c_1d(
-            static_cast<int>(v.size()),
-            const_cast<typename real_vector::value_type*>(&v[0]),
-            &result[0],
-            FFTW_ESTIMATE);
-      c_api::execute(p);
-      c_api::destroy_plan(p);
+      real* in = const_cast<typename real_vector::value_type*>(&v[0]);
+      complex* out = &result[0];
+      const int n = static_cast<int>(v.size());
+      if (c_api::alignment_of(in) == 0 and c_api::alignment_of(reinterpret_cast<real*>(out)) == 0) {
+         c_api::execute_dft_r2c(plans().get(n, true), in, out);
+      }
+      else {
+         // not allocated by FFTW: the cached plans would not apply
+         execute_once([&] { return c_api::plan_dft_r2c_1d(n, in, out, FFTW_ESTIMATE); });
+      }
       return result;
    }
 
@@ -162,13 +186,16 @@ struct fftw
       if (v.size() < fft_size(result))
          throw std::invalid_argument("fftw::ifft(): v must have size result.size() / 2 + 1");
       // the transform is performed out-of-place, hence the const_cast is safe
-      typename c_api::plan p = c_api::plan_dft_c2r_1d(
-            static_cast<int>(result.size()),
-            const_cast<typename complex_vector::value_type*>(&v[0]),
-            &result[0],
-            FFTW_ESTIMATE);
-      c_api::execute(p);
-      c_api::destroy_plan(p);
+      complex* in = const_cast<typename complex_vector::value_type*>(&v[0]);
+      real* out = &result[0];
+      const int n = static_cast<int>(result.size());
+      if (c_api::alignment_of(reinterpret_cast<real*>(in)) == 0 and c_api::alignment_of(out) == 0) {
+         c_api::execute_dft_c2r(plans().get(n, false), in, out);
+      }
+      else {
+         // not allocated by FFTW: the cached plans would not apply
+         execute_once([&] { return c_api::plan_dft_c2r_1d(n, in, out, FFTW_ESTIMATE); });
+      }
       if (normalize) {
          real norm = static_cast<real>(1.0 / result.size());
          for (typename real_vector::iterator it = result.begin(); it != result.end(); ++it)
@@ -198,6 +225,221 @@ struct fftw
       ifft(v, fv, normalize);
       return fv;
    }
+
+   /**
+    * Returns the output size (exact) of the multidimensional real-to-complex
+    * Fourier transform of an array of dimensions \c dims, in row-major
+    * order: only half of the elements (plus one) of the last dimension are
+    * stored.
+    */
+   static typename complex_vector::size_type fft_size(const std::vector<int>& dims)
+   {
+      typename complex_vector::size_type size = 1;
+      for (size_t i = 0; i + 1 < dims.size(); i++)
+         size *= dims[i];
+      return dims.empty() ? size : size * (dims.back() / 2 + 1);
+   }
+
+   /**
+    * Computes the multidimensional real-to-complex Fourier transform of the
+    * array \c v of dimensions \c dims, stored in row-major order, into \c
+    * result, whose expected size is fft_size(dims).
+    */
+   static complex_vector& fft(const std::vector<int>& dims, const real_vector& v, complex_vector& result)
+   {
+      if (dims.size() == 1)
+         return fft(v, result);
+      if (result.size() < fft_size(dims))
+         throw std::invalid_argument("fftw::fft(): result must have size fft_size(dims)");
+      real* in = const_cast<typename real_vector::value_type*>(&v[0]);
+      complex* out = &result[0];
+      if (c_api::alignment_of(in) == 0 and c_api::alignment_of(reinterpret_cast<real*>(out)) == 0) {
+         c_api::execute_dft_r2c(plans().get(dims, true), in, out);
+      }
+      else {
+         execute_once([&] { return c_api::plan_dft_r2c(static_cast<int>(dims.size()), dims.data(), in, out, FFTW_ESTIMATE); });
+      }
+      return result;
+   }
+
+   /**
+    * Computes the multidimensional complex-to-real Fourier transform of \c v
+    * into the array \c result of dimensions \c dims, stored in row-major
+    * order.  The expected size of \c v is fft_size(dims).
+    *
+    * \warning As with all the complex-to-real transforms of FFTW, the
+    * contents of \c v are overwritten.  If normalize is \c false, the
+    * components of \c result must be divided by \c result.size() for proper
+    * normalization.
+    */
+   static real_vector& ifft(const std::vector<int>& dims, const complex_vector& v, real_vector& result, bool normalize=true)
+   {
+      if (dims.size() == 1)
+         return ifft(v, result, normalize);
+      if (v.size() < fft_size(dims))
+         throw std::invalid_argument("fftw::ifft(): v must have size fft_size(dims)");
+      complex* in = const_cast<typename complex_vector::value_type*>(&v[0]);
+      real* out = &result[0];
+      if (c_api::alignment_of(reinterpret_cast<real*>(in)) == 0 and c_api::alignment_of(out) == 0) {
+         c_api::execute_dft_c2r(plans().get(dims, false), in, out);
+      }
+      else {
+         execute_once([&] { return c_api::plan_dft_c2r(static_cast<int>(dims.size()), dims.data(), in, out, FFTW_ESTIMATE); });
+      }
+      if (normalize) {
+         real norm = static_cast<real>(1.0 / result.size());
+         for (typename real_vector::iterator it = result.begin(); it != result.end(); ++it)
+            *it *= norm;
+      }
+      return result;
+   }
+
+   /**
+    * Sets the FFTW planner flags used for the plans created from now on.
+    * The default is \c FFTW_ESTIMATE, which plans almost instantly; \c
+    * FFTW_MEASURE yields faster transforms at the price of a longer planning,
+    * which can be avoided in subsequent runs by saving the wisdom with
+    * export_wisdom().
+    *
+    * Plans are created once for each transform size and direction and reused
+    * by all subsequent transforms.
+    */
+   static void set_planner_flags(unsigned flags)
+   { plans().set_flags(flags); }
+
+   /**
+    * Returns the FFTW planner flags used for new plans.
+    */
+   static unsigned planner_flags()
+   { return plans().flags(); }
+
+   /**
+    * Loads FFTW wisdom from the file \c filename.
+    * Returns \c false if the file could not be read.
+    */
+   static bool import_wisdom(const std::string& filename)
+   {
+      std::lock_guard<std::mutex> lock(plans().mutex());
+      return c_api::import_wisdom_from_filename(filename.c_str()) != 0;
+   }
+
+   /**
+    * Saves the wisdom accumulated by FFTW to the file \c filename.
+    * Returns \c false if the file could not be written.
+    */
+   static bool export_wisdom(const std::string& filename)
+   {
+      std::lock_guard<std::mutex> lock(plans().mutex());
+      return c_api::export_wisdom_to_filename(filename.c_str()) != 0;
+   }
+
+private:
+   /**
+    * Creates a plan with \c make_plan, executes it once and destroys it.
+    *
+    * Used for the arrays not allocated by FFTW, to which the cached plans do
+    * not apply.  The planner is not thread-safe, so that the creation and the
+    * destruction of the plan are serialized with those of plan_cache.
+    */
+   template <typename MAKE_PLAN>
+   static void execute_once(MAKE_PLAN make_plan)
+   {
+      typename c_api::plan p;
+      {
+         std::lock_guard<std::mutex> lock(plans().mutex());
+         p = make_plan();
+      }
+      c_api::execute(p);
+      std::lock_guard<std::mutex> lock(plans().mutex());
+      c_api::destroy_plan(p);
+   }
+
+   /**
+    * Cache of FFTW plans, keyed by transform size, direction and planner flags.
+    *
+    * The plans are created on scratch buffers (planning with \c FFTW_MEASURE
+    * overwrites its arrays) and executed on the arrays of the caller through
+    * FFTW's new-array execute interface, which only requires the arrays to
+    * have the alignment of those allocated by FFTW.  The FFTW planner is not
+    * thread-safe, hence planning is serialized; executing plans is.
+    */
+   class plan_cache
+   {
+   public:
+      ~plan_cache()
+      {
+         for (const auto& p : m_plans)
+            c_api::destroy_plan(p.second);
+         for (const auto& p : m_multiPlans)
+            c_api::destroy_plan(p.second);
+      }
+
+      typename c_api::plan get(int n, bool forward)
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         const auto key = std::make_tuple(n, forward, m_flags);
+         auto it = m_plans.find(key);
+         if (it != m_plans.end()) {
+            Profiler::count(Profiler::Counter::PLAN_CACHE_HITS);
+            return it->second;
+         }
+         Profiler::count(Profiler::Counter::PLAN_CACHE_MISSES);
+         real_vector r(n);
+         complex_vector c(n / 2 + 1);
+         typename c_api::plan p = forward ?
+            c_api::plan_dft_r2c_1d(n, &r[0], &c[0], m_flags) :
+            c_api::plan_dft_c2r_1d(n, &c[0], &r[0], m_flags);
+         m_plans.emplace(key, p);
+         return p;
+      }
+
+      typename c_api::plan get(const std::vector<int>& dims, bool forward)
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         const auto key = std::make_tuple(dims, forward, m_flags);
+         auto it = m_multiPlans.find(key);
+         if (it != m_multiPlans.end()) {
+            Profiler::count(Profiler::Counter::PLAN_CACHE_HITS);
+            return it->second;
+         }
+         Profiler::count(Profiler::Counter::PLAN_CACHE_MISSES);
+         size_t n = 1;
+         for (int k : dims)
+            n *= k;
+         real_vector r(n);
+         complex_vector c(fft_size(dims));
+         const int rank = static_cast<int>(dims.size());
+         typename c_api::plan p = forward ?
+            c_api::plan_dft_r2c(rank, dims.data(), &r[0], &c[0], m_flags) :
+            c_api::plan_dft_c2r(rank, dims.data(), &c[0], &r[0], m_flags);
+         m_multiPlans.emplace(key, p);
+         return p;
+      }
+
+      void set_flags(unsigned flags)
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_flags = flags;
+      }
+
+      unsigned flags() const
+      { return m_flags; }
+
+      std::mutex& mutex()
+      { return m_mutex; }
+
+   private:
+      std::mutex m_mutex;
+      unsigned m_flags = FFTW_ESTIMATE;
+      std::map<std::tuple<int, bool, unsigned>, typename c_api::plan> m_plans;
+      std::map<std::tuple<std::vector<int>, bool, unsigned>, typename c_api::plan> m_multiPlans;
+   };
+
+   static plan_cache& plans()
+   {
+      static plan_cache cache;
+      return cache;
+   }
 };
 
 /**
@@ -224,11 +466,33 @@ struct fftw<float>::c_api
    static plan plan_dft_c2r_1d(int n, complex *in, real *out, unsigned flags)
    { return fftwf_plan_dft_c2r_1d(n, reinterpret_cast<fftwf_complex*>(in), out, flags); }
 
+   static plan plan_dft_r2c(int rank, const int *n, real *in, complex *out, unsigned flags)
+   { return fftwf_plan_dft_r2c(rank, n, in, reinterpret_cast<fftwf_complex*>(out), flags); }
+
+   static plan plan_dft_c2r(int rank, const int *n, complex *in, real *out, unsigned flags)
+   { return fftwf_plan_dft_c2r(rank, n, reinterpret_cast<fftwf_complex*>(in), out, flags); }
+
    static void destroy_plan(plan p)
    { fftwf_destroy_plan(p); }
 
    static void execute(const plan p)
    { return fftwf_execute(p); }
+
+   // new-array execution of a plan created for arrays with the same alignment
+   static void execute_dft_r2c(const plan p, real *in, complex *out)
+   { fftwf_execute_dft_r2c(p, in, reinterpret_cast<fftwf_complex*>(out)); }
+
+   static void execute_dft_c2r(const plan p, complex *in, real *out)
+   { fftwf_execute_dft_c2r(p, reinterpret_cast<fftwf_complex*>(in), out); }
+
+   static int alignment_of(real *p)
+   { return fftwf_alignment_of(p); }
+
+   static int import_wisdom_from_filename(const char *filename)
+   { return fftwf_import_wisdom_from_filename(filename); }
+
+   static int export_wisdom_to_filename(const char *filename)
+   { return fftwf_export_wisdom_to_filename(filename); }
 };
 
 /**
@@ -255,11 +519,86 @@ struct fftw<double>::c_api
    static plan plan_dft_c2r_1d(int n, complex *in, real *out, unsigned flags)
    { return fftw_plan_dft_c2r_1d(n, reinterpret_cast<fftw_complex*>(in), out, flags); }
 
+   static plan plan_dft_r2c(int rank, const int *n, real *in, complex *out, unsigned flags)
+   { return fftw_plan_dft_r2c(rank, n, in, reinterpret_cast<fftw_complex*>(out), flags); }
+
+   static plan plan_dft_c2r(int rank, const int *n, complex *in, real *out, unsigned flags)
+   { return fftw_plan_dft_c2r(rank, n, reinterpret_cast<fftw_complex*>(in), out, flags); }
+
    static void destroy_plan(plan p)
    { fftw_destroy_plan(p); }
 
    static void execute(const plan p)
    { return fftw_execute(p); }
+
+   // new-array execution of a plan created for arrays with the same alignment
+   static void execute_dft_r2c(const plan p, real *in, complex *out)
+   { fftw_execute_dft_r2c(p, in, reinterpret_cast<fftw_complex*>(out)); }
+
+   static void execute_dft_c2r(const plan p, complex *in, real *out)
+   { fftw_execute_dft_c2r(p, reinterpret_cast<fftw_complex*>(in), out); }
+
+   static int alignment_of(real *p)
+   { return fftw_alignment_of(p); }
+
+   static int import_wisdom_from_filename(const char *filename)
+   { return fftw_import_wisdom_from_filename(filename); }
+
+   static int export_wisdom_to_filename(const char *filename)
+   { return fftw_export_wisdom_to_filename(filename); }
+};
+
+/**
+ * Specialization of c_api for \c long \c double precision.
+ */
+template <>
+struct fftw<long double>::c_api
+{
+   typedef long double real;
+   typedef std::complex<long double> complex;
+   typedef fftwl_plan plan;
+
+   static void *malloc(size_t n)
+   { return fftwl_malloc(n); }
+
+   static void free(void *p)
+   { fftwl_free(p); }
+
+   // this works as long as the data in std::complex is [real, imag]
+   static plan plan_dft_r2c_1d(int n, real *in, complex *out, unsigned flags)
+   { return fftwl_plan_dft_r2c_1d(n, in, reinterpret_cast<fftwl_complex*>(out), flags); }
+
+   // this works as long as the data in std::complex is [real, imag]
+   static plan plan_dft_c2r_1d(int n, complex *in, real *out, unsigned flags)
+   { return fftwl_plan_dft_c2r_1d(n, reinterpret_cast<fftwl_complex*>(in), out, flags); }
+
+   static plan plan_dft_r2c(int rank, const int *n, real *in, complex *out, unsigned flags)
+   { return fftwl_plan_dft_r2c(rank, n, in, reinterpret_cast<fftwl_complex*>(out), flags); }
+
+   static plan plan_dft_c2r(int rank, const int *n, complex *in, real *out, unsigned flags)
+   { return fftwl_plan_dft_c2r(rank, n, reinterpret_cast<fftwl_complex*>(in), out, flags); }
+
+   static void destroy_plan(plan p)
+   { fftwl_destroy_plan(p); }
+
+   static void execute(const plan p)
+   { return fftwl_execute(p); }
+
+   // new-array execution of a plan created for arrays with the same alignment
+   static void execute_dft_r2c(const plan p, real *in, complex *out)
+   { fftwl_execute_dft_r2c(p, in, reinterpret_cast<fftwl_complex*>(out)); }
+
+   static void execute_dft_c2r(const plan p, complex *in, real *out)
+   { fftwl_execute_dft_c2r(p, reinterpret_cast<fftwl_complex*>(in), out); }
+
+   static int alignment_of(real *p)
+   { return fftwl_alignment_of(p); }
+
+   static int import_wisdom_from_filename(const char *filename)
+   { return fftwl_import_wisdom_from_filename(filename); }
+
+   static int export_wisdom_to_filename(const char *filename)
+   { return fftwl_export_wisdom_to_filename(filename); }
 };
 
 
@@ -0,0 +1,105 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Binary input of explicit generating matrices.
+ */
+
+#ifndef NETBUILDER__BINARY_INPUT_H
+#define NETBUILDER__BINARY_INPUT_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/GeneratingMatrix.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace NetBuilder {
+
+/**
+ * Read-only view of a net written by BinaryOutput, mapped in memory.
+ *
+ * The header is checked when the file is opened, and the columns are read from the mapped file only when
+ * the generating matrices are created. The matrices with at most GeneratingMatrix::maxPackedCols rows and
+ * columns are built from their columns by transposing a block of words, without setting their elements one by one,
+ * so that nets of large dimension are loaded without parsing.
+ */
+class BinaryInput
+{
+public:
+    /**
+     * Returns \c true if the file \c fileName starts with the magic bytes of the binary format.
+     */
+    static bool isBinary(const std::string& fileName);
+
+    /**
+     * Maps the net stored in \c fileName.
+     * @throws std::runtime_error if the file cannot be mapped, or is not a net of a known version of the format.
+     */
+    explicit BinaryInput(const std::string& fileName);
+
+    BinaryInput(const BinaryInput&) = delete;
+    BinaryInput& operator=(const BinaryInput&) = delete;
+
+    /// Returns the number of generating matrices of the net.
+    Dimension dimension() const { return m_dimension; }
+
+    /// Returns the interlacing factor of the net.
+    unsigned int interlacingFactor() const { return m_interlacingFactor; }
+
+    /// Returns the number of rows of the generating matrices.
+    unsigned int numRows() const { return m_nRows; }
+
+    /// Returns the number of columns of the generating matrices.
+    unsigned int numColumns() const { return m_nCols; }
+
+    /// Returns the merit value stored with the net.
+    Real merit() const { return m_merit; }
+
+    /// Returns the command line stored with the net.
+    const std::string& commandLine() const { return m_commandLine; }
+
+    /**
+     * Returns the generating matrix of coordinate \c coord.
+     */
+    GeneratingMatrix generatingMatrix(Dimension coord) const;
+
+    /**
+     * Returns the generating matrices of all the coordinates.
+     */
+    std::vector<GeneratingMatrix> generatingMatrices() const;
+
+private:
+    boost::interprocess::file_mapping m_file;
+    boost::interprocess::mapped_region m_region;
+    Dimension m_dimension = 0;
+    unsigned int m_interlacingFactor = 1;
+    unsigned int m_nRows = 0;
+    unsigned int m_nCols = 0;
+    unsigned int m_wordsPerColumn = 0;
+    Real m_merit = 0;
+    std::string m_commandLine;
+    const unsigned char* m_columns = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Binary output of the resulting nets.
+ */
+
+#ifndef NETBUILDER__BINARY_OUTPUT_H
+#define NETBUILDER__BINARY_OUTPUT_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/DigitalNet.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace NetBuilder {
+
+/**
+ * Binary output of a net, read without parsing by other programs.
+ *
+ * All the values are little-endian, whatever the platform. The file starts with a header:
+ * - the magic bytes \c LNBN;
+ * - the version of the format, as a 32-bit unsigned integer (currently #version);
+ * - the number of coordinates of the net (that is, the number of components with interlacing),
+ *   the interlacing factor, the number of rows and the number of columns of the generating matrices,
+ *   and the number of words by column, as 32-bit unsigned integers;
+ * - the merit value and the elapsed time of the search in seconds, as 64-bit floating-point numbers;
+ * - the length in bytes of the input command line, as a 32-bit unsigned integer, followed by the command line.
+ *
+ * The generating matrices follow, one after the other, each with its columns one after the other.
+ * A column is stored as words of 32 bits: the element of row \f$i\f$ is the bit of weight
+ * \f$2^{i \bmod 32}\f$ of the word \f$\lfloor i / 32 \rfloor\f$ of the column.
+ *
+ * The version increases when the format changes; readers should reject the versions they do not know.
+ */
+class BinaryOutput
+{
+public:
+    /// Version of the format written by write().
+    static constexpr uint32_t version = 1;
+
+    /**
+     * Writes \c net to the binary stream \c os. The matrices are written one by one, so that only the columns
+     * of one matrix are held in memory.
+     * @param os Binary output stream.
+     * @param net Net to write.
+     * @param merit Merit value of the net.
+     * @param elapsed Elapsed time of the search in seconds.
+     * @param interlacingFactor Interlacing factor of the net.
+     * @param commandLine Input command line.
+     * @throws std::runtime_error if the net cannot be written.
+     */
+    static void write(std::ostream& os, const AbstractDigitalNet& net, Real merit, double elapsed,
+                      unsigned int interlacingFactor = 1, const std::string& commandLine = "");
+};
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Index-based generation of the points of digital nets, callable from device code.
+ */ 
+
+#ifndef NETBUILDER__DEVICE_POINTS_H
+#define NETBUILDER__DEVICE_POINTS_H
+
+#include "netbuilder/PointGenerator.h"
+
+#include "latbuilder/DevicePoints.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace NetBuilder { namespace Device {
+
+/**
+ * Description of a digital net point set in base 2 that can be copied as is to the memory of a device.
+ * 
+ * The arrays are not owned: \c prefixColumns holds <code>numColumns * dimension</code> words laid out
+ * as DigitalNetPointGenerator::prefixColumns(), and \c digitalShift holds <code>dimension</code> words
+ * with the first digit in the most significant bit, or is null for no digital shift.
+ */ 
+struct DigitalNetPointLayout
+{
+    uint64_t numPoints;
+    uint32_t dimension;
+    uint32_t numColumns;
+    const uint64_t* prefixColumns;
+    const uint64_t* digitalShift;
+};
+
+/**
+ * Returns the layout of the points of \c generator with the digital shift \c digitalShift, with arrays that point
+ * to the memory of \c generator and \c digitalShift. 
+ * 
+ * To generate the points on a device, copy the arrays to the device and replace the pointers of the layout with the
+ * device addresses; only \f$O(ms)\f$ words are transferred and the points are produced directly in device buffers.
+ * @param generator Point generator of the net.
+ * @param digitalShift Digital shift with one word by coordinate, or empty for no shift. It must outlive the layout.
+ */ 
+inline DigitalNetPointLayout hostLayout(const DigitalNetPointGenerator& generator, const std::vector<uint64_t>& digitalShift = {})
+{
+    if (!digitalShift.empty() && digitalShift.size() != generator.dimension())
+    {
+        throw std::invalid_argument("The dimension of the digital shift does not match the dimension of the points.");
+    }
+    return DigitalNetPointLayout{
+        uint64_t(generator.numPoints()),
+        uint32_t(generator.dimension()),
+        generator.numColumns(),
+        generator.prefixColumns().data(),
+        digitalShift.empty() ? nullptr : digitalShift.data()};
+}
+
+/**
+ * Returns the position of the lowest set bit of \c x, which must not be zero.
+ */ 
+LATBUILDER_HOST_DEVICE inline unsigned int lowestSetBit64(uint64_t x)
+{
+#if defined(__CUDA_ARCH__)
+    return (unsigned int) (__ffsll((long long) x) - 1);
+#elif defined(__GNUC__)
+    return (unsigned int) __builtin_ctzll(x);
+#else
+    unsigned int r = 0;
+    while (!(x & 1)) { x >>= 1; ++r; }
+    return r;
+#endif
+}
+
+/**
+ * Returns the column \c k of the interlaced matrix of coordinate \c j.
+ */ 
+LATBUILDER_HOST_DEVICE inline uint64_t column(const DigitalNetPointLayout& layout, unsigned int k, uint32_t j)
+{
+    const uint64_t* prefix = layout.prefixColumns + k * layout.dimension + j;
+    return k > 0 ? prefix[0] ^ prefix[-(long) layout.dimension] : prefix[0];
+}
+
+/**
+ * Returns the digits of the coordinate \c j of the digitally shifted point of index \c i, in the natural order,
+ * with the first digit in the most significant bit. The value is identical to the one of DigitalNetPointGenerator.
+ */ 
+LATBUILDER_HOST_DEVICE inline uint64_t digits(const DigitalNetPointLayout& layout, uint64_t i, uint32_t j)
+{
+    uint64_t point = layout.digitalShift ? layout.digitalShift[j] : 0;
+    for (unsigned int k = 0; k < layout.numColumns && (i >> k); ++k)
+    {
+        if ((i >> k) & 1)
+        {
+            point ^= column(layout, k, j);
+        }
+    }
+    return point;
+}
+
+/**
+ * Returns the digits of the coordinate \c j of the \f$i\f$-th point in the Gray code order, that is, of the point
+ * of index \f$i \oplus \lfloor i/2 \rfloor\f$.
+ */ 
+LATBUILDER_HOST_DEVICE inline uint64_t grayCodeDigits(const DigitalNetPointLayout& layout, uint64_t i, uint32_t j)
+{ return digits(layout, i ^ (i >> 1), j); }
+
+/// Converts the digits of a coordinate to a double-precision number in \f$[0,1)\f$.
+LATBUILDER_HOST_DEVICE inline void storeDigits(uint64_t point, double* out)
+{ *out = (double) (point >> 11) * (1.0 / 9007199254740992.0); }
+
+/// Stores the first 32 digits of a coordinate.
+LATBUILDER_HOST_DEVICE inline void storeDigits(uint64_t point, uint32_t* out)
+{ *out = (uint32_t) (point >> 32); }
+
+/**
+ * Writes the coordinates of the points of indices \c first to <code>first + count - 1</code> to \c out,
+ * one point after the other, for a thread that processes a block of consecutive points.
+ * 
+ * Only the first point is computed from its index. In the natural order, each next point is obtained with one XOR
+ * of a prefix column by coordinate, as in DigitalNetPointGenerator; with \c grayCode set, the \f$i\f$-th point is
+ * the one of grayCodeDigits() and is obtained with one XOR of a column by coordinate. The coordinates are processed
+ * one after the other so that no per-coordinate state has to be allocated on the device.
+ * \c T is \c double or \c uint32_t.
+ */ 
+template <typename T>
+LATBUILDER_HOST_DEVICE void generateDigitalNetPoints(const DigitalNetPointLayout& layout, uint64_t first, uint64_t count, T* out, bool grayCode = false)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    for (uint32_t j = 0; j < layout.dimension; ++j)
+    {
+        uint64_t point = grayCode ? grayCodeDigits(layout, first, j) : digits(layout, first, j);
+        T* dest = out + j;
+        for (uint64_t i = first; ; dest += layout.dimension)
+        {
+            storeDigits(point, dest);
+            if (++i == first + count)
+            {
+                break;
+            }
+            const unsigned int k = lowestSetBit64(i);
+            point ^= grayCode ? column(layout, k, j) : layout.prefixColumns[k * layout.dimension + j];
+        }
+    }
+}
+
+/**
+ * Draws a random digital shift with \c dimension coordinates from the 64-bit generator \c rng (for instance
+ * LatBuilder::LFSR258), with the first digit in the most significant bit.
+ */ 
+template <class RNG>
+std::vector<uint64_t> randomDigitalShift(Dimension dimension, RNG& rng)
+{
+    std::vector<uint64_t> shift(dimension);
+    for (auto& word : shift)
+    {
+        word = (uint64_t) rng();
+    }
+    return shift;
+}
+
+}}
+
+#endif
@@ -59,12 +59,15 @@
 #define NETBUILDER__DIGITAL_NET_H
 
 #include "latbuilder/Util.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/ThreadPool.h"
 
 #include "netbuilder/Types.h"
 #include "netbuilder/GeneratingMatrix.h"
 #include "netbuilder/NetConstructionTraits.h"
 
 #include <memory>
+#include <ostream>
 #include <sstream>
 #include <stdexcept>
 
@@ -131,16 +134,28 @@ class AbstractDigitalNet
          */
         const GeneratingMatrix& generatingMatrix(Dimension coord) const 
         {
-            return *m_generatingMatrices[coord];
+            return (coord < m_prefixDimension) ? m_prefix->generatingMatrix(coord) : *m_generatingMatrices[coord - m_prefixDimension];
         }
 
         /**
          * Formats the net for output.
-         * @param outputFormat Format of output.
+         * @param outputStyle Specific Format of output Machine format.
          * @param interlacingFactor Interlacing factor of the net.
+         */ 
+        std::string format(OutputStyle outputStyle = OutputStyle::TERMINAL, unsigned int interlacingFactor = 1) const
+        {
+            std::ostringstream stream;
+            format(stream, outputStyle, interlacingFactor);
+            return stream.str();
+        }
+
+        /**
+         * Writes the net formatted for output to \c os, without building the whole description as a string.
+         * @param os Output stream.
          * @param outputStyle Specific Format of output Machine format.
+         * @param interlacingFactor Interlacing factor of the net.
          */ 
-        virtual std::string format(OutputStyle outputStyle = OutputStyle::TERMINAL, unsigned int interlacingFactor = 1) const = 0;
+        virtual void format(std::ostream& os, OutputStyle outputStyle = OutputStyle::TERMINAL, unsigned int interlacingFactor = 1) const = 0;
 
         /** 
          * Returns a bool indicating whether the net can be viewed as a digital sequence.
@@ -154,6 +169,8 @@ class AbstractDigitalNet
         unsigned int m_nCols; // number of columns in generating matrices
         mutable std::vector<std::shared_ptr<GeneratingMatrix>> m_generatingMatrices; // vector of shared pointers to the generating matrices
         // The generating matrix class is defined in GeneratingMatrix.h.
+        const AbstractDigitalNet* m_prefix = nullptr; // net holding the generating matrices of the first coordinates, if any
+        Dimension m_prefixDimension = 0; // number of coordinates whose generating matrices are held by m_prefix
 
         /** 
          * Most general constructor. Designed to be used by derived classes. 
@@ -178,6 +195,9 @@ class AbstractDigitalNet
  * It is templated by a NetConstructionTraits, which describes the construction method.
  * @see NetBuilder::NetConstructionTraits
  */ 
+template <NetConstruction NC>
+class DigitalNetCandidate;
+
 template <NetConstruction NC>
 class DigitalNet : public AbstractDigitalNet
 {
@@ -198,7 +218,9 @@ class DigitalNet : public AbstractDigitalNet
 
         /** 
          * Construction of a net from its size parameter and generating values.
-         * This operation computes and stores the generating matrices of the net.
+         * This operation computes and stores the generating matrices of the net. If the construction method
+         * allows it, the matrices of nets of large dimension are computed concurrently by the shared thread pool
+         * (see LatBuilder::ThreadPool::global()).
          * @param dimension Dimension of the net.
          * @param sizeParameter Size parameter of the net.
          * @param genValues Sequence of generating values to create the net.
@@ -210,14 +232,28 @@ class DigitalNet : public AbstractDigitalNet
                 AbstractDigitalNet(dimension, ConstructionMethod::nRows(sizeParameter), ConstructionMethod::nCols(sizeParameter)),
                 m_sizeParameter(std::move(sizeParameter))
         {
+            m_generatingMatrices.resize(genValues.size());
+            // construct the generating matrix of coordinate j, which is also the index used for creating JoeKuo nets
+            auto createMatrix = [this, &genValues](unsigned int, size_t j)
+            {
+                m_generatingMatrices[j].reset(ConstructionMethod::createGeneratingMatrix(genValues[j], m_sizeParameter, (Dimension) j));
+            };
+            if (ConstructionMethod::concurrentConstruction && genValues.size() >= minConcurrentDimension)
+            {
+                LatBuilder::ThreadPool::global().parallelFor(genValues.size(), createMatrix);
+            }
+            else
+            {
+                for(size_t j = 0; j < genValues.size(); ++j)
+                {
+                    createMatrix(0, j);
+                }
+            }
+
             m_genValues.reserve(m_dimension);
-            Dimension dimension_j = 0; //index of the dimension of the net, used for creating JoeKuo net 
-            for(const auto& genValue : genValues)
+            for(auto& genValue : genValues)
             {
-                // construct the generating matrix and store them and the generating values
-                m_generatingMatrices.push_back(std::shared_ptr<GeneratingMatrix>(ConstructionMethod::createGeneratingMatrix(genValue,m_sizeParameter,dimension_j)));
                 m_genValues.push_back(std::shared_ptr<GenValue>(new GenValue(std::move(genValue))));
-                dimension_j++;
             }
         }
 
@@ -239,6 +275,7 @@ class DigitalNet : public AbstractDigitalNet
         ~DigitalNet() = default;
 
         /** Adds a new coordinate at the end of a digital net using the generating value \c newGenValue. 
+         * To evaluate candidate extensions of the net without copying its coordinates, see DigitalNetCandidate.
          * Note that the resources (generating matrices, generatins values and computation data) for the lower dimensions are not copied. The net on 
          * which this method is called and the new net share these resources.
          * @param newGenValue  Generating value used to extend the net.
@@ -264,54 +301,52 @@ class DigitalNet : public AbstractDigitalNet
         /**
          * {@inheritDoc}
          */ 
-        virtual std::string format(OutputStyle outputStyle = OutputStyle::TERMINAL, unsigned int interlacingFactor = 1) const
+        virtual void format(std::ostream& os, OutputStyle outputStyle = OutputStyle::TERMINAL, unsigned int interlacingFactor = 1) const override
         {   
-            std::string res;
-
             if (outputStyle == OutputStyle::TERMINAL){
-                std::ostringstream stream;
-                stream << numColumns() << "  // Number of columns" << std::endl;
-                stream << numRows() << "  // Number of rows" << std::endl;
-                stream << numPoints() << "  // Number of points" << std::endl;
-                stream << dimension() / interlacingFactor << "  // Dimension of points" << std::endl;
+                os << numColumns() << "  // Number of columns" << std::endl;
+                os << numRows() << "  // Number of rows" << std::endl;
+                os << numPoints() << "  // Number of points" << std::endl;
+                os << dimension() / interlacingFactor << "  // Dimension of points" << std::endl;
                 if (interlacingFactor > 1){
-                    stream << interlacingFactor << "  // Interlacing factor" << std::endl;
-                    stream << dimension() << "  // Number of components = interlacing factor x dimension" << std::endl;
+                    os << interlacingFactor << "  // Interlacing factor" << std::endl;
+                    os << dimension() << "  // Number of components = interlacing factor x dimension" << std::endl;
                 }
-                res+=stream.str();
             }
 
             else if (outputStyle == OutputStyle::NET) {
-                std::string dimension_as_str = std::to_string(dimension() / interlacingFactor);
-                std::string nb_col_as_str = std::to_string(numColumns());
-                res += "# Parameters for a digital net in base 2\n";
-                res += dimension_as_str + "    # s = " + dimension_as_str + " dimensions\n";
+                const Dimension dimensionOfPoints = dimension() / interlacingFactor;
+                os << "# Parameters for a digital net in base 2\n";
+                os << dimensionOfPoints << "    # s = " << dimensionOfPoints << " dimensions\n";
                 if (interlacingFactor > 1){
-                    res += std::to_string(interlacingFactor) + "    # Interlacing factor" + "\n";
-                    res += std::to_string(dimension()) + "    # Number of components = interlacing factor x dimension" + "\n";
+                    os << interlacingFactor << "    # Interlacing factor" << "\n";
+                    os << dimension() << "    # Number of components = interlacing factor x dimension" << "\n";
                 }
-                res += nb_col_as_str + "    # k = " + nb_col_as_str + ",  n = 2^"+ nb_col_as_str + " = "; 
-                res += std::to_string(numPoints()) + " points\n";
-                res += "31    # r = 31 binary output digits\n";
+                os << numColumns() << "    # k = " << numColumns() << ",  n = 2^" << numColumns() << " = "; 
+                os << numPoints() << " points\n";
+                os << "31    # r = 31 binary output digits\n";
                 if (interlacingFactor == 1){
-                    res += "# Columns of gen. matrices C_1,...,C_s, one matrix per line\n";
+                    os << "# Columns of gen. matrices C_1,...,C_s, one matrix per line\n";
                 }
                 else {
-                    res += "# Columns of gen. matrices C_1,...,C_{ds}, one matrix per line\n";
+                    os << "# Columns of gen. matrices C_1,...,C_{ds}, one matrix per line\n";
                 }
                 for(unsigned int coord = 0; coord < m_genValues.size(); coord++)
                 {
-                    res += ConstructionMethod::createGeneratingMatrix(*(m_genValues[coord]), m_sizeParameter, coord, 31)->formatToColumnsReverse();
-                    res += "\n";
+                    if (coord > 0){
+                        os << "\n";
+                    }
+                    // the matrices are written one at a time
+                    std::unique_ptr<GeneratingMatrix> matrix(ConstructionMethod::createGeneratingMatrix(*(m_genValues[coord]), m_sizeParameter, coord, 31));
+                    matrix->formatToColumnsReverse(os);
                 }
-                res.pop_back();
             }
 
-            res += ConstructionMethod::format(m_generatingMatrices, m_genValues, m_sizeParameter, outputStyle, interlacingFactor);
-
-            return res;
+            ConstructionMethod::format(os, m_generatingMatrices, m_genValues, m_sizeParameter, outputStyle, interlacingFactor);
         }
 
+        using AbstractDigitalNet::format;
+
         /**
          * {@inheritDoc}
          */ 
@@ -321,9 +356,35 @@ class DigitalNet : public AbstractDigitalNet
         }
 
         SizeParameter sizeParameter() const { return m_sizeParameter ; }
+
+        /**
+         * Returns the generating value of coordinate \c coord.
+         */
+        const GenValue& generatingValue(Dimension coord) const { return *m_genValues[coord]; }
+
+        /**
+         * Returns the net made of the first \c dimension coordinates of the net. The new net shares the
+         * generating matrices and the generating values of the net, so that nothing is recomputed.
+         * @param dimension Dimension of the new net, at most the dimension of the net.
+         */
+        std::unique_ptr<DigitalNet<NC>> restriction(Dimension dimension) const
+        {
+            if (dimension > m_dimension)
+            {
+                throw std::invalid_argument("DigitalNet: the restriction cannot have more coordinates than the net");
+            }
+            std::vector<std::shared_ptr<GenValue>> genVals(m_genValues.begin(), m_genValues.begin() + dimension);
+            std::vector<std::shared_ptr<GeneratingMatrix>> genMats(m_generatingMatrices.begin(), m_generatingMatrices.begin() + dimension);
+            return std::unique_ptr<DigitalNet<NC>>(new DigitalNet<NC>(dimension, m_sizeParameter, std::move(genVals), std::move(genMats)));
+        }
     
     private:
 
+        /// Smallest number of coordinates for which the generating matrices are computed concurrently.
+        static constexpr size_t minConcurrentDimension = 64;
+
+        friend class DigitalNetCandidate<NC>;
+
         SizeParameter m_sizeParameter; // size parameter of the net
         std::vector<std::shared_ptr<GenValue>> m_genValues; // vector of shared pointers to the generating values of the net
 
@@ -344,6 +405,105 @@ class DigitalNet : public AbstractDigitalNet
                 m_genValues(std::move(genValues))
         {};
 };
+
+/** View of a digital net extended by one coordinate, used to evaluate the candidates of CBC explorations.
+ * 
+ * The candidate refers to the generating matrices of the base net for the previous coordinates and only holds 
+ * the generating value and the generating matrix of the new coordinate, so that constructing it does not copy the
+ * coordinates of the base net. The candidate is materialized with #materialize as the same DigitalNet as the one returned by
+ * DigitalNet::appendNewCoordinate, for instance when an observer keeps it. The base net must outlive the candidate.
+ */ 
+template <NetConstruction NC>
+class DigitalNetCandidate : public AbstractDigitalNet
+{
+    public:
+
+        typedef typename DigitalNet<NC>::ConstructionMethod ConstructionMethod;
+        typedef typename DigitalNet<NC>::GenValue GenValue;
+
+        /**
+         * Constructs the extension of the net \c baseNet by a coordinate with generating value \c newGenValue.
+         * This computes the generating matrix of the new coordinate.
+         * @param baseNet Net to extend.
+         * @param newGenValue Generating value of the new coordinate.
+         */ 
+        DigitalNetCandidate(const DigitalNet<NC>& baseNet, GenValue newGenValue):
+            AbstractDigitalNet(baseNet.dimension() + 1, baseNet.numRows(), baseNet.numColumns()),
+            m_baseNet(&baseNet),
+            m_genValue(std::move(newGenValue))
+        {
+            LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::CANDIDATE_CONSTRUCTION);
+            m_prefix = m_baseNet;
+            m_prefixDimension = m_baseNet->dimension();
+            m_generatingMatrices.push_back(std::shared_ptr<GeneratingMatrix>(ConstructionMethod::createGeneratingMatrix(m_genValue, m_baseNet->m_sizeParameter, m_prefixDimension)));
+        }
+
+        /**
+         * Constructs the extension of the net \c baseNet by a coordinate with generating value \c newGenValue, 
+         * writing the generating matrix of the new coordinate in \c buffer. The matrix held by \c buffer is reused
+         * if no other object shares it (for instance a net materialized from a previous candidate), and
+         * \c buffer is set to a new matrix otherwise.
+         * @param baseNet Net to extend.
+         * @param newGenValue Generating value of the new coordinate.
+         * @param buffer Caller-owned generating matrix.
+         */ 
+        DigitalNetCandidate(const DigitalNet<NC>& baseNet, GenValue newGenValue, std::shared_ptr<GeneratingMatrix>& buffer):
+            AbstractDigitalNet(baseNet.dimension() + 1, baseNet.numRows(), baseNet.numColumns()),
+            m_baseNet(&baseNet),
+            m_genValue(std::move(newGenValue))
+        {
+            LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::CANDIDATE_CONSTRUCTION);
+            m_prefix = m_baseNet;
+            m_prefixDimension = m_baseNet->dimension();
+            if (!buffer || buffer.use_count() > 1)
+            {
+                buffer = std::make_shared<GeneratingMatrix>(0, 0);
+            }
+            ConstructionMethod::fillGeneratingMatrix(m_genValue, m_baseNet->m_sizeParameter, *buffer, m_prefixDimension);
+            m_generatingMatrices.push_back(buffer);
+        }
+
+        /**
+         * Returns the generating value of the new coordinate.
+         */ 
+        const GenValue& newGeneratingValue() const { return m_genValue; }
+
+        /**
+         * Returns the extended net as a DigitalNet, which shares the resources of the base net and the generating matrix of the candidate.
+         */ 
+        std::unique_ptr<DigitalNet<NC>> materialize() const
+        {
+            auto genMats = m_baseNet->m_generatingMatrices;
+            genMats.push_back(m_generatingMatrices.front());
+
+            auto genVals = m_baseNet->m_genValues;
+            genVals.push_back(std::make_shared<GenValue>(m_genValue));
+
+            return std::unique_ptr<DigitalNet<NC>>(new DigitalNet<NC>(m_dimension, m_baseNet->m_sizeParameter, std::move(genVals), std::move(genMats)));
+        }
+
+        /**
+         * {@inheritDoc}
+         */ 
+        virtual void format(std::ostream& os, OutputStyle outputStyle = OutputStyle::TERMINAL, unsigned int interlacingFactor = 1) const override
+        {
+            materialize()->format(os, outputStyle, interlacingFactor);
+        }
+
+        using AbstractDigitalNet::format;
+
+        /**
+         * {@inheritDoc}
+         */ 
+        virtual bool isSequenceViewable() const 
+        {
+            return ConstructionMethod::isSequenceViewable;
+        }
+
+    private:
+        const DigitalNet<NC>* m_baseNet; // net extended by the candidate
+        GenValue m_genValue; // generating value of the new coordinate
+};
 }
 
 #endif
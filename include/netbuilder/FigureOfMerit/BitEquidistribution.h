@@ -21,6 +21,8 @@
 #include "netbuilder/Helpers/RankComputer.h"
 #include "netbuilder/FigureOfMerit/LevelCombiner.h"
 
+#include <algorithm>
+
 
 namespace NetBuilder { namespace FigureOfMerit {
 
@@ -117,8 +119,7 @@ class BitEquidistribution : public CBCFigureOfMerit{
                 BitEquidistributionEvaluator(BitEquidistribution* figure):
                     m_figure(figure),
                     m_tmpRankComputer(m_figure->nbBits()),
-                    m_memRankComputer(m_figure->nbBits()),
-                    m_newRankComputer(m_figure->nbBits())
+                    m_memRankComputer(m_figure->nbBits())
                 {};
 
                 /** 
@@ -141,7 +142,6 @@ class BitEquidistribution : public CBCFigureOfMerit{
                 {
                     m_tmpRankComputer.reset(0);
                     m_memRankComputer.reset(0);
-                    m_newRankComputer = m_memRankComputer;
                 }
 
                 /**
@@ -149,7 +149,7 @@ class BitEquidistribution : public CBCFigureOfMerit{
                  */  
                 virtual void lastNetWasBest() override
                 {
-                    m_tmpRankComputer = std::move(m_newRankComputer);
+                    m_tmpRankComputer = m_memRankComputer;
                 }
                 
                 /**
@@ -160,13 +160,13 @@ class BitEquidistribution : public CBCFigureOfMerit{
                 virtual void prepareForNextDimension() override
                 {
                     m_memRankComputer = m_tmpRankComputer;
+                    m_memRankComputer.checkpoint();
                 }
 
             private:
                 BitEquidistribution* m_figure; // pointer to the figure of merit
                 RankComputer m_tmpRankComputer; // contains the reduction for the best net so far
-                RankComputer m_memRankComputer; // contains the reduction for the best net of the previous dimension
-                RankComputer m_newRankComputer; // contains the reduction for the latest evaluated net
+                RankComputer m_memRankComputer; // contains the reduction for the latest evaluated net, with a checkpoint at the reduction for the best net of the previous dimension
 
         };
 
@@ -212,26 +212,30 @@ MeritValue BitEquidistribution<EmbeddingType::UNILEVEL>::BitEquidistributionEval
     if (dimension==0)
     {
         m_memRankComputer.reset(nCols); // if the dimension is the first dimension, initiate the data structure
+        m_memRankComputer.checkpoint();
+    }
+    else
+    {
+        m_memRankComputer.rollback(); // go back to the reduction of the best net for the previous dimension
     }
 
     auto acc = m_figure->accumulator(std::move(initialValue)); // create the accumulator from the initial value
 
-    m_newRankComputer = m_memRankComputer; // copy the reduction of the best net for the previous dimension
-
     for(unsigned int bit = 0; bit < m_figure->nbBits(); ++bit) // for each bit of equidistribution
     {
-        m_newRankComputer.addRow(net.generatingMatrix(dimension).subMatrix(bit, 0, 1, nCols )); // add the new row
-        if (m_newRankComputer.computeRank() < m_newRankComputer.numRows())
+        m_memRankComputer.addRow(net.generatingMatrix(dimension), bit); // add the new row
+        if (m_memRankComputer.computeRank() < m_memRankComputer.numRows())
         {
             acc.accumulate(m_figure->weight(), 1, m_figure->expNorm()); // the points are not equidistributed: set the merit
             break;
         }
     }
 
-    if(!onProgress()(acc.value())) // if someone is listening, may tell that the computation is useless
+    if(!continueEvaluation(acc.value())) // if someone is listening, may tell that the computation is useless
     {
         acc.accumulate(std::numeric_limits<Real>::infinity(), 1, 1); // set the merit to infinity
         onAbort()(net); // abort the computation
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::EARLY_ABORTS);
     }
 
     return acc.value();
@@ -247,28 +251,31 @@ MeritValue BitEquidistribution<EmbeddingType::MULTILEVEL>::BitEquidistributionEv
     if (dimension==0) // if the dimension is the first dimension, initiate the data structure
     {
         m_memRankComputer.reset(nCols);
+        m_memRankComputer.checkpoint();
+    }
+    else
+    {
+        m_memRankComputer.rollback(); // go back to the reduction of the best net for the previous dimension
     }
 
     auto acc = m_figure->accumulator(std::move(initialValue)); // create the accumulator from the initial value
 
-    m_newRankComputer = m_memRankComputer; // copy the reduction of the best net for the previous dimension
-
     std::vector<unsigned int> merits(nCols,0);
 
     for(unsigned int bit = 0; bit < m_figure->nbBits(); ++bit) // for each bit of equidistribution
     {
-        m_newRankComputer.addRow(net.generatingMatrix(dimension).subMatrix(bit, 0, 1, nCols )); // add the new row
-        std::vector<unsigned int> ranks = m_newRankComputer.computeRanks(0,nCols); // compute the rank
+        m_memRankComputer.addRow(net.generatingMatrix(dimension), bit); // add the new row
 
-        for(unsigned int m = 1; m <= nCols; ++m) // for each level of points
+        // the first m columns have full row-rank if and only if m is at least the smallest full rank,
+        // so the levels which could have been equidistributed but are not form a range
+        const unsigned int firstLevel = std::max(m_memRankComputer.numRows(), 1u);
+        const unsigned int endLevel = std::min(m_memRankComputer.smallestFullRank(), nCols + 1);
+        for(unsigned int m = firstLevel; m < endLevel; ++m) // for each level of points
         {
-            if (m >= m_newRankComputer.numRows() && ranks[m-1] <  m_newRankComputer.numRows() ) // if the system is not full row-rank and could have been
-            {
-                merits[m-1] = 1; // the points could have been equidistributed but are not: put the merit to 1
-            }
+            merits[m-1] = 1; // the points could have been equidistributed but are not: put the merit to 1
         }
 
-        if (ranks[nCols-1] < nCols)
+        if (m_memRankComputer.computeRank() < nCols)
         {
             break; // if even the system with most columns is not invertible, stop the computation
         }
@@ -281,10 +288,11 @@ MeritValue BitEquidistribution<EmbeddingType::MULTILEVEL>::BitEquidistributionEv
         acc.accumulate(m_figure->weight(), merit, m_figure->expNorm()); // accumulate the merit
     }
     
-    if(!onProgress()(acc.value())) // if someone is listening, may tell that the computation is useless
+    if(!continueEvaluation(acc.value())) // if someone is listening, may tell that the computation is useless
     {
         acc.accumulate(std::numeric_limits<Real>::infinity(), 1, 1); // set the merit to infinity
         onAbort()(net); // abort the computation
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::EARLY_ABORTS);
     }
 
     return acc.value();
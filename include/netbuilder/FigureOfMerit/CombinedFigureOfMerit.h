@@ -20,12 +20,25 @@
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
 #include "netbuilder/FigureOfMerit/LevelCombiner.h"
 
+#include "latbuilder/StateIO.h"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <sstream>
+
 namespace NetBuilder { namespace FigureOfMerit {
 
 using LatBuilder::Functor::AllOf;
 
 /** 
- * Aggregation of figures of merit computed in a specific order.
+ * Aggregation of figures of merit.
+ *
+ * The evaluator computes the figures in an adaptive order: it measures the mean evaluation time of each figure and
+ * the proportion of nets whose computation it aborted, and evaluates first the figures with the smallest expected
+ * time per abortion, so that the nets rejected by a cheap figure do not pay for the expensive ones. The combined
+ * partial merit is checked after each contribution of every figure. The merit is accumulated in the order of the
+ * figures, so that its value does not depend on the evaluation order.
  */ 
 class CombinedFigureOfMerit : public CBCFigureOfMerit{
 
@@ -60,7 +73,7 @@ class CombinedFigureOfMerit : public CBCFigureOfMerit{
         /** 
          * Returns the vector of weights. 
          */
-        std::vector<Real> weights() const { return m_weights; }
+        const std::vector<Real>& weights() const { return m_weights; }
 
         /** 
          * Returns the number of figures. 
@@ -113,8 +126,11 @@ class CombinedFigureOfMerit : public CBCFigureOfMerit{
                 CombinedFigureOfMeritEvaluator(CombinedFigureOfMerit* figure):
                     m_figure(figure),
                     m_oldMerits(figure->size(),0),
-                    m_newMerits(figure->size(),0)
+                    m_newMerits(figure->size(),0),
+                    m_statistics(figure->size()),
+                    m_order(figure->size())
                 {
+                    std::iota(m_order.begin(), m_order.end(), 0);
                     for(unsigned int i = 0; i < m_figure->size(); ++i)
                     {
                         m_evaluators.push_back((m_figure->pointerToFigure(i)->evaluator()));
@@ -131,30 +147,38 @@ class CombinedFigureOfMerit : public CBCFigureOfMerit{
                  */ 
                 virtual MeritValue operator()(const AbstractDigitalNet& net, Dimension dimension, MeritValue initialValue, int verbose = 0) override
                 {
-                    auto acc = m_figure->accumulator(0); // create the accumulator from the initial value
+                    const std::vector<Real>& weights = m_figure->weights();
+
+                    auto acc = m_figure->accumulator(0); // partial merit, in evaluation order
 
                     Real weight; // weight of the figure currently evaluated
 
                     // capture used to determine whether the computation should be aborted is early abortion is activated
-                    auto goOn = [this, &acc, &weight] (MeritValue value) -> bool { return this->onProgress()(acc.tryAccumulate(weight, value, this->m_figure->expNorm())) ;} ;
+                    auto goOn = [this, &acc, &weight] (MeritValue value) -> bool { return this->continueEvaluation(acc.tryAccumulate(weight, value, this->m_figure->expNorm())) ;} ;
 
+                    sortFigures();
 
-                    for(unsigned int i = 0; i < m_figure->size(); ++i)
+                    for(unsigned int i : m_order)
                     {
                         if (verbose>0)
                         {
                             std::cout << "Computing for figure num " << i  << "..." << std::endl;
                         }
 
-                        weight = m_figure->weights()[i];
+                        weight = weights[i];
 
                         if (weight != 0.0)
                         {
                             auto goOnConnection = m_evaluators[i]->onProgress().connect(goOn); // connect the closure
 
+                            const auto start = std::chrono::steady_clock::now();
+
                             m_newMerits[i] = (*m_evaluators[i])(net, dimension, 0, verbose-1); // compute the merit
 
-                            acc.accumulate(m_figure->weights()[i], m_newMerits[i], m_figure->expNorm()) ; // accumulate the merit
+                            m_statistics[i].seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                            ++m_statistics[i].evaluations;
+
+                            acc.accumulate(weight, m_newMerits[i], m_figure->expNorm()) ; // accumulate the merit
 
                             goOnConnection.disconnect(); // disconnect the closure
 
@@ -163,11 +187,13 @@ class CombinedFigureOfMerit : public CBCFigureOfMerit{
                                 std::cout << "Partial merit value: " << acc.value() << std::endl;
                             }
 
-                            if (!onProgress()(acc.value())) // if someone is listening, may tell that the computation is useless
+                            if (!continueEvaluation(acc.value())) // if someone is listening, may tell that the computation is useless
                             {
+                                ++m_statistics[i].aborts;
                                 acc.accumulate(weight, std::numeric_limits<Real>::infinity(), m_figure->expNorm()); // set the merit to infinity
                                 onAbort()(net); // abort the computation
-                                break;
+                                LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::EARLY_ABORTS);
+                                return acc.value();
                             }
                         }
                         else
@@ -178,7 +204,17 @@ class CombinedFigureOfMerit : public CBCFigureOfMerit{
                             }
                         }
                     }
-                    return acc.value();
+
+                    // accumulate in the order of the figures, so that the merit does not depend on the evaluation order
+                    auto merit = m_figure->accumulator(0);
+                    for(unsigned int i = 0; i < m_figure->size(); ++i)
+                    {
+                        if (weights[i] != 0.0)
+                        {
+                            merit.accumulate(weights[i], m_newMerits[i], m_figure->expNorm());
+                        }
+                    }
+                    return merit.value();
                 }
 
                 /**     
@@ -207,6 +243,17 @@ class CombinedFigureOfMerit : public CBCFigureOfMerit{
                     m_oldMerits = std::move(m_bestNewMerits);
                 }
 
+                /**
+                 * Enables or disables the pruning of the evaluators of all the figures.
+                 */
+                virtual void setPruning(bool pruning) override
+                {
+                    for(auto& eval : m_evaluators)
+                    {
+                        eval->setPruning(pruning);
+                    }
+                }
+
                 /**
                  * Tells the evaluator that no more net will be evaluate for the current dimension,
                  * store information about the best net for the dimension which is over and prepare data structures
@@ -221,12 +268,87 @@ class CombinedFigureOfMerit : public CBCFigureOfMerit{
                     }
                 }
 
+                /**
+                 * Saves the states of the evaluators of all the figures, if they can all be saved.
+                 */
+                virtual bool saveState(std::ostream& os) const override
+                {
+                    std::vector<std::string> states;
+                    for(const auto& eval : m_evaluators)
+                    {
+                        std::ostringstream state;
+                        if (!eval->saveState(state))
+                        {
+                            return false;
+                        }
+                        states.push_back(state.str());
+                    }
+                    LatBuilder::StateIO::write(os, states);
+                    LatBuilder::StateIO::write(os, m_oldMerits);
+                    LatBuilder::StateIO::write(os, m_bestNewMerits);
+                    return true;
+                }
+
+                /**
+                 * {@inheritDoc}
+                 */
+                virtual bool loadState(std::istream& is) override
+                {
+                    std::vector<std::string> states;
+                    LatBuilder::StateIO::read(is, states);
+                    if (states.size() != m_evaluators.size())
+                    {
+                        throw std::runtime_error("the saved state does not match the combined figure of merit");
+                    }
+                    for(unsigned int i = 0; i < m_evaluators.size(); ++i)
+                    {
+                        std::istringstream state(states[i]);
+                        if (!m_evaluators[i]->loadState(state))
+                        {
+                            throw std::runtime_error("the saved state does not match the combined figure of merit");
+                        }
+                    }
+                    LatBuilder::StateIO::read(is, m_oldMerits);
+                    LatBuilder::StateIO::read(is, m_bestNewMerits);
+                    return true;
+                }
+
             private:
+                /**
+                 * Evaluation statistics of a figure.
+                 */
+                struct Statistics {
+                    double seconds = 0; // total evaluation time
+                    unsigned long evaluations = 0; // number of evaluations
+                    unsigned long aborts = 0; // number of computations aborted after the evaluation of the figure
+                };
+
+                /**
+                 * Sorts the figures by increasing expected evaluation time per abortion, the figures which were
+                 * never evaluated coming first, in their original order.
+                 */
+                void sortFigures()
+                {
+                    auto cost = [this](unsigned int i) -> double
+                    {
+                        const Statistics& stats = m_statistics[i];
+                        if (stats.evaluations == 0)
+                        {
+                            return 0;
+                        }
+                        const double abortRate = (stats.aborts + 1.0) / (stats.evaluations + 2.0); // smoothed proportion of aborts
+                        return stats.seconds / stats.evaluations / abortRate;
+                    };
+                    std::stable_sort(m_order.begin(), m_order.end(), [&cost](unsigned int a, unsigned int b) { return cost(a) < cost(b); });
+                }
+
                 CombinedFigureOfMerit* m_figure; // pointer to the figure
                 std::vector<std::unique_ptr<CBCFigureOfMeritEvaluator>> m_evaluators; // evaluators
                 std::vector<Real> m_oldMerits; // merits for the best net of the previous dimension
                 std::vector<Real> m_bestNewMerits; // best merits for the best net so far for the current dimension
                 std::vector<Real> m_newMerits; // merits of the latest evaluated net 
+                std::vector<Statistics> m_statistics; // evaluation statistics of each figure, kept across nets
+                std::vector<unsigned int> m_order; // evaluation order of the figures
 
         };
 
@@ -22,6 +22,7 @@
 
 #include "latticetester/Weights.h"
 
+#include "latbuilder/CoordUniformFigureOfMerit.h"
 #include "latbuilder/Kernel/Base.h"
 #include "latbuilder/Types.h"
 #include "latbuilder/Storage.h"
@@ -29,6 +30,10 @@
 #include "latbuilder/ClonePtr.h"
 #include "latbuilder/MeritSeq/CoordUniformStateCreator.h"
 #include "latbuilder/MeritSeq/CoordUniformInnerProd.h"
+#include "latbuilder/StateIO.h"
+
+#include <limits>
+#include <vector>
 
 namespace NetBuilder{ namespace FigureOfMerit { 
 
@@ -125,6 +130,14 @@ namespace NetBuilder{ namespace FigureOfMerit {
             }
 
 
+            /**
+             * Returns the coordinate-uniform figure of merit of LatBuilder with the same kernel, which takes over the
+             * weights of this figure, for the searches of polynomial lattice rules implemented by LatBuilder.
+             * This figure cannot be used afterwards.
+             */
+            LatBuilder::CoordUniformFigureOfMerit<KERNEL> giveLatBuilderFigure()
+            { return LatBuilder::CoordUniformFigureOfMerit<KERNEL>(std::move(m_weights), m_kernel); }
+
             /**
              * Returns a <code>std::unique_ptr</code> to an evaluator for the figure of merit. 
              */
@@ -167,7 +180,8 @@ namespace NetBuilder{ namespace FigureOfMerit {
                             m_storage(m_sizeParam),
                             m_innerProd(m_storage, m_figure->kernel()),
                             m_memStates(LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights())),
-                            m_tmpStates(LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights()))
+                            m_weightedStateValid(false),
+                            m_hasBestMatrix(false)
                         {};
 
 
@@ -199,7 +213,8 @@ namespace NetBuilder{ namespace FigureOfMerit {
                         virtual void reset() override
                         {
                             m_memStates = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
-                            m_tmpStates = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
+                            m_weightedStateValid = false;
+                            m_hasBestMatrix = false;
                         }
 
                         /** 
@@ -235,17 +250,32 @@ namespace NetBuilder{ namespace FigureOfMerit {
 
                             MeritValue acc = initialValue; // create the accumulator from the initial value
 
-                            lastMatrix = net.generatingMatrix(dimension);
-                            std::vector<GeneratingMatrix> genSeq {lastMatrix};
-                            auto prodSeq = m_innerProd.prodSeq(genSeq, weightedState());
-                            auto merit = *(prodSeq.begin());
+                            // the states, hence the total weighted state, only change between dimensions,
+                            // so the candidates of a dimension share the same operand of the inner products
+                            if (!m_weightedStateValid)
+                            {
+                                m_weightedState = m_innerProd.weightedVector(weightedState());
+                                m_weightedStateValid = true;
+                                m_rowTable.clear();
+                                m_changedRow = noRow;
+                            }
+                            const GeneratingMatrix& matrix = net.generatingMatrix(dimension);
+                            typename Storage::MeritValue merit;
+                            if (!rowTableMerit(matrix, merit))
+                            {
+                                std::vector<GeneratingMatrix> genSeq {matrix};
+                                auto prodSeq = m_innerProd.prodSeq(genSeq, m_weightedState);
+                                merit = *(prodSeq.begin());
+                            }
+                            lastMatrix = matrix;
                             m_sizeParam.normalize(merit);
                             acc += combine(merit);
 
-                            if (! onProgress()(acc)) // if someone is listening, may tell that the computation is useless
+                            if (! continueEvaluation(acc)) // if someone is listening, may tell that the computation is useless
                             { 
                                 acc = std::numeric_limits<Real>::infinity(); // set the merit to infinity
                                 onAbort()(net); // abort the computation
+                                LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::EARLY_ABORTS);
                             }
                             return acc;
                         }
@@ -257,7 +287,15 @@ namespace NetBuilder{ namespace FigureOfMerit {
                          */ 
                         virtual void prepareForNextDimension() override
                         {
-                            m_memStates = m_tmpStates;
+                            if (m_hasBestMatrix) // the states are only updated with the best net of the dimension
+                            {
+                                for (auto& state : m_memStates)
+                                {
+                                    state->update(m_innerProd.kernelValues(), m_bestMatrix);
+                                }
+                                m_hasBestMatrix = false;
+                                m_weightedStateValid = false;
+                            }
                         } 
 
                         /**
@@ -265,11 +303,76 @@ namespace NetBuilder{ namespace FigureOfMerit {
                          */
                         virtual void lastNetWasBest() override
                         {
-                            m_tmpStates = m_memStates;
-                            for (auto& state : m_tmpStates)
+                            m_bestMatrix = lastMatrix;
+                            m_hasBestMatrix = true;
+                        }
+
+                        /**
+                         * Saves the number of levels, the states and the matrix of the best net of the current dimension,
+                         * which is applied to the states by the next call to prepareForNextDimension().
+                         */
+                        virtual bool saveState(std::ostream& os) const override
+                        {
+                            using LatBuilder::StateIO::write;
+                            write(os, m_numLevels);
+                            LatBuilder::StateIO::writeSize(os, m_memStates.size());
+                            for (const auto& state : m_memStates)
+                            {
+                                state->save(os);
+                            }
+                            write(os, m_hasBestMatrix);
+                            if (m_hasBestMatrix)
+                            {
+                                write(os, m_bestMatrix.nRows());
+                                write(os, m_bestMatrix.nCols());
+                                for (unsigned int i = 0; i < m_bestMatrix.nRows(); ++i)
+                                {
+                                    for (unsigned int j = 0; j < m_bestMatrix.nCols(); ++j)
+                                    {
+                                        write(os, static_cast<unsigned char>(m_bestMatrix(i, j)));
+                                    }
+                                }
+                            }
+                            return true;
+                        }
+
+                        /**
+                         * {@inheritDoc}
+                         */
+                        virtual bool loadState(std::istream& is) override
+                        {
+                            using LatBuilder::StateIO::read;
+                            unsigned int numLevels;
+                            read(is, numLevels);
+                            updateSizeParam(numLevels);
+                            if (LatBuilder::StateIO::readSize(is) != m_memStates.size())
                             {
-                                state->update(m_innerProd.kernelValues(), lastMatrix);
+                                throw std::runtime_error("the saved state does not match the weights of the coordinate-uniform figure");
                             }
+                            for (auto& state : m_memStates)
+                            {
+                                state->load(is);
+                            }
+                            m_weightedStateValid = false;
+                            read(is, m_hasBestMatrix);
+                            if (m_hasBestMatrix)
+                            {
+                                unsigned int nRows, nCols;
+                                read(is, nRows);
+                                read(is, nCols);
+                                m_bestMatrix = GeneratingMatrix(nRows, nCols);
+                                for (unsigned int i = 0; i < nRows; ++i)
+                                {
+                                    for (unsigned int j = 0; j < nCols; ++j)
+                                    {
+                                        unsigned char bit;
+                                        read(is, bit);
+                                        m_bestMatrix(i, j) = (bit != 0);
+                                    }
+                                }
+                                lastMatrix = m_bestMatrix;
+                            }
+                            return true;
                         }
 
                         void updateSizeParam(unsigned int m)
@@ -281,8 +384,156 @@ namespace NetBuilder{ namespace FigureOfMerit {
                                 m_storage = Storage(m_sizeParam);
                                 m_innerProd = InnerProd(m_storage, m_figure->kernel());
                                 m_memStates = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
-                                m_tmpStates = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
+                                m_weightedStateValid = false;
+                                m_hasBestMatrix = false;
+                            }
+                        }
+
+                        /**
+                         * Computes in \c merit the inner product of \c matrix from the table of the merit values of all the
+                         * matrices which only differ by one row, if \c matrix is one of them. Such a table is computed with a
+                         * Walsh-Hadamard transform when the last two evaluated matrices changed the same row of their predecessor,
+                         * as while the explicit matrices are enumerated, so that the next candidates are looked up in it.
+                         * Returns \c false if the inner product must be computed directly.
+                         */
+                        bool rowTableMerit(const GeneratingMatrix& matrix, Real& merit)
+                        {
+                            if (!m_rowTable.empty() && sameRowsExcept(matrix, m_rowTableBase, m_rowTableRow))
+                            {
+                                merit = m_rowTable[matrix.packedRow(m_rowTableRow)];
+                                return true;
+                            }
+                            if (KERNEL::suggestedCompression() != LatBuilder::Compress::NONE || m_innerProd.onTheFly() ||
+                                matrix.nCols() > GeneratingMatrix::maxPackedCols || matrix.nRows() > matrix.nCols() ||
+                                lastMatrix.nRows() != matrix.nRows() || lastMatrix.nCols() != matrix.nCols())
+                            {
+                                m_changedRow = noRow;
+                                return false;
+                            }
+                            const unsigned int changedRow = onlyChangedRow(lastMatrix, matrix);
+                            if (changedRow == noRow || changedRow != m_changedRow)
+                            {
+                                m_changedRow = changedRow;
+                                return false;
+                            }
+                            computeRowTable(matrix, changedRow);
+                            merit = m_rowTable[matrix.packedRow(changedRow)];
+                            return true;
+                        }
+
+                        /**
+                         * The merit values of multilevel nets are not tabulated.
+                         */
+                        bool rowTableMerit(const GeneratingMatrix& matrix, RealVector& merit)
+                        { return false; }
+
+                        /**
+                         * Computes the inner products of all the matrices equal to \c matrix except for the row \c row.
+                         *
+                         * The i-th point of the storage has the digits a_i of the point of the matrix with a zero row, and
+                         * the digit <code>row</code> flipped if the dot product of the row with the Gray code g_i of i is odd.
+                         * The inner product for the row r thus equals the sum A of the products w_i K(a_i) with the
+                         * matrix with a zero row, plus the sum of the differences d_{g_i} = w_i (K(a_i + b) - K(a_i)) over
+                         * the points for which r.g_i is odd, that is A + (D - H(r)) / 2, where D is the sum of the differences
+                         * and H their Walsh-Hadamard transform.
+                         */
+                        void computeRowTable(const GeneratingMatrix& matrix, unsigned int row)
+                        {
+                            m_rowTableBase = matrix;
+                            m_rowTableBase.setPackedRow(row, 0);
+                            m_rowTableRow = row;
+
+                            const std::vector<unsigned long> cols = m_rowTableBase.getColsReverse();
+                            const unsigned long flipped = 1UL << (matrix.nRows() - row - 1);
+                            const RealVector& kernelValues = m_innerProd.kernelValues();
+                            const RealVector& weights = *m_weightedState;
+                            const size_t n = weights.size();
+
+                            m_rowTable.assign(n, 0);
+                            Real base = 0;
+                            Real sumDifferences = 0;
+                            unsigned long point = 0;
+                            for (size_t i = 0; i < n; ++i)
+                            {
+                                if (i > 0)
+                                {
+                                    point ^= cols[lowestSetBit(i)]; // the Gray codes of i-1 and i differ by the lowest set bit of i
+                                }
+                                const Real value = weights[i] * kernelValues[point];
+                                const Real difference = weights[i] * kernelValues[point ^ flipped] - value;
+                                base += value;
+                                sumDifferences += difference;
+                                m_rowTable[i ^ (i >> 1)] = difference;
+                            }
+                            walshHadamardTransform(m_rowTable);
+                            for (auto& merit : m_rowTable)
+                            {
+                                merit = base + (sumDifferences - merit) / 2;
+                            }
+                        }
+
+                        /**
+                         * Replaces \c values, whose size is a power of two, with its Walsh-Hadamard transform.
+                         */
+                        static void walshHadamardTransform(std::vector<Real>& values)
+                        {
+                            const size_t n = values.size();
+                            Real* const data = values.data();
+                            for (size_t half = 1; half < n; half <<= 1)
+                            {
+                                for (size_t block = 0; block < n; block += 2 * half)
+                                {
+                                    Real* const low = data + block;
+                                    Real* const high = low + half;
+                                    for (size_t k = 0; k < half; ++k)
+                                    {
+                                        const Real a = low[k];
+                                        const Real b = high[k];
+                                        low[k] = a + b;
+                                        high[k] = a - b;
+                                    }
+                                }
+                            }
+                        }
+
+                        /**
+                         * Returns the only row which differs between \c previous and \c matrix, or #noRow if no row or
+                         * several rows differ.
+                         */
+                        static unsigned int onlyChangedRow(const GeneratingMatrix& previous, const GeneratingMatrix& matrix)
+                        {
+                            unsigned int changedRow = noRow;
+                            for (unsigned int i = 0; i < matrix.nRows(); ++i)
+                            {
+                                if (previous.packedRow(i) != matrix.packedRow(i))
+                                {
+                                    if (changedRow != noRow)
+                                    {
+                                        return noRow;
+                                    }
+                                    changedRow = i;
+                                }
                             }
+                            return changedRow;
+                        }
+
+                        /**
+                         * Returns \c true if \c matrix and \c base, whose row \c row is zero, only differ by this row.
+                         */
+                        static bool sameRowsExcept(const GeneratingMatrix& matrix, const GeneratingMatrix& base, unsigned int row)
+                        {
+                            if (matrix.nRows() != base.nRows() || matrix.nCols() != base.nCols())
+                            {
+                                return false;
+                            }
+                            for (unsigned int i = 0; i < matrix.nRows(); ++i)
+                            {
+                                if (i != row && matrix.packedRow(i) != base.packedRow(i))
+                                {
+                                    return false;
+                                }
+                            }
+                            return true;
                         }
 
                         // CoordUniformFigureOfMeritEvaluator(CoordUniformFigureOfMeritEvaluator&&) = default;
@@ -308,10 +559,20 @@ namespace NetBuilder{ namespace FigureOfMerit {
 
                         InnerProd m_innerProd; // used to compute inner products 
                         StateList m_memStates; // states for the best net for the previous dimension
-                        StateList m_tmpStates; // states for the best net so far for the current dimension
+                        typename InnerProd::WeightedVector m_weightedState; // total weighted state of m_memStates, with the compression weights
+                        bool m_weightedStateValid; // whether m_weightedState is up to date with m_memStates
 
 
                         GeneratingMatrix lastMatrix; // last matrix of latets evaluated net for the current dimension
+                        GeneratingMatrix m_bestMatrix; // matrix of the best net so far for the current dimension, applied to the states by prepareForNextDimension()
+                        bool m_hasBestMatrix; // whether a best net was found for the current dimension
+
+                        static constexpr unsigned int noRow = std::numeric_limits<unsigned int>::max(); // no changed row
+
+                        std::vector<Real> m_rowTable; // inner products of the matrices which differ from m_rowTableBase by the row m_rowTableRow, indexed by that row
+                        GeneratingMatrix m_rowTableBase; // matrix of m_rowTable, whose row m_rowTableRow is zero
+                        unsigned int m_rowTableRow = noRow; // row which varies in m_rowTable
+                        unsigned int m_changedRow = noRow; // only row by which the last evaluated matrix differs from its predecessor
 
                 };
 
@@ -25,13 +25,18 @@
 #include "latticetester/Coordinates.h"
 
 #include "latbuilder/Functor/AllOf.h"
+#include "latbuilder/SharedMinimum.h"
+#include "latbuilder/Profiler.h"
 
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <istream>
+#include <ostream>
 #include <string>
 #include <limits>
 #include <functional>
+#include <stdexcept>
 
 #include <boost/signals2.hpp>
 
@@ -60,7 +65,8 @@ class FigureOfMeritEvaluator
         */
         FigureOfMeritEvaluator():
             m_onProgress(new OnProgress),
-            m_onAbort(new OnAbort)
+            m_onAbort(new OnAbort),
+            m_sharedMinimum(nullptr)
         {};
 
         /// \name Signals
@@ -86,6 +92,14 @@ class FigureOfMeritEvaluator
         OnAbort& onAbort() const { return *m_onAbort; }
         //@}
 
+        /**
+        * Sets the shared minimum merit value polled after each contribution to the figure of merit:
+        * the computation is aborted as soon as the partial merit value exceeds it, and the progress
+        * signal is no longer emitted. A \c nullptr restores the progress signal.
+        * The shared minimum must outlive the computations of the evaluator.
+        */
+        void setSharedMinimum(const LatBuilder::SharedMinimum* minimum) { m_sharedMinimum = minimum; }
+
         /** 
          * Computes the figure of merit for the given \c net for all the dimensions (full computation).
          * @param net Net to evaluate.
@@ -98,9 +112,25 @@ class FigureOfMeritEvaluator
          */ 
         virtual void reset() = 0;
 
+    protected:
+        /**
+         * Returns whether the computation of the figure of merit must go on with the partial merit value \c merit,
+         * according to the shared minimum if one is set, to the slots of the progress signal otherwise.
+         */
+        bool continueEvaluation(const MeritValue& merit) const
+        { return m_sharedMinimum ? m_sharedMinimum->accepts(merit) : onProgress()(merit); }
+
+        /**
+         * Returns the largest partial merit value accepted by continueEvaluation() when it is known, that is,
+         * the value of the shared minimum if one is set, infinity otherwise.
+         */
+        Real acceptedMeritBound() const
+        { return m_sharedMinimum ? m_sharedMinimum->value() : std::numeric_limits<Real>::infinity(); }
+
     private:
         std::unique_ptr<OnProgress> m_onProgress; 
         std::unique_ptr<OnAbort> m_onAbort;
+        const LatBuilder::SharedMinimum* m_sharedMinimum;
 };
 
 
@@ -137,6 +167,18 @@ class FigureOfMerit{
         virtual std::unique_ptr<FigureOfMeritEvaluator> createEvaluator() = 0;
 };
 
+/**
+ * Estimate of a partial merit value, with the half-width of its confidence interval.
+ */
+struct MeritEstimate
+{
+    Real value; ///< estimated value
+    Real halfWidth; ///< half-width of the confidence interval around the estimated value, zero if the value is exact
+
+    /// Returns the lower end of the confidence interval.
+    Real lower() const { return value - halfWidth; }
+};
+
 /** 
  * Evaluator abstract class to evaluate figure of merit for a net in a CBC way.
  */ 
@@ -151,23 +193,41 @@ class CBCFigureOfMeritEvaluator:
          * @{inheritDoc}
          */ 
         virtual MeritValue operator() (const AbstractDigitalNet& net, int verbose = 0) override
+        {
+            return evaluateByCoordinate(net.dimension(), [&net](Dimension) -> const AbstractDigitalNet& { return net; }, verbose);
+        }
+
+        /**
+         * Computes the figure of merit of a net of dimension \c dimension coordinate by coordinate, as operator()(net, verbose),
+         * but with the net of the first <code>coord + 1</code> coordinates returned by <code>extend(coord)</code>, which is
+         * called once for each coordinate, in order, only when the coordinate is evaluated. Hence, the coordinates after the one
+         * which aborts the computation are never constructed. The reference returned by \c extend must remain valid until
+         * the next call.
+         * @param dimension Dimension of the net.
+         * @param extend Callable returning the net made of the first <code>coord + 1</code> coordinates.
+         * @param verbose Verbosity level.
+         */
+        template <typename EXTEND>
+        MeritValue evaluateByCoordinate(Dimension dimension, EXTEND&& extend, int verbose = 0)
         {
             MeritValue merit = 0; // start from a merit equal to zero
-            for(Dimension coord = 0; coord < net.dimension(); ++coord) // for each coordinate
+            for(Dimension coord = 0; coord < dimension; ++coord) // for each coordinate
             {
                 prepareForNextDimension(); // prepare the evaluator for the next coordinate
                 if (verbose>0 && coord > 0)
                 {
-                    std::cout << "Begin coordinate: " << coord + 1 << "/" << net.dimension() << std::endl;
+                    std::cout << "Begin coordinate: " << coord + 1 << "/" << dimension << std::endl;
                 }
+                const AbstractDigitalNet& net = extend(coord);
                 merit = operator()(net, coord, merit, verbose-1); // evaluate the partial merit value
                 if (verbose>0)
                 {
                     std::cout << "Partial merit value: " << merit <<std::endl;
                 }
-                if (!onProgress()(merit)) // // if someone is listening, may tell that the computation is useless
+                if (!continueEvaluation(merit)) // // if someone is listening, may tell that the computation is useless
                 {
                     onAbort()(net);
+                    LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::EARLY_ABORTS);
                     merit = std::numeric_limits<Real>::infinity();
                     break;
                 }
@@ -199,6 +259,62 @@ class CBCFigureOfMeritEvaluator:
          */
         virtual void lastNetWasBest() = 0;
 
+        /**
+         * Lets the evaluator discard, when \c pruning is \c true, the data which is only needed to evaluate again the
+         * coordinates already prepared, so that it uses less memory. After a reset(), such a data is computed again.
+         * Hence, only a search which keeps extending the same net, as the CBC search, should enable it.
+         * Evaluators which keep no such data ignore it, which is the default.
+         */
+        virtual void setPruning(bool pruning)
+        {
+            (void) pruning;
+        }
+
+        /**
+         * Returns \c true if the evaluator implements estimate(), which is not the default.
+         */
+        virtual bool estimates() const { return false; }
+
+        /**
+         * Estimates the value which operator()(net, dimension, initialValue) would add to a sum \c initialValue,
+         * that is, the weighted sum of the merits of the projections of the coordinate \c dimension, from a sample of
+         * \c sampleSize projections drawn with probabilities proportional to their weights.
+         * The sample of a coordinate does not depend on the net, so that the estimates of the candidates of a coordinate
+         * can be compared more accurately than they are known. The evaluator must be in the same state as for operator().
+         * @param net Net to evaluate.
+         * @param dimension Coordinate whose projections are sampled.
+         * @param sampleSize Number of projections drawn with replacement.
+         * @param zScore Half-width of the confidence interval, in estimated standard errors.
+         * @throw std::logic_error if the evaluator does not implement estimates.
+         */
+        virtual MeritEstimate estimate(const AbstractDigitalNet& net, Dimension dimension, size_t sampleSize, Real zScore)
+        {
+            throw std::logic_error("The evaluator of the figure of merit does not estimate merit values.");
+        }
+
+        /**
+         * Writes to \c os the state of the evaluator after the last net told to be the best, as described in
+         * LatBuilder::StateIO, so that a search extending this net restores it with loadState() instead of
+         * evaluating its coordinates again.
+         * Returns \c false without writing anything if the evaluator cannot save its state, which is the default.
+         */
+        virtual bool saveState(std::ostream& os) const
+        {
+            (void) os;
+            return false;
+        }
+
+        /**
+         * Replaces the state of the evaluator by the one written by saveState() for the same figure of merit.
+         * Returns \c false without reading anything if the evaluator cannot restore its state, which is the default.
+         * @throw std::runtime_error if the state cannot be read.
+         */
+        virtual bool loadState(std::istream& is)
+        {
+            (void) is;
+            return false;
+        }
+
 };
 
 /**
@@ -224,6 +340,18 @@ class CBCFigureOfMerit:
          */
         virtual Accumulator accumulator(Real initialValue) const = 0 ;
 
+        /**
+         * Returns a lower bound of the partial merit values of the candidates for a new coordinate, given the partial
+         * merit value \c baseMerit of the net they extend. A CBC search stops exploring the candidates of a coordinate
+         * as soon as one of them reaches this bound, since no other candidate can be better. The default is minus
+         * infinity, that is no bound.
+         */
+        virtual Real meritLowerBound(Real baseMerit) const
+        {
+            (void) baseMerit;
+            return -std::numeric_limits<Real>::infinity();
+        }
+
     private:
 
         virtual std::unique_ptr<FigureOfMeritEvaluator> createEvaluator()
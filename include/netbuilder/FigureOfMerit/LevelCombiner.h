@@ -37,6 +37,15 @@ namespace NetBuilder {
                 return 0.0;
             };          
 
+            /**
+             * Returns true if the combined merit cannot decrease when the merit of any level increases, so that
+             * combining lower bounds of the merits of the levels yields a lower bound of the combined merit.
+             */
+            virtual bool isMonotone() const
+            {
+                return false;
+            }
+
         };
 
         /** 
@@ -61,6 +70,11 @@ namespace NetBuilder {
                 }
                 return res;
             }
+
+            virtual bool isMonotone() const override
+            {
+                return true;
+            }
         };
 
         /**
@@ -85,6 +99,11 @@ namespace NetBuilder {
                 }
                 return res;
             }
+
+            virtual bool isMonotone() const override
+            {
+                return true;
+            }
             
         };
 
@@ -115,6 +134,11 @@ namespace NetBuilder {
                     return merits[m_level-1];
                 }
 
+                virtual bool isMonotone() const override
+                {
+                    return true;
+                }
+
             private:   
                 unsigned int m_level;
         };
@@ -18,50 +18,90 @@
 #define NETBUILDER__FIGURE_OF_MERIT_BIT__PROJECTION_DEPENDENT_EVALUATOR
 
 #include "netbuilder/FigureOfMerit/WeightedFigureOfMerit.h"
+#include "netbuilder/Helpers/Projection.h"
+#include "netbuilder/Helpers/ProjectionSample.h"
+
+#include "latbuilder/Memory.h"
+#include "latbuilder/StateIO.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Trace.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
 
 namespace NetBuilder { namespace FigureOfMerit {
 
+/**
+ * Computes the projection-dependent merit \c projDepMerit of the net \c net for the projection \c projection, knowing
+ * that the evaluation is aborted if the combined merit of the projection is greater than \c maxMerit.
+ * This generic version ignores \c maxMerit; overloads for specific projection-dependent merits may instead return,
+ * as soon as the combined merit is known to be greater than \c maxMerit, any merit whose combined value is greater
+ * than \c maxMerit.
+ * @param projDepMerit Projection-dependent merit.
+ * @param net Net to evaluate.
+ * @param projection Projection to use.
+ * @param subProjCombination Combination of the merits of the subprojections.
+ * @param maxMerit Largest combined merit of the projection which does not abort the evaluation.
+ */
+template <typename PROJDEP>
+typename PROJDEP::Merit boundedProjDepMerit(const PROJDEP& projDepMerit, const AbstractDigitalNet& net, const Projection& projection,
+                                            const typename PROJDEP::SubProjCombination& subProjCombination, Real maxMerit)
+{
+    return projDepMerit(net, projection, subProjCombination);
+}
+
 /** 
  * Class to implement the evaluation of specific projection-dependent weighted figure of merit where
  * the merits of the subprojections of order one less are used to compute the merit of a bigger projection, for instance
  * the t-value of subprojections. 
+ * The projections are stored in flat arrays indexed by node, with the subprojections of each node
+ * in compressed sparse row format, so that evaluations and extensions are linear scans of contiguous memory.
+ * The projections of the maximal cardinal of the merit are dropped once their coordinate is chosen, so that the memory
+ * grows with the number of projections of lower cardinal only.
+ * When the shared LatBuilder::ThreadPool has more than one worker, the projections of a given cardinal, which
+ * only depend on the merits of projections of lower cardinals, are evaluated concurrently; the merits are then
+ * accumulated in the usual order, so that the result and the early abortions do not depend on the number of threads.
+ * When a shared minimum is set, the merits of the projections are computed with boundedProjDepMerit(), so that
+ * the projection-dependent merits which support it stop as soon as the candidate is known to be rejected.
+ * The merits are accumulated with an accumulator of type \c ACC. With StaticAccumulator, whose binary operation is
+ * fixed at compile time, and with Task::CBCSearch instantiated with this evaluator type, the evaluation of the candidates
+ * is dispatched statically and can be inlined in the search loop.
  * @tparam PROJDEP Template parameter representing the projection-dependent merit.
+ * @tparam ACC Type of the accumulator, either Accumulator or an instance of StaticAccumulator.
  */ 
-template <typename PROJDEP>
+template <typename PROJDEP, typename ACC = Accumulator>
 class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator 
 {
 
 
     public:
 
+        /// Type of the figure of merit evaluated.
+        typedef WeightedFigureOfMerit<PROJDEP> Figure;
+
         /** 
          * Constructor.
          * @param figure Pointer to the figure of merit.
          */ 
-        ProjectionDependentEvaluator(WeightedFigureOfMerit<PROJDEP>* figure):
+        ProjectionDependentEvaluator(Figure* figure):
                     m_figure(figure),
                     m_numCoordinates(0),
                     m_maxNumCoordinates(0),
-                    m_maxCardinal(m_figure->projDepMerit().maxCardinal())
-        {};
-
-        /** 
-         * Destructor. */
-        ~ProjectionDependentEvaluator()
+                    m_maxCardinal(m_figure->projDepMerit().maxCardinal()),
+                    m_layerBegin(1, 0),
+                    m_motherOffsets(1, 0),
+                    m_meritsSaved(false),
+                    m_pruning(false),
+                    m_pruned(false),
+                    m_memory(LatBuilder::Memory::Component::PROJECTIONS)
         {
-            for(Dimension dim = 0; dim < m_maxNumCoordinates; ++dim)
+            if (!ACC::acceptsNormType(m_figure->normType()))
             {
-                ProjectionNode* it = m_roots[dim];
-                ProjectionNode* nextIt = nullptr;
-                do
-                {
-                    nextIt = it->getNextNode();
-                    delete it;
-                    it = nextIt;
-                }
-                while(it != nullptr);
+                throw std::invalid_argument("In projection-dependent figure of merit evaluator: the accumulator does not match the norm type of the figure.");
             }
-        }
+        };
 
         /** 
          * Computes the figure of merit for the given \c net for the given \c dimension (partial computation), 
@@ -73,56 +113,130 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
          */ 
         virtual MeritValue operator() (const AbstractDigitalNet& net, Dimension dimension, MeritValue initialValue, int verbose = 0) override
         {
+            LatBuilder::Trace::Span span("projections", "evaluation", "projections", m_layerBegin[dimension + 1] - m_layerBegin[dimension]);
             unsigned int nLevels = PROJDEP::numLevels(net); // determine the number of levels
 
-            auto acc = m_figure->accumulator(std::move(initialValue));
+            ACC acc(std::move(initialValue), m_figure->normType());
+            m_meritsSaved = false;
+
+            if (LatBuilder::ThreadPool::global().size() > 1)
+            {
+                evaluateConcurrently(net, dimension, nLevels, acc);
+                return acc.value();
+            }
 
-            ProjectionNode* it = m_roots[dimension]; // iterator over the nodes
-            do
+            for(NodeId node = m_layerBegin[dimension]; node < m_layerBegin[dimension + 1]; ++node) // for each node of the layer in evaluation order
             {   
-                Real weight = it->getWeight();
+                Real weight = m_weights[node];
                 
-                if (PROJDEP::size(it->getSubProjCombination()) < nLevels) // resize the subprojections combination if required
+                if (PROJDEP::size(m_subProjCombinations[node]) < nLevels) // resize the subprojections combination if required
                 {
-                    PROJDEP::resize(it->getSubProjCombination(), nLevels);
+                    PROJDEP::resize(m_subProjCombinations[node], nLevels);
                 }
 
-                it->updateSubProjCombination(); // update the subprojection combination
+                updateSubProjCombination(node, m_layerBegin[dimension]); // update the subprojection combination
 
-                LatticeTester::Coordinates proj = it->getProjectionRepresentation();
+                const Projection proj = projectionRepresentation(node);
 
-                auto grossMerit = m_figure->projDepMerit()(net, proj ,it->getSubProjCombination()); // compute the merit of the projection
+                auto grossMerit = projectionMerit(net, proj, node, acc); // compute the merit of the projection
 
                 Real merit = m_figure->projDepMerit().combine(grossMerit, net, proj); // combine in a single merit value
 
                 acc.accumulate(weight,merit,1);
 
-                if (!onProgress()(acc.value()))  // if someone is listening, may tell that the computation is useless
+                if (!continueEvaluation(acc.value()))  // if someone is listening, may tell that the computation is useless
                 {
                     acc.accumulate(std::numeric_limits<Real>::infinity(), merit, 1); // set the merit to infinity
                     onAbort()(net); // abort the computation
+                    LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::EARLY_ABORTS);
                     break;
                 }
 
-                it->setMeritTmp(grossMerit); // update the merit of the node
-                it = it->getNextNode(); // skip to next node
+                m_meritsTmp[node] = grossMerit; // update the merit of the node
             }
-            while(it != nullptr);
 
             return acc.value();
         }
 
+        /**
+         * @{inheritDoc}
+         * The nodes of the maximal cardinal of the previous layers are then removed by extend().
+         */
+        virtual void setPruning(bool pruning) override
+        {
+            m_pruning = pruning;
+        }
+
         /**     
          * Resets the evaluator and prepare it to evaluate a new net.
+         * If nodes were pruned (see setPruning() and extend()), the layers are created again as the coordinates are added.
          */ 
-        virtual void reset() override { m_numCoordinates=0; }
+        virtual void reset() override
+        {
+            m_numCoordinates=0;
+            m_meritsSaved=false;
+            if (m_pruned)
+            {
+                clearNodes();
+            }
+        }
 
         /**
          * Tells the evaluator that the last net was the best so far and store the relevant information
          */
         virtual void lastNetWasBest() override
         {
-            saveMerits(m_numCoordinates-1);
+            if (!m_meritsSaved)
+            {
+                swapMerits(m_numCoordinates-1);
+                m_meritsSaved = true;
+            }
+        }
+
+        /**
+         * Returns \c true if the norm type of the figure is finite: the merit of the sup norm cannot be estimated from a sample.
+         */
+        virtual bool estimates() const override
+        { return m_figure->normType() < std::numeric_limits<Real>::infinity(); }
+
+        /**
+         * {@inheritDoc}
+         * The projections are sampled among the nodes of the layer of \c dimension, and their merits are computed without
+         * the merits of their subprojections, which are only known for the projections of the candidates evaluated exactly.
+         * The stored merits are not changed, so that estimates can be interleaved with exact evaluations.
+         */
+        virtual MeritEstimate estimate(const AbstractDigitalNet& net, Dimension dimension, size_t sampleSize, Real zScore) override
+        {
+            if (!estimates())
+            {
+                throw std::logic_error("The merit values of the sup norm cannot be estimated.");
+            }
+            if (dimension + 1 >= m_layerBegin.size())
+            {
+                throw std::logic_error("In projection-dependent figure of merit evaluator: the coordinate to estimate has no projections.");
+            }
+            const NodeId first = m_layerBegin[dimension];
+            if (!m_sample.drawn(dimension, sampleSize))
+            {
+                m_sample.draw(dimension, std::vector<Real>(m_weights.begin() + first, m_weights.begin() + m_layerBegin[dimension + 1]), sampleSize);
+            }
+            const unsigned int nLevels = PROJDEP::numLevels(net);
+            std::vector<Real> values;
+            values.reserve(m_sample.indices().size());
+            for (size_t index : m_sample.indices())
+            {
+                const NodeId node = first + index;
+                SubProjCombination zero = m_subProjCombinations[node];
+                if (PROJDEP::size(zero) < nLevels)
+                {
+                    PROJDEP::resize(zero, nLevels);
+                }
+                PROJDEP::setToZero(zero);
+                const Projection proj = projectionRepresentation(node);
+                auto grossMerit = m_figure->projDepMerit()(net, proj, zero);
+                values.push_back(m_figure->projDepMerit().combine(grossMerit, net, proj));
+            }
+            return m_sample.estimate(values, zScore);
         }
 
         /**
@@ -147,244 +261,384 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
             }
         }
 
-    private:
-
-        /** 
-         * Represents a projection. The node is linked to the projections with order one less and with the following
-         * projection in the evaluation order. The node store some merit values.
-         */ 
-        struct ProjectionNode
+        /**
+         * Saves the number of coordinates and the stored merits and combinations of the subprojections of their nodes.
+         * The nodes themselves only depend on the weights, so they are created again by loadState().
+         */
+        virtual bool saveState(std::ostream& os) const override
         {
-            /// Type of merit value storage.
-            typedef typename PROJDEP::Merit MeritStorage;
-
-            /// Type of the combination of the merits of the subprojections.
-            typedef typename PROJDEP::SubProjCombination SubProjCombination; 
-
-            /** 
-             * Constructor.
-             * @param dimension Highest coordinate in all the projections of the layer.
-             * @param cardinal Cardinal of the projection.
-             * @param weight Importance of the projection in the figure of merit.
-             */ 
-            ProjectionNode(Dimension dimension, unsigned int cardinal, double weight):
-                m_weight(weight),
-                m_dimension(dimension),
-                m_cardinal(cardinal)
-            {};
-
-            /** 
-             * Returns the cardinal of the projection represented by the node.
-             */ 
-            unsigned int getCardinal() const { return m_cardinal; }
-
-            /** 
-             * Returns the maximum dimension, that is the highest coordinate in all the projections of the layer.
-             */ 
-            Dimension getMaxDimension() const { return m_dimension; }
-
-            /** Returns a pointer to the next projection to evaluate. May be null.
-             */ 
-            ProjectionNode* getNextNode() const { return m_nextNode; }
-
-            /** Set the next node of the current node.
-             * @param node is a pointer to the next node.
-             */ 
-            void setNextNode(ProjectionNode* node){ m_nextNode = node; }
-
-            /** 
-             * Returns a vector of pointers to the subprojections whose cardinal is one less than the
-             * projection's.
-             */ 
-            const std::vector<ProjectionNode*>& getMotherNodes() const { return m_mothersNodes; }
-
-            /** 
-             * Returns the projection represented by the node.
-             */ 
-            LatticeTester::Coordinates getProjectionRepresentation() const { 
-                LatticeTester::Coordinates res;
-                accumulateProjectionRepresentation(res);
-                return res;
+            using LatBuilder::StateIO::write;
+            write(os, m_numCoordinates);
+            write(os, m_meritsSaved);
+            for(NodeId node = 0; node < m_layerBegin[m_numCoordinates]; ++node)
+            {
+                write(os, m_meritsMem[node]);
+                write(os, m_subProjCombinations[node]);
             }
+            return true;
+        }
 
-            /**
-             * Add a mother to the projection node.
-             * @param mother Pointer to the new mother.
-             */ 
-            void addMother(ProjectionNode* mother) { m_mothersNodes.push_back(mother); }
-
-            /** 
-             * Returns the weight of the projection represented by the node.
-             */ 
-            Real getWeight() const { return m_weight; }
-
-
-            /** Returns the stored merit of the projection represented by the node.
-             */ 
-            MeritStorage getMeritMem() const {return m_meritMem; }
-
-            /** Returns the temporary merit of the projection represented by the node.
-             */ 
-            MeritStorage getMeritTmp() const {return m_meritTmp; }
-
-
-            /** 
-             * Returns the maximum of the merits of the subprojections.
-             */ 
-            SubProjCombination& getSubProjCombination() { return m_subProjCombination; }
-
-            /** 
-             * Set the temporary merit of the node to be the given merit
-             * @param merit is the merit to assign to the node.
-             */ 
-            void setMeritTmp(MeritStorage merit) {m_meritTmp = merit; }
-
-            /** 
-             * Save the temporary merit in the m_meritMem field. 
-             */ 
-            void saveMerit() {m_meritMem = m_meritTmp; }
-
-            /** 
-             * Updates the combination of the merits of the subprojections (mothers). Note that for
-             * subprojections which also contain getMaxDimension(), the temporary merit is used
-             * whereas for other nodes, the stored merit is used. This allows component-by-component
-             * evaluation for several nets with a unique datastructure..
-             */ 
-            void updateSubProjCombination()
+        /**
+         * {@inheritDoc}
+         * The subclasses which keep data about the nodes, such as reductions of the generating matrices, compute it
+         * again when it is needed.
+         */
+        virtual bool loadState(std::istream& is) override
+        {
+            using LatBuilder::StateIO::read;
+            reset();
+            Dimension numCoordinates;
+            read(is, numCoordinates);
+            while (m_maxNumCoordinates < numCoordinates)
             {
-                if (getCardinal() > 1)
-                {
-                    PROJDEP::setToZero(m_subProjCombination);
-                    for (auto const* m : m_mothersNodes)
-                    {
-                        if (m->getMaxDimension() < m_dimension)
-                        {
-                            PROJDEP::update(m->getMeritMem(), m_subProjCombination);
-                        }
-                        else{
-                            PROJDEP::update(m->getMeritTmp(), m_subProjCombination);
-                        } 
-                    }
-                }
+                extend();
             }
-
-            /** 
-             * Overloads operator < to compare projections. A projection is smaller (less important) than another one if they have the same cardinal and its weight is smaller
-             * of if it has a strictly bigger cardinal.
-             */ 
-            bool operator>(const ProjectionNode &b) const
+            m_numCoordinates = numCoordinates;
+            read(is, m_meritsSaved);
+            for(NodeId node = 0; node < m_layerBegin[m_numCoordinates]; ++node)
             {
-                return (getCardinal() == b.getCardinal()) ? 
-                            (getWeight() > b.getWeight()) : 
-                            (getCardinal() < b.getCardinal());
+                read(is, m_meritsMem[node]);
+                read(is, m_subProjCombinations[node]);
             }
+            return true;
+        }
 
-            /** 
-             * Comparison between pointers to nodes by dereferencing. Used to sort by decreasing importance.
-             */ 
-            static bool compareNodePointers(const ProjectionNode* a, const ProjectionNode* b){
-                return (*a > * b);
-            }
-                    
-            /** 
-             * Overloading of the << operator to print projection nodes.
-             */
-            friend std::ostream& operator<<(std::ostream& os, const ProjectionNode& dt)
+    protected:
+
+        /// Type of merit value storage.
+        typedef typename PROJDEP::Merit MeritStorage;
+
+        /// Type of the combination of the merits of the subprojections.
+        typedef typename PROJDEP::SubProjCombination SubProjCombination; 
+
+        /// Index of a projection node in the arrays of the evaluator.
+        typedef size_t NodeId;
+
+        /**
+         * Computes the merit of the projection \c proj of the node \c node with boundedProjDepMerit(), given the largest combined
+         * merit \c maxMerit which does not abort the evaluation, or exactly if \c maxMerit is infinite.
+         * Evaluators of specific projection-dependent merits may override it to reuse the computations made for the subprojections
+         * of the node, which belong to the previous layers and thus do not change from one candidate net to the next. It may be called
+         * concurrently for distinct nodes of the same cardinal.
+         */
+        virtual MeritStorage nodeMerit(const AbstractDigitalNet& net, const Projection& proj, NodeId node, Real maxMerit)
+        {
+            if (maxMerit == std::numeric_limits<Real>::infinity())
             {
-                os << "projection: " << dt.getProjectionRepresentation() << " - weight: " << dt.getWeight();
-                return os;
+                return m_figure->projDepMerit()(net, proj, m_subProjCombinations[node]);
             }
+            return boundedProjDepMerit(m_figure->projDepMerit(), net, proj, m_subProjCombinations[node], maxMerit);
+        }
 
-            double m_weight; // weight of the projection
-            Dimension m_dimension; // last dimension (highest coordinate in the projection)
-            unsigned int m_cardinal; // cardinal of the projection
+        /**
+         * Returns the number of nodes of the layers of the coordinates lower than \c dimension.
+         */
+        NodeId layerBegin(Dimension dimension) const { return m_layerBegin[dimension]; }
+
+        /**
+         * Returns the cardinal of the projection of the node \c node.
+         */
+        unsigned int nodeCardinal(NodeId node) const { return m_cardinals[node]; }
 
-            ProjectionNode* m_nextNode = nullptr; // pointer to the next projection to evaluate
-            std::vector<ProjectionNode*> m_mothersNodes; // pointers to the subprojections whose cardinal is one less
+        /**
+         * Returns the node of the projection of the node \c node without its highest coordinate. The cardinal of \c node must be greater than one.
+         */
+        NodeId parentNode(NodeId node) const { return m_mothers[m_motherOffsets[node]]; }
 
-            SubProjCombination m_subProjCombination; // combination of the merits of the subprojections
+        /**
+         * Returns the combination of the merits of the subprojections of the node \c node for the net being evaluated.
+         */
+        const SubProjCombination& subProjCombination(NodeId node) const { return m_subProjCombinations[node]; }
 
-            MeritStorage m_meritMem; // stored merit
-            MeritStorage m_meritTmp; // temporay merit
+    private:
 
-            void accumulateProjectionRepresentation(LatticeTester::Coordinates& projection) const
+        /** 
+         * Returns the projection represented by the node \c node. The first mother of a node of cardinal
+         * greater than one is the projection without its highest coordinate.
+         * @param node Index of the node.
+         */ 
+        Projection projectionRepresentation(NodeId node) const
+        {
+            Projection res;
+            while (true)
             {
-                projection.insert(m_dimension);
-                if(m_cardinal>1)
+                res.insert(m_dimensions[node]);
+                if (m_cardinals[node] <= 1)
                 {
-                    m_mothersNodes[0]->accumulateProjectionRepresentation(projection);
+                    break;
                 }
+                node = m_mothers[m_motherOffsets[node]];
             }
-        };
+            return res;
+        }
+
+        /**
+         * Computes the merit of the projection \c proj of the node \c node, given the accumulator \c acc of the merits
+         * of the previous nodes. The computation may stop early if the merit is too large for the net to be accepted; in
+         * that case, the returned merit still makes the net rejected.
+         */
+        MeritStorage projectionMerit(const AbstractDigitalNet& net, const Projection& proj, NodeId node, const ACC& acc)
+        {
+            const Real bound = acceptedMeritBound();
+            if (bound == std::numeric_limits<Real>::infinity())
+            {
+                return nodeMerit(net, proj, node, bound);
+            }
+            const Real maxMerit = acc.maxAccumulableValue(m_weights[node], bound);
+            auto grossMerit = nodeMerit(net, proj, node, maxMerit);
+            const Real merit = m_figure->projDepMerit().combine(grossMerit, net, proj);
+            if (merit > maxMerit && continueEvaluation(acc.tryAccumulate(m_weights[node], merit, 1)))
+            {
+                // the rounding errors of the accumulation let the net through: the exact merit is required
+                grossMerit = nodeMerit(net, proj, node, std::numeric_limits<Real>::infinity());
+            }
+            return grossMerit;
+        }
 
         /** 
-         * Extends by one dimension the evaluator. This creates new nodes corresponding to the new projections to consider
-         * while evaluating figures of merits.
+         * Computes the figure of merit for the given \c net for the given \c dimension with the shared thread pool.
+         * The nodes of the layer are processed by groups of nodes with the same cardinal: the merits of the nodes of
+         * a group are computed concurrently, then accumulated in evaluation order.
+         * @param net Net to evaluate.
+         * @param dimension Dimension to compute.
+         * @param nLevels Number of levels of the net.
+         * @param acc Accumulator of the merit.
          */ 
-        void extend(){
-            ++m_maxNumCoordinates; // increase maximal number of coordinates
-            std::vector<ProjectionNode*> newNodes; // to store new nodes
-
-            std::map<LatticeTester::Coordinates,ProjectionNode*> mapsToNodes; // map between new projections and new nodes
-
-            // create projection {m_numCoordinates} 
-            LatticeTester::Coordinates proj1DRep;
-            proj1DRep.insert(m_maxNumCoordinates-1);
-            double weight = m_figure->weights().getWeight(proj1DRep);
-            ProjectionNode* proj1D = new ProjectionNode(m_maxNumCoordinates-1, (unsigned int) proj1DRep.size(), weight);
+        void evaluateConcurrently(const AbstractDigitalNet& net, Dimension dimension, unsigned int nLevels, ACC& acc)
+        {
+            const NodeId layerBegin = m_layerBegin[dimension];
+            const NodeId layerEnd = m_layerBegin[dimension + 1];
+            std::vector<Real> merits; // combined merits of the nodes of the group
 
-            if(m_maxNumCoordinates==1){
-                m_roots.push_back(proj1D);
-                return;
-            }
+            for(NodeId groupBegin = layerBegin; groupBegin < layerEnd; )
+            {
+                NodeId groupEnd = groupBegin + 1;
+                while (groupEnd < layerEnd && m_cardinals[groupEnd] == m_cardinals[groupBegin])
+                {
+                    ++groupEnd;
+                }
 
-            newNodes.push_back(proj1D);
+                merits.resize(groupEnd - groupBegin);
+                LatBuilder::Trace::Span span("projection-group", "evaluation", "projections", groupEnd - groupBegin);
+                LatBuilder::ThreadPool::global().parallelFor(groupEnd - groupBegin, [&](unsigned int, size_t i)
+                    {
+                        const NodeId node = groupBegin + i;
+                        if (PROJDEP::size(m_subProjCombinations[node]) < nLevels) // resize the subprojections combination if required
+                        {
+                            PROJDEP::resize(m_subProjCombinations[node], nLevels);
+                        }
+                        updateSubProjCombination(node, layerBegin); // the mothers in the layer belong to the previous group
+                        const Projection proj = projectionRepresentation(node);
+                        m_meritsTmp[node] = projectionMerit(net, proj, node, acc); // the accumulated value can only grow until the node
+                        merits[i] = m_figure->projDepMerit().combine(m_meritsTmp[node], net, proj); // combine in a single merit value
+                    });
 
-            mapsToNodes.insert(std::pair<LatticeTester::Coordinates,ProjectionNode*>(std::move(proj1DRep),proj1D));
+                for(NodeId node = groupBegin; node < groupEnd; ++node)
+                {
+                    const Real merit = merits[node - groupBegin];
+                    acc.accumulate(m_weights[node], merit, 1);
 
+                    if (!continueEvaluation(acc.value()))  // if someone is listening, may tell that the computation is useless
+                    {
+                        acc.accumulate(std::numeric_limits<Real>::infinity(), merit, 1); // set the merit to infinity
+                        onAbort()(net); // abort the computation
+                        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::EARLY_ABORTS);
+                        return;
+                    }
+                }
+                groupBegin = groupEnd;
+            }
+        }
 
-            for(unsigned int i = 0; i < m_maxNumCoordinates-1; ++i) // for each previous dimensions
+        /** 
+         * Updates the combination of the merits of the subprojections (mothers) of the node \c node. Note that for
+         * subprojections which belong to the same layer, the temporary merit is used
+         * whereas for other nodes, the stored merit is used. This allows component-by-component
+         * evaluation for several nets with a unique datastructure.
+         * @param node Index of the node.
+         * @param layerBegin Index of the first node of the layer of \c node.
+         */ 
+        void updateSubProjCombination(NodeId node, NodeId layerBegin)
+        {
+            if (m_cardinals[node] > 1)
             {
-                ProjectionNode* it = m_roots[i];
-                do
-                {   if (it->getCardinal() <= m_maxCardinal-1)
+                SubProjCombination& subProjCombination = m_subProjCombinations[node];
+                PROJDEP::setToZero(subProjCombination);
+                for (size_t k = m_motherOffsets[node]; k < m_motherOffsets[node + 1]; ++k)
+                {
+                    const NodeId mother = m_mothers[k];
+                    if (mother < layerBegin)
                     {
-                        LatticeTester::Coordinates projectionRep = it->getProjectionRepresentation(); // consider the projection
-                        projectionRep.insert(m_maxNumCoordinates-1);
-                        double weight =  m_figure->weights().getWeight(projectionRep);
-                        ProjectionNode* newNode = new ProjectionNode(m_maxNumCoordinates-1, (unsigned int) projectionRep.size() , weight); // create the node
-                        newNode->addMother(it);
-                        mapsToNodes.insert(std::pair<LatticeTester::Coordinates,ProjectionNode*>(std::move(projectionRep),newNode));
-                        newNodes.push_back(newNode);
+                        PROJDEP::update(m_meritsMem[mother], subProjCombination);
                     }
-                    it = it->getNextNode();
+                    else{
+                        PROJDEP::update(m_meritsTmp[mother], subProjCombination);
+                    } 
                 }
-                while(it != nullptr);
             }
+        }
 
-            std::sort(newNodes.begin(), newNodes.end(), ProjectionNode::compareNodePointers); // sort the nodes by increasing cardinal and decreasing weights
-
-            m_roots.push_back(newNodes[0]); // add the root corresponding to the dimension
+        /** 
+         * Extends by one dimension the evaluator. This creates new nodes corresponding to the new projections to consider
+         * while evaluating figures of merits. The nodes of the new layer are appended to the arrays of the evaluator
+         * in evaluation order.
+         * 
+         * The new projections are the projection {d}, where d is the new coordinate, and the projections \f$P \cup \{d\}\f$ 
+         * for each projection \f$P\f$ of the previous layers which is small enough. The mothers of \f$P \cup \{d\}\f$ are \f$P\f$ and the 
+         * projections \f$Q \cup \{d\}\f$ for each mother Q of P (or {d} if P is a singleton), so that they are found without any lookup.
+         *
+         * If pruning is enabled (see setPruning()), the nodes of the maximal cardinal of the previous layer are removed first: they are
+         * neither extended nor the mothers of any node, so that their merits are useless once their coordinate is chosen. Since the nodes of a layer are sorted by
+         * cardinal, they are at the end of the arrays, and the identifiers of the other nodes do not change. The evaluator thus only
+         * keeps the projections of cardinal lower than the maximal cardinal, in addition to those of the layer being evaluated.
+         */ 
+        void extend(){
+            if (m_pruning)
+            {
+                pruneLastLayer();
+            }
+            ++m_maxNumCoordinates; // increase maximal number of coordinates
+            const Dimension newCoord = m_maxNumCoordinates - 1;
+            const NodeId layerBegin = m_layerBegin.back(); // number of nodes in the previous layers
+
+            // the new projections, in creation order: first {newCoord}, then one for each source projection of the previous layers
+            std::vector<NodeId> sources; // source projection of each new projection (unused for {newCoord})
+            std::vector<unsigned int> cardinals;
+            std::vector<Real> weights;
+            std::vector<size_t> newIndexOfSource(layerBegin, 0); // index in the creation order of the new projection built from each source
+
+            Projection proj1DRep;
+            proj1DRep.insert(newCoord);
+            sources.push_back(layerBegin);
+            cardinals.push_back(1);
+            weights.push_back(m_figure->weightTable().weight(proj1DRep));
+
+            for(NodeId source = 0; source < layerBegin; ++source) // for each node of the previous layers
+            {
+                if (m_cardinals[source] <= m_maxCardinal-1)
+                {
+                    Projection projectionRep = projectionRepresentation(source); // consider the projection
+                    projectionRep.insert(newCoord);
+                    newIndexOfSource[source] = sources.size();
+                    sources.push_back(source);
+                    cardinals.push_back((unsigned int) projectionRep.size());
+                    weights.push_back(m_figure->weightTable().weight(projectionRep));
+                }
+            }
 
-            for(size_t i = 0; i < newNodes.size()-1; ++i)
+            // sort the nodes by increasing cardinal and decreasing weights
+            std::vector<size_t> order(sources.size());
+            for(size_t i = 0; i < order.size(); ++i)
+            {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&cardinals, &weights](size_t a, size_t b)
+                {
+                    return (cardinals[a] == cardinals[b]) ? (weights[a] > weights[b]) : (cardinals[a] < cardinals[b]);
+                });
+            std::vector<NodeId> nodeIdOf(order.size());
+            for(size_t i = 0; i < order.size(); ++i)
             {
-                newNodes[i]->setNextNode(newNodes[i+1]); // link the new nodes
+                nodeIdOf[order[i]] = layerBegin + i;
             }
 
-            for (ProjectionNode* node : newNodes) // for each new nodes
-            {   
-                LatticeTester::Coordinates tmp = node->getProjectionRepresentation();
-                for(unsigned int i = 0; i < m_maxNumCoordinates-1; ++i) // link to mothers which contains m_numCoordinates
+            for (size_t i : order) // append the new nodes in evaluation order
+            {
+                m_dimensions.push_back(newCoord);
+                m_cardinals.push_back(cardinals[i]);
+                m_weights.push_back(weights[i]);
+                if (cardinals[i] > 1)
                 {
-                    if (tmp.find(i) != tmp.end())
+                    const NodeId source = sources[i];
+                    m_mothers.push_back(source); // the projection without the new coordinate
+                    if (m_cardinals[source] == 1)
                     {
-                        tmp.erase(i);
-                        auto foo = mapsToNodes.find(tmp)->second;
-                        node->addMother(foo);
-                        tmp.insert(i);
+                        m_mothers.push_back(nodeIdOf[0]); // the projection {newCoord}
+                    }
+                    else
+                    {
+                        // the mothers containing the new coordinate, by increasing removed coordinate
+                        for (size_t k = m_motherOffsets[source] + 1; k < m_motherOffsets[source + 1]; ++k)
+                        {
+                            m_mothers.push_back(nodeIdOf[newIndexOfSource[m_mothers[k]]]);
+                        }
+                        m_mothers.push_back(nodeIdOf[newIndexOfSource[m_mothers[m_motherOffsets[source]]]]);
                     }
                 }
+                m_motherOffsets.push_back(m_mothers.size());
             }
+
+            m_subProjCombinations.resize(m_dimensions.size());
+            m_meritsMem.resize(m_dimensions.size());
+            m_meritsTmp.resize(m_dimensions.size());
+            m_layerBegin.push_back(m_dimensions.size());
+            account();
+        }
+
+        /**
+         * Removes the nodes of the last layer which are not extended by extend(), which are the last nodes of the arrays.
+         */
+        void pruneLastLayer()
+        {
+            if (m_maxNumCoordinates == 0)
+            {
+                return;
+            }
+            const NodeId lastLayerBegin = m_layerBegin[m_maxNumCoordinates - 1];
+            NodeId end = m_layerBegin.back();
+            while (end > lastLayerBegin && !(m_cardinals[end - 1] <= m_maxCardinal-1))
+            {
+                --end;
+            }
+            if (end == m_layerBegin.back())
+            {
+                return;
+            }
+            m_dimensions.resize(end);
+            m_cardinals.resize(end);
+            m_weights.resize(end);
+            m_mothers.resize(m_motherOffsets[end]);
+            m_motherOffsets.resize(end + 1);
+            m_subProjCombinations.resize(end);
+            m_meritsMem.resize(end);
+            m_meritsTmp.resize(end);
+            m_layerBegin.back() = end;
+            m_pruned = true;
+            account();
+        }
+
+        /**
+         * Removes all the nodes of the evaluator.
+         */
+        void clearNodes()
+        {
+            m_maxNumCoordinates = 0;
+            m_layerBegin.assign(1, 0);
+            m_dimensions.clear();
+            m_cardinals.clear();
+            m_weights.clear();
+            m_motherOffsets.assign(1, 0);
+            m_mothers.clear();
+            m_subProjCombinations.clear();
+            m_meritsMem.clear();
+            m_meritsTmp.clear();
+            m_pruned = false;
+            account();
+        }
+
+        /**
+         * Charges the arrays of the nodes to the projections component of LatBuilder::Memory.
+         */
+        void account()
+        {
+            m_memory.set(bytes(m_layerBegin) + bytes(m_dimensions) + bytes(m_cardinals) + bytes(m_weights) + bytes(m_motherOffsets)
+                         + bytes(m_mothers) + bytes(m_subProjCombinations) + bytes(m_meritsMem) + bytes(m_meritsTmp));
+        }
+
+        template <typename T>
+        static size_t bytes(const std::vector<T>& array)
+        {
+            return array.capacity() * sizeof(T);
         }
 
         /** Save the merits of all the nodes corresponding to the \c dimension.
@@ -392,13 +646,17 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
          */  
         void saveMerits(Dimension dimension)
         {
-            ProjectionNode* it = m_roots[dimension];
-            do
-            {
-                it->saveMerit();
-                it = it->getNextNode();
-            }
-            while(it != nullptr);
+            std::copy(m_meritsTmp.begin() + m_layerBegin[dimension], m_meritsTmp.begin() + m_layerBegin[dimension + 1], m_meritsMem.begin() + m_layerBegin[dimension]);
+        }
+
+        /** Exchanges the temporary and the stored merits of all the nodes corresponding to the \c dimension, so that
+         * the merits of the last net evaluated are saved without copying them. The stored merits of the layer are not
+         * used while evaluating the layer, and the temporary merits it gets back are overwritten by the next evaluation.
+         * @param dimension Dimension of the nodes.
+         */
+        void swapMerits(Dimension dimension)
+        {
+            std::swap_ranges(m_meritsTmp.begin() + m_layerBegin[dimension], m_meritsTmp.begin() + m_layerBegin[dimension + 1], m_meritsMem.begin() + m_layerBegin[dimension]);
         }
 
         /** 
@@ -412,14 +670,30 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
             }
         }
 
-        WeightedFigureOfMerit<PROJDEP> * m_figure;
+        Figure* m_figure;
 
         Dimension m_numCoordinates; 
         Dimension m_maxNumCoordinates;
         unsigned int m_maxCardinal; 
-        std::vector<ProjectionNode*> m_roots; // pointer to the first node of each layer (one by dimension)
+
+        // The projection nodes are stored layer by layer (one layer by dimension) in evaluation order,
+        // each field in its own array indexed by NodeId.
+        std::vector<NodeId> m_layerBegin; // index of the first node of each layer, followed by the total number of nodes
+        std::vector<Dimension> m_dimensions; // highest coordinate of the projection of each node, which is the dimension of its layer
+        std::vector<unsigned int> m_cardinals; // cardinal of the projection of each node
+        std::vector<Real> m_weights; // weight of the projection of each node
+        std::vector<size_t> m_motherOffsets; // the mothers of node i are m_mothers[m_motherOffsets[i]], ..., m_mothers[m_motherOffsets[i+1]-1]
+        std::vector<NodeId> m_mothers; // subprojections whose cardinal is one less of all the nodes
+        std::vector<SubProjCombination> m_subProjCombinations; // combination of the merits of the subprojections of each node
+        ProjectionSample m_sample; // sample of the nodes of the last estimated layer
+        std::vector<MeritStorage> m_meritsMem; // stored merit of each node
+        std::vector<MeritStorage> m_meritsTmp; // temporary merit of each node
+        bool m_meritsSaved; // whether the temporary merits of the last net evaluated were already saved
+        bool m_pruning; // whether extend() removes the nodes which are not extended
+        bool m_pruned; // whether nodes of the previous layers were removed by extend()
+        LatBuilder::Memory::Usage m_memory; // size of the arrays of the nodes
 };
 
 }}
 
-#endif
\ No newline at end of file
+#endif
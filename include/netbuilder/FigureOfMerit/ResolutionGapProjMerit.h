@@ -22,6 +22,10 @@
 #include "netbuilder/Helpers/RankComputer.h"
 #include "netbuilder/FigureOfMerit/LevelCombiner.h"
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 namespace NetBuilder { namespace FigureOfMerit {
 
 /** 
@@ -75,20 +79,25 @@ class ResolutionGapProjMerit<EmbeddingType::UNILEVEL>
          * @param net Digital to evaluate.
          * @param projection Projection to use.
          */ 
-        Real operator()(const AbstractDigitalNet& net , const LatticeTester::Coordinates& projection) 
+        Real operator()(const AbstractDigitalNet& net , const Projection& projection) 
         {
             Dimension dimension = projection.size();
             unsigned int numCols = net.numColumns();
 
+            unsigned int maxResolution = numCols/dimension;
+            if (maxResolution == 0 || isEquidistributed(net, projection, maxResolution))
+            {
+                return 0;
+            }
+
             m_rankComputer.reset(numCols);
 
-            unsigned int maxResolution = numCols/dimension;
             unsigned int merit = maxResolution; 
-            for(unsigned int resolution = 0; resolution < maxResolution; ++resolution)
+            for(unsigned int resolution = 0; resolution + 1 < maxResolution; ++resolution) // the maximal resolution is not reached
             {
                 for(auto coord : projection)
                 {
-                    m_rankComputer.addRow(net.generatingMatrix(coord).subMatrix(resolution, 0, 1,numCols));
+                    m_rankComputer.addRow(net.generatingMatrix(coord), resolution);
                 }
                 if(m_rankComputer.computeRank() == m_rankComputer.numRows())
                 {
@@ -112,8 +121,99 @@ class ResolutionGapProjMerit<EmbeddingType::UNILEVEL>
         }
 
     private:
+        /// Coordinate whose first rows were added to the rank computer of a PrefixTree.
+        struct PrefixNode
+        {
+            Dimension coord; // coordinate of the rows
+            GeneratingMatrix rows; // rows added to the rank computer
+            bool independent; // true if the rows added so far are linearly independent
+        };
+
+        /// Reduction of the first rows of the coordinates of the last projection tested for a given resolution.
+        struct PrefixTree
+        {
+            unsigned int numCols = 0; // number of columns of the rank computer
+            RankComputer rankComputer; // reduction with one checkpoint before the rows of each node
+            std::vector<PrefixNode> nodes; // coordinates added to the rank computer, in increasing order
+        };
+
+        /**
+         * Returns true if the first \c resolution rows of the generating matrices of the coordinates in \c projection
+         * are linearly independent, that is, if the projection reaches resolution \c resolution.
+         * The projections of CBCCoordinateSet come in lexicographic order for each order, so that consecutive projections
+         * share their smallest coordinates: the rows of these coordinates are kept in the rank computer of the
+         * resolution and only the rows of the other coordinates are reduced. A coordinate is shared only if its rows
+         * did not change, so that the reduction carries over from a net to the next one of the same CBC step.
+         */
+        bool isEquidistributed(const AbstractDigitalNet& net, const Projection& projection, unsigned int resolution)
+        {
+            unsigned int numCols = net.numColumns();
+            PrefixTree& tree = m_prefixTrees[resolution];
+            if (tree.numCols != numCols)
+            {
+                tree.numCols = numCols;
+                tree.rankComputer.reset(numCols);
+                tree.nodes.clear();
+            }
+
+            auto coord = projection.begin();
+            unsigned int shared = 0;
+            while (shared < tree.nodes.size() && coord != projection.end() && tree.nodes[shared].coord == *coord && sameRows(tree.nodes[shared].rows, net.generatingMatrix(*coord)))
+            {
+                ++shared;
+                ++coord;
+            }
+            while (tree.nodes.size() > shared)
+            {
+                tree.rankComputer.popCheckpoint();
+                tree.nodes.pop_back();
+            }
+            if (!tree.nodes.empty() && !tree.nodes.back().independent)
+            {
+                return false;
+            }
+
+            for(; coord != projection.end(); ++coord)
+            {
+                const GeneratingMatrix& matrix = net.generatingMatrix(*coord);
+                tree.rankComputer.pushCheckpoint();
+                for(unsigned int row = 0; row < resolution; ++row)
+                {
+                    tree.rankComputer.addRow(matrix, row);
+                }
+                bool independent = tree.rankComputer.computeRank() == tree.rankComputer.numRows();
+                tree.nodes.push_back({(Dimension) *coord, matrix.upperLeftSubMatrix(resolution, numCols), independent});
+                if (!independent)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Returns true if the first rows of \c matrix are the rows \c rows.
+         */
+        static bool sameRows(const GeneratingMatrix& rows, const GeneratingMatrix& matrix)
+        {
+            if (matrix.nCols() != rows.nCols() || matrix.nRows() < rows.nRows())
+            {
+                return false;
+            }
+            const bool packed = rows.nCols() <= GeneratingMatrix::maxPackedCols;
+            for(unsigned int i = 0; i < rows.nRows(); ++i)
+            {
+                if (packed ? rows.packedRow(i) != matrix.packedRow(i) : rows[i] != matrix[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
         unsigned int m_maxCardinal; // maximum order of subprojections to take into account
         RankComputer m_rankComputer; // use to compute the rank of matrices
+        std::map<unsigned int, PrefixTree> m_prefixTrees; // reductions of the last projection tested, for each resolution
 };
 
 /** Template specialization of the projection-dependent merit defined by the resolution-gap of the projection
@@ -159,7 +259,7 @@ class ResolutionGapProjMerit<EmbeddingType::MULTILEVEL>
          * @param net Digital to evaluate.
          * @param projection Projection to use.
          */ 
-        Real operator()(const AbstractDigitalNet& net , const LatticeTester::Coordinates& projection) 
+        Real operator()(const AbstractDigitalNet& net , const Projection& projection) 
         {
             Dimension dimension = projection.size();
 
@@ -181,17 +281,14 @@ class ResolutionGapProjMerit<EmbeddingType::MULTILEVEL>
             {
                 for(auto coord : projection)
                 {
-                    m_rankComputer.addRow(net.generatingMatrix(coord).subMatrix(resolution, 0,  1, numCols));
+                    m_rankComputer.addRow(net.generatingMatrix(coord), resolution);
                 }
-                std::vector<unsigned int> ranks = m_rankComputer.computeRanks(0,numCols);
-                for(unsigned int m = 1; m <= numCols; ++m)
+                // the first m columns have full row-rank if and only if m is at least the smallest full rank
+                for(unsigned int m = std::max(m_rankComputer.smallestFullRank(), 1u); m <= numCols; ++m)
                 {
-                    if (ranks[m-1] == m_rankComputer.numRows())
-                    {
-                        --merits[m-1];
-                    }
+                    --merits[m-1];
                 }
-                if (ranks[numCols-1] <  m_rankComputer.numRows())
+                if (m_rankComputer.smallestFullRank() > numCols)
                 {
                     break;
                 }
@@ -0,0 +1,127 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NETBUILDER__FIGURE_OF_MERIT_BIT__SAMPLED_SCREENING_FIGURE_H
+#define NETBUILDER__FIGURE_OF_MERIT_BIT__SAMPLED_SCREENING_FIGURE_H
+
+#include "netbuilder/FigureOfMerit/FigureOfMerit.h"
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace NetBuilder { namespace FigureOfMerit {
+
+/**
+ * Screening figure of a weighted figure of merit (see Task::CBCSearch::setPrefilter()) which estimates the partial merit
+ * of each candidate from a weight-proportional sample of the projections of its coordinate, with the estimates of the
+ * evaluators of the figure (see CBCFigureOfMeritEvaluator::estimate()).
+ *
+ * The screening merit of a candidate is its screening merit for the previous coordinates plus the lower end of the
+ * confidence interval of its estimate, or zero if that is negative. The candidates discarded by the search are those
+ * whose estimate is not competitive with the exact merit of the best candidate so far; only the others are evaluated
+ * exactly. Unlike the screening figures which bound the figure of merit, a competitive candidate is discarded with a small
+ * probability, which decreases as the sample size and \c zScore increase, so the search may select a slightly worse
+ * net than the exact search: this is a screening stage for huge weighted figures, not a replacement of their evaluation.
+ * The figure must have a finite norm type.
+ */
+class SampledScreeningFigure : public CBCFigureOfMerit
+{
+    public:
+
+        /**
+         * Constructor.
+         * @param figure Figure of merit to estimate, which must outlive the screening figure, for instance the figure of the search.
+         * @param sampleSize Number of projections sampled by coordinate.
+         * @param zScore Half-width of the confidence intervals, in estimated standard errors.
+         */
+        SampledScreeningFigure(CBCFigureOfMerit& figure, size_t sampleSize, Real zScore = 2):
+            m_figure(figure),
+            m_sampleSize(sampleSize),
+            m_zScore(zScore)
+        {}
+
+        virtual Accumulator accumulator(Real initialValue) const override
+        { return m_figure.accumulator(initialValue); }
+
+        /**
+         * Returns a <code>std::unique_ptr</code> to an evaluator for the screening figure.
+         * @throw std::invalid_argument if the evaluators of the figure do not estimate merit values.
+         */
+        virtual std::unique_ptr<CBCFigureOfMeritEvaluator> evaluator() override
+        {
+            auto evaluator = m_figure.evaluator();
+            if (!evaluator->estimates())
+            {
+                throw std::invalid_argument("The figure of merit cannot be estimated from a sample of projections.");
+            }
+            return std::make_unique<SampledScreeningEvaluator>(std::move(evaluator), m_sampleSize, m_zScore);
+        }
+
+        virtual std::string format() const override
+        {
+            std::ostringstream stream;
+            stream << "Sampled screening of " << m_sampleSize << " projections by coordinate, at " << m_zScore << " standard errors, of:" << std::endl;
+            stream << m_figure.format();
+            return stream.str();
+        }
+
+    private:
+
+        CBCFigureOfMerit& m_figure;
+        size_t m_sampleSize;
+        Real m_zScore;
+
+        /**
+         * Evaluator which drives an evaluator of the figure and returns the lower end of its estimates.
+         */
+        class SampledScreeningEvaluator : public CBCFigureOfMeritEvaluator
+        {
+            public:
+                SampledScreeningEvaluator(std::unique_ptr<CBCFigureOfMeritEvaluator> evaluator, size_t sampleSize, Real zScore):
+                    m_evaluator(std::move(evaluator)),
+                    m_sampleSize(sampleSize),
+                    m_zScore(zScore)
+                {}
+
+                virtual MeritValue operator() (const AbstractDigitalNet& net, Dimension dimension, MeritValue initialValue, int verbose = 0) override
+                {
+                    const MeritEstimate estimate = m_evaluator->estimate(net, dimension, m_sampleSize, m_zScore);
+                    if (verbose > 0)
+                    {
+                        std::cout << "estimate: " << estimate.value << " +/- " << estimate.halfWidth << std::endl;
+                    }
+                    return initialValue + std::max<Real>(estimate.lower(), 0);
+                }
+
+                virtual void reset() override { m_evaluator->reset(); }
+
+                virtual void prepareForNextDimension() override { m_evaluator->prepareForNextDimension(); }
+
+                virtual void lastNetWasBest() override { m_evaluator->lastNetWasBest(); }
+
+            private:
+                std::unique_ptr<CBCFigureOfMeritEvaluator> m_evaluator;
+                size_t m_sampleSize;
+                Real m_zScore;
+        };
+};
+
+}}
+
+#endif
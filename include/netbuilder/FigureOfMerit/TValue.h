@@ -20,6 +20,17 @@
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
 #include "netbuilder/FigureOfMerit/LevelCombiner.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace NetBuilder { namespace FigureOfMerit {
 
@@ -33,9 +44,16 @@ namespace NetBuilder { namespace FigureOfMerit {
  * the coordinate-uniform evaluation algorithm used for kernel-based
  * figures. That is why the Storage class from LatBuilder is used here,
  * with the same trick as for CoordUniformFigureOfMerit.
+ *
+ * The figure can also be evaluated coordinate by coordinate: the CBC evaluator keeps,
+ * for each point, the truncated product of the factors of the coordinates already fixed,
+ * so that each candidate for the next coordinate costs one truncated multiplication per point.
+ * These products take \f$2^k (k+1)\f$ machine integers.
+ * The evaluator of the whole net instead streams the points of the nets with more than \f$2^{20}\f$ points
+ * (see #maxStoredLevels), in constant memory.
  */
 template <EmbeddingType ET>
-class TValue : public FigureOfMerit
+class TValue : public CBCFigureOfMerit
 {
     public:
 
@@ -55,11 +73,45 @@ class TValue : public FigureOfMerit
             return std::make_unique<TValueEvaluator>(this);
         }
 
+        /**
+         * Returns a <code>std::unique_ptr</code> to an evaluator of the figure of merit coordinate by coordinate.
+         */
+        virtual std::unique_ptr<CBCFigureOfMeritEvaluator> evaluator() override
+        {
+            return std::make_unique<TValueCBCEvaluator>(this);
+        }
+
+        /**
+         * Creates a new accumulator: the t-value of a net is the largest t-value of its projections
+         * on its first coordinates.
+         * @param initialValue Initial accumulator value.
+         */
+        virtual Accumulator accumulator(Real initialValue) const override
+        { return Accumulator(std::move(initialValue), std::numeric_limits<Real>::infinity()); }
+
+        /**
+         * Returns \c baseMerit: the partial merit value of a candidate is the maximum of \c baseMerit and the t-value
+         * of the projection on the first coordinates, which cannot be lower.
+         */
+        virtual Real meritLowerBound(Real baseMerit) const override
+        { return baseMerit; }
+
         MeritValue combine(const RealVector& merits)
         {
             return (*m_combiner)(merits);
         }
 
+        /**
+         * Largest number of levels for which the evaluator of the whole net stores the permuted kernel values of
+         * all the points; the t-values of larger nets are computed by streaming their points.
+         */
+        static constexpr unsigned int maxStoredLevels = 20;
+
+        /**
+         * Number of consecutive points evaluated together when streaming the points of a net.
+         */
+        static constexpr size_t streamingChunkSize = size_t(1) << 16;
+
         virtual std::string format() const override
         {
             return "";
@@ -68,6 +120,183 @@ class TValue : public FigureOfMerit
 
 
     private:
+        /**
+         * Returns true if the polynomials of the \f$2^k\f$ points of a net in dimension \c s
+         * can be accumulated by accumulatePoint without overflow.
+         * The coefficients handled by accumulatePoint are bounded in absolute value by the number of subsets of at most
+         * \c k coordinates for one point, hence by \f$2^k\f$ times this number for the sum over all the points.
+         */ 
+        static bool fitsInMachineIntegers(Dimension s, unsigned int k)
+        {
+            double numSubsets = 0;
+            double binomial = 1;
+            for (unsigned int j = 0; j <= std::min<Dimension>(k, s); ++j)
+            {
+                numSubsets += binomial;
+                binomial = binomial * (double) (s - j) / (j + 1);
+            }
+            return std::ldexp(numSubsets, (int) k) < std::ldexp(1.0, std::numeric_limits<long>::digits - 1);
+        }
+
+        /**
+         * Adds to \c acc the contribution of point \c i to the truncated weight polynomial.
+         * As the factor of coordinate \f$j\f$ is \f$1 - (2z)^{v_j}\f$ where \f$v_j\f$ is the permuted kernel value,
+         * the product is computed as a polynomial in \f$w = 2z\f$ (see unscale), whose coefficients are small integers.
+         * Each factor is applied in place in \f$O(k)\f$ operations on machine integers, without any allocation.
+         * @param permutedValues Permuted kernel values for each coordinate.
+         * @param i Index of the point.
+         * @param k Truncation degree.
+         * @param prod Buffer of size <code>k + 1</code>.
+         * @param acc Accumulator of size <code>k + 1</code>.
+         */ 
+        template <typename PERMUTED>
+        static void accumulatePoint(const PERMUTED& permutedValues, size_t i, unsigned int k, std::vector<long>& prod, std::vector<long>& acc)
+        {
+            prod[0] = 1;
+            unsigned int degree = 0;
+            for(const auto& values : permutedValues)
+            {
+                const unsigned int v = (unsigned int) values[i];
+                if (v > k)
+                {
+                    continue; // the factor is 1 after truncation
+                }
+                const unsigned int newDegree = std::min(k, degree + v);
+                std::fill(prod.begin() + degree + 1, prod.begin() + newDegree + 1, 0);
+                degree = newDegree;
+                for (unsigned int d = degree; d >= v; --d)
+                {
+                    prod[d] -= prod[d - v];
+                }
+            }
+            for (unsigned int d = 0; d <= degree; ++d)
+            {
+                acc[d] += prod[d];
+            }
+        }
+
+        /**
+         * Adds to \c acc the contributions of the first \c numPoints points, as accumulatePoint, for a truncation
+         * degree \c K known at compile time: the products and their sum are kept in fixed-size arrays, so that the
+         * loops over the degrees have constant bounds.
+         */
+        template <unsigned int K>
+        static void accumulatePoints(const std::vector<std::vector<unsigned int>>& permutedValues, size_t numPoints, std::vector<long>& acc)
+        {
+            std::array<long, K + 1> sum{};
+            std::array<long, K + 1> prod;
+            for (size_t i = 0; i < numPoints; ++i)
+            {
+                prod.fill(0);
+                prod[0] = 1;
+                for (const auto& values : permutedValues)
+                {
+                    const unsigned int v = values[i]; // kernel values are at least 1
+                    if (v > K)
+                    {
+                        continue; // the factor is 1 after truncation
+                    }
+                    for (unsigned int d = K; d >= v; --d)
+                    {
+                        prod[d] -= prod[d - v];
+                    }
+                }
+                for (unsigned int d = 0; d <= K; ++d)
+                {
+                    sum[d] += prod[d];
+                }
+            }
+            for (unsigned int d = 0; d <= K; ++d)
+            {
+                acc[d] += sum[d];
+            }
+        }
+
+        /**
+         * Adds to \c acc the contributions of the \f$2^k\f$ points of a net by dispatching to the instance of
+         * accumulatePoints of degree \c k, among the degrees \c K.
+         */
+        template <size_t... K>
+        static void accumulateFixedDegree(std::index_sequence<K...>, const std::vector<std::vector<unsigned int>>& permutedValues, unsigned int k, std::vector<long>& acc)
+        {
+            typedef void (*Accumulate)(const std::vector<std::vector<unsigned int>>&, size_t, std::vector<long>&);
+            static constexpr Accumulate accumulate[] = { &accumulatePoints<K>... };
+            accumulate[k](permutedValues, size_t(1) << k, acc);
+        }
+
+        /**
+         * Returns the polynomial in \f$z\f$ corresponding to the coefficients \c acc of a polynomial in \f$w = 2z\f$, 
+         * that is with the coefficient of degree \f$d\f$ multiplied by \f$2^d\f$.
+         */ 
+        static IntPolynomial unscale(const std::vector<long>& acc)
+        {
+            IntPolynomial res(0);
+            for (unsigned int d = 0; d < acc.size(); ++d)
+            {
+                if (acc[d] != 0)
+                {
+                    NTL::ZZ coefficient;
+                    coefficient = acc[d];
+                    coefficient <<= d;
+                    NTL::SetCoeff(res, d, coefficient);
+                }
+            }
+            return res;
+        }
+
+        /**
+         * Returns the auxiliary polynomial \f$Q_m(z)\f$ for \c s coordinates and \c numLevels levels.
+         */ 
+        static IntPolynomial auxPoly(Dimension s, unsigned int numLevels)
+        {
+            IntPolynomial res(1);
+            IntPolynomial base(1);
+            for (unsigned int j = 1; j <= numLevels; ++j)
+            {
+                NTL::SetCoeff(base, j, 1 << (j - 1)) ;
+            }
+            for (unsigned int k = 1; k <= s; ++k)
+            {
+                res = NTL::MulTrunc(base, res, numLevels + 1);
+            }
+            return res;
+        }
+
+        /**
+         * Stores in \c values the kernel values \f$\nu^\star(\frac{i}{2^k})\f$, \f$ i = 0, \dots, 2^k-1\f$, for \f$k\f$ = \c numLevels.
+         */ 
+        static void computeKernelValues(unsigned int numLevels, boost::numeric::ublas::vector<uInteger>& values)
+        {
+            values.resize(1 << numLevels);
+            values[0] = numLevels + 1;
+            uInteger width = 1;
+            uInteger index = 1;
+            for(unsigned int value = numLevels; value >= 1; --value)
+            {
+                for(uInteger i = index; i < index+width; ++i)
+                {
+                    values[i] = value;
+                }
+                index = index + width;
+                width *= 2;
+            }
+        }
+
+        /**
+         * Returns the t-value of a net with \f$2^m\f$ points from the sum \c truncWeightPoly of the products of its points,
+         * where \c aux is the auxiliary polynomial.
+         */ 
+        static unsigned int tValue(const IntPolynomial& aux, const IntPolynomial& truncWeightPoly, unsigned int m)
+        {
+            const IntPolynomial poly = NTL::MulTrunc(aux, truncWeightPoly, m + 1);
+            unsigned int rho = 1;
+            while(rho <= m && NTL::coeff(poly, rho) == 0)
+            {
+                ++rho;
+            }
+            return m + 1 - rho;
+        }
+
         /**
          * Evaluator for the t-value figure of merit.
          */ 
@@ -102,28 +331,40 @@ class TValue : public FigureOfMerit
                     Dimension s = net.dimension();
                     unsigned int k = net.numColumns();
 
-                    updateDimensionAndNbLevels(s, k);  // update the pre-computed quantities according to dimension and size of the net
+                    if (k > maxStoredLevels)
+                    {
+                        return streamedTValue(net, s, k);
+                    }
 
-                    std::vector<boost::numeric::ublas::vector_indirect<const boost::numeric::ublas::vector<uInteger> , typename LatBuilder::IndexMap< typename LatBuilder::StorageTraits<Storage>::Stride>>> permutedValues;
-                    permutedValues.reserve(s);
+                    updateDimensionAndNbLevels(s, k);  // update the pre-computed quantities according to dimension and size of the net
 
-                    // compute the permutations of the kernel values for all coordinates
+                    // gather the permutations of the kernel values for all coordinates
+                    std::vector<std::vector<unsigned int>> permutedValues(s);
                     for(Dimension coord = 0; coord < s; ++coord)
                     {
-                        permutedValues.push_back(m_storage->strided(kernelValues(), net.generatingMatrix(coord)));
+                        permute(net, coord, permutedValues[coord]);
                     }
 
                     IntPolynomial truncWeightPoly(0);
-                    for(size_t i = 0; i < (unsigned int) (1 << k); ++i)
+                    if (fitsInMachineIntegers(s, k))
                     {
-                        IntPolynomial prod(1);
-                        for(Dimension coord = 0; coord < s; ++coord)
+                        std::vector<long> acc(k + 1, 0);
+                        accumulateFixedDegree(std::make_index_sequence<maxStoredLevels + 1>(), permutedValues, k, acc);
+                        truncWeightPoly = unscale(acc);
+                    }
+                    else
+                    {
+                        for(size_t i = 0; i < (unsigned int) (1 << k); ++i)
                         {
-                            IntPolynomial fact(1);
-                            NTL::SetCoeff(fact, permutedValues[coord][i], - (1 << permutedValues[coord][i]));
-                            prod = NTL::MulTrunc(prod, fact, k + 1);
+                            IntPolynomial prod(1);
+                            for(Dimension coord = 0; coord < s; ++coord)
+                            {
+                                IntPolynomial fact(1);
+                                NTL::SetCoeff(fact, permutedValues[coord][i], - (1 << permutedValues[coord][i]));
+                                prod = NTL::MulTrunc(prod, fact, k + 1);
+                            }
+                            truncWeightPoly += prod;
                         }
-                        truncWeightPoly += prod;
                     }
                     truncWeightPoly = NTL::MulTrunc(m_auxPoly, truncWeightPoly, k + 1);
                     unsigned int rho = 1;
@@ -144,6 +385,100 @@ class TValue : public FigureOfMerit
 
             private:
 
+                /**
+                 * Computes the t-value of \c net, of dimension \c s with \f$2^k\f$ points, without storing the permuted
+                 * kernel values: the points are generated in Gray code order from the columns of the generating matrices,
+                 * by consecutive chunks of #streamingChunkSize points evaluated concurrently by the shared thread pool
+                 * (see LatBuilder::ThreadPool::global()). Each worker accumulates the products of its points,
+                 * which are exact, so that the result does not depend on the number of workers.
+                 */
+                static MeritValue streamedTValue(const AbstractDigitalNet& net, Dimension s, unsigned int k)
+                {
+                    if (k >= static_cast<unsigned int>(std::numeric_limits<size_t>::digits))
+                    {
+                        throw std::invalid_argument("the t-value of a net of 2^" + std::to_string(k) + " points cannot be computed");
+                    }
+                    std::vector<std::vector<unsigned long>> cols(s);
+                    for(Dimension coord = 0; coord < s; ++coord)
+                    {
+                        cols[coord] = net.generatingMatrix(coord).getColsReverse();
+                    }
+
+                    const size_t numPoints = size_t(1) << k;
+                    const size_t chunkSize = streamingChunkSize;
+                    const size_t numChunks = (numPoints + chunkSize - 1) / chunkSize;
+                    const bool fast = fitsInMachineIntegers(s, k);
+                    auto& pool = LatBuilder::ThreadPool::global();
+                    std::vector<std::vector<long>> accs(pool.size(), std::vector<long>(k + 1, 0));
+                    std::vector<IntPolynomial> slowAccs(pool.size(), IntPolynomial(0));
+
+                    pool.parallelFor(numChunks, [&](unsigned int worker, size_t chunk)
+                    {
+                        const size_t begin = chunk * chunkSize;
+                        const size_t end = std::min(begin + chunkSize, numPoints);
+
+                        // the point of index i is the image of the Gray code of i by the generating matrices
+                        std::vector<unsigned long> points(s, 0);
+                        const size_t gray = begin ^ (begin >> 1);
+                        for(Dimension coord = 0; coord < s; ++coord)
+                        {
+                            for (size_t bits = gray; bits != 0; bits &= bits - 1)
+                            {
+                                points[coord] ^= cols[coord][lowestSetBit(bits)];
+                            }
+                        }
+
+                        std::vector<unsigned int> values(s);
+                        std::vector<const unsigned int*> pointValues(s); // kernel values of the current point, by coordinate
+                        for(Dimension coord = 0; coord < s; ++coord)
+                        {
+                            pointValues[coord] = &values[coord];
+                        }
+                        std::vector<long> prod(k + 1);
+                        for(size_t i = begin; i < end; ++i)
+                        {
+                            for(Dimension coord = 0; coord < s; ++coord)
+                            {
+                                if (i > begin)
+                                {
+                                    points[coord] ^= cols[coord][lowestSetBit(i)]; // the Gray codes of i-1 and i differ by the lowest set bit of i
+                                }
+                                values[coord] = kernelValue(points[coord], k);
+                            }
+                            if (fast)
+                            {
+                                accumulatePoint(pointValues, 0, k, prod, accs[worker]);
+                            }
+                            else
+                            {
+                                IntPolynomial product(1);
+                                for(Dimension coord = 0; coord < s; ++coord)
+                                {
+                                    IntPolynomial fact(1);
+                                    NTL::SetCoeff(fact, values[coord], - (NTL::ZZ(1) << values[coord]));
+                                    product = NTL::MulTrunc(product, fact, k + 1);
+                                }
+                                slowAccs[worker] += product;
+                            }
+                        }
+                    });
+
+                    IntPolynomial truncWeightPoly(0);
+                    for (unsigned int worker = 0; worker < pool.size(); ++worker)
+                    {
+                        truncWeightPoly += fast ? unscale(accs[worker]) : slowAccs[worker];
+                    }
+                    return tValue(auxPoly(s, k), truncWeightPoly, k);
+                }
+
+                /**
+                 * Returns the kernel value \f$\nu^\star(\frac{i}{2^k})\f$ stored by computeKernelValues at index \c i.
+                 */
+                static unsigned int kernelValue(unsigned long i, unsigned int k)
+                {
+                    return i == 0 ? k + 1 : k - highestSetBit(i);
+                }
+
                 Dimension m_dimension;
                 unsigned int m_numLevels;
                 IntPolynomial m_auxPoly;
@@ -173,16 +508,7 @@ class TValue : public FigureOfMerit
                  */ 
                 void updateAuxPoly()
                 {
-                    m_auxPoly = IntPolynomial(1);
-                    IntPolynomial base(1);
-                    for (unsigned int j = 1; j <= m_numLevels; ++j)
-                    {
-                        NTL::SetCoeff(base, j, 1 << (j - 1)) ;
-                    }
-                    for (unsigned int k = 1; k <= m_dimension; ++k)
-                    {
-                        m_auxPoly = NTL::MulTrunc(base, m_auxPoly, m_numLevels + 1);
-                    }
+                    m_auxPoly = auxPoly(m_dimension, m_numLevels);
                 }
 
                 /**
@@ -190,29 +516,265 @@ class TValue : public FigureOfMerit
                  */ 
                 void updateKernelValues()
                 {
-                    m_kernelValues.resize(1 << m_numLevels);
-                    m_kernelValues[0] = m_numLevels + 1;
-                    uInteger width = 1;
-                    uInteger index = 1;
-                    for(unsigned int value = m_numLevels; value >= 1; --value)
+                    computeKernelValues(m_numLevels, m_kernelValues);
+                }
+
+                /**
+                 * Returns a const reference to the kernel values
+                 */ 
+                const boost::numeric::ublas::vector<uInteger>& kernelValues() const
+                {
+                    return m_kernelValues;
+                }
+
+                /**
+                 * Stores in \c values the permuted kernel values of coordinate \c coord of \c net.
+                 */
+                void permute(const AbstractDigitalNet& net, Dimension coord, std::vector<unsigned int>& values) const
+                {
+                    m_storage->gather(kernelValues(), net.generatingMatrix(coord), values);
+                }
+
+        };
+
+        /**
+         * Evaluator for the t-value figure of merit, coordinate by coordinate.
+         *
+         * For each point \f$i\f$, the evaluator keeps the truncated product \f$\prod_j (1 - (2z)^{v_{i,j}})\f$ over the
+         * coordinates \f$j\f$ already fixed, as a polynomial in \f$w = 2z\f$ on machine integers as long as
+         * TValue::fitsInMachineIntegers allows it, and as an IntPolynomial otherwise. A candidate for the next coordinate
+         * multiplies each product by its factor, and the products are updated with the factors of the best candidate
+         * when the evaluator is prepared for the next coordinate.
+         */ 
+        class TValueCBCEvaluator:
+            public CBCFigureOfMeritEvaluator
+        {
+            public:
+
+                /// Storage class 
+                typedef LatBuilder::Storage<LatBuilder::LatticeType::DIGITAL, ET,  LatBuilder::Compress::NONE> Storage;
+
+                /**
+                 * Constructor.
+                 * @param figure Pointer to the figure of merit.
+                 */ 
+                TValueCBCEvaluator(TValue* figure):
+                    m_figure(figure),
+                    m_numLevels(0),
+                    m_hasBestValues(false)
+                {
+                    updateNbLevels(1);
+                };
+
+                /** 
+                 * Computes the t-value of the projection of \c net on its first coordinates up to \c dimension, from the
+                 * products of the previous coordinates.
+                 * @param net Net to evaluate.
+                 * @param dimension Dimension to compute.
+                 * @param initialValue Initial value of the merit.
+                 * @param verbose Verbosity level.
+                 */ 
+                virtual MeritValue operator()(const AbstractDigitalNet& net, Dimension dimension, MeritValue initialValue, int verbose = 0) override
+                {
+                    const unsigned int k = net.numColumns();
+                    if (k != m_numLevels)
+                    {
+                        updateNbLevels(k);
+                    }
+                    if (dimension != m_numCoords) // the products do not match the previous coordinates of the net
                     {
-                        for(uInteger i = index; i < index+width; ++i)
+                        reset();
+                        for(Dimension coord = 0; coord < dimension; ++coord)
                         {
-                            m_kernelValues[i] = value;
+                            permute(net, coord, m_bestValues);
+                            multiply(m_bestValues);
                         }
-                        index = index + width;
-                        width *= 2;
                     }
+                    permute(net, dimension, m_lastValues);
+
+                    const Dimension s = dimension + 1;
+                    while (m_auxPolys.size() <= s)
+                    {
+                        m_auxPolys.push_back(auxPoly((Dimension) m_auxPolys.size(), k));
+                    }
+                    const IntPolynomial& aux = m_auxPolys[s];
+                    if (!m_slowProducts && !fitsInMachineIntegers(s, k))
+                    {
+                        convertProducts();
+                    }
+                    const bool fast = !m_slowProducts;
+
+                    RealVector merits(ET == EmbeddingType::MULTILEVEL ? k : 1);
+                    std::vector<long> acc(k + 1, 0);
+                    IntPolynomial truncWeightPoly(0);
+                    size_t i = 0;
+                    for(unsigned int m = (ET == EmbeddingType::MULTILEVEL) ? 0 : k; m <= k; ++m)
+                    {
+                        const size_t end = size_t(1) << m; // the first 2^m points form the net of level m
+                        for(; i < end; ++i)
+                        {
+                            const unsigned int v = m_lastValues[i];
+                            if (fast)
+                            {
+                                const long* prod = &m_products[i * (k + 1)];
+                                for (unsigned int d = 0; d <= k; ++d)
+                                {
+                                    acc[d] += prod[d];
+                                }
+                                for (unsigned int d = v; d <= k; ++d)
+                                {
+                                    acc[d] -= prod[d - v];
+                                }
+                            }
+                            else
+                            {
+                                truncWeightPoly += NTL::MulTrunc(m_slowProducts->at(i), factor(v), k + 1);
+                            }
+                        }
+                        if (m >= 1 && (ET == EmbeddingType::MULTILEVEL || m == k))
+                        {
+                            if (fast)
+                            {
+                                truncWeightPoly = unscale(acc);
+                            }
+                            merits[ET == EmbeddingType::MULTILEVEL ? m - 1 : 0] = tValue(aux, truncWeightPoly, m);
+                        }
+                    }
+
+                    auto merit = m_figure->accumulator(std::move(initialValue));
+                    merit.accumulate(1, ET == EmbeddingType::MULTILEVEL ? m_figure->combine(merits) : merits[0], 1);
+                    return merit.value();
+                }
+
+                /**     
+                 * Resets the evaluator and prepare it to evaluate a new net.
+                 */ 
+                virtual void reset() override
+                {
+                    m_numCoords = 0;
+                    m_products.assign((size_t(1) << m_numLevels) * (m_numLevels + 1), 0);
+                    for (size_t i = 0; i < (size_t(1) << m_numLevels); ++i)
+                    {
+                        m_products[i * (m_numLevels + 1)] = 1;
+                    }
+                    m_slowProducts.reset();
+                    m_hasBestValues = false;
                 }
 
                 /**
-                 * Returns a const reference to the kernel values
+                 * Multiplies the products of the points by the factors of the best candidate for the previous coordinate.
+                 */
+                virtual void prepareForNextDimension() override
+                {
+                    if (m_hasBestValues)
+                    {
+                        multiply(m_bestValues);
+                        m_hasBestValues = false;
+                    }
+                }
+
+                /**
+                 * Records the permuted kernel values of the last candidate, whose factors will be applied to the products
+                 * by the next call to prepareForNextDimension().
+                 */
+                virtual void lastNetWasBest() override
+                {
+                    m_bestValues = m_lastValues;
+                    m_hasBestValues = true;
+                }
+
+            private:
+                TValue* m_figure;
+                unsigned int m_numLevels;
+                std::unique_ptr<Storage> m_storage; // storage for the kernel values
+                boost::numeric::ublas::vector<uInteger> m_kernelValues;
+                std::vector<IntPolynomial> m_auxPolys; // auxiliary polynomials, by number of coordinates
+                Dimension m_numCoords; // number of coordinates in the products
+                std::vector<long> m_products; // truncated products in w = 2z of the points, k + 1 coefficients per point
+                std::unique_ptr<std::vector<IntPolynomial>> m_slowProducts; // truncated products in z, once they exceed machine integers
+                std::vector<unsigned int> m_lastValues; // permuted kernel values of the last candidate
+                std::vector<unsigned int> m_bestValues; // permuted kernel values of the best candidate
+                bool m_hasBestValues;
+
+                typedef LatBuilder::SizeParam<LatBuilder::LatticeType::DIGITAL, ET> SizeParam;
+
+                /**
+                 * Updates the pre-computed quantities for nets with \f$2^k\f$ points and resets the products.
                  */ 
-                const boost::numeric::ublas::vector<uInteger>& kernelValues() const
+                void updateNbLevels(unsigned int k)
                 {
-                    return m_kernelValues;
+                    m_numLevels = k;
+                    m_storage = std::make_unique<Storage>(SizeParam(1 << m_numLevels));
+                    computeKernelValues(m_numLevels, m_kernelValues);
+                    m_auxPolys.clear();
+                    reset();
+                }
+
+                /**
+                 * Stores in \c values the permuted kernel values of coordinate \c coord of \c net.
+                 */ 
+                void permute(const AbstractDigitalNet& net, Dimension coord, std::vector<unsigned int>& values) const
+                {
+                    m_storage->gather(m_kernelValues, net.generatingMatrix(coord), values);
+                }
+
+                /**
+                 * Returns the factor \f$1 - 2^v z^v\f$ of a coordinate of kernel value \c v.
+                 */ 
+                static IntPolynomial factor(unsigned int v)
+                {
+                    IntPolynomial res(1);
+                    NTL::SetCoeff(res, v, - (1 << v));
+                    return res;
                 }
 
+                /**
+                 * Converts the products of the points from machine integers to polynomials in \f$z\f$.
+                 */ 
+                void convertProducts()
+                {
+                    const unsigned int k = m_numLevels;
+                    const size_t numPoints = size_t(1) << k;
+                    m_slowProducts = std::make_unique<std::vector<IntPolynomial>>(numPoints);
+                    for (size_t i = 0; i < numPoints; ++i)
+                    {
+                        (*m_slowProducts)[i] = unscale(std::vector<long>(m_products.begin() + i * (k + 1), m_products.begin() + (i + 1) * (k + 1)));
+                    }
+                    std::vector<long>().swap(m_products);
+                }
+
+                /**
+                 * Multiplies the products of the points by the factors of a coordinate of permuted kernel values \c values.
+                 */ 
+                void multiply(const std::vector<unsigned int>& values)
+                {
+                    const unsigned int k = m_numLevels;
+                    ++m_numCoords;
+                    if (!m_slowProducts && !fitsInMachineIntegers(m_numCoords + 1, k))
+                    {
+                        convertProducts(); // the next candidates could overflow the machine integers
+                    }
+                    for (size_t i = 0; i < values.size(); ++i)
+                    {
+                        const unsigned int v = values[i];
+                        if (v > k)
+                        {
+                            continue; // the factor is 1 after truncation
+                        }
+                        if (m_slowProducts)
+                        {
+                            (*m_slowProducts)[i] = NTL::MulTrunc((*m_slowProducts)[i], factor(v), k + 1);
+                        }
+                        else
+                        {
+                            long* prod = &m_products[i * (k + 1)];
+                            for (unsigned int d = k; d >= v; --d)
+                            {
+                                prod[d] -= prod[d - v];
+                            }
+                        }
+                    }
+                }
         };
 
         pCombiner m_combiner;
@@ -256,31 +818,50 @@ MeritValue TValue<EmbeddingType::MULTILEVEL>::TValueEvaluator::operator()(const
 
     updateDimensionAndNbLevels(s, k); 
 
-    std::vector<boost::numeric::ublas::vector_indirect<const boost::numeric::ublas::vector<uInteger> , typename LatBuilder::IndexMap< typename LatBuilder::StorageTraits<Storage>::Stride>>> permutedValues;
-    permutedValues.reserve(s);
-
+    std::vector<std::vector<unsigned int>> permutedValues(s);
     for(Dimension coord = 0; coord < s; ++coord)
     {
-        permutedValues.push_back(m_storage->strided(kernelValues(), net.generatingMatrix(coord)));
+        permute(net, coord, permutedValues[coord]);
     }
 
     RealVector merits(k);
 
+    const bool fast = fitsInMachineIntegers(s, k);
+    std::vector<long> acc;
+    std::vector<long> prod;
+    if (fast)
+    {
+        acc.assign(k + 1, 0);
+        prod.resize(k + 1);
+        acc[0] = 1;
+    }
+
     IntPolynomial truncWeightPoly(0);
     NTL::SetCoeff(truncWeightPoly, 0, 1);
     size_t i = 1;
     for(unsigned int m = 1; m <= k; ++m)
     {
-        for(size_t j = i; j < 2 * i ; ++j)
+        if (fast)
         {
-            IntPolynomial prod(1);
-            for(Dimension coord = 0; coord < s; ++coord)
+            for(size_t j = i; j < 2 * i ; ++j)
             {
-                IntPolynomial fact(1);
-                NTL::SetCoeff(fact, permutedValues[coord][j], - (1 << permutedValues[coord][j]));
-                prod = NTL::MulTrunc(prod, fact, k + 1);
+                accumulatePoint(permutedValues, j, k, prod, acc);
+            }
+            truncWeightPoly = unscale(acc);
+        }
+        else
+        {
+            for(size_t j = i; j < 2 * i ; ++j)
+            {
+                IntPolynomial prod(1);
+                for(Dimension coord = 0; coord < s; ++coord)
+                {
+                    IntPolynomial fact(1);
+                    NTL::SetCoeff(fact, permutedValues[coord][j], - (1 << permutedValues[coord][j]));
+                    prod = NTL::MulTrunc(prod, fact, k + 1);
+                }
+                truncWeightPoly += prod;
             }
-            truncWeightPoly += prod;
         }
         IntPolynomial partialTruncWeightPoly = NTL::MulTrunc(m_auxPoly, truncWeightPoly, m + 1);
         unsigned int rho = 1;
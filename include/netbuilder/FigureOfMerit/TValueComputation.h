@@ -24,16 +24,80 @@
 
 #include "netbuilder/GeneratingMatrix.h"
 
+#include <vector>
+
 namespace NetBuilder {
 
     /**
      * Class to compute the t-value of a projection of a digital net in base 2.
      * This class uses a refined version of the gaussian elimination to compute efficiently the t-value of
      * a projection, knowing the t-value of the smaller projections. 
+     * When the shared LatBuilder::ThreadPool has more than one worker, the compositions of the rows of large projections are
+     * split between the workers by the number of rows of one coordinate; the workers stop as soon as one of them finds dependent rows.
      * \todo add a reference if a paper is made.
      */  
     struct GaussMethod
     {
+        /**
+         * Row reductions of the compositions of the rows of the generating matrices of a projection, which are
+         * reused to compute the t-values of the projections obtained by adding one coordinate to it.
+         * 
+         * A composition \f$(a_1, ..., a_q)\f$ selects the first \f$ a_j \f$ rows of the \f$ j \f$-th matrix. The compositions
+         * are enumerated depth-first, one row at a time, so that each selection extends the previous one: each row is stored once,
+         * reduced against the rows of the selection it extends, and the reduction of a composition is the path which leads to it.
+         * The compositions whose rows are linearly dependent are not extended, nor stored.
+         * 
+         * Only the matrices with at most GeneratingMatrix::maxPackedCols columns are supported, since the rows are stored
+         * as word-packed rows.
+         */ 
+        class Reduction
+        {
+            public:
+                /**
+                 * Constructs an empty reduction, which is not valid.
+                 */
+                Reduction();
+
+                /**
+                 * Reduces the compositions of the rows of the generating matrices \c baseMatrices which select fewer rows
+                 * than the matrices have.
+                 * @param baseMatrices Generating matrices of the projection, which must all have the same size.
+                 */
+                explicit Reduction(const std::vector<const GeneratingMatrix*>& baseMatrices);
+
+                /**
+                 * Returns true if the reduction of \c baseMatrices can be computed.
+                 */
+                static bool fits(const std::vector<const GeneratingMatrix*>& baseMatrices);
+
+                /**
+                 * Returns true if the reduction was computed.
+                 */
+                bool valid() const { return m_numMatrices > 0; }
+
+            private:
+                friend struct GaussMethod;
+
+                typedef GeneratingMatrix::PackedRow PackedRow;
+
+                /// Row of the selection which leads to a composition.
+                struct Entry
+                {
+                    PackedRow row; // reduced row
+                    PackedRow pivot; // mask of the pivot of the row
+                    unsigned int depth; // number of rows of the selection, including this one
+                    bool composition; // whether the selection has at least one row of each matrix
+                };
+
+                unsigned int m_numMatrices;
+                unsigned int m_nRows;
+                unsigned int m_nCols;
+                unsigned int m_dependentBound; // smallest number of rows of a composition whose rows are dependent
+                std::vector<Entry> m_entries; // rows in depth-first order
+
+                void extend(const std::vector<const GeneratingMatrix*>& baseMatrices, unsigned int matrix, std::vector<Entry>& path);
+        };
+
 
         /**
          * Compute the t-value corresponding to the generating matrices \c baseMatrices, using the prior knowledge that the maximum of the
@@ -44,6 +108,27 @@ namespace NetBuilder {
          */ 
         static unsigned int computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, int verbose);
 
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices as computeTValue(), unless it is greater than \c cutoff.
+         * The numbers of rows which could only yield a t-value greater than \c cutoff are not examined: as soon as the t-value is known to be
+         * greater than \c cutoff, a lower bound on the t-value, greater than \c cutoff, is returned.
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param cutoff Largest t-value which must be computed exactly.
+         * @param verbose Verbosity level.
+         */ 
+        static unsigned int computeBoundedTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, unsigned int cutoff, int verbose);
+
+        /**
+         * Compute the t-value of the generating matrices of \c reduction completed by the matrix \c newMatrix as computeBoundedTValue(),
+         * without reducing the rows of the matrices of \c reduction again: only the rows of \c newMatrix are added to the reduction of each composition.
+         * @param reduction Reduction of the generating matrices of the projection without the new coordinate.
+         * @param newMatrix Generating matrix of the new coordinate, of the same size as the matrices of \c reduction.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param cutoff Largest t-value which must be computed exactly.
+         */ 
+        static unsigned int computeBoundedTValue(const Reduction& reduction, const GeneratingMatrix& newMatrix, unsigned int maxTValuesSubProj, unsigned int cutoff);
+
         /**
          * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, using the prior knowledge that the maximum of the
          * t-values of the subprojections, for each level \c i is \c maxTValuesSubProj[i].
@@ -59,18 +144,34 @@ namespace NetBuilder {
         /**
          * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level greater or equal to \c mMin, using the prior knowledge that the maximum of the
          * t-values of the subprojections, for each level <CODE> i + mMin </CODE> is \c maxTValuesSubProj[i]. We do not compute the t-value for the lower levels.
+         * For matrices with at most GeneratingMatrix::maxPackedCols columns, the rows of the compositions of all the numbers of rows are reduced
+         * in a single depth-first walk, once for all the levels.
          * @param baseMatrices Generating matrices.
          * @param mMin Minimul level.
          * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
          * @param verbose Verbosity level.
          */ 
         static std::vector<unsigned int> computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxTValuesSubProj, int verbose);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, as computeTValue(), unless the t-value of 
+         * some level \c i is greater than \c cutoffs[i]. The single walk over the compositions stops as soon as it is known to be: the lower bounds 
+         * \c maxTValuesSubProj are then returned, with the bound of such a level raised above its cutoff.
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param cutoffs Largest t-value of each level which must be computed exactly.
+         * @param verbose Verbosity level.
+         */ 
+        static std::vector<unsigned int> computeBoundedTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj,
+                                                              const std::vector<unsigned int>& cutoffs, int verbose);
     };
 
     /**
      * Class to compute the t-value of a projection of a digital net in base 2.
      * This class uses the algorithm described in \cite rSCH99a, which consists, for each compositions of matrices, in enumerating all the combinations of the rows of the rows in the
      * Gray code order, looking for a linear dependence between the columns.
+     * For matrices with at most GeneratingMatrix::maxPackedCols columns, the combinations are enumerated by blocks of 256 
+     * word-packed rows, with branchless XOR loops.
      */  
     struct SchmidMethod
     {
@@ -93,6 +194,140 @@ namespace NetBuilder {
         static std::vector<unsigned int> computeTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose);
     };
 
+    /**
+     * Class to compute the t-value of a projection of a digital net in base 2 from the weight enumerator of its dual net.
+     * As in \cite rDIC13a, the minimum Niederreiter-Rosenbloom-Tsfasman weight of the nonzero dual vectors is obtained from
+     * the sum over the \f$ 2^m \f$ points of the projection of products of one factor per coordinate. The coordinates of the points
+     * are computed in Gray code order as XORs of word-packed columns, so that the cost, about \f$ 2^m s \f$ word operations, 
+     * does not depend on the number of compositions of the rows: the method is faster than GaussMethod and SchmidMethod for
+     * the projections of large cardinal. The points are split between the workers of the shared LatBuilder::ThreadPool.
+     * The projections which do not fit (see #fits) are computed with GaussMethod.
+     */  
+    struct DualMethod
+    {
+        /// Largest number of columns of the matrices whose t-values are computed from the dual net.
+        static constexpr unsigned int maxColumns = 30;
+
+        /**
+         * Returns true if the t-value of a projection of cardinal \c s of matrices with \c m columns can be computed from the
+         * dual net: \c m is at most #maxColumns and the sums of the products of the points fit in machine integers.
+         */ 
+        static bool fits(unsigned int s, unsigned int m);
+
+        /**
+         * Returns true if the t-value of the projection of the matrices \c baseMatrices can be computed from the dual net,
+         * which also requires at least as many rows as columns.
+         */ 
+        static bool fits(const std::vector<GeneratingMatrix>& baseMatrices);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, using the prior knowledge that the maximum of the
+         * t-values of the subprojections is \c maxTValuesSubProj.
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */ 
+        static unsigned int computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, int verbose);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, using the prior knowledge that the maximum of the
+         * t-values of the subprojections, for each level \c i is \c maxTValuesSubProj[i]. The t-value of each level is computed from its own points.
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */ 
+        static std::vector<unsigned int> computeTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose);
+    };
+
+    /**
+     * Class to compute the t-value of a projection of a digital net in base 2 with GaussMethod, SchmidMethod or DualMethod, whichever is
+     * expected to be faster for the projection.
+     * The choice is made projection by projection from the cardinal \f$ s \f$ of the projection and the largest number of rows 
+     * \f$ K = m - t' \f$ which must be examined, where \f$ t' \f$ is the maximum of the t-values of the subprojections (at the last level, for 
+     * multilevel t-values): for the compositions of each number of rows \f$ k \leq K \f$, GaussMethod reduces about \f$ k \f$ rows and 
+     * SchmidMethod enumerates about \f$ 2^k \f$ combinations of rows, whereas DualMethod computes \f$ s \f$ coordinates for each of the
+     * \f$ 2^m \f$ points.
+     * The fixed cost and the cost per unit of work of each method form a Profile, which is calibrated once per process by timing both 
+     * methods on a few random projections, unless it is set beforehand with #setProfile.
+     */  
+    struct AutoMethod
+    {
+        /**
+         * Cost model of the two methods, in seconds.
+         */
+        struct Profile
+        {
+            double gaussFixed; ///< Fixed cost of a t-value computation with GaussMethod.
+            double gaussPerRow; ///< Cost of the reduction of a row of a composition with GaussMethod.
+            double schmidFixed; ///< Fixed cost of a t-value computation with SchmidMethod.
+            double schmidPerCombination; ///< Cost of the enumeration of a combination of rows with SchmidMethod.
+            double dualFixed; ///< Fixed cost of a t-value computation with DualMethod.
+            double dualPerCoordinate; ///< Cost of the computation of a coordinate of a point with DualMethod.
+        };
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, using the prior knowledge that the maximum of the
+         * t-values of the subprojections is \c maxTValuesSubProj.
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */ 
+        static unsigned int computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, int verbose);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices as computeTValue(), unless it is greater than \c cutoff,
+         * in which case a lower bound on the t-value, greater than \c cutoff, may be returned (see GaussMethod::computeBoundedTValue()).
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param cutoff Largest t-value which must be computed exactly.
+         * @param verbose Verbosity level.
+         */ 
+        static unsigned int computeBoundedTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, unsigned int cutoff, int verbose);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, using the prior knowledge that the maximum of the
+         * t-values of the subprojections, for each level \c i is \c maxTValuesSubProj[i].
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */ 
+        static std::vector<unsigned int> computeTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, as computeTValue(), unless the t-value
+         * of some level \c i is greater than \c cutoffs[i], in which case lower bounds may be returned (see GaussMethod::computeBoundedTValue()).
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param cutoffs Largest t-value of each level which must be computed exactly.
+         * @param verbose Verbosity level.
+         */ 
+        static std::vector<unsigned int> computeBoundedTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj,
+                                                              const std::vector<unsigned int>& cutoffs, int verbose);
+
+        /**
+         * Returns true if SchmidMethod is expected to be faster than GaussMethod for a projection of cardinal \c s of matrices with \c m columns,
+         * given the maximum \c maxTValuesSubProj of the t-values of its subprojections.
+         */ 
+        static bool prefersSchmid(unsigned int s, unsigned int m, unsigned int maxTValuesSubProj);
+
+        /**
+         * Returns true if DualMethod is expected to be faster than both GaussMethod and SchmidMethod for a projection of cardinal \c s
+         * of matrices with \c m columns, given the maximum \c maxTValuesSubProj of the t-values of its subprojections.
+         */ 
+        static bool prefersDual(unsigned int s, unsigned int m, unsigned int maxTValuesSubProj);
+
+        /**
+         * Returns the cost model, calibrated by the first call if it was not set with #setProfile.
+         */ 
+        static Profile profile();
+
+        /**
+         * Sets the cost model, for instance to a profile stored by a previous run, instead of calibrating it. Must not be called
+         * while t-values are computed.
+         */ 
+        static void setProfile(const Profile& profile);
+    };
+
 }
 
 #endif
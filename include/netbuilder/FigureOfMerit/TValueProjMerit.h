@@ -21,8 +21,12 @@
 #include "netbuilder/FigureOfMerit/ProjectionDependentEvaluator.h"
 #include "netbuilder/FigureOfMerit/TValueComputation.h"
 #include "netbuilder/FigureOfMerit/LevelCombiner.h"
+#include "netbuilder/Helpers/TValueCache.h"
 
+#include <deque>
 #include <functional>
+#include <limits>
+#include <mutex>
 #include <stdexcept>
 
 namespace NetBuilder { namespace FigureOfMerit {
@@ -86,17 +90,17 @@ class TValueProjMerit<EmbeddingType::UNILEVEL, METHOD>
          * @param projection Projection to use.
          * @param maxMeritsSubProj Maximum of the t-value of the subprojections. 
          */ 
-        Real operator()(const AbstractDigitalNet& net , const LatticeTester::Coordinates& projection, SubProjCombination maxMeritsSubProj) const 
+        Real operator()(const AbstractDigitalNet& net , const Projection& projection, SubProjCombination maxMeritsSubProj) const 
         {
             std::vector<GeneratingMatrix> mats;
             for(auto dim : projection)
             {
                 mats.push_back(net.generatingMatrix(dim));
             }
-            return METHOD::computeTValue(std::move(mats),maxMeritsSubProj, false);
+            return TValueCache::unilevel(mats, [&mats, &maxMeritsSubProj]() { return METHOD::computeTValue(std::move(mats), maxMeritsSubProj, false); });
         }
 
-        virtual Real combine(Merit merit, const AbstractDigitalNet& net, const LatticeTester::Coordinates& projection)
+        virtual Real combine(Merit merit, const AbstractDigitalNet& net, const Projection& projection)
         {
             return (Real) merit;
         }
@@ -171,7 +175,8 @@ class TValueProjMerit<EmbeddingType::MULTILEVEL, METHOD>
          */  
         TValueProjMerit(unsigned int maxCardinal, pCombiner combiner):
             m_maxCardinal(maxCardinal),
-            m_combiner(std::move(combiner))
+            m_combiner(std::move(combiner)),
+            m_progressive(false)
         {};
         virtual ~TValueProjMerit(){};
 
@@ -180,6 +185,18 @@ class TValueProjMerit<EmbeddingType::MULTILEVEL, METHOD>
          */ 
         unsigned int maxCardinal() const { return m_maxCardinal; }
 
+        /**
+         * Sets whether the computation of the t-values of a projection stops, when the evaluation may be aborted, 
+         * as soon as the t-value of a level makes the combined merit abort it (see progressiveTValues()). This requires
+         * a monotone combiner (see LevelCombiner::LevelCombiner::isMonotone()) and is ignored otherwise. Only the methods which compute bounded t-values, GaussMethod and AutoMethod, support it.
+         */
+        void setProgressive(bool progressive) { m_progressive = progressive; }
+
+        /**
+         * Returns true if the computation of the t-values of a projection stops as soon as the evaluation is known to be aborted.
+         */
+        bool progressive() const { return m_progressive && m_combiner->isMonotone(); }
+
         /**
          * Output information about the figure of merit.
          */ 
@@ -198,14 +215,14 @@ class TValueProjMerit<EmbeddingType::MULTILEVEL, METHOD>
          * @param projection is the projection to consider
          * @param maxMeritsSubProj is the maximal merit of the subprojections
          */ 
-        std::vector<unsigned int> operator()(const AbstractDigitalNet& net, const LatticeTester::Coordinates& projection, const std::vector<unsigned int>& maxMeritsSubProj) const 
+        std::vector<unsigned int> operator()(const AbstractDigitalNet& net, const Projection& projection, const std::vector<unsigned int>& maxMeritsSubProj) const 
         {
             std::vector<GeneratingMatrix> mats;
             for(auto dim : projection)
             {
                 mats.push_back(net.generatingMatrix(dim));
             }
-            return METHOD::computeTValue(std::move(mats), maxMeritsSubProj, 0);
+            return TValueCache::multilevel(mats, [&mats, &maxMeritsSubProj]() { return METHOD::computeTValue(std::move(mats), maxMeritsSubProj, 0); });
         }
 
         /** 
@@ -214,7 +231,14 @@ class TValueProjMerit<EmbeddingType::MULTILEVEL, METHOD>
          * @param net Digital net.
          * @param projection Projection.
          */ 
-        virtual Real combine(const Merit& merits, const AbstractDigitalNet& net, const LatticeTester::Coordinates& projection) {
+        virtual Real combine(const Merit& merits, const AbstractDigitalNet& net, const Projection& projection) {
+            return combineLevels(merits);
+        }
+
+        /** 
+         * Combines the multilevel t-values \c merits into a single value merit with the combiner.
+         */ 
+        Real combineLevels(const Merit& merits) const {
             RealVector tmp(merits.size());
             for (unsigned int i=0; i<merits.size(); i++){
                 tmp[i] = (Real) merits[i];
@@ -273,11 +297,166 @@ class TValueProjMerit<EmbeddingType::MULTILEVEL, METHOD>
         unsigned int m_maxCardinal; // maximum order of subprojections to take into account 
         pCombiner m_combiner; 
         // function wrapper which combines multilevel merits in a single value merit
+        bool m_progressive; // stop the computation of the levels under early abortion
 };
 
+/**
+ * Returns the largest t-value whose merit \c maxMerit does not abort the evaluation, as the cutoff of GaussMethod::computeBoundedTValue().
+ */
+inline unsigned int tValueCutoff(Real maxMerit)
+{
+    unsigned int cutoff = std::numeric_limits<unsigned int>::max();
+    if (maxMerit < 0)
+    {
+        cutoff = 0;
+    }
+    else if (maxMerit < (Real) cutoff)
+    {
+        cutoff = (unsigned int) maxMerit;
+    }
+    return cutoff;
+}
+
+/**
+ * Computes the t-value of the projection \c projection of the unilevel net \c net with \c METHOD::computeBoundedTValue(),
+ * which stops as soon as the t-value is known to be greater than \c maxMerit, unless it is in the TValueCache.
+ */
+template <typename METHOD>
+unsigned int boundedTValue(const AbstractDigitalNet& net, const Projection& projection, unsigned int maxMeritsSubProj, Real maxMerit)
+{
+    std::vector<GeneratingMatrix> mats;
+    for(auto dim : projection)
+    {
+        mats.push_back(net.generatingMatrix(dim));
+    }
+    unsigned int tValue;
+    if (TValueCache::findUnilevel(mats, tValue))
+    {
+        return tValue;
+    }
+    return METHOD::computeBoundedTValue(std::move(mats), maxMeritsSubProj, tValueCutoff(maxMerit), 0);
+}
+
+/**
+ * Computes the t-value of the projection \c projection of the unilevel net \c net with GaussMethod::computeBoundedTValue(),
+ * which stops as soon as the t-value is known to be greater than \c maxMerit. @see boundedProjDepMerit
+ */
+inline unsigned int boundedProjDepMerit(const TValueProjMerit<EmbeddingType::UNILEVEL, GaussMethod>& projDepMerit, const AbstractDigitalNet& net,
+                                        const Projection& projection, unsigned int maxMeritsSubProj, Real maxMerit)
+{
+    return boundedTValue<GaussMethod>(net, projection, maxMeritsSubProj, maxMerit);
+}
+
+/**
+ * Computes the t-value of the projection \c projection of the unilevel net \c net with AutoMethod::computeBoundedTValue(),
+ * which stops as soon as the t-value is known to be greater than \c maxMerit if GaussMethod is selected. @see boundedProjDepMerit
+ */
+inline unsigned int boundedProjDepMerit(const TValueProjMerit<EmbeddingType::UNILEVEL, AutoMethod>& projDepMerit, const AbstractDigitalNet& net,
+                                        const Projection& projection, unsigned int maxMeritsSubProj, Real maxMerit)
+{
+    return boundedTValue<AutoMethod>(net, projection, maxMeritsSubProj, maxMerit);
+}
+
+/**
+ * Computes the multilevel t-values of the projection \c projection of the net \c net with \c METHOD::computeBoundedTValue(),
+ * unless they are in the TValueCache. The t-values of the levels are bounded below by the maxima \c maxMeritsSubProj of the
+ * t-values of the subprojections. With a monotone combiner, the combined merit of these lower bounds, where the bound
+ * of a single level is raised, is thus a lower bound of the combined merit of the projection: the cutoff of each level is
+ * the largest t-value which keeps it no greater than \c maxMerit. The walk over the compositions, which resolves the coarse
+ * levels with the compositions of few rows, then stops at the first level which exceeds its cutoff, and the compositions
+ * of many rows, which are the most expensive ones, are skipped for most of the rejected nets.
+ * The t-values returned are exact if their combined merit does not exceed \c maxMerit.
+ */
+template <typename METHOD>
+std::vector<unsigned int> progressiveTValues(const TValueProjMerit<EmbeddingType::MULTILEVEL, METHOD>& projDepMerit, const AbstractDigitalNet& net,
+                                             const Projection& projection, const std::vector<unsigned int>& maxMeritsSubProj, Real maxMerit)
+{
+    std::vector<GeneratingMatrix> mats;
+    for(auto dim : projection)
+    {
+        mats.push_back(net.generatingMatrix(dim));
+    }
+    std::vector<unsigned int> tValues;
+    if (TValueCache::findMultilevel(mats, tValues))
+    {
+        return tValues;
+    }
+
+    const unsigned int nCols = mats[0].nCols();
+    const unsigned int nLevels = (unsigned int) maxMeritsSubProj.size();
+    tValues = maxMeritsSubProj;
+    if (projDepMerit.combineLevels(tValues) > maxMerit)
+    {
+        return tValues;
+    }
+
+    // largest t-value of each level for which the combined lower bound does not exceed maxMerit
+    std::vector<unsigned int> cutoffs(nLevels);
+    for (unsigned int level = 0; level < nLevels; ++level)
+    {
+        unsigned int cutoff = maxMeritsSubProj[level];
+        unsigned int upper = std::max(nCols, cutoff);
+        while (cutoff < upper)
+        {
+            const unsigned int middle = cutoff + (upper - cutoff + 1) / 2;
+            tValues[level] = middle;
+            if (projDepMerit.combineLevels(tValues) > maxMerit)
+            {
+                upper = middle - 1;
+            }
+            else
+            {
+                cutoff = middle;
+            }
+        }
+        tValues[level] = maxMeritsSubProj[level];
+        cutoffs[level] = cutoff;
+    }
+
+    tValues = METHOD::computeBoundedTValue(mats, maxMeritsSubProj, cutoffs, 0);
+    if (TValueCache::enabled() && projDepMerit.combineLevels(tValues) <= maxMerit)
+    {
+        TValueCache::multilevel(mats, [&tValues]() { return tValues; });
+    }
+    return tValues;
+}
+
+/**
+ * Computes the multilevel t-values of the projection \c projection of the net \c net with progressiveTValues()
+ * if \c projDepMerit is progressive, and exactly otherwise. @see boundedProjDepMerit
+ */
+inline std::vector<unsigned int> boundedProjDepMerit(const TValueProjMerit<EmbeddingType::MULTILEVEL, GaussMethod>& projDepMerit, const AbstractDigitalNet& net,
+                                                     const Projection& projection, const std::vector<unsigned int>& maxMeritsSubProj, Real maxMerit)
+{
+    if (!projDepMerit.progressive() || projection.size() == 1)
+    {
+        return projDepMerit(net, projection, maxMeritsSubProj);
+    }
+    return progressiveTValues(projDepMerit, net, projection, maxMeritsSubProj, maxMerit);
+}
+
+/**
+ * Computes the multilevel t-values of the projection \c projection of the net \c net with progressiveTValues()
+ * if \c projDepMerit is progressive, and exactly otherwise. @see boundedProjDepMerit
+ */
+inline std::vector<unsigned int> boundedProjDepMerit(const TValueProjMerit<EmbeddingType::MULTILEVEL, AutoMethod>& projDepMerit, const AbstractDigitalNet& net,
+                                                     const Projection& projection, const std::vector<unsigned int>& maxMeritsSubProj, Real maxMerit)
+{
+    if (!projDepMerit.progressive() || projection.size() == 1)
+    {
+        return projDepMerit(net, projection, maxMeritsSubProj);
+    }
+    return progressiveTValues(projDepMerit, net, projection, maxMeritsSubProj, maxMerit);
+}
+
 /**
  * Template specialization of the evaluator for the weighted figure of merit based on the t-value projection-dependent merit 
  * in the case of unilevel nets.
+ * 
+ * The rows of the generating matrices of each projection are reduced once for all the compositions of GaussMethod
+ * (see GaussMethod::Reduction), the first time the projection is extended by a new coordinate. The t-value of the extended
+ * projection is then computed by adding the rows of the new coordinate only, without copying any matrix unless 
+ * the TValueCache is enabled. The reductions are discarded when the evaluator is reset.
  */ 
 template<>
 class WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::UNILEVEL, GaussMethod>>::WeightedFigureOfMeritEvaluator : public ProjectionDependentEvaluator<TValueProjMerit<EmbeddingType::UNILEVEL, GaussMethod>>
@@ -287,6 +466,89 @@ class WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::UNILEVEL, GaussMethod
         WeightedFigureOfMeritEvaluator(WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::UNILEVEL, GaussMethod>>* figure):
             ProjectionDependentEvaluator(figure)
         {}
+
+        virtual MeritValue operator() (const AbstractDigitalNet& net, Dimension dimension, MeritValue initialValue, int verbose = 0) override
+        {
+            // the nodes of the previous layers get their slots before the nodes of the layer are evaluated, possibly concurrently
+            while (m_reductions.size() < layerBegin(dimension))
+            {
+                m_reductions.emplace_back();
+            }
+            return ProjectionDependentEvaluator::operator()(net, dimension, std::move(initialValue), verbose);
+        }
+
+        virtual void reset() override
+        {
+            ProjectionDependentEvaluator::reset();
+            m_reductions.clear();
+        }
+
+    protected:
+
+        virtual unsigned int nodeMerit(const AbstractDigitalNet& net, const Projection& proj, NodeId node, Real maxMerit) override
+        {
+            if (nodeCardinal(node) == 1)
+            {
+                return ProjectionDependentEvaluator::nodeMerit(net, proj, node, maxMerit);
+            }
+
+            std::vector<const GeneratingMatrix*> mats;
+            for(auto dim : proj)
+            {
+                mats.push_back(&net.generatingMatrix(dim));
+            }
+            const GeneratingMatrix& newMatrix = *mats.back(); // the highest coordinate is the one added to the parent projection
+            mats.pop_back();
+
+            std::vector<GeneratingMatrix> cacheKey;
+            if (TValueCache::enabled())
+            {
+                // the t-values in the cache, for instance those of a t-value profile, do not require the reduction of the parent
+                for (const GeneratingMatrix* mat : mats)
+                {
+                    cacheKey.push_back(*mat);
+                }
+                cacheKey.push_back(newMatrix);
+                unsigned int tValue;
+                if (TValueCache::findUnilevel(cacheKey, tValue))
+                {
+                    return tValue;
+                }
+            }
+
+            ParentReduction& parent = m_reductions[parentNode(node)];
+            std::call_once(parent.built, [&parent, &mats]()
+                {
+                    if (GaussMethod::Reduction::fits(mats))
+                    {
+                        parent.reduction = GaussMethod::Reduction(mats);
+                    }
+                });
+            if (!parent.reduction.valid())
+            {
+                return ProjectionDependentEvaluator::nodeMerit(net, proj, node, maxMerit);
+            }
+
+            const unsigned int maxMeritsSubProj = subProjCombination(node);
+            const unsigned int cutoff = tValueCutoff(maxMerit);
+            if (TValueCache::enabled() && cutoff == std::numeric_limits<unsigned int>::max())
+            {
+                return TValueCache::unilevel(cacheKey, [&parent, &newMatrix, maxMeritsSubProj, cutoff]()
+                    { return GaussMethod::computeBoundedTValue(parent.reduction, newMatrix, maxMeritsSubProj, cutoff); });
+            }
+            return GaussMethod::computeBoundedTValue(parent.reduction, newMatrix, maxMeritsSubProj, cutoff);
+        }
+
+    private:
+
+        /// Reduction of the generating matrices of the projection of a node, computed on first use.
+        struct ParentReduction
+        {
+            std::once_flag built;
+            GaussMethod::Reduction reduction;
+        };
+
+        std::deque<ParentReduction> m_reductions; // reduction of the projection of each node of the previous layers
 };
 
 /**
@@ -332,6 +594,61 @@ class WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::MULTILEVEL, SchmidMet
 };
 
 
+/**
+ * Template specialization of the evaluator for the weighted figure of merit based on the t-value projection-dependent merit 
+ * in the case of unilevel nets.
+ */ 
+template<>
+class WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::UNILEVEL, AutoMethod>>::WeightedFigureOfMeritEvaluator : public ProjectionDependentEvaluator<TValueProjMerit<EmbeddingType::UNILEVEL, AutoMethod>>
+{
+    public:
+
+        WeightedFigureOfMeritEvaluator(WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::UNILEVEL, AutoMethod>>* figure):
+            ProjectionDependentEvaluator(figure)
+        {}
+};
+
+/**
+ * Template specialization of the evaluator for the weighted figure of merit based on the t-value projection-dependent merit 
+ * in the case of multilevel nets.
+ */ 
+template<>
+class WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::MULTILEVEL, AutoMethod>>::WeightedFigureOfMeritEvaluator : public ProjectionDependentEvaluator<TValueProjMerit<EmbeddingType::MULTILEVEL, AutoMethod>>
+{
+    public:
+
+        WeightedFigureOfMeritEvaluator(WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::MULTILEVEL, AutoMethod>>* figure):
+            ProjectionDependentEvaluator(figure)
+        {}
+};
+
+/**
+ * Template specialization of the evaluator for the weighted figure of merit based on the t-value projection-dependent merit 
+ * in the case of unilevel nets.
+ */ 
+template<>
+class WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::UNILEVEL, DualMethod>>::WeightedFigureOfMeritEvaluator : public ProjectionDependentEvaluator<TValueProjMerit<EmbeddingType::UNILEVEL, DualMethod>>
+{
+    public:
+
+        WeightedFigureOfMeritEvaluator(WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::UNILEVEL, DualMethod>>* figure):
+            ProjectionDependentEvaluator(figure)
+        {}
+};
+
+/**
+ * Template specialization of the evaluator for the weighted figure of merit based on the t-value projection-dependent merit 
+ * in the case of multilevel nets.
+ */ 
+template<>
+class WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::MULTILEVEL, DualMethod>>::WeightedFigureOfMeritEvaluator : public ProjectionDependentEvaluator<TValueProjMerit<EmbeddingType::MULTILEVEL, DualMethod>>
+{
+    public:
+
+        WeightedFigureOfMeritEvaluator(WeightedFigureOfMerit<TValueProjMerit<EmbeddingType::MULTILEVEL, DualMethod>>* figure):
+            ProjectionDependentEvaluator(figure)
+        {}
+};
 
 }}
 
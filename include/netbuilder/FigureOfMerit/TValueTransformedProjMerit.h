@@ -93,7 +93,7 @@ class TValueTransformedProjMerit<EmbeddingType::UNILEVEL, METHOD>: public TValue
             this->cost_function = cost_function;
         }
 
-        virtual Real combine(Merit merit, const AbstractDigitalNet& net, const LatticeTester::Coordinates& projection)
+        virtual Real combine(Merit merit, const AbstractDigitalNet& net, const Projection& projection)
         {
             return h(merit, net.numColumns(), projection.size(), cost_function);
         }
@@ -137,7 +137,7 @@ class TValueTransformedProjMerit<EmbeddingType::MULTILEVEL, METHOD>: public TVal
             this->cost_function = cost_function;
         }
 
-        virtual Real combine(const Merit& merits, const AbstractDigitalNet& net, const LatticeTester::Coordinates& projection) {
+        virtual Real combine(const Merit& merits, const AbstractDigitalNet& net, const Projection& projection) {
             RealVector tmp(merits.size());
             for (unsigned int i=0; i<merits.size(); i++){
                 tmp[i] = h(merits[i], net.numColumns(), projection.size(), cost_function);
@@ -19,18 +19,27 @@
 
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
 #include "netbuilder/FigureOfMerit/LevelCombiner.h"
+#include "netbuilder/Helpers/Projection.h"
+#include "netbuilder/Helpers/ProjectionSample.h"
+#include "netbuilder/Helpers/WeightTable.h"
 
 #include "latticetester/Coordinates.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
 namespace NetBuilder{ namespace FigureOfMerit { 
 
 /** Class which represents a weighted figure of merit based on a projection dependent merit whose type is the template
  * parameter. 
  * 
  * @tparam PROJDEP The type of the projection dependent merit. This type should implement the following methods:
- *  - container<LatticeTester::Coordinates> projections(Dimension dimension) which returns an iterable container of the projections to consider for the 
+ *  - container<Projection> projections(Dimension dimension) which returns an iterable container of the projections to consider for the 
  *  given dimension. \n 
- *  - Real operator()(const AbstractDigitalNet& net, LatticeTester::Coordinates) which returns the projection-dependent merit of the net for the given projection. \n
+ *  - Real operator()(const AbstractDigitalNet& net, const Projection&) which returns the projection-dependent merit of the net for the given projection. \n
  *  
  */  
 template<typename PROJDEP>
@@ -46,6 +55,7 @@ class WeightedFigureOfMerit : public CBCFigureOfMerit
         WeightedFigureOfMerit(Real normType, std::unique_ptr<LatticeTester::Weights> weights, std::unique_ptr<PROJDEP> projDepMerit):
             m_normType(normType),
             m_weights(std::move(weights)),
+            m_weightTable(*m_weights),
             m_projDepMerit(std::move(projDepMerit)),
             m_expNorm( (normType < std::numeric_limits<Real>::infinity()) ? normType : 1)
         {};
@@ -55,6 +65,11 @@ class WeightedFigureOfMerit : public CBCFigureOfMerit
          */
         const LatticeTester::Weights& weights() const { return *m_weights; }
 
+        /**
+         * Returns the precomputed table of the weights of the figure, to look up the weights in the evaluators.
+         */
+        const WeightTable& weightTable() const { return m_weightTable; }
+
         /** 
          * Returns the projection-dependent merit of the figure 
          */
@@ -72,6 +87,13 @@ class WeightedFigureOfMerit : public CBCFigureOfMerit
         virtual Accumulator accumulator(Real initialValue) const override
         { return Accumulator(std::move(initialValue), m_normType); }
 
+        /**
+         * Returns \c baseMerit: the merits of the new projections are nonnegative and accumulated with nonnegative
+         * weights, which cannot lower the partial merit value.
+         */
+        virtual Real meritLowerBound(Real baseMerit) const override
+        { return baseMerit; }
+
         /**
          * Returns a <code>std::unique_ptr</code> to an evaluator for the figure of merit. 
          */
@@ -104,6 +126,7 @@ class WeightedFigureOfMerit : public CBCFigureOfMerit
 
         Real m_normType; // norm type of the figure
         std::unique_ptr<LatticeTester::Weights> m_weights; // weights of the projections
+        WeightTable m_weightTable; // table of m_weights
         std::unique_ptr<PROJDEP> m_projDepMerit; // projection dependent merit
         Real m_expNorm; // exponent to use when accumulating merit
 
@@ -115,7 +138,8 @@ class WeightedFigureOfMerit : public CBCFigureOfMerit
             public:
                 /** Constructs the evaluator */
                 WeightedFigureOfMeritEvaluator(WeightedFigureOfMerit* figure):
-                    m_figure(figure)
+                    m_figure(figure),
+                    m_projectionsDimension(Projection::npos)
                 {};
 
                 /** 
@@ -128,18 +152,12 @@ class WeightedFigureOfMerit : public CBCFigureOfMerit
                  */ 
                 virtual MeritValue operator() (const AbstractDigitalNet& net, Dimension dimension, MeritValue initialValue, int verbose = 0) override
                 {
-                    using namespace LatticeTester;
-                    auto projections = m_figure->projDepMerit().projections(dimension);
                     auto acc = m_figure->accumulator(std::move(initialValue)); // create the accumulator from the initial value
 
-                    for (auto cit = projections.begin (); cit != projections.end (); ++cit) // for each coordinate
+                    for (const auto& projection : projections(dimension)) // for each projection of non-zero weight
                     {
-                        const Coordinates& proj = *cit;
-                        Real weight = m_figure->weights().getWeight(proj); // get the weight
-
-                        if (weight == 0.0) { 
-                            continue; // skip the projection
-                        }
+                        const Projection& proj = projection.first;
+                        const Real weight = projection.second;
 
                         MeritValue merit = m_figure->projDepMerit()(net, proj); // compute the proj-dep merit
 
@@ -150,9 +168,10 @@ class WeightedFigureOfMerit : public CBCFigureOfMerit
 
                         acc.accumulate(weight, merit, m_figure->expNorm()); // accumulate the merit
 
-                        if (!onProgress()(acc.value())) { // if the current merit is too high
+                        if (!continueEvaluation(acc.value())) { // if the current merit is too high
                             acc.accumulate(std::numeric_limits<Real>::infinity(), merit, m_figure->expNorm()); // set the merit to infinity
                             onAbort()(net); // abort the computation
+                            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::EARLY_ABORTS);
                             break;
                         }
                     }
@@ -176,9 +195,75 @@ class WeightedFigureOfMerit : public CBCFigureOfMerit
                  */
                 virtual void lastNetWasBest() override {};
 
+                /**
+                 * Returns \c true if the norm type of the figure is finite: the merit of the sup norm cannot be estimated from a sample.
+                 */
+                virtual bool estimates() const override
+                { return m_figure->normType() < std::numeric_limits<Real>::infinity(); }
+
+                /**
+                 * {@inheritDoc}
+                 * The merits of the sampled projections are raised to the power of the norm type, as they are accumulated.
+                 */
+                virtual MeritEstimate estimate(const AbstractDigitalNet& net, Dimension dimension, size_t sampleSize, Real zScore) override
+                {
+                    if (!estimates())
+                    {
+                        throw std::logic_error("The merit values of the sup norm cannot be estimated.");
+                    }
+                    const auto& projs = projections(dimension);
+                    if (!m_sample.drawn(dimension, sampleSize))
+                    {
+                        std::vector<Real> weights;
+                        weights.reserve(projs.size());
+                        for (const auto& projection : projs)
+                        {
+                            weights.push_back(projection.second);
+                        }
+                        m_sample.draw(dimension, weights, sampleSize);
+                    }
+                    std::vector<Real> values;
+                    values.reserve(m_sample.indices().size());
+                    for (size_t index : m_sample.indices())
+                    {
+                        values.push_back(std::pow(m_figure->projDepMerit()(net, projs[index].first), m_figure->expNorm()));
+                    }
+                    return m_sample.estimate(values, zScore);
+                }
+
             private:
 
+                /**
+                 * Returns the projections of non-zero weight for dimension \c dimension with their weights. They are enumerated
+                 * and weighted once by dimension with the weight table of the figure, so that evaluating a candidate does not
+                 * look up any weight. The projections are sorted by decreasing weight, so that the accumulated merit of
+                 * a losing candidate exceeds the threshold of early abortion after fewer projections; the accumulators
+                 * (sum or maximum) do not depend on the order, up to rounding.
+                 */
+                const std::vector<std::pair<Projection, Real>>& projections(Dimension dimension)
+                {
+                    if (dimension != m_projectionsDimension)
+                    {
+                        m_projections.clear();
+                        for (const Projection& proj : m_figure->projDepMerit().projections(dimension))
+                        {
+                            const Real weight = m_figure->weightTable().weight(proj);
+                            if (weight != 0.0)
+                            {
+                                m_projections.emplace_back(proj, weight);
+                            }
+                        }
+                        std::stable_sort(m_projections.begin(), m_projections.end(),
+                                         [](const std::pair<Projection, Real>& a, const std::pair<Projection, Real>& b) { return a.second > b.second; });
+                        m_projectionsDimension = dimension;
+                    }
+                    return m_projections;
+                }
+
                 WeightedFigureOfMerit* m_figure;
+                Dimension m_projectionsDimension; // dimension of the projections of m_projections
+                std::vector<std::pair<Projection, Real>> m_projections;
+                ProjectionSample m_sample; // sample of the projections of the last estimated dimension
         };
 };
 
@@ -23,6 +23,8 @@
 #define NETBUILDER__GENERATING_MATRIX_H
 
 #include <boost/dynamic_bitset.hpp> 
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <algorithm>
@@ -40,6 +42,11 @@ namespace NetBuilder {
  * arbitrarly large matrices. The choice of representing the matrix by its rows and not its columns
  * comes from the rank computation algorithm, which is the most complicated algorithm handling matrices in the software.
  * 
+ * Matrices with at most #maxPackedCols columns, which covers nearly all the nets built in practice, can also
+ * have their rows read and written as single machine words (see #packedRow and #setPackedRow). The rank computations
+ * (RankComputer, SchmidMethod) rely on this word-packed representation to perform XOR row operations and pivot
+ * searches without heap allocations.
+ * 
  * For now, the computation of the points from the matrices is done in latbuilder/Storage-SIMPLE-DIGITAL.h.
  * TODO: add more explanation on this. The basic idea is that we do not need to explicitely compute the points anywhere 
  * in LatNet Builder, but map a matrix to a permutation of {0, 1/n, ...,  1}.
@@ -57,6 +64,12 @@ class GeneratingMatrix {
         /// Type for unsigned long.
         typedef unsigned long uInteger;
 
+        /// Type for rows packed in a single word: the element in column \c j is the bit of weight \f$2^j\f$.
+        typedef uint64_t PackedRow;
+
+        /// Maximal number of columns of a matrix whose rows fit in a PackedRow.
+        static constexpr unsigned int maxPackedCols = 64;
+
         /** Constructs a generating matrix with all entries set to zero.
          * @param nRows Number of rows.
          * @param nCols Number of columns.
@@ -114,6 +127,19 @@ class GeneratingMatrix {
          */ 
         Row& operator[](unsigned int i);
 
+        /** Returns the row at position \c i of the matrix packed in a single word.
+         * The matrix must have at most #maxPackedCols columns.
+         * @param i Position of the row.
+         */ 
+        PackedRow packedRow(unsigned int i) const;
+
+        /** Sets the row at position \c i of the matrix from its packed representation.
+         * The matrix must have at most #maxPackedCols columns. Bits beyond the number of columns are ignored.
+         * @param i Position of the row.
+         * @param row Packed row.
+         */ 
+        void setPackedRow(unsigned int i, PackedRow row);
+
         /** Returns the upper-left submatrix with \c nRows rows and \c nCols columns.
          * @param nRows Number of rows.
          * @param nCols Number of columns.
@@ -133,6 +159,7 @@ class GeneratingMatrix {
 
         /**
          * Computes the product of the matrix by matrix \c m.
+         * Word-packed products with many rows use the tables of a RightMultiplier (method of the Four Russians).
          * @param m Right multiplier.
          */ 
         GeneratingMatrix operator*(const GeneratingMatrix& m) const;
@@ -158,20 +185,45 @@ class GeneratingMatrix {
         /** Overloads of << operator to print matrices. */
         friend std::ostream& operator<<(std::ostream& os, const GeneratingMatrix& mat);
 
+        /** Returns the columns of the matrix as integers separated by spaces, each column being read as a bit string
+         * of \c nBits bits with the first row as the highest bit.
+         */
         std::string formatToColumnsReverse(unsigned int nBits = 31) const;
 
+        /** Writes the columns of the matrix to \c os, as formatToColumnsReverse(unsigned int) const does, without
+         * building a string.
+         */
+        void formatToColumnsReverse(std::ostream& os, unsigned int nBits = 31) const;
+
         /** Returns an integer representation of the columns of the matrix. A column is read as a bit string
          * with highest bit in first position. This function is used to generate the points from the digital net.
+         * Matrices with at most #maxPackedCols rows and columns are transposed as a block of words, without reading
+         * the elements one by one.
          */ 
         std::vector<unsigned long> getColsReverse() const;
 
+        /** Sets the elements of the matrix from the integer representation of its columns, as returned by getColsReverse().
+         * The matrix must have at most #maxPackedCols rows and columns, and \c cols one integer by column.
+         * The columns are transposed as a block of words, without writing the elements one by one.
+         */
+        void setColsReverse(const std::vector<unsigned long>& cols);
+
         /** Creates a matrix from its reversed column representation.
          * @param nInputRows Number of bits in the integer representation of the columns. Typically equals 31.
          * @param nOutputRows Number of rows of the matrix returned by the function. Rows below are ignored. Typically equals the number of columns.
          * @param columns Integer representation of the columns of the matrix.
+         * @throw std::runtime_error if a column has more than \c nInputBits bits.
          */ 
         static GeneratingMatrix fromColsReverse(unsigned int nInputBits, unsigned int nOutputRows, std::vector<unsigned long> columns);
 
+        /** Creates a matrix from its packed columns, where the element in row \c i is the bit of weight \f$2^i\f$ of the column.
+         * The matrix must have at most #maxPackedCols rows and columns. The columns are transposed as a block of words.
+         * @param nRows Number of rows of the matrix. Bits beyond the number of rows are ignored.
+         * @param nCols Number of columns of the matrix.
+         * @param columns Packed columns of the matrix, one by column.
+         */
+        static GeneratingMatrix fromPackedColumns(unsigned int nRows, unsigned int nCols, const PackedRow* columns);
+
         /**
          * Creates a matrix with ones on the main diagonal, random bits below the main diagonal, and zeros above.
          * TODO: give the maximum values for nRows and nCols for this to work.
@@ -184,13 +236,15 @@ class GeneratingMatrix {
             std::vector<GeneratingMatrix::uInteger> res(nRows, 0);
             unsigned long diagonalCoeff = 1 << (nCols);
             LatBuilder::UniformUIntDistribution<unsigned long, LatBuilder::LFSR258> m_unif(0, diagonalCoeff - 1);
+            std::vector<unsigned long> values(nRows);
+            m_unif(randomGen, values.data(), values.size());
             for(unsigned int i = 0; i < std::min(nCols, nRows); ++i)
             {
-                res[i] = ((diagonalCoeff + m_unif(randomGen)) >> (nCols-i));
+                res[i] = ((diagonalCoeff + values[i]) >> (nCols-i));
             }
             for(unsigned int i = nCols; i < nRows; ++i)
             {
-                res[i] = m_unif(randomGen);
+                res[i] = values[i];
             }
             return GeneratingMatrix(nRows, nCols, res);
         };
@@ -201,5 +255,126 @@ class GeneratingMatrix {
         unsigned int m_nCols; // number of columns of the matrix
 };
 
+/**
+ * Returns a packed row with the \c n lowest bits set, that is the mask of the first \c n columns.
+ */ 
+inline GeneratingMatrix::PackedRow lowBitsMask(unsigned int n)
+{
+    return (n >= GeneratingMatrix::maxPackedCols) ? ~GeneratingMatrix::PackedRow(0) : ((GeneratingMatrix::PackedRow(1) << n) - 1);
+}
+
+/**
+ * Returns the position of the lowest set bit of \c x, which must be non-zero.
+ */ 
+inline unsigned int lowestSetBit(GeneratingMatrix::PackedRow x)
+{
+#if defined(__GNUC__)
+    return (unsigned int) __builtin_ctzll(x);
+#else
+    unsigned int r = 0;
+    while (!(x & 1)) { x >>= 1; ++r; }
+    return r;
+#endif
+}
+
+/**
+ * Returns the position of the highest set bit of \c x, which must be non-zero.
+ */ 
+inline unsigned int highestSetBit(GeneratingMatrix::PackedRow x)
+{
+#if defined(__GNUC__)
+    return (unsigned int) (63 - __builtin_clzll(x));
+#else
+    unsigned int r = 0;
+    while (x >>= 1) ++r;
+    return r;
+#endif
+}
+
+/**
+ * Returns the number of set bits of \c x.
+ */ 
+inline unsigned int countSetBits(GeneratingMatrix::PackedRow x)
+{
+#if defined(__GNUC__)
+    return (unsigned int) __builtin_popcountll(x);
+#else
+    unsigned int r = 0;
+    for (; x; x &= x - 1) ++r;
+    return r;
+#endif
+}
+
+/**
+ * Interlaces the digits of a coordinate, stored first digit in the most significant bit: the digit \f$r\f$ of \c digits
+ * (starting from 0) becomes the digit \f$rd + l\f$ of the result, where \f$d\f$ is \c factor and \f$l < d\f$ is
+ * \c offset, and the digits beyond the 64th are dropped. The interlaced coordinate \f$j\f$ of a net with interlacing
+ * factor \f$d\f$ is the XOR of its \f$d\f$ components \f$jd + l\f$ interlaced at offsets \f$l\f$.
+ * 
+ * Uses a single parallel bit deposit where the BMI2 instruction set is enabled at compile time, or supported by the
+ * host when the instruction sets are selected at run time (see LATNETBUILDER_CPU_DISPATCH_ENABLED), and tables of
+ * the interlaced bytes for factors up to 9 otherwise.
+ */ 
+GeneratingMatrix::PackedRow interlaceDigits(GeneratingMatrix::PackedRow digits, unsigned int factor, unsigned int offset);
+
+/**
+ * Precomputed products of a matrix with at most GeneratingMatrix::maxPackedCols rows and columns, used to multiply
+ * many matrices on its left (method of the Four Russians).
+ * 
+ * The rows of the matrix are split in groups of #chunkBits rows and the XORs of all the subsets of each group are
+ * tabulated: a row of the product is then the XOR of one table entry per group of bits of the left row, instead of
+ * one row of the matrix per set bit. Building the tables costs about as much as multiplying #chunkSize rows, so that
+ * a multiplier should be reused for all the products by the same matrix.
+ */
+class RightMultiplier
+{
+    public:
+        typedef GeneratingMatrix::PackedRow PackedRow;
+
+        /// Number of rows of the matrix in each group of the tables.
+        static constexpr unsigned int chunkBits = 4;
+
+        /// Number of entries of the table of each group.
+        static constexpr unsigned int chunkSize = 1u << chunkBits;
+
+        /**
+         * Constructs the tables of the products by \c matrix.
+         * @param matrix Right multiplier. Must have at most GeneratingMatrix::maxPackedCols rows and columns.
+         */
+        explicit RightMultiplier(const GeneratingMatrix& matrix);
+
+        /** Returns the number of rows of the right multiplier. */
+        unsigned int nRows() const { return m_nRows; }
+
+        /** Returns the number of columns of the right multiplier. */
+        unsigned int nCols() const { return m_nCols; }
+
+        /**
+         * Returns the product of the packed row \c row by the right multiplier.
+         * @param row Packed row with at most #nRows bits. Bits beyond are ignored.
+         */
+        PackedRow multiplyRow(PackedRow row) const
+        {
+            PackedRow acc = 0;
+            const PackedRow* table = m_tables.data();
+            for (row &= lowBitsMask(m_nRows); row; row >>= chunkBits, table += chunkSize)
+            {
+                acc ^= table[row & (chunkSize - 1)];
+            }
+            return acc;
+        }
+
+        /**
+         * Returns the product of \c left by the right multiplier.
+         * @param left Left multiplier. Must have #nRows columns.
+         */
+        GeneratingMatrix leftMultiply(const GeneratingMatrix& left) const;
+
+    private:
+        unsigned int m_nRows; // number of rows of the right multiplier
+        unsigned int m_nCols; // number of columns of the right multiplier
+        std::array<PackedRow, GeneratingMatrix::maxPackedCols / chunkBits * chunkSize> m_tables; // XORs of the subsets of each group of rows
+};
+
 }
 #endif
\ No newline at end of file
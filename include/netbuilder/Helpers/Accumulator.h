@@ -24,7 +24,12 @@
 
 #include "netbuilder/Types.h"
 
+#include "latbuilder/Functor/binary.h"
+
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <type_traits>
 
 namespace NetBuilder{
 
@@ -88,6 +93,15 @@ class Accumulator
          */
         Real tryAccumulate(Real weight, Real value, Real power) const;
 
+        /**
+         * Returns the largest value which can be accumulated with weight \c weight and power 1
+         * without the value held by the accumulator exceeding \c bound. The result may be negative
+         * or infinite.
+         * @param weight Weight of the value.
+         * @param bound Upper bound on the accumulated value.
+         */
+        Real maxAccumulableValue(Real weight, Real bound) const;
+
         /**
          * Set the current merit value held by the accumulator to \c value.
          */ 
@@ -98,10 +112,17 @@ class Accumulator
          */ 
         Real value() const;
 
+        /**
+         * Returns whether the accumulator can be constructed with the norm type \c normType.
+         * Any norm type is accepted.
+         */
+        static bool acceptsNormType(Real normType) { return true; }
+
 
     private:
 
         Real m_data; // current value
+        bool m_isSum; // whether the binary operation is the sum (or else the max)
         std::function<Real (Real, Real)>  m_op; // binary opration
         
         /**
@@ -110,6 +131,91 @@ class Accumulator
         static std::function<Real (Real, Real)>  realToBinOp(Real normType);
 };
 
+/**
+ * Accumulator class with a binary operation fixed at compile time.
+ * It implements the interface of Accumulator, so that it can replace it in evaluators whose norm type
+ * is known when they are compiled: the accumulations are then inlined instead of going through a function wrapper.
+ * @tparam OP Class template providing the binary operation, either LatBuilder::Functor::Sum (finite norm types)
+ * or LatBuilder::Functor::Max (sup norm).
+ */
+template <template <typename> class OP>
+class StaticAccumulator
+{
+    public:
+
+        /**
+         * Constructor.
+         * @param initialValue Initial value of the accumulator.
+         * @param normType Norm type of the accumulator, which must be accepted by acceptsNormType(). Only
+         * used for sake of uniformity with Accumulator.
+         */
+        StaticAccumulator(Real initialValue, Real normType):
+            m_data(initialValue)
+        {}
+
+        /**
+         * Accumulate a new merit value \c value with weight \c weight. The accumulator raises \c value to power \c power.
+         * @param weight Weight of the \c value.
+         * @param value Value to accumulate.
+         * @param power Power used when raising \c value.
+         */
+        void accumulate(Real weight, Real value, Real power)
+        { m_data = tryAccumulate(weight, value, power); }
+
+        /**
+         * Returns the value which would be held by the accumulator
+         * if a new merit value \c value with weight \c weight were accumulated. The accumulator raises \c value to power \c power.
+         * @param weight Weight of the \c value.
+         * @param value Value to accumulate.
+         * @param power Power used when raising \c value.
+         */
+        Real tryAccumulate(Real weight, Real value, Real power) const
+        { return OP<Real>::apply(weight * ((power == 1) ? value : std::pow(value, power)), m_data); }
+
+        /**
+         * Returns the largest value which can be accumulated with weight \c weight and power 1
+         * without the value held by the accumulator exceeding \c bound. The result may be negative
+         * or infinite.
+         * @param weight Weight of the value.
+         * @param bound Upper bound on the accumulated value.
+         */
+        Real maxAccumulableValue(Real weight, Real bound) const
+        {
+            if (m_data > bound) // no value can be accumulated
+            {
+                return -std::numeric_limits<Real>::infinity();
+            }
+            if (weight <= 0)
+            {
+                return std::numeric_limits<Real>::infinity();
+            }
+            return (isSum() ? (bound - m_data) : bound) / weight;
+        }
+
+        /**
+         * Set the current merit value held by the accumulator to \c value.
+         */
+        void set(Real value) { m_data = value; }
+
+        /**
+         * Returns the current merit value held by the accumulator.
+         */
+        Real value() const { return m_data; }
+
+        /**
+         * Returns whether the accumulator can be constructed with the norm type \c normType, that is,
+         * whether \c normType is finite if the binary operation is the sum and infinite otherwise.
+         */
+        static bool acceptsNormType(Real normType)
+        { return isSum() == (normType < std::numeric_limits<Real>::infinity()); }
+
+    private:
+
+        Real m_data; // current value
+
+        static constexpr bool isSum() { return std::is_same<OP<Real>, LatBuilder::Functor::Sum<Real>>::value; }
+};
+
 }
 
 #endif
\ No newline at end of file
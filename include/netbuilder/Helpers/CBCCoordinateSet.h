@@ -22,11 +22,12 @@
 #ifndef NETBUILDER__CBC_COORDINATE_SET_H
 #define NETBUILDER__CBC_COORDINATE_SET_H
 
-#include "latticetester/CoordinateSets.h"
 #include "netbuilder/Types.h"
+#include "netbuilder/Helpers/Projection.h"
 
-#include <iostream>
+#include <iterator>
 #include <algorithm>
+#include <vector>
 
 namespace NetBuilder { 
 
@@ -36,46 +37,139 @@ namespace NetBuilder {
  * This class implements a sequence of coordinates which can be used in the CBC
  * evaluation of figures of merit. More precisely, this class is meant to represent all the non empty subsets of \f$ \{0, \dots, d-1\} \f$
  * with order lower than \f$ \k \in \mathbb{N} \f$ which contain \f$ d-1 \f$.
- * @see LatticeTester::CoordinateSets
+ * The subsets are enumerated by increasing order and, for a given order, in lexicographic order, as those of
+ * LatticeTester::CoordinateSets::FromRanges. They are represented by a Projection which the iterator updates in place, 
+ * so that advancing the iterator does not allocate memory (for \f$ d \leq 64 \f$).
  */ 
 class CBCCoordinateSet
 {
     public:
 
+        /**
+         * Iterator over the subsets of a CBCCoordinateSet.
+         */
+        class const_iterator
+        {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef Projection value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const Projection* pointer;
+                typedef const Projection& reference;
+
+                /// Constructs the iterator pointing to the first subset of \c set.
+                explicit const_iterator(const CBCCoordinateSet& set):
+                    m_lastCoordinate(set.m_lastCoordinate),
+                    m_maxBaseOrder(set.m_maxBaseOrder),
+                    m_end(false)
+                {
+                    m_base.reserve(m_maxBaseOrder);
+                    m_value.insert(m_lastCoordinate);
+                }
+
+                /// Constructs the past-the-end iterator.
+                const_iterator():
+                    m_lastCoordinate(0),
+                    m_maxBaseOrder(0),
+                    m_end(true)
+                {};
+
+                const Projection& operator*() const { return m_value; }
+                const Projection* operator->() const { return &m_value; }
+
+                const_iterator& operator++()
+                {
+                    increment();
+                    return *this;
+                }
+
+                bool operator==(const const_iterator& other) const 
+                { return m_end == other.m_end && (m_end || m_value == other.m_value); }
+
+                bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+            private:
+                Dimension m_lastCoordinate; // coordinate contained in all the subsets
+                unsigned int m_maxBaseOrder; // maximal number of other coordinates
+                std::vector<Dimension> m_base; // other coordinates of the current subset, in increasing order
+                Projection m_value; // current subset
+                bool m_end;
+
+                /** 
+                 * Moves to the next subset of the same order in lexicographic order, or to the first subset of the next order.
+                 */
+                void increment()
+                {
+                    const size_t order = m_base.size();
+                    // find the last coordinate which can be incremented
+                    size_t i = order;
+                    while (i > 0 && m_base[i - 1] + (order - i) + 1 >= m_lastCoordinate)
+                    {
+                        --i;
+                    }
+                    if (i > 0)
+                    {
+                        for (size_t j = i - 1; j < order; ++j)
+                        {
+                            m_value.erase(m_base[j]);
+                        }
+                        const Dimension first = m_base[i - 1] + 1;
+                        for (size_t j = i - 1; j < order; ++j)
+                        {
+                            m_base[j] = first + (j - (i - 1));
+                            m_value.insert(m_base[j]);
+                        }
+                        return;
+                    }
+                    if (order + 1 > m_maxBaseOrder || order + 1 > m_lastCoordinate)
+                    {
+                        m_end = true;
+                        return;
+                    }
+                    // first subset of the next order
+                    for (Dimension coord : m_base)
+                    {
+                        m_value.erase(coord);
+                    }
+                    m_base.resize(order + 1);
+                    for (size_t j = 0; j <= order; ++j)
+                    {
+                        m_base[j] = j;
+                        m_value.insert(j);
+                    }
+                }
+        };
+
         /** Constructs the set of coordinates.
          * @param maxCoordinate Maximal coordinate of the subsets. Corresponds to \f$ d \f$.
          * @param maxOrder Maximal order of subsets. Corresponds to \f$ k \f$.
          */ 
         CBCCoordinateSet(Dimension maxCoordinate, unsigned int maxOrder):
-            m_dimension(maxCoordinate+1),
-            m_maxOrder(maxOrder),
-            m_base(0, std::min(maxOrder-1, (unsigned int) (maxCoordinate)), 0, std::max((unsigned int) (maxCoordinate),(unsigned int) 1)- 1),
-            m_addCoordinate(m_base, maxCoordinate)
+            m_lastCoordinate(maxCoordinate),
+            m_maxBaseOrder(maxOrder == 0 ? 0 : maxOrder - 1)
         {};
 
         /**
         * Returns an iterator pointing to the first element in the sequence.
         */
-        LatticeTester::CoordinateSets::AddCoordinate<LatticeTester::CoordinateSets::FromRanges>::const_iterator begin() const 
+        const_iterator begin() const 
         {
-            return m_addCoordinate.begin();
+            return const_iterator(*this);
         }
 
         /**
         * Returns an iterator pointing past the last element in the sequence.
         */
-        LatticeTester::CoordinateSets::AddCoordinate<LatticeTester::CoordinateSets::FromRanges>::const_iterator end() const 
+        const_iterator end() const 
         {
-            return m_addCoordinate.end();
+            return const_iterator();
         }
 
     private:
-        Dimension m_dimension;
-        unsigned int m_maxOrder;
-        LatticeTester::CoordinateSets::FromRanges m_base;
-        LatticeTester::CoordinateSets::AddCoordinate<LatticeTester::CoordinateSets::FromRanges> m_addCoordinate;
+        Dimension m_lastCoordinate;
+        unsigned int m_maxBaseOrder;
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -68,4 +68,64 @@ class CompositionMaker
         std::vector<int> m_master; // index of the master of the index
         std::pair<std::pair<int,int>, std::pair<int,int>> m_lastChange; // change between the previous and the current composition
 
+};
+
+/**
+ * Walker over the rows selected by the compositions of an integer \f$ k \f$ in \f$ s \f$ parts.
+ * 
+ * The composition \f$(a_1, ..., a_s)\f$ selects the first \f$ a_j \f$ rows of the \f$ j \f$-th coordinate, that is \f$ k \f$ rows in total,
+ * which are stored in \f$ k \f$ slots. Since two consecutive compositions differ by one unit, the walk from one composition to the next 
+ * replaces the last selected row of a coordinate by the next row of another coordinate in the same slot. The slot of each (coordinate, row) pair 
+ * is held in a dense table, so that this update does not allocate memory.
+ * 
+ * Coordinates are numbered from 1 to \f$ s \f$ and rows from 0.
+ */ 
+class CompositionRowWalker
+{
+    public:
+
+        /** 
+         * Description of the row selected in a slot.
+         */ 
+        struct SlotRow
+        {
+            unsigned int slot; // index of the slot
+            unsigned int coordinate; // coordinate of the row
+            unsigned int row; // index of the row in its coordinate
+        };
+
+        /**
+         * Constructs a walker over the compositions of \c k into \c s parts, starting from the composition \f$(k-s+1, 1, ..., 1)\f$.
+         */ 
+        CompositionRowWalker(unsigned int k, unsigned int s);
+
+        /**
+         * Returns the number of slots, that is \f$ k \f$.
+         */ 
+        unsigned int numSlots() const { return (unsigned int) m_initialRows.size(); }
+
+        /**
+         * Returns the rows selected by the first composition, in the order of the slots.
+         */ 
+        const std::vector<SlotRow>& initialRows() const { return m_initialRows; }
+
+        /** 
+         * Moves to the next composition. 
+         * Returns false when the walker is depleted and true otherwise.
+         */ 
+        bool next();
+
+        /**
+         * Returns the row which entered the selection with the last call to #next, in the slot of the row which left it.
+         */ 
+        const SlotRow& lastChange() const { return m_lastChange; }
+
+    private:
+        unsigned int& slotOf(unsigned int coordinate, unsigned int row) { return m_slots[(coordinate - 1) * m_maxRows + row]; }
+
+        CompositionMaker m_compositionMaker; // generator of the compositions
+        unsigned int m_maxRows; // maximal number of rows selected in a coordinate
+        std::vector<unsigned int> m_slots; // slot of each selected (coordinate, row) pair
+        std::vector<SlotRow> m_initialRows; // rows selected by the first composition
+        SlotRow m_lastChange; // row which entered the selection with the last move
 };
\ No newline at end of file
@@ -0,0 +1,84 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file contains the filter of the digital nets equivalent to nets seen before.
+ */
+
+#ifndef NETBUILDER__EQUIVALENT_NET_FILTER_H
+#define NETBUILDER__EQUIVALENT_NET_FILTER_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/DigitalNet.h"
+
+#include <string>
+#include <unordered_set>
+
+namespace NetBuilder {
+
+/**
+ * Filter of the digital nets equivalent to nets seen before.
+ *
+ * Multiplying all the generating matrices of a net on the right by the same invertible upper-triangular matrix
+ * only reorders the points within each of the embedded nets made of the first \f$2^k\f$ points, so that the figures of
+ * merit of unilevel and multilevel nets are unchanged. For unilevel nets, any invertible matrix keeps the point set.
+ * 
+ * The canonical form of a net for this equivalence is read from the generating matrices stacked on top of each other:
+ * - for multilevel nets, each column reduced modulo the span of the previous columns, by the reduced echelon basis of this span;
+ * - for unilevel nets, the reduced echelon basis of the span of all the columns.
+ * 
+ * The filter remembers the canonical forms of the nets seen so far, so that searches over whole nets can skip the
+ * candidates equivalent to a net already evaluated. A skipped net has the same merit as the first net of its class, so
+ * that skipping it does not change the net selected by a search.
+ */
+class EquivalentNetFilter
+{
+    public:
+        /**
+         * Constructor.
+         * @param embeddingType Embedding type of the nets, which selects the equivalence.
+         */
+        explicit EquivalentNetFilter(EmbeddingType embeddingType);
+
+        /**
+         * Returns the canonical form of \c net, as a string of bytes.
+         */
+        std::string canonicalForm(const AbstractDigitalNet& net) const;
+
+        /**
+         * Returns true if a net equivalent to \c net was seen before. Otherwise, records \c net and returns false.
+         */
+        bool seen(const AbstractDigitalNet& net);
+
+        /**
+         * Returns the number of classes of equivalent nets seen so far.
+         */
+        size_t numClasses() const { return m_canonicalForms.size(); }
+
+        /**
+         * Forgets the nets seen so far.
+         */
+        void clear() { m_canonicalForms.clear(); }
+
+    private:
+        EmbeddingType m_embeddingType; // embedding type of the nets
+        std::unordered_set<std::string> m_canonicalForms; // canonical forms of the nets seen so far
+};
+
+}
+
+#endif
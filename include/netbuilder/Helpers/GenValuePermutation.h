@@ -0,0 +1,138 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * This file contains the sampling without replacement of the generating values of a coordinate.
+ */
+
+#ifndef NETBUILDER__HELPERS__GEN_VALUE_PERMUTATION_H
+#define NETBUILDER__HELPERS__GEN_VALUE_PERMUTATION_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/NetConstructionTraits.h"
+
+#include "latbuilder/RandomPermutation.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+namespace NetBuilder {
+
+/**
+ * Random permutation of the sequence of the possible generating values of a coordinate.
+ *
+ * The generating values are accessed through their index in the sequence returned by
+ * NetConstructionTraits::genValueSpaceCoord(), which is permuted by a LatBuilder::RandomPermutation selected by a key.
+ * The first values of the permutation are thus a uniform sample without replacement of the generating values, drawn
+ * in constant memory.
+ * The permutation is only available if the random generating values of the construction method are uniform over this
+ * sequence (see NetConstructionTraits::uniformRandomGenValues) and if all the values of the sequence are addressable.
+ */
+template <NetConstruction NC, bool = NetConstructionTraits<NC>::uniformRandomGenValues>
+class GenValuePermutation
+{
+    typedef NetConstructionTraits<NC> ConstructionMethod;
+
+    public:
+        /**
+         * Permutes the generating values of coordinate \c coord with the permutation of key \c key.
+         * Returns \c false, and leaves the permutation inactive, if the values cannot be sampled through their index.
+         */
+        bool reset(Dimension coord, const typename ConstructionMethod::SizeParameter& sizeParameter, uint64_t key)
+        {
+            m_seq.reset();
+            if (ConstructionMethod::hasSpecialFirstCoordinate && coord == 0)
+            {
+                return false;
+            }
+            auto seq = std::make_unique<typename ConstructionMethod::GenValueSpaceCoordSeq>(ConstructionMethod::genValueSpaceCoord(coord, sizeParameter));
+            const auto size = seq->size();
+            if (size == 0 || size == std::numeric_limits<decltype(size)>::max())
+            {
+                return false; // empty, or only partly addressable
+            }
+            m_seq = std::move(seq);
+            m_permutation = LatBuilder::RandomPermutation((uint64_t) size, key);
+            return true;
+        }
+
+        /**
+         * Returns whether the permutation is active.
+         */
+        bool active() const
+        {
+            return (bool) m_seq;
+        }
+
+        /**
+         * Returns the number of generating values of the coordinate, or 0 if the permutation is inactive.
+         */
+        uint64_t size() const
+        {
+            return m_seq ? m_permutation.size() : 0;
+        }
+
+        /**
+         * Returns the generating value of index \c i in the permuted sequence.
+         */
+        typename ConstructionMethod::GenValue operator[](uint64_t i) const
+        {
+            return (*m_seq)[m_permutation(i)];
+        }
+
+    private:
+        std::unique_ptr<typename ConstructionMethod::GenValueSpaceCoordSeq> m_seq;
+        LatBuilder::RandomPermutation m_permutation;
+};
+
+/**
+ * Specialization for the construction methods whose random generating values are not uniform over an indexable
+ * sequence: the permutation is never active.
+ */
+template <NetConstruction NC>
+class GenValuePermutation<NC, false>
+{
+    typedef NetConstructionTraits<NC> ConstructionMethod;
+
+    public:
+        bool reset(Dimension, const typename ConstructionMethod::SizeParameter&, uint64_t)
+        {
+            return false;
+        }
+
+        bool active() const
+        {
+            return false;
+        }
+
+        uint64_t size() const
+        {
+            return 0;
+        }
+
+        typename ConstructionMethod::GenValue operator[](uint64_t) const
+        {
+            throw std::logic_error("the generating values of this construction method cannot be permuted");
+        }
+};
+
+}
+
+#endif
@@ -21,16 +21,21 @@
 #include <string>
 /**
  * \file 
- * This file contains a global variable PATH_TO_LATNETBUILDER_DIR which should always equal
+ * This file gives access to the path PATH_TO_LATNETBUILDER_DIR which should always equal
  * the path to the directory in which the latnetbuilder executable is located.
  * From this directory, the library recovers the location of the data files required for
  * some functionalities.
+ * The path is guarded by a mutex, so that it can be read by tasks running concurrently
+ * in the same process while another thread sets it.
  */
 
 namespace NetBuilder{
 
-    /// Path to the directory containing the latnetbuilder executable
-    extern std::string PATH_TO_LATNETBUILDER_DIR;
+    /**
+     * Returns the path to the directory containing the latnetbuilder executable,
+     * "." until it is set.
+     */
+    std::string GET_PATH_TO_LATNETBUILDER_DIR();
 
     /** Sets the path to the directory containing the latnetbuilder executable. 
      *  Should only be call from an executable which is located in the same 
@@ -55,6 +60,8 @@ namespace NetBuilder{
      * Alternatively, \c path can be a relative path from
      * the working directory from which the executable will be called.
      * Finally, \c path can be an absolute path.
+     * The path is checked as by CHECK_PATH_TO_LATNETBUILDER_DIR() before it is set,
+     * so that it is left unchanged if the check throws.
      * @param path New value of PATH_TO_LATNETBUILDER_DIR.
      */ 
     void SET_PATH_TO_LATNETBUILDER_DIR(const std::string& path);
@@ -0,0 +1,303 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file contains the bitmask representation of the projections used by the figures of merit.
+ */
+
+#ifndef NETBUILDER__PROJECTION_H
+#define NETBUILDER__PROJECTION_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/GeneratingMatrix.h"
+
+#include "latticetester/Coordinates.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace NetBuilder {
+
+/**
+ * Set of coordinates represented by a bitmask.
+ *
+ * The coordinates lower than 64 are held in a single word, so that the projections of nets of dimension
+ * at most 64 are built, copied and modified without any memory allocation; the larger coordinates are held in
+ * additional words. The coordinates are iterated in increasing order, as those of LatticeTester::Coordinates.
+ */
+class Projection
+{
+    public:
+
+        /// Type of the words of the bitmask.
+        typedef uint64_t Word;
+
+        /// Number of coordinates by word.
+        static constexpr unsigned int bitsPerWord = 64;
+
+        /**
+         * Iterator over the coordinates of a projection, in increasing order.
+         */
+        class const_iterator
+        {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef Dimension value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const Dimension* pointer;
+                typedef Dimension reference;
+
+                const_iterator(const Projection* projection, Dimension coord):
+                    m_projection(projection),
+                    m_coord(coord)
+                {};
+
+                Dimension operator*() const { return m_coord; }
+
+                const_iterator& operator++()
+                {
+                    m_coord = m_projection->next(m_coord + 1);
+                    return *this;
+                }
+
+                const_iterator operator++(int)
+                {
+                    const_iterator res(*this);
+                    ++(*this);
+                    return res;
+                }
+
+                bool operator==(const const_iterator& other) const { return m_coord == other.m_coord; }
+                bool operator!=(const const_iterator& other) const { return m_coord != other.m_coord; }
+
+            private:
+                const Projection* m_projection;
+                Dimension m_coord;
+        };
+
+        /// Value of the past-the-end coordinate.
+        static constexpr Dimension npos = ~Dimension(0);
+
+        /**
+         * Constructs the empty projection.
+         */
+        Projection():
+            m_low(0)
+        {};
+
+        /**
+         * Constructs the projection with the coordinates of \c coords.
+         */
+        explicit Projection(const LatticeTester::Coordinates& coords):
+            m_low(0)
+        {
+            for (auto coord : coords)
+            {
+                insert((Dimension) coord);
+            }
+        }
+
+        /**
+         * Adds the coordinate \c coord to the projection.
+         */
+        void insert(Dimension coord)
+        {
+            word(coord) |= Word(1) << (coord % bitsPerWord);
+        }
+
+        /**
+         * Removes the coordinate \c coord from the projection.
+         */
+        void erase(Dimension coord)
+        {
+            if (coord < bitsPerWord || coord / bitsPerWord <= m_high.size())
+            {
+                word(coord) &= ~(Word(1) << (coord % bitsPerWord));
+            }
+        }
+
+        /**
+         * Returns whether the projection contains the coordinate \c coord.
+         */
+        bool contains(Dimension coord) const
+        {
+            if (coord < bitsPerWord)
+            {
+                return (m_low >> coord) & 1;
+            }
+            const size_t index = coord / bitsPerWord - 1;
+            return index < m_high.size() && ((m_high[index] >> (coord % bitsPerWord)) & 1);
+        }
+
+        /**
+         * Returns the number of coordinates of the projection.
+         */
+        Dimension size() const
+        {
+            Dimension res = countSetBits(m_low);
+            for (Word w : m_high)
+            {
+                res += countSetBits(w);
+            }
+            return res;
+        }
+
+        /**
+         * Returns whether the projection is empty.
+         */
+        bool empty() const { return next(0) == npos; }
+
+        /**
+         * Returns the smallest coordinate of the projection larger than or equal to \c coord, or #npos if there is none.
+         */
+        Dimension next(Dimension coord) const
+        {
+            if (coord < bitsPerWord)
+            {
+                const Word w = m_low & ~lowBitsMask(coord);
+                if (w)
+                {
+                    return lowestSetBit(w);
+                }
+                coord = bitsPerWord;
+            }
+            for (size_t index = coord / bitsPerWord - 1; index < m_high.size(); ++index)
+            {
+                const Word w = m_high[index] & ~lowBitsMask(coord % bitsPerWord);
+                if (w)
+                {
+                    return (Dimension) ((index + 1) * bitsPerWord + lowestSetBit(w));
+                }
+                coord = (Dimension) ((index + 2) * bitsPerWord);
+            }
+            return npos;
+        }
+
+        /**
+         * Returns an iterator pointing to the smallest coordinate.
+         */
+        const_iterator begin() const { return const_iterator(this, next(0)); }
+
+        /**
+         * Returns an iterator pointing past the largest coordinate.
+         */
+        const_iterator end() const { return const_iterator(this, npos); }
+
+        /**
+         * Returns the projection as a LatticeTester::Coordinates, for instance to compute its weight.
+         */
+        LatticeTester::Coordinates toCoordinates() const
+        {
+            LatticeTester::Coordinates res;
+            for (auto coord : *this)
+            {
+                res.insert(coord);
+            }
+            return res;
+        }
+
+        bool operator==(const Projection& other) const
+        {
+            if (m_low != other.m_low)
+            {
+                return false;
+            }
+            const size_t n = std::max(m_high.size(), other.m_high.size());
+            for (size_t index = 0; index < n; ++index)
+            {
+                if ((index < m_high.size() ? m_high[index] : 0) != (index < other.m_high.size() ? other.m_high[index] : 0))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool operator!=(const Projection& other) const { return !(*this == other); }
+
+        /**
+         * Returns a hash of the projection, consistent with operator==.
+         */
+        size_t hash() const
+        {
+            uint64_t res = m_low * 0x9E3779B97F4A7C15ULL;
+            for (size_t index = 0; index < m_high.size(); ++index)
+            {
+                if (m_high[index]) // trailing empty words do not change the projection
+                {
+                    res ^= (m_high[index] + index + 1) * 0xC2B2AE3D27D4EB4FULL;
+                    res = (res << 31) | (res >> 33);
+                }
+            }
+            return (size_t) (res ^ (res >> 29));
+        }
+
+    private:
+        Word m_low; // coordinates 0 to 63
+        std::vector<Word> m_high; // coordinates from 64 on, by words of 64 coordinates
+
+        Word& word(Dimension coord)
+        {
+            if (coord < bitsPerWord)
+            {
+                return m_low;
+            }
+            const size_t index = coord / bitsPerWord - 1;
+            if (index >= m_high.size())
+            {
+                m_high.resize(index + 1, 0);
+            }
+            return m_high[index];
+        }
+};
+
+/**
+ * Writes the coordinates of \c projection to \c os.
+ */
+inline std::ostream& operator<<(std::ostream& os, const Projection& projection)
+{
+    os << "{";
+    bool first = true;
+    for (auto coord : projection)
+    {
+        os << (first ? "" : ",") << coord;
+        first = false;
+    }
+    return os << "}";
+}
+
+}
+
+namespace std {
+
+/**
+ * Hash of the projections, to use them as keys of unordered containers.
+ */
+template <>
+struct hash<NetBuilder::Projection>
+{
+    size_t operator()(const NetBuilder::Projection& projection) const { return projection.hash(); }
+};
+
+}
+
+#endif
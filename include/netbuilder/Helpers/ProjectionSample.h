@@ -0,0 +1,92 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file contains the samples of projections used to estimate weighted figures of merit.
+ */
+
+#ifndef NETBUILDER__PROJECTION_SAMPLE_H
+#define NETBUILDER__PROJECTION_SAMPLE_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/FigureOfMerit/FigureOfMerit.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace NetBuilder {
+
+/**
+ * Sample of the projections of a coordinate, drawn with replacement with probabilities proportional to their weights.
+ *
+ * If \f$W\f$ is the sum of the weights \f$w_u\f$ of the projections and \f$u_1, \dots, u_K\f$ are the sampled projections,
+ * \f$W K^{-1} \sum_k v_{u_k}\f$ is an unbiased estimator of \f$\sum_u w_u v_u\f$, whose variance is estimated from the sample
+ * variance of the \f$v_{u_k}\f$. The estimator is exact when the values do not depend on the projection, and the heavy
+ * projections, which are drawn many times, are evaluated once.
+ * If the sample is not smaller than the number of projections, all the projections are taken instead and the weighted sum is exact.
+ *
+ * The sample of coordinate \f$j\f$ is drawn from stream \f$j\f$ of LatBuilder::LFSR258 from its default seed, so that all the
+ * candidates of a coordinate, in all the evaluators, are estimated from the same projections.
+ */
+class ProjectionSample
+{
+    public:
+
+        /**
+         * Constructs an empty sample.
+         */
+        ProjectionSample();
+
+        /**
+         * Returns \c true if the sample was drawn for the coordinate \c coord with size \c sampleSize.
+         */
+        bool drawn(Dimension coord, size_t sampleSize) const { return m_coord == coord && m_sampleSize == sampleSize; }
+
+        /**
+         * Draws the sample of the coordinate \c coord among the projections of weights \c weights.
+         * @param coord Coordinate of the projections.
+         * @param weights Nonnegative weights of the projections.
+         * @param sampleSize Number of projections drawn with replacement.
+         */
+        void draw(Dimension coord, const std::vector<Real>& weights, size_t sampleSize);
+
+        /**
+         * Returns the distinct indices of the sampled projections, in increasing order.
+         */
+        const std::vector<size_t>& indices() const { return m_indices; }
+
+        /**
+         * Returns the estimate of the weighted sum of the values of the projections, given the values \c values of the
+         * projections of indices(), in the same order.
+         * @param values Values of the sampled projections.
+         * @param zScore Half-width of the confidence interval, in estimated standard errors.
+         */
+        MeritEstimate estimate(const std::vector<Real>& values, Real zScore) const;
+
+    private:
+
+        Dimension m_coord; // coordinate of the sample, or Projection::npos
+        size_t m_sampleSize; // requested size of the sample
+        Real m_totalWeight; // sum of the weights of the projections
+        bool m_exact; // whether all the projections are taken
+        std::vector<size_t> m_indices; // distinct sampled projections
+        std::vector<Real> m_factors; // number of draws of each sampled projection, or its weight if m_exact
+};
+
+}
+
+#endif
@@ -24,9 +24,10 @@
 
 #include "netbuilder/GeneratingMatrix.h"
 
+#include <array>
+#include <limits>
 #include <map>
-#include <set>
-#include <list>
+#include <vector>
 
 // #define DEBUG_ROW_REDUCER
 
@@ -34,6 +35,15 @@ namespace NetBuilder {
 
 /**
  * Class used to perform row reduction operations on a matrix.
+ * 
+ * When the matrix has at most GeneratingMatrix::maxPackedCols columns and rows, the reduction is stored
+ * in word-packed rows (see GeneratingMatrix::PackedRow): row operations are XORs of machine words and
+ * pivots are found with bit scans, without any heap allocation. The rank computer switches transparently
+ * to the general representation when the matrix outgrows this size.
+ *
+ * The reduction can be saved with #checkpoint and restored with #rollback, which allows to try several 
+ * sets of additional rows on top of a common reduction without copying the rank computer. Checkpoints
+ * can be nested with #pushCheckpoint and #popCheckpoint to add and remove rows in stack order.
  */ 
 class RankComputer
 {
@@ -55,6 +65,15 @@ class RankComputer
          */ 
         void addRow(GeneratingMatrix newRow);
 
+        /**
+         * Adds the first numCols() elements of the row \c row of \c matrix below the current matrix and 
+         * updates the reduction subsequently. Equivalent to <code>addRow(matrix.subMatrix(row, 0, 1, numCols()))</code>
+         * without the copy.
+         * @param matrix Matrix containing the row to add.
+         * @param row Index of the row in \c matrix.
+         */ 
+        void addRow(const GeneratingMatrix& matrix, unsigned int row);
+
         /**
          * Adds a column on the right to the current matrix and updates the reduction subsequently.
          * @param newCol The one-column matrix to stack on the right.
@@ -69,6 +88,15 @@ class RankComputer
          */ 
         void replaceRow(unsigned int rowIndex, GeneratingMatrix&& newRow, int verbose = 0);
 
+        /**
+         * Replaces the row in position \c rowIndex by the first numCols() elements of the row \c row of \c matrix.
+         * @param rowIndex Index of the row to discard.
+         * @param matrix Matrix containing the replacement row.
+         * @param row Index of the replacement row in \c matrix.
+         * @param verbose Verbosity level.
+         */ 
+        void replaceRow(unsigned int rowIndex, const GeneratingMatrix& matrix, unsigned int row, int verbose = 0);
+
         /** 
          * Computes the rank of the matrix.
          */ 
@@ -81,21 +109,30 @@ class RankComputer
          */ 
         std::vector<unsigned int> computeRanks(unsigned int firstCol, unsigned int numCol) const;
 
+        /** 
+         * Computes the ranks of the submatrices with an increasing number of columns into \c ranks, which is resized
+         * to \c numCol elements. Passing the same vector at each call avoids allocating the ranks.
+         * @param firstCol Index of the the last column of the first submatrix.
+         * @param numCol Number of submatrices to consider.
+         * @param ranks Output ranks.
+         */ 
+        void computeRanks(unsigned int firstCol, unsigned int numCol, std::vector<unsigned int>& ranks) const;
+
         /** 
          * Returns the minimal number of columns necessary for the system spanned by the rows to be of full rank.
          * Returns nCols() + 1 if the system is not of full rank even if all the columns are taken.
          */ 
-        unsigned int smallestFullRank() { return m_smallestFullRank; }
+        unsigned int smallestFullRank() const { return m_smallestFullRank; }
 
         /**
-         * Returns a const reference to the row-reduced matrix.
+         * Returns the row-reduced matrix.
          */ 
-        const GeneratingMatrix& reducedMatrix() const {return m_redMat;}
+        GeneratingMatrix reducedMatrix() const;
 
         /**
-         * Returns a const reference to the row operations matrix.
+         * Returns the row operations matrix.
          */ 
-        const GeneratingMatrix& rowOperations() const {return m_rowOperations; }
+        GeneratingMatrix rowOperations() const;
 
         /**
          * Returns the number of rows in the rank computer.
@@ -110,13 +147,52 @@ class RankComputer
         /**
          * Returns a map of pivot positions (key: row index, value: column index).
          */ 
-        std::map<unsigned int, unsigned int> getPivots() const {return m_pivotsRowColPositions; }
+        std::map<unsigned int, unsigned int> getPivots() const;
 
         /**
          * Check if a matrix is invertible. Returns false if the matrix is not-square or singular, 
          * and true otherwise.
          */ 
         static bool checkIfInvertible(GeneratingMatrix matrix) ;
+
+        /**
+         * Saves the current reduction so that it can be restored by #rollback.
+         * Between the checkpoint and the rollback, rows may only be added with #addRow: the existing rows modified by
+         * these additions are journaled, so that the cost of the rollback is proportional to the work done since the checkpoint.
+         * Any other modification of the rank computer discards the checkpoint, as well as the nested checkpoints.
+         */ 
+        void checkpoint();
+
+        /**
+         * Saves the current reduction on top of the current checkpoints, if any. The checkpoints are nested:
+         * #rollback and #popCheckpoint act on the last one, so that a sequence of sets of rows can be added and
+         * removed in stack order, each removal costing only the work done since its checkpoint.
+         */ 
+        void pushCheckpoint();
+
+        /**
+         * Restores the reduction saved by the last call to #checkpoint or #pushCheckpoint. The checkpoint is kept, so that 
+         * several sets of rows can be tried in turn on top of the same reduction.
+         * @throws std::logic_error if there is no checkpoint.
+         */ 
+        void rollback();
+
+        /**
+         * Restores the reduction saved by the last checkpoint and discards this checkpoint, so that the previous one,
+         * if any, becomes the last one.
+         * @throws std::logic_error if there is no checkpoint.
+         */ 
+        void popCheckpoint();
+
+        /**
+         * Returns true if a reduction was saved by #checkpoint and can be restored by #rollback.
+         */ 
+        bool hasCheckpoint() const { return !m_checkpoints.empty(); }
+
+        /**
+         * Returns the number of nested checkpoints.
+         */ 
+        unsigned int numCheckpoints() const { return (unsigned int) m_checkpoints.size(); }
         
         #ifdef DEBUG_ROW_REDUCER
         void check();
@@ -125,20 +201,94 @@ class RankComputer
 
 
     private:
+
+        typedef GeneratingMatrix::PackedRow PackedRow;
+
+        static constexpr unsigned int noPivot = std::numeric_limits<unsigned int>::max(); // pivot position of the rows and columns without pivot
     
         unsigned int m_nRows = 0; // number of rows in the rank computer
         unsigned int m_nCols; // number of columns of the rank computer
         unsigned int m_smallestFullRank; // minimal number of columns necessary for the system spanned by the rows to be full-rank.
         GeneratingMatrix m_redMat; // row-reduced matrix
         GeneratingMatrix m_rowOperations; // row operations matrix
-        std::map<unsigned int, unsigned int> m_pivotsColRowPositions; // columns index are the keys and rows indexes are the values
-        std::map<unsigned int, unsigned int> m_pivotsRowColPositions; // columns index are the keys and rows indexes are the values
-        std::set<unsigned int> m_columnsWithoutPivot; // ordered set for columns without a pivot
-        std::list<unsigned int> m_rowsWithoutPivot; // list of rows without a pivot 
+        std::vector<unsigned int> m_pivotRowOfCol; // row of the pivot of each column (noPivot if none)
+        std::vector<unsigned int> m_pivotColOfRow; // column of the pivot of each row (noPivot if none)
+        GeneratingMatrix::Row m_columnsWithoutPivot; // bit set of the columns without a pivot
+        GeneratingMatrix::Row m_rowsWithoutPivot; // bit set of the rows without a pivot
+        GeneratingMatrix::Row m_scratchRow; // work row reused by the reductions to avoid allocations
         #ifdef DEBUG_ROW_REDUCER
         GeneratingMatrix m_baseMatrix;
         #endif
 
+        bool m_packed; // true if the reduction is stored in the word-packed members below instead of the members above
+        std::array<PackedRow, GeneratingMatrix::maxPackedCols> m_packedRedMat; // row-reduced matrix in packed mode
+        std::array<PackedRow, GeneratingMatrix::maxPackedCols> m_packedRowOperations; // row operations matrix in packed mode
+        std::array<unsigned int, GeneratingMatrix::maxPackedCols> m_packedPivotColOfRow; // column of the pivot of each row (noPivot if none) in packed mode
+        std::array<unsigned int, GeneratingMatrix::maxPackedCols> m_packedPivotRowOfCol; // row of the pivot of each column with a pivot in packed mode
+        PackedRow m_packedColumnsWithoutPivot; // mask of the columns without a pivot in packed mode
+        PackedRow m_packedRowsWithoutPivot; // mask of the rows without a pivot in packed mode
+
+        /// Saved values of a row modified after the checkpoint in packed mode.
+        struct PackedJournalEntry
+        {
+            unsigned int row;
+            PackedRow redRow;
+            PackedRow rowOperations;
+        };
+
+        /// Saved values of a row modified after the checkpoint in general mode.
+        struct JournalEntry
+        {
+            unsigned int row;
+            GeneratingMatrix::Row redRow;
+            GeneratingMatrix::Row rowOperations;
+        };
+
+        /// Reduction saved by a checkpoint.
+        struct Checkpoint
+        {
+            bool packed; // true if the reduction was in packed mode at the checkpoint
+            unsigned int nRows; // number of rows at the checkpoint
+            unsigned int smallestFullRank; // smallest full rank at the checkpoint
+            PackedRow columnsWithoutPivot; // mask of the columns without a pivot at the checkpoint in packed mode
+            PackedRow rowsWithoutPivot; // mask of the rows without a pivot at the checkpoint in packed mode
+            std::size_t packedJournalSize; // size of the packed journal at the checkpoint
+            std::size_t journalSize; // size of the general journal at the checkpoint
+        };
+
+        std::vector<Checkpoint> m_checkpoints; // nested checkpoints, the last one being the innermost
+        std::vector<PackedJournalEntry> m_packedJournal; // rows modified since the first checkpoint in packed mode, in order of modification
+        std::vector<JournalEntry> m_journal; // rows modified since the first checkpoint in general mode, in order of modification
+
+        /**
+         * Switches from the word-packed representation to the general one.
+         */ 
+        void unpack();
+
+        /**
+         * Discards the checkpoints, if any.
+         */ 
+        void discardCheckpoint();
+
+        /**
+         * Adds a packed row below the current matrix and updates the reduction subsequently (packed mode only).
+         * @param newRow The row to stack below.
+         */ 
+        void addPackedRow(PackedRow newRow);
+
+        /**
+         * Replaces the row in position \c rowIndex by \c newRow (packed mode only).
+         * @param rowIndex Index of the row to discard.
+         * @param newRow Replacement row.
+         */ 
+        void replacePackedRow(unsigned int rowIndex, PackedRow newRow);
+
+        /**
+         * Packed mode counterpart of pivotRowAndFindNewPivot.
+         * @param rowIndex Index of the row.
+         */ 
+        unsigned int pivotPackedRowAndFindNewPivot(unsigned int rowIndex);
+
         /**
          * Uses existing pivots to pivot the row at position \c rowIndex and look for
          * a new pivot on this row. If such a pivot exists, uses it to pivot the other rows.
@@ -0,0 +1,99 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file defines a process-wide cache of the t-values of the projections of digital nets.
+ */ 
+
+#ifndef NETBUILDER__HELPERS__TVALUE_CACHE_H
+#define NETBUILDER__HELPERS__TVALUE_CACHE_H
+
+#include "netbuilder/GeneratingMatrix.h"
+
+#include <functional>
+#include <vector>
+
+namespace NetBuilder {
+
+/**
+ * Process-wide cache of the t-values of projections, identified by their generating matrices.
+ * 
+ * The t-values of a projection only depend on its generating matrices, so that evaluations of the same net 
+ * with different level combiners, or the evaluations of several tasks in one process, can share them.
+ * The multilevel t-values are stored with the unilevel t-value, which is the t-value of the last level: 
+ * unilevel evaluations reuse the multilevel computations on the same matrices.
+ * 
+ * The computations must be given the maxima of the t-values of the subprojections (which are always smaller
+ * than or equal to the t-values of the projection), so that they return the exact t-values.
+ * 
+ * The computations are called after the last access to the matrices, so that they may move them.
+ * 
+ * The cache is disabled by default; it is enabled by setting its capacity with #setCapacity. When it is full, 
+ * the oldest entries are evicted first.
+ */ 
+class TValueCache
+{
+    public:
+
+        /**
+         * Returns the t-values of each level of the projection whose generating matrices are \c matrices, 
+         * computed with \c compute if they are not in the cache.
+         */ 
+        static std::vector<unsigned int> multilevel(const std::vector<GeneratingMatrix>& matrices, const std::function<std::vector<unsigned int>()>& compute);
+
+        /**
+         * Returns the t-value of the projection whose generating matrices are \c matrices, 
+         * computed with \c compute if it is not in the cache.
+         */ 
+        static unsigned int unilevel(const std::vector<GeneratingMatrix>& matrices, const std::function<unsigned int()>& compute);
+
+        /**
+         * Looks for the t-value of the projection whose generating matrices are \c matrices, without computing it.
+         * Returns true and sets \c tValue if it is in the cache, and false otherwise.
+         */ 
+        static bool findUnilevel(const std::vector<GeneratingMatrix>& matrices, unsigned int& tValue);
+
+        /**
+         * Looks for the t-values of each level of the projection whose generating matrices are \c matrices, without computing them.
+         * Returns true and sets \c tValues if they are in the cache, and false otherwise.
+         */ 
+        static bool findMultilevel(const std::vector<GeneratingMatrix>& matrices, std::vector<unsigned int>& tValues);
+
+        /**
+         * Sets the maximal number of projections kept in the cache. The cache is disabled if \c numEntries is zero (the default).
+         */ 
+        static void setCapacity(size_t numEntries);
+
+        /**
+         * Returns true if the cache is enabled.
+         */ 
+        static bool enabled();
+
+        /**
+         * Returns the maximal number of projections kept in the cache, which is zero if it is disabled.
+         */
+        static size_t capacity();
+
+        /**
+         * Removes all entries of the cache.
+         */ 
+        static void clear();
+};
+
+}
+
+#endif
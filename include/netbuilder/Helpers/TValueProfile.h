@@ -0,0 +1,131 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file contains the t-values of the low-order projections of a digital net.
+ */
+
+#ifndef NETBUILDER__TVALUE_PROFILE_H
+#define NETBUILDER__TVALUE_PROFILE_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/DigitalNet.h"
+#include "netbuilder/Helpers/Projection.h"
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace NetBuilder {
+
+/**
+ * t-values of all the projections of a digital net whose order is at most a given order.
+ *
+ * The projections are enumerated once, in prefix order: each projection is followed by the projections obtained by
+ * adding higher coordinates to it, so that the projections of each first coordinate form a tree. The rows of the generating matrices
+ * of each projection which is extended are reduced once (see GaussMethod::Reduction), and the t-value of each child is computed
+ * by adding the rows of its highest coordinate to this reduction, with the t-values of its parent and of its highest coordinate as
+ * lower bounds. The trees of the first coordinates are computed in parallel by the global ThreadPool.
+ *
+ * The t-values are those of the whole generating matrices, as for unilevel nets.
+ *
+ * The profile can also be written to a binary file (see writeBinary()) and read back with readBinary(), so that the
+ * evaluations of the same net with other weights or norm types take the t-values from the TValueCache (see fillCache())
+ * instead of computing them again.
+ */
+class TValueProfile
+{
+    public:
+        /// t-value of a projection.
+        struct Entry
+        {
+            Projection projection;
+            unsigned int tValue;
+        };
+
+        /**
+         * Computes the t-values of the projections of \c net of order at most \c maxOrder.
+         * @param net Digital net.
+         * @param maxOrder Largest order of the projections; must be positive.
+         */
+        TValueProfile(const AbstractDigitalNet& net, Dimension maxOrder);
+
+        /**
+         * Reads the profile written to the file \c fileName by writeBinary().
+         * @throw std::runtime_error if the file cannot be read or is not a binary t-value profile.
+         */
+        static TValueProfile readBinary(const std::string& fileName);
+
+        /**
+         * Returns the dimension of the net.
+         */
+        Dimension dimension() const { return m_dimension; }
+
+        /**
+         * Returns the largest order of the projections.
+         */
+        Dimension maxOrder() const { return m_maxOrder; }
+
+        /**
+         * Returns the t-values of the projections, in prefix order.
+         */
+        const std::vector<Entry>& entries() const { return m_entries; }
+
+        /**
+         * Writes one line for each projection to \c os, in prefix order: the coordinates of the projection, numbered from 1
+         * and separated by commas as in the projection-dependent weights, a colon and the t-value.
+         */
+        void write(std::ostream& os) const;
+
+        /**
+         * Writes the t-values of the projections to the file \c fileName, as write().
+         * @throw std::runtime_error if the file cannot be written.
+         */
+        void write(const std::string& fileName) const;
+
+        /**
+         * Writes the profile to the binary file \c fileName. All the values are little-endian: the magic bytes \c LNBT,
+         * the version of the format (currently #binaryVersion), the dimension of the net and the largest order as 32-bit
+         * unsigned integers, and the number of projections as a 64-bit unsigned integer. Each projection follows, in prefix
+         * order, as its order, its coordinates numbered from 0 and its t-value, all of them 32-bit unsigned integers.
+         * @throw std::runtime_error if the file cannot be written.
+         */
+        void writeBinary(const std::string& fileName) const;
+
+        /**
+         * Stores the t-values of the projections of \c net in the TValueCache, which must be enabled with a capacity of at least
+         * the number of projections. The unilevel t-value figures of merit evaluated on \c net then read the t-values of these projections
+         * from the cache. \c net must be the net of the profile.
+         * @throw std::invalid_argument if the dimension of \c net is not that of the profile.
+         */
+        void fillCache(const AbstractDigitalNet& net) const;
+
+        /// Version of the format written by writeBinary().
+        static constexpr uint32_t binaryVersion = 1;
+
+    private:
+        TValueProfile() = default;
+
+        Dimension m_dimension = 0;
+        Dimension m_maxOrder = 0;
+        std::vector<Entry> m_entries;
+};
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file contains the precomputed tables of the weights of the projections.
+ */
+
+#ifndef NETBUILDER__WEIGHT_TABLE_H
+#define NETBUILDER__WEIGHT_TABLE_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/Helpers/Projection.h"
+
+#include "latticetester/Weights.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace NetBuilder {
+
+/**
+ * Table of the weights of the projections, built once from LatticeTester::Weights.
+ *
+ * The weights of the usual types are looked up without any virtual call nor LatticeTester::Coordinates:
+ * - order-dependent weights, by a dense array indexed by the order;
+ * - product weights, by a dense array indexed by the coordinate;
+ * - POD weights, by both arrays;
+ * - projection-dependent weights, by a hash table keyed by the bitmask of the projections;
+ * - combined weights (see LatBuilder::CombinedWeights), by the sum of the tables of the combined weights.
+ *
+ * The weights of the other types, and the weights missing from the tables (such as the default weights of the
+ * projection-dependent weights), are computed by LatticeTester::Weights::getWeight, so that
+ * weight() always returns the same value as the weights the table is built from.
+ */
+class WeightTable
+{
+    public:
+        /**
+         * Builds the table of \c weights, which must outlive the table.
+         */
+        explicit WeightTable(const LatticeTester::Weights& weights);
+
+        /**
+         * Returns the weight of the projection \c projection.
+         */
+        Real weight(const Projection& projection) const
+        {
+            switch (m_kind)
+            {
+                case Kind::ORDER_DEPENDENT:
+                    return orderWeight(projection.size());
+                case Kind::PRODUCT:
+                    return projection.empty() ? fallback(projection) : productWeight(projection);
+                case Kind::POD:
+                    return projection.empty() ? fallback(projection) : orderWeight(projection.size()) * productWeight(projection);
+                case Kind::PROJECTION_DEPENDENT:
+                {
+                    const auto it = m_projectionWeights.find(projection);
+                    return it != m_projectionWeights.end() ? it->second : fallback(projection);
+                }
+                case Kind::COMBINED:
+                {
+                    Real sum = 0;
+                    for (const auto& table : m_components)
+                    {
+                        sum += table.weight(projection);
+                    }
+                    return sum;
+                }
+                default:
+                    return fallback(projection);
+            }
+        }
+
+    private:
+        enum class Kind { ORDER_DEPENDENT, PRODUCT, POD, PROJECTION_DEPENDENT, COMBINED, OTHER };
+
+        Real orderWeight(Dimension order) const
+        { return order < m_orderWeights.size() ? m_orderWeights[order] : m_defaultOrderWeight; }
+
+        Real productWeight(const Projection& projection) const
+        {
+            Real res = 1;
+            for (auto coord : projection)
+            {
+                res *= coord < m_coordinateWeights.size() ? m_coordinateWeights[coord] : m_defaultCoordinateWeight;
+            }
+            return res;
+        }
+
+        Real fallback(const Projection& projection) const
+        { return m_weights.getWeight(projection.toCoordinates()); }
+
+        const LatticeTester::Weights& m_weights;
+        Kind m_kind;
+        std::vector<Real> m_orderWeights; // weight of each order
+        Real m_defaultOrderWeight;
+        std::vector<Real> m_coordinateWeights; // weight of each coordinate
+        Real m_defaultCoordinateWeight;
+        std::unordered_map<Projection, Real> m_projectionWeights; // weights given explicitly for some projections
+        std::vector<WeightTable> m_components; // tables of the combined weights
+};
+
+}
+
+#endif
@@ -0,0 +1,209 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Parsing of the tasks of the command line, by net construction.
+ */
+
+#ifndef NETBUILDER__MAKE_TASK_H
+#define NETBUILDER__MAKE_TASK_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/Parser/CommandLine.h"
+#include "netbuilder/Parser/OutputStyleParser.h"
+#include "netbuilder/ResultCache.h"
+#include "netbuilder/Task/Task.h"
+#include "netbuilder/Task/ResultCacheTask.h"
+
+#include "latbuilder/Checkpoint.h"
+#include "latbuilder/Distributed.h"
+#include "latbuilder/Shard.h"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace NetBuilder{
+
+/**
+ * Entry points of the modules of the net constructions (see LatBuilder::Module), which parse the task
+ * described by the options \c opt into \c task and set \c interlacingFactor and \c outputStyle to those
+ * of the task.
+ */
+extern "C" {
+typedef void MakeTaskFunction(const boost::program_options::variables_map& opt, const std::string& outputFolder,
+                              unsigned int& interlacingFactor, OutputStyle& outputStyle, std::unique_ptr<Task::Task>& task);
+MakeTaskFunction netbuilder_make_task_sobol;
+MakeTaskFunction netbuilder_make_task_polynomial;
+MakeTaskFunction netbuilder_make_task_explicit;
+MakeTaskFunction netbuilder_make_task_lms;
+}
+
+/**
+ * Returns the description of the task of the command line for the result cache, without its dimension. The values
+ * of the options are stripped of their spaces and the weights, which are summed, are sorted.
+ */
+std::string resultCacheDescription(const boost::program_options::variables_map& opt);
+
+/**
+ * Returns \c true if the exploration of the command line is a CBC exploration which can start from the net
+ * of the same exploration for fewer coordinates.
+ */
+bool extendsCachedNets(const boost::program_options::variables_map& opt);
+
+/**
+ * Parses the task of the command line, answered from the result cache given by --result-cache when possible.
+ * A CBC exploration starts from the net of the same exploration for the largest number of coordinates
+ * below its dimension found in the cache.
+ */
+template <NetBuilder::NetConstruction NC, NetBuilder::EmbeddingType ET>
+std::unique_ptr<Task::Task> parseCachedTask(NetBuilder::Parser::CommandLine<NC, ET>& cmd, const boost::program_options::variables_map& opt)
+{
+  const ResultCache cache(opt["result-cache"].as<std::string>());
+  const std::string description = resultCacheDescription(opt);
+  const Dimension dimension = boost::lexical_cast<Dimension>(cmd.s_dimension);
+  auto task = std::make_unique<Task::ResultCacheTask<NC>>(cmd.parse(), cache, description, dimension, cmd.m_sizeParameter);
+  if (task->cached() || !extendsCachedNets(opt)){
+    return std::move(task);
+  }
+  for (Dimension baseDimension = dimension; baseDimension-- > 1; ){
+    ResultCache::Entry entry;
+    if (!cache.read(description, baseDimension, entry)){
+      continue;
+    }
+    // the entry must have been written by the same task for fewer coordinates
+    cmd.s_dimension = std::to_string(baseDimension);
+    const std::string key = description + cmd.parse()->format();
+    cmd.s_dimension = std::to_string(dimension);
+    if (entry.key != key){
+      continue;
+    }
+    std::cout << "Starting from the net of dimension " << baseDimension << " of the result cache " << cache.directory() << std::endl;
+    cmd.m_baseGenValues = entry.genValues;
+    return std::make_unique<Task::ResultCacheTask<NC>>(cmd.parse(), cache, description, dimension, cmd.m_sizeParameter);
+  }
+  return std::move(task);
+}
+
+
+/**
+ * Writes the net selected by \c task to the shard result \c fileName (see LatBuilder::Shard).
+ */
+template <NetBuilder::NetConstruction NC>
+void writeShardResult(const Task::Task& task, const std::string& fileName)
+{
+  LatBuilder::Shard::Result result;
+  result.index = LatBuilder::Shard::index();
+  result.count = LatBuilder::Shard::count();
+  result.merit = task.outputMeritValue();
+  result.genValues = Task::formatCBCNet(dynamic_cast<const DigitalNet<NC>&>(task.resultNet()));
+  result.write(fileName);
+}
+
+/**
+ * Parses the task of the command line. With --result-cache, the task is answered from the cache when possible
+ * (see parseCachedTask()). If the search is split into shards, the net it selects is written to shard.txt
+ * in \c outputFolder.
+ */
+template <NetBuilder::NetConstruction NC, NetBuilder::EmbeddingType ET>
+std::unique_ptr<Task::Task> parseTask(NetBuilder::Parser::CommandLine<NC, ET>& cmd, const boost::program_options::variables_map& opt, const std::string& outputFolder)
+{
+  auto task = opt.count("result-cache") >= 1 ? parseCachedTask(cmd, opt) : cmd.parse();
+  if (LatBuilder::Shard::active() && outputFolder != "" && LatBuilder::Distributed::isRoot()){
+    const std::string fileName = outputFolder + "/shard.txt";
+    task->connectOnNetSelected([fileName](const Task::Task& selected){ writeShardResult<NC>(selected, fileName); });
+  }
+  return task;
+}
+
+/**
+ * Parses the task of the net construction \c NC described by the options \c opt (see parseTask())
+ * and sets \c interlacingFactor and \c outputStyle to those of the task.
+ */
+template <NetBuilder::NetConstruction NC, NetBuilder::EmbeddingType ET>
+std::unique_ptr<Task::Task> buildTask(const boost::program_options::variables_map& opt, const std::string& outputFolder, unsigned int& interlacingFactor, OutputStyle& outputStyle)
+{
+    NetBuilder::Parser::CommandLine<NC, ET> cmd;
+
+    cmd.s_verbose = opt["verbose"].as<std::string>();
+    cmd.s_explorationMethod = opt["exploration-method"].as<std::string>();
+    cmd.s_size = opt["size-parameter"].as<std::string>();
+    cmd.s_dimension = opt["dimension"].as<std::string>();
+    const auto& figures = opt["figure-of-merit"].as<std::vector<std::string>>();
+    cmd.s_figure = figures.front();
+    cmd.s_additionalFigures.assign(figures.begin() + 1, figures.end());
+    cmd.s_weights       = opt["weights"].as<std::vector<std::string>>();
+    cmd.m_normType = boost::lexical_cast<Real>(opt["norm-type"].as<std::string>());
+    cmd.m_interlacingFactor = opt["interlacing-factor"].as<unsigned int>();
+    cmd.m_nThreads = opt["threads"].as<unsigned int>();
+    if (outputFolder != ""){
+        cmd.m_checkpointFile = outputFolder + "/checkpoint.txt";
+    }
+    cmd.m_resume = opt["resume"].as<bool>();
+    if (opt["save-state"].as<bool>()){
+        cmd.m_stateFile = outputFolder + "/state.bin";
+    }
+    if (opt.count("resume-state") >= 1){
+        cmd.m_resumeStateFile = opt["resume-state"].as<std::string>();
+    }
+    if (opt.count("base-net") >= 1){
+        cmd.m_baseGenValues = LatBuilder::Checkpoint::read(opt["base-net"].as<std::string>()).genValues;
+    }
+    cmd.m_progressiveLevels = opt["progressive-levels"].as<bool>();
+    cmd.m_skipEquivalentNets = opt["skip-equivalent-nets"].as<bool>();
+    if (opt.count("tvalue-profile") >= 1){
+        cmd.m_tValueProfileOrder = opt["tvalue-profile"].as<unsigned int>();
+        cmd.m_tValueProfileFile = outputFolder + "/tvalues.txt";
+        cmd.m_tValueProfileBinaryFile = outputFolder + "/tvalues.bin";
+    }
+    if (opt.count("tvalue-table") >= 1){
+        cmd.m_tValueTableFile = opt["tvalue-table"].as<std::string>();
+    }
+    interlacingFactor = cmd.m_interlacingFactor;
+    if (opt.count("combiner") < 1){
+        cmd.s_combiner = "";
+    }
+    else{
+        cmd.s_combiner = opt["combiner"].as<std::string>();
+    }
+    if (opt.count("weight-power") == 1 ){
+        cmd.m_weightPower = boost::lexical_cast<Real>(opt["weight-power"].as<std::string>());
+    }
+    else{
+        if (cmd.m_normType < std::numeric_limits<Real>::infinity())
+        {
+            cmd.m_weightPower = cmd.m_normType;
+        }
+        else
+        {
+            cmd.m_weightPower = 1;
+        }
+    }
+    auto task = parseTask(cmd, opt, outputFolder);
+    outputStyle = NetBuilder::Parser::OutputStyleParser<NC>::parse(opt["output-style"].as<std::string>());
+    return task;
+}
+
+}
+
+#endif
@@ -0,0 +1,60 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Net constructions of the shared modules (see LatBuilder::Module).
+ */
+
+#ifndef NETBUILDER__MODULE_H
+#define NETBUILDER__MODULE_H
+
+#include "latbuilder/Module.h"
+
+// In modular builds, the module of a net construction is compiled with
+// NETBUILDER_MODULE_CONSTRUCTION_<construction> defined, so that it only
+// instantiates the tasks of that construction.
+#if defined(NETBUILDER_MODULE_CONSTRUCTION_SOBOL) || defined(NETBUILDER_MODULE_CONSTRUCTION_POLYNOMIAL) || \
+    defined(NETBUILDER_MODULE_CONSTRUCTION_EXPLICIT) || defined(NETBUILDER_MODULE_CONSTRUCTION_LMS)
+#ifdef NETBUILDER_MODULE_CONSTRUCTION_SOBOL
+#define NETBUILDER_WITH_CONSTRUCTION_SOBOL 1
+#else
+#define NETBUILDER_WITH_CONSTRUCTION_SOBOL 0
+#endif
+#ifdef NETBUILDER_MODULE_CONSTRUCTION_POLYNOMIAL
+#define NETBUILDER_WITH_CONSTRUCTION_POLYNOMIAL 1
+#else
+#define NETBUILDER_WITH_CONSTRUCTION_POLYNOMIAL 0
+#endif
+#ifdef NETBUILDER_MODULE_CONSTRUCTION_EXPLICIT
+#define NETBUILDER_WITH_CONSTRUCTION_EXPLICIT 1
+#else
+#define NETBUILDER_WITH_CONSTRUCTION_EXPLICIT 0
+#endif
+#ifdef NETBUILDER_MODULE_CONSTRUCTION_LMS
+#define NETBUILDER_WITH_CONSTRUCTION_LMS 1
+#else
+#define NETBUILDER_WITH_CONSTRUCTION_LMS 0
+#endif
+#else
+#define NETBUILDER_WITH_CONSTRUCTION_SOBOL 1
+#define NETBUILDER_WITH_CONSTRUCTION_POLYNOMIAL 1
+#define NETBUILDER_WITH_CONSTRUCTION_EXPLICIT 1
+#define NETBUILDER_WITH_CONSTRUCTION_LMS 1
+#endif
+
+#endif
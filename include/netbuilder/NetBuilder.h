@@ -17,8 +17,49 @@
 #ifndef NETBUILDER_H
 #define NETBUILDER_H
 
+#include "netbuilder/Types.h"
+#include "netbuilder/Task/Task.h"
+
+#include <boost/program_options/variables_map.hpp>
+
+#include <memory>
+#include <string>
+
 namespace NetBuilder{
     int main(int argc, const char *argv[]);
+
+    /**
+     * Same as main(), but reports the errors by throwing exceptions instead
+     * of exiting, so that several commands can be run in the same process.
+     */
+    int run(int argc, const char *argv[]);
+
+    /**
+     * Parses the command-line arguments accepted by main(), where \c argv[0]
+     * is the program name.
+     * If \c --help is given, the help message is printed and the other
+     * arguments are not checked.
+     */
+    boost::program_options::variables_map parseOptions(int argc, const char *argv[]);
+
+    /**
+     * Applies the process-wide settings of the options \c opt returned by
+     * parseOptions() (threads, caches, budget, target merit value, shard).
+     * The settings whose option is absent, and those of LatBuilder which
+     * NetBuilder has no option for, are reset to their defaults, so that the
+     * commands run in the same process do not inherit the settings of the
+     * previous ones.
+     */
+    void applySettings(const boost::program_options::variables_map& opt);
+
+    /**
+     * Returns the task described by the options \c opt.
+     * @param opt Options returned by parseOptions().
+     * @param outputFolder Output folder, where the checkpoints of the CBC searches are written (none if empty).
+     * @param interlacingFactor Set to the interlacing factor of the task.
+     * @param outputStyle Set to the output style of the task.
+     */
+    std::unique_ptr<Task::Task> makeTask(const boost::program_options::variables_map& opt, const std::string& outputFolder, unsigned int& interlacingFactor, OutputStyle& outputStyle);
 }
 
 #endif
\ No newline at end of file
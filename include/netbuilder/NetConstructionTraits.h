@@ -27,12 +27,15 @@
 #include "netbuilder/Helpers/RankComputer.h"
 
 #include "latbuilder/GenSeq/GeneratingValues.h"
+#include "latbuilder/PolynomialWord.h"
 #include "latbuilder/SeqCombiner.h"
 #include "latbuilder/UniformUIntDistribution.h"
 #include "latbuilder/LFSR258.h"
 
+#include <cstddef>
 #include <string>
 #include <list>
+#include <ostream>
 #include <tuple>
 #include <string>
 #include <vector>
@@ -55,16 +58,25 @@ namespace NetBuilder {
  *  - \c isSequenceViewable: a bool indicating whether the net can be viewed as a sequence
  *  - \c name: a string naming the specialization 
  *  - \c hasSpecialFirstCoordinate: a bool indicating whether the first coordinate is a special case and can only take one value
+ *  - \c concurrentConstruction: a bool indicating whether the generating matrices of several coordinates can be created concurrently
+ *  - \c uniformRandomGenValues: a bool indicating whether RandomGenValueGenerator draws the generating values uniformly from the
+ *  sequence returned by genValueSpaceCoord(), whose values can then be sampled without replacement through their indices
  * \n the following static functions:
  *  - <CODE> static \c bool \c checkGenValue(const GenValue& genValue) </CODE>: checks whether a generating value is correct
  *  - <CODE> static \c unsigned int \c nRows(const GenValue& genValue) </CODE>: computes the number of rows associated to the size parameter
  *  - <CODE> static \c unsigned int \c nCols(const GenValue& genValue) </CODE>: computes the number of columns associated to the size parameter
  *  - <CODE>static GeneratingMatrix* createGeneratingMatrix(const GenValue& genValue, SizeParameter sizeParameter)</CODE>: 
  * create a generating matrix using the generating value and the size parameter.
+ *  - <CODE>static void fillGeneratingMatrix(const GenValue& genValue, SizeParameter sizeParameter, GeneratingMatrix& buffer)</CODE>: 
+ * writes the same generating matrix in the caller-owned matrix \c buffer, without allocating memory when \c buffer already has the right size, 
+ * so that a buffer can be reused for many generating values.
  *  - <CODE>static GenValueSpaceCoordSeq genValueSpaceCoord(Dimension coord, const SizeParameter& sizeParameter)</CODE>: returns the sequence of all the possible generating values
  *  for coordinate \c coord.
  *  - <CODE> static GenValueSpaceSeq genValueSpace(Dimension dimension , const SizeParameter& sizeParameter) </CODE>: returns the sequence of all the possible combinations
  *  of generating values for a net in dimension \c dimension.
+ *  - <CODE> static void format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals,
+ *  const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor) </CODE>: writes the part of the description of a net
+ *  specific to the construction method to \c os.
  * \n and the following class template:
  *  - <CODE> template<EmbeddingType ET, typename RAND = LatBuilder::LFSR258> class RandomGenValueGenerator </CODE>: a class template where template parameter ET correspond
  *  to the embedding type of the point set and template parameter RAND implements
@@ -88,6 +100,10 @@ struct NetConstructionTraits<NetConstruction::SOBOL>
 
     static constexpr bool hasSpecialFirstCoordinate = true;
 
+    static constexpr bool concurrentConstruction = true;
+
+    static constexpr bool uniformRandomGenValues = true;
+
     static bool checkGenValue(const GenValue& genValue, const SizeParameter& sizeParam);
 
     static unsigned int nRows(const SizeParameter& param);
@@ -96,6 +112,18 @@ struct NetConstructionTraits<NetConstruction::SOBOL>
 
     static GeneratingMatrix* createGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, const Dimension& dimension_j = 1, const unsigned int nRows = 0);
 
+    static void fillGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, GeneratingMatrix& buffer, const Dimension& dimension_j = 1, const unsigned int nRows = 0);
+
+    /**
+     * Sequence of all the possible generating values for a coordinate, that is, of the direction numbers
+     * \f$(m_1, \dots, m_d)\f$ where \f$d\f$ is the degree of the primitive polynomial of the coordinate and
+     * \f$m_k\f$ is an odd integer smaller than \f$2^k\f$.
+     * The sequence is not materialized: the generating value of index \f$i\f$ is decoded from the digits of
+     * \f$i\f$ in the mixed radix \f$(2^0, 2^1, \dots, 2^{d-1})\f$, the last direction number varying fastest,
+     * so that the values can be accessed randomly, or by chunks, in constant memory.
+     * When the number of values exceeds the range of \c size_t, only the values whose index fits in \c size_t
+     * are addressable, and size() returns the largest \c size_t value.
+     */
     class GenValueSpaceCoordSeq
     {
         public:
@@ -108,7 +136,7 @@ struct NetConstructionTraits<NetConstruction::SOBOL>
             class const_iterator:
             public boost::iterators::iterator_facade<const_iterator,
             const GenValue,
-            boost::iterators::forward_traversal_tag>
+            boost::iterators::random_access_traversal_tag>
             {
                 public:
                     struct end_tag {};
@@ -117,6 +145,11 @@ struct NetConstructionTraits<NetConstruction::SOBOL>
 
                     const_iterator(const GenValueSpaceCoordSeq& seq, end_tag);
 
+                    /**
+                     * Returns the index of the generating value in the sequence.
+                     */
+                    size_t index() const;
+
                 private:
                     friend class boost::iterators::iterator_core_access;
 
@@ -126,15 +159,25 @@ struct NetConstructionTraits<NetConstruction::SOBOL>
 
                     void increment();
 
-                    Dimension m_coord;
+                    void decrement();
+
+                    void advance(std::ptrdiff_t n);
+
+                    std::ptrdiff_t distance_to(const const_iterator& other) const;
 
-                    LatBuilder::SeqCombiner<std::vector<uInteger>,LatBuilder::CartesianProduct>::const_iterator m_underlyingIterator;
+                    void update();
+
+                    unsigned int m_degree;
+
+                    size_t m_size;
+
+                    size_t m_index;
 
                     value_type m_value;
 
             };
 
-            const_iterator begin() const;;
+            const_iterator begin() const;
 
             const_iterator end() const;
 
@@ -142,13 +185,21 @@ struct NetConstructionTraits<NetConstruction::SOBOL>
 
             size_t size() const;
 
-            const LatBuilder::SeqCombiner<std::vector<uInteger>,LatBuilder::CartesianProduct>& underlyingSeq() const;
+            /**
+             * Returns the generating value of index \c i.
+             */
+            value_type operator[](size_t i) const;
 
         private:
             Dimension m_coord;
-            LatBuilder::SeqCombiner<std::vector<uInteger>,LatBuilder::CartesianProduct> m_underlyingSeq;
-
-            static std::vector<std::vector<uInteger>> underlyingSeqs(Dimension coord);
+            unsigned int m_degree;
+            size_t m_size;
+
+            /**
+             * Decodes the direction numbers of index \c index for a primitive polynomial of degree \c degree into
+             * \c dirNums, which must have \c degree elements.
+             */
+            static void decode(unsigned int degree, size_t index, std::vector<uInteger>& dirNums);
     };
 
     typedef LatBuilder::SeqCombiner<GenValueSpaceCoordSeq, LatBuilder::CartesianProduct> GenValueSpaceSeq;
@@ -195,7 +246,7 @@ struct NetConstructionTraits<NetConstruction::SOBOL>
             LatBuilder::UniformUIntDistribution<unsigned long, RAND> m_unif;
     };
 
-    static std::string format(const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor);
+    static void format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor);
 
     typedef std::pair<unsigned int,uInteger> PrimitivePolynomial; 
 
@@ -221,6 +272,10 @@ struct NetConstructionTraits<NetConstruction::POLYNOMIAL>
 
     static constexpr bool hasSpecialFirstCoordinate = true;
 
+    static constexpr bool concurrentConstruction = true; // the matrices only read the NTL polynomials, the arithmetic is done on word contexts
+
+    static constexpr bool uniformRandomGenValues = true;
+
     static bool checkGenValue(const GenValue& genValue, const SizeParameter& sizeParam);
 
     static unsigned int nRows(const SizeParameter& param);
@@ -230,6 +285,15 @@ struct NetConstructionTraits<NetConstruction::POLYNOMIAL>
     // TODO: add comment about the nRows parameter.
     static GeneratingMatrix* createGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, const Dimension& dimension_j = 1, const unsigned int nRows = 0);
 
+    static void fillGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, GeneratingMatrix& buffer, const Dimension& dimension_j = 1, const unsigned int nRows = 0);
+
+    /**
+     * Same as the other overload, with the arithmetic context \c context of the size parameter, which is built
+     * once and can be passed to concurrent workers. The overload taking the size parameter uses the context
+     * cached by the calling thread (see LatBuilder::PolynomialWordModulus::cached()).
+     */
+    static void fillGeneratingMatrix(const GenValue& genValue, const LatBuilder::PolynomialWordModulus& context, GeneratingMatrix& buffer, const unsigned int nRows = 0);
+
     static GenValueSpaceCoordSeq genValueSpaceCoord(Dimension coord, const SizeParameter& sizeParameter);
 
     static GenValueSpaceSeq genValueSpace(Dimension dimension , const SizeParameter& sizeParameter);
@@ -263,7 +327,7 @@ struct NetConstructionTraits<NetConstruction::POLYNOMIAL>
             LatBuilder::UniformUIntDistribution<size_t, RAND> m_unif;
     };
 
-    static std::string format(const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle , unsigned int interlacingFactor);
+    static void format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor);
 };
 
 template<>
@@ -272,8 +336,92 @@ struct NetConstructionTraits<NetConstruction::EXPLICIT>
     typedef GeneratingMatrix GenValue ;
 
     typedef std::pair<unsigned int, unsigned int> SizeParameter;
-    
-    typedef std::vector<GenValue> GenValueSpaceCoordSeq;
+
+    /**
+     * Sequence of all the generating matrices of a given size, in the order of the binary reflected Gray code:
+     * the bits of the matrix of index \f$i\f$, read row after row, are those of \f$i \oplus \lfloor i/2 \rfloor\f$,
+     * so that two consecutive matrices differ by a single bit.
+     * The sequence is not materialized: an iterator flips one bit of its matrix at each increment, and the
+     * matrix of any index can be decoded directly, so that the sequence can be explored by chunks in constant memory.
+     */
+    class GenValueSpaceCoordSeq
+    {
+        public:
+
+            typedef GenValue value_type;
+            typedef size_t size_type;
+
+            /**
+             * Constructor.
+             * @param sizeParameter Size of the matrices.
+             * @throws std::logic_error If the number of matrices exceeds the range of \c size_t.
+             */
+            GenValueSpaceCoordSeq(const SizeParameter& sizeParameter);
+
+            class const_iterator:
+            public boost::iterators::iterator_facade<const_iterator,
+            const GenValue,
+            boost::iterators::random_access_traversal_tag>
+            {
+                public:
+                    struct end_tag {};
+
+                    explicit const_iterator(const GenValueSpaceCoordSeq& seq);
+
+                    const_iterator(const GenValueSpaceCoordSeq& seq, end_tag);
+
+                    /**
+                     * Returns the index of the matrix in the sequence.
+                     */
+                    size_t index() const;
+
+                private:
+                    friend class boost::iterators::iterator_core_access;
+
+                    bool equal(const const_iterator& other) const;
+
+                    const value_type& dereference() const;
+
+                    void increment();
+
+                    void decrement();
+
+                    void advance(std::ptrdiff_t n);
+
+                    std::ptrdiff_t distance_to(const const_iterator& other) const;
+
+                    void update();
+
+                    size_t m_size;
+
+                    size_t m_index;
+
+                    value_type m_value;
+            };
+
+            const_iterator begin() const;
+
+            const_iterator end() const;
+
+            size_t size() const;
+
+            /**
+             * Returns the matrix of index \c i.
+             */
+            value_type operator[](size_t i) const;
+
+        private:
+            unsigned int m_nRows;
+            unsigned int m_nCols;
+            size_t m_size;
+
+            /**
+             * Sets the bits of \c matrix to those of the Gray code of \c index.
+             */
+            static void decode(size_t index, GeneratingMatrix& matrix);
+    };
+
+    typedef LatBuilder::SeqCombiner<GenValueSpaceCoordSeq, LatBuilder::CartesianProduct> GenValueSpaceSeq;
 
     static constexpr bool isSequenceViewable = true;
 
@@ -281,6 +429,10 @@ struct NetConstructionTraits<NetConstruction::EXPLICIT>
 
     static constexpr bool hasSpecialFirstCoordinate = false;
 
+    static constexpr bool concurrentConstruction = true;
+
+    static constexpr bool uniformRandomGenValues = false;
+
     static bool checkGenValue(const GenValue& genValue, const SizeParameter& sizeParam);
 
     static unsigned int nRows(const SizeParameter& param);
@@ -289,9 +441,11 @@ struct NetConstructionTraits<NetConstruction::EXPLICIT>
 
     static GeneratingMatrix* createGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, const Dimension& dimension_j = 1, const unsigned int nRows = 0);
 
+    static void fillGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, GeneratingMatrix& buffer, const Dimension& dimension_j = 1, const unsigned int nRows = 0);
+
     static GenValueSpaceCoordSeq genValueSpaceCoord(Dimension coord, const SizeParameter& sizeParameter);
 
-    static std::vector<GenValueSpaceCoordSeq> genValueSpace(Dimension dimension , const SizeParameter& sizeParameter);
+    static GenValueSpaceSeq genValueSpace(Dimension dimension , const SizeParameter& sizeParameter);
 
     template<EmbeddingType  ET, typename RAND = LatBuilder::LFSR258>
     class RandomGenValueGenerator;
@@ -347,11 +501,13 @@ struct NetConstructionTraits<NetConstruction::EXPLICIT>
             
             GenValue operator()(Dimension dimension)
             {
+                std::vector<typename RAND::result_type> words(m_sizeParameter.first);
+                m_randomGen.fill(words.data(), words.size());
                 std::vector<uInteger> init;
                 init.reserve(m_sizeParameter.first);
                 for (unsigned int i = 0; i < m_sizeParameter.first; ++i)
                 {
-                    uInteger nb = m_randomGen();
+                    uInteger nb = words[i];
                     init.push_back( (1 << i) + (nb - (nb % (1 << (i + 1)))));
                 }
                 return GeneratingMatrix(m_sizeParameter.first, m_sizeParameter.second, std::move(init));
@@ -363,7 +519,7 @@ struct NetConstructionTraits<NetConstruction::EXPLICIT>
             LatBuilder::UniformUIntDistribution<unsigned long, RAND> m_unif;
     };
 
-    static std::string format(const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor);
+    static void format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor);
 };
 
 template<>
@@ -381,6 +537,10 @@ struct NetConstructionTraits<NetConstruction::LMS>
 
     static constexpr bool hasSpecialFirstCoordinate = false;
 
+    static constexpr bool concurrentConstruction = true;
+
+    static constexpr bool uniformRandomGenValues = false;
+
     static bool checkGenValue(const GenValue& genValue, const SizeParameter& sizeParam);
 
     static unsigned int nRows(const SizeParameter& param);
@@ -389,6 +549,8 @@ struct NetConstructionTraits<NetConstruction::LMS>
 
     static GeneratingMatrix* createGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, const Dimension& dimension_j = 1, const unsigned int nRows = 0);
 
+    static void fillGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, GeneratingMatrix& buffer, const Dimension& dimension_j = 1, const unsigned int nRows = 0);
+
     static GenValueSpaceCoordSeq genValueSpaceCoord(Dimension coord, const SizeParameter& sizeParameter);
 
     static std::vector<GenValueSpaceCoordSeq> genValueSpace(Dimension dimension , const SizeParameter& sizeParameter);
@@ -434,7 +596,7 @@ struct NetConstructionTraits<NetConstruction::LMS>
             RAND m_randomGen;
     };
 
-    static std::string format(const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor);
+    static void format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor);
 };
 
 
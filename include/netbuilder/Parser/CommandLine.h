@@ -44,6 +44,7 @@ struct CommandLine {
    std::string s_size;
    std::string s_dimension;
    std::string s_figure;
+   std::vector<std::string> s_additionalFigures; // evaluated on the same net as s_figure, by the evaluation task only
    std::vector<std::string> s_weights;
    std::string s_figureCombiner;
    std::string s_combiner;
@@ -55,8 +56,21 @@ struct CommandLine {
    std::unique_ptr<LevelCombiner::LevelCombiner> m_combiner;
    Dimension m_dimension;
    std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
+   std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> m_additionalFigures;
    int m_verbose;
    unsigned int m_interlacingFactor;
+   unsigned int m_nThreads = 1;
+   std::string m_checkpointFile; // written by CBC explorations after each coordinate, if not empty
+   bool m_resume = false; // resume CBC explorations from m_checkpointFile
+   std::string m_stateFile; // written by CBC explorations at the end of the search, if not empty
+   std::string m_resumeStateFile; // state file from which CBC explorations extend the net, if not empty
+   std::vector<std::string> m_baseGenValues; // formatted generating values of the net extended by CBC explorations, if not empty
+   bool m_progressiveLevels = false; // stop the computation of the multilevel t-values as soon as the evaluation is aborted
+   bool m_skipEquivalentNets = false; // skip the candidates of exhaustive and random explorations equivalent to a net evaluated before
+   Dimension m_tValueProfileOrder = 0; // largest order of the projections whose t-values the evaluation task writes, or 0
+   std::string m_tValueProfileFile; // file to which the evaluation task writes the t-values of the projections
+   std::string m_tValueProfileBinaryFile; // binary file to which the evaluation task writes the t-values of the projections
+   std::string m_tValueTableFile; // binary t-value profile of the net read by the evaluation task, or empty
 
    std::unique_ptr<Task::Task> parse();
 };
@@ -24,22 +24,31 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/lexical_cast.hpp>
 #include <fstream>
+#include <type_traits>
 
 #include "netbuilder/Types.h"
+#include "netbuilder/BinaryInput.h"
 #include "netbuilder/Parser/NetDescriptionParser.h"
 
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
 
 #include "netbuilder/Task/Task.h"
 #include "netbuilder/Task/CBCSearch.h"
+#include "netbuilder/Task/CBCCheckpoint.h"
 #include "netbuilder/Task/Eval.h"
 #include "netbuilder/Task/ExhaustiveSearch.h"
 #include "netbuilder/Task/RandomSearch.h"
+#include "netbuilder/Task/AdaptiveCBCExplorer.h"
+#include "netbuilder/Task/BatchEval.h"
+#include "netbuilder/Task/BeamCBCSearch.h"
 #include "netbuilder/Task/FullCBCExplorer.h"
 #include "netbuilder/Task/MixedCBCExplorer.h"
+#include "netbuilder/Task/PolynomialFastCBC.h"
 #include "netbuilder/Task/RandomCBCExplorer.h"
 #include "netbuilder/NetConstructionTraits.h"
 
+#include "latbuilder/Shard.h"
+
 
 namespace NetBuilder
 {
@@ -76,8 +85,29 @@ struct ExplorationMethodParser
 
         unsigned int r = 0;
 
+        if ((commandLine.m_resume || !commandLine.m_resumeStateFile.empty() || !commandLine.m_baseGenValues.empty()) && name != "full-CBC" && name != "random-CBC" && name != "mixed-CBC" && name != "adaptive-CBC")
+        {
+            throw BadExplorationMethod("only CBC explorations can be resumed from a checkpoint or a state file, or extend a base net");
+        }
+
+        if (!commandLine.m_additionalFigures.empty() && name != "evaluation")
+        {
+            throw BadExplorationMethod("only the evaluation task accepts several figures of merit");
+        }
+
+        if (!commandLine.m_tValueTableFile.empty() && name != "evaluation")
+        {
+            throw BadExplorationMethod("only the evaluation task reads the t-values of the projections");
+        }
+
+        if (commandLine.m_tValueProfileOrder > 0 && name != "evaluation")
+        {
+            throw BadExplorationMethod("only the evaluation task writes the t-values of the projections");
+        }
+
         if (name == "evaluation"){
             std::string netDescritionString;
+            std::vector<typename NetConstructionTraits<NC>::GenValue> genValues;
             if (explorationDescriptionStrings.size() < 2 || explorationDescriptionStrings.size() > 3)
             {
                 throw BadExplorationMethod("net description is not correctly specified; see --help");
@@ -85,6 +115,10 @@ struct ExplorationMethodParser
             else if (explorationDescriptionStrings.size() == 2){
                 netDescritionString = explorationDescriptionStrings[1];
             }
+            else if (BinaryInput::isBinary(explorationDescriptionStrings[2])){
+                // the matrices are read from the mapped file, without parsing
+                genValues = binaryGenValues(commandLine, explorationDescriptionStrings[2], std::integral_constant<bool, NC == NetConstruction::EXPLICIT>());
+            }
             else if (explorationDescriptionStrings.size() == 3){
                 std::ifstream t(explorationDescriptionStrings[2]);
                 std::stringstream buffer;
@@ -106,29 +140,70 @@ struct ExplorationMethodParser
                 boost::replace_all(netDescritionString, " ", ",");
             }
 
-            auto genValues = NetDescriptionParser<NC,ET>::parse(commandLine, netDescritionString);
+            if (genValues.empty()){
+                genValues = NetDescriptionParser<NC,ET>::parse(commandLine, netDescritionString);
+            }
             auto net = std::make_unique<DigitalNet<NC>>(commandLine.m_dimension, commandLine.m_sizeParameter, std::move(genValues));
-            return std::make_unique<Task::Eval>(std::move(net), std::move(commandLine.m_figure), commandLine.m_verbose);
+            std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> figures;
+            figures.push_back(std::move(commandLine.m_figure));
+            for (auto& figure : commandLine.m_additionalFigures)
+            {
+                figures.push_back(std::move(figure));
+            }
+            auto eval = std::make_unique<Task::Eval>(std::move(net), std::move(figures), commandLine.m_verbose);
+            eval->setTValueProfile(commandLine.m_tValueProfileOrder, commandLine.m_tValueProfileFile, commandLine.m_tValueProfileBinaryFile);
+            eval->setTValueTable(commandLine.m_tValueTableFile);
+            return eval;
+        }
+        else if (name == "evaluation-batch"){
+            if (explorationDescriptionStrings.size() < 2 || explorationDescriptionStrings.size() > 3)
+            {
+                throw BadExplorationMethod("file of net descriptions is not correctly specified; see --help");
+            }
+            // the nets are parsed while the task runs, with the dimension and the size parameter of the command line
+            auto netCommandLine = std::make_shared<Parser::CommandLine<NC, ET>>();
+            netCommandLine->m_dimension = commandLine.m_dimension;
+            netCommandLine->m_sizeParameter = commandLine.m_sizeParameter;
+            auto parser = [netCommandLine](const std::string& description) -> std::unique_ptr<AbstractDigitalNet>
+            {
+                auto genValues = NetDescriptionParser<NC,ET>::parse(*netCommandLine, description);
+                return std::make_unique<DigitalNet<NC>>(netCommandLine->m_dimension, netCommandLine->m_sizeParameter, std::move(genValues));
+            };
+            return std::make_unique<Task::BatchEval>(explorationDescriptionStrings[1],
+                                                     explorationDescriptionStrings.size() == 3 ? explorationDescriptionStrings[2] : std::string(),
+                                                     std::move(parser),
+                                                     std::move(commandLine.m_figure),
+                                                     commandLine.m_verbose,
+                                                     commandLine.m_nThreads);
         }
-        else if (name == "exhaustive"){
-            return std::make_unique<Task::ExhaustiveSearch<NC, ET>>(commandLine.m_dimension,
+        else if (name == "exhaustive" || name == "exhaustive-DFS"){
+            auto search = std::make_unique<Task::ExhaustiveSearch<NC, ET>>(commandLine.m_dimension,
                                                         commandLine.m_sizeParameter,
                                                         std::move(commandLine.m_figure),
-                                                        commandLine.m_verbose);
+                                                        commandLine.m_verbose,
+                                                        false,
+                                                        commandLine.m_nThreads);
+            search->setSkipEquivalentNets(commandLine.m_skipEquivalentNets);
+            search->setDepthFirst(name == "exhaustive-DFS");
+            return search;
         }
-        else if (name == "random" || name == "random-CBC" || name == "mixed-CBC"){
+        else if (name == "random" || name == "random-CBC" || name == "mixed-CBC" || name == "adaptive-CBC"){
             if (explorationDescriptionStrings.size() < 2){
                 throw BadExplorationMethod("nb of random samples required; see --help");
             }
             r = boost::lexical_cast<unsigned int>(explorationDescriptionStrings[1]);
         }
         if (name == "random")
-            return std::make_unique<Task::RandomSearch<NC, ET>>(commandLine.m_dimension,
+        {
+            auto search = std::make_unique<Task::RandomSearch<NC, ET>>(commandLine.m_dimension,
                                                     commandLine.m_sizeParameter,
                                                     std::move(commandLine.m_figure),
                                                     r,
                                                     commandLine.m_verbose,
                                                     true);
+            search->setSkipEquivalentNets(commandLine.m_skipEquivalentNets);
+            return search;
+        }
 
 
         std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure;
@@ -145,12 +220,7 @@ struct ExplorationMethodParser
         }
             
         if (name == "random-CBC"){
-            return std::make_unique<Task::CBCSearch<NC, ET, Task::RandomCBCExplorer>>(commandLine.m_dimension, 
-                                                            commandLine.m_sizeParameter,
-                                                            std::move(figure),
-                                                            std::make_unique<Task::RandomCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter, r),
-                                                            commandLine.m_verbose,
-                                                            true);
+            return cbcSearch(commandLine, std::move(figure), std::make_unique<Task::RandomCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter, r));
         }
 
         if (name == "mixed-CBC"){
@@ -159,20 +229,42 @@ struct ExplorationMethodParser
             }
             unsigned int nbFullCoordinates = boost::lexical_cast<unsigned int>(explorationDescriptionStrings[2]);
 
-            return std::make_unique<Task::CBCSearch<NC, ET, Task::MixedCBCExplorer>>(commandLine.m_dimension, 
-                                                            commandLine.m_sizeParameter,
-                                                            std::move(figure),
-                                                            std::make_unique<Task::MixedCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter, nbFullCoordinates, r), 
-                                                            commandLine.m_verbose,
-                                                            true);
+            return cbcSearch(commandLine, std::move(figure), std::make_unique<Task::MixedCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter, nbFullCoordinates, r));
+        }
+        else if (name == "adaptive-CBC"){
+            if (explorationDescriptionStrings.size() < 4 || explorationDescriptionStrings.size() > 5){
+                throw BadExplorationMethod("batch size and tolerance required; see --help");
+            }
+            unsigned int batchSize = boost::lexical_cast<unsigned int>(explorationDescriptionStrings[2]);
+            Real tolerance = boost::lexical_cast<Real>(explorationDescriptionStrings[3]);
+            unsigned int window = explorationDescriptionStrings.size() == 5 ? boost::lexical_cast<unsigned int>(explorationDescriptionStrings[4]) : 2;
+            if (batchSize == 0 || window == 0 || !(tolerance >= 0)){
+                throw BadExplorationMethod("the batch size and the window must be positive and the tolerance non-negative; see --help");
+            }
+
+            return cbcSearch(commandLine, std::move(figure), std::make_unique<Task::AdaptiveCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter, r, batchSize, tolerance, window));
+        }
+        else if (name == "beam-CBC"){
+            if (explorationDescriptionStrings.size() < 2 || explorationDescriptionStrings.size() > 3){
+                throw BadExplorationMethod("width of the beam required; see --help");
+            }
+            unsigned int width = boost::lexical_cast<unsigned int>(explorationDescriptionStrings[1]);
+            if (width == 0){
+                throw BadExplorationMethod("the width of the beam must be positive; see --help");
+            }
+            if (explorationDescriptionStrings.size() == 3){
+                r = boost::lexical_cast<unsigned int>(explorationDescriptionStrings[2]);
+                return std::make_unique<Task::BeamCBCSearch<NC, ET, Task::RandomCBCExplorer>>(commandLine.m_dimension, commandLine.m_sizeParameter, std::move(figure),
+                    std::make_unique<Task::RandomCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter, r), width, commandLine.m_verbose, true, commandLine.m_nThreads);
+            }
+            return std::make_unique<Task::BeamCBCSearch<NC, ET, Task::FullCBCExplorer>>(commandLine.m_dimension, commandLine.m_sizeParameter, std::move(figure),
+                std::make_unique<Task::FullCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter), width, commandLine.m_verbose, true, commandLine.m_nThreads);
         }
         else if (name == "full-CBC"){
-            return std::make_unique<Task::CBCSearch<NC, ET,  Task::FullCBCExplorer>>(commandLine.m_dimension, 
-                                                                commandLine.m_sizeParameter,
-                                                                std::move(figure),
-                                                                std::make_unique<Task::FullCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter),
-                                                                commandLine.m_verbose,
-                                                                true);
+            return cbcSearch(commandLine, std::move(figure), std::make_unique<Task::FullCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter));
+        }
+        else if (name == "fast-CBC"){
+            return fastCBCSearch(commandLine, std::move(figure), std::integral_constant<bool, NC == NetConstruction::POLYNOMIAL && ET == EmbeddingType::UNILEVEL>());
         }
         else{
             throw BadExplorationMethod(name + " is not a valid exploration method; see --help");
@@ -180,6 +272,126 @@ struct ExplorationMethodParser
         return result_type();
     }
 
+  private:
+    /**
+     * Reads the explicit generating matrices of the binary net file \c fileName (see BinaryInput), which must
+     * match the dimension and the size of the command line.
+     */
+    static std::vector<GeneratingMatrix> binaryGenValues(Parser::CommandLine<NC, ET>& commandLine, const std::string& fileName, std::true_type)
+    {
+        std::unique_ptr<BinaryInput> input;
+        try
+        {
+            input = std::make_unique<BinaryInput>(fileName);
+        }
+        catch (std::runtime_error& e)
+        {
+            throw BadExplorationMethod(e.what());
+        }
+        if (input->dimension() != commandLine.m_dimension)
+        {
+            throw BadExplorationMethod("incompatible dimension and number of matrices in " + fileName);
+        }
+        if (input->numRows() != NetConstructionTraits<NC>::nRows(commandLine.m_sizeParameter) ||
+            input->numColumns() != NetConstructionTraits<NC>::nCols(commandLine.m_sizeParameter))
+        {
+            throw BadExplorationMethod("bad generating matrix size in " + fileName);
+        }
+        return input->generatingMatrices();
+    }
+
+    static std::vector<typename NetConstructionTraits<NC>::GenValue> binaryGenValues(Parser::CommandLine<NC, ET>& commandLine, const std::string& fileName, std::false_type)
+    {
+        throw BadExplorationMethod("binary net files can only be evaluated with the explicit construction");
+    }
+
+    /**
+     * Creates a fast CBC search of polynomial lattice rules, which computes the merit values of all the candidates
+     * of a coordinate at once with the fast CBC of LatBuilder.
+     */
+    static result_type fastCBCSearch(Parser::CommandLine<NC, ET>& commandLine, std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure, std::true_type)
+    {
+        auto search = Task::makePolynomialFastCBC(commandLine.m_dimension, commandLine.m_sizeParameter, *figure, commandLine.m_verbose);
+        if (!search)
+        {
+            throw BadExplorationMethod("the fast CBC exploration requires a coordinate-uniform figure of merit with the CU:R or CU:P<alpha> kernel");
+        }
+        return search;
+    }
+
+    static result_type fastCBCSearch(Parser::CommandLine<NC, ET>& commandLine, std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure, std::false_type)
+    {
+        throw BadExplorationMethod("the fast CBC exploration is only available for unilevel polynomial nets");
+    }
+
+    /**
+     * Creates a CBC search with the given explorer, which writes its checkpoints to the checkpoint file of
+     * the command line. If the command line asks for resuming, the search starts from the net read from the checkpoint file.
+     * If the command line has a state file to resume from, the search extends the net of that file and restores its evaluators from it.
+     * If the command line has the generating values of a base net, the search extends that net.
+     */
+    template <template <NetConstruction, EmbeddingType> class EXPLORER>
+    static result_type cbcSearch(Parser::CommandLine<NC, ET>& commandLine, std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure, std::unique_ptr<EXPLORER<NC, ET>> explorer)
+    {
+        typedef Task::CBCSearch<NC, ET, EXPLORER> SearchType;
+        std::unique_ptr<SearchType> search;
+        const Dimension baseDimension = commandLine.m_baseGenValues.size();
+        if (LatBuilder::Shard::active() && baseDimension + 1 != commandLine.m_dimension)
+        {
+            throw BadExplorationMethod("a CBC exploration split into shards must add a single coordinate to its base net");
+        }
+        if (!commandLine.m_baseGenValues.empty())
+        {
+            auto baseNet = Task::parseCBCNet<NC>(commandLine.m_baseGenValues, commandLine.m_sizeParameter, "the base net");
+            if (baseNet->dimension() > commandLine.m_dimension)
+            {
+                throw BadExplorationMethod("the base net has more coordinates than the searched net");
+            }
+            search = std::make_unique<SearchType>(commandLine.m_dimension,
+                                                  std::move(baseNet),
+                                                  std::move(figure),
+                                                  std::move(explorer),
+                                                  commandLine.m_verbose,
+                                                  true,
+                                                  commandLine.m_nThreads);
+        }
+        else if (commandLine.m_resume || !commandLine.m_resumeStateFile.empty())
+        {
+            if (commandLine.m_resume && !commandLine.m_resumeStateFile.empty())
+            {
+                throw BadExplorationMethod("a CBC exploration cannot be resumed from both a checkpoint and a state file");
+            }
+            const std::string& fileName = commandLine.m_resume ? commandLine.m_checkpointFile : commandLine.m_resumeStateFile;
+            auto baseNet = commandLine.m_resume ?
+                Task::readCBCCheckpoint<NC>(fileName, commandLine.m_sizeParameter) :
+                Task::readCBCStateNet<NC>(fileName, commandLine.m_sizeParameter);
+            if (baseNet->dimension() > commandLine.m_dimension)
+            {
+                throw BadExplorationMethod("the file " + fileName + " has more coordinates than the searched net");
+            }
+            search = std::make_unique<SearchType>(commandLine.m_dimension,
+                                                  std::move(baseNet),
+                                                  std::move(figure),
+                                                  std::move(explorer),
+                                                  commandLine.m_verbose,
+                                                  true,
+                                                  commandLine.m_nThreads);
+        }
+        else
+        {
+            search = std::make_unique<SearchType>(commandLine.m_dimension,
+                                                  commandLine.m_sizeParameter,
+                                                  std::move(figure),
+                                                  std::move(explorer),
+                                                  commandLine.m_verbose,
+                                                  true,
+                                                  commandLine.m_nThreads);
+        }
+        search->setCheckpointFile(commandLine.m_checkpointFile);
+        search->setStateFile(commandLine.m_stateFile);
+        search->setResumeStateFile(commandLine.m_resumeStateFile);
+        return std::move(search);
+    }
 
 };
 }
@@ -18,7 +18,6 @@
 #define NETBUILDER__PARSER__FIGURE_PARSER_H
 
 #include <limits>
-#include <fstream>
 
 #include <boost/algorithm/string/erase.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -73,6 +72,17 @@ struct FigureParser
 {
     typedef std::unique_ptr<FigureOfMerit::FigureOfMerit> result_type;
 
+    // the t-values of unilevel nets have a single level
+    template <typename METHOD>
+    static void setProgressive(FigureOfMerit::TValueProjMerit<EmbeddingType::UNILEVEL, METHOD>&, bool)
+    {}
+
+    template <typename METHOD>
+    static void setProgressive(FigureOfMerit::TValueProjMerit<EmbeddingType::MULTILEVEL, METHOD>& projDepMerit, bool progressive)
+    {
+        projDepMerit.setProgressive(progressive);
+    }
+
     static result_type parse(Parser::CommandLine<NC, ET>& commandLine)
     {
 
@@ -84,28 +94,27 @@ struct FigureParser
             weightsPowerScale = commandLine.m_normType / commandLine.m_weightPower;
         }
 
-        std::vector<std::string> weightsStrings;
+        const std::vector<std::string>& weightsStrings = commandLine.s_weights;
         std::unique_ptr<LatticeTester::Weights> weights;
 
-        if (commandLine.s_weights.size() == 1 && commandLine.s_weights.front().compare(0, 4, "file") == 0)
-        {
-            std::ifstream t(commandLine.s_weights.front().substr(5));
-            std::stringstream buffer;
-            buffer << t.rdbuf();
-            std::string fileContent = buffer.str();
-            boost::split(weightsStrings, fileContent, boost::is_any_of(" "));
-        }
-        else {
-            weightsStrings = commandLine.s_weights;
-        }
-        
-        if (weightsStrings.size() == 1)
+        const bool fromFile = weightsStrings.size() == 1 &&
+            (weightsStrings.front().compare(0, 5, "file:") == 0 || weightsStrings.front().compare(0, 4, "bin:") == 0);
+        if (weightsStrings.size() == 1 && !fromFile)
         {
             weights = LatBuilder::Parser::Weights::parse(weightsStrings.front(), weightsPowerScale);
         }
         else
         {
-            weights = LatBuilder::Parser::CombinedWeights::parse(weightsStrings, weightsPowerScale);
+            auto combinedWeights = LatBuilder::Parser::CombinedWeights::parse(weightsStrings, weightsPowerScale);
+            if (combinedWeights->list().size() == 1) // a file with a single weights specification
+            {
+                auto weightsList = combinedWeights->giveWeights();
+                weights = std::move(weightsList.front());
+            }
+            else
+            {
+                weights = std::move(combinedWeights);
+            }
         }
 
         std::vector<std::string> figureDescriptionStrings;
@@ -177,8 +186,28 @@ struct FigureParser
         {
             unsigned int maxCard = LatBuilder::WeightsDispatcher::dispatch<ComputeMaxCardFromWeights>(*weights);
             auto projDepMerit = std::make_unique<FigureOfMerit::TValueProjMerit<ET>>(maxCard, std::move(commandLine.m_combiner));
+            setProgressive(*projDepMerit, commandLine.m_progressiveLevels);
             return std::make_unique<FigureOfMerit::WeightedFigureOfMerit<FigureOfMerit::TValueProjMerit<ET>>>(commandLine.m_normType, std::move(weights), std::move(projDepMerit));
         }
+        else if (commandLine.s_figure == "projdep:t-value:schmid")
+        {
+            unsigned int maxCard = LatBuilder::WeightsDispatcher::dispatch<ComputeMaxCardFromWeights>(*weights);
+            auto projDepMerit = std::make_unique<FigureOfMerit::TValueProjMerit<ET, SchmidMethod>>(maxCard, std::move(commandLine.m_combiner));
+            return std::make_unique<FigureOfMerit::WeightedFigureOfMerit<FigureOfMerit::TValueProjMerit<ET, SchmidMethod>>>(commandLine.m_normType, std::move(weights), std::move(projDepMerit));
+        }
+        else if (commandLine.s_figure == "projdep:t-value:dual")
+        {
+            unsigned int maxCard = LatBuilder::WeightsDispatcher::dispatch<ComputeMaxCardFromWeights>(*weights);
+            auto projDepMerit = std::make_unique<FigureOfMerit::TValueProjMerit<ET, DualMethod>>(maxCard, std::move(commandLine.m_combiner));
+            return std::make_unique<FigureOfMerit::WeightedFigureOfMerit<FigureOfMerit::TValueProjMerit<ET, DualMethod>>>(commandLine.m_normType, std::move(weights), std::move(projDepMerit));
+        }
+        else if (commandLine.s_figure == "projdep:t-value:auto")
+        {
+            unsigned int maxCard = LatBuilder::WeightsDispatcher::dispatch<ComputeMaxCardFromWeights>(*weights);
+            auto projDepMerit = std::make_unique<FigureOfMerit::TValueProjMerit<ET, AutoMethod>>(maxCard, std::move(commandLine.m_combiner));
+            setProgressive(*projDepMerit, commandLine.m_progressiveLevels);
+            return std::make_unique<FigureOfMerit::WeightedFigureOfMerit<FigureOfMerit::TValueProjMerit<ET, AutoMethod>>>(commandLine.m_normType, std::move(weights), std::move(projDepMerit));
+        }
         else if (commandLine.s_figure == "projdep:t-value:starDisc")
         {
             unsigned int maxCard = LatBuilder::WeightsDispatcher::dispatch<ComputeMaxCardFromWeights>(*weights);
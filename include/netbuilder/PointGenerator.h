@@ -0,0 +1,141 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file contains the generator of the points of digital nets.
+ */ 
+
+#ifndef NETBUILDER__POINT_GENERATOR_H
+#define NETBUILDER__POINT_GENERATOR_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/DigitalNet.h"
+
+#include "latbuilder/PointGenerator.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace NetBuilder {
+
+/**
+ * Randomizations of the points of a digital net in base 2.
+ * - NONE: the points of the net;
+ * - DIGITAL_SHIFT: a uniform random digital shift, the same for all the points;
+ * - LMS: a random left matrix scramble (a lower-triangular invertible matrix by coordinate applied to the digits)
+ *   followed by a random digital shift;
+ * - NESTED_UNIFORM: an approximation of Owen's nested uniform scrambling, where each digit is flipped by a hash of 
+ *   the previous digits of the coordinate and of a random seed.
+ */ 
+enum class Scrambling { NONE, DIGITAL_SHIFT, LMS, NESTED_UNIFORM };
+
+/**
+ * Generator of the points of a digital net in base 2, possibly interlaced.
+ * 
+ * The digits of the point of index \f$i = \sum_k a_k 2^k\f$ are the product of the generating matrix by the
+ * vector \f$(a_0, a_1, \dots)\f$. With an interlacing factor \f$d\f$, the coordinate \f$j\f$ of the points
+ * interlaces the digits of the coordinates \f$jd, \dots, jd + d - 1\f$ of the net: its \f$(rd + l + 1)\f$-th digit
+ * is the \f$(r+1)\f$-th digit of coordinate \f$jd + l\f$.
+ * 
+ * The columns of the matrices are precomputed as machine words holding the first 64 digits of the coordinates. 
+ * As consecutive indices \f$i-1\f$ and \f$i\f$ differ by the bits \f$0, \dots, k\f$ where \f$k\f$ is the
+ * position of the lowest set bit of \f$i\f$, each point is obtained from the previous one with one XOR by coordinate,
+ * as in the Gray code construction of Sobol' points, while the points are still produced in their natural order.
+ * 
+ * The points can be randomized (see Scrambling) with 64 digits of precision. The random matrices and shifts of the left
+ * matrix scramble are drawn from the seed and the replicate index, so that the replicates of a randomized point set are
+ * independent streams that can be generated separately or concurrently. As left matrix scrambles and digital shifts act
+ * linearly on the digits, they are applied once to the columns of the matrices; nested uniform scrambling is applied to
+ * each coordinate of the points, block by block.
+ * 
+ * The points of a range of indices are written one after the other (row-major order) into buffers provided by the caller. 
+ * See LatBuilder::generatePoints() and LatBuilder::writePoints() to process the whole point set with the shared thread pool.
+ */ 
+class DigitalNetPointGenerator
+{
+    public:
+
+        /**
+         * Constructor.
+         * @param net Digital net.
+         * @param interlacingFactor Interlacing factor of the net. The dimension of the net must be a multiple of it.
+         */ 
+        DigitalNetPointGenerator(const AbstractDigitalNet& net, unsigned int interlacingFactor = 1);
+
+        /**
+         * Constructor of a randomized point generator.
+         * @param net Digital net.
+         * @param interlacingFactor Interlacing factor of the net. The dimension of the net must be a multiple of it.
+         * @param scrambling Randomization of the points. Left matrix scrambles are applied to the coordinates of the net
+         * before interlacing; nested uniform scrambling requires an interlacing factor of one.
+         * @param seed Seed of the randomization.
+         * @param replicate Index of the independent replicate of the randomization.
+         */ 
+        DigitalNetPointGenerator(const AbstractDigitalNet& net, unsigned int interlacingFactor, Scrambling scrambling, uint64_t seed, unsigned int replicate = 0);
+
+        /**
+         * Returns the number of points.
+         */ 
+        uInteger numPoints() const { return m_numPoints; }
+
+        /**
+         * Returns the number of coordinates of the points (the dimension of the net divided by the interlacing factor).
+         */ 
+        Dimension dimension() const { return m_dimension; }
+
+        /**
+         * Returns the number of columns of the generating matrices.
+         */ 
+        unsigned int numColumns() const { return m_nCols; }
+
+        /**
+         * Returns the XOR of the columns 0 to \f$k\f$ of the interlaced matrix of coordinate \f$j\f$ at index
+         * <code>k * dimension() + j</code>, with the first digit in the most significant bit.
+         */ 
+        const std::vector<uint64_t>& prefixColumns() const { return m_prefixColumns; }
+
+        /**
+         * Writes the coordinates of the points of indices \c first to <code>first + count - 1</code> to \c out,
+         * which must have room for <code>count * dimension()</code> values.
+         */ 
+        void generate(uInteger first, uInteger count, double* out) const;
+
+        /**
+         * Writes the first 32 digits of the coordinates of the points of indices \c first to <code>first + count - 1</code> to \c out,
+         * which must have room for <code>count * dimension()</code> values.
+         */ 
+        void generate(uInteger first, uInteger count, uint32_t* out) const;
+
+    private:
+
+        uInteger m_numPoints; // number of points
+        Dimension m_dimension; // number of coordinates of the points
+        unsigned int m_nCols; // number of columns of the generating matrices
+        std::vector<uint64_t> m_prefixColumns; // XOR of the columns 0 to k of coordinate j at index k * m_dimension + j, first digit in the most significant bit
+        std::vector<uint64_t> m_digitalShift; // digital shift of coordinate j, zero without shift
+        std::vector<uint64_t> m_scrambleSeeds; // seed of the nested uniform scrambling of coordinate j, empty without it
+
+        template <typename T, typename CONVERT>
+        void generateImpl(uInteger first, uInteger count, T* out, CONVERT convert) const;
+
+        template <typename T, typename CONVERT>
+        void generateDigits(uInteger first, uInteger count, T* out, CONVERT convert) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,87 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * On-disk cache of the results of the tasks.
+ */
+
+#ifndef NETBUILDER__RESULT_CACHE_H
+#define NETBUILDER__RESULT_CACHE_H
+
+#include "netbuilder/Types.h"
+
+#include <string>
+#include <vector>
+
+namespace NetBuilder {
+
+/**
+ * On-disk cache of the nets and merit values computed by the tasks, so that a task identical to one already executed
+ * is answered without being executed again.
+ *
+ * The entries are identified by a description of the task and its dimension (see Task::ResultCacheTask). The
+ * description excludes the dimension, so that a CBC search can find the entries of the same search for fewer
+ * coordinates and start from their nets. Each entry also holds the key of the task, the complete description
+ * of the task, which must match for the entry to be used.
+ *
+ * The entries are stored in binary files of the cache directory, in the native representation of the machine,
+ * with the generating values of the nets formatted as in the checkpoints (see Task::CheckpointTraits). A file is
+ * written through a temporary file which is then renamed, so that concurrent processes may share the directory.
+ */
+class ResultCache
+{
+public:
+    /// Entry of the cache.
+    struct Entry
+    {
+        std::string key; ///< Complete description of the task.
+        std::vector<std::string> genValues; ///< Formatted generating values of the resulting net.
+        std::vector<Real> merits; ///< Merit values of the resulting net, one by figure of merit.
+    };
+
+    /**
+     * Constructor. The directory is created if it does not exist.
+     */
+    explicit ResultCache(std::string directory);
+
+    /**
+     * Returns the directory of the cache.
+     */
+    const std::string& directory() const { return m_directory; }
+
+    /**
+     * Reads to \c entry the entry of the task described by \c description for \c dimension coordinates, and
+     * returns \c false if there is none.
+     */
+    bool read(const std::string& description, Dimension dimension, Entry& entry) const;
+
+    /**
+     * Writes \c entry as the entry of the task described by \c description for \c dimension coordinates.
+     * @throws std::runtime_error if the entry cannot be written.
+     */
+    void write(const std::string& description, Dimension dimension, const Entry& entry) const;
+
+private:
+    std::string m_directory;
+
+    std::string fileName(const std::string& description, Dimension dimension) const;
+};
+
+}
+
+#endif
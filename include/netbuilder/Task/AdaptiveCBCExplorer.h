@@ -0,0 +1,192 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NETBUILDER__TASK__ADAPTIVE_CBC_EXPLORER_H
+#define NETBUILDER__TASK__ADAPTIVE_CBC_EXPLORER_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/NetConstructionTraits.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * Class to explore randomly a search space using the CBC search algorithm, with a number of samples
+ * by coordinate which adapts to the improvement of the best merit value.
+ *
+ * The candidates of each coordinate are drawn in batches of \c batchSize random generating values.
+ * After each batch, the exploration of the coordinate stops if the best merit value improved by less
+ * than \c tolerance, relatively to the current best merit value, over the last \c window batches.
+ * At most \c maxTries candidates are drawn for each coordinate.
+ *
+ * The explorer is informed of the merit values of the candidates through observeMerit(), and available()
+ * gives the number of candidates which can be drawn before the explorer needs their merit values, so
+ * that the parallel searches stop at the same candidate as the serial search (see CBCSearch).
+ */
+template <NetConstruction NC, EmbeddingType ET>
+class AdaptiveCBCExplorer
+{
+    typedef NetConstructionTraits<NC> ConstructionMethod;
+
+    public:
+
+        /** Constructor.
+         * @param dimension Number of coordinates of the explorer.
+         * @param sizeParameter Size parameter of the search space.
+         * @param maxTries Maximal number of random choices of generating values by dimension.
+         * @param batchSize Number of random choices between two tests of the improvement of the best merit.
+         * @param tolerance Relative improvement of the best merit below which the exploration of a coordinate stops.
+         * @param window Number of batches over which the improvement is measured.
+         */
+        AdaptiveCBCExplorer(Dimension dimension, typename ConstructionMethod::SizeParameter sizeParameter, unsigned int maxTries,
+                            unsigned int batchSize, Real tolerance, unsigned int window = 2):
+            m_dimension(dimension),
+            m_currentCoord(0),
+            m_maxTries(maxTries),
+            m_batchSize(batchSize),
+            m_tolerance(tolerance),
+            m_window(window),
+            m_randomGenValueGenerator(std::move(sizeParameter)),
+            m_countTries(0),
+            m_bestMerit(std::numeric_limits<Real>::infinity()),
+            m_converged(false)
+        {
+            if (batchSize == 0 || window == 0)
+            {
+                throw std::invalid_argument("AdaptiveCBCExplorer: the batch size and the window must be positive");
+            }
+            if (!(tolerance >= 0))
+            {
+                throw std::invalid_argument("AdaptiveCBCExplorer: the tolerance must be non-negative");
+            }
+        };
+
+        /**
+         * Returns whether current coordinate is fully explored
+         */
+        bool isOver()
+        {
+            if (m_countTries >= size())
+            {
+                return true;
+            }
+            if (m_countTries > 0 && m_countTries % m_batchSize == 0 && m_countTries / m_batchSize > m_batchBests.size())
+            {
+                m_batchBests.push_back(m_bestMerit); // end of a batch
+                const size_t nBatches = m_batchBests.size();
+                if (nBatches > m_window)
+                {
+                    const Real previous = m_batchBests[nBatches - 1 - m_window];
+                    // no improvement is measured as long as no net was found
+                    m_converged = !std::isinf(m_bestMerit) && previous - m_bestMerit <= m_tolerance * std::abs(m_bestMerit);
+                }
+            }
+            return m_converged;
+        }
+
+        /**
+         * Returns the next generating values of dimension \c dim
+         */
+        typename ConstructionMethod::GenValue nextGenValue()
+        {
+            m_countTries+= 1;
+            return m_randomGenValueGenerator(m_currentCoord);
+        }
+
+        /**
+         * Informs the explorer of the merit values of the candidates drawn since the last call,
+         * possibly through their minimum only.
+         */
+        void observeMerit(Real merit)
+        {
+            m_bestMerit = std::min(m_bestMerit, merit);
+        }
+
+        /**
+         * Returns the number of candidates which can be drawn before the explorer needs their merit values.
+         */
+        size_t available() const
+        {
+            return std::min<size_t>(m_batchSize - m_countTries % m_batchSize, size() - std::min<size_t>(m_countTries, size()));
+        }
+
+        /**
+         * Resets the explorer to the first coordinate.
+         */
+        void reset()
+        {
+           switchToCoordinate(0);
+        }
+
+        /**
+         * Switches the explorer to coordinate \c coord.
+         */
+        void switchToCoordinate(Dimension coord)
+        {
+            m_currentCoord = coord;
+            m_countTries = 0;
+            m_bestMerit = std::numeric_limits<Real>::infinity();
+            m_batchBests.clear();
+            m_converged = false;
+        };
+
+        /**
+         * Returns the maximal number of candidates of the current coordinate.
+         */
+        size_t size() const
+        {
+            if (NetConstructionTraits<NC>::hasSpecialFirstCoordinate && m_currentCoord == 0)
+            {
+                return 1;
+            }
+            return m_maxTries;
+        }
+
+        size_t count() const
+        {
+            return m_countTries;
+        }
+
+        std::string format() const
+        {
+            return "Adaptive Explorer - at most " + std::to_string(m_maxTries) + " samples - batches of " + std::to_string(m_batchSize)
+                + " samples - tolerance " + std::to_string(m_tolerance) + " over " + std::to_string(m_window) + " batches";
+        }
+
+    private:
+        Dimension m_dimension;
+        Dimension m_currentCoord;
+        unsigned int m_maxTries;
+        unsigned int m_batchSize;
+        Real m_tolerance;
+        unsigned int m_window;
+        typename ConstructionMethod:: template RandomGenValueGenerator <ET> m_randomGenValueGenerator;
+        unsigned int m_countTries;
+        Real m_bestMerit; // best merit of the current coordinate
+        std::vector<Real> m_batchBests; // best merit after each batch of the current coordinate
+        bool m_converged;
+
+};
+
+}}
+
+#endif
@@ -0,0 +1,268 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NETBUILDER__TASK__BATCH_EVAL_H
+#define NETBUILDER__TASK__BATCH_EVAL_H
+
+#include "netbuilder/Types.h"
+
+#include "netbuilder/Task/Task.h"
+#include "netbuilder/FigureOfMerit/FigureOfMerit.h"
+
+#include "latbuilder/Distributed.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * Evaluation of many nets read from a file.
+ *
+ * The input file holds one net description by line, in the format of the \c evaluation exploration
+ * method; the empty lines and the lines starting with \c # are ignored. The file is read by chunks,
+ * so that its size is not limited by the memory, and the nets of a chunk are evaluated concurrently
+ * by the workers, each of them reusing its own evaluator for all the nets it evaluates.
+ *
+ * The merit values are written as a CSV table with one row by net, in the order of the input file:
+ * the line number of the net in the input file and its merit value. The result of the task is the
+ * net with the smallest merit value, the first one in case of ties.
+ */
+class BatchEval : public Task
+{
+    public:
+        /// Parser of the net descriptions.
+        typedef std::function<std::unique_ptr<AbstractDigitalNet> (const std::string&)> NetParser;
+
+        /**
+         * Constructor.
+         * @param inputFile File of the net descriptions, or \c - for the standard input.
+         * @param tableFile File to which the CSV table is written, or an empty string for the standard output.
+         * @param parser Parser of the net descriptions.
+         * @param figure Figure of merit.
+         * @param verbose Verbosity level.
+         * @param nThreads Number of threads used to evaluate the nets. If 0, the number of hardware threads is used.
+         */
+        BatchEval(std::string inputFile, std::string tableFile, NetParser parser, std::unique_ptr<FigureOfMerit::FigureOfMerit> figure,
+                  int verbose = 0, unsigned int nThreads = 1):
+            m_inputFile(std::move(inputFile)),
+            m_tableFile(std::move(tableFile)),
+            m_parser(std::move(parser)),
+            m_figure(std::move(figure)),
+            m_verbose(verbose),
+            m_nThreads(LatBuilder::ThreadPool::resolveNumThreads(nThreads)),
+            m_numNets(0),
+            m_merit(std::numeric_limits<Real>::infinity())
+        {};
+
+        BatchEval(BatchEval&&) = default;
+
+        ~BatchEval() = default;
+
+        /**
+         * Returns the best evaluated net.
+         */
+        const AbstractDigitalNet& net() const
+        {
+            if (!m_bestNet)
+            {
+                throw std::logic_error("BatchEval: no net was evaluated");
+            }
+            return *m_bestNet;
+        }
+
+        virtual std::string outputNet(OutputStyle outputStyle, unsigned int interlacingFactor) const override
+        { return net().format(outputStyle, interlacingFactor); }
+
+        virtual const AbstractDigitalNet& resultNet() const override
+        { return net(); }
+
+        /**
+         *  Returns information about the task
+         */
+        virtual std::string format() const override
+        {
+            std::ostringstream stream;
+            stream << "Task: NetBuilder Batch Evaluation" << std::endl;
+            stream << "Nets read from: " << (m_inputFile == "-" ? std::string("standard input") : m_inputFile) << std::endl;
+            stream << "Merit values written to: " << (m_tableFile.empty() ? std::string("standard output") : m_tableFile) << std::endl;
+            if (m_nThreads > 1)
+            {
+                stream << "Number of threads: " << m_nThreads << std::endl;
+            }
+            stream << "Figure of merit: " << m_figure->format() << std::endl;
+            return stream.str();
+        }
+
+        /**
+         * Returns the smallest merit value of the evaluated nets.
+         */
+        virtual Real outputMeritValue() const override
+        { return m_merit; }
+
+        /**
+         * Returns the number of evaluated nets.
+         */
+        unsigned long long numNets() const { return m_numNets; }
+
+        const FigureOfMerit::FigureOfMerit& figureOfMerit() const
+        { return *m_figure; }
+
+        /**
+         * Executes the task. In an MPI job, only the root process writes the table.
+         */
+        virtual void execute() override
+        {
+            std::ifstream file;
+            if (m_inputFile != "-")
+            {
+                file.open(m_inputFile);
+                if (!file)
+                {
+                    throw std::runtime_error("cannot open " + m_inputFile);
+                }
+            }
+            std::istream& input = m_inputFile == "-" ? std::cin : file;
+
+            const bool writes = LatBuilder::Distributed::isRoot();
+            std::ofstream tableFile;
+            if (writes && !m_tableFile.empty())
+            {
+                tableFile.open(m_tableFile);
+                if (!tableFile)
+                {
+                    throw std::runtime_error("cannot open " + m_tableFile);
+                }
+            }
+            std::ostream& table = m_tableFile.empty() ? std::cout : tableFile;
+            table.precision(std::numeric_limits<Real>::max_digits10);
+            if (writes)
+            {
+                table << "line,merit" << std::endl;
+            }
+
+            LatBuilder::ThreadPool& pool = LatBuilder::ThreadPool::shared(m_nThreads);
+            std::vector<std::unique_ptr<FigureOfMerit::FigureOfMeritEvaluator>> evaluators;
+            for(unsigned int worker = 0; worker < pool.size(); ++worker)
+            {
+                evaluators.push_back(m_figure->evaluator()); // each worker reuses its evaluator for all its nets
+            }
+
+            const size_t chunkSize = 64 * pool.size(); // number of nets read at once
+            std::vector<std::string> descriptions;
+            std::vector<unsigned long long> lines;
+            std::vector<std::unique_ptr<AbstractDigitalNet>> nets;
+            std::vector<Real> merits;
+            std::string line;
+            unsigned long long lineNumber = 0;
+            bool endOfFile = false;
+            while (!endOfFile)
+            {
+                descriptions.clear();
+                lines.clear();
+                while (descriptions.size() < chunkSize)
+                {
+                    if (!std::getline(input, line))
+                    {
+                        endOfFile = true;
+                        break;
+                    }
+                    ++lineNumber;
+                    const auto first = line.find_first_not_of(" \t\r");
+                    if (first == std::string::npos || line[first] == '#')
+                    {
+                        continue;
+                    }
+                    descriptions.push_back(line.substr(first));
+                    lines.push_back(lineNumber);
+                }
+
+                nets.clear();
+                for (size_t i = 0; i < descriptions.size(); ++i)
+                {
+                    try
+                    {
+                        nets.push_back(m_parser(descriptions[i]));
+                    }
+                    catch (std::exception& e)
+                    {
+                        throw std::runtime_error("line " + std::to_string(lines[i]) + " of " + m_inputFile + ": " + e.what());
+                    }
+                }
+                merits.resize(nets.size());
+                pool.parallelFor(nets.size(), [&](unsigned int worker, size_t i)
+                {
+                    LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::EVALUATION);
+                    merits[i] = (*evaluators[worker])(*nets[i], m_verbose-3);
+                });
+
+                for (size_t i = 0; i < nets.size(); ++i) // in the order of the input file
+                {
+                    LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::CANDIDATES);
+                    if (writes)
+                    {
+                        table << lines[i] << "," << merits[i] << "\n";
+                    }
+                    if (merits[i] < m_merit || !m_bestNet)
+                    {
+                        m_merit = merits[i];
+                        m_bestNet = std::move(nets[i]);
+                    }
+                }
+                m_numNets += nets.size();
+                if (m_verbose >= 1)
+                {
+                    std::cout << "Nets evaluated: " << m_numNets << std::endl;
+                }
+            }
+            table.flush();
+            if (!m_bestNet)
+            {
+                throw std::runtime_error("no net was evaluated from " + m_inputFile);
+            }
+        }
+
+        virtual void reset() override
+        {
+            m_numNets = 0;
+            m_merit = std::numeric_limits<Real>::infinity();
+            m_bestNet.reset();
+        }
+
+    private:
+        std::string m_inputFile;
+        std::string m_tableFile;
+        NetParser m_parser;
+        std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
+        int m_verbose;
+        unsigned int m_nThreads;
+        unsigned long long m_numNets;
+        Real m_merit;
+        std::unique_ptr<AbstractDigitalNet> m_bestNet;
+};
+
+}}
+
+#endif
@@ -0,0 +1,327 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NETBUILDER__TASK__BEAM_CBC_SEARCH_H
+#define NETBUILDER__TASK__BEAM_CBC_SEARCH_H
+
+#include "netbuilder/Task/Search.h"
+#include "netbuilder/Task/TopKObserver.h"
+
+#include "latbuilder/Profiler.h"
+#include "latbuilder/ProgressFeed.h"
+#include "latbuilder/SharedMinimum.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * Class for beam CBC search tasks.
+ *
+ * Instead of keeping only the best net for each coordinate, the beam search keeps the \c width best
+ * nets, or partial nets, for the coordinates explored so far. For each coordinate, each of these nets
+ * is extended by the generating values given by the explorer, and the \c width best extensions among
+ * all of them, given by a TopKObserver, are kept for the next coordinate. The generating values of a
+ * coordinate are drawn once from the explorer and shared by all the partial nets. With a width of 1,
+ * the beam search returns the same net as CBCSearch.
+ *
+ * Template template parameter EXPLORER must implement the member functions described in CBCSearch.
+ * The explorer is not informed of the merit values of the candidates.
+ *
+ * The candidates of each partial net are evaluated in batches by m_nThreads workers, each worker owning
+ * its own evaluator. Since the evaluators cannot be copied, the state of the evaluators for a partial net
+ * is rebuilt by evaluating its coordinates again before its candidates are evaluated, which costs one
+ * evaluation by coordinate and by worker for each partial net. Under early abortion, a candidate is
+ * aborted if its partial merit is strictly larger than the \c width-th best merit observed so far.
+ *
+ * In an MPI job, each process runs the whole search.
+ */
+template <NetConstruction NC, EmbeddingType ET, template <NetConstruction, EmbeddingType> class EXPLORER>
+class BeamCBCSearch : public Search<NC, ET>
+{
+    public:
+        typedef EXPLORER<NC, ET> Explorer;
+
+        /** Constructor.
+         * @param dimension Dimension of the searched net.
+         * @param sizeParameter Size parameter of the searched net.
+         * @param figure Figure of merit used to compare nets.
+         * @param explorer Explorer to search for nets.
+         * @param width Number of partial nets kept for each coordinate.
+         * @param verbose Verbosity level.
+         * @param earlyAbortion Early-abortion switch. If true, the computations will be stopped if the net cannot be kept.
+         * @param nThreads Number of threads used to evaluate the candidate nets. If 0, the number of hardware threads is used.
+         */
+        BeamCBCSearch(  Dimension dimension,
+                        typename NetConstructionTraits<NC>::SizeParameter sizeParameter,
+                        std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure,
+                        std::unique_ptr<Explorer> explorer,
+                        unsigned int width,
+                        int verbose = 0,
+                        bool earlyAbortion = false,
+                        unsigned int nThreads = 1):
+            Search<NC, ET>(dimension, sizeParameter, verbose, earlyAbortion),
+            m_figure(std::move(figure)),
+            m_explorer(std::move(explorer)),
+            m_width(width),
+            m_nThreads(LatBuilder::ThreadPool::resolveNumThreads(nThreads))
+        {
+            if (width == 0)
+            {
+                throw std::invalid_argument("In beam CBC search: the width of the beam must be positive.");
+            }
+        };
+
+        /** Constructor.
+         * @param dimension Dimension of the searched net.
+         * @param baseNet Net from which to start the search.
+         * @param figure Figure of merit used to compare nets.
+         * @param explorer Explorer to search for nets.
+         * @param width Number of partial nets kept for each coordinate.
+         * @param verbose Verbosity level.
+         * @param earlyAbortion Early-abortion switch. If true, the computations will be stopped if the net cannot be kept.
+         * @param nThreads Number of threads used to evaluate the candidate nets. If 0, the number of hardware threads is used.
+         */
+        BeamCBCSearch(  Dimension dimension,
+                        std::unique_ptr<DigitalNet<NC>> baseNet,
+                        std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure,
+                        std::unique_ptr<Explorer> explorer,
+                        unsigned int width,
+                        int verbose = 0,
+                        bool earlyAbortion = false,
+                        unsigned int nThreads = 1):
+            Search<NC, ET>(dimension, std::move(baseNet), verbose, earlyAbortion),
+            m_figure(std::move(figure)),
+            m_explorer(std::move(explorer)),
+            m_width(width),
+            m_nThreads(LatBuilder::ThreadPool::resolveNumThreads(nThreads))
+        {
+            if (width == 0)
+            {
+                throw std::invalid_argument("In beam CBC search: the width of the beam must be positive.");
+            }
+        };
+
+        /**
+         *  Default move constructor.
+         *  Deletes the implicit copy constructor.
+         */
+        BeamCBCSearch(BeamCBCSearch&&) = default;
+
+        /**
+         * Default destructor.
+         */
+        ~BeamCBCSearch() = default;
+
+        /**
+         *  Returns information about the task
+         */
+        virtual std::string format() const override
+        {
+            std::string res;
+            std::ostringstream stream;
+            stream << Search<NC, ET>::format();
+            stream << "Exploration method: beam CBC - width " << m_width << " - " << m_explorer->format() << std::endl;
+            if (m_nThreads > 1)
+            {
+                stream << "Number of threads: " << m_nThreads << std::endl;
+            }
+            stream << "Figure of merit: " << m_figure->format() << std::endl;
+            res += stream.str();
+            stream.str(std::string());
+            return res;
+        }
+
+        /**
+         * Executes the search task.
+         * The best net and merit value are set in the process.
+         */
+        virtual void execute() override
+        {
+            LatBuilder::ThreadPool& pool = LatBuilder::ThreadPool::shared(m_nThreads);
+
+            std::vector<std::unique_ptr<FigureOfMerit::CBCFigureOfMeritEvaluator>> evaluators;
+            for(unsigned int worker = 0; worker < pool.size(); ++worker)
+            {
+                evaluators.push_back(m_figure->evaluator()); // create an evaluator for each worker
+            }
+
+            LatBuilder::SharedMinimum threshold; // worst merit kept so far for the current coordinate
+            const LatBuilder::SharedMinimum* sharedMinimum = this->m_earlyAbortion ? &threshold : nullptr;
+
+            // the beam starts from the base net
+            std::vector<Beam> beams;
+            beams.push_back(Beam{std::make_shared<DigitalNet<NC>>(this->observer().bestNet()), 0});
+            beams.front().merit = replay(*evaluators.front(), *beams.front().net, sharedMinimum);
+
+            TopKObserver top(m_width);
+            const size_t batchSize = 16 * pool.size(); // number of candidates evaluated at once
+            std::vector<typename NetConstructionTraits<NC>::GenValue> genValues;
+            std::vector<DigitalNetCandidate<NC>> batch;
+            std::vector<std::shared_ptr<GeneratingMatrix>> buffers(batchSize); // generating matrices of the candidates of the batch
+            std::vector<Real> merits;
+
+            for(Dimension coord = beams.front().net->dimension(); coord < this->dimension(); ++coord) // for each dimension to explore
+            {
+                if(this->m_verbose>=1 && coord > 0)
+                {
+                    std::cout << "Begin coordinate: " << coord + 1 << "/" << this->dimension() << std::endl;
+                }
+                m_explorer->switchToCoordinate(coord);
+                genValues.clear();
+                while(!m_explorer->isOver()) // the generating values are shared by the partial nets
+                {
+                    genValues.push_back(m_explorer->nextGenValue());
+                }
+                const unsigned long long nCandidates = genValues.size();
+                LatBuilder::ProgressFeed::setCoordinate(coord + 1, this->dimension());
+                LatBuilder::ProgressFeed::setCandidates(beams.size() * nCandidates);
+
+                top.reset();
+                threshold.reset();
+                const auto budget = LatBuilder::Budget::share(this->dimension() - coord); // the remaining budget is divided between the remaining coordinates
+                bool exhausted = false;
+                for(size_t k = 0; k < beams.size() && !exhausted; ++k) // for each partial net
+                {
+                    const Beam& beam = beams[k];
+                    pool.parallelFor(evaluators.size(), [&](unsigned int, size_t i)
+                    {
+                        replay(*evaluators[i], *beam.net, sharedMinimum); // bring each evaluator to the state of the partial net
+                        evaluators[i]->prepareForNextDimension();
+                    });
+                    for(size_t first = 0; first < genValues.size() && !exhausted; first += batchSize)
+                    {
+                        const size_t n = std::min<size_t>(batchSize, genValues.size() - first);
+                        batch.clear();
+                        for(size_t i = 0; i < n; ++i)
+                        {
+                            batch.emplace_back(*beam.net, genValues[first + i], buffers[i]);
+                        }
+                        merits.resize(n);
+                        pool.parallelFor(n, [&](unsigned int worker, size_t i)
+                        {
+                            merits[i] = evaluate(*evaluators[worker], batch[i], coord, beam.merit, this->m_verbose-3); // evaluate the net
+                        });
+                        for(size_t i = 0; i < n; ++i) // give the nets to the observer in exploration order
+                        {
+                            top.observe(k * nCandidates + first + i, merits[i]);
+                        }
+                        LatBuilder::ProgressFeed::setCandidate(k * nCandidates + first + n);
+                        threshold.lower(top.worstMerit());
+                        exhausted = budget.exhausted();
+                    }
+                }
+
+                if (top.size() == 0)
+                {
+                    this->onFailedSearch()(*this); // fails if the search has failed
+                    return;
+                }
+
+                std::vector<Beam> newBeams;
+                for(const auto& entry : top.entries()) // from the best to the worst
+                {
+                    const Beam& parent = beams[entry.index / nCandidates];
+                    newBeams.push_back(Beam{std::shared_ptr<DigitalNet<NC>>(parent.net->appendNewCoordinate(genValues[entry.index % nCandidates])), entry.merit});
+                }
+                beams = std::move(newBeams);
+                LatBuilder::ProgressFeed::setBestMerit(beams.front().merit);
+
+                if(this->m_verbose>=1)
+                {
+                    std::cout << "End coordinate: " << coord + 1 << "/" << this->dimension() << " - " << nCandidates << " nets explored for each partial net"
+                              << " - partial merit values: " << beams.front().merit << " to " << beams.back().merit << std::endl;
+                }
+            }
+            this->m_observer->observe(std::make_unique<DigitalNet<NC>>(*beams.front().net), beams.front().merit);
+            this->selectBestNet(*beams.front().net, beams.front().merit);
+        }
+
+        /**
+         * Resets the search.
+         */
+        virtual void reset() override
+        {
+            Search<NC, ET>::reset();
+            m_explorer->reset();
+        }
+
+        /**
+         * {@inheritDoc}
+         */
+        virtual const FigureOfMerit::CBCFigureOfMerit& figureOfMerit() const override
+        {
+            return *m_figure;
+        }
+
+        /**
+         * Returns the number of partial nets kept for each coordinate.
+         */
+        unsigned int width() const { return m_width; }
+
+        /**
+         * Returns the number of threads used to evaluate the candidate nets.
+         */
+        unsigned int numThreads() const { return m_nThreads; }
+
+    private:
+        /// Partial net kept by the beam.
+        struct Beam {
+            std::shared_ptr<DigitalNet<NC>> net;
+            Real merit;
+        };
+
+        /**
+         * Computes with \c evaluator the partial merit value of \c net for the coordinate \c coord, starting from \c initialValue.
+         */
+        static MeritValue evaluate(FigureOfMerit::CBCFigureOfMeritEvaluator& evaluator, const AbstractDigitalNet& net, Dimension coord, MeritValue initialValue, int verbose = 0)
+        {
+            LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::EVALUATION);
+            return evaluator(net, coord, std::move(initialValue), verbose);
+        }
+
+        /**
+         * Resets \c evaluator and brings it to the state of the net \c net, then returns the merit value of \c net.
+         * The coordinates of \c net are evaluated without early abortion, and \c sharedMinimum is then given to the evaluator.
+         */
+        static Real replay(FigureOfMerit::CBCFigureOfMeritEvaluator& evaluator, const DigitalNet<NC>& net, const LatBuilder::SharedMinimum* sharedMinimum)
+        {
+            evaluator.reset();
+            evaluator.setSharedMinimum(nullptr);
+            Real merit = 0;
+            for(Dimension coord = 0; coord < net.dimension(); ++coord)
+            {
+                evaluator.prepareForNextDimension();
+                merit = evaluate(evaluator, net, coord, merit);
+                evaluator.lastNetWasBest();
+            }
+            evaluator.setSharedMinimum(sharedMinimum);
+            return merit;
+        }
+
+        std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> m_figure;
+        std::unique_ptr<Explorer> m_explorer;
+        unsigned int m_width; // number of partial nets kept for each coordinate
+        unsigned int m_nThreads; // number of threads used to evaluate the candidates
+};
+
+}}
+
+#endif
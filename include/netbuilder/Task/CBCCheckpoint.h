@@ -0,0 +1,224 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NETBUILDER__TASK__CBC_CHECKPOINT_H
+#define NETBUILDER__TASK__CBC_CHECKPOINT_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/DigitalNet.h"
+#include "netbuilder/NetConstructionTraits.h"
+
+#include "latbuilder/Checkpoint.h"
+#include "latbuilder/Util.h"
+
+#include <boost/lexical_cast.hpp>
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * Formatting of the generating values in checkpoint files.
+ * Each specialization must define the following static member functions:
+ * - <CODE> std::string format(const GenValue& genValue) </CODE>: format the generating value on a single line.
+ * - <CODE> GenValue parse(const std::string& str, const SizeParameter& sizeParameter, Dimension coord) </CODE>: parse a
+ * generating value formatted by \c format for coordinate \c coord.
+ */
+template <NetConstruction NC>
+struct CheckpointTraits;
+
+namespace detail {
+    inline std::vector<unsigned long> parseCheckpointNumbers(const std::string& str)
+    {
+        std::vector<unsigned long> numbers;
+        std::istringstream stream(str);
+        std::string token;
+        while (stream >> token)
+        {
+            numbers.push_back(boost::lexical_cast<unsigned long>(token));
+        }
+        return numbers;
+    }
+
+    inline std::string formatCheckpointMatrix(const GeneratingMatrix& matrix)
+    {
+        return std::to_string(matrix.nRows()) + " " + matrix.formatToColumnsReverse(matrix.nRows());
+    }
+
+    inline GeneratingMatrix parseCheckpointMatrix(const std::string& str)
+    {
+        auto numbers = parseCheckpointNumbers(str);
+        if (numbers.empty())
+        {
+            throw std::runtime_error("invalid generating matrix in checkpoint: " + str);
+        }
+        const unsigned int nRows = (unsigned int) numbers.front();
+        return GeneratingMatrix::fromColsReverse(nRows, nRows, std::vector<unsigned long>(numbers.begin() + 1, numbers.end()));
+    }
+}
+
+/// Direction numbers, separated by spaces.
+template <>
+struct CheckpointTraits<NetConstruction::SOBOL>
+{
+    typedef NetConstructionTraits<NetConstruction::SOBOL>::GenValue GenValue;
+    typedef NetConstructionTraits<NetConstruction::SOBOL>::SizeParameter SizeParameter;
+
+    static std::string format(const GenValue& genValue)
+    {
+        std::string res;
+        for (const auto& dirNum : genValue.second)
+        {
+            res += std::to_string(dirNum) + " ";
+        }
+        if (!res.empty())
+        {
+            res.pop_back();
+        }
+        return res;
+    }
+
+    static GenValue parse(const std::string& str, const SizeParameter&, Dimension coord)
+    {
+        auto numbers = detail::parseCheckpointNumbers(str);
+        return GenValue(coord, std::vector<uInteger>(numbers.begin(), numbers.end()));
+    }
+};
+
+/// Index of the generating polynomial.
+template <>
+struct CheckpointTraits<NetConstruction::POLYNOMIAL>
+{
+    typedef NetConstructionTraits<NetConstruction::POLYNOMIAL>::GenValue GenValue;
+    typedef NetConstructionTraits<NetConstruction::POLYNOMIAL>::SizeParameter SizeParameter;
+
+    static std::string format(const GenValue& genValue)
+    {
+        return std::to_string(LatBuilder::IndexOfPolynomial(genValue));
+    }
+
+    static GenValue parse(const std::string& str, const SizeParameter&, Dimension)
+    {
+        return LatBuilder::PolynomialFromInt(boost::lexical_cast<uInteger>(str));
+    }
+};
+
+/// Number of rows of the generating matrix followed by its columns in reverse integer representation.
+template <>
+struct CheckpointTraits<NetConstruction::EXPLICIT>
+{
+    typedef NetConstructionTraits<NetConstruction::EXPLICIT>::GenValue GenValue;
+    typedef NetConstructionTraits<NetConstruction::EXPLICIT>::SizeParameter SizeParameter;
+
+    static std::string format(const GenValue& genValue)
+    {
+        return detail::formatCheckpointMatrix(genValue);
+    }
+
+    static GenValue parse(const std::string& str, const SizeParameter&, Dimension)
+    {
+        return detail::parseCheckpointMatrix(str);
+    }
+};
+
+/// Number of rows of the scrambling matrix followed by its columns in reverse integer representation.
+template <>
+struct CheckpointTraits<NetConstruction::LMS>
+{
+    typedef NetConstructionTraits<NetConstruction::LMS>::GenValue GenValue;
+    typedef NetConstructionTraits<NetConstruction::LMS>::SizeParameter SizeParameter;
+
+    static std::string format(const GenValue& genValue)
+    {
+        return detail::formatCheckpointMatrix(genValue);
+    }
+
+    static GenValue parse(const std::string& str, const SizeParameter&, Dimension)
+    {
+        return detail::parseCheckpointMatrix(str);
+    }
+};
+
+/**
+ * Returns the net whose generating values, formatted by CheckpointTraits, are \c genValues.
+ * @param genValues Formatted generating values of the coordinates.
+ * @param sizeParameter Size parameter of the net.
+ * @param fileName Name of the file from which the values were read, for the error messages.
+ */
+template <NetConstruction NC>
+std::unique_ptr<DigitalNet<NC>> parseCBCNet(const std::vector<std::string>& genValues, const typename NetConstructionTraits<NC>::SizeParameter& sizeParameter, const std::string& fileName)
+{
+    std::vector<typename NetConstructionTraits<NC>::GenValue> values;
+    values.reserve(genValues.size());
+    for (Dimension coord = 0; coord < genValues.size(); ++coord)
+    {
+        auto genValue = CheckpointTraits<NC>::parse(genValues[coord], sizeParameter, coord);
+        if (!NetConstructionTraits<NC>::checkGenValue(genValue, sizeParameter))
+        {
+            throw std::runtime_error("the generating value of coordinate " + std::to_string(coord + 1) + " of " + fileName + " does not match the size parameter");
+        }
+        values.push_back(std::move(genValue));
+    }
+    return std::make_unique<DigitalNet<NC>>(genValues.size(), sizeParameter, std::move(values));
+}
+
+/**
+ * Returns the generating values of \c net formatted by CheckpointTraits.
+ */
+template <NetConstruction NC>
+std::vector<std::string> formatCBCNet(const DigitalNet<NC>& net)
+{
+    std::vector<std::string> genValues;
+    for (Dimension coord = 0; coord < net.dimension(); ++coord)
+    {
+        genValues.push_back(CheckpointTraits<NC>::format(net.generatingValue(coord)));
+    }
+    return genValues;
+}
+
+/**
+ * Writes the checkpoint of a CBC search whose best net for the completed coordinates is \c net.
+ * @param fileName Name of the checkpoint file.
+ * @param net Best net for the completed coordinates.
+ * @param merit Merit value of \c net.
+ */
+template <NetConstruction NC>
+void writeCBCCheckpoint(const std::string& fileName, const DigitalNet<NC>& net, Real merit)
+{
+    LatBuilder::Checkpoint checkpoint;
+    checkpoint.merit = merit;
+    checkpoint.genValues = formatCBCNet(net);
+    checkpoint.write(fileName);
+}
+
+/**
+ * Reads the checkpoint of a CBC search and returns the net of the completed coordinates,
+ * to be used as the base net of the resumed search.
+ * @param fileName Name of the checkpoint file.
+ * @param sizeParameter Size parameter of the search.
+ */
+template <NetConstruction NC>
+std::unique_ptr<DigitalNet<NC>> readCBCCheckpoint(const std::string& fileName, const typename NetConstructionTraits<NC>::SizeParameter& sizeParameter)
+{
+    return parseCBCNet<NC>(LatBuilder::Checkpoint::read(fileName).genValues, sizeParameter, fileName);
+}
+
+}}
+
+#endif
@@ -18,9 +18,36 @@
 #define NETBUILDER__TASK__CBC_SEARCH_H
 
 #include "netbuilder/Task/Search.h"
+#include "netbuilder/Task/CBCCheckpoint.h"
+#include "netbuilder/Task/CBCState.h"
+
+#include "latbuilder/Distributed.h"
+#include "latbuilder/Execution.h"
+#include "latbuilder/Shard.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/ProgressFeed.h"
+#include "latbuilder/SharedMinimum.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Trace.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
 
 namespace NetBuilder { namespace Task {
 
+namespace detail {
+    /// Whether the explorer is informed of the merit values of the candidates.
+    template <typename EXPLORER, typename = void>
+    struct ObservesMerits : std::false_type {};
+
+    template <typename EXPLORER>
+    struct ObservesMerits<EXPLORER, decltype(std::declval<EXPLORER&>().observeMerit(Real()), std::declval<const EXPLORER&>().available(), void())> : std::true_type {};
+}
+
 /** 
  * Class for CBC Search tasks.
  * Template template parameter EXPLORER must implement the following member functions:
@@ -30,12 +57,68 @@ namespace NetBuilder { namespace Task {
  * - <CODE> typename NetConstructionTraits<NC>::GenValue nextGenValue() </CODE>: return the next generating value.
  * - <CODE> bool isOver() </CODE>: indicate whether the exploration of the current coordinate is over.
  * where NC is the template parameter of EXPLORER.
+ * An explorer which adapts its exploration to the merit values, such as AdaptiveCBCExplorer, may also implement:
+ * - <CODE> void observeMerit(Real merit) </CODE>: inform the explorer of the minimum merit of the candidates drawn since the last call.
+ * - <CODE> size_t available() const </CODE>: return the number of candidates which can be drawn before the explorer needs their merit values.
+ * The parallel searches then draw no more than available() candidates before giving their minimum merit to the explorer,
+ * so that they explore the same candidates as the serial search.
+ *
+ * If more than one thread is requested, the candidate nets of each coordinate are drawn from the explorer
+ * in batches by the calling thread and evaluated concurrently, each worker owning its own evaluator.
+ * The merits are then given to the observer in exploration order, so that the parallel search
+ * returns the same net as the serial search, ties included.
+ * In the last batch of a coordinate, the workers which find no candidate left to evaluate speculatively bring their evaluator
+ * to the state of the best candidate evaluated so far, as if it were selected, instead of waiting for the others to finish.
+ * Once the best candidate is known, only the evaluators whose speculation was wrong are brought to its state.
+ *
+ * If a screening figure is set with setPrefilter(), each candidate is first evaluated with it, and the candidates whose
+ * screening merit already exceeds the merit value of the best candidate so far are discarded without being evaluated with
+ * the figure of merit. The screening figure must give a lower bound of the partial merit values of the figure of merit,
+ * for instance the same weighted figure restricted to low-order projections, or a cheaper figure known to be smaller:
+ * the search then returns the same net as without screening.
+ * FigureOfMerit::SampledScreeningFigure instead estimates the merit of the candidates from a sample of the projections of
+ * weighted figures whose evaluation is too costly even with early abortion; the search is then no longer exact.
+ * If setScreeningOrder() is also enabled, all the candidates of each coordinate are first screened, then evaluated by
+ * increasing screening merit, so that a good candidate is found early and most of the others are discarded or aborted
+ * early. The best merit is the same, but a different net of equal merit may be selected. Explorers which observe the
+ * merit values of the candidates keep their own order.
+ *
+ * If the figure of merit gives a lower bound of the merits of the candidates of a coordinate
+ * (see FigureOfMerit::CBCFigureOfMerit::meritLowerBound()), for instance the partial t-value of the base net for the
+ * t-value figures, the exploration of the coordinate stops as soon as the best candidate reaches it.
+ *
+ * If a checkpoint file is set, the best net is written to it after each completed coordinate.
+ * A search constructed with the net read from the checkpoint as its base net resumes from the
+ * first coordinate which was not completed.
+ *
+ * If a state file is set with setStateFile(), the states of the evaluators for the selected net are written to it at the end
+ * of the search (see CBCState). A search whose base net is the net of that file, read with readCBCStateNet(), and
+ * which is given the file with setResumeStateFile(), restores the evaluators from it instead of evaluating the
+ * coordinates of the base net again. The evaluators which cannot save their state
+ * (see FigureOfMerit::CBCFigureOfMeritEvaluator::saveState()) still evaluate the base net.
+ *
+ * In an MPI job, the candidate nets of each coordinate are shared by the processes as described in LatBuilder::Distributed:
+ * each process evaluates its own slice of the candidates with its threads, then the processes agree on the best candidate
+ * and the process which evaluated it broadcasts its generating value. Only the root process writes the checkpoints.
+ * If the search is split into shards (see LatBuilder::Shard), the shard of the process only evaluates its range of the
+ * candidates of each coordinate, so that its search is meant to add a single coordinate to the base net.
+ *
+ * Template parameter EVALUATOR is the type of the evaluators of the figure of merit. With the default
+ * FigureOfMerit::CBCFigureOfMeritEvaluator, the evaluators are created by the figure and called through virtual functions,
+ * so that any CBC figure of merit can be used. Embedded users who know the figure of merit when they compile
+ * may instead give a concrete evaluator type, for instance
+ * <CODE> FigureOfMerit::ProjectionDependentEvaluator<PROJDEP, StaticAccumulator<LatBuilder::Functor::Max>> </CODE>:
+ * the candidates are then evaluated with non-virtual calls which can be inlined in the search loop. A concrete EVALUATOR must
+ * define the type <CODE> Figure </CODE> of the figure of merit it evaluates and be constructible from a <CODE> Figure* </CODE>;
+ * the figure given to the search must be of this type.
  */ 
-template < NetConstruction NC, EmbeddingType ET, template <NetConstruction, EmbeddingType> class EXPLORER, template <NetConstruction> class OBSERVER = MinimumObserver>
+template < NetConstruction NC, EmbeddingType ET, template <NetConstruction, EmbeddingType> class EXPLORER, template <NetConstruction> class OBSERVER = MinimumObserver,
+           class EVALUATOR = FigureOfMerit::CBCFigureOfMeritEvaluator>
 class CBCSearch : public Search<NC, ET, OBSERVER>
 {
     public:
         typedef EXPLORER<NC, ET> Explorer;
+        typedef EVALUATOR Evaluator;
 
         /** Constructor.
          * @param dimension Dimension of the searched net.
@@ -44,16 +127,19 @@ class CBCSearch : public Search<NC, ET, OBSERVER>
          * @param explorer Explorer to search for nets.
          * @param verbose Verbosity level.
          * @param earlyAbortion Early-abortion switch. If true, the computations will be stopped if the net is worse than the best one so far.
+         * @param nThreads Number of threads used to evaluate the candidate nets. If 0, the number of hardware threads is used.
          */
         CBCSearch(  Dimension dimension, 
                     typename NetConstructionTraits<NC>::SizeParameter sizeParameter,
                     std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure,
                     std::unique_ptr<Explorer> explorer = std::make_unique<Explorer>(),
                     int verbose = 0,
-                    bool earlyAbortion = false):
+                    bool earlyAbortion = false,
+                    unsigned int nThreads = 1):
             Search<NC, ET, OBSERVER>(dimension, sizeParameter, verbose, earlyAbortion),
             m_figure(std::move(figure)),
-            m_explorer(std::move(explorer))
+            m_explorer(std::move(explorer)),
+            m_nThreads(LatBuilder::ThreadPool::resolveNumThreads(nThreads))
         {};
 
         /** Constructor.
@@ -63,16 +149,19 @@ class CBCSearch : public Search<NC, ET, OBSERVER>
          * @param explorer Explorer to search for nets.
          * @param verbose Verbosity level.
          * @param earlyAbortion Early-abortion switch. If true, the computations will be stopped if the net is worse than the best one so far.
+         * @param nThreads Number of threads used to evaluate the candidate nets. If 0, the number of hardware threads is used.
          */
         CBCSearch(  Dimension dimension, 
                     std::unique_ptr<DigitalNet<NC>> baseNet,
                     std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure,
                     std::unique_ptr<Explorer> explorer = std::make_unique<Explorer>(),
                     int verbose = 0,
-                    bool earlyAbortion = false):
+                    bool earlyAbortion = false,
+                    unsigned int nThreads = 1):
             Search<NC, ET, OBSERVER>(dimension, std::move(baseNet), verbose, earlyAbortion),
             m_figure(std::move(figure)),
-            m_explorer(std::move(explorer))
+            m_explorer(std::move(explorer)),
+            m_nThreads(LatBuilder::ThreadPool::resolveNumThreads(nThreads))
         {};
 
         /** 
@@ -95,7 +184,15 @@ class CBCSearch : public Search<NC, ET, OBSERVER>
             std::ostringstream stream;
             stream << Search<NC, ET, OBSERVER>::format();
             stream << "Exploration method: CBC - " << m_explorer->format() << std::endl;
+            if (m_nThreads > 1)
+            {
+                stream << "Number of threads: " << m_nThreads << std::endl;
+            }
             stream << "Figure of merit: " << m_figure->format() << std::endl;
+            if (m_prefilter)
+            {
+                stream << "Screening figure: " << m_prefilter->format() << std::endl;
+            }
             res += stream.str();
             stream.str(std::string());
             return res;
@@ -107,47 +204,129 @@ class CBCSearch : public Search<NC, ET, OBSERVER>
          */
         virtual void execute() override
         {
+            if (m_nThreads > 1 || LatBuilder::Distributed::size() > 1 || LatBuilder::Shard::active())
+            {
+                executeParallel();
+                return;
+            }
 
-            auto evaluator = this->m_figure->evaluator(); // create an evaluator
+            auto evaluator = makeEvaluator(); // create an evaluator
+            auto prefilter = makePrefilter(); // screening evaluator, if any
 
             // compute the merit of the base net is one was provided
             Real merit = 0; 
+            Real prefilterMerit = 0; // screening merit of the base net
+
+            CBCState saved;
+            const bool resumed = readResumeState(saved);
+            const bool restored = resumed && restoreState(*evaluator, saved.evaluatorState);
+            const bool prefilterRestored = prefilter && resumed && restoreState(*prefilter, saved.prefilterState);
+            if (restored)
+            {
+                merit = saved.merit;
+            }
+            if (prefilterRestored)
+            {
+                prefilterMerit = saved.prefilterMerit;
+            }
 
             for(Dimension coord = 0; coord < this->observer().bestNet().dimension(); ++coord)
             {
-                evaluator->prepareForNextDimension();
-                merit = (*evaluator)(this->observer().bestNet(), coord, merit) ;
-                evaluator->lastNetWasBest();
+                if (!restored)
+                {
+                    evaluator->prepareForNextDimension();
+                    merit = evaluate(*evaluator, this->observer().bestNet(), coord, merit) ;
+                    evaluator->lastNetWasBest();
+                }
+                if (prefilter && !prefilterRestored)
+                {
+                    prefilter->prepareForNextDimension();
+                    prefilterMerit = evaluatePrefilter(*prefilter, this->observer().bestNet(), coord, prefilterMerit);
+                    prefilter->lastNetWasBest();
+                }
             }
 
-            if (this->m_earlyAbortion) // if the switch is on, connect the abortion signals of the evaluator to the observer
+            if (selectCompleteBaseNet(merit))
             {
-                evaluator->onProgress().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onProgress, &this->observer(), boost::placeholders::_1));
-                evaluator->onAbort().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onAbort, &this->observer(), boost::placeholders::_1));
+                return;
+            }
+
+            if (this->m_earlyAbortion) // if the switch is on, let the evaluator poll the best merit of the observer
+            {
+                evaluator->setSharedMinimum(&this->observer().sharedMinimum());
+            }
+            if (prefilter) // the screening stops as soon as the candidate is known to be discarded
+            {
+                prefilter->setSharedMinimum(&this->observer().sharedMinimum());
             }
 
             m_explorer->switchToCoordinate(this->observer().bestNet().dimension()); // to to the first dimension to explore
 
             for(Dimension coord = this->observer().bestNet().dimension() ; coord < this->dimension(); ++coord) // for each dimension to explore
             {
+                LatBuilder::Trace::Span span("coordinate", "search", "coordinate", coord + 1);
                 evaluator->prepareForNextDimension();
+                if (prefilter)
+                {
+                    prefilter->prepareForNextDimension();
+                }
+                Real bestPrefilterMerit = prefilterMerit; // screening merit of the best candidate
                 if(this->m_verbose>=1 && coord > 0)
                 {
                     std::cout << "Begin coordinate: " << coord + 1 << "/" << this->dimension() << std::endl;
                 }
+                LatBuilder::ProgressFeed::setCoordinate(coord + 1, this->dimension());
+                LatBuilder::ProgressFeed::setCandidates(m_explorer->size());
                 auto net = this->m_observer->bestNet(); // base net of the search
-                while(!m_explorer->isOver()) // for each generating values provided by the explorer
+                std::shared_ptr<GeneratingMatrix> buffer; // generating matrix of the candidates, reused until a candidate is kept
+                const auto budget = LatBuilder::Budget::share(this->dimension() - coord); // the remaining budget is divided between the remaining coordinates
+                const Real lowerBound = m_figure->meritLowerBound(merit); // no candidate can be better than a candidate reaching it
+                const bool ordered = screeningOrder() && prefilter;
+                std::vector<ScreenedCandidate> screened; // candidates in screening order, if ordered
+                if (ordered)
+                {
+                    screened = drawCandidates(false);
+                    for (auto& candidate : screened)
+                    {
+                        candidate.merit = evaluatePrefilter(*prefilter, DigitalNetCandidate<NC>(net, candidate.genValue, buffer), coord, prefilterMerit);
+                    }
+                    sortByScreeningMerit(screened);
+                }
+                size_t next = 0; // index of the next candidate in screening order
+                while(ordered ? next < screened.size() : !m_explorer->isOver()) // for each generating values provided by the explorer
                 {
-                    auto newNet = net.appendNewCoordinate(m_explorer->nextGenValue());
+                    DigitalNetCandidate<NC> newNet(net, ordered ? screened[next].genValue : m_explorer->nextGenValue(), buffer);
                     unsigned long totalSize = m_explorer->size();
+                    LatBuilder::ProgressFeed::setCandidate(m_explorer->count());
                     if (this->m_verbose>=2 && ((totalSize > 100 && m_explorer->count() % 100 == 0) || (m_explorer->count() % 10 == 0)))
                     {
                         std::cout << "Coordinate " << coord + 1 << "/" << this->dimension() << " - net " << m_explorer->count() << "/" << totalSize << std::endl;
                     }
-                    double newMerit = (*evaluator)(*newNet,coord,merit, this->m_verbose-3); // evaluate the net
-                    if (this->m_observer->observe(std::move(newNet),newMerit)) // give it to the observer
+                    Real screeningMerit = 0;
+                    const bool accepted = ordered ? accepts(screened[next++].merit, this->observer().sharedMinimum(), screeningMerit) :
+                        screen(prefilter.get(), newNet, coord, prefilterMerit, this->observer().sharedMinimum(), screeningMerit);
+                    double newMerit = accepted ? evaluate(*evaluator, newNet, coord, merit, this->m_verbose-3) : std::numeric_limits<Real>::infinity(); // evaluate the net
+                    if (this->m_observer->observe(newNet,newMerit)) // give it to the observer
                     {
                         evaluator->lastNetWasBest();
+                        if (prefilter)
+                        {
+                            if (!ordered) // the screening evaluator was last given another candidate otherwise
+                            {
+                                prefilter->lastNetWasBest();
+                            }
+                            bestPrefilterMerit = screeningMerit;
+                        }
+                    }
+                    observeMerit(newMerit, detail::ObservesMerits<Explorer>());
+                    this->writePartialResult();
+                    if (budget.exhausted())
+                    {
+                        break;
+                    }
+                    if (reachedLowerBound(lowerBound))
+                    {
+                        break;
                     }
                 }
                 if (!this->m_observer->hasFoundNet())
@@ -155,23 +334,34 @@ class CBCSearch : public Search<NC, ET, OBSERVER>
                     this->onFailedSearch()(*this); // fails if the search has failed
                     return;
                 }
+                if (ordered) // bring the screening evaluator to the state of the best net
+                {
+                    prefilter->setSharedMinimum(nullptr);
+                    evaluatePrefilter(*prefilter, this->m_observer->bestNet(), coord, prefilterMerit);
+                    prefilter->lastNetWasBest();
+                    prefilter->setSharedMinimum(&this->observer().sharedMinimum());
+                }
                 merit = this->m_observer->bestMerit();
+                prefilterMerit = bestPrefilterMerit;
                 if(this->m_verbose>=1)
                 {
                     std::string netExplored;
-                    if (m_explorer->size() == 1){
+                    if (m_explorer->count() == 1){
                         netExplored = "1 net";
                     }
                     else{
-                        netExplored = std::to_string(m_explorer->size()) + " nets";
+                        netExplored = std::to_string(m_explorer->count()) + " nets";
                     }
                     std::cout << "End coordinate: " << coord + 1 << "/" << this->dimension() << " - " << netExplored << " explored - partial merit value: " << merit << std::endl;
                 }
+                LatBuilder::ProgressFeed::setBestMerit(merit);
+                writeCheckpoint(merit);
                 if (coord + 1 < this->dimension()){ // if at least one dimension remains unexplored
                     this->m_observer->reset(false);
                     m_explorer->switchToCoordinate(coord+1);
                 }
             }
+            writeState(*evaluator, prefilter.get(), merit, prefilterMerit);
             this->selectBestNet(this->m_observer->bestNet(), this->m_observer->bestMerit());
         }
 
@@ -193,9 +383,680 @@ class CBCSearch : public Search<NC, ET, OBSERVER>
             return *m_figure;
         }
 
+        /**
+         * Returns the number of threads used to evaluate the candidate nets.
+         */
+        unsigned int numThreads() const { return m_nThreads; }
+
+        /**
+         * Sets the file to which the best net is written after each completed coordinate.
+         * No checkpoint is written if \c fileName is empty.
+         */
+        void setCheckpointFile(std::string fileName) { m_checkpointFile = std::move(fileName); }
+
+        /**
+         * Sets the file to which the states of the evaluators for the selected net are written at the end of the search.
+         * No state is written if \c fileName is empty.
+         */
+        void setStateFile(std::string fileName) { m_stateFile = std::move(fileName); }
+
+        /**
+         * Sets the file, written by a search with setStateFile(), from which the states of the evaluators for the base
+         * net are restored. The base net of the search must be the net of the file, and the figures of merit must be the same.
+         * No state is restored if \c fileName is empty.
+         */
+        void setResumeStateFile(std::string fileName) { m_resumeStateFile = std::move(fileName); }
+
+        /**
+         * Sets the screening figure evaluated before the figure of merit, which must give a lower bound of its partial
+         * merit values. A \c nullptr disables the screening.
+         */
+        void setPrefilter(std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> prefilter) { m_prefilter = std::move(prefilter); }
+
+        /**
+         * Returns the screening figure, or \c nullptr if the candidates are not screened.
+         */
+        const FigureOfMerit::CBCFigureOfMerit* prefilter() const { return m_prefilter.get(); }
+
+        /**
+         * Sets whether all the candidates of each coordinate are screened first, then evaluated by increasing screening
+         * merit. Ignored if there is no screening figure or if the explorer observes the merit values of the candidates.
+         */
+        void setScreeningOrder(bool ordered) { m_screeningOrder = ordered; }
+
     private:
+        typedef std::unique_ptr<EVALUATOR> pEvaluator;
+
+        /// Whether the evaluators are called through the virtual functions of FigureOfMerit::CBCFigureOfMeritEvaluator.
+        typedef std::is_same<EVALUATOR, FigureOfMerit::CBCFigureOfMeritEvaluator> isDynamic;
+
+        /**
+         * Returns true if the best candidate of the current coordinate reaches the lower bound \c lowerBound of the merits
+         * of its candidates (see FigureOfMerit::CBCFigureOfMerit::meritLowerBound()). The candidates which follow it cannot
+         * be better, and the observer keeps the first of the best candidates, so that the search returns the same net
+         * without exploring them.
+         */
+        bool reachedLowerBound(Real lowerBound) const
+        {
+            return this->m_observer->hasFoundNet() && this->m_observer->bestMerit() <= lowerBound;
+        }
+
+        /**
+         * Creates an evaluator for the figure of merit. The evaluator only extends the base net, so that it may discard
+         * the data of the coordinates already chosen (see FigureOfMerit::CBCFigureOfMeritEvaluator::setPruning()).
+         */
+        pEvaluator makeEvaluator()
+        {
+            auto evaluator = makeEvaluator(isDynamic());
+            evaluator->setPruning(true);
+            return evaluator;
+        }
+
+        pEvaluator makeEvaluator(std::true_type) { return m_figure->evaluator(); }
+
+        pEvaluator makeEvaluator(std::false_type)
+        {
+            auto figure = dynamic_cast<typename EVALUATOR::Figure*>(m_figure.get());
+            if (!figure)
+            {
+                throw std::invalid_argument("In CBC search: the figure of merit does not match the type of the evaluator.");
+            }
+            return std::make_unique<EVALUATOR>(figure);
+        }
+
+        /**
+         * Computes with \c evaluator the partial merit value of \c net for the coordinate \c coord, starting from \c initialValue.
+         * The call is not virtual if EVALUATOR is a concrete evaluator type.
+         */
+        static MeritValue evaluate(EVALUATOR& evaluator, const AbstractDigitalNet& net, Dimension coord, MeritValue initialValue, int verbose = 0)
+        {
+            LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::EVALUATION);
+            return evaluate(evaluator, net, coord, std::move(initialValue), verbose, isDynamic());
+        }
+
+        static MeritValue evaluate(EVALUATOR& evaluator, const AbstractDigitalNet& net, Dimension coord, MeritValue initialValue, int verbose, std::true_type)
+        { return evaluator(net, coord, std::move(initialValue), verbose); }
+
+        static MeritValue evaluate(EVALUATOR& evaluator, const AbstractDigitalNet& net, Dimension coord, MeritValue initialValue, int verbose, std::false_type)
+        { return evaluator.EVALUATOR::operator()(net, coord, std::move(initialValue), verbose); }
+
+        typedef std::unique_ptr<FigureOfMerit::CBCFigureOfMeritEvaluator> pPrefilter;
+
+        /**
+         * Creates an evaluator for the screening figure, or returns \c nullptr if there is none. As the evaluator of the
+         * figure of merit, it may discard the data of the coordinates already chosen.
+         */
+        pPrefilter makePrefilter()
+        {
+            if (!m_prefilter)
+            {
+                return pPrefilter();
+            }
+            auto prefilter = m_prefilter->evaluator();
+            prefilter->setPruning(true);
+            return prefilter;
+        }
+
+        /**
+         * Computes with \c prefilter the partial screening merit of \c net for the coordinate \c coord, starting from \c initialValue.
+         */
+        static MeritValue evaluatePrefilter(FigureOfMerit::CBCFigureOfMeritEvaluator& prefilter, const AbstractDigitalNet& net, Dimension coord, MeritValue initialValue)
+        {
+            LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::EVALUATION);
+            return prefilter(net, coord, std::move(initialValue));
+        }
+
+        /**
+         * Returns \c false if the candidate \c net must be discarded because its screening merit for the coordinate
+         * \c coord, computed with \c prefilter from \c initialValue and stored in \c merit, exceeds \c threshold.
+         * Returns \c true without any computation if \c prefilter is \c nullptr.
+         */
+        static bool screen(FigureOfMerit::CBCFigureOfMeritEvaluator* prefilter, const AbstractDigitalNet& net, Dimension coord, Real initialValue,
+                           const LatBuilder::SharedMinimum& threshold, Real& merit)
+        {
+            if (!prefilter)
+            {
+                return true;
+            }
+            merit = evaluatePrefilter(*prefilter, net, coord, initialValue);
+            if (threshold.accepts(merit))
+            {
+                return true;
+            }
+            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::SCREENED_OUT);
+            return false;
+        }
+
+        /**
+         * Same as screen() for a candidate whose screening merit \c screeningMerit is already known.
+         */
+        static bool accepts(Real screeningMerit, const LatBuilder::SharedMinimum& threshold, Real& merit)
+        {
+            merit = screeningMerit;
+            if (threshold.accepts(merit))
+            {
+                return true;
+            }
+            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::SCREENED_OUT);
+            return false;
+        }
+
+        /// Candidate drawn from the explorer, with its screening merit and its index in exploration order.
+        struct ScreenedCandidate
+        {
+            typename NetConstructionTraits<NC>::GenValue genValue;
+            unsigned long long index;
+            Real merit;
+        };
+
+        /**
+         * Returns true if the candidates are evaluated in screening order (see setScreeningOrder()).
+         */
+        bool screeningOrder() const { return screeningOrder(detail::ObservesMerits<Explorer>()); }
+
+        bool screeningOrder(std::true_type) const { return false; }
+
+        bool screeningOrder(std::false_type) const { return m_screeningOrder; }
+
+        /**
+         * Draws all the candidates of the current coordinate from the explorer. If \c owned is true, only the candidates
+         * evaluated by this process are kept (see LatBuilder::Shard and LatBuilder::Distributed).
+         */
+        std::vector<ScreenedCandidate> drawCandidates(bool owned)
+        {
+            std::vector<ScreenedCandidate> candidates;
+            for(unsigned long long candidate = 0; !m_explorer->isOver(); ++candidate)
+            {
+                auto genValue = m_explorer->nextGenValue();
+                if (!owned || (LatBuilder::Shard::owns(candidate, m_explorer->size()) && LatBuilder::Distributed::owns(candidate)))
+                {
+                    candidates.push_back(ScreenedCandidate{std::move(genValue), candidate, 0});
+                }
+            }
+            LatBuilder::ProgressFeed::setCandidate(m_explorer->count());
+            return candidates;
+        }
+
+        /**
+         * Sorts \c candidates by increasing screening merit, ties in exploration order.
+         */
+        static void sortByScreeningMerit(std::vector<ScreenedCandidate>& candidates)
+        {
+            std::stable_sort(candidates.begin(), candidates.end(), [](const ScreenedCandidate& a, const ScreenedCandidate& b) { return a.merit < b.merit; });
+        }
+
+        /**
+         * Informs the explorer of the merit value of a candidate, if it observes the merit values.
+         */
+        void observeMerit(Real merit, std::true_type) { m_explorer->observeMerit(merit); }
+
+        void observeMerit(Real, std::false_type) {}
+
+        /**
+         * Informs the explorer of the minimum merit value of a batch of candidates over all the processes,
+         * if it observes the merit values.
+         */
+        void observeBatchMerits(const std::vector<Real>& merits, std::true_type)
+        {
+            LatBuilder::Distributed::Candidate best;
+            if (!merits.empty())
+            {
+                best.merit = *std::min_element(merits.begin(), merits.end());
+            }
+            if (LatBuilder::Distributed::size() > 1)
+            {
+                best = LatBuilder::Distributed::minimum(best); // each process observed its own slice of the batch
+            }
+            m_explorer->observeMerit(best.merit);
+        }
+
+        void observeBatchMerits(const std::vector<Real>&, std::false_type) {}
+
+        /**
+         * Returns the number of candidates which can be drawn before the explorer needs their merit values.
+         */
+        size_t available(std::true_type) const { return m_explorer->available(); }
+
+        size_t available(std::false_type) const { return std::numeric_limits<size_t>::max(); }
+
+        /**
+         * Executes the search with m_nThreads workers.
+         * Each worker has its own evaluator. The evaluators all hold the state of the best net for the previous
+         * coordinates: once the best net for a coordinate is known, each evaluator evaluates it again before being told that it was the best one.
+         * Under early abortion, a candidate is only aborted if its partial merit is strictly larger than the best merit observed so far
+         * by any worker, so that the candidate selected by the serial search is never aborted.
+         */
+        void executeParallel()
+        {
+            LatBuilder::ThreadPool& pool = LatBuilder::ThreadPool::shared(m_nThreads);
+
+            std::vector<pEvaluator> evaluators;
+            std::vector<pPrefilter> prefilters; // screening evaluators, empty if there is no screening figure
+            for(unsigned int worker = 0; worker < pool.size(); ++worker)
+            {
+                evaluators.push_back(makeEvaluator()); // create an evaluator for each worker
+                if (m_prefilter)
+                {
+                    prefilters.push_back(makePrefilter());
+                }
+            }
+
+            // compute the merit of the base net is one was provided
+            std::vector<Real> baseMerits(pool.size(), 0);
+            std::vector<Real> basePrefilterMerits(pool.size(), 0);
+            const auto& baseNet = this->observer().bestNet();
+            CBCState saved;
+            const bool resumed = readResumeState(saved);
+            // the evaluators are all of the same type, so they are all restored or none is
+            std::vector<char> restored(pool.size(), false);
+            std::vector<char> prefilterRestored(pool.size(), false);
+            pool.parallelFor(pool.size(), [&](unsigned int, size_t i)
+            {
+                LatBuilder::Trace::Span span("base-net", "search", "evaluator", i);
+                if (resumed && restoreState(*evaluators[i], saved.evaluatorState))
+                {
+                    restored[i] = true;
+                    baseMerits[i] = saved.merit;
+                }
+                if (!prefilters.empty() && resumed && restoreState(*prefilters[i], saved.prefilterState))
+                {
+                    prefilterRestored[i] = true;
+                    basePrefilterMerits[i] = saved.prefilterMerit;
+                }
+                for(Dimension coord = 0; coord < baseNet.dimension(); ++coord)
+                {
+                    if (!restored[i])
+                    {
+                        evaluators[i]->prepareForNextDimension();
+                        baseMerits[i] = evaluate(*evaluators[i], baseNet, coord, baseMerits[i]);
+                        evaluators[i]->lastNetWasBest();
+                    }
+                    if (!prefilters.empty() && !prefilterRestored[i])
+                    {
+                        prefilters[i]->prepareForNextDimension();
+                        basePrefilterMerits[i] = evaluatePrefilter(*prefilters[i], baseNet, coord, basePrefilterMerits[i]);
+                        prefilters[i]->lastNetWasBest();
+                    }
+                }
+            });
+            Real merit = baseMerits[0];
+            Real prefilterMerit = basePrefilterMerits[0]; // screening merit of the base net
+
+            if (selectCompleteBaseNet(merit))
+            {
+                return;
+            }
+
+            LatBuilder::SharedMinimum threshold; // best merit observed so far for the current coordinate
+
+            if (this->m_earlyAbortion) // if the switch is on, let the evaluators poll the shared threshold
+            {
+                for(auto& evaluator : evaluators)
+                {
+                    evaluator->setSharedMinimum(&threshold);
+                }
+            }
+            for(auto& prefilter : prefilters) // the screening stops as soon as the candidate is known to be discarded
+            {
+                prefilter->setSharedMinimum(&threshold);
+            }
+
+            const size_t batchSize = 16 * pool.size(); // number of candidates drawn from the explorer at once
+            std::vector<DigitalNetCandidate<NC>> batch;
+            std::vector<std::shared_ptr<GeneratingMatrix>> buffers(batchSize); // generating matrices of the candidates of the batch
+            std::vector<unsigned long long> batchIndices; // indices of the candidates of the batch in exploration order
+            std::vector<Real> merits;
+            const bool speculative = pool.size() > 1 && LatBuilder::Distributed::size() == 1; // the processes agree on the best candidate afterwards
+            std::vector<unsigned long long> speculated(pool.size()); // candidate whose state each evaluator holds after a speculation
+
+            m_explorer->switchToCoordinate(this->observer().bestNet().dimension()); // to to the first dimension to explore
+
+            for(Dimension coord = this->observer().bestNet().dimension() ; coord < this->dimension(); ++coord) // for each dimension to explore
+            {
+                LatBuilder::Trace::Span span("coordinate", "search", "coordinate", coord + 1);
+                for(auto& evaluator : evaluators)
+                {
+                    evaluator->prepareForNextDimension();
+                }
+                for(auto& prefilter : prefilters)
+                {
+                    prefilter->prepareForNextDimension();
+                }
+                threshold.reset();
+                if(this->m_verbose>=1 && coord > 0)
+                {
+                    std::cout << "Begin coordinate: " << coord + 1 << "/" << this->dimension() << std::endl;
+                }
+                LatBuilder::ProgressFeed::setCoordinate(coord + 1, this->dimension());
+                LatBuilder::ProgressFeed::setCandidates(m_explorer->size());
+                auto net = this->m_observer->bestNet(); // base net of the search
+                unsigned long long candidate = 0; // index of the next candidate in exploration order
+                unsigned long long localBest = LatBuilder::Distributed::Candidate::none; // index of the best candidate evaluated by this process
+                const auto budget = LatBuilder::Budget::share(this->dimension() - coord); // the remaining budget is divided between the remaining coordinates
+                const Real lowerBound = m_figure->meritLowerBound(merit); // no candidate can be better than a candidate reaching it
+                const bool ordered = screeningOrder() && !prefilters.empty();
+                std::vector<ScreenedCandidate> screened; // candidates of this process in screening order, if ordered
+                if (ordered)
+                {
+                    screened = drawCandidates(true);
+                    pool.parallelFor(screened.size(), [&](unsigned int worker, size_t i)
+                    {
+                        screened[i].merit = evaluatePrefilter(*prefilters[worker], DigitalNetCandidate<NC>(net, screened[i].genValue), coord, prefilterMerit);
+                    });
+                    sortByScreeningMerit(screened);
+                }
+                size_t next = 0; // index of the next candidate in screening order
+                std::vector<Real> batchScreeningMerits; // screening merits of the candidates of the batch, if ordered
+                std::fill(speculated.begin(), speculated.end(), LatBuilder::Distributed::Candidate::none);
+                while(ordered ? next < screened.size() : !m_explorer->isOver())
+                {
+                    batch.clear();
+                    batchIndices.clear();
+                    batchScreeningMerits.clear();
+                    for(; ordered && next < screened.size() && batch.size() < batchSize; ++next) // draw the candidates in screening order
+                    {
+                        batch.emplace_back(net, screened[next].genValue, buffers[batch.size()]);
+                        batchIndices.push_back(screened[next].index);
+                        batchScreeningMerits.push_back(screened[next].merit);
+                    }
+                    const size_t drawLimit = ordered ? 0 : available(detail::ObservesMerits<Explorer>()); // candidates which can be drawn before the explorer needs their merits
+                    for(size_t drawn = 0; drawn < drawLimit && !m_explorer->isOver() && batch.size() < batchSize; ++drawn) // draw the candidates in exploration order
+                    {
+                        auto genValue = m_explorer->nextGenValue();
+                        if (LatBuilder::Shard::owns(candidate, m_explorer->size()) && LatBuilder::Distributed::owns(candidate)) // keep the slice of this process
+                        {
+                            batch.emplace_back(net, std::move(genValue), buffers[batch.size()]);
+                            batchIndices.push_back(candidate);
+                        }
+                        ++candidate;
+                        unsigned long totalSize = m_explorer->size();
+                        LatBuilder::ProgressFeed::setCandidate(m_explorer->count());
+                        if (this->m_verbose>=2 && ((totalSize > 100 && m_explorer->count() % 100 == 0) || (m_explorer->count() % 10 == 0)))
+                        {
+                            std::cout << "Coordinate " << coord + 1 << "/" << this->dimension() << " - net " << m_explorer->count() << "/" << totalSize << std::endl;
+                        }
+                    }
+                    LatBuilder::Trace::Span batchSpan("batch", "search", "candidates", batch.size());
+                    merits.resize(batch.size());
+                    // in the last batch, one more index by worker lets the workers without candidates left speculate
+                    const bool lastBatch = speculative && (ordered ? next >= screened.size() : m_explorer->isOver());
+                    std::mutex guessMutex;
+                    Real guessMerit = this->m_observer->hasFoundNet() ? this->m_observer->bestMerit() : std::numeric_limits<Real>::infinity();
+                    unsigned long long guessIndex = localBest; // best candidate evaluated so far
+                    size_t guessPosition = batch.size(); // its position in the batch, or the size of the batch for the best net of the previous batches
+                    pool.parallelFor(batch.size() + (lastBatch ? pool.size() : 0), [&](unsigned int worker, size_t i)
+                    {
+                        if (i >= batch.size())
+                        {
+                            speculate(*evaluators[worker], speculated[worker], guessMutex, guessIndex, guessPosition, batch, coord, merit);
+                            return;
+                        }
+                        Real screeningMerit = 0;
+                        if (ordered ? !accepts(batchScreeningMerits[i], threshold, screeningMerit) :
+                            !screen(prefilters.empty() ? nullptr : prefilters[worker].get(), batch[i], coord, prefilterMerit, threshold, screeningMerit))
+                        {
+                            merits[i] = std::numeric_limits<Real>::infinity(); // discarded by the screening figure
+                            return;
+                        }
+                        merits[i] = evaluate(*evaluators[worker], batch[i], coord, merit, this->m_verbose-3); // evaluate the net
+                        threshold.lower(merits[i]);
+                        if (lastBatch)
+                        {
+                            // the observer selects the first candidate in exploration order among those of minimal merit
+                            std::lock_guard<std::mutex> lock(guessMutex);
+                            if (merits[i] < guessMerit || (merits[i] == guessMerit && guessIndex != LatBuilder::Distributed::Candidate::none && batchIndices[i] < guessIndex))
+                            {
+                                guessMerit = merits[i];
+                                guessIndex = batchIndices[i];
+                                guessPosition = i;
+                            }
+                        }
+                    });
+                    for(size_t i = 0; i < batch.size(); ++i) // give the nets to the observer in exploration order
+                    {
+                        if (this->m_observer->observe(batch[i], merits[i]))
+                        {
+                            localBest = batchIndices[i];
+                        }
+                    }
+                    observeBatchMerits(merits, detail::ObservesMerits<Explorer>());
+                    this->writePartialResult();
+                    if (budget.exhausted())
+                    {
+                        break;
+                    }
+                    if (reachedLowerBound(lowerBound)) // the candidates of the other processes cannot be better either
+                    {
+                        break;
+                    }
+                }
+                if (LatBuilder::Distributed::size() > 1)
+                {
+                    selectDistributedBest(net, localBest);
+                }
+                if (!this->m_observer->hasFoundNet())
+                {
+                    this->onFailedSearch()(*this); // fails if the search has failed
+                    return;
+                }
+
+                const auto& best = this->m_observer->bestNet();
+                std::vector<Real> bestPrefilterMerits(prefilters.size(), 0);
+                pool.parallelFor(evaluators.size(), [&](unsigned int, size_t i)
+                {
+                    if (localBest == LatBuilder::Distributed::Candidate::none || speculated[i] != localBest)
+                    {
+                        evaluate(*evaluators[i], best, coord, merit); // bring each evaluator to the state of the best net
+                        evaluators[i]->lastNetWasBest();
+                    }
+                    if (!prefilters.empty())
+                    {
+                        prefilters[i]->setSharedMinimum(nullptr); // the screening merit of the best net is required
+                        bestPrefilterMerits[i] = evaluatePrefilter(*prefilters[i], best, coord, prefilterMerit);
+                        prefilters[i]->lastNetWasBest();
+                        prefilters[i]->setSharedMinimum(&threshold);
+                    }
+                });
+                if (!prefilters.empty())
+                {
+                    prefilterMerit = bestPrefilterMerits[0];
+                }
+
+                merit = this->m_observer->bestMerit();
+                if(this->m_verbose>=1)
+                {
+                    std::string netExplored;
+                    if (m_explorer->count() == 1){
+                        netExplored = "1 net";
+                    }
+                    else{
+                        netExplored = std::to_string(m_explorer->count()) + " nets";
+                    }
+                    std::cout << "End coordinate: " << coord + 1 << "/" << this->dimension() << " - " << netExplored << " explored - partial merit value: " << merit << std::endl;
+                }
+                LatBuilder::ProgressFeed::setBestMerit(merit);
+                writeCheckpoint(merit);
+                if (coord + 1 < this->dimension()){ // if at least one dimension remains unexplored
+                    this->m_observer->reset(false);
+                    m_explorer->switchToCoordinate(coord+1);
+                }
+            }
+            writeState(*evaluators[0], prefilters.empty() ? nullptr : prefilters[0].get(), merit, prefilterMerit);
+            this->selectBestNet(this->m_observer->bestNet(), this->m_observer->bestMerit());
+        }
+
+        /**
+         * Brings \c evaluator to the state of the best candidate evaluated so far, of index \c guessIndex in exploration order and
+         * of position \c guessPosition in \c batch, or the best net of the observer if \c guessPosition is the size of the batch,
+         * and records its index in \c speculated. Does nothing if the evaluator already speculated or if no candidate was accepted.
+         * The evaluation may be aborted by a better candidate, in which case the speculation is wrong anyway.
+         */
+        void speculate(EVALUATOR& evaluator, unsigned long long& speculated, std::mutex& guessMutex, const unsigned long long& guessIndex,
+                       const size_t& guessPosition, const std::vector<DigitalNetCandidate<NC>>& batch, Dimension coord, Real merit)
+        {
+            if (speculated != LatBuilder::Distributed::Candidate::none)
+            {
+                return;
+            }
+            unsigned long long index;
+            size_t position;
+            {
+                std::lock_guard<std::mutex> lock(guessMutex);
+                index = guessIndex;
+                position = guessPosition;
+            }
+            if (index == LatBuilder::Distributed::Candidate::none)
+            {
+                return;
+            }
+            if (position < batch.size())
+            {
+                evaluate(evaluator, batch[position], coord, merit);
+            }
+            else
+            {
+                evaluate(evaluator, this->m_observer->bestNet(), coord, merit);
+            }
+            evaluator.lastNetWasBest();
+            speculated = index;
+        }
+
         std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> m_figure;
         std::unique_ptr<Explorer> m_explorer;
+        std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> m_prefilter; // screening figure, if any
+        bool m_screeningOrder = false; // whether the candidates are evaluated in screening order
+        unsigned int m_nThreads; // number of threads used to evaluate the candidates
+        std::string m_checkpointFile; // file written after each completed coordinate
+        std::string m_stateFile; // file to which the states of the evaluators are written at the end of the search
+        std::string m_resumeStateFile; // file from which the states of the evaluators for the base net are read
+
+        /**
+         * Replaces the best candidate found by this process for the coordinate following \c net,
+         * of index \c localBest in exploration order, by the best candidate found by all the processes.
+         */
+        void selectDistributedBest(const DigitalNet<NC>& net, unsigned long long localBest)
+        {
+            LatBuilder::Distributed::Candidate local;
+            if (this->m_observer->hasFoundNet())
+            {
+                local.merit = this->m_observer->bestMerit();
+                local.index = localBest;
+            }
+            const auto best = LatBuilder::Distributed::minimum(local);
+            if (best.index == LatBuilder::Distributed::Candidate::none)
+            {
+                return; // no process has found a net
+            }
+            std::string genValue;
+            if (LatBuilder::Distributed::owns(best.index))
+            {
+                genValue = CheckpointTraits<NC>::format(this->m_observer->bestNet().generatingValue(net.dimension()));
+            }
+            genValue = LatBuilder::Distributed::broadcast(genValue, LatBuilder::Distributed::owner(best.index));
+            this->m_observer->reset(false);
+            this->m_observer->observe(net.appendNewCoordinate(CheckpointTraits<NC>::parse(genValue, net.sizeParameter(), net.dimension())), best.merit);
+        }
+
+        void writeCheckpoint(Real merit) const
+        {
+            LatBuilder::Execution::check(); // the coordinate may not be fully explored
+            if (!m_checkpointFile.empty() && LatBuilder::Distributed::isRoot())
+            {
+                writeCBCCheckpoint(m_checkpointFile, this->m_observer->bestNet(), merit);
+            }
+        }
+
+        /**
+         * Reads the resume state file to \c state if one is set and returns true in that case.
+         * @throw std::runtime_error if the state file was not written for the base net and the figure of merit of the search.
+         */
+        bool readResumeState(CBCState& state)
+        {
+            if (m_resumeStateFile.empty())
+            {
+                return false;
+            }
+            state = CBCState::read(m_resumeStateFile);
+            if (state.figure != m_figure->format())
+            {
+                throw std::runtime_error("the state file " + m_resumeStateFile + " was written for another figure of merit");
+            }
+            if (state.genValues != formatCBCNet(this->observer().bestNet()))
+            {
+                throw std::runtime_error("the state file " + m_resumeStateFile + " was written for another base net");
+            }
+            if (!m_prefilter || state.prefilter != m_prefilter->format())
+            {
+                state.prefilterState.clear(); // the screening figure evaluates the base net
+            }
+            return true;
+        }
+
+        /**
+         * Restores \c evaluator from \c savedState, and returns false if the state is empty or cannot be restored
+         * by the evaluator.
+         */
+        template <class EVAL>
+        static bool restoreState(EVAL& evaluator, const std::string& savedState)
+        {
+            if (savedState.empty())
+            {
+                return false;
+            }
+            std::istringstream is(savedState);
+            return evaluator.loadState(is);
+        }
+
+        /**
+         * Writes the states of \c evaluator and \c prefilter for the selected net to the state file, if one is set.
+         */
+        void writeState(const EVALUATOR& evaluator, const FigureOfMerit::CBCFigureOfMeritEvaluator* prefilter, Real merit, Real prefilterMerit) const
+        {
+            LatBuilder::Execution::check();
+            if (m_stateFile.empty() || !LatBuilder::Distributed::isRoot())
+            {
+                return;
+            }
+            CBCState state;
+            std::ostringstream os;
+            if (!evaluator.saveState(os))
+            {
+                if (this->m_verbose >= 1)
+                {
+                    std::cout << "The evaluator of the figure of merit cannot save its state; no state file is written" << std::endl;
+                }
+                return;
+            }
+            state.evaluatorState = os.str();
+            if (prefilter)
+            {
+                state.prefilter = m_prefilter->format();
+                std::ostringstream prefilterOs;
+                if (prefilter->saveState(prefilterOs))
+                {
+                    state.prefilterState = prefilterOs.str();
+                }
+            }
+            state.figure = m_figure->format();
+            state.genValues = formatCBCNet(this->m_observer->bestNet());
+            state.merit = merit;
+            state.prefilterMerit = prefilterMerit;
+            state.write(m_stateFile);
+        }
+
+        /**
+         * Selects the base net if it already has all the coordinates, as may happen when resuming a search.
+         * Returns true in that case.
+         */
+        bool selectCompleteBaseNet(Real merit)
+        {
+            if (this->observer().bestNet().dimension() < this->dimension())
+            {
+                return false;
+            }
+            this->selectBestNet(this->m_observer->bestNet(), merit);
+            return true;
+        }
 };
 
 }}
@@ -0,0 +1,135 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NETBUILDER__TASK__CBC_STATE_H
+#define NETBUILDER__TASK__CBC_STATE_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/Task/CBCCheckpoint.h"
+
+#include "latbuilder/StateIO.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * State of the evaluators of a CBC search for the net it selected, written by CBCSearch::setStateFile() and read
+ * by CBCSearch::setResumeStateFile(), so that a search extending the net to more coordinates restores the
+ * evaluators instead of evaluating the coordinates of the net again.
+ *
+ * The file is a binary file written with LatBuilder::StateIO: it can only be read on the same architecture
+ * by the same version of the program. It holds the description of the figure of merit and of the screening figure,
+ * the generating values of the net formatted as in the checkpoints (see CheckpointTraits), its merit values and the
+ * states saved by FigureOfMerit::CBCFigureOfMeritEvaluator::saveState(). The state of the screening figure is empty
+ * if it could not be saved.
+ */
+struct CBCState
+{
+    std::string figure; ///< Description of the figure of merit.
+    std::string prefilter; ///< Description of the screening figure, empty if there was none.
+    std::vector<std::string> genValues; ///< Formatted generating values of the net.
+    Real merit = 0; ///< Merit value of the net.
+    Real prefilterMerit = 0; ///< Screening merit value of the net.
+    std::string evaluatorState; ///< State of the evaluator of the figure of merit.
+    std::string prefilterState; ///< State of the evaluator of the screening figure, if any.
+
+    /**
+     * Writes the state to \c fileName, through a temporary file which is then renamed.
+     */
+    void write(const std::string& fileName) const
+    {
+        using LatBuilder::StateIO::write;
+        const std::string tmpFileName = fileName + ".tmp";
+        {
+            std::ofstream file(tmpFileName, std::ios::binary);
+            write(file, magic());
+            write(file, version());
+            write(file, figure);
+            write(file, prefilter);
+            write(file, genValues);
+            write(file, merit);
+            write(file, prefilterMerit);
+            write(file, evaluatorState);
+            write(file, prefilterState);
+            if (!file)
+            {
+                throw std::runtime_error("cannot write state file " + tmpFileName);
+            }
+        }
+        if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+        {
+            throw std::runtime_error("cannot rename " + tmpFileName + " to " + fileName);
+        }
+    }
+
+    /**
+     * Reads a state written by write().
+     * @throw std::runtime_error if the file cannot be read or was not written by write().
+     */
+    static CBCState read(const std::string& fileName)
+    {
+        using LatBuilder::StateIO::read;
+        std::ifstream file(fileName, std::ios::binary);
+        if (!file)
+        {
+            throw std::runtime_error("cannot read state file " + fileName);
+        }
+        CBCState state;
+        try
+        {
+            LatBuilder::StateIO::expect(file, magic(), "not a CBC state file");
+            LatBuilder::StateIO::expect(file, version(), "unsupported version");
+            read(file, state.figure);
+            read(file, state.prefilter);
+            read(file, state.genValues);
+            read(file, state.merit);
+            read(file, state.prefilterMerit);
+            read(file, state.evaluatorState);
+            read(file, state.prefilterState);
+        }
+        catch (const std::runtime_error& e)
+        {
+            throw std::runtime_error("invalid state file " + fileName + ": " + e.what());
+        }
+        return state;
+    }
+
+private:
+    static std::string magic() { return "LatNetBuilder CBC state"; }
+    static std::uint32_t version() { return 1; }
+};
+
+/**
+ * Reads the state file of a CBC search and returns its net, to be used as the base net of the search which
+ * resumes from the state.
+ * @param fileName Name of the state file.
+ * @param sizeParameter Size parameter of the search.
+ */
+template <NetConstruction NC>
+std::unique_ptr<DigitalNet<NC>> readCBCStateNet(const std::string& fileName, const typename NetConstructionTraits<NC>::SizeParameter& sizeParameter)
+{
+    return parseCBCNet<NC>(CBCState::read(fileName).genValues, sizeParameter, fileName);
+}
+
+}}
+
+#endif
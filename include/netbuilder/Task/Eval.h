@@ -21,22 +21,59 @@
 
 #include "netbuilder/Task/Task.h"
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
+#include "netbuilder/Helpers/TValueCache.h"
+#include "netbuilder/Helpers/TValueProfile.h"
+
+#include "latbuilder/Distributed.h"
 
 #include <boost/signals2.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <limits>
+#include <string>
+#include <vector>
 
 namespace NetBuilder { namespace Task {
 
+/**
+ * Evaluation of a net with one or several figures of merit.
+ *
+ * The figures of merit are evaluated one after the other on the same net, which is constructed once. Their merit values
+ * are reported separately (see outputMeritValues()); the merit value of the task is that of the first figure.
+ * The t-values of the projections only depend on the generating matrices, so that the t-value based figures share them
+ * through the TValueCache: if it is disabled, it is enabled with #sharedTValueCapacity entries while several figures are evaluated.
+ * The t-values of all the low-order projections of the net can also be written to a file (see setTValueProfile()).
+ * The binary file of such a profile can be given back with setTValueTable() to evaluate the same net with other weights
+ * or norm types: the t-values of its projections are then stored in the TValueCache before the figures are evaluated,
+ * so that the unilevel t-value figures do not compute them again.
+ */
 class Eval : public Task 
 {
     public:
 
+        /**
+         * Number of projections kept in the TValueCache while several figures are evaluated, if it is disabled.
+         */
+        static constexpr size_t sharedTValueCapacity = 1 << 16;
+
         Eval(std::unique_ptr<AbstractDigitalNet> net, std::unique_ptr<FigureOfMerit::FigureOfMerit> figure, int verbose = 0):
             m_net(std::move(net)),
             m_merit(0),
-            m_figure(std::move(figure)),
+            m_verbose(verbose)
+        {
+            m_figures.push_back(std::move(figure));
+            m_merits.assign(1, 0);
+        };
+
+        /**
+         * Constructor for the evaluation of the net \c net with each figure of merit of \c figures, which must not be empty.
+         */
+        Eval(std::unique_ptr<AbstractDigitalNet> net, std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> figures, int verbose = 0):
+            m_net(std::move(net)),
+            m_merit(0),
+            m_figures(std::move(figures)),
+            m_merits(m_figures.size(), 0),
             m_verbose(verbose)
         {};
 
@@ -66,6 +103,12 @@ class Eval : public Task
         virtual std::string outputNet(OutputStyle outputStyle, unsigned int interlacingFactor) const 
         { return net().format(outputStyle, interlacingFactor); }
 
+        /**
+        * Returns the evaluated net.
+        */
+        virtual const AbstractDigitalNet& resultNet() const 
+        { return net(); }
+
         /**
          *  Returns information about the task
          */
@@ -76,8 +119,18 @@ class Eval : public Task
             stream << "Task: NetBuilder Evaluation" << std::endl;
             stream << "Number of components: " << this->dimension() << std::endl;
             stream << "Evaluation of the net:" << std::endl;
-            stream << m_net->format(OutputStyle::TERMINAL, 1);
-            stream << "Figure of merit: " << m_figure->format() << std::endl;
+            m_net->format(stream, OutputStyle::TERMINAL, 1);
+            if (m_figures.size() == 1)
+            {
+                stream << "Figure of merit: " << m_figures.front()->format() << std::endl;
+            }
+            else
+            {
+                for (size_t i = 0; i < m_figures.size(); ++i)
+                {
+                    stream << "Figure of merit " << i + 1 << ": " << m_figures[i]->format() << std::endl;
+                }
+            }
             res += stream.str();
             stream.str(std::string());
             return res;
@@ -95,9 +148,42 @@ class Eval : public Task
         virtual Real outputMeritValue() const 
         { return meritValue(); }
 
+        /**
+        * Returns the merit value of the net for each figure of merit, in the order of the figures.
+        */
+        virtual std::vector<Real> outputMeritValues() const
+        { return m_merits; }
+
         const FigureOfMerit::FigureOfMerit& figureOfMerit() const 
         {
-               return *m_figure;
+               return *m_figures.front();
+        }
+
+        /**
+        * Returns the number of figures of merit.
+        */
+        size_t numFigures() const
+        { return m_figures.size(); }
+
+        /**
+         * Sets the largest order \c maxOrder of the projections whose t-values are written to the file \c fileName
+         * by execute(), after the evaluation of the figures (see TValueProfile). No profile is computed if \c maxOrder is 0.
+         * If \c binaryFileName is not empty, the profile is also written to it with TValueProfile::writeBinary().
+         */
+        void setTValueProfile(Dimension maxOrder, std::string fileName, std::string binaryFileName = "")
+        {
+            m_profileOrder = maxOrder;
+            m_profileFile = std::move(fileName);
+            m_profileBinaryFile = std::move(binaryFileName);
+        }
+
+        /**
+         * Sets the binary t-value profile of the net, written by TValueProfile::writeBinary(), whose t-values are given to the
+         * figures through the TValueCache. No profile is read if \c fileName is empty.
+         */
+        void setTValueTable(std::string fileName)
+        {
+            m_tableFile = std::move(fileName);
         }
 
         /**
@@ -107,27 +193,62 @@ class Eval : public Task
         */
         virtual void execute() {
 
-            auto evaluator = m_figure->evaluator(); 
-            m_merit = evaluator->operator()(*m_net, m_verbose);
+            const size_t cacheCapacity = TValueCache::capacity();
+            if (!m_tableFile.empty())
+            {
+                const TValueProfile table = TValueProfile::readBinary(m_tableFile);
+                TValueCache::setCapacity(std::max({cacheCapacity, table.entries().size(), sharedTValueCapacity}));
+                table.fillCache(*m_net);
+            }
+            else if (m_figures.size() > 1 && cacheCapacity == 0)
+            {
+                TValueCache::setCapacity(sharedTValueCapacity);
+            }
+            for (size_t i = 0; i < m_figures.size(); ++i)
+            {
+                auto evaluator = m_figures[i]->evaluator(); 
+                m_merits[i] = evaluator->operator()(*m_net, m_verbose);
+            }
+            TValueCache::setCapacity(cacheCapacity);
+            m_merit = m_merits.front();
+
+            if (m_profileOrder > 0)
+            {
+                TValueProfile profile(*m_net, m_profileOrder);
+                if (LatBuilder::Distributed::isRoot())
+                {
+                    profile.write(m_profileFile);
+                    if (!m_profileBinaryFile.empty())
+                    {
+                        profile.writeBinary(m_profileBinaryFile);
+                    }
+                }
+            }
         }
 
         virtual void reset()
         {
             m_merit = 0;
+            m_merits.assign(m_figures.size(), 0);
         }
 
         virtual void reset(std::unique_ptr<AbstractDigitalNet> net)
         {
             m_net = std::move(net);
-            m_merit = 0;
+            reset();
         }
 
     private:
 
         std::unique_ptr<AbstractDigitalNet> m_net;
         Real m_merit;
-        std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
+        std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> m_figures;
+        std::vector<Real> m_merits;
         int m_verbose;
+        Dimension m_profileOrder = 0; // largest order of the projections of the t-value profile, or 0
+        std::string m_profileFile; // file to which the t-value profile is written
+        std::string m_profileBinaryFile; // binary file to which the t-value profile is written, if any
+        std::string m_tableFile; // binary t-value profile whose t-values are stored in the cache, if any
 
 };
 
@@ -18,6 +18,15 @@
 #define NETBUILDER__TASK__EXHAUSTIVE_SEARCH_H
 
 #include "netbuilder/Task/Search.h"
+#include "netbuilder/Helpers/EquivalentNetFilter.h"
+
+#include "latbuilder/ProgressFeed.h"
+#include "latbuilder/Shard.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace NetBuilder { namespace Task {
 
@@ -35,14 +44,18 @@ class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
          * @param figure Figure of merit used to compare nets.
          * @param verbose Verbosity level.
          * @param earlyAbortion Early-abortion switch. If true, the computations will be stopped if the net is worse than the best one so far.
+         * @param nThreads Number of threads used to evaluate the candidate nets. If 0, the number of hardware threads is used.
          */
         ExhaustiveSearch(   Dimension dimension, 
                             typename NetConstructionTraits<NC>::SizeParameter sizeParameter,
                             std::unique_ptr<FigureOfMerit::FigureOfMerit> figure,
                             int verbose = 0,
-                            bool earlyAbortion = false):
+                            bool earlyAbortion = false,
+                            unsigned int nThreads = 1):
             Search<NC, ET, OBSERVER>(dimension, sizeParameter, verbose, earlyAbortion),
-            m_figure(std::move(figure))
+            m_figure(std::move(figure)),
+            m_nThreads(LatBuilder::ThreadPool::resolveNumThreads(nThreads)),
+            m_depthFirst(false)
         {};
 
         /** 
@@ -52,6 +65,25 @@ class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
         ExhaustiveSearch(ExhaustiveSearch&&) = default;
 
 
+        /**
+         * Sets whether the candidate nets equivalent to a net evaluated before are skipped (see EquivalentNetFilter).
+         * Skipping them does not change the selected net.
+         */
+        void setSkipEquivalentNets(bool skip)
+        {
+            m_equivalentNetFilter = skip ? std::make_unique<EquivalentNetFilter>(ET) : nullptr;
+        }
+
+        /**
+         * Sets whether the search space is explored depth first, as a tree whose nodes of depth \c d are the nets of
+         * the first \c d coordinates, by branch and bound (see executeDepthFirst()).
+         * The figure of merit must then be evaluated coordinate by coordinate (see FigureOfMerit::CBCFigureOfMerit).
+         */
+        void setDepthFirst(bool depthFirst)
+        {
+            m_depthFirst = depthFirst;
+        }
+
         /**
          *  Returns information about the task
          */
@@ -60,7 +92,7 @@ class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
             std::string res;
             std::ostringstream stream;
             stream << Search<NC, ET, OBSERVER>::format();
-            stream << "Exploration method: exhaustive" << std::endl;
+            stream << "Exploration method: exhaustive" << (m_depthFirst ? " (depth first, branch and bound)" : "") << std::endl;
             stream << "Figure of merit: " << m_figure->format() << std::endl;
             res += stream.str();
             stream.str(std::string());
@@ -70,32 +102,93 @@ class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
         /**
         * Executes the search task.
         * The best net and merit value are set in the process.
+        * The search space is traversed lazily by batches of nets, which are built in exploration order, evaluated
+        * concurrently by m_nThreads workers with their own evaluators, and given to the observer in exploration order,
+        * so that the selected net does not depend on the number of threads.
+        * If the search is split into shards (see LatBuilder::Shard), only the range of the search space of the shard
+        * of the process is explored.
         */
         virtual void execute() override 
         {
+            if (m_depthFirst)
+            {
+                executeDepthFirst();
+                return;
+            }
 
-            auto evaluator = this->m_figure->evaluator();
+            LatBuilder::ThreadPool& pool = LatBuilder::ThreadPool::shared(m_nThreads);
 
-            
-            if (this->m_earlyAbortion)
+            std::vector<std::unique_ptr<FigureOfMerit::FigureOfMeritEvaluator>> evaluators;
+            for(unsigned int worker = 0; worker < pool.size(); ++worker)
             {
-                evaluator->onProgress().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onProgress, &this->observer(), boost::placeholders::_1));
-                evaluator->onAbort().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onAbort, &this->observer(), boost::placeholders::_1));
+                evaluators.push_back(this->m_figure->evaluator()); // create an evaluator for each worker
+                if (this->m_earlyAbortion)
+                {
+                    evaluators.back()->setSharedMinimum(&this->observer().sharedMinimum());
+                }
             }
             
             auto searchSpace = DigitalNet<NC>::ConstructionMethod::genValueSpace(this->dimension(), this->m_sizeParameter);
+            if (m_equivalentNetFilter)
+            {
+                m_equivalentNetFilter->clear();
+            }
             
+            const auto budget = LatBuilder::Budget::share();
+
+            const size_t batchSize = 16 * pool.size(); // number of nets built at once
+            std::vector<std::unique_ptr<DigitalNet<NC>>> batch;
+            std::vector<Real> merits;
+
             uInteger nbNets = 1;
-            for(const auto& genVal : searchSpace)
+            auto genVal = searchSpace.begin();
+
+            // the shard of the process explores its own range of the search space
+            const uInteger first = LatBuilder::Shard::begin(searchSpace.size());
+            uInteger remaining = LatBuilder::Shard::end(searchSpace.size()) - first;
+            LatBuilder::ProgressFeed::setCandidates(remaining);
+            for(uInteger skipped = 0; skipped < first; ++skipped)
             {
-                if(this->m_verbose>0 && ((searchSpace.size() > 100 && nbNets % 100 == 0) || (nbNets % 10 == 0)))
+                ++genVal;
+            }
+
+            while (genVal != searchSpace.end() && remaining > 0)
+            {
+                batch.clear();
+                for(; genVal != searchSpace.end() && batch.size() < batchSize && remaining > 0; ++genVal, --remaining)
+                {
+                    if(this->m_verbose>0 && ((searchSpace.size() > 100 && nbNets % 100 == 0) || (nbNets % 10 == 0)))
+                    {
+                        std::cout << "Net " << nbNets << "/" << searchSpace.size() << std::endl;
+                    }
+                    nbNets++;
+                    auto net = std::make_unique<DigitalNet<NC>>(this->m_dimension, this->m_sizeParameter, *genVal);
+                    if (m_equivalentNetFilter && m_equivalentNetFilter->seen(*net))
+                    {
+                        continue; // same merit as an equivalent net evaluated before
+                    }
+                    batch.push_back(std::move(net));
+                }
+                merits.resize(batch.size());
+                pool.parallelFor(batch.size(), [&](unsigned int worker, size_t i)
+                {
+                    LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::EVALUATION);
+                    merits[i] = (*evaluators[worker])(*batch[i], this->m_verbose-3);
+                });
+                for(size_t i = 0; i < batch.size(); ++i)
                 {
-                    std::cout << "Net " << nbNets << "/" << searchSpace.size() << std::endl;
+                    this->m_observer->observe(std::move(batch[i]), merits[i]);
+                }
+                LatBuilder::ProgressFeed::setCandidate(nbNets - 1);
+                if (this->m_observer->hasFoundNet())
+                {
+                    LatBuilder::ProgressFeed::setBestMerit(this->m_observer->bestMerit());
+                }
+                this->writePartialResult();
+                if (budget.exhausted())
+                {
+                    break;
                 }
-                nbNets++;
-                auto net = std::make_unique<DigitalNet<NC>>(this->m_dimension, this->m_sizeParameter, genVal);
-                double merit = (*evaluator)(*net, this->m_verbose-3);
-                this->m_observer->observe(std::move(net),merit);
             }
             if (!this->m_observer->hasFoundNet())
             {
@@ -114,7 +207,178 @@ class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
         }
 
     private:
+        typedef typename DigitalNet<NC>::ConstructionMethod::GenValueSpaceCoordSeq GenValueSpaceCoordSeq;
+
+        /**
+         * Executes the search depth first.
+         * The nets of the first \c d coordinates are extended with each generating value of coordinate \c d in
+         * exploration order, and the partial merit value of each extension is computed by a single CBC evaluator from
+         * the state it had for the net it extends. The subtree of an extension is pruned as soon as its partial merit
+         * value is not below the merit of the best net found so far. The partial merit value of a net cannot be above
+         * that of its extensions for the figures of merit whose evaluators abort early, so that the selected net is
+         * that of execute() without depth-first exploration, which evaluates every net.
+         * The state of the evaluator for a net is saved before its subtree is explored and restored afterwards (see
+         * FigureOfMerit::CBCFigureOfMeritEvaluator::saveState()), or rebuilt by evaluating the coordinates of the net
+         * again if the evaluator cannot save its state.
+         * The candidate nets are evaluated in the calling thread, since the exploration depends on the best merit of
+         * the nets before them; the evaluators still use the shared thread pool.
+         * @throw std::invalid_argument if the figure of merit is not evaluated coordinate by coordinate.
+         */
+        void executeDepthFirst()
+        {
+            auto figure = dynamic_cast<FigureOfMerit::CBCFigureOfMerit*>(m_figure.get());
+            if (!figure)
+            {
+                throw std::invalid_argument("the depth-first exhaustive search requires a figure of merit evaluated coordinate by coordinate");
+            }
+            auto evaluator = figure->evaluator();
+            evaluator->setSharedMinimum(&this->observer().sharedMinimum());
+            if (m_equivalentNetFilter)
+            {
+                m_equivalentNetFilter->clear();
+            }
+
+            // generating values of each coordinate and number of nets of the subtrees of each depth
+            m_coordSpaces.clear();
+            m_subtreeSizes.assign(this->dimension() + 1, 1);
+            for(Dimension coord = 0; coord < this->dimension(); ++coord)
+            {
+                m_coordSpaces.push_back(DigitalNet<NC>::ConstructionMethod::genValueSpaceCoord(coord, this->m_sizeParameter));
+            }
+            for(Dimension coord = this->dimension(); coord > 0; --coord)
+            {
+                m_subtreeSizes[coord - 1] = m_subtreeSizes[coord] * m_coordSpaces[coord - 1].size();
+            }
+            LatBuilder::ProgressFeed::setCandidates(m_subtreeSizes[0]);
+
+            const auto budget = LatBuilder::Budget::share();
+            std::vector<std::unique_ptr<DigitalNet<NC>>> prefixes; // nets of the first coordinates of the current node
+            prefixes.push_back(std::make_unique<DigitalNet<NC>>(0, this->m_sizeParameter));
+            uInteger explored = 0;
+            if (this->dimension() > 0)
+            {
+                evaluator->reset();
+                exploreDepthFirst(*evaluator, prefixes, 0, explored, budget);
+            }
+            m_coordSpaces.clear();
+
+            if (!this->m_observer->hasFoundNet())
+            {
+                this->onFailedSearch()(*this);
+                return;
+            }
+            this->selectBestNet(this->m_observer->bestNet(), this->m_observer->bestMerit());
+        }
+
+        /**
+         * Explores the subtree of the net <code>prefixes.back()</code> of partial merit value \c merit, with \c
+         * evaluator in the state of the last coordinate of this net told to be the best, and counts in \c explored the
+         * nets of the subtree which are evaluated or pruned.
+         * Returns \c false if the budget was exhausted.
+         */
+        bool exploreDepthFirst(
+            FigureOfMerit::CBCFigureOfMeritEvaluator& evaluator,
+            std::vector<std::unique_ptr<DigitalNet<NC>>>& prefixes,
+            Real merit,
+            uInteger& explored,
+            const LatBuilder::Budget::Share& budget)
+        {
+            const Dimension coord = prefixes.back()->dimension();
+            const bool leaf = coord + 1 == this->dimension();
+            std::string state; // state of the evaluator for the net of the node, if it can be saved
+            if (!leaf && coord > 0)
+            {
+                std::ostringstream os;
+                if (evaluator.saveState(os))
+                {
+                    state = os.str();
+                }
+            }
+            evaluator.prepareForNextDimension();
+
+            for(const auto& genValue : m_coordSpaces[coord])
+            {
+                auto net = prefixes.back()->appendNewCoordinate(genValue);
+                if (leaf && m_equivalentNetFilter && m_equivalentNetFilter->seen(*net))
+                {
+                    ++explored;
+                    continue; // same merit as an equivalent net evaluated before
+                }
+                Real newMerit;
+                {
+                    LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::EVALUATION);
+                    newMerit = evaluator(*net, coord, merit, this->m_verbose-3);
+                }
+                if (leaf)
+                {
+                    ++explored;
+                    if (this->m_observer->observe(std::move(net), newMerit))
+                    {
+                        LatBuilder::ProgressFeed::setBestMerit(this->m_observer->bestMerit());
+                        this->writePartialResult();
+                    }
+                    LatBuilder::ProgressFeed::setCandidate(explored);
+                    if (budget.exhausted())
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                if (!(newMerit < this->m_observer->bestMerit()))
+                {
+                    explored += m_subtreeSizes[coord + 1]; // no extension can be better than the best net
+                    LatBuilder::ProgressFeed::setCandidate(explored);
+                    continue;
+                }
+                evaluator.lastNetWasBest();
+                prefixes.push_back(std::move(net));
+                const bool more = exploreDepthFirst(evaluator, prefixes, newMerit, explored, budget);
+                prefixes.pop_back();
+                if (!more)
+                {
+                    return false;
+                }
+                restoreState(evaluator, prefixes, state);
+                evaluator.prepareForNextDimension();
+            }
+            return true;
+        }
+
+        /**
+         * Brings \c evaluator back to the state of the last coordinate of the net <code>prefixes.back()</code> told
+         * to be the best, from \c state if it is not empty, otherwise by evaluating the coordinates of the net again.
+         */
+        void restoreState(
+            FigureOfMerit::CBCFigureOfMeritEvaluator& evaluator,
+            const std::vector<std::unique_ptr<DigitalNet<NC>>>& prefixes,
+            const std::string& state)
+        {
+            if (!state.empty())
+            {
+                std::istringstream is(state);
+                if (evaluator.loadState(is))
+                {
+                    return;
+                }
+            }
+            evaluator.reset();
+            evaluator.setSharedMinimum(nullptr); // the best merit may have decreased below the partial merits of the net
+            Real merit = 0;
+            for(Dimension coord = 0; coord < prefixes.back()->dimension(); ++coord)
+            {
+                evaluator.prepareForNextDimension();
+                merit = evaluator(*prefixes[coord + 1], coord, merit);
+                evaluator.lastNetWasBest();
+            }
+            evaluator.setSharedMinimum(&this->observer().sharedMinimum());
+        }
+
         std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
+        unsigned int m_nThreads;
+        bool m_depthFirst; // whether the search space is explored depth first
+        std::unique_ptr<EquivalentNetFilter> m_equivalentNetFilter; // classes of the nets evaluated so far, if equivalent nets are skipped
+        std::vector<GenValueSpaceCoordSeq> m_coordSpaces; // generating values of each coordinate, during a depth-first search
+        std::vector<uInteger> m_subtreeSizes; // number of nets of a subtree of each depth, during a depth-first search
 };
 
 }}
@@ -20,6 +20,10 @@
 #include "netbuilder/Types.h"
 #include "netbuilder/DigitalNet.h"
 
+#include "latbuilder/SharedMinimum.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Budget.h"
+
 #include <boost/signals2.hpp>
 
 #include <memory>
@@ -31,7 +35,11 @@ namespace NetBuilder { namespace Task {
 * Observer of the best figure of merit
 *
 * It allows for truncating the figure if, during its term-by-term evaluation, the partial figure 
-* reaches a value superior to the current minimum value.
+* reaches a value superior to the current minimum value, either through the onProgress() slot or,
+* without any signal dispatch, by giving sharedMinimum() to the evaluators.
+*
+* If a target merit value is set (see LatBuilder::Budget::setTarget()), only the nets with a merit
+* value below the target are observed as best nets, so that the search fails if none is found.
 */
 template <NetConstruction NC>
 class MinimumObserver 
@@ -65,14 +73,16 @@ class MinimumObserver
         };
             
         /** 
-         * Initializes the best observed merit value to infinity, 
+         * Initializes the best observed merit value to the target merit value
+         * (see LatBuilder::Budget::setTarget()), or to infinity if no target is set,
          * sets the found net flag to \c false.
          * Optionally, resets the starting net to the empty net.
          * @param hard Flag indicating if the starting net must be reset to the empty net.
          */
         virtual void reset(bool hard = true) 
         { 
-            m_bestMerit = std::numeric_limits<Real>::infinity();
+            m_bestMerit = LatBuilder::Budget::target();
+            m_sharedMinimum.reset(m_bestMerit);
             m_foundBestNet = false;
             if (hard)
                 m_bestNet = std::make_unique<DigitalNet<NC>>(0, m_bestNet->sizeParameter());
@@ -105,15 +115,19 @@ class MinimumObserver
          */
         virtual bool observe(std::unique_ptr<DigitalNet<NC>> net, const Real& merit)
         {
+                LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::CANDIDATES);
+                LatBuilder::Budget::count();
                 if (merit < m_bestMerit){
                     m_bestMerit = merit;
+                    m_sharedMinimum.lower(merit);
+                    LatBuilder::Budget::reach(merit);
                     m_foundBestNet = true;
                     m_bestNet = std::move(net);
 
                     if (m_verbose>0)
                     {
                         std::cout << "Current merit: " << merit << " (best) with net:" << std::endl;
-                        std::cout << m_bestNet->format(OutputStyle::TERMINAL, 1);
+                        m_bestNet->format(std::cout, OutputStyle::TERMINAL, 1);
                         std::cout << std::endl;
                         std::cout << std::endl;
                     }
@@ -121,17 +135,47 @@ class MinimumObserver
                 }
                 else
                 {
-                    if (m_verbose>0)
+                    if (m_verbose>1)
                     {
                         std::cout << "Current merit: " << merit << " (rejected) with net:" << std::endl;
-                        std::cout << net->format(OutputStyle::TERMINAL, 1);
+                        net->format(std::cout, OutputStyle::TERMINAL, 1);
                         std::cout << std::endl;
                         std::cout << std::endl;
                     }
+                    else if (m_verbose>0)
+                    {
+                        std::cout << "Current merit: " << merit << " (rejected)" << std::endl;
+                    }
                     return false;
                 }
         }
 
+        /** 
+         * Notifies the observer that the merit value of the candidate net \c candidate has been observed.
+         * The candidate is only materialized as a DigitalNet if it becomes the best observed net
+         * (or to be displayed in verbose mode, see printsRejectedNets()).
+         */
+        bool observe(const DigitalNetCandidate<NC>& candidate, const Real& merit)
+        {
+            if (merit < m_bestMerit || printsRejectedNets())
+            {
+                return observe(candidate.materialize(), merit);
+            }
+            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::CANDIDATES); // the materialized candidates are counted by observe(net)
+            LatBuilder::Budget::count();
+            if (m_verbose>0)
+            {
+                std::cout << "Current merit: " << merit << " (rejected)" << std::endl;
+            }
+            return false;
+        }
+
+        /**
+         * Returns whether the rejected nets are displayed. In verbose mode, the best nets are always displayed,
+         * but the rejected ones only from verbosity level 2 on, so that only their merit values are displayed at level 1.
+         */
+        bool printsRejectedNets() const { return m_verbose > 1; }
+
         /**
          * Returns whether the search has found a net.
          */ 
@@ -150,10 +194,16 @@ class MinimumObserver
         void onAbort(const AbstractDigitalNet& net) const
         {};
 
+        /**
+         * Returns the best observed merit value as a shared minimum to be polled by the evaluators.
+         */ 
+        const LatBuilder::SharedMinimum& sharedMinimum() const { return m_sharedMinimum; }
+
         private:
             std::unique_ptr<DigitalNet<NC>> m_bestNet;
             bool m_foundBestNet;
             Real m_bestMerit;
+            LatBuilder::SharedMinimum m_sharedMinimum;
             int m_verbose;
 };
 
@@ -0,0 +1,172 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NETBUILDER__TASK__POLYNOMIAL_FAST_CBC_H
+#define NETBUILDER__TASK__POLYNOMIAL_FAST_CBC_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/DigitalNet.h"
+#include "netbuilder/Task/Task.h"
+#include "netbuilder/FigureOfMerit/CoordUniformFigureOfMerit.h"
+
+#include "latbuilder/CoordUniformFigureOfMerit.h"
+#include "latbuilder/Kernel/PAlphaTilde.h"
+#include "latbuilder/Kernel/RPLR.h"
+#include "latbuilder/Storage.h"
+#include "latbuilder/SizeParam.h"
+#include "latbuilder/Task/FastCBC.h"
+
+#include <functional>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * Fast CBC search for polynomial lattice rules with a coordinate-uniform figure of merit.
+ *
+ * The merit values of all the candidate generating polynomials of a coordinate are computed at once with
+ * the fast CBC of LatBuilder, which relies on fast Fourier transforms over the cyclic group of units modulo
+ * the modulus, instead of evaluating the candidate nets one by one. The modulus must thus be a power of an
+ * irreducible polynomial. The figure of merit is the same as that of the CBC explorations of polynomial nets,
+ * so that both return a net with the same merit value.
+ * @tparam KERNEL Coordinate-uniform kernel (LatBuilder::Kernel::RPLR or LatBuilder::Kernel::PAlphaTilde).
+ */
+template <class KERNEL>
+class PolynomialFastCBC : public Task
+{
+    public:
+
+        /// Figure of merit of LatBuilder.
+        typedef LatBuilder::CoordUniformFigureOfMerit<KERNEL> LatticeFigure;
+
+        /// Fast CBC search of LatBuilder.
+        typedef LatBuilder::Task::FastCBC<LatBuilder::LatticeType::POLYNOMIAL, EmbeddingType::UNILEVEL, KERNEL::suggestedCompression(),
+            LatBuilder::defaultPerLevelOrder<LatBuilder::LatticeType::POLYNOMIAL, EmbeddingType::UNILEVEL>::Order, LatticeFigure> LatticeSearch;
+
+        /**
+         * Constructor.
+         * @param dimension Dimension of the searched net.
+         * @param modulus Modulus of the searched net.
+         * @param figure Coordinate-uniform figure of merit of NetBuilder, whose weights are taken over by the search.
+         * @param verbose Verbosity level.
+         */
+        PolynomialFastCBC(Dimension dimension,
+                          Polynomial modulus,
+                          FigureOfMerit::CoordUniformFigureOfMerit<KERNEL, EmbeddingType::UNILEVEL>& figure,
+                          int verbose = 0):
+            m_dimension(dimension),
+            m_modulus(modulus),
+            m_figureDescription(figure.format()),
+            m_search(typename LatticeSearch::Storage(typename LatticeSearch::Storage::SizeParam(modulus)), dimension, figure.giveLatBuilderFigure()),
+            m_bestNet(0, modulus),
+            m_bestMerit(std::numeric_limits<Real>::infinity())
+        {
+            m_search.setObserverVerbosity(verbose - 2);
+            m_search.onLatticeSelected().connect([this](const LatBuilder::Task::Search<LatBuilder::LatticeType::POLYNOMIAL, EmbeddingType::UNILEVEL>& search)
+            {
+                m_bestNet = DigitalNet<NetConstruction::POLYNOMIAL>(search.bestLattice().dimension(), m_modulus, search.bestLattice().gen());
+                m_bestMerit = search.bestMeritValue();
+                for (const auto& slot : m_onNetSelected)
+                {
+                    slot(*this);
+                }
+            });
+        }
+
+        /**
+         * Executes the search. The best net and merit value are set in the process.
+         */
+        virtual void execute() override
+        { m_search.execute(); }
+
+        /**
+         * Returns the best net found by the search.
+         */
+        const DigitalNet<NetConstruction::POLYNOMIAL>& bestNet() const
+        { return m_bestNet; }
+
+        virtual std::string outputNet(OutputStyle outputStyle, unsigned int interlacingFactor) const override
+        { return m_bestNet.format(outputStyle, interlacingFactor); }
+
+        virtual const AbstractDigitalNet& resultNet() const override
+        { return m_bestNet; }
+
+        virtual std::string format() const override
+        {
+            std::ostringstream stream;
+            stream << "Task: NetBuilder Search - Net Construction : " << NetConstructionTraits<NetConstruction::POLYNOMIAL>::name << std::endl;
+            stream << "Number of components: " << m_dimension << std::endl;
+            stream << "Modulus: " << LatBuilder::IndexOfPolynomial(m_modulus) << std::endl;
+            stream << "Exploration method: CBC - Fast Explorer" << std::endl;
+            stream << "Figure of merit: " << m_figureDescription << std::endl;
+            return stream.str();
+        }
+
+        virtual Real outputMeritValue() const override
+        { return m_bestMerit; }
+
+        virtual void reset() override
+        {
+            m_search.reset();
+            m_bestNet = DigitalNet<NetConstruction::POLYNOMIAL>(0, m_modulus);
+            m_bestMerit = std::numeric_limits<Real>::infinity();
+        }
+
+        /**
+         * Connects \c slot to the selection of the best net of each coordinate.
+         */
+        virtual void connectOnNetSelected(std::function<void (const Task&)> slot) override
+        { m_onNetSelected.push_back(std::move(slot)); }
+
+    private:
+        Dimension m_dimension; // dimension of the search
+        Polynomial m_modulus; // modulus of the searched net
+        std::string m_figureDescription; // description of the figure of merit
+        LatticeSearch m_search; // fast CBC search of LatBuilder
+        DigitalNet<NetConstruction::POLYNOMIAL> m_bestNet; // best net
+        Real m_bestMerit; // best merit
+        std::vector<std::function<void (const Task&)>> m_onNetSelected; // slots called when a net is selected
+};
+
+/**
+ * Returns a fast CBC search for polynomial lattice rules with the figure of merit \c figure, or a null pointer
+ * if it is not a coordinate-uniform figure of merit whose kernel has a fast CBC implementation.
+ * The search takes over the weights of \c figure, which cannot be used afterwards.
+ */
+inline std::unique_ptr<Task> makePolynomialFastCBC(Dimension dimension, Polynomial modulus, FigureOfMerit::CBCFigureOfMerit& figure, int verbose = 0)
+{
+    typedef FigureOfMerit::CoordUniformFigureOfMerit<LatBuilder::Kernel::RPLR, EmbeddingType::UNILEVEL> RPLRFigure;
+    typedef FigureOfMerit::CoordUniformFigureOfMerit<LatBuilder::Kernel::PAlphaTilde, EmbeddingType::UNILEVEL> PAlphaTildeFigure;
+    // the weights of the figure are taken over by the search
+    if (auto rplr = dynamic_cast<RPLRFigure*>(&figure))
+    {
+        return std::make_unique<PolynomialFastCBC<LatBuilder::Kernel::RPLR>>(dimension, modulus, *rplr, verbose);
+    }
+    if (auto pAlpha = dynamic_cast<PAlphaTildeFigure*>(&figure))
+    {
+        return std::make_unique<PolynomialFastCBC<LatBuilder::Kernel::PAlphaTilde>>(dimension, modulus, *pAlpha, verbose);
+    }
+    return nullptr;
+}
+
+}}
+
+#endif
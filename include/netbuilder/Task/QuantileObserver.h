@@ -0,0 +1,179 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NETBUILDER__TASK__QUANTILE_OBSERVER_H
+#define NETBUILDER__TASK__QUANTILE_OBSERVER_H
+
+#include "netbuilder/Task/MinimumObserver.h"
+
+#include "latbuilder/QuantileSketch.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * Observer of the best figure of merit which also gathers the distribution of the observed merit values
+ * and the best alternative nets, in constant memory.
+ *
+ * The merit values are summarized by a LatBuilder::QuantileSketch, and the nets with the \c K smallest
+ * merit values are kept in a bounded heap, ties being resolved in favor of the first observed net. A
+ * candidate net of a CBC search is only materialized if it is kept. The distribution and the kept nets
+ * are cleared on every reset of the observer, hence, for a CBC search, they hold the candidates of the
+ * last coordinate.
+ *
+ * Under early abortion, the merit values of the aborted nets are not computed, so that the distribution
+ * is only meaningful if early abortion is disabled.
+ */
+template <NetConstruction NC>
+class QuantileObserver : public MinimumObserver<NC>
+{
+    public:
+
+        /// Net kept by the observer.
+        struct Alternative {
+            Real merit;
+            unsigned long long index; // rank of the net in the order of observation
+            std::shared_ptr<const DigitalNet<NC>> net;
+
+            bool operator<(const Alternative& other) const
+            { return merit < other.merit || (merit == other.merit && index < other.index); }
+        };
+
+        /**
+         * Constructor.
+         * @param sizeParameter Size parameter of the searched net.
+         * @param verbose Verbosity level.
+         */
+        QuantileObserver(typename NetConstructionTraits<NC>::SizeParameter sizeParameter, int verbose = 0):
+            MinimumObserver<NC>(sizeParameter, verbose)
+        {};
+
+        /**
+         * Constructor.
+         * @param baseNet Net from which to start the search.
+         * @param verbose Verbosity level.
+         */
+        QuantileObserver(std::unique_ptr<DigitalNet<NC>> baseNet, int verbose = 0):
+            MinimumObserver<NC>(std::move(baseNet), verbose)
+        {};
+
+        virtual void reset(bool hard = true) override
+        {
+            MinimumObserver<NC>::reset(hard);
+            m_sketch.clear();
+            m_alternatives.clear();
+            m_numObserved = 0;
+        }
+
+        using MinimumObserver<NC>::reset;
+
+        /**
+         * Sets the number \c K of kept nets. Clears the kept nets.
+         */
+        void setNumAlternatives(size_t numAlternatives)
+        {
+            m_numAlternatives = numAlternatives;
+            m_alternatives.clear();
+        }
+
+        /**
+         * Sets the capacity of the sketch of the merit values, which sets its accuracy
+         * (see LatBuilder::QuantileSketch). Clears the sketch.
+         */
+        void setSketchCapacity(unsigned int k)
+        {
+            m_sketch = LatBuilder::QuantileSketch(k);
+        }
+
+        virtual bool observe(std::unique_ptr<DigitalNet<NC>> net, const Real& merit) override
+        {
+            m_sketch.insert(merit);
+            if (keeps(merit))
+            {
+                keep(std::make_shared<DigitalNet<NC>>(*net), merit);
+            }
+            ++m_numObserved;
+            return MinimumObserver<NC>::observe(std::move(net), merit);
+        }
+
+        /**
+         * Notifies the observer that the merit value of the candidate net \c candidate has been observed.
+         * The candidate is only materialized if it is kept or becomes the best observed net
+         * (or to be displayed in verbose mode).
+         */
+        bool observe(const DigitalNetCandidate<NC>& candidate, const Real& merit)
+        {
+            if (merit < this->bestMerit() || keeps(merit) || this->printsRejectedNets())
+            {
+                return observe(candidate.materialize(), merit);
+            }
+            m_sketch.insert(merit);
+            ++m_numObserved;
+            return MinimumObserver<NC>::observe(candidate, merit); // only counts the candidate
+        }
+
+        /**
+         * Returns the sketch of the observed merit values.
+         */
+        const LatBuilder::QuantileSketch& sketch() const { return m_sketch; }
+
+        /**
+         * Returns the kept nets, from the best to the worst.
+         */
+        std::vector<Alternative> alternatives() const
+        {
+            std::vector<Alternative> res(m_alternatives);
+            std::sort(res.begin(), res.end());
+            return res;
+        }
+
+    private:
+        /**
+         * Returns whether a net of merit value \c merit observed now would be kept.
+         */
+        bool keeps(Real merit) const
+        {
+            if (m_numAlternatives == 0 || !(merit < std::numeric_limits<Real>::infinity()))
+            {
+                return false;
+            }
+            return m_alternatives.size() < m_numAlternatives || Alternative{merit, m_numObserved, nullptr} < m_alternatives.front();
+        }
+
+        void keep(std::shared_ptr<const DigitalNet<NC>> net, Real merit)
+        {
+            if (m_alternatives.size() == m_numAlternatives)
+            {
+                std::pop_heap(m_alternatives.begin(), m_alternatives.end());
+                m_alternatives.pop_back();
+            }
+            m_alternatives.push_back(Alternative{merit, m_numObserved, std::move(net)});
+            std::push_heap(m_alternatives.begin(), m_alternatives.end());
+        }
+
+        LatBuilder::QuantileSketch m_sketch;
+        size_t m_numAlternatives = 0;
+        std::vector<Alternative> m_alternatives; // max-heap of the kept nets
+        unsigned long long m_numObserved = 0;
+};
+
+}}
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "netbuilder/Types.h"
 #include "netbuilder/NetConstructionTraits.h"
+#include "netbuilder/Helpers/GenValuePermutation.h"
 
 #include "latbuilder/LFSR258.h"
 
@@ -29,6 +30,13 @@ namespace NetBuilder { namespace Task {
 
 /**
  * Class to explorer randomly a search space using the CBC search algorithm. 
+ *
+ * If the construction method allows it (see GenValuePermutation), the generating values of each coordinate are
+ * sampled without replacement, by walking a random permutation of their indices, so that no candidate is evaluated
+ * twice and that at most all the generating values of the coordinate are explored.
+ * Otherwise, they are drawn independently.
+ * The key of the permutation of each coordinate is drawn from a stream with a fixed seed, so that all the processes
+ * and threads explore the same sequence of candidates, and that their slices of it are disjoint.
  */ 
 template <NetConstruction NC, EmbeddingType ET>
 class RandomCBCExplorer
@@ -46,9 +54,12 @@ class RandomCBCExplorer
             m_dimension(dimension),
             m_currentCoord(0),
             m_nbTries(nbTries),
+            m_sizeParameter(sizeParameter),
             m_randomGenValueGenerator(std::move(sizeParameter)),
             m_countTries(0)
-        {};
+        {
+            switchToCoordinate(0);
+        };
 
         /**
          * Returns whether current coordinate is fully explored
@@ -63,6 +74,10 @@ class RandomCBCExplorer
          */
         typename ConstructionMethod::GenValue nextGenValue()
         {
+            if (m_permutation.active())
+            {
+                return m_permutation[m_countTries++];
+            }
             m_countTries+= 1;
             return m_randomGenValueGenerator(m_currentCoord);
         }
@@ -82,6 +97,7 @@ class RandomCBCExplorer
         {
             m_currentCoord = coord;
             m_countTries = 0;
+            m_permutation.reset(coord, m_sizeParameter, m_keyGenerator());
         };
 
         size_t size() const
@@ -90,6 +106,10 @@ class RandomCBCExplorer
             {
                 return 1;
             }
+            if (m_permutation.active())
+            {
+                return (size_t) std::min<uint64_t>(m_nbTries, m_permutation.size());
+            }
             return m_nbTries;
         }
 
@@ -107,8 +127,11 @@ class RandomCBCExplorer
         Dimension m_dimension;
         Dimension m_currentCoord;
         unsigned int m_nbTries;
+        typename ConstructionMethod::SizeParameter m_sizeParameter;
         typename ConstructionMethod:: template RandomGenValueGenerator <ET> m_randomGenValueGenerator;
         unsigned int m_countTries;
+        LatBuilder::LFSR258 m_keyGenerator; // keys of the permutations of the coordinates
+        GenValuePermutation<NC> m_permutation;
 
 };
 
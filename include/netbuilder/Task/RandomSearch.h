@@ -18,7 +18,14 @@
 #define NETBUILDER__TASK__RANDOM_SEARCH_H
 
 #include "netbuilder/Task/Search.h"
+#include "netbuilder/Helpers/EquivalentNetFilter.h"
+#include "netbuilder/Helpers/GenValuePermutation.h"
 #include "latbuilder/LFSR258.h"
+#include "latbuilder/ProgressFeed.h"
+#include "latbuilder/Shard.h"
+#include "latbuilder/RandomPermutation.h"
+
+#include <limits>
 
 namespace NetBuilder { namespace Task {
 
@@ -48,7 +55,7 @@ class RandomSearch : public Search<NC, ET, OBSERVER>
             Search<NC, ET, OBSERVER>(dimension, sizeParameter, verbose, earlyAbortion),
             m_figure(std::move(figure)),
             m_nbTries(nbTries),
-            m_randomGenValueGenerator(this->m_sizeParameter)
+            m_randomGenValueGenerator(this->m_sizeParameter, LatBuilder::Shard::randomGenerator())
         {};
     
 
@@ -58,6 +65,15 @@ class RandomSearch : public Search<NC, ET, OBSERVER>
          */
         RandomSearch(RandomSearch&&) = default;
 
+        /**
+         * Sets whether the candidate nets equivalent to a net evaluated before are skipped (see EquivalentNetFilter).
+         * Skipping them does not change the selected net.
+         */
+        void setSkipEquivalentNets(bool skip)
+        {
+            m_equivalentNetFilter = skip ? std::make_unique<EquivalentNetFilter>(ET) : nullptr;
+        }
+
         /**
          *  Returns information about the task
          */
@@ -80,40 +96,92 @@ class RandomSearch : public Search<NC, ET, OBSERVER>
         {
             Search<NC, ET, OBSERVER>::reset();
             this->m_figure->evaluator()->reset();
+            if (m_equivalentNetFilter)
+            {
+                m_equivalentNetFilter->clear();
+            }
         }
 
         /**
         * Executes the search task.
         * The best net and merit value are set in the process.
+        * If the construction method allows it (see GenValuePermutation), the nets are sampled without replacement, by
+        * walking a random permutation of the indices of the nets of the search space, so that no net is evaluated twice.
+        * The permutation is the same for all the shards (see LatBuilder::Shard), and each shard walks its own slice
+        * of it.
+        * Otherwise, the generating values are drawn independently, and the shard of the process draws its share of
+        * the samples from its own random stream.
         */
         virtual void execute() override 
         {
 
             auto evaluator = this->m_figure->evaluator();
+            const bool permuted = setUpPermutation();
+            const uInteger total = permuted ? std::min<uInteger>(m_nbTries, m_netPermutation.size()) : m_nbTries;
+            const uInteger first = LatBuilder::Shard::begin(total);
+            const unsigned int nbTries = (unsigned int) (LatBuilder::Shard::end(total) - first);
 
 
             if (this->m_earlyAbortion)
             {
-                evaluator->onProgress().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onProgress, &this->observer(), boost::placeholders::_1));
-                evaluator->onAbort().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onAbort, &this->observer(), boost::placeholders::_1));
+                evaluator->setSharedMinimum(&this->observer().sharedMinimum());
             }
 
-            for(unsigned int attempt = 1; attempt <= m_nbTries; ++attempt)
+            // the coordinates of the nets are constructed as they are evaluated if the figure can be evaluated coordinate
+            // by coordinate, unless the equivalent nets are skipped, which requires the whole nets
+            auto* cbcEvaluator = m_equivalentNetFilter ? nullptr : dynamic_cast<FigureOfMerit::CBCFigureOfMeritEvaluator*>(evaluator.get());
+
+            const auto budget = LatBuilder::Budget::share();
+            LatBuilder::ProgressFeed::setCandidates(nbTries);
+
+            for(unsigned int attempt = 1; attempt <= nbTries; ++attempt)
             {
-                if(this->m_verbose>0 && ((m_nbTries > 100 && attempt % 100 == 0) || (attempt % 10 == 0)))
+                if(this->m_verbose>0 && ((nbTries > 100 && attempt % 100 == 0) || (attempt % 10 == 0)))
                 {
-                    std::cout << "Net " << attempt << "/" << m_nbTries << std::endl;
+                    std::cout << "Net " << attempt << "/" << nbTries << std::endl;
                 }
                 std::vector<typename ConstructionMethod::GenValue> genVals;
                 genVals.reserve(this->dimension());
+                uint64_t index = permuted ? m_netPermutation(first + attempt - 1) : 0;
                 for(Dimension dim = 0; dim < this->dimension(); ++dim)
                 {
+                    if (permuted && m_permutations[dim].active())
+                    {
+                        genVals.push_back(m_permutations[dim][index % m_permutations[dim].size()]);
+                        index /= m_permutations[dim].size();
+                        continue;
+                    }
                     auto tmp = m_randomGenValueGenerator(dim);
                     genVals.push_back(std::move(tmp));
                 }
-                auto net = std::make_unique<DigitalNet<NC>>(this->m_dimension, this->m_sizeParameter, std::move(genVals));
-                double merit = (*evaluator)(*net,this->m_verbose-3);
+                std::unique_ptr<DigitalNet<NC>> net;
+                double merit;
+                if (cbcEvaluator)
+                {
+                    net = evaluateByCoordinate(*cbcEvaluator, genVals, merit);
+                }
+                else
+                {
+                    net = std::make_unique<DigitalNet<NC>>(this->m_dimension, this->m_sizeParameter, std::move(genVals));
+                    if (m_equivalentNetFilter && m_equivalentNetFilter->seen(*net))
+                    {
+                        LatBuilder::ProgressFeed::setCandidate(attempt);
+                        continue; // same merit as an equivalent net evaluated before
+                    }
+                    LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::EVALUATION);
+                    merit = (*evaluator)(*net,this->m_verbose-3);
+                }
                 this->m_observer->observe(std::move(net),merit);
+                LatBuilder::ProgressFeed::setCandidate(attempt);
+                if (this->m_observer->hasFoundNet())
+                {
+                    LatBuilder::ProgressFeed::setBestMerit(this->m_observer->bestMerit());
+                }
+                this->writePartialResult();
+                if (budget.exhausted())
+                {
+                    break;
+                }
             }
             if (!this->m_observer->hasFoundNet())
             {
@@ -132,9 +200,75 @@ class RandomSearch : public Search<NC, ET, OBSERVER>
         }
 
     private:
+        /**
+         * Evaluates the net with generating values \c genVals coordinate by coordinate with \c evaluator, constructing
+         * the generating matrix of each coordinate only when it is evaluated, so that the coordinates after an early
+         * abortion are not constructed. The merit value is stored in \c merit.
+         * Returns the net of the evaluated coordinates, completed with the other ones only if the rejected nets are displayed.
+         */
+        std::unique_ptr<DigitalNet<NC>> evaluateByCoordinate(
+            FigureOfMerit::CBCFigureOfMeritEvaluator& evaluator,
+            const std::vector<typename ConstructionMethod::GenValue>& genVals,
+            double& merit) const
+        {
+            auto net = std::make_unique<DigitalNet<NC>>(0, this->m_sizeParameter);
+            {
+                LatBuilder::Profiler::Scope scope(LatBuilder::Profiler::Timer::EVALUATION);
+                merit = evaluator.evaluateByCoordinate(this->dimension(), [&](Dimension coord) -> const AbstractDigitalNet& {
+                    net = net->appendNewCoordinate(genVals[coord]);
+                    return *net;
+                }, this->m_verbose-3);
+            }
+            if (this->m_verbose > 1)
+            {
+                for(Dimension coord = net->dimension(); coord < this->dimension(); ++coord)
+                {
+                    net = net->appendNewCoordinate(genVals[coord]);
+                }
+            }
+            return net;
+        }
+
+        /**
+         * Sets up the permutations of the generating values of the coordinates and of the indices of the nets, whose
+         * digits in the mixed radix of the numbers of generating values of the coordinates are the indices of their
+         * generating values.
+         * Returns \c false if the nets cannot be sampled without replacement.
+         */
+        bool setUpPermutation()
+        {
+            LatBuilder::LFSR258 keyGenerator; // same keys for all the shards
+            m_permutations.clear();
+            m_permutations.resize(this->dimension());
+            uint64_t size = 1;
+            for(Dimension dim = 0; dim < this->dimension(); ++dim)
+            {
+                if (!m_permutations[dim].reset(dim, this->m_sizeParameter, keyGenerator()))
+                {
+                    if (ConstructionMethod::hasSpecialFirstCoordinate && dim == 0)
+                    {
+                        continue; // single generating value
+                    }
+                    m_permutations.clear();
+                    return false;
+                }
+                if (m_permutations[dim].size() > std::numeric_limits<uint64_t>::max() / size)
+                {
+                    m_permutations.clear();
+                    return false;
+                }
+                size *= m_permutations[dim].size();
+            }
+            m_netPermutation = LatBuilder::RandomPermutation(size, keyGenerator());
+            return true;
+        }
+
         std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
         unsigned int m_nbTries;
         typename ConstructionMethod:: template RandomGenValueGenerator <ET> m_randomGenValueGenerator;
+        std::vector<GenValuePermutation<NC>> m_permutations; // generating values of the coordinates, if nets are sampled without replacement
+        LatBuilder::RandomPermutation m_netPermutation; // indices of the nets, if nets are sampled without replacement
+        std::unique_ptr<EquivalentNetFilter> m_equivalentNetFilter; // classes of the nets evaluated so far, if equivalent nets are skipped
 };
 
 }}
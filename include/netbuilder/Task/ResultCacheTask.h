@@ -0,0 +1,134 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NETBUILDER__TASK__RESULT_CACHE_TASK_H
+#define NETBUILDER__TASK__RESULT_CACHE_TASK_H
+
+#include "netbuilder/Types.h"
+#include "netbuilder/ResultCache.h"
+#include "netbuilder/Task/Task.h"
+#include "netbuilder/Task/CBCCheckpoint.h"
+
+#include "latbuilder/Profiler.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * Task answered from a ResultCache when possible.
+ *
+ * The key of the task is its description (see ResultCache::read()) followed by the output of Task::format(),
+ * which describes the parsed task: the weights, the figure of merit, the exploration method and the size of the net.
+ * If the cache holds an entry of the same key, execute() does nothing and the net and the merit values are those of
+ * the entry. Otherwise, execute() executes the task and writes its result to the cache.
+ */
+template <NetConstruction NC>
+class ResultCacheTask : public Task
+{
+public:
+    /**
+     * Constructor.
+     * @param task Task answered from the cache.
+     * @param cache Cache of the results.
+     * @param description Description of the task, without its dimension.
+     * @param dimension Dimension of the task.
+     * @param sizeParameter Size parameter of the net.
+     */
+    ResultCacheTask(std::unique_ptr<Task> task, ResultCache cache, std::string description, Dimension dimension,
+                    typename NetConstructionTraits<NC>::SizeParameter sizeParameter):
+        m_task(std::move(task)),
+        m_cache(std::move(cache)),
+        m_description(std::move(description)),
+        m_dimension(dimension),
+        m_key(m_description + m_task->format())
+    {
+        ResultCache::Entry entry;
+        if (m_cache.read(m_description, m_dimension, entry) && entry.key == m_key && !entry.merits.empty())
+        {
+            m_net = parseCBCNet<NC>(entry.genValues, sizeParameter, "the result cache " + m_cache.directory());
+            m_merits = std::move(entry.merits);
+        }
+    }
+
+    /**
+     * Returns \c true if the result of the task was read from the cache.
+     */
+    bool cached() const
+    { return m_net != nullptr; }
+
+    virtual void execute() override
+    {
+        LatBuilder::Profiler::count(cached() ? LatBuilder::Profiler::Counter::RESULT_CACHE_HITS : LatBuilder::Profiler::Counter::RESULT_CACHE_MISSES);
+        if (cached())
+        {
+            std::cout << "Result read from the cache " << m_cache.directory() << std::endl;
+            return;
+        }
+        m_task->execute();
+        const auto net = dynamic_cast<const DigitalNet<NC>*>(&m_task->resultNet());
+        if (!net)
+        {
+            return;
+        }
+        ResultCache::Entry entry;
+        entry.key = m_key;
+        entry.genValues = formatCBCNet(*net);
+        entry.merits = m_task->outputMeritValues();
+        m_cache.write(m_description, m_dimension, entry);
+    }
+
+    virtual std::string outputNet(OutputStyle outputStyle, unsigned int interlacingFactor) const override
+    { return cached() ? m_net->format(outputStyle, interlacingFactor) : m_task->outputNet(outputStyle, interlacingFactor); }
+
+    virtual const AbstractDigitalNet& resultNet() const override
+    { return cached() ? *m_net : m_task->resultNet(); }
+
+    virtual std::string format() const override
+    { return m_task->format(); }
+
+    virtual Real outputMeritValue() const override
+    { return cached() ? m_merits.front() : m_task->outputMeritValue(); }
+
+    virtual std::vector<Real> outputMeritValues() const override
+    { return cached() ? m_merits : m_task->outputMeritValues(); }
+
+    virtual void reset() override
+    { m_task->reset(); }
+
+    virtual void connectOnNetSelected(std::function<void (const Task&)> slot) override
+    { m_task->connectOnNetSelected(std::move(slot)); }
+
+    virtual void setPartialResultFile(std::string fileName, OutputStyle outputStyle, unsigned int interlacingFactor, Real period) override
+    { m_task->setPartialResultFile(std::move(fileName), outputStyle, interlacingFactor, period); }
+
+private:
+    std::unique_ptr<Task> m_task;
+    ResultCache m_cache;
+    std::string m_description;
+    Dimension m_dimension;
+    std::string m_key;
+    std::unique_ptr<DigitalNet<NC>> m_net; // resulting net read from the cache, if any
+    std::vector<Real> m_merits;
+};
+
+}}
+
+#endif
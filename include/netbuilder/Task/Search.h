@@ -21,8 +21,14 @@
 #include "netbuilder/Task/MinimumObserver.h"
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
 
+#include "latbuilder/Budget.h"
+#include "latbuilder/Distributed.h"
+#include "latbuilder/ProgressFeed.h"
 #include "latbuilder/Util.h"
 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <ostream>
 #include <memory>
 
@@ -179,6 +185,12 @@ public:
     virtual std::string outputNet(OutputStyle outputStyle, unsigned int interlacingFactor) const override
     { return bestNet().format(outputStyle, interlacingFactor); }
 
+    /**
+     *  Returns the best net found by the search task.
+     */
+    virtual const AbstractDigitalNet& resultNet() const override
+    { return bestNet(); }
+
     /**
      *  Returns information about the task
      */
@@ -227,6 +239,12 @@ public:
     const OnNetSelected& onNetSelected() const
     { return *m_onNetSelected; }
 
+    /**
+     * Connects \c slot to the net-selected signal.
+     */
+    virtual void connectOnNetSelected(std::function<void (const Task&)> slot) override
+    { onNetSelected().connect([slot](const Search& search) { slot(search); }); }
+
     /**
      * Failed search signal.
      * Emitted when no net has been selected by the search algorithm.
@@ -241,6 +259,19 @@ public:
     const OnFailedSearch& onFailedSearch() const
     { return *m_onFailedSearch; }
 
+    /**
+     * Sets the file to which the search writes the best net observed so far while it runs,
+     * at most every \c period seconds. No partial result is written if \c fileName is empty.
+     * In an MPI job, only the root process writes the partial results.
+     */
+    virtual void setPartialResultFile(std::string fileName, OutputStyle outputStyle, unsigned int interlacingFactor, Real period) override
+    {
+        m_partialResultFile = std::move(fileName);
+        m_partialResultStyle = outputStyle;
+        m_partialResultInterlacing = interlacingFactor;
+        m_partialResultPeriod = period;
+    }
+
     /** 
      * Returns a const qualified reference to the figure of merit. 
      */
@@ -260,9 +291,38 @@ public:
         {
             m_bestNet = net;
             m_bestMerit = merit;
+            LatBuilder::ProgressFeed::setBestMerit(merit);
             onNetSelected()(*this);
         }
 
+        /**
+         * Writes the best net observed so far to the partial result file, if the period has elapsed
+         * since the last write. Meant to be called by the searches after each observed net.
+         */
+        void writePartialResult()
+        {
+            if (m_partialResultFile.empty() || !m_observer->hasFoundNet() || !LatBuilder::Distributed::isRoot())
+            {
+                return;
+            }
+            const auto now = std::chrono::steady_clock::now();
+            if (now < m_nextPartialResult)
+            {
+                return;
+            }
+            m_nextPartialResult = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<Real>(m_partialResultPeriod));
+
+            // written to a temporary file which is then renamed, so that the file is always complete
+            const std::string tmpFile = m_partialResultFile + ".tmp";
+            {
+                std::ofstream file(tmpFile);
+                file << "# Partial result after " << LatBuilder::Budget::elapsed() << " seconds and " << LatBuilder::Budget::evaluations() << " nets" << std::endl;
+                file << "# Merit: " << m_observer->bestMerit() << std::endl;
+                m_observer->bestNet().format(file, m_partialResultStyle, m_partialResultInterlacing);
+            }
+            std::rename(tmpFile.c_str(), m_partialResultFile.c_str());
+        }
+
         std::unique_ptr<OnNetSelected> m_onNetSelected; // onNetSelected signal
         std::unique_ptr<OnFailedSearch> m_onFailedSearch; // onFailedSearch signal
         Dimension m_dimension; // dimension of the search
@@ -274,6 +334,11 @@ public:
         std::unique_ptr<Observer> m_observer; // minimum observer
         int m_verbose; // verbosity level
         bool m_earlyAbortion; // early abortion switch
+        std::string m_partialResultFile; // file of the best net observed so far
+        OutputStyle m_partialResultStyle = OutputStyle::TERMINAL; // output style of the partial results
+        unsigned int m_partialResultInterlacing = 1; // interlacing factor of the partial results
+        Real m_partialResultPeriod = 0; // minimum number of seconds between two partial results
+        std::chrono::steady_clock::time_point m_nextPartialResult; // time after which the next partial result is written
         
 };
 
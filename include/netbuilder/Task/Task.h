@@ -21,8 +21,13 @@
 #include "netbuilder/Types.h"
 #include "netbuilder/NetConstructionTraits.h"
 
+#include "latbuilder/Execution.h"
+
+#include <functional>
 #include <ostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace NetBuilder { namespace Task {
 
@@ -43,6 +48,11 @@ public:
      */ 
     virtual std::string outputNet(OutputStyle outputStyle, unsigned int interlacingFactor) const = 0;
 
+    /**
+     * Returns the resulting net of the task.
+     */ 
+    virtual const AbstractDigitalNet& resultNet() const = 0;
+
     /**
      * Output information about the task.
      */ 
@@ -53,12 +63,46 @@ public:
      */ 
     virtual Real outputMeritValue() const = 0;
 
+    /**
+     * Outputs the resulting merit values of the task, one by figure of merit, for the tasks which evaluate
+     * several figures. Returns the single value of outputMeritValue() by default.
+     */ 
+    virtual std::vector<Real> outputMeritValues() const
+    { return {outputMeritValue()}; }
+
     /**
      * Resets the task.
      */ 
     virtual void reset() = 0;
+
+    /**
+     * Connects \c slot to the signal emitted each time the task selects a new
+     * best net, for the tasks which emit one (the searches). Does nothing by
+     * default.
+     */
+    virtual void connectOnNetSelected(std::function<void (const Task&)> slot)
+    {}
+
+    /**
+     * Sets the file to which the task writes the best net found so far while
+     * it runs, at most every \c period seconds, for the tasks which explore
+     * nets (the searches). Does nothing by default.
+     */
+    virtual void setPartialResultFile(std::string fileName, OutputStyle outputStyle, unsigned int interlacingFactor, Real period)
+    {}
 };
 
+/**
+ * Reports the nets selected by \c task to the progress of \c execution (see LatBuilder::AsyncTask).
+ */
+inline void connectProgress(Task& task, std::shared_ptr<LatBuilder::Execution> execution)
+{
+    task.connectOnNetSelected([execution](const Task& selected)
+    {
+        execution->select(selected.resultNet().dimension(), selected.outputMeritValue());
+    });
+}
+
 }}
 
 #endif
@@ -0,0 +1,142 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef NETBUILDER__TASK__TOP_K_OBSERVER_H
+#define NETBUILDER__TASK__TOP_K_OBSERVER_H
+
+#include "netbuilder/Types.h"
+
+#include "latbuilder/Budget.h"
+#include "latbuilder/Profiler.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace NetBuilder { namespace Task {
+
+/**
+ * Observer of the \c K best merit values.
+ *
+ * The candidates are identified by their index in exploration order. The observer keeps the \c K
+ * candidates with the smallest merit values in a bounded heap; ties are resolved in favor of the
+ * smallest index, so that the kept candidates do not depend on how the candidates are evaluated
+ * as long as they are observed in exploration order. With <tt>K = 1</tt>, the observer keeps the
+ * same candidate as MinimumObserver.
+ */
+class TopKObserver
+{
+    public:
+
+        /// Candidate kept by the observer.
+        struct Entry {
+            Real merit;
+            unsigned long long index;
+
+            bool operator<(const Entry& other) const
+            { return merit < other.merit || (merit == other.merit && index < other.index); }
+        };
+
+        /**
+         * Constructor.
+         * @param capacity Number \c K of kept candidates.
+         */
+        explicit TopKObserver(size_t capacity):
+            m_capacity(capacity)
+        {
+            if (capacity == 0)
+            {
+                throw std::invalid_argument("TopKObserver: the number of kept candidates must be positive");
+            }
+            m_heap.reserve(capacity);
+        }
+
+        /**
+         * Forgets the kept candidates.
+         */
+        void reset()
+        {
+            m_heap.clear();
+        }
+
+        /**
+         * Notifies the observer that the candidate of index \c index has the merit value \c merit.
+         * Returns \c true if the candidate is kept.
+         */
+        bool observe(unsigned long long index, Real merit)
+        {
+            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::CANDIDATES);
+            LatBuilder::Budget::count();
+            const Entry entry{merit, index};
+            if (!full())
+            {
+                if (!(merit < std::numeric_limits<Real>::infinity())) // aborted candidates are never kept
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                if (!(entry < m_heap.front()))
+                {
+                    return false;
+                }
+                std::pop_heap(m_heap.begin(), m_heap.end());
+                m_heap.pop_back();
+            }
+            m_heap.push_back(entry);
+            std::push_heap(m_heap.begin(), m_heap.end());
+            return true;
+        }
+
+        /**
+         * Returns whether \c K candidates are kept.
+         */
+        bool full() const { return m_heap.size() == m_capacity; }
+
+        /**
+         * Returns the number of kept candidates.
+         */
+        size_t size() const { return m_heap.size(); }
+
+        /**
+         * Returns the largest merit value of the kept candidates if \c K candidates are kept, infinity otherwise.
+         * A candidate with a larger merit value cannot be kept.
+         */
+        Real worstMerit() const
+        {
+            return full() ? m_heap.front().merit : std::numeric_limits<Real>::infinity();
+        }
+
+        /**
+         * Returns the kept candidates, from the best to the worst.
+         */
+        std::vector<Entry> entries() const
+        {
+            std::vector<Entry> res(m_heap);
+            std::sort(res.begin(), res.end());
+            return res;
+        }
+
+    private:
+        size_t m_capacity;
+        std::vector<Entry> m_heap; // max-heap of the kept candidates
+};
+
+}}
+
+#endif
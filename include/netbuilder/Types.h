@@ -40,11 +40,11 @@ namespace NetBuilder
 /// Scalar unsigned integer .
 typedef unsigned long uInteger;
 
-/// Scalar floating-point type.
-typedef double Real;
+/// Scalar floating-point type (see LatBuilder::Real).
+typedef LatBuilder::Real Real;
 
-/// Vector of floating-point values.
-typedef boost::numeric::ublas::vector<Real> RealVector;
+/// Vector of floating-point values (see LatBuilder::RealVector).
+typedef LatBuilder::RealVector RealVector;
 
 /// Merit value type.
 typedef Real MeritValue;
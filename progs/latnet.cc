@@ -15,11 +15,33 @@
 // limitations under the License.
 
 #include <boost/program_options.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "netbuilder/Helpers/Path.h"
 #include "latbuilder/LatBuilder.h"
 #include "netbuilder/NetBuilder.h"
+#include "latbuilder/Distributed.h"
+#include "latbuilder/Checkpoint.h"
+#include "latbuilder/CpuDispatch.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Kernel/ValueCache.h"
+#include "latbuilder/Shard.h"
+#include "latbuilder/Parser/Common.h"
 
 #ifndef LATNETBUILDER_VERSION
 #define LATNETBUILDER_VERSION "(unkown version)"
@@ -34,6 +56,31 @@ makeOptionsDescription()
     desc.add_options()
     ("help,h", "produce help message")
     ("version", "show version")
+    ("server",
+        "run as a server reading one command per line on the standard input; each command is a JSON object\n"
+        "  {\"id\": ..., \"args\": [\"--set-type\", ...]}\n"
+        "with the command-line arguments, and is answered on one line of the standard output by a JSON object\n"
+        "  {\"id\": ..., \"status\": \"ok\"|\"error\", \"message\": ..., \"output\": ...}\n"
+        "the data tables are loaded only once for all the commands; a line\n"
+        "  {\"id\": ..., \"metrics\": true}\n"
+        "is answered at once, even while a command runs, with the metrics of the server in the text format of "
+        "Prometheus as output")
+    ("metrics-file", po::value<std::string>(),
+        "with --server, file to which the metrics of the server are written periodically in the text format of "
+        "Prometheus, for instance for the textfile collector of its node exporter")
+    ("metrics-period", po::value<double>()->default_value(10.0),
+        "with --metrics-file, period in seconds of the writing of the metrics")
+    ("jobs", po::value<std::string>(),
+        "run in one process the commands of the JSON file given as argument, of the form\n"
+        "  {\"jobs\": [{\"id\": ..., \"args\": [\"--set-type\", ...]}, ...]}\n"
+        "one after the other, grouped by set type, construction and size parameter so that the consecutive commands "
+        "share the tables of the storages, the kernel values and the FFT plans; each command is answered on one line "
+        "of the standard output as with --server")
+    ("merge-shards", po::value<std::vector<std::string>>()->multitoken(),
+        "combine the files shard.txt written by the shards of a search split with --shard, given as arguments, "
+        "into the checkpoint file of the best candidate, which can be given to --base-net to search the next coordinate")
+    ("merge-output", po::value<std::string>()->default_value("merged.txt"),
+        "checkpoint file written by --merge-shards")
     ("set-type,t", po::value<std::string>(),
         "(required) point set type; possible values:\n"
         "  lattice\n"
@@ -42,53 +89,521 @@ makeOptionsDescription()
     return desc;
 }
 
-int main(int argc, const char *argv[])
+/**
+ * Combines the results of the shards of a search into the checkpoint file \c outputFile.
+ */
+int mergeShards(const std::vector<std::string>& shardFiles, const std::string& outputFile)
+{
+    std::vector<LatBuilder::Shard::Result> results;
+    for (const auto& shardFile : shardFiles)
+    {
+        results.push_back(LatBuilder::Shard::Result::read(shardFile));
+    }
+    const auto best = LatBuilder::Shard::merge(results);
+
+    LatBuilder::Checkpoint checkpoint;
+    checkpoint.merit = best.merit;
+    checkpoint.genValues = best.genValues;
+    checkpoint.write(outputFile);
+
+    std::cout << "Best candidate found by shard " << best.index << "/" << best.count << std::endl;
+    std::cout << "Merit value: " << best.merit << std::endl;
+    std::cout << "Generating values:" << std::endl;
+    for (const auto& genValue : best.genValues)
+    {
+        std::cout << "  " << genValue << std::endl;
+    }
+    std::cout << "Written to: " << outputFile << std::endl;
+    return 0;
+}
+
+/**
+ * Runs a single command without exiting on errors.
+ */
+int run(int argc, const char *argv[])
 {
+    namespace po = boost::program_options;
+
+    auto desc = makeOptionsDescription();
+
+    po::variables_map opt;
+    // po::store(po::parse_command_line(argc, argv, desc), opt);
+    po::store(po::command_line_parser(argc, argv).options(desc).allow_unregistered().run(), opt);
+    po::notify(opt);
+
+    if (opt.count("help") && opt.count("set-type") < 1)
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    if (opt.count("version"))
+    {
+        std::cout << "LatNet Builder " << LATNETBUILDER_VERSION << std::endl;
+        std::cout << "Instruction sets of the kernels: " << LatBuilder::cpuDispatchDescription() << std::endl;
+        return 0;
+    }
+
+    if (opt.count("merge-shards"))
+    {
+        return mergeShards(opt["merge-shards"].as<std::vector<std::string>>(), opt["merge-output"].as<std::string>());
+    }
+
+    if (opt.count("set-type") < 1)
+    {
+        throw std::runtime_error("point set type must be specified; see --help");
+    }
+    if (opt["set-type"].as<std::string>() == "lattice")
+    {
+        return LatBuilder::run(argc, argv);
+    }
+    else if (opt["set-type"].as<std::string>() == "net")
+    {
+        return NetBuilder::run(argc, argv);
+    }
+    else
+    {
+        throw std::runtime_error("point set type not recognized; see --help");
+    }
+}
+
+/**
+ * Runs the command of \c request and returns the response.
+ *
+ * The standard output of the command is captured and returned in the
+ * response.
+ */
+boost::property_tree::ptree execute(const boost::property_tree::ptree& request, const char* programName)
+{
+    namespace pt = boost::property_tree;
+
+    pt::ptree response;
+    response.put("id", request.get<std::string>("id", ""));
+    std::ostringstream output;
+    auto stdoutBuffer = std::cout.rdbuf(output.rdbuf());
     try
     {
-        NetBuilder::SET_PATH_TO_LATNETBUILDER_DIR_FROM_PROGRAM_NAME(argv[0]);
-        namespace po = boost::program_options;
+        std::vector<std::string> args{programName};
+        for (const auto& arg : request.get_child("args"))
+        {
+            args.push_back(arg.second.data());
+        }
+        std::vector<const char*> argv;
+        for (const auto& arg : args)
+        {
+            argv.push_back(arg.c_str());
+        }
+        argv.push_back(nullptr);
+
+        run((int) args.size(), argv.data());
+        response.put("status", "ok");
+    }
+    catch (LatBuilder::Parser::ParserError& e)
+    {
+        response.put("status", "error");
+        response.put("message", std::string("COMMAND LINE ERROR: ") + e.what());
+    }
+    catch (std::exception& e)
+    {
+        response.put("status", "error");
+        response.put("message", std::string("ERROR: ") + e.what());
+    }
+    std::cout.rdbuf(stdoutBuffer);
 
-        auto desc = makeOptionsDescription();
+    response.put("output", output.str());
+    return response;
+}
 
-        po::variables_map opt;
-        // po::store(po::parse_command_line(argc, argv, desc), opt);
-        po::store(po::command_line_parser(argc, argv).options(desc).allow_unregistered().run(), opt);
-        po::notify(opt);
+/**
+ * State of the server reported by its metrics.
+ *
+ * The counters are atomic, so that the metrics are read while a command runs.
+ */
+struct ServerState
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::atomic<unsigned long long> queued{0}; ///< Commands waiting to run.
+    std::atomic<unsigned long long> running{0}; ///< Commands running (0 or 1).
+    std::atomic<unsigned long long> succeeded{0};
+    std::atomic<unsigned long long> failed{0};
+};
+
+/**
+ * Number of candidates at a given time, from which the metrics compute the
+ * candidates evaluated per second until the next sample.
+ */
+struct RateSample
+{
+    std::chrono::steady_clock::time_point time = std::chrono::steady_clock::now();
+    unsigned long long candidates = 0;
+};
+
+/**
+ * Writes the metrics of the server to \c os in the text format of Prometheus:
+ * the totals of the profiler (see LatBuilder::Profiler::writeMetrics()) and
+ * the state of the server.  The number of candidates per second is computed
+ * since \c sample, which is then updated.
+ */
+void writeMetrics(std::ostream& os, const ServerState& state, RateSample& sample)
+{
+    using LatBuilder::Profiler;
+
+    Profiler::writeMetrics(os);
+
+    const auto now = std::chrono::steady_clock::now();
+    const auto candidates = Profiler::totalValue(Profiler::Counter::CANDIDATES);
+    const double interval = std::chrono::duration<double>(now - sample.time).count();
+    const double rate = interval > 0 ? (candidates - sample.candidates) / interval : 0.0;
+    sample.time = now;
+    sample.candidates = candidates;
+
+    const auto flags = os.flags();
+    os << std::fixed;
+    os << "# HELP latnetbuilder_candidates_per_second Candidates evaluated per second since the previous sample." << std::endl;
+    os << "# TYPE latnetbuilder_candidates_per_second gauge" << std::endl;
+    os << "latnetbuilder_candidates_per_second " << rate << std::endl;
+    os << "# HELP latnetbuilder_kernel_cache_bytes Size of the kernel values kept in memory." << std::endl;
+    os << "# TYPE latnetbuilder_kernel_cache_bytes gauge" << std::endl;
+    os << "latnetbuilder_kernel_cache_bytes " << LatBuilder::Kernel::ValueCache::size() << std::endl;
+    os << "# HELP latnetbuilder_queue_depth Commands waiting to run." << std::endl;
+    os << "# TYPE latnetbuilder_queue_depth gauge" << std::endl;
+    os << "latnetbuilder_queue_depth " << state.queued.load() << std::endl;
+    os << "# HELP latnetbuilder_running Commands running." << std::endl;
+    os << "# TYPE latnetbuilder_running gauge" << std::endl;
+    os << "latnetbuilder_running " << state.running.load() << std::endl;
+    os << "# HELP latnetbuilder_requests_total Commands answered, by status." << std::endl;
+    os << "# TYPE latnetbuilder_requests_total counter" << std::endl;
+    os << "latnetbuilder_requests_total{status=\"ok\"} " << state.succeeded.load() << std::endl;
+    os << "latnetbuilder_requests_total{status=\"error\"} " << state.failed.load() << std::endl;
+    os << "# HELP latnetbuilder_uptime_seconds Time since the start of the server." << std::endl;
+    os << "# TYPE latnetbuilder_uptime_seconds gauge" << std::endl;
+    os << "latnetbuilder_uptime_seconds " << std::chrono::duration<double>(now - state.start).count() << std::endl;
+    os.flags(flags);
+}
 
-        if (opt.count("help") && opt.count("set-type") < 1)
+/**
+ * Writes the metrics of the server to a file every \c period seconds until
+ * it is destroyed.
+ *
+ * Each file is written to a temporary file which is then renamed, so that
+ * the file read by the monitoring tools is always complete.
+ */
+class MetricsFile
+{
+public:
+    MetricsFile(std::string fileName, double period, const ServerState& state):
+        m_fileName(std::move(fileName)),
+        m_period(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(period))),
+        m_state(state)
+    {
+        if (period <= 0)
         {
-            std::cout << desc << std::endl;
-            std::exit(0);
+            throw std::runtime_error("the period of the metrics must be positive");
         }
+        write();
+        m_thread = std::thread([this] { loop(); });
+    }
 
-        if (opt.count("version"))
+    ~MetricsFile()
+    {
         {
-            std::cout << "LatNet Builder " << LATNETBUILDER_VERSION << std::endl;
-            std::exit(0);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
         }
+        m_wakeUp.notify_one();
+        m_thread.join();
+    }
 
-        if (opt.count("set-type") < 1)
+    MetricsFile(const MetricsFile&) = delete;
+    MetricsFile& operator=(const MetricsFile&) = delete;
+
+private:
+    std::string m_fileName;
+    std::chrono::steady_clock::duration m_period;
+    const ServerState& m_state;
+    RateSample m_sample;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    bool m_stop = false;
+    std::thread m_thread;
+
+    void loop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_wakeUp.wait_for(lock, m_period, [this] { return m_stop; }))
         {
-            throw std::runtime_error("point set type must be specified; see --help");
+            write();
         }
-        if (opt["set-type"].as<std::string>() == "lattice")
+        write();
+    }
+
+    void write()
+    {
+        const std::string tmpName = m_fileName + ".tmp";
         {
-            LatBuilder::main(argc, argv);
+            std::ofstream file(tmpName);
+            writeMetrics(file, m_state, m_sample);
+            if (!file)
+            {
+                std::cerr << "WARNING: cannot write the metrics file " << tmpName << std::endl;
+                return;
+            }
         }
-        else if (opt["set-type"].as<std::string>() == "net")
+        std::rename(tmpName.c_str(), m_fileName.c_str());
+    }
+};
+
+/**
+ * Answers the commands read on the standard input, one JSON object per line.
+ *
+ * The standard output of each command is captured and returned in the
+ * response, so that the standard output of the server only contains the
+ * responses.
+ *
+ * The commands run one at a time on a worker thread, in the order in which
+ * they are read, while the standard input is read on the calling thread, so
+ * that the metrics requests are answered at once.  The profiler stays enabled
+ * (see LatBuilder::Profiler::setMonitored()), its counters being cheap
+ * atomic updates.  If \c metricsFile is not empty, the metrics are also
+ * written to that file every \c metricsPeriod seconds.
+ */
+void serve(const char* programName, const std::string& metricsFile, double metricsPeriod)
+{
+    namespace pt = boost::property_tree;
+
+    if (LatBuilder::Distributed::size() > 1)
+    {
+        throw std::runtime_error("the server mode cannot be used in an MPI job");
+    }
+
+    LatBuilder::Profiler::setMonitored(true);
+    ServerState state;
+    std::unique_ptr<MetricsFile> metrics;
+    if (!metricsFile.empty())
+    {
+        metrics.reset(new MetricsFile(metricsFile, metricsPeriod, state));
+    }
+
+    // the responses are written by both threads
+    std::ostream responses(std::cout.rdbuf());
+    std::mutex responsesMutex;
+    const auto respond = [&](const pt::ptree& response)
+    {
+        std::lock_guard<std::mutex> lock(responsesMutex);
+        pt::write_json(responses, response, false);
+        responses.flush();
+    };
+
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    std::deque<pt::ptree> queue;
+    bool closed = false;
+
+    std::thread worker([&]
+    {
+        while (true)
+        {
+            pt::ptree request;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueChanged.wait(lock, [&] { return closed || !queue.empty(); });
+                if (queue.empty())
+                {
+                    return;
+                }
+                request = std::move(queue.front());
+                queue.pop_front();
+                state.queued--;
+                state.running++;
+            }
+            const auto response = execute(request, programName);
+            state.running--;
+            (response.get<std::string>("status") == "ok" ? state.succeeded : state.failed)++;
+            respond(response);
+        }
+    });
+
+    // the commands redirect std::cout, which must not be flushed by the reads
+    std::cin.tie(nullptr);
+    RateSample sample;
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+
+        pt::ptree request;
+        std::istringstream is(line);
+        try
+        {
+            pt::read_json(is, request);
+        }
+        catch (std::exception& e)
+        {
+            pt::ptree response;
+            response.put("status", "error");
+            response.put("message", std::string("ERROR: ") + e.what());
+            response.put("output", "");
+            respond(response);
+            continue;
+        }
+
+        if (request.get<bool>("metrics", false))
         {
-            NetBuilder::main(argc, argv);
+            std::ostringstream os;
+            writeMetrics(os, state, sample);
+            pt::ptree response;
+            response.put("id", request.get<std::string>("id", ""));
+            response.put("status", "ok");
+            response.put("output", os.str());
+            respond(response);
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(std::move(request));
+            state.queued++;
+        }
+        queueChanged.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        closed = true;
+    }
+    queueChanged.notify_one();
+    worker.join();
+}
+
+/**
+ * Returns the value of the option \c name (long form) or \c shortName in the
+ * arguments of a job, or an empty string.
+ */
+std::string jobOption(const boost::property_tree::ptree& job, const std::string& name, const std::string& shortName)
+{
+    std::string previous;
+    for (const auto& arg : job.get_child("args"))
+    {
+        const std::string value = arg.second.data();
+        if (previous == name || previous == shortName)
+        {
+            return value;
+        }
+        if (value.compare(0, name.size() + 1, name + "=") == 0)
+        {
+            return value.substr(name.size() + 1);
+        }
+        previous = value;
+    }
+    return "";
+}
+
+/**
+ * Runs the jobs of the JSON file \c fileName one after the other, and answers
+ * each of them on one line of the standard output.
+ *
+ * The jobs of the same set type, construction and size parameter are run
+ * consecutively, in the order of the file, so that they share the tables of
+ * the storages (which are kept for the next search of the same size) in
+ * addition to the process-wide caches of the kernel values, of the FFT plans
+ * and of the generators of the cyclic groups.  The jobs run one at a time, each
+ * with the threads given by its own arguments, because the commands set
+ * process-wide parameters, such as the number of threads and the budgets.
+ */
+void runJobs(const std::string& fileName, const char* programName)
+{
+    namespace pt = boost::property_tree;
+
+    if (LatBuilder::Distributed::size() > 1)
+    {
+        throw std::runtime_error("the job mode cannot be used in an MPI job");
+    }
+
+    pt::ptree root;
+    pt::read_json(fileName, root);
+    std::vector<pt::ptree> jobs;
+    for (const auto& job : root.get_child("jobs"))
+    {
+        jobs.push_back(job.second);
+    }
+
+    std::vector<std::string> keys;
+    for (const auto& job : jobs)
+    {
+        keys.push_back(jobOption(job, "--set-type", "-t") + "\n" + jobOption(job, "--construction", "-c") + "\n" + jobOption(job, "--size-parameter", "-s"));
+    }
+    std::vector<size_t> order(jobs.size());
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+    std::ostream responses(std::cout.rdbuf());
+    for (const size_t i : order)
+    {
+        pt::write_json(responses, execute(jobs[i], programName), false);
+        responses.flush();
+    }
+}
+
+int main(int argc, const char *argv[])
+{
+    LatBuilder::Distributed::Session distributedSession;
+    if (!LatBuilder::Distributed::isRoot())
+    {
+        std::cout.rdbuf(nullptr); // in an MPI job, only the root process reports
+    }
+
+    try
+    {
+        NetBuilder::SET_PATH_TO_LATNETBUILDER_DIR_FROM_PROGRAM_NAME(argv[0]);
+
+        bool server = false;
+        std::string jobs;
+        std::string metricsFile;
+        double metricsPeriod = 10.0;
+        for (int i = 1; i < argc; i++)
+        {
+            server = server || std::string(argv[i]) == "--server";
+            if (std::string(argv[i]) == "--jobs" && i + 1 < argc)
+            {
+                jobs = argv[i + 1];
+            }
+            if (std::string(argv[i]) == "--metrics-file" && i + 1 < argc)
+            {
+                metricsFile = argv[i + 1];
+            }
+            if (std::string(argv[i]) == "--metrics-period" && i + 1 < argc)
+            {
+                metricsPeriod = std::stod(argv[i + 1]);
+            }
+        }
+
+        if (server)
+        {
+            serve(argv[0], metricsFile, metricsPeriod);
+        }
+        else if (!jobs.empty())
+        {
+            runJobs(jobs, argv[0]);
         }
         else
         {
-            throw std::runtime_error("point set type not recognized; see --help");
+            run(argc, argv);
         }
     }
+    catch (LatBuilder::Parser::ParserError& e) {
+      std::cerr << "COMMAND LINE ERROR: " << e.what() << std::endl;
+      std::exit(1);
+    }
     catch (std::exception& e) {
       std::cerr << "ERROR: " << e.what() << std::endl;
       std::exit(1);
     }
 
    return 0;
-}
\ No newline at end of file
+}
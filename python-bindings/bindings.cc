@@ -0,0 +1,331 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Python module \c _latnetbuilder, giving direct access to the searches and
+ * evaluations of LatNet Builder.
+ *
+ * The tasks are described by the same arguments as the latnetbuilder
+ * executable, but they run in the Python process: the results are returned
+ * as NumPy arrays instead of being parsed from the output files.
+ */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/functional.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "latbuilder/LatBuilder.h"
+#include "latbuilder/Parser/Common.h"
+#include "latbuilder/Parser/EmbeddingType.h"
+#include "latbuilder/Parser/Lattice.h"
+#include "latbuilder/Util.h"
+
+#include "netbuilder/NetBuilder.h"
+#include "netbuilder/DigitalNet.h"
+#include "netbuilder/Helpers/Path.h"
+
+#include <boost/algorithm/string/join.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace {
+
+    using LatBuilder::Dimension;
+    using LatBuilder::Real;
+    using LatBuilder::uInteger;
+
+    /// Callback receiving the merit value and the dimension of a newly selected point set.
+    typedef std::function<void (Real, unsigned int)> SelectionCallback;
+
+    /**
+     * Returns a NumPy array viewing the contents of \c data, which is moved to
+     * the heap and owned by the array.
+     */
+    template <typename T>
+    py::array_t<T> toArray(std::vector<T>&& data, std::vector<py::ssize_t> shape)
+    {
+        auto owner = new std::vector<T>(std::move(data));
+        py::capsule capsule(owner, [](void* p) { delete static_cast<std::vector<T>*>(p); });
+        return py::array_t<T>(shape, owner->data(), capsule);
+    }
+
+    /**
+     * Returns a callback which calls \c callback while holding the GIL, to be
+     * connected to the signals emitted while the task runs without it.
+     */
+    SelectionCallback withGIL(SelectionCallback callback)
+    {
+        auto shared = std::make_shared<SelectionCallback>(std::move(callback));
+        return [shared](Real merit, unsigned int dimension)
+        {
+            py::gil_scoped_acquire acquire;
+            (*shared)(merit, dimension);
+        };
+    }
+
+    /**
+     * Parses the options of LatBuilder or NetBuilder from the command-line
+     * arguments \c args, which do not include the program name, and applies
+     * their process-wide settings with \c apply, which resets those of the
+     * previous tasks.
+     */
+    template <typename PARSE, typename APPLY>
+    boost::program_options::variables_map parseArguments(const std::vector<std::string>& args, PARSE parse, APPLY apply)
+    {
+        std::vector<const char*> argv{"latnetbuilder"};
+        for (const auto& arg : args)
+        {
+            argv.push_back(arg.c_str());
+        }
+        auto opt = parse((int) argv.size(), argv.data());
+        if (opt.count("help"))
+        {
+            throw std::invalid_argument("--help is not supported by the Python bindings");
+        }
+        apply(opt);
+        return opt;
+    }
+
+    /**
+     * Digital net search or evaluation.
+     */
+    class NetTask
+    {
+    public:
+        explicit NetTask(const std::vector<std::string>& args)
+        {
+            auto opt = parseArguments(args, NetBuilder::parseOptions, NetBuilder::applySettings);
+            std::string outputFolder;
+            if (opt.count("output-folder") >= 1)
+            {
+                outputFolder = opt["output-folder"].as<std::string>();
+            }
+            m_task = NetBuilder::makeTask(opt, outputFolder, m_interlacingFactor, m_outputStyle);
+        }
+
+        void execute()
+        {
+            py::gil_scoped_release release;
+            m_task->execute();
+        }
+
+        void reset()
+        { m_task->reset(); }
+
+        Real merit() const
+        { return m_task->outputMeritValue(); }
+
+        std::string format() const
+        { return m_task->format(); }
+
+        std::string output() const
+        { return m_task->outputNet(m_outputStyle, m_interlacingFactor); }
+
+        unsigned int interlacingFactor() const
+        { return m_interlacingFactor; }
+
+        /**
+         * Returns the generating matrices of the resulting net as an array of
+         * shape (dimension, rows, columns) of zeros and ones.
+         */
+        py::array_t<std::uint8_t> generatingMatrices() const
+        {
+            const auto& net = m_task->resultNet();
+            const unsigned int nRows = net.numRows();
+            const unsigned int nCols = net.numColumns();
+            std::vector<std::uint8_t> data;
+            data.reserve((size_t) net.dimension() * nRows * nCols);
+            for (Dimension coord = 0; coord < net.dimension(); ++coord)
+            {
+                const auto& matrix = net.generatingMatrix(coord);
+                for (unsigned int i = 0; i < nRows; ++i)
+                {
+                    for (unsigned int j = 0; j < nCols; ++j)
+                    {
+                        data.push_back(matrix(i, j));
+                    }
+                }
+            }
+            return toArray(std::move(data), {(py::ssize_t) net.dimension(), (py::ssize_t) nRows, (py::ssize_t) nCols});
+        }
+
+        void onNetSelected(SelectionCallback callback)
+        {
+            auto slot = withGIL(std::move(callback));
+            m_task->connectOnNetSelected([slot](const NetBuilder::Task::Task& task)
+            {
+                slot(task.outputMeritValue(), task.resultNet().dimension());
+            });
+        }
+
+    private:
+        std::unique_ptr<NetBuilder::Task::Task> m_task;
+        unsigned int m_interlacingFactor = 1;
+        NetBuilder::OutputStyle m_outputStyle = NetBuilder::OutputStyle::TERMINAL;
+    };
+
+    /**
+     * Lattice search or evaluation, independently of the type of lattice.
+     */
+    class LatticeTask
+    {
+    public:
+        virtual ~LatticeTask() = default;
+        virtual void execute() = 0;
+        virtual void reset() = 0;
+        virtual Real merit() const = 0;
+        virtual std::string format() const = 0;
+        virtual uInteger numPoints() const = 0;
+        virtual std::vector<uInteger> generatingVector() const = 0;
+        virtual void onLatticeSelected(SelectionCallback callback) = 0;
+    };
+
+    inline uInteger genValueToInteger(uInteger genValue)
+    { return genValue; }
+
+    inline uInteger genValueToInteger(const LatBuilder::Polynomial& genValue)
+    { return LatBuilder::IndexOfPolynomial(genValue); }
+
+    template <LatBuilder::LatticeType LR, LatBuilder::EmbeddingType ET>
+    class LatticeTaskImpl : public LatticeTask
+    {
+    public:
+        explicit LatticeTaskImpl(const LatBuilder::Parser::CommandLine<LR, ET>& cmd):
+            m_search(cmd.parse())
+        {}
+
+        void execute() override
+        {
+            py::gil_scoped_release release;
+            m_search->execute();
+        }
+
+        void reset() override
+        { m_search->reset(); }
+
+        Real merit() const override
+        { return m_search->bestMeritValue(); }
+
+        std::string format() const override
+        {
+            std::ostringstream os;
+            os << *m_search;
+            return os.str();
+        }
+
+        uInteger numPoints() const override
+        { return m_search->bestLattice().sizeParam().numPoints(); }
+
+        std::vector<uInteger> generatingVector() const override
+        {
+            std::vector<uInteger> res;
+            for (const auto& genValue : m_search->bestLattice().gen())
+            {
+                res.push_back(genValueToInteger(genValue));
+            }
+            return res;
+        }
+
+        void onLatticeSelected(SelectionCallback callback) override
+        {
+            auto slot = withGIL(std::move(callback));
+            m_search->onLatticeSelected().connect([slot](const LatBuilder::Task::Search<LR, ET>& search)
+            {
+                slot(search.bestMeritValue(), (unsigned int) search.bestLattice().dimension());
+            });
+        }
+
+    private:
+        std::unique_ptr<LatBuilder::Task::Search<LR, ET>> m_search;
+    };
+
+    template <LatBuilder::LatticeType LR>
+    std::unique_ptr<LatticeTask> makeLatticeTask(const boost::program_options::variables_map& opt, const std::string& originalCommandLine)
+    {
+        const auto cmd = LatBuilder::makeCommandLine<LR>(opt, originalCommandLine);
+        if (LatBuilder::Parser::EmbeddingType::parse(opt["multilevel"].as<std::string>()) == LatBuilder::EmbeddingType::UNILEVEL)
+        {
+            return std::unique_ptr<LatticeTask>(new LatticeTaskImpl<LR, LatBuilder::EmbeddingType::UNILEVEL>(cmd));
+        }
+        return std::unique_ptr<LatticeTask>(new LatticeTaskImpl<LR, LatBuilder::EmbeddingType::MULTILEVEL>(cmd));
+    }
+
+    std::unique_ptr<LatticeTask> createLatticeTask(const std::vector<std::string>& args)
+    {
+        auto opt = parseArguments(args, LatBuilder::parseOptions, LatBuilder::applySettings);
+        const auto originalCommandLine = boost::algorithm::join(args, " ");
+        if (LatBuilder::Parser::LatticeParser::parse(opt["construction"].as<std::string>()) == LatBuilder::LatticeType::ORDINARY)
+        {
+            return makeLatticeTask<LatBuilder::LatticeType::ORDINARY>(opt, originalCommandLine);
+        }
+        return makeLatticeTask<LatBuilder::LatticeType::POLYNOMIAL>(opt, originalCommandLine);
+    }
+}
+
+PYBIND11_MODULE(_latnetbuilder, m)
+{
+    m.doc() = "Direct access to the searches and evaluations of LatNet Builder.\n\n"
+        "The tasks are described by the command-line arguments of the latnetbuilder executable, "
+        "without the program name and the --set-type argument.";
+
+    py::register_exception<LatBuilder::Parser::ParserError>(m, "ParserError", PyExc_ValueError);
+
+    m.def("set_data_folder",
+        [](const std::string& path) { NetBuilder::SET_PATH_TO_LATNETBUILDER_DIR(path); },
+        "Sets the directory containing the latnetbuilder executable, from which the data files are located.",
+        py::arg("path"));
+
+    py::class_<NetTask>(m, "NetTask", "Digital net search or evaluation.")
+        .def(py::init<const std::vector<std::string>&>(), py::arg("args"))
+        .def("execute", &NetTask::execute, "Runs the task without holding the GIL.")
+        .def("reset", &NetTask::reset)
+        .def_property_readonly("merit", &NetTask::merit)
+        .def_property_readonly("interlacing_factor", &NetTask::interlacingFactor)
+        .def("format", &NetTask::format, "Returns the description of the task.")
+        .def("output", &NetTask::output, "Returns the resulting net in the output style of the task.")
+        .def("generating_matrices", &NetTask::generatingMatrices,
+            "Returns the generating matrices of the resulting net, as an array of shape (dimension, rows, columns).")
+        .def("on_net_selected", &NetTask::onNetSelected,
+            "Calls callback(merit, dimension) each time the search selects a new best net.", py::arg("callback"));
+
+    py::class_<LatticeTask>(m, "LatticeTask", "Lattice search or evaluation.")
+        .def(py::init(&createLatticeTask), py::arg("args"))
+        .def("execute", &LatticeTask::execute, "Runs the task without holding the GIL.")
+        .def("reset", &LatticeTask::reset)
+        .def_property_readonly("merit", &LatticeTask::merit)
+        .def_property_readonly("num_points", &LatticeTask::numPoints)
+        .def("format", &LatticeTask::format, "Returns the description of the task.")
+        .def("generating_vector",
+            [](const LatticeTask& task)
+            {
+                auto gen = task.generatingVector();
+                const auto size = (py::ssize_t) gen.size();
+                return toArray(std::move(gen), {size});
+            },
+            "Returns the generating vector of the resulting lattice (polynomials are represented by the integers "
+            "whose binary digits are their coefficients).")
+        .def("on_lattice_selected", &LatticeTask::onLatticeSelected,
+            "Calls callback(merit, dimension) each time the search selects a new best lattice.", py::arg("callback"));
+}
@@ -28,4 +28,10 @@ atexit.register(_delete_archive)
 
 from .gui import gui
 from .search import SearchLattice, SearchNet
+from .server import Server
+try:
+    # native module, built by waf configure --build-python-bindings
+    from ._latnetbuilder import NetTask, LatticeTask
+except ImportError:
+    pass
 from .generate_points import generate_points_digital_net, generate_points_ordinary_lattice
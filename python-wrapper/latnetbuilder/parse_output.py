@@ -140,3 +140,31 @@ def parse_output(file_output):
             matrices.append(generatingMatricesFromColumns([int(x) for x in Lines[next_line+3+c].split(' ')]))
             matrices_cols.append([int(x) for x in Lines[next_line+3+c].split(' ')])
         return Result('Explicit', nb_points, dim, merit, nb_cols=nb_cols, nb_rows=nb_rows, matrices=np.array(matrices), interlacing=interlacing, matrices_cols=np.array(matrices_cols), max_level=max_level)
+
+
+BINARY_OUTPUT_VERSION = 1
+
+def parse_binary_output(data):
+    '''Parse the content (bytes) of the output.bin file written with the --output-binary flag.'''
+    if data[:4] != b'LNBN':
+        raise ValueError('not a LatNet Builder binary output')
+    version = int(np.frombuffer(data, dtype='<u4', count=1, offset=4)[0])
+    if version != BINARY_OUTPUT_VERSION:
+        raise ValueError('unsupported version %d of the binary output' % version)
+    nb_components, interlacing, nb_rows, nb_cols, words_per_column = [int(x) for x in np.frombuffer(data, dtype='<u4', count=5, offset=8)]
+    merit, elapsed = [float(x) for x in np.frombuffer(data, dtype='<f8', count=2, offset=28)]
+    cl_length = int(np.frombuffer(data, dtype='<u4', count=1, offset=44)[0])
+    offset = 48 + cl_length
+
+    words = np.frombuffer(data, dtype='<u4', count=nb_components * nb_cols * words_per_column, offset=offset)
+    words = words.reshape((nb_components, nb_cols, words_per_column))
+    rows = np.arange(nb_rows)
+    # matrices[c, i, j] is the bit of weight 2^(i % 32) of the word i // 32 of the column j
+    bits = (words[:, :, rows // 32] >> (rows % 32).astype('<u4')) & 1
+    matrices = np.transpose(bits, (0, 2, 1)).astype(np.int32)
+
+    dim = nb_components // interlacing
+    result = Result('Explicit', 2 ** nb_cols, dim, merit, nb_cols=nb_cols, nb_rows=nb_rows, matrices=matrices, interlacing=interlacing)
+    result.elapsed = elapsed
+    result.command_line = data[48:offset].decode('utf-8')
+    return result
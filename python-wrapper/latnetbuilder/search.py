@@ -6,15 +6,18 @@ import shutil
 import logging
 import traceback
 import tarfile
+import json
 from IPython.display import display, FileLink
 import numpy as np
 
 from .parse_output import parse_output, Result
+from .server import server_arguments
 from .gui.output import output, create_output
 from .gui.progress_bars import progress_bars
 from .generate_points import generate_points_digital_net, generate_points_ordinary_lattice
 
 DEFAULT_OUTPUT_FOLDER = 'latnetbuilder_results'
+PROGRESS_FILENAME = 'progress.jsonl'
 
 class Search():
     def __init__(self):
@@ -65,7 +68,7 @@ class Search():
                    '--figure-of-merit', self.figure_of_merit,
                    '--norm-type', self.norm_type,
                    '--exploration-method', self.exploration_method,
-                   '--verbose', '2',
+                   '--verbose', '1',
                    '--dimension', str(self.dimension),
                    '--interlacing', str(self.interlacing),
                    '--output-folder', self._output_folder
@@ -86,6 +89,7 @@ class Search():
         This function is used by the GUI, but should NOT be called directly by the end user.'''
 
         command = self.construct_command_line()
+        command += ['--progress', os.path.join(self._output_folder, PROGRESS_FILENAME)]
         if sys.platform.startswith('win'):
             process = subprocess.Popen(command, stdout=stdout_file, stderr=stderr_file, shell=True)
         else:
@@ -95,20 +99,15 @@ class Search():
         return process
 
     def _parse_progress(self, line):
-        '''Parse the progress information delivered by the C++ stdout. Useful for progress bars.'''
-        try_split = line.split('-')
-        if len(try_split) == 1:
-            current_nb_nets = int(line.split('/')[0].split(' ')[-1])
-            total_nb_nets = int(line.split('/')[1])
-            return (0, float(current_nb_nets) / total_nb_nets)
-        elif len(try_split) == 2:
-            current_nb_nets = int(try_split[1].split('/')[0].split(' ')[-1])
-            total_nb_nets = int(try_split[1].split('/')[1])
-            current_dim = int(try_split[0].split('/')[0].split(' ')[-1])
-            total_dim = int(try_split[0].split('/')[1])
-            return (float(current_dim) / total_dim, float(current_nb_nets) / total_nb_nets)
-
-    def execute(self, output_folder=None, delete_files=True, stdout_filename='cpp_outfile.txt', stderr_filename='cpp_errfile.txt', display_progress_bar=False):
+        '''Parse a line of the progress file written by the C++ executable with --progress. Useful for progress bars.
+
+        Returns the fractions of the coordinates and of the candidates of the current coordinate explored.'''
+        record = json.loads(line)
+        prog_dimension = float(record['coordinate']) / record['dimension'] if record['dimension'] > 0 else 0
+        prog_net = float(record['candidate']) / record['candidates'] if record['candidates'] > 0 else 0
+        return (prog_dimension, prog_net)
+
+    def execute(self, output_folder=None, delete_files=True, stdout_filename='cpp_outfile.txt', stderr_filename='cpp_errfile.txt', display_progress_bar=False, server=None):
         '''Call the C++ process and monitor it.
 
         Arguments (all optional):
@@ -118,12 +117,17 @@ class Search():
             + stdout_filename: name of the file which will contain the std output of the C++ executable
             + stdout_filename: name of the file which will contain the error output of the C++ executable
             + display_progress_bars: if set to True, ipywidgets progress bars are displayed (should be used only in the notebook)
+            + server: latnetbuilder.server.Server instance to which the search is sent instead of launching a new C++ process
         
         This function should be used by the end user if he instanciates a Search object.'''
         
         if output_folder is not None:
             self._output_folder = output_folder
-            
+
+        if server is not None:
+            self._execute_on_server(server)
+            return
+
         try:
             if not os.path.exists(self._output_folder):
                 os.makedirs(self._output_folder)
@@ -138,6 +142,20 @@ class Search():
         process = self._launch_subprocess(stdout_file, stderr_file)
         self._monitor_process(process, stdout_filepath, stderr_filepath, display_progress_bar=display_progress_bar, delete_files=delete_files)
 
+    def _execute_on_server(self, server):
+        '''Send the search to a running LatNetBuilder server and print the result.'''
+        if not os.path.exists(self._output_folder):
+            os.makedirs(self._output_folder)
+        response = server.query(server_arguments(self.construct_command_line()))
+        if response['status'] != 'ok':
+            print(response.get('message', ''))
+            return
+        with open(os.path.join(self._output_folder, 'output.txt')) as f:
+            result_obj = parse_output(f.read())
+        print(result_obj)
+        self.my_output = output()
+        self.my_output.result_obj = result_obj
+
     def _monitor_process(self, process, stdout_filepath, stderr_filepath, gui=None, display_progress_bar=False, delete_files=True):
         '''Monitor the C++ process.
         
@@ -165,10 +183,10 @@ class Search():
             
             while process.poll() is None:   # while the process is not finished
                 time.sleep(0.1)
-                with open(stdout_filepath,'r') as f:
-                    data = f.read()
                 try:
-                    last_line = data.split('\n')[-2]    # read the before last line (the last line is always blank)
+                    with open(os.path.join(self._output_folder, PROGRESS_FILENAME),'r') as f:
+                        data = f.read()
+                    last_line = data.split('\n')[-2]    # read the last complete line (the last line is blank or being written)
                     prog_dimension, prog_net = self._parse_progress(last_line)
                     if display_progress_bar:    # update progress bars
                         my_progress_bars.progress_bar_nets.value = prog_net
@@ -220,6 +238,8 @@ class Search():
             if delete_files:
                 os.remove(os.path.join(self._output_folder, 'cpp_outfile.txt'))
                 os.remove(os.path.join(self._output_folder, 'cpp_errfile.txt'))
+                if os.path.exists(os.path.join(self._output_folder, PROGRESS_FILENAME)):
+                    os.remove(os.path.join(self._output_folder, PROGRESS_FILENAME))
             
         except Exception as e:
             error_file = os.path.join(self._output_folder, 'stderr.txt')
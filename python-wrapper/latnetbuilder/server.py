@@ -0,0 +1,52 @@
+import json
+import shlex
+import subprocess
+
+class Server():
+    '''Long-lived LatNetBuilder process answering several commands.
+
+    The commands are sent to `latnetbuilder --server` one JSON line at a time, so that
+    the start-up of the executable and the loading of its data tables are paid only once.'''
+
+    def __init__(self, path_to_latnetbuilder=None):
+        if path_to_latnetbuilder is None:
+            from . import PATH_TO_LATNETBUILDER
+            path_to_latnetbuilder = PATH_TO_LATNETBUILDER
+        self._process = subprocess.Popen([path_to_latnetbuilder, '--server'], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+        self._next_id = 0
+
+    def query(self, args):
+        '''Run the command with the command-line arguments args (list of strings, without the executable)
+        and return the response as a dictionary with the keys id, status, output and, on errors, message.'''
+        return self._request({'args': list(args)})
+
+    def metrics(self):
+        '''Return the metrics of the server (counters of the candidates, of the early aborts, of the
+        caches and times of the phases) in the text format of Prometheus.'''
+        return self._request({'metrics': True})['output']
+
+    def _request(self, request):
+        self._next_id += 1
+        request = dict(request, id=str(self._next_id))
+        self._process.stdin.write(json.dumps(request) + '\n')
+        self._process.stdin.flush()
+        line = self._process.stdout.readline()
+        if line == '':
+            raise RuntimeError('the LatNetBuilder server has terminated')
+        return json.loads(line)
+
+    def close(self):
+        '''Terminate the server.'''
+        if self._process.poll() is None:
+            self._process.stdin.close()
+            self._process.wait()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+def server_arguments(command):
+    '''Convert a command line built for the shell by Search.construct_command_line into server arguments.'''
+    return shlex.split(' '.join(command[1:]))
@@ -0,0 +1,144 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Budget.h"
+#include "latbuilder/Execution.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+namespace LatBuilder
+{
+
+namespace {
+
+   // the budget is set before the searches start, the evaluations are
+   // counted concurrently
+   struct State {
+      Budget::Clock::time_point start = Budget::Clock::now();
+      Real seconds = std::numeric_limits<Real>::infinity();
+      unsigned long long maxEvaluations = 0;
+      std::atomic<unsigned long long> evaluations{0};
+      Real target = std::numeric_limits<Real>::infinity();
+      std::atomic<unsigned long long> targetsReached{0};
+   };
+
+   State& state()
+   {
+      static State instance;
+      return instance;
+   }
+}
+
+//===============================================================================
+void Budget::set(Real seconds, unsigned long long evaluations)
+{
+   if (!(seconds > 0))
+      throw std::invalid_argument("Budget: the time budget must be positive");
+   State& s = state();
+   s.seconds = seconds;
+   s.maxEvaluations = evaluations;
+   restart();
+}
+
+//===============================================================================
+void Budget::setTarget(Real merit)
+{
+   if (std::isnan(merit))
+      throw std::invalid_argument("Budget: the target merit value must be a number");
+   state().target = merit;
+}
+
+//===============================================================================
+void Budget::clear()
+{
+   State& s = state();
+   s.seconds = std::numeric_limits<Real>::infinity();
+   s.maxEvaluations = 0;
+   s.target = std::numeric_limits<Real>::infinity();
+   restart();
+}
+
+//===============================================================================
+Real Budget::target()
+{ return state().target; }
+
+//===============================================================================
+void Budget::reach(Real merit)
+{
+   State& s = state();
+   if (merit < s.target)
+      s.targetsReached.fetch_add(1, std::memory_order_relaxed);
+}
+
+//===============================================================================
+unsigned long long Budget::targetsReached()
+{ return state().targetsReached.load(std::memory_order_relaxed); }
+
+//===============================================================================
+void Budget::restart()
+{
+   State& s = state();
+   s.start = Clock::now();
+   s.evaluations.store(0, std::memory_order_relaxed);
+}
+
+//===============================================================================
+bool Budget::limited()
+{
+   const State& s = state();
+   return !std::isinf(s.seconds) || s.maxEvaluations != 0;
+}
+
+//===============================================================================
+void Budget::count(unsigned long long n)
+{ state().evaluations.fetch_add(n, std::memory_order_relaxed); }
+
+//===============================================================================
+unsigned long long Budget::evaluations()
+{ return state().evaluations.load(std::memory_order_relaxed); }
+
+//===============================================================================
+Real Budget::elapsed()
+{ return std::chrono::duration<Real>(Clock::now() - state().start).count(); }
+
+//===============================================================================
+auto Budget::share(unsigned int parts) -> Share
+{
+   Execution::check();
+   const State& s = state();
+   parts = std::max(parts, 1u);
+   Share share;
+   if (!std::isinf(s.target))
+      share.m_targetEpoch = targetsReached();
+   if (const Execution* execution = Execution::current())
+      share.m_cancelled = &execution->cancelFlag();
+   if (!std::isinf(s.seconds)) {
+      const auto now = Clock::now();
+      const Real remaining = std::max<Real>(0, s.seconds - std::chrono::duration<Real>(now - s.start).count());
+      share.m_deadline = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<Real>(remaining / parts));
+   }
+   if (s.maxEvaluations != 0) {
+      const unsigned long long used = evaluations();
+      const unsigned long long remaining = used < s.maxEvaluations ? s.maxEvaluations - used : 0;
+      share.m_maxEvaluations = used + std::max(remaining / parts, 1ull);
+   }
+   return share;
+}
+
+}
@@ -0,0 +1,89 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Checkpoint.h"
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace LatBuilder
+{
+
+namespace {
+   const std::string coordinatesTag = "# Coordinates: ";
+   const std::string meritTag = "# Merit: ";
+
+   bool startsWith(const std::string& line, const std::string& prefix)
+   { return line.compare(0, prefix.size(), prefix) == 0; }
+}
+
+//===============================================================================
+void Checkpoint::write(const std::string& fileName) const
+{
+   const std::string tmpFileName = fileName + ".tmp";
+   {
+      std::ofstream file(tmpFileName);
+      if (!file)
+         throw std::runtime_error("cannot write checkpoint file " + tmpFileName);
+      file.precision(std::numeric_limits<Real>::max_digits10);
+      file << coordinatesTag << dimension() << std::endl;
+      file << meritTag << merit << std::endl;
+      for (const auto& genValue : genValues)
+         file << genValue << std::endl;
+      if (!file)
+         throw std::runtime_error("cannot write checkpoint file " + tmpFileName);
+   }
+   if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+      throw std::runtime_error("cannot rename " + tmpFileName + " to " + fileName);
+}
+
+//===============================================================================
+Checkpoint Checkpoint::read(const std::string& fileName)
+{
+   std::ifstream file(fileName);
+   if (!file)
+      throw std::runtime_error("cannot read checkpoint file " + fileName);
+
+   Checkpoint checkpoint;
+   bool hasMerit = false;
+   Dimension dimension = 0;
+   bool hasDimension = false;
+
+   std::string line;
+   while (std::getline(file, line)) {
+      if (startsWith(line, coordinatesTag)) {
+         std::istringstream is(line.substr(coordinatesTag.size()));
+         hasDimension = static_cast<bool>(is >> dimension);
+      }
+      else if (startsWith(line, meritTag)) {
+         std::istringstream is(line.substr(meritTag.size()));
+         hasMerit = static_cast<bool>(is >> checkpoint.merit);
+      }
+      else if (!line.empty() && line[0] != '#') {
+         checkpoint.genValues.push_back(line);
+      }
+   }
+
+   if (!hasDimension || !hasMerit || dimension != checkpoint.dimension())
+      throw std::runtime_error("invalid checkpoint file " + fileName);
+
+   return checkpoint;
+}
+
+}
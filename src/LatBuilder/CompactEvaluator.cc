@@ -0,0 +1,214 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/CompactEvaluator.h"
+#include "latbuilder/Functor/PAlpha.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace LatBuilder
+{
+
+namespace {
+   // Sums over the points of the products of the kernel values, per order
+   // for POD weights, or of the products of (1 + gamma_j omega) otherwise.
+   class PointSums {
+   public:
+      PointSums(Dimension dimension, const Real* productWeights, const Real* orderWeights):
+         m_dimension(dimension),
+         m_orderWeights(orderWeights),
+         m_sum(0.0)
+      {
+         for (Dimension j = 0; j < dimension; j++)
+            m_gamma[j] = productWeights ? productWeights[j] : Real(1.0);
+         for (Dimension l = 0; l <= dimension; l++)
+            m_sums[l] = 0.0;
+      }
+
+      // adds the point the kernel values of which are omega[0..dimension)
+      void add(const Real* omega)
+      {
+         if (m_orderWeights) {
+            // p[l] = sum of the products of gamma_j omega_j over the projections of order l
+            Real p[CompactEvaluator::MaxDimension + 1];
+            p[0] = 1.0;
+            for (Dimension j = 0; j < m_dimension; j++) {
+               const Real x = m_gamma[j] * omega[j];
+               p[j + 1] = x * p[j];
+               for (Dimension l = j; l >= 1; l--)
+                  p[l] += x * p[l - 1];
+            }
+            for (Dimension l = 1; l <= m_dimension; l++)
+               m_sums[l] += p[l];
+         }
+         else {
+            Real prod = 1.0;
+            for (Dimension j = 0; j < m_dimension; j++)
+               prod *= 1.0 + m_gamma[j] * omega[j];
+            m_sum += prod;
+         }
+      }
+
+      Real merit(uInteger numPoints) const
+      {
+         if (not m_orderWeights)
+            return m_sum / numPoints - 1.0;
+         Real merit = 0.0;
+         for (Dimension l = 1; l <= m_dimension; l++)
+            merit += m_orderWeights[l] * m_sums[l];
+         return merit / numPoints;
+      }
+
+   private:
+      Dimension m_dimension;
+      const Real* m_orderWeights;
+      Real m_gamma[CompactEvaluator::MaxDimension];
+      Real m_sums[CompactEvaluator::MaxDimension + 1];
+      Real m_sum;
+   };
+}
+
+//===============================================================================
+CompactEvaluator::CompactEvaluator():
+   m_kernelPoints(0),
+   m_kernelAlpha(0)
+{}
+
+//===============================================================================
+CompactEvaluator& CompactEvaluator::local()
+{
+   thread_local CompactEvaluator evaluator;
+   return evaluator;
+}
+
+//===============================================================================
+void CompactEvaluator::reserve(uInteger numPoints)
+{
+   checkSize(numPoints, 1);
+   m_kernel.reserve(numPoints);
+}
+
+//===============================================================================
+void CompactEvaluator::checkSize(uInteger numPoints, Dimension dimension)
+{
+   if (numPoints == 0 or numPoints > MaxPoints)
+      throw std::invalid_argument("CompactEvaluator: the number of points must be between 1 and 2^16");
+   if (dimension > MaxDimension)
+      throw std::invalid_argument("CompactEvaluator: the dimension must not exceed 32");
+}
+
+//===============================================================================
+void CompactEvaluator::prepareLattice(uInteger numPoints, unsigned int alpha)
+{
+   if (m_kernelPoints == numPoints and m_kernelAlpha == alpha)
+      return;
+
+   const Functor::PAlpha functor(alpha);
+
+   // the kernel values are computed in place from the points i / n
+   m_kernelAlpha = 0;
+   m_kernel.resize(numPoints);
+   for (uInteger i = 0; i < numPoints; i++)
+      m_kernel[i] = Real(i) / numPoints;
+   functor.apply(m_kernel.data(), m_kernel.data(), numPoints, numPoints);
+
+   m_kernelPoints = numPoints;
+   m_kernelAlpha = alpha;
+}
+
+//===============================================================================
+Real CompactEvaluator::latticePAlpha(
+      uInteger numPoints,
+      const uInteger* gen,
+      Dimension dimension,
+      unsigned int alpha,
+      const Real* productWeights,
+      const Real* orderWeights)
+{
+   checkSize(numPoints, dimension);
+   prepareLattice(numPoints, alpha);
+
+   uInteger step[MaxDimension];
+   uInteger index[MaxDimension];
+   Real omega[MaxDimension];
+   for (Dimension j = 0; j < dimension; j++) {
+      step[j] = gen[j] % numPoints;
+      index[j] = 0;
+   }
+
+   PointSums sums(dimension, productWeights, orderWeights);
+   const Real* kernel = m_kernel.data();
+   for (uInteger i = 0; i < numPoints; i++) {
+      // index[j] = i a_j mod n, updated without division
+      for (Dimension j = 0; j < dimension; j++) {
+         omega[j] = kernel[index[j]];
+         index[j] += step[j];
+         if (index[j] >= numPoints)
+            index[j] -= numPoints;
+      }
+      sums.add(omega);
+   }
+   return sums.merit(numPoints);
+}
+
+//===============================================================================
+Real CompactEvaluator::netPAlphaTilde(
+      unsigned int m,
+      const std::uint32_t* columns,
+      Dimension dimension,
+      unsigned int alpha,
+      const Real* productWeights,
+      const Real* orderWeights)
+{
+   if (m > 16)
+      throw std::invalid_argument("CompactEvaluator: the number of points must be between 1 and 2^16");
+   if (alpha < 2)
+      throw std::invalid_argument("CompactEvaluator: alpha must be larger than 1");
+   const uInteger numPoints = uInteger(1) << m;
+   checkSize(numPoints, dimension);
+
+   // the kernel value of x = k / 2^m depends only on the bit length b of k:
+   // mu if k = 0, mu - 2^((b - m) (alpha - 1)) (1 + mu) otherwise
+   const Real mu = 1 / (1 - std::pow(Real(2), 1 - Real(alpha)));
+   Real kernel[17];
+   kernel[0] = mu;
+   for (unsigned int b = 1; b <= m; b++)
+      kernel[b] = mu - std::ldexp(1 + mu, ((int) b - (int) m) * ((int) alpha - 1));
+
+   std::uint32_t point[MaxDimension];
+   Real omega[MaxDimension];
+   const std::uint32_t mask = (std::uint32_t(1) << m) - 1;
+   for (Dimension j = 0; j < dimension; j++) {
+      point[j] = 0;
+      omega[j] = kernel[0];
+   }
+
+   PointSums sums(dimension, productWeights, orderWeights);
+   sums.add(omega);
+   for (uInteger i = 1; i < numPoints; i++) {
+      // Gray code: the point i differs from the previous one by column ctz(i)
+      const unsigned int c = (unsigned int) __builtin_ctzll(i);
+      for (Dimension j = 0; j < dimension; j++) {
+         point[j] = (point[j] ^ columns[j * m + c]) & mask;
+         omega[j] = kernel[point[j] ? 32 - __builtin_clz(point[j]) : 0];
+      }
+      sums.add(omega);
+   }
+   return sums.merit(numPoints);
+}
+
+}
@@ -0,0 +1,46 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/CpuDispatch.h"
+
+namespace LatBuilder
+{
+
+//===============================================================================
+std::string cpuDispatchDescription()
+{
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED
+   std::string features;
+   const auto add = [&features] (CpuFeature feature, const char* name) {
+      if (cpuSupports(feature))
+         features += (features.empty() ? "" : " ") + std::string(name);
+   };
+   add(CpuFeature::POPCNT, "popcnt");
+   add(CpuFeature::SSE42, "sse4.2");
+   add(CpuFeature::PCLMUL, "pclmul");
+   add(CpuFeature::BMI2, "bmi2");
+   add(CpuFeature::AVX2, "avx2");
+   add(CpuFeature::AVX512F, "avx512f");
+   add(CpuFeature::PMULL, "pmull");
+   add(CpuFeature::SVE, "sve");
+   return "selected at run time (host: " + (features.empty() ? std::string("baseline") : features) + ")";
+#else
+   return "fixed at compile time";
+#endif
+}
+
+}
@@ -0,0 +1,150 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Distributed.h"
+
+#ifdef LATNETBUILDER_MPI
+#include <mpi.h>
+#include <type_traits>
+#include <vector>
+#endif
+
+namespace LatBuilder
+{
+
+constexpr unsigned long long Distributed::Candidate::none;
+
+#ifdef LATNETBUILDER_MPI
+
+namespace {
+   // MPI datatype of the merit values, for the floating-point type selected
+   // at configure time
+   MPI_Datatype realType()
+   {
+      return std::is_same<Real, float>::value ? MPI_FLOAT :
+         std::is_same<Real, long double>::value ? MPI_LONG_DOUBLE : MPI_DOUBLE;
+   }
+
+   bool isRunning()
+   {
+      int initialized = 0;
+      int finalized = 0;
+      MPI_Initialized(&initialized);
+      MPI_Finalized(&finalized);
+      return initialized && !finalized;
+   }
+}
+
+//===============================================================================
+Distributed::Session::Session():
+   m_owner(false)
+{
+   int initialized = 0;
+   MPI_Initialized(&initialized);
+   if (!initialized) {
+      MPI_Init(nullptr, nullptr);
+      m_owner = true;
+   }
+}
+
+Distributed::Session::~Session()
+{
+   if (m_owner && isRunning())
+      MPI_Finalize();
+}
+
+//===============================================================================
+unsigned int Distributed::rank()
+{
+   if (!isRunning())
+      return 0;
+   int rank = 0;
+   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+   return (unsigned int) rank;
+}
+
+unsigned int Distributed::size()
+{
+   if (!isRunning())
+      return 1;
+   int size = 1;
+   MPI_Comm_size(MPI_COMM_WORLD, &size);
+   return (unsigned int) size;
+}
+
+//===============================================================================
+Distributed::Candidate Distributed::minimum(const Candidate& local)
+{
+   const unsigned int n = size();
+   if (n == 1)
+      return local;
+
+   std::vector<Real> merits(n);
+   std::vector<unsigned long long> indices(n);
+   MPI_Allgather(&local.merit, 1, realType(), merits.data(), 1, realType(), MPI_COMM_WORLD);
+   MPI_Allgather(&local.index, 1, MPI_UNSIGNED_LONG_LONG, indices.data(), 1, MPI_UNSIGNED_LONG_LONG, MPI_COMM_WORLD);
+
+   Candidate best;
+   for (unsigned int i = 0; i < n; i++) {
+      if (indices[i] == Candidate::none)
+         continue;
+      if (best.index == Candidate::none || merits[i] < best.merit || (merits[i] == best.merit && indices[i] < best.index)) {
+         best.merit = merits[i];
+         best.index = indices[i];
+      }
+   }
+   return best;
+}
+
+//===============================================================================
+std::string Distributed::broadcast(const std::string& value, unsigned int root)
+{
+   if (size() == 1)
+      return value;
+
+   unsigned long long length = value.size();
+   MPI_Bcast(&length, 1, MPI_UNSIGNED_LONG_LONG, (int) root, MPI_COMM_WORLD);
+   std::vector<char> buffer(value.begin(), value.end());
+   buffer.resize(length);
+   MPI_Bcast(buffer.data(), (int) length, MPI_CHAR, (int) root, MPI_COMM_WORLD);
+   return std::string(buffer.begin(), buffer.end());
+}
+
+#else
+
+//===============================================================================
+Distributed::Session::Session():
+   m_owner(false)
+{}
+
+Distributed::Session::~Session()
+{}
+
+unsigned int Distributed::rank()
+{ return 0; }
+
+unsigned int Distributed::size()
+{ return 1; }
+
+Distributed::Candidate Distributed::minimum(const Candidate& local)
+{ return local; }
+
+std::string Distributed::broadcast(const std::string& value, unsigned int root)
+{ return value; }
+
+#endif
+
+}
@@ -0,0 +1,297 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/DryRun.h"
+#include "latbuilder/CombinedWeights.h"
+#include "latbuilder/Storage.h"
+#include "latbuilder/GenSeq/GeneratingValues.h"
+#include "latbuilder/Parser/Common.h"
+#include "latbuilder/Parser/SizeParam.h"
+#include "latbuilder/Parser/CombinedWeights.h"
+
+#include "latticetester/OrderDependentWeights.h"
+#include "latticetester/ProductWeights.h"
+#include "latticetester/PODWeights.h"
+#include "latticetester/ProjectionDependentWeights.h"
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <set>
+
+namespace LatBuilder
+{
+
+namespace {
+
+   unsigned int index(Memory::Component component)
+   { return static_cast<unsigned int>(component); }
+
+   // number of rows of the states of the coordinate-uniform figures of merit
+   size_t stateRows(const LatticeTester::Weights& weights, Dimension dimension)
+   {
+      if (dynamic_cast<const LatticeTester::PODWeights*>(&weights) ||
+            dynamic_cast<const LatticeTester::OrderDependentWeights*>(&weights))
+         return dimension;
+      if (dynamic_cast<const LatticeTester::ProductWeights*>(&weights))
+         return 1;
+      if (auto w = dynamic_cast<const LatticeTester::ProjectionDependentWeights*>(&weights)) {
+         // the empty projection and the projections from which those of
+         // nonzero weight are built (see ConcreteCoordUniformState::plan())
+         std::set<LatticeTester::Coordinates> prefixes{LatticeTester::Coordinates()};
+         const Dimension size = std::min<Dimension>(w->getSize(), dimension);
+         for (Dimension largestIndex = 0; largestIndex < size; largestIndex++) {
+            for (const auto& pw : w->getWeightsForLargestIndex(largestIndex)) {
+               if (pw.second == 0.0)
+                  continue;
+               LatticeTester::Coordinates proj = pw.first;
+               proj.erase(*proj.rbegin());
+               while (not proj.empty() and prefixes.insert(proj).second)
+                  proj.erase(*proj.rbegin());
+            }
+         }
+         return prefixes.size();
+      }
+      if (auto w = dynamic_cast<const CombinedWeights*>(&weights)) {
+         size_t rows = 0;
+         for (const auto& component : w->list())
+            rows += stateRows(*component, dimension);
+         return rows;
+      }
+      // other weights: as many rows as order-dependent weights
+      return dimension;
+   }
+
+   template <LatticeType LR>
+   Level numLevels(const SizeParam<LR, EmbeddingType::UNILEVEL>&)
+   { return 1; }
+
+   template <LatticeType LR>
+   Level numLevels(const SizeParam<LR, EmbeddingType::MULTILEVEL>& size)
+   { return size.maxLevel() + 1; }
+
+   template <LatticeType LR, EmbeddingType ET, Compress COMPRESS>
+   void sizes(const SizeParam<LR, ET>& size, DryRun::Estimate& out)
+   {
+      out.storageSize = Storage<LR, ET, COMPRESS, defaultPerLevelOrder<LR, ET>::Order>(size).size();
+      out.numGeneratingValues = GenSeq::GeneratingValues<LR, COMPRESS>(size.modulus()).size();
+   }
+
+   // operations of the FFT's of a coordinate of the fast constructions
+   double fftOperations(double size)
+   { return size > 1 ? 2.5 * size * std::log2(size) : size; }
+}
+
+//===============================================================================
+double DryRun::Estimate::totalBytes() const
+{
+   double total = 0;
+   for (const auto x : bytes)
+      total += x;
+   return total;
+}
+
+double DryRun::Estimate::seconds() const
+{ return operations * secondsPerOperation / numThreads; }
+
+//===============================================================================
+template <LatticeType LR, EmbeddingType ET>
+DryRun::Estimate DryRun::estimate(
+      const Parser::CommandLine<LR, EmbeddingType::MULTILEVEL>& cmd,
+      unsigned int numThreads,
+      unsigned int repeat)
+{
+   typedef Memory::Component Component;
+
+   Estimate out;
+   out.numThreads = std::max(numThreads, 1u);
+
+   const auto size = Parser::SizeParam<LR, ET>::parse(cmd.size);
+   const Dimension dimension = boost::lexical_cast<Dimension>(cmd.dimension) * boost::lexical_cast<unsigned int>(cmd.interlacingFactor);
+   const auto weights = Parser::CombinedWeights::parse(cmd.weights, cmd.weightsPowerScale);
+   const auto figure = Parser::splitPair<>(cmd.figure, ':');
+   const bool coordUniform = figure.first == "CU";
+
+   // the kernels of the ordinary lattices are all symmetric
+   out.symmetric = coordUniform and LR == LatticeType::ORDINARY;
+   if (out.symmetric)
+      sizes<LR, ET, Compress::SYMMETRIC>(size, out);
+   else
+      sizes<LR, ET, Compress::NONE>(size, out);
+   out.numPoints = static_cast<double>(size.numPoints());
+   out.stateRows = coordUniform ? stateRows(*weights, dimension) : 0;
+
+   const double S = out.storageSize;
+   const double G = out.numGeneratingValues;
+   const double rows = out.stateRows;
+   const double levels = numLevels(size);
+   const double real = sizeof(Real);
+
+   std::vector<std::string> method;
+   boost::split(method, cmd.construction, boost::is_any_of(":"));
+   const std::string& name = method[0];
+
+   const bool fast = name == "fast-CBC" or name == "fast-Korobov";
+   const bool cbc = name == "full-CBC" or name == "fast-CBC" or name == "random-CBC" or name == "extend";
+
+   // number of lattices evaluated by a run, and number of searches executed
+   // concurrently, each with its own states
+   double evaluations = 0;
+   double concurrentStates = 1;
+   if (name == "full-CBC" or name == "fast-CBC")
+      evaluations = 1 + (dimension - 1) * G;
+   else if (name == "Korobov" or name == "fast-Korobov")
+      evaluations = G;
+   else if (name == "exhaustive")
+      evaluations = std::pow(G, dimension - 1);
+   else if (name == "exhaustive-DFS") {
+      evaluations = std::pow(G, dimension - 1);
+      out.notes.push_back("the number of evaluations of exhaustive-DFS is that of exhaustive, before the branches are bounded");
+   }
+   else if (name == "evaluation" or name == "evaluation-levels")
+      evaluations = 1;
+   else if (name == "extend" and method.size() >= 2) {
+      const auto base = Parser::SizeParam<LR, ET>::parse(method[1]);
+      evaluations = dimension * out.numPoints / static_cast<double>(base.numPoints());
+   }
+   else if (method.size() >= 2 and (name == "random" or name == "random-Korobov" or name == "random-CBC")) {
+      const auto samples = boost::lexical_cast<double>(method[1]);
+      evaluations = name == "random-CBC" ? 1 + (dimension - 1) * std::min(samples, G) : samples;
+   }
+   else
+      throw Parser::ParserError("unsupported construction method: " + cmd.construction);
+
+   if (name == "exhaustive-DFS")
+      concurrentStates = dimension;
+   else if (not cbc and not fast and evaluations > 1)
+      concurrentStates = std::min<double>(out.numThreads, evaluations);
+   out.evaluations = evaluations * repeat;
+
+   if (ET == EmbeddingType::MULTILEVEL)
+      out.bytes[index(Component::STORAGE)] = out.numPoints * sizeof(std::uint32_t);
+
+   if (not coordUniform) {
+      out.notes.push_back("the figure of merit is not coordinate-uniform: its memory and its time are not estimated");
+      return out;
+   }
+
+   out.bytes[index(Component::KERNEL_VALUES)] = S * real;
+   out.bytes[index(Component::STATES)] = rows * S * real * concurrentStates;
+   if (fast) {
+      // transforms of the circulant matrices of the kernel values, and the
+      // real and complex buffers of each worker
+      out.bytes[index(Component::FFT_BUFFERS)] = (G + 3 * G * out.numThreads) * real;
+      out.bytes[index(Component::OTHER)] = G * real;
+   }
+   else if (cbc)
+      out.bytes[index(Component::OTHER)] = G * levels * real;
+
+   // a candidate costs an inner product with the weighted state, and each
+   // coordinate the weighted state and the update of the rows
+   if (fast)
+      out.operations = dimension * (fftOperations(G) + 2 * rows * S);
+   else if (cbc)
+      out.operations = evaluations * S + dimension * 2 * rows * S;
+   else
+      out.operations = evaluations * dimension * S * (1 + 2 * rows);
+   out.operations *= repeat;
+   out.secondsPerOperation = calibrate(out.storageSize);
+   if (out.numThreads > 1)
+      out.notes.push_back("the time assumes a linear speedup on the threads");
+   return out;
+}
+
+//===============================================================================
+double DryRun::calibrate(size_t size)
+{
+   using namespace std::chrono;
+
+   // large vectors are sampled by a part which does not fit in cache either
+   size = std::max<size_t>(std::min<size_t>(size, size_t(1) << 22), 1024);
+   std::vector<Real> state(size, 1.0);
+   std::vector<Real> kernel(size, 0.5);
+   const size_t stride = size / 3 * 2 + 1;
+
+   volatile Real sink = 0;
+   size_t count = 0;
+   const auto t0 = steady_clock::now();
+   duration<double> dt(0);
+   do {
+      Real sum = 0;
+      size_t j = 0;
+      for (size_t i = 0; i < size; i++) {
+         sum += state[i] * kernel[j];
+         j += stride;
+         if (j >= size)
+            j -= size;
+      }
+      sink = sink + sum;
+      count += size;
+      dt = duration_cast<duration<double>>(steady_clock::now() - t0);
+   } while (dt.count() < 0.05);
+   return dt.count() / count;
+}
+
+//===============================================================================
+void DryRun::write(std::ostream& os, const Estimate& estimate)
+{
+   const auto flags = os.flags();
+   const auto precision = os.precision();
+
+   os << "Dry run: the search is not executed" << std::endl;
+   os << "Number of points: " << std::setprecision(15) << estimate.numPoints << std::endl;
+   os << "Storage size: " << estimate.storageSize << " elements"
+      << (estimate.symmetric ? " (symmetric compression)" : "") << std::endl;
+   os << "Candidate generating values by coordinate: " << estimate.numGeneratingValues << std::endl;
+   if (estimate.stateRows)
+      os << "State rows: " << estimate.stateRows << std::endl;
+   os << "Estimated peak memory:" << std::endl;
+   for (unsigned int i = 0; i < Memory::NUM_COMPONENTS; i++) {
+      const auto component = static_cast<Memory::Component>(i);
+      os << "  " << std::left << std::setw(16) << Memory::name(component) << std::right
+         << Memory::format(estimate.bytes[i]) << std::endl;
+   }
+   os << "  " << std::left << std::setw(16) << "total" << std::right << Memory::format(estimate.totalBytes()) << std::endl;
+   os << std::setprecision(3);
+   os << "Evaluated lattices: " << estimate.evaluations << std::endl;
+   if (estimate.operations > 0) {
+      os << "Elementary operations: " << estimate.operations
+         << " (" << estimate.secondsPerOperation * 1e9 << " ns each on this machine)" << std::endl;
+      os << "Estimated time: " << estimate.seconds() << " seconds on " << estimate.numThreads
+         << (estimate.numThreads > 1 ? " threads" : " thread") << std::endl;
+   }
+   else
+      os << "Estimated time: n/a" << std::endl;
+   for (const auto& note : estimate.notes)
+      os << "Note: " << note << std::endl;
+
+   os.flags(flags);
+   os.precision(precision);
+}
+
+template DryRun::Estimate DryRun::estimate<LatticeType::ORDINARY, EmbeddingType::UNILEVEL>(const Parser::CommandLine<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>&, unsigned int, unsigned int);
+template DryRun::Estimate DryRun::estimate<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>(const Parser::CommandLine<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>&, unsigned int, unsigned int);
+template DryRun::Estimate DryRun::estimate<LatticeType::POLYNOMIAL, EmbeddingType::UNILEVEL>(const Parser::CommandLine<LatticeType::POLYNOMIAL, EmbeddingType::MULTILEVEL>&, unsigned int, unsigned int);
+template DryRun::Estimate DryRun::estimate<LatticeType::POLYNOMIAL, EmbeddingType::MULTILEVEL>(const Parser::CommandLine<LatticeType::POLYNOMIAL, EmbeddingType::MULTILEVEL>&, unsigned int, unsigned int);
+
+}
@@ -0,0 +1,142 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/ExactSum.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace LatBuilder {
+
+//===========================================================================
+ExactSum::ExactSum():
+   m_pending(0),
+   m_nan(false),
+   m_positiveInfinity(false),
+   m_negativeInfinity(false)
+{ std::fill(m_digits, m_digits + NumDigits, 0); }
+
+//===========================================================================
+void ExactSum::addSpecial(double x)
+{
+   if (std::isnan(x))
+      m_nan = true;
+   else if (x > 0)
+      m_positiveInfinity = true;
+   else
+      m_negativeInfinity = true;
+}
+
+//===========================================================================
+void ExactSum::normalize()
+{
+   for (int k = 0; k < NumDigits - 1; k++) {
+      const std::int64_t carry = m_digits[k] >> 32;
+      m_digits[k] -= carry * (std::int64_t(1) << 32);
+      m_digits[k + 1] += carry;
+   }
+   m_pending = 0;
+}
+
+//===========================================================================
+ExactSum& ExactSum::merge(const ExactSum& other)
+{
+   ExactSum normalized = other;
+   normalized.normalize();
+   normalize();
+   for (int k = 0; k < NumDigits; k++)
+      m_digits[k] += normalized.m_digits[k];
+   normalize();
+   m_nan = m_nan or other.m_nan;
+   m_positiveInfinity = m_positiveInfinity or other.m_positiveInfinity;
+   m_negativeInfinity = m_negativeInfinity or other.m_negativeInfinity;
+   return *this;
+}
+
+//===========================================================================
+double ExactSum::extract()
+{
+   normalize();
+
+   // the lower digits are nonnegative, so the sign is that of the highest one
+   std::int64_t magnitude[NumDigits];
+   const bool negative = m_digits[NumDigits - 1] < 0;
+   std::copy(m_digits, m_digits + NumDigits, magnitude);
+   if (negative) {
+      std::int64_t borrow = 0;
+      for (int k = 0; k < NumDigits; k++) {
+         const std::int64_t digit = -magnitude[k] - borrow;
+         borrow = digit < 0 ? 1 : 0;
+         magnitude[k] = digit + borrow * (std::int64_t(1) << 32);
+      }
+   }
+
+   int top = NumDigits - 1;
+   while (top >= 0 and magnitude[top] == 0)
+      top--;
+   if (top < 0)
+      return 0.0;
+
+   // the 64 leading bits of the magnitude, and whether any bit below is set
+   const auto digitAt = [&] (int k) { return k >= 0 ? static_cast<std::uint64_t>(magnitude[k]) : std::uint64_t(0); };
+   const std::uint64_t high = digitAt(top);
+   const std::uint64_t low = (digitAt(top - 1) << 32) | digitAt(top - 2);
+   int bits = 0;
+   while (bits < 32 and (high >> bits) != 0)
+      bits++;
+   std::uint64_t leading = (high << (64 - bits)) | (low >> bits);
+   bool sticky = (low & ((std::uint64_t(1) << bits) - 1)) != 0;
+   for (int k = top - 3; k >= 0 and not sticky; k--)
+      sticky = magnitude[k] != 0;
+   // exponent of the lowest of the leading bits
+   const int exponent = 32 * (top - 2) + LowestExponent + bits;
+
+   // round to nearest, ties to even, to 53 bits or to the subnormal precision
+   const int precision = std::min(std::numeric_limits<double>::digits, exponent + 64 + 1074);
+   const int cut = 64 - precision;
+   const std::uint64_t remainder = leading & ((std::uint64_t(1) << cut) - 1);
+   const std::uint64_t half = std::uint64_t(1) << (cut - 1);
+   leading >>= cut;
+   if (remainder > half or (remainder == half and (sticky or (leading & 1))))
+      leading++;
+
+   double rounded = std::ldexp(static_cast<double>(leading), exponent + cut);
+   if (negative)
+      rounded = -rounded;
+   if (std::isfinite(rounded))
+      add(-rounded);
+   return rounded;
+}
+
+//===========================================================================
+Real ExactSum::value() const
+{
+   if (m_nan or (m_positiveInfinity and m_negativeInfinity))
+      return std::numeric_limits<Real>::quiet_NaN();
+   if (m_positiveInfinity)
+      return std::numeric_limits<Real>::infinity();
+   if (m_negativeInfinity)
+      return -std::numeric_limits<Real>::infinity();
+
+   ExactSum rest = *this;
+   const double rounded = rest.extract();
+   if (sizeof(Real) > sizeof(double) and std::isfinite(rounded))
+      return Real(rounded) + Real(rest.extract());
+   return Real(rounded);
+}
+
+}
@@ -0,0 +1,200 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/Execute.h"
+#include "latbuilder/LatBuilder.h"
+#include "latbuilder/Parser/EmbeddingType.h"
+#include "latbuilder/Distributed.h"
+#include "latbuilder/Budget.h"
+#include "latbuilder/Task/EvalLevels.h"
+#include "latbuilder/Trace.h"
+
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+namespace LatBuilder{
+using TextStream::operator<<;
+
+namespace {
+
+template <EmbeddingType ET>
+std::string helper2(const SizeParam<LatticeType::ORDINARY, ET>& param);
+
+template<>
+std::string helper2(const SizeParam<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>& param)
+{
+  return ", embedded from " + std::to_string(param.base()) + " to " + std::to_string(param.maxLevel()) + "\n";
+}
+
+template<>
+std::string helper2(const SizeParam<LatticeType::ORDINARY, EmbeddingType::UNILEVEL>& param)
+{
+  return "\n";
+}
+
+
+/// Outputs the merit value at each level of an evaluation at every level (see Task::EvalLevels).
+template <EmbeddingType ET>
+void writeLevelMerits(const Task::Search<LatticeType::ORDINARY, ET>& search, const std::string& outputFolder)
+{
+   const auto* eval = dynamic_cast<const Task::EvalLevels*>(&search);
+   if (!eval)
+      return;
+   const auto& sizeParam = eval->bestLattice().sizeParam();
+   std::ostringstream stream;
+   stream << "# level    points    merit" << std::endl;
+   for (Level level = 0; level < eval->levelMerits().size(); level++)
+      stream << level << "    " << sizeParam.numPointsOnLevel(level) << "    " << eval->levelMerits()[level] << std::endl;
+   std::cout << "Merit at each level:" << std::endl << stream.str() << std::endl;
+   if (outputFolder != ""){
+      std::ofstream outFile(outputFolder + "/levels.txt");
+      outFile << stream.str();
+   }
+}
+
+template <EmbeddingType ET>
+void executeOrdinary(const Parser::CommandLine<LatticeType::ORDINARY, ET>& cmd, const ExecuteOptions& options)
+{
+   const LatticeType LR = LatticeType::ORDINARY ;
+   using namespace std::chrono;
+
+   const int verbose = options.verbose;
+   const unsigned int repeat = options.repeat;
+   const bool parallelRepeats = options.parallelRepeats;
+   const unsigned int merit_digits_displayed = options.meritDigitsDisplayed;
+   std::string outputFolder = options.outputFolder;
+   std::string outputPoints = options.outputPoints;
+
+   auto search = cmd.parse();
+   setCheckpoint(*search, outputFolder, options.resume);
+   if (!Distributed::isRoot()){ // in an MPI job, only the root process writes the outputs
+      outputFolder = "";
+      outputPoints = "";
+   }
+
+   const std::string separator = "====================\n";
+  
+   std::cout << separator << "    Input" << std::endl << separator << *search << std::endl;
+    if (outputFolder != ""){
+      std::ofstream outFile;
+      std::string fileName = outputFolder + "/input.txt";
+      outFile.open(fileName);
+      outFile << "Input Command Line: " << cmd.originalCommandLine << std::endl << std::endl;
+      outFile << *search; 
+      outFile.close();
+    }
+
+   if (verbose > 0 && !parallelRepeats) {
+      search->onLatticeSelected().connect([merit_digits_displayed](const Task::Search<LR, ET>& s){ onLatticeSelected(s, merit_digits_displayed); });
+      search->setObserverVerbosity(verbose-1);
+      search->setVerbose(verbose-2);
+   }
+
+   // the parallel runs are executed at once and reported as a single one
+   const unsigned int numLoops = parallelRepeats ? 1 : repeat;
+   for (unsigned int i = 0; i < numLoops; i++) {
+        if (numLoops > 1){
+          std::cout << separator << "      Run " << i+1 << std::endl << separator;
+        }
+        else if (parallelRepeats){
+          std::cout << separator << "Running " << repeat << " runs of the task..." << std::endl << separator;
+        }
+        else{
+          std::cout << separator << "Running the task..." << std::endl << separator;
+        }
+
+      Budget::restart(); // each run has the whole budget
+      auto t0 = high_resolution_clock::now();
+      {
+         Trace::Span span("execute", "task");
+         if (parallelRepeats)
+            search = executeParallelRepeats(cmd, std::move(search), repeat);
+         else
+            search->execute();
+      }
+      auto t1 = high_resolution_clock::now();
+      Trace::Span outputSpan("output", "task");
+      writeShardResult(*search, outputFolder);
+
+      unsigned int old_precision = (unsigned int) std::cout.precision();
+      if (merit_digits_displayed)
+   std::cout.precision(merit_digits_displayed);
+     const auto lat = search->bestLattice();
+     
+   auto dt = duration_cast<duration<double>>(t1 - t0);
+         std::cout << std::endl;
+         std::cout << separator << "      Result" << std::endl << separator;
+        std::cout << lat;
+        std::cout << "Merit: " << search->bestMeritValue() << std::endl;
+        if (!std::isinf(Budget::target()) && !(search->bestMeritValue() < Budget::target()))
+          std::cout << "Target merit " << Budget::target() << " not reached" << std::endl;
+        std::cout << std::endl;
+        writeLevelMerits(*search, outputFolder);
+         std::cout << "ELAPSED CPU TIME: " << dt.count() << " seconds" << std::endl << std::endl;
+         writePeakMemory(verbose);
+
+      if (outputFolder != ""){
+        std::ofstream outFile;
+        std::string fileName = outputFolder + "/output.txt";
+        outFile.open(fileName);
+        outFile << "# Input Command Line: " << cmd.originalCommandLine << std::endl;
+        outFile << "# Merit: " << search->bestMeritValue() << std::endl;
+        outFile << "# Parameters for a lattice rule";
+        outFile << helper2<ET>(lat.sizeParam());
+        outFile << lat.dimension() <<"    # s = "<< lat.dimension() << " dimensions\n";
+        outFile << lat.sizeParam().numPoints() <<"    # modulus = n = "<< lat.sizeParam().numPoints() << " points\n";
+        auto vec = lat.gen();
+        outFile << "# Coordinates of generating vector, starting at j=1" << std::endl;
+        for (unsigned int coord = 0; coord < vec.size(); coord++){
+          if (coord < vec.size() - 1){
+            outFile << vec[coord] << std::endl;
+          }
+          else{
+            outFile << vec[coord];
+          }
+        }
+        outFile.close();
+      }
+
+      if (outputPoints != "" && i == numLoops - 1)
+         writePointsFile(LatticePointGenerator(lat), outputPoints, options.pointFormat);
+      
+      if (merit_digits_displayed)
+   std::cout.precision(old_precision);
+
+      search->reset();
+    }
+}
+
+}
+
+//===========================================================================
+void latbuilder_execute_ordinary(const boost::program_options::variables_map& opt, const ExecuteOptions& options)
+{
+   auto cmd = makeCommandLine<LatticeType::ORDINARY>(opt, options.originalCommandLine);
+
+   const auto embedding = Parser::EmbeddingType::parse(opt["multilevel"].as<std::string>());
+   if (options.dryRun)
+      writeDryRun<LatticeType::ORDINARY>(cmd, embedding, options);
+   else if (embedding == EmbeddingType::UNILEVEL)
+      executeOrdinary<EmbeddingType::UNILEVEL>(cmd, options);
+   else
+      executeOrdinary<EmbeddingType::MULTILEVEL>(cmd, options);
+}
+
+}
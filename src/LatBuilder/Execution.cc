@@ -0,0 +1,74 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/Execution.h"
+#include "latbuilder/Budget.h"
+
+namespace LatBuilder
+{
+
+namespace {
+   thread_local Execution* currentExecution = nullptr;
+}
+
+//===============================================================================
+Execution::Scope::Scope(Execution& execution):
+   m_previous(currentExecution)
+{ currentExecution = &execution; }
+
+Execution::Scope::~Scope()
+{ currentExecution = m_previous; }
+
+//===============================================================================
+Execution::Execution():
+   m_cancelled(false),
+   m_firstEvaluation(Budget::evaluations()),
+   m_coordinate(0),
+   m_bestMerit(std::numeric_limits<Real>::infinity())
+{}
+
+//===============================================================================
+void Execution::select(Dimension coordinate, Real merit)
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   m_coordinate = coordinate;
+   m_bestMerit = merit;
+}
+
+auto Execution::progress() const -> Progress
+{
+   Progress progress;
+   // the count restarts with the budget
+   const unsigned long long evaluations = Budget::evaluations();
+   progress.count = evaluations >= m_firstEvaluation ? evaluations - m_firstEvaluation : evaluations;
+   std::lock_guard<std::mutex> lock(m_mutex);
+   progress.coordinate = m_coordinate;
+   progress.bestMerit = m_bestMerit;
+   return progress;
+}
+
+//===============================================================================
+Execution* Execution::current()
+{ return currentExecution; }
+
+void Execution::check()
+{
+   if (currentExecution && currentExecution->cancelled())
+      throw Cancelled();
+}
+
+}
@@ -0,0 +1,93 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/HugePages.h"
+#include "latbuilder/Memory.h"
+
+#include <atomic>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LATBUILDER_HAVE_POSIX_MEMALIGN
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace LatBuilder
+{
+
+namespace {
+   std::atomic<bool> hugePagesEnabled{true};
+
+   // the large allocations are rounded up to whole huge pages, so that none
+   // of their huge pages is shared with another allocation
+   size_t roundUp(size_t bytes)
+   { return (bytes + HugePages::alignment - 1) / HugePages::alignment * HugePages::alignment; }
+}
+
+constexpr size_t HugePages::threshold;
+constexpr size_t HugePages::alignment;
+
+//===============================================================================
+void HugePages::setEnabled(bool enabled)
+{ hugePagesEnabled = enabled; }
+
+bool HugePages::enabled()
+{ return hugePagesEnabled; }
+
+//===============================================================================
+void* HugePages::allocate(size_t bytes)
+{
+#ifdef LATBUILDER_HAVE_POSIX_MEMALIGN
+   if (bytes >= threshold) {
+      const size_t size = roundUp(bytes);
+      void* p = nullptr;
+      if (posix_memalign(&p, alignment, size) != 0)
+         throw std::bad_alloc();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      // only a hint: without transparent huge pages, the vector stays on
+      // ordinary pages
+      if (enabled())
+         madvise(p, size, MADV_HUGEPAGE);
+#endif
+      Memory::allocated(p, size);
+      return p;
+   }
+#endif
+   void* p = ::operator new(bytes);
+   if (bytes >= threshold)
+      Memory::allocated(p, bytes);
+   return p;
+}
+
+//===============================================================================
+void HugePages::deallocate(void* p, size_t bytes) noexcept
+{
+#ifdef LATBUILDER_HAVE_POSIX_MEMALIGN
+   if (bytes >= threshold) {
+      Memory::deallocated(p, roundUp(bytes));
+      std::free(p);
+      return;
+   }
+#endif
+   if (bytes >= threshold)
+      Memory::deallocated(p, bytes);
+   ::operator delete(p);
+}
+
+}
@@ -17,7 +17,7 @@
 #include "latbuilder/Interlaced/IPDWeights.h"
 #include "netbuilder/Types.h"
 
-#include "latticetester/CoordinateSets.h"
+#include <vector>
 
 namespace LatBuilder { namespace Interlaced
 {
@@ -33,19 +33,46 @@ m_baseWeights(std::move(weights))
     fakeWeights.getProductWeights().setDefaultWeight(1);
     kernel.correctPODWeights(fakeWeights);
     typename KERNEL::CorrectionProductWeights correctionProductWeights(kernel); 
-    Dimension dim(m_baseWeights->getSize());
-    if (dim > 0){
-        LatticeTester::CoordinateSets::FromRanges projections(0, dim * kernel.interlacingFactor(), 0, dim * kernel.interlacingFactor() - 1);
-        for (auto cit = projections.begin (); cit != projections.end (); ++cit) {
-            const LatticeTester::Coordinates& projection = *cit;
-            LatticeTester::Coordinates realProjection;
-            for(Dimension coord : projection)
-            {
-                realProjection.insert( coord / kernel.interlacingFactor() );
+    // the interlaced projections of nonzero weight are those whose image by w is a base projection of nonzero weight:
+    // each coordinate j of the base projection contributes a nonempty subset of its components jd, ..., jd + d - 1,
+    // so that they are enumerated from the base projections instead of all the subsets of the ds components
+    const unsigned int d = kernel.interlacingFactor();
+    const unsigned int numSubsets = (1u << d) - 1; // number of nonempty subsets of the components of a coordinate
+    for(size_t largestIndex = 0; largestIndex < m_baseWeights->getSize(); ++largestIndex)
+    {
+        for(const auto& projWeight : m_baseWeights->getWeightsForLargestIndex(largestIndex))
+        {
+            const LatticeTester::Coordinates& realProjection = projWeight.first;
+            const double baseWeight = projWeight.second;
+            if (!(baseWeight > 0) || realProjection.empty()){
+                continue;
             }
-            double baseWeight = m_baseWeights->getWeight(realProjection);
-            if (baseWeight > 0){
-                LatticeTester::ProjectionDependentWeights::setWeight(projection, baseWeight * fakeWeights.getWeight(realProjection) * correctionProductWeights.getWeight(projection));
+            const std::vector<Dimension> coords(realProjection.begin(), realProjection.end());
+            const double realWeight = baseWeight * fakeWeights.getWeight(realProjection);
+            std::vector<unsigned int> subsets(coords.size(), 1); // subset of the components of each coordinate, as a bitmask
+            while (true)
+            {
+                LatticeTester::Coordinates projection;
+                for(size_t i = 0; i < coords.size(); ++i)
+                {
+                    for(unsigned int l = 0; l < d; ++l)
+                    {
+                        if ((subsets[i] >> l) & 1){
+                            projection.insert(coords[i] * d + l);
+                        }
+                    }
+                }
+                LatticeTester::ProjectionDependentWeights::setWeight(projection, realWeight * correctionProductWeights.getWeight(projection));
+
+                size_t i = 0; // next combination of subsets
+                while (i < coords.size() && subsets[i] == numSubsets){
+                    subsets[i] = 1;
+                    ++i;
+                }
+                if (i == coords.size()){
+                    break;
+                }
+                ++subsets[i];
             }
         }
     }
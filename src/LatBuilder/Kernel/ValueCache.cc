@@ -0,0 +1,230 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Kernel/ValueCache.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Memory.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+
+namespace LatBuilder { namespace Kernel {
+
+namespace {
+
+   /*
+    * File format: the magic string, the length of the key, the key, the
+    * number of values and the values, in native representation.
+    */
+   const char MAGIC[8] = {'L', 'N', 'B', 'K', 'E', 'R', 'N', '1'};
+
+   struct Entry {
+      std::string key;
+      std::shared_ptr<const RealVector> values;
+   };
+
+   struct State {
+      std::mutex mutex;
+      std::string directory;
+      size_t capacity = size_t(1) << 30;
+      size_t size = 0;
+      std::list<Entry> entries; // oldest first
+      std::map<std::string, std::list<Entry>::iterator> index;
+   };
+
+   State& state()
+   {
+      static State instance;
+      return instance;
+   }
+
+   size_t bytes(const RealVector& values)
+   { return values.size() * sizeof(Real); }
+
+   // must be called with the mutex locked
+   void evict(State& s)
+   {
+      while (s.size > s.capacity && !s.entries.empty()) {
+         s.size -= bytes(*s.entries.front().values);
+         s.index.erase(s.entries.front().key);
+         s.entries.pop_front();
+      }
+   }
+
+   std::string fileName(const std::string& directory, const std::string& key)
+   {
+      std::ostringstream os;
+      os << directory << "/kernel-" << std::hex << std::hash<std::string>()(key) << ".bin";
+      return os.str();
+   }
+
+   /*
+    * Returns the values stored in the file, or a null pointer if the file
+    * does not exist or was written for another key.
+    */
+   std::shared_ptr<const RealVector> readFile(const std::string& name, const std::string& key)
+   {
+      namespace bip = boost::interprocess;
+
+      if (!boost::filesystem::exists(name))
+         return nullptr;
+
+      try {
+         bip::file_mapping file(name.c_str(), bip::read_only);
+         bip::mapped_region region(file, bip::read_only);
+         const char* data = static_cast<const char*>(region.get_address());
+         const size_t size = region.get_size();
+
+         size_t pos = 0;
+         auto read = [&](void* dest, size_t n) {
+            if (pos + n > size)
+               return false;
+            std::memcpy(dest, data + pos, n);
+            pos += n;
+            return true;
+         };
+
+         char magic[sizeof(MAGIC)];
+         std::uint64_t keySize = 0;
+         if (!read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || !read(&keySize, sizeof(keySize)))
+            return nullptr;
+         if (keySize != key.size() || pos + keySize > size || key.compare(0, key.size(), data + pos, keySize) != 0)
+            return nullptr;
+         pos += keySize;
+
+         std::uint64_t n = 0;
+         if (!read(&n, sizeof(n)) || pos + n * sizeof(Real) != size)
+            return nullptr;
+
+         auto values = std::make_shared<RealVector>(n);
+         if (n > 0)
+            std::memcpy(&(*values)[0], data + pos, n * sizeof(Real));
+         return values;
+      }
+      catch (bip::interprocess_exception&) {
+         return nullptr;
+      }
+   }
+
+   void writeFile(const std::string& name, const std::string& key, const RealVector& values)
+   {
+      const std::string tmpName = name + ".tmp";
+      {
+         std::ofstream file(tmpName, std::ios::binary);
+         if (!file)
+            throw std::runtime_error("cannot write kernel values to " + tmpName);
+         const std::uint64_t keySize = key.size();
+         const std::uint64_t n = values.size();
+         file.write(MAGIC, sizeof(MAGIC));
+         file.write(reinterpret_cast<const char*>(&keySize), sizeof(keySize));
+         file.write(key.data(), (std::streamsize) key.size());
+         file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+         if (n > 0)
+            file.write(reinterpret_cast<const char*>(&values[0]), (std::streamsize) (n * sizeof(Real)));
+         if (!file)
+            throw std::runtime_error("cannot write kernel values to " + tmpName);
+      }
+      if (std::rename(tmpName.c_str(), name.c_str()) != 0)
+         throw std::runtime_error("cannot rename " + tmpName + " to " + name);
+   }
+}
+
+//===============================================================================
+RealVector ValueCache::get(const std::string& key, const std::function<RealVector()>& compute)
+{
+   Profiler::Scope scope(Profiler::Timer::KERNEL_SETUP);
+   Memory::Scope memory(Memory::Component::KERNEL_VALUES);
+   auto& s = state();
+
+   std::string directory;
+   {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      auto it = s.index.find(key);
+      if (it != s.index.end()) {
+         Profiler::count(Profiler::Counter::KERNEL_CACHE_HITS);
+         return *it->second->values;
+      }
+      directory = s.directory;
+   }
+
+   // compute the values without holding the lock; concurrent requests for the
+   // same key may compute them more than once
+   std::shared_ptr<const RealVector> values;
+   if (!directory.empty())
+      values = readFile(fileName(directory, key), key);
+   Profiler::count(values ? Profiler::Counter::KERNEL_CACHE_HITS : Profiler::Counter::KERNEL_CACHE_MISSES);
+   if (!values) {
+      values = std::make_shared<RealVector>(compute());
+      if (!directory.empty())
+         writeFile(fileName(directory, key), key, *values);
+   }
+
+   std::lock_guard<std::mutex> lock(s.mutex);
+   if (s.index.count(key) == 0 && bytes(*values) <= s.capacity) {
+      s.entries.push_back(Entry{key, values});
+      s.index[key] = std::prev(s.entries.end());
+      s.size += bytes(*values);
+      evict(s);
+   }
+   return *values;
+}
+
+//===============================================================================
+void ValueCache::setDirectory(const std::string& directory)
+{
+   if (!directory.empty())
+      boost::filesystem::create_directories(directory);
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   s.directory = directory;
+}
+
+void ValueCache::setCapacity(size_t capacity)
+{
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   s.capacity = capacity;
+   evict(s);
+}
+
+size_t ValueCache::size()
+{
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   return s.size;
+}
+
+void ValueCache::clear()
+{
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   s.entries.clear();
+   s.index.clear();
+   s.size = 0;
+}
+
+}}
@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "latbuilder/LFSR113.h"
+#include "latbuilder/detail/LFSRJump.h"
 #include <limits>
 
 namespace LatBuilder {
@@ -88,6 +89,51 @@ void LFSR113::jump()
    m_s[3] = z;
 }
 
+namespace {
+   typedef detail::LFSRJump<LFSR113::result_type> Jump;
+
+   // parameters (k, q, s) of the components
+   const std::array<Jump, 4>& jumps()
+   {
+      static const std::array<Jump, 4> jumps = {{
+         Jump(31, 6, 18), Jump(29, 2, 2), Jump(28, 13, 7), Jump(25, 3, 13)
+      }};
+      return jumps;
+   }
+}
+
+void LFSR113::jumpPowerOfTwo(unsigned int e)
+{
+   for (unsigned int j = 0; j < m_s.size(); j++)
+      m_s[j] = jumps()[j].jumpPowerOfTwo(m_s[j], e);
+}
+
+void LFSR113::discard(unsigned long long n)
+{
+   for (unsigned int j = 0; j < m_s.size(); j++)
+      m_s[j] = jumps()[j].discard(m_s[j], n);
+}
+
+LFSR113 LFSR113::split()
+{
+   LFSR113 stream(*this);
+   nextStream();
+   return stream;
+}
+
+void LFSR113::fill(result_type* out, size_t n)
+{
+   result_type s0 = m_s[0], s1 = m_s[1], s2 = m_s[2], s3 = m_s[3];
+   for (size_t i = 0; i < n; i++) {
+      s0 = ((s0 &   -2) << 18) ^ (((s0 <<   6) ^ s0) >> 13);
+      s1 = ((s1 &   -8) <<  2) ^ (((s1 <<   2) ^ s1) >> 27);
+      s2 = ((s2 &  -16) <<  7) ^ (((s2 <<  13) ^ s2) >> 21);
+      s3 = ((s3 & -128) << 13) ^ (((s3 <<   3) ^ s3) >> 12);
+      out[i] = s0 ^ s1 ^ s2 ^ s3;
+   }
+   m_s = {{s0, s1, s2, s3}};
+}
+
 void LFSR113::check_seed(const seed_type& s)
 {
    // seed_type is unsigned
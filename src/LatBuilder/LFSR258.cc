@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "latbuilder/LFSR258.h"
+#include "latbuilder/detail/LFSRJump.h"
 #include <limits>
 
 namespace LatBuilder {
@@ -115,6 +116,69 @@ void LFSR258::jump()
    m_s[4] = z;
 }
 
+namespace {
+   typedef detail::LFSRJump<LFSR258::result_type> Jump;
+
+   // parameters (k, q, s) of the components
+   const std::array<Jump, 5>& jumps()
+   {
+      static const std::array<Jump, 5> jumps = {{
+         Jump(63, 1, 10), Jump(55, 24, 5), Jump(52, 3, 29), Jump(47, 5, 23), Jump(41, 3, 8)
+      }};
+      return jumps;
+   }
+}
+
+void LFSR258::jumpPowerOfTwo(unsigned int e)
+{
+   for (unsigned int j = 0; j < m_s.size(); j++)
+      m_s[j] = jumps()[j].jumpPowerOfTwo(m_s[j], e);
+}
+
+void LFSR258::discard(unsigned long long n)
+{
+   for (unsigned int j = 0; j < m_s.size(); j++)
+      m_s[j] = jumps()[j].discard(m_s[j], n);
+}
+
+LFSR258 LFSR258::split()
+{
+   LFSR258 stream(*this);
+   nextStream();
+   return stream;
+}
+
+void LFSR258::fill(result_type* out, size_t n)
+{
+   result_type s0 = m_s[0], s1 = m_s[1], s2 = m_s[2], s3 = m_s[3], s4 = m_s[4];
+   for (size_t i = 0; i < n; i++) {
+      s0 = ((s0 & 18446744073709551614UL) << 10) ^ (((s0 << 1) ^ s0) >> 53);
+      s1 = ((s1 & 18446744073709551104UL) << 5) ^ (((s1 << 24) ^ s1) >> 50);
+      s2 = ((s2 & 18446744073709547520UL) << 29) ^ (((s2 << 3) ^ s2) >> 23);
+      s3 = ((s3 & 18446744073709420544UL) << 23) ^ (((s3 << 5) ^ s3) >> 24);
+      s4 = ((s4 & 18446744073701163008UL) << 8) ^ (((s4 << 3) ^ s4) >> 33);
+      out[i] = s0 ^ s1 ^ s2 ^ s3 ^ s4;
+   }
+   m_s = {{s0, s1, s2, s3, s4}};
+}
+
+namespace {
+   LFSR258::seed_type& threadSeed()
+   {
+      thread_local LFSR258::seed_type seed = LFSR258::default_seed;
+      return seed;
+   }
+}
+
+auto LFSR258::threadDefaultSeed() -> const seed_type&
+{ return threadSeed(); }
+
+void LFSR258::setThreadDefaultSeed(seed_type s)
+{
+   LFSR258 checked(std::move(s));
+   threadSeed() = checked.seed();
+}
+
 void LFSR258::check_seed(const seed_type& s)
 {
    if ((s[0] < 2)  or
@@ -0,0 +1,75 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/MappedTable.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+
+namespace LatBuilder
+{
+
+namespace {
+   const char MAGIC[8] = {'L', 'N', 'B', 'T', 'A', 'B', 'L', '1'};
+}
+
+//===============================================================================
+std::unique_ptr<MappedTable> MappedTable::open(const std::string& fileName)
+{
+   namespace bip = boost::interprocess;
+
+   if (!boost::filesystem::exists(fileName))
+      return nullptr;
+
+   std::unique_ptr<MappedTable> table(new MappedTable);
+   try {
+      table->m_file = bip::file_mapping(fileName.c_str(), bip::read_only);
+      table->m_region = bip::mapped_region(table->m_file, bip::read_only);
+   }
+   catch (bip::interprocess_exception&) {
+      return nullptr;
+   }
+
+   // the region is page-aligned, and so are the 64-bit words of the file
+   const char* data = static_cast<const char*>(table->m_region.get_address());
+   const size_t size = table->m_region.get_size();
+   const size_t words = size / sizeof(std::uint64_t);
+   if (size % sizeof(std::uint64_t) != 0 || words < 3 || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+      return nullptr;
+
+   const std::uint64_t* header = reinterpret_cast<const std::uint64_t*>(data);
+   const std::uint64_t numRows = header[1];
+   if (numRows > words - 3)
+      return nullptr;
+   const std::uint64_t* offsets = header + 2;
+   const std::uint64_t numValues = words - 3 - numRows;
+
+   // check the offsets once, so that the rows can be accessed without checks
+   if (offsets[0] != 0 || offsets[numRows] != numValues)
+      return nullptr;
+   for (std::uint64_t i = 0; i < numRows; i++) {
+      if (offsets[i] > offsets[i + 1])
+         return nullptr;
+   }
+
+   table->m_numRows = static_cast<size_t>(numRows);
+   table->m_offsets = offsets;
+   table->m_values = offsets + numRows + 1;
+   return table;
+}
+
+}
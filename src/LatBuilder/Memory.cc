@@ -0,0 +1,173 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/Memory.h"
+
+#include <array>
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace LatBuilder
+{
+
+namespace {
+
+   struct State {
+      std::array<std::atomic<size_t>, Memory::NUM_COMPONENTS> bytes;
+      std::array<std::atomic<size_t>, Memory::NUM_COMPONENTS> peaks;
+      std::atomic<size_t> total{0};
+      std::atomic<size_t> peakTotal{0};
+
+      // component charged with each large allocation
+      std::mutex mutex;
+      std::unordered_map<const void*, Memory::Component> allocations;
+
+      State()
+      {
+         for (auto& x : bytes) x = 0;
+         for (auto& x : peaks) x = 0;
+      }
+   };
+
+   // never destroyed, as the static vectors of the other units may be freed
+   // after it at the end of the process
+   State& state()
+   {
+      static State* instance = new State;
+      return *instance;
+   }
+
+   thread_local Memory::Component currentComponent = Memory::Component::OTHER;
+
+   const char* const componentNames[Memory::NUM_COMPONENTS] = {
+      "storage", "kernel-values", "states", "fft-buffers", "projections", "other"
+   };
+
+   unsigned int index(Memory::Component component)
+   { return static_cast<unsigned int>(component); }
+
+   void raise(std::atomic<size_t>& peak, size_t value)
+   {
+      size_t old = peak.load(std::memory_order_relaxed);
+      while (value > old && !peak.compare_exchange_weak(old, value, std::memory_order_relaxed)) {}
+   }
+}
+
+constexpr unsigned int Memory::NUM_COMPONENTS;
+
+//===============================================================================
+Memory::Scope::Scope(Component component):
+   m_previous(currentComponent)
+{ currentComponent = component; }
+
+Memory::Scope::~Scope()
+{ currentComponent = m_previous; }
+
+Memory::Component Memory::current()
+{ return currentComponent; }
+
+//===============================================================================
+void Memory::allocated(const void* p, size_t bytes)
+{
+   auto& s = state();
+   const auto component = current();
+   {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.allocations[p] = component;
+   }
+   add(component, bytes);
+}
+
+void Memory::deallocated(const void* p, size_t bytes) noexcept
+{
+   auto& s = state();
+   Component component;
+   {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      auto it = s.allocations.find(p);
+      if (it == s.allocations.end())
+         return;
+      component = it->second;
+      s.allocations.erase(it);
+   }
+   remove(component, bytes);
+}
+
+void Memory::add(Component component, size_t bytes)
+{
+   auto& s = state();
+   raise(s.peaks[index(component)], s.bytes[index(component)].fetch_add(bytes, std::memory_order_relaxed) + bytes);
+   raise(s.peakTotal, s.total.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+}
+
+void Memory::remove(Component component, size_t bytes) noexcept
+{
+   auto& s = state();
+   s.bytes[index(component)].fetch_sub(bytes, std::memory_order_relaxed);
+   s.total.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+//===============================================================================
+size_t Memory::bytes(Component component)
+{ return state().bytes[index(component)].load(); }
+
+size_t Memory::peakBytes(Component component)
+{ return state().peaks[index(component)].load(); }
+
+size_t Memory::totalBytes()
+{ return state().total.load(); }
+
+size_t Memory::peakTotalBytes()
+{ return state().peakTotal.load(); }
+
+void Memory::resetPeaks()
+{
+   auto& s = state();
+   for (unsigned int i = 0; i < NUM_COMPONENTS; i++)
+      s.peaks[i] = s.bytes[i].load();
+   s.peakTotal = s.total.load();
+}
+
+std::string Memory::name(Component component)
+{ return componentNames[index(component)]; }
+
+std::string Memory::format(double bytes)
+{
+   const char* const units[] = {"B", "KiB", "MiB", "GiB", "TiB", "PiB"};
+   unsigned int unit = 0;
+   while (bytes >= 1024 && unit + 1 < sizeof(units) / sizeof(units[0])) {
+      bytes /= 1024;
+      unit++;
+   }
+   std::ostringstream os;
+   os << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << bytes << " " << units[unit];
+   return os.str();
+}
+
+void Memory::writePeaks(std::ostream& os)
+{
+   for (unsigned int i = 0; i < NUM_COMPONENTS; i++) {
+      const auto component = static_cast<Component>(i);
+      os << "  " << std::left << std::setw(16) << name(component) << std::right << format(peakBytes(component)) << std::endl;
+   }
+   os << "  " << std::left << std::setw(16) << "total" << std::right << format(peakTotalBytes()) << std::endl;
+}
+
+}
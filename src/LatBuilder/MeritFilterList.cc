@@ -53,7 +53,22 @@ Real MeritFilterListPolicy<LR, EmbeddingType::UNILEVEL>::applyFilters(Real merit
 
 template< LatticeType LR>
 Real MeritFilterListPolicy<LR, EmbeddingType::MULTILEVEL>::applyFilters(const RealVector& merit, const typename EBase::LatDef& lat) const
-{ return OBase::apply(combiner()(EBase::apply(merit, lat), lat), lat); }
+{
+   if (not LevelVector::fits(merit.size()))
+      return OBase::apply(combiner()(EBase::apply(merit, lat), lat), lat);
+
+   // apply the multilevel filters and the combiner in place, on the stack
+   LevelVector levels(merit);
+   try {
+      for (const auto& filter : EBase::filters())
+         filter->apply(levels, lat);
+   }
+   catch (LatticeRejectedException&) {
+      EBase::onReject()(lat);
+      levels.fill(std::numeric_limits<Real>::infinity());
+   }
+   return OBase::apply(combiner().apply(levels, lat), lat);
+}
 
 template class MeritFilterListPolicy<LatticeType::ORDINARY, EmbeddingType::UNILEVEL>;
 template class MeritFilterListPolicy<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>;
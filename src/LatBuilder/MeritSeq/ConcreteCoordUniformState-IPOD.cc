@@ -15,8 +15,10 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-IPOD.h"
+#include "latbuilder/MeritSeq/StateBlocks.h"
 #include "latbuilder/TextStream.h"
 #include <iostream>
+#include <vector>
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -24,6 +26,9 @@ namespace LatBuilder { namespace MeritSeq {
 // IPODWeights
 //========================================================================
 
+using detail::STATE_BLOCK_SIZE;
+using detail::forEachStateBlock;
+
 #define CONCRETE_COORD_UNIF_STATE(KERNEL)\
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>\
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatBuilder::Interlaced::IPODWeights<KERNEL>>::\
@@ -48,10 +53,8 @@ ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatBuilder::Interlaced::IPODWei
 reset()\
 {\
    CoordUniformState<LR, ET, COMPRESS, PLO>::reset();\
-   m_state.clear();\
-   m_partialWeightedState.clear(); \
-   m_elemPolySum.clear();\
-   m_state.push_back(RealVector(this->storage().size(), 1.0));\
+   Memory::Scope memory(Memory::Component::STATES);\
+   m_state.reset(this->storage().size(), 1.0);\
    m_partialWeightedState = RealVector(this->storage().size(), m_weights.getWeightForOrder(1));\
    m_elemPolySum = RealVector(this->storage().size(), 1.); /*the first elementary symmetric polynomial equals 1*/\
 }\
@@ -65,34 +68,56 @@ update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen)
    CoordUniformState<LR, ET, COMPRESS, PLO>::update(kernelValues, gen);\
    const auto newCoordinate = this->dimension() - 1;\
 \
-   auto stridedKernelValues = this->storage().strided(kernelValues, gen);\
-   Real dweight = m_weights.getCorrectionProductWeightForCoordinate(newCoordinate);\
-   m_elemPolySum = boost::numeric::ublas::element_prod(\
-      m_elemPolySum,\
-      RealVector(this->storage().size(), 1.) + dweight * stridedKernelValues\
-      );\
-   if (newCoordinate % m_interlacingFactor == m_interlacingFactor-1){\
-      /*we are changing of `real` coordinate*/\
-      m_elemPolySum -= RealVector(this->storage().size(), 1.);\
-\
-      const Real pweight = m_weights.getWeightForCoordinate(newCoordinate / m_interlacingFactor);\
-\
-      \
-      m_state.push_back(RealVector(this->storage().size(), 0.0));\
-\
-      for (size_t order = m_state.size() - 1; order > 0; order--)\
-            m_state[order] += boost::numeric::ublas::element_prod(\
-                  pweight * m_elemPolySum,\
-                  m_state[order - 1]\
-                  );\
-\
-      m_partialWeightedState = RealVector(this->storage().size(), 0.);\
-      for (size_t order = 0; order < m_state.size(); order++){\
-            m_partialWeightedState += m_weights.getWeightForOrder(order+1) * m_state[order];\
-      }\
-      m_elemPolySum = RealVector(this->storage().size(), 1.);\
-\
+   const size_t n = this->storage().size();\
+   const Real dweight = m_weights.getCorrectionProductWeightForCoordinate(newCoordinate);\
+   Real* const elemPolySum = &m_elemPolySum[0];\
+\
+   if (newCoordinate % m_interlacingFactor != m_interlacingFactor-1){\
+      forEachStateBlock(n, [&] (size_t begin, size_t end) {\
+         alignas(32) Real w[STATE_BLOCK_SIZE];\
+         this->storage().gather(kernelValues, gen, begin, end, w);\
+         for (size_t i = 0; i < end - begin; i++)\
+            elemPolySum[begin + i] *= 1 + dweight * w[i];\
+      });\
+      return;\
    }\
+\
+   /*we are changing of `real` coordinate: the last factor of the elementary*/\
+   /*symmetric polynomials, the orders, the partial weighted state and the*/\
+   /*reset of the polynomials are fused in one pass over the points*/\
+   const Real pweight = m_weights.getWeightForCoordinate(newCoordinate / m_interlacingFactor);\
+\
+   m_state.appendRow(0.0);\
+\
+   const size_t maxOrder = m_state.numRows() - 1;\
+   std::vector<Real> orderWeights(maxOrder + 1);\
+   for (size_t order = 0; order <= maxOrder; order++)\
+      orderWeights[order] = m_weights.getWeightForOrder(order + 1);\
+\
+   Real* const state = m_state.row(0);\
+   const size_t rowSize = m_state.rowSize();\
+   Real* const partialWeightedState = &m_partialWeightedState[0];\
+\
+   forEachStateBlock(n, m_state, [&] (size_t begin, size_t end) {\
+      alignas(32) Real e[STATE_BLOCK_SIZE];\
+      this->storage().gather(kernelValues, gen, begin, end, e);\
+      for (size_t i = 0; i < end - begin; i++) {\
+         e[i] = pweight * (elemPolySum[begin + i] * (1 + dweight * e[i]) - 1);\
+         elemPolySum[begin + i] = 1.;\
+         partialWeightedState[begin + i] = 0.;\
+      }\
+      /*recursive update by decreasing order to avoid unwanted overwriting*/\
+      for (size_t order = maxOrder; order > 0; order--) {\
+         Real* const row = state + order * rowSize + begin;\
+         detail::addProduct(row, e, row - rowSize, end - begin);\
+      }\
+      for (size_t order = 0; order <= maxOrder; order++) {\
+         const Real weight = orderWeights[order];\
+         if (weight == 0.0)\
+            continue;\
+         detail::addScaled(partialWeightedState + begin, weight, state + order * rowSize + begin, end - begin);\
+      }\
+   });\
 }\
 \
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>\
@@ -100,17 +125,50 @@ RealVector \
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatBuilder::Interlaced::IPODWeights<KERNEL>>::\
 weightedState() const\
 {\
-   using LatticeTester::Coordinates;\
-\
    const auto nextCoordinate = this->dimension();\
 \
    const Real pweight = m_weights.getWeightForCoordinate(nextCoordinate / m_interlacingFactor);\
    const Real dweight = m_weights.getCorrectionProductWeightForCoordinate(nextCoordinate);\
+   const Real weight = pweight * dweight;\
+\
+   const size_t n = this->storage().size();\
+   RealVector weightedState(n);\
+   Real* const out = &weightedState[0];\
+   const Real* const elemPolySum = &m_elemPolySum[0];\
+   const Real* const partialWeightedState = &m_partialWeightedState[0];\
+\
+   forEachStateBlock(n, [&] (size_t begin, size_t end) {\
+      for (size_t i = begin; i < end; i++)\
+         out[i] = weight * elemPolySum[i] * partialWeightedState[i];\
+   });\
+\
+   return weightedState;\
+}\
 \
-   return boost::numeric::ublas::element_prod(\
-         pweight * dweight * m_elemPolySum,\
-         m_partialWeightedState\
-   );\
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>\
+void \
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatBuilder::Interlaced::IPODWeights<KERNEL>>::\
+save(std::ostream& os) const\
+{\
+   CoordUniformState<LR, ET, COMPRESS, PLO>::save(os);\
+   StateIO::write(os, m_elemPolySum);\
+   StateIO::write(os, m_partialWeightedState);\
+   m_state.save(os);\
+}\
+\
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>\
+void \
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatBuilder::Interlaced::IPODWeights<KERNEL>>::\
+load(std::istream& is)\
+{\
+   CoordUniformState<LR, ET, COMPRESS, PLO>::load(is);\
+   Memory::Scope memory(Memory::Component::STATES);\
+   StateIO::read(is, m_elemPolySum);\
+   StateIO::read(is, m_partialWeightedState);\
+   m_state.load(is);\
+   const size_t n = this->storage().size();\
+   if (m_elemPolySum.size() != n or m_partialWeightedState.size() != n or m_state.numColumns() != n)\
+      throw std::runtime_error("invalid coordinate-uniform state");\
 }\
 \
 /*Ordinary state must be instantiated for compatibility purposes but will throw a runtime error when constructed.*/\
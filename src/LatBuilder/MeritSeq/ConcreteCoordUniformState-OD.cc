@@ -15,6 +15,9 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-OD.h"
+#include "latbuilder/MeritSeq/StateBlocks.h"
+
+#include <vector>
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -22,15 +25,17 @@ namespace LatBuilder { namespace MeritSeq {
 // OrderDependentWeights
 //========================================================================
 
+using detail::STATE_BLOCK_SIZE;
+using detail::forEachStateBlock;
+
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 void
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::OrderDependentWeights>::
 reset()
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::reset();
-   m_state.clear();
    // order 0
-   m_state.push_back(RealVector(this->storage().size(), 1.0));
+   m_state.reset(this->storage().size(), 1.0);
 }
 
 //===========================================================================
@@ -42,17 +47,26 @@ update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen)
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::update(kernelValues, gen);
 
-   auto stridedKernelValues = this->storage().strided(kernelValues, gen);
+   const size_t n = this->storage().size();
 
    // add new order
-   m_state.push_back(RealVector(this->storage().size(), 0.0));
-
-   // recursive update by decreasing order to avoid unwanted overwriting
-   for (size_t order = m_state.size() - 1; order > 0; order--)
-      m_state[order] += boost::numeric::ublas::element_prod(
-            stridedKernelValues,
-            m_state[order - 1]
-            );
+   m_state.appendRow(0.0);
+
+   const size_t maxOrder = m_state.numRows() - 1;
+   Real* const state = m_state.row(0);
+   const size_t rowSize = m_state.rowSize();
+
+   forEachStateBlock(n, m_state, [&] (size_t begin, size_t end) {
+      // the permuted kernel values of the block are gathered once for all
+      // orders
+      alignas(32) Real w[STATE_BLOCK_SIZE];
+      this->storage().gather(kernelValues, gen, begin, end, w);
+      // recursive update by decreasing order to avoid unwanted overwriting
+      for (size_t order = maxOrder; order > 0; order--) {
+         Real* const row = state + order * rowSize + begin;
+         detail::addProduct(row, w, row - rowSize, end - begin);
+      }
+   });
 }
 
 //===========================================================================
@@ -62,22 +76,51 @@ RealVector
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::OrderDependentWeights>::
 weightedState() const
 {
-   using LatticeTester::Coordinates;
+   const size_t n = this->storage().size();
+
+   std::vector<Real> weights(m_state.numRows());
+   for (size_t order = 0; order < weights.size(); order++)
+      weights[order] = m_weights.getWeightForOrder(order + 1);
 
    RealVector weightedState =
-      boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 0.0);
+      boost::numeric::ublas::scalar_vector<Real>(n, 0.0);
 
-   for (Coordinates::size_type order = 0; order < m_state.size(); order++) {
+   Real* const out = &weightedState[0];
 
-      Real weight = m_weights.getWeightForOrder(order + 1);
+   forEachStateBlock(n, m_state, [&] (size_t begin, size_t end) {
+      for (size_t order = 0; order < weights.size(); order++) {
+         const Real weight = weights[order];
+         if (weight == 0.0)
+            continue;
+         detail::addScaled(out + begin, weight, m_state.row(order) + begin, end - begin);
+      }
+   });
 
-      if (weight == 0.0)
-         continue;
+   return weightedState;
+}
 
-      weightedState += weight * m_state[order];
-   }
+//===========================================================================
 
-   return weightedState;
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+void
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::OrderDependentWeights>::
+save(std::ostream& os) const
+{
+   CoordUniformState<LR, ET, COMPRESS, PLO>::save(os);
+   m_state.save(os);
+}
+
+//===========================================================================
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+void
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::OrderDependentWeights>::
+load(std::istream& is)
+{
+   CoordUniformState<LR, ET, COMPRESS, PLO>::load(is);
+   m_state.load(is);
+   if (m_state.numColumns() != this->storage().size())
+      throw std::runtime_error("invalid coordinate-uniform state");
 }
 
 template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC,      LatticeTester::OrderDependentWeights>;
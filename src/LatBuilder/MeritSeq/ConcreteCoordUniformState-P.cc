@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-P.h"
+#include "latbuilder/MeritSeq/StateBlocks.h"
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -22,12 +23,16 @@ namespace LatBuilder { namespace MeritSeq {
 // ProductWeights
 //========================================================================
 
+using detail::STATE_BLOCK_SIZE;
+using detail::forEachStateBlock;
+
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 void
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProductWeights>::
 reset()
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::reset();
+   Memory::Scope memory(Memory::Component::STATES);
    m_state.clear();
    m_state = boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 1.0);
 }
@@ -41,18 +46,20 @@ update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen)
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::update(kernelValues, gen);
 
-   auto stridedKernelValues = this->storage().strided(kernelValues, gen);
-
    const auto newCoordinate = this->dimension() - 1;
 
    const Real weight = m_weights.getWeightForCoordinate(newCoordinate);
 
-   const auto ones = boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 1.0);
+   const size_t n = this->storage().size();
+
+   Real* const state = n > 0 ? &m_state[0] : nullptr;
 
-   m_state = boost::numeric::ublas::element_prod(
-         ones + weight * stridedKernelValues,
-         m_state
-         );
+   forEachStateBlock(n, [&] (size_t begin, size_t end) {
+      alignas(32) Real w[STATE_BLOCK_SIZE];
+      this->storage().gather(kernelValues, gen, begin, end, w);
+      for (size_t i = 0; i < end - begin; i++)
+         state[begin + i] *= 1.0 + weight * w[i];
+   });
 }
 
 //===========================================================================
@@ -69,6 +76,31 @@ weightedState() const
    return weight * m_state;
 }
 
+//===========================================================================
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+void
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProductWeights>::
+save(std::ostream& os) const
+{
+   CoordUniformState<LR, ET, COMPRESS, PLO>::save(os);
+   StateIO::write(os, m_state);
+}
+
+//===========================================================================
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+void
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProductWeights>::
+load(std::istream& is)
+{
+   CoordUniformState<LR, ET, COMPRESS, PLO>::load(is);
+   Memory::Scope memory(Memory::Component::STATES);
+   StateIO::read(is, m_state);
+   if (m_state.size() != this->storage().size())
+      throw std::runtime_error("invalid coordinate-uniform state");
+}
+
 template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC,      LatticeTester::ProductWeights>;
 template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::SYMMETRIC, PerLevelOrder::BASIC, LatticeTester::ProductWeights>;
 template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL, Compress::NONE, PerLevelOrder::CYCLIC,      LatticeTester::ProductWeights>;
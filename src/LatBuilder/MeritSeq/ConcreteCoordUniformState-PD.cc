@@ -15,6 +15,9 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-PD.h"
+#include "latbuilder/MeritSeq/StateBlocks.h"
+
+#include <algorithm>
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -22,48 +25,133 @@ namespace LatBuilder { namespace MeritSeq {
 // ProjectionDependentWeights
 //========================================================================
 
+using detail::STATE_BLOCK_SIZE;
+using detail::forEachStateBlock;
+
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 void
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights>::
 reset()
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::reset();
-   m_state.clear();
+   plan();
+   m_freeRows.clear();
+   m_stateRows.clear();
+   m_mergedRows.clear();
    // empty set
-   m_state[LatticeTester::Coordinates()] =
-      boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 1.0);
-   m_gen.clear();
+   m_rows.reset(this->storage().size(), 1.0);
+   m_stateRows[LatticeTester::Coordinates()] = 0;
+   collect();
+}
+
+//===========================================================================
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+void
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights>::
+plan()
+{
+   using LatticeTester::Coordinates;
+
+   m_projections.clear();
+   m_byLargestCoordinate.clear();
+   m_projections[Coordinates()];
+
+   for (Dimension largestIndex = 0; largestIndex < m_weights.getSize(); largestIndex++) {
+      for (const auto& pw : m_weights.getWeightsForLargestIndex(largestIndex)) {
+         if (pw.second == 0.0)
+            continue;
+         // remove largest coordinate index
+         Coordinates proj = pw.first;
+         proj.erase(*proj.rbegin());
+         m_projections[proj].extensions.emplace_back(largestIndex, pw.second);
+         // the projections from which proj is built
+         while (not proj.empty()) {
+            const auto largestCoord = *proj.rbegin();
+            proj.erase(largestCoord);
+            auto& base = m_projections[proj];
+            base.childrenEnd = std::max<Dimension>(base.childrenEnd, largestCoord + 1);
+         }
+      }
+   }
+
+   for (const auto& p : m_projections) {
+      if (p.first.empty())
+         continue;
+      const auto largestCoord = *p.first.rbegin();
+      if (m_byLargestCoordinate.size() <= largestCoord)
+         m_byLargestCoordinate.resize(largestCoord + 1);
+      m_byLargestCoordinate[largestCoord].push_back(p.first);
+   }
 }
 
 //===========================================================================
 
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
-const RealVector&
+size_t
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights>::
-createStateVector(const LatticeTester::Coordinates& projection, const RealVector& kernelValues)
+allocateRow()
 {
-   auto it = m_state.find(projection);
-   if (it != m_state.end())
-      return it->second;
-
-   // select largest index
-   const LatticeTester::Coordinates::value_type largestCoord = *projection.rbegin();
-
-   // remove largest coordinate index
-   LatticeTester::Coordinates baseProjection = projection;
-   baseProjection.erase(largestCoord);
-   // create base state vector
-   const RealVector& baseState = createStateVector(baseProjection, kernelValues);
-
-   // compute merit value for new projection
-   auto stridedKernelValues = this->storage().strided(
-         kernelValues,
-         m_gen[largestCoord]
-         );
-   return m_state[projection] = boost::numeric::ublas::element_prod(
-         stridedKernelValues,
-         baseState
-         );
+   if (not m_freeRows.empty()) {
+      const size_t row = m_freeRows.back();
+      m_freeRows.pop_back();
+      return row;
+   }
+   m_rows.appendRow(0.0);
+   return m_rows.numRows() - 1;
+}
+
+//===========================================================================
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+void
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights>::
+collect()
+{
+   const Dimension dimension = this->dimension();
+   const size_t n = this->storage().size();
+
+   for (auto it = m_mergedRows.begin(); it != m_mergedRows.end() and it->first < dimension; ) {
+      m_freeRows.push_back(it->second);
+      it = m_mergedRows.erase(it);
+   }
+
+   for (auto it = m_stateRows.begin(); it != m_stateRows.end(); ) {
+      const Projection& proj = m_projections.at(it->first);
+      if (proj.childrenEnd > dimension) {
+         ++it;
+         continue;
+      }
+      // the extensions not reached yet
+      std::vector<std::pair<Dimension, Real>> pending;
+      size_t missing = 0;
+      for (const auto& ext : proj.extensions) {
+         if (ext.first < dimension)
+            continue;
+         pending.push_back(ext);
+         missing += m_mergedRows.count(ext.first) ? 0 : 1;
+      }
+      if (not pending.empty() and missing > 1) {
+         // merging would take more memory than keeping the vector
+         ++it;
+         continue;
+      }
+      for (const auto& ext : pending) {
+         auto merged = m_mergedRows.find(ext.first);
+         if (merged == m_mergedRows.end()) {
+            merged = m_mergedRows.emplace(ext.first, allocateRow()).first;
+            std::fill(m_rows.row(merged->second), m_rows.row(merged->second) + n, 0.0);
+         }
+         const Real weight = ext.second;
+         Real* const out = m_rows.row(merged->second);
+         const Real* const in = m_rows.row(it->second);
+         forEachStateBlock(n, m_rows, [&] (size_t begin, size_t end) {
+            detail::addScaled(out + begin, weight, in + begin, end - begin);
+         });
+      }
+      m_freeRows.push_back(it->second);
+      it = m_stateRows.erase(it);
+   }
 }
 
 //===========================================================================
@@ -74,19 +162,36 @@ ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDepend
 update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen)
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::update(kernelValues, gen);
-   m_gen.push_back(gen);
-
-   // Create a new state vector for each projection $\mathfrak u$ such that
-   // $\max \mathfrak u$ < $j$ and that $\mathfrak u \cup \{j\}$ has a nonzero
-   // weight.
-   const auto nextCoordinate = this->dimension();
-   for (const auto& pw : m_weights.getWeightsForLargestIndex(nextCoordinate)) {
-      // remove largest coordinate index
-      LatticeTester::Coordinates proj = pw.first;
-      proj.erase(*proj.rbegin());
-      // create state vector
-      createStateVector(proj, kernelValues);
+
+   const Dimension coordinate = this->dimension() - 1;
+   const size_t n = this->storage().size();
+
+   // Create the state vector of each needed projection $\mathfrak u$ such
+   // that $\max \mathfrak u = j$, from that of $\mathfrak u \setminus \{j\}$.
+   std::vector<std::pair<size_t, size_t>> rows; // (new row, base row)
+   if (coordinate < m_byLargestCoordinate.size()) {
+      for (const auto& proj : m_byLargestCoordinate[coordinate]) {
+         LatticeTester::Coordinates baseProj = proj;
+         baseProj.erase(coordinate);
+         const size_t row = allocateRow();
+         rows.emplace_back(row, m_stateRows.at(baseProj));
+         m_stateRows[proj] = row;
+      }
    }
+
+   if (not rows.empty()) {
+      forEachStateBlock(n, m_rows, [&] (size_t begin, size_t end) {
+         // the permuted kernel values of the block are gathered once for all
+         // projections
+         alignas(32) Real w[STATE_BLOCK_SIZE];
+         this->storage().gather(kernelValues, gen, begin, end, w);
+         for (const auto& r : rows) {
+            detail::multiply(m_rows.row(r.first) + begin, w, m_rows.row(r.second) + begin, end - begin);
+         }
+      });
+   }
+
+   collect();
 }
 
 //===========================================================================
@@ -96,30 +201,74 @@ RealVector
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights>::
 weightedState() const
 {
-   using LatticeTester::Coordinates;
+   const Dimension nextCoordinate = this->dimension();
+   const size_t n = this->storage().size();
 
-   const auto nextCoordinate = this->dimension();
+   // rows to combine, with their weights
+   std::vector<std::pair<const Real*, Real>> terms;
+   const auto merged = m_mergedRows.find(nextCoordinate);
+   if (merged != m_mergedRows.end())
+      terms.emplace_back(m_rows.row(merged->second), 1.0);
+   for (const auto& sr : m_stateRows) {
+      for (const auto& ext : m_projections.at(sr.first).extensions) {
+         if (ext.first == nextCoordinate)
+            terms.emplace_back(m_rows.row(sr.second), ext.second);
+      }
+   }
 
    RealVector weightedState =
-      boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 0.0);
-
-   for (const auto& pw : m_weights.getWeightsForLargestIndex(nextCoordinate)) {
-      // remove largest coordinate index
-      LatticeTester::Coordinates proj = pw.first;
-      proj.erase(*proj.rbegin());
-      // find state vector
-      auto it = m_state.find(proj);
-      if (it == m_state.end())
-         throw std::runtime_error("projection-dependent state was not created");
-      // contribute to weighted state
-      weightedState += pw.second * it->second;
-   }
+      boost::numeric::ublas::scalar_vector<Real>(n, 0.0);
+
+   if (terms.empty())
+      return weightedState;
+
+   Real* const out = &weightedState[0];
+
+   forEachStateBlock(n, m_rows, [&] (size_t begin, size_t end) {
+      for (const auto& term : terms) {
+         detail::addScaled(out + begin, term.second, term.first + begin, end - begin);
+      }
+   });
 
    return weightedState;
 }
 
 //===========================================================================
 
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+void
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights>::
+save(std::ostream& os) const
+{
+   CoordUniformState<LR, ET, COMPRESS, PLO>::save(os);
+   m_rows.save(os);
+   StateIO::write(os, m_freeRows);
+   StateIO::write(os, m_stateRows);
+   StateIO::write(os, m_mergedRows);
+}
+
+//===========================================================================
+
+template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
+void
+ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights>::
+load(std::istream& is)
+{
+   CoordUniformState<LR, ET, COMPRESS, PLO>::load(is);
+   // the projections only depend on the weights
+   plan();
+   m_rows.load(is);
+   StateIO::read(is, m_freeRows);
+   StateIO::read(is, m_stateRows);
+   StateIO::read(is, m_mergedRows);
+   if (m_rows.numColumns() != this->storage().size())
+      throw std::runtime_error("invalid coordinate-uniform state");
+   for (const auto& sr : m_stateRows) {
+      if (m_projections.count(sr.first) == 0 or sr.second >= m_rows.numRows())
+         throw std::runtime_error("the saved coordinate-uniform state does not match the projection-dependent weights");
+   }
+}
+
 template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC,      LatticeTester::ProjectionDependentWeights>;
 template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::SYMMETRIC, PerLevelOrder::BASIC, LatticeTester::ProjectionDependentWeights>;
 template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL, Compress::NONE, PerLevelOrder::CYCLIC,      LatticeTester::ProjectionDependentWeights>;
@@ -0,0 +1,187 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/MeritSeq/StateBlocks.h"
+#include "latbuilder/CpuDispatch.h"
+
+#include <type_traits>
+
+// explicit AArch64 implementations, in double precision: NEON, which every
+// AArch64 host has, and SVE, selected at run time
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(LATNETBUILDER_REAL_FLOAT) && !defined(LATNETBUILDER_REAL_LONG_DOUBLE)
+#define LATBUILDER__STATE_BLOCKS_NEON
+#include <arm_neon.h>
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED
+#define LATBUILDER__STATE_BLOCKS_SVE
+#include <arm_sve.h>
+#endif
+#endif
+
+namespace LatBuilder { namespace MeritSeq { namespace detail {
+
+#if defined(LATBUILDER__STATE_BLOCKS_NEON)
+namespace {
+   static_assert(std::is_same<Real, double>::value, "the NEON kernels are in double precision");
+
+   void addProductNeon(Real* out, const Real* a, const Real* b, size_t n)
+   {
+      size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+         vst1q_f64(out + i, vfmaq_f64(vld1q_f64(out + i), vld1q_f64(a + i), vld1q_f64(b + i)));
+      for (; i < n; i++)
+         out[i] += a[i] * b[i];
+   }
+
+   void addScaledNeon(Real* out, Real weight, const Real* in, size_t n)
+   {
+      const float64x2_t w = vdupq_n_f64(weight);
+      size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+         vst1q_f64(out + i, vfmaq_f64(vld1q_f64(out + i), w, vld1q_f64(in + i)));
+      for (; i < n; i++)
+         out[i] += weight * in[i];
+   }
+
+   void multiplyNeon(Real* out, const Real* a, const Real* in, size_t n)
+   {
+      size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+         vst1q_f64(out + i, vmulq_f64(vld1q_f64(a + i), vld1q_f64(in + i)));
+      for (; i < n; i++)
+         out[i] = a[i] * in[i];
+   }
+
+   void scaleNeon(Real* out, Real weight, size_t n)
+   {
+      size_t i = 0;
+      for (; i + 2 <= n; i += 2)
+         vst1q_f64(out + i, vmulq_n_f64(vld1q_f64(out + i), weight));
+      for (; i < n; i++)
+         out[i] *= weight;
+   }
+
+#if defined(LATBUILDER__STATE_BLOCKS_SVE)
+   // the predicate of the last iteration covers the remaining values, whatever
+   // the vector length of the host
+   LATNETBUILDER_TARGET("+sve")
+   void addProductSve(Real* out, const Real* a, const Real* b, size_t n)
+   {
+      for (uint64_t i = 0; i < n; i += svcntd()) {
+         const svbool_t pg = svwhilelt_b64(i, (uint64_t) n);
+         svst1(pg, out + i, svmla_x(pg, svld1(pg, out + i), svld1(pg, a + i), svld1(pg, b + i)));
+      }
+   }
+
+   LATNETBUILDER_TARGET("+sve")
+   void addScaledSve(Real* out, Real weight, const Real* in, size_t n)
+   {
+      for (uint64_t i = 0; i < n; i += svcntd()) {
+         const svbool_t pg = svwhilelt_b64(i, (uint64_t) n);
+         svst1(pg, out + i, svmla_n_f64_x(pg, svld1(pg, out + i), svld1(pg, in + i), weight));
+      }
+   }
+
+   LATNETBUILDER_TARGET("+sve")
+   void multiplySve(Real* out, const Real* a, const Real* in, size_t n)
+   {
+      for (uint64_t i = 0; i < n; i += svcntd()) {
+         const svbool_t pg = svwhilelt_b64(i, (uint64_t) n);
+         svst1(pg, out + i, svmul_x(pg, svld1(pg, a + i), svld1(pg, in + i)));
+      }
+   }
+
+   LATNETBUILDER_TARGET("+sve")
+   void scaleSve(Real* out, Real weight, size_t n)
+   {
+      for (uint64_t i = 0; i < n; i += svcntd()) {
+         const svbool_t pg = svwhilelt_b64(i, (uint64_t) n);
+         svst1(pg, out + i, svmul_n_f64_x(pg, svld1(pg, out + i), weight));
+      }
+   }
+#endif
+}
+#endif
+
+//===========================================================================
+
+LATNETBUILDER_TARGET_CLONES
+void addProduct(Real* out, const Real* a, const Real* b, size_t n)
+{
+#if defined(LATBUILDER__STATE_BLOCKS_SVE)
+   if (cpuSupports(CpuFeature::SVE))
+      return addProductSve(out, a, b, n);
+#endif
+#if defined(LATBUILDER__STATE_BLOCKS_NEON)
+   addProductNeon(out, a, b, n);
+#else
+   for (size_t i = 0; i < n; i++)
+      out[i] += a[i] * b[i];
+#endif
+}
+
+//===========================================================================
+
+LATNETBUILDER_TARGET_CLONES
+void addScaled(Real* out, Real weight, const Real* in, size_t n)
+{
+#if defined(LATBUILDER__STATE_BLOCKS_SVE)
+   if (cpuSupports(CpuFeature::SVE))
+      return addScaledSve(out, weight, in, n);
+#endif
+#if defined(LATBUILDER__STATE_BLOCKS_NEON)
+   addScaledNeon(out, weight, in, n);
+#else
+   for (size_t i = 0; i < n; i++)
+      out[i] += weight * in[i];
+#endif
+}
+
+//===========================================================================
+
+LATNETBUILDER_TARGET_CLONES
+void multiply(Real* out, const Real* a, const Real* in, size_t n)
+{
+#if defined(LATBUILDER__STATE_BLOCKS_SVE)
+   if (cpuSupports(CpuFeature::SVE))
+      return multiplySve(out, a, in, n);
+#endif
+#if defined(LATBUILDER__STATE_BLOCKS_NEON)
+   multiplyNeon(out, a, in, n);
+#else
+   for (size_t i = 0; i < n; i++)
+      out[i] = a[i] * in[i];
+#endif
+}
+
+//===========================================================================
+
+LATNETBUILDER_TARGET_CLONES
+void scale(Real* out, Real weight, size_t n)
+{
+#if defined(LATBUILDER__STATE_BLOCKS_SVE)
+   if (cpuSupports(CpuFeature::SVE))
+      return scaleSve(out, weight, n);
+#endif
+#if defined(LATBUILDER__STATE_BLOCKS_NEON)
+   scaleNeon(out, weight, n);
+#else
+   for (size_t i = 0; i < n; i++)
+      out[i] *= weight;
+#endif
+}
+
+}}}
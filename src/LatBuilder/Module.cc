@@ -0,0 +1,86 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/Module.h"
+
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef LATNETBUILDER_MODULAR
+#include <dlfcn.h>
+#endif
+
+namespace LatBuilder
+{
+
+//===============================================================================
+std::string Module::directory()
+{
+   const char* path = std::getenv("LATNETBUILDER_MODULE_PATH");
+   if (path && *path)
+      return path;
+#ifdef LATNETBUILDER_MODULE_DIR
+   return LATNETBUILDER_MODULE_DIR;
+#else
+   return ".";
+#endif
+}
+
+//===============================================================================
+const Module& Module::load(const std::string& name)
+{
+#ifdef LATNETBUILDER_MODULAR
+   static std::mutex mutex;
+   static std::map<std::string, std::unique_ptr<Module>> modules;
+
+   std::lock_guard<std::mutex> lock(mutex);
+   auto& module = modules[name];
+   if (!module){
+      const std::string fileName = directory() + "/liblatnetbuilder-" + name + ".so";
+      void* handle = dlopen(fileName.c_str(), RTLD_NOW | RTLD_LOCAL);
+      if (!handle){
+         modules.erase(name);
+         throw std::runtime_error("cannot load module " + name + ": " + dlerror());
+      }
+      module.reset(new Module(fileName, handle));
+   }
+   return *module;
+#else
+   throw std::logic_error("cannot load module " + name + ": LatNet Builder was not built with modules");
+#endif
+}
+
+//===============================================================================
+void* Module::address(const std::string& symbol) const
+{
+#ifdef LATNETBUILDER_MODULAR
+   dlerror();
+   void* address = dlsym(m_handle, symbol.c_str());
+   const char* error = dlerror();
+   if (error)
+      throw std::runtime_error("module " + m_fileName + " has no entry point " + symbol + ": " + error);
+   return address;
+#else
+   (void) m_handle;
+   throw std::logic_error("module " + m_fileName + " has no entry point " + symbol + ": LatNet Builder was not built with modules");
+#endif
+}
+
+}
@@ -0,0 +1,264 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/NTTConvolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace LatBuilder
+{
+
+namespace {
+
+   typedef std::uint64_t uint64;
+   typedef unsigned __int128 uint128;
+
+   /**
+    * Arithmetic modulo a prime \f$p < 2^{62}\f$, with the residues in
+    * Montgomery form \f$x 2^{64} \bmod p\f$.
+    */
+   class Modulus {
+   public:
+      Modulus(uint64 p, uint64 nonResidue):
+         m_p(p)
+      {
+         // inverse of p modulo 2^64, by Newton's iteration from 3 correct bits
+         uint64 inv = p;
+         for (int i = 0; i < 5; i++)
+            inv *= 2 - p * inv;
+         m_negInv = 0 - inv;
+         const uint128 r = (uint128(1) << 64) % p;
+         m_one = static_cast<uint64>(r);
+         m_r2 = static_cast<uint64>(r * r % p);
+         m_nonResidue = toMontgomery(nonResidue);
+      }
+
+      uint64 modulus() const
+      { return m_p; }
+
+      uint64 one() const
+      { return m_one; }
+
+      uint64 nonResidue() const
+      { return m_nonResidue; }
+
+      uint64 reduce(uint128 t) const
+      {
+         const uint64 m = static_cast<uint64>(t) * m_negInv;
+         const uint64 u = static_cast<uint64>((t + static_cast<uint128>(m) * m_p) >> 64);
+         return u >= m_p ? u - m_p : u;
+      }
+
+      uint64 mul(uint64 a, uint64 b) const
+      { return reduce(static_cast<uint128>(a) * b); }
+
+      uint64 add(uint64 a, uint64 b) const
+      { const uint64 s = a + b; return s >= m_p ? s - m_p : s; }
+
+      uint64 sub(uint64 a, uint64 b) const
+      { return a >= b ? a - b : a + m_p - b; }
+
+      uint64 pow(uint64 a, uint64 e) const
+      {
+         uint64 result = m_one;
+         for (; e; e >>= 1) {
+            if (e & 1)
+               result = mul(result, a);
+            a = mul(a, a);
+         }
+         return result;
+      }
+
+      uint64 inverse(uint64 a) const
+      { return pow(a, m_p - 2); }
+
+      uint64 toMontgomery(uint64 x) const
+      { return mul(x % m_p, m_r2); }
+
+      uint64 fromMontgomery(uint64 x) const
+      { return reduce(x); }
+
+      uint64 fromSigned(std::int64_t x) const
+      { return toMontgomery(x >= 0 ? static_cast<uint64>(x) : m_p - static_cast<uint64>(-x)); }
+
+   private:
+      uint64 m_p;
+      uint64 m_negInv;
+      uint64 m_one;
+      uint64 m_r2;
+      uint64 m_nonResidue;
+   };
+
+   // primes c 2^50 + 1 below 2^62, so that the sum of two residues fits in 64
+   // bits, with a quadratic non-residue of each, from which the roots of unity
+   // of orders up to 2^50 are derived
+   const Modulus& modulus(unsigned int k)
+   {
+      static const Modulus moduli[2] = {
+         Modulus(4601552919265804289ULL, 3),
+         Modulus(4546383823830515713ULL, 5)
+      };
+      return moduli[k];
+   }
+
+   // With mantissas of at most 2^44 in absolute value and vectors of size at
+   // most 2^32, the convolution is less than 2^120, half of p1 p2.
+   const int MANTISSA_BITS = 44;
+   const unsigned int MAX_LOG_SIZE = 32;
+
+   /**
+    * Replaces \c a with its number-theoretic transform, or with its inverse
+    * transform if \c inverse is true.  The size of \c a must be a power of two.
+    */
+   void transform(std::vector<uint64>& a, const Modulus& mod, bool inverse)
+   {
+      const size_t n = a.size();
+
+      // bit-reversal permutation
+      for (size_t i = 1, j = 0; i < n; i++) {
+         size_t bit = n >> 1;
+         for (; j & bit; bit >>= 1)
+            j ^= bit;
+         j ^= bit;
+         if (i < j)
+            std::swap(a[i], a[j]);
+      }
+
+      for (size_t len = 2; len <= n; len <<= 1) {
+         // a non-residue to the power (p - 1) / len is a root of unity of order len
+         uint64 w = mod.pow(mod.nonResidue(), (mod.modulus() - 1) / len);
+         if (inverse)
+            w = mod.inverse(w);
+         const size_t half = len / 2;
+         for (size_t i = 0; i < n; i += len) {
+            uint64 wk = mod.one();
+            for (size_t k = 0; k < half; k++) {
+               const uint64 u = a[i + k];
+               const uint64 v = mod.mul(a[i + k + half], wk);
+               a[i + k] = mod.add(u, v);
+               a[i + k + half] = mod.sub(u, v);
+               wk = mod.mul(wk, w);
+            }
+         }
+      }
+
+      if (inverse) {
+         const uint64 scale = mod.inverse(mod.toMontgomery(n));
+         for (auto& x : a)
+            x = mod.mul(x, scale);
+      }
+   }
+
+   /**
+    * Rounds the \c n values starting at \c values to mantissas of absolute
+    * value at most \f$2^{44}\f$, and returns their common binary exponent.
+    */
+   int toFixedPoint(const Real* values, size_t n, std::vector<std::int64_t>& mantissas)
+   {
+      Real maxAbs = 0.0;
+      for (size_t i = 0; i < n; i++)
+         maxAbs = std::max(maxAbs, std::abs(values[i]));
+      mantissas.assign(n, 0);
+      if (maxAbs == 0.0)
+         return 0;
+      int e;
+      std::frexp(maxAbs, &e);
+      const int exponent = e - MANTISSA_BITS;
+      for (size_t i = 0; i < n; i++)
+         mantissas[i] = std::llround(std::ldexp(values[i], -exponent));
+      return exponent;
+   }
+
+   size_t transformSize(size_t size)
+   {
+      // a power of two is convolved cyclically, other sizes are padded for
+      // the linear convolution
+      if (size > (size_t(1) << MAX_LOG_SIZE))
+         throw std::length_error("NTTConvolution: vectors are too large");
+      const size_t minSize = (size & (size - 1)) == 0 ? size : 2 * size - 1;
+      size_t n = 1;
+      while (n < minSize)
+         n <<= 1;
+      return n;
+   }
+}
+
+std::atomic<bool> NTTConvolution::s_enabled(false);
+
+//===============================================================================
+NTTConvolution::NTTConvolution(const Real* values, size_t size):
+   m_size(size),
+   m_transformSize(transformSize(size))
+{
+   std::vector<std::int64_t> mantissas;
+   m_exponent = toFixedPoint(values, size, mantissas);
+   for (unsigned int k = 0; k < 2; k++) {
+      const Modulus& mod = modulus(k);
+      auto& a = m_transforms[k];
+      a.assign(m_transformSize, 0);
+      for (size_t i = 0; i < size; i++)
+         a[i] = mod.fromSigned(mantissas[i]);
+      transform(a, mod, false);
+   }
+}
+
+//===============================================================================
+void NTTConvolution::apply(const Real* vec, Real* out) const
+{
+   std::vector<std::int64_t> mantissas;
+   const int exponent = toFixedPoint(vec, m_size, mantissas) + m_exponent;
+
+   std::vector<uint64> residues[2];
+   for (unsigned int k = 0; k < 2; k++) {
+      const Modulus& mod = modulus(k);
+      auto& a = residues[k];
+      a.assign(m_transformSize, 0);
+      for (size_t i = 0; i < m_size; i++)
+         a[i] = mod.fromSigned(mantissas[i]);
+      transform(a, mod, false);
+      for (size_t i = 0; i < m_transformSize; i++)
+         a[i] = mod.mul(a[i], m_transforms[k][i]);
+      transform(a, mod, true);
+      // fold the linear convolution
+      for (size_t i = 0; i < m_size; i++) {
+         uint64 x = a[i];
+         if (m_transformSize != m_size and i + m_size < m_transformSize)
+            x = mod.add(x, a[i + m_size]);
+         a[i] = mod.fromMontgomery(x);
+      }
+   }
+
+   // Chinese remainder theorem: x = r1 + p1 ((r2 - r1) / p1 mod p2), and the
+   // values above half of p1 p2 are negative
+   const Modulus& mod2 = modulus(1);
+   const uint64 p1 = modulus(0).modulus();
+   const uint64 p2 = mod2.modulus();
+   // mul() divides by 2^64, which cancels the Montgomery form of the inverse
+   const uint64 inv = mod2.inverse(mod2.toMontgomery(p1));
+   const uint128 product = static_cast<uint128>(p1) * p2;
+   for (size_t i = 0; i < m_size; i++) {
+      const uint64 r1 = residues[0][i];
+      const uint64 t = mod2.mul(mod2.sub(residues[1][i], r1 % p2), inv);
+      const uint128 x = r1 + static_cast<uint128>(p1) * t;
+      const Real value = x > product / 2 ? -static_cast<Real>(product - x) : static_cast<Real>(x);
+      out[i] = std::ldexp(value, exponent);
+   }
+}
+
+}
@@ -0,0 +1,134 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Norm/BoundCache.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace LatBuilder { namespace Norm {
+
+namespace {
+
+   /*
+    * File format: one line per value, with the key and the value in
+    * hexadecimal floating-point notation separated by a tab.
+    */
+   struct State {
+      std::mutex mutex;
+      std::string fileName;
+      std::map<std::string, Real> values;
+   };
+
+   State& state()
+   {
+      static State instance;
+      return instance;
+   }
+
+   // must be called with the mutex locked
+   void appendToFile(const State& s, const std::string& key, Real value)
+   {
+      std::ofstream file(s.fileName, std::ios::app);
+      file << key << '\t' << std::hexfloat << value << '\n';
+      if (!file)
+         throw std::runtime_error("cannot write bound values to " + s.fileName);
+   }
+}
+
+//===============================================================================
+Real BoundCache::get(const std::string& key, const std::function<Real()>& compute)
+{
+   auto& s = state();
+   {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      auto it = s.values.find(key);
+      if (it != s.values.end())
+         return it->second;
+   }
+
+   // minimize the bound without holding the lock; concurrent requests for the
+   // same key may compute it more than once
+   const Real value = compute();
+
+   std::lock_guard<std::mutex> lock(s.mutex);
+   if (s.values.emplace(key, value).second && !s.fileName.empty())
+      appendToFile(s, key, value);
+   return value;
+}
+
+//===============================================================================
+std::string BoundCache::digest(const LatticeTester::Weights& weights)
+{
+   std::ostringstream os;
+   os.precision(std::numeric_limits<Real>::max_digits10);
+   os << weights;
+   const std::string text = os.str();
+
+   // 64-bit FNV-1a, which does not depend on the standard library
+   std::uint64_t hash = 14695981039346656037ULL;
+   for (const unsigned char c : text) {
+      hash ^= c;
+      hash *= 1099511628211ULL;
+   }
+   std::ostringstream out;
+   out << std::hex << hash << '-' << std::dec << text.size();
+   return out.str();
+}
+
+//===============================================================================
+void BoundCache::setFile(const std::string& fileName)
+{
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   s.fileName = fileName;
+   if (fileName.empty() || !boost::filesystem::exists(fileName))
+      return;
+
+   std::ifstream file(fileName);
+   if (!file)
+      throw std::runtime_error("cannot read bound values from " + fileName);
+   std::string line;
+   while (std::getline(file, line)) {
+      const auto tab = line.rfind('\t');
+      if (tab == std::string::npos)
+         continue;
+      // the hexadecimal notation is parsed by strtold, not by operator>>
+      const std::string text = line.substr(tab + 1);
+      char* end = nullptr;
+      const long double value = std::strtold(text.c_str(), &end);
+      if (end == text.c_str())
+         continue;
+      s.values.emplace(line.substr(0, tab), static_cast<Real>(value));
+   }
+}
+
+void BoundCache::clear()
+{
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   s.values.clear();
+}
+
+}}
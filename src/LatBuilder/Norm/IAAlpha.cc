@@ -167,7 +167,7 @@ namespace SumHelperIAAlpha{
 }
 
 IAAlpha::IAAlpha(unsigned int alpha, const LatticeTester::Weights& weights, Real normType):
-   NormAlphaBase<IAAlpha>(alpha, normType),
+   NormAlphaBase<IAAlpha>(alpha, weights, normType),
    m_weights(weights)
 {}
 
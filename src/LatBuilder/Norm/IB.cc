@@ -188,7 +188,7 @@ namespace SumHelperIB{
 }
 
 IB::IB(unsigned int alpha, const LatticeTester::Weights& weights, Real normType):
-   NormAlphaBase<IB>(alpha, normType),
+   NormAlphaBase<IB>(alpha, weights, normType),
    m_weights(weights)
 {}
 
@@ -114,7 +114,7 @@ namespace SumHelperPAlphaDPW08{
 }
 
 PAlphaDPW08::PAlphaDPW08(unsigned int alpha, const LatticeTester::Weights& weights, Real normType):
-   NormAlphaBase<PAlphaDPW08>(alpha, normType),
+   NormAlphaBase<PAlphaDPW08>(alpha, weights, normType),
    m_weights(weights)
 {}
 
@@ -221,7 +221,7 @@ namespace SumHelperPAlphaTilde{
 }
 
 PAlphaTilde::PAlphaTilde(unsigned int alpha, const LatticeTester::Weights& weights, Real normType):
-   NormAlphaBase<PAlphaTilde>(alpha, normType),
+   NormAlphaBase<PAlphaTilde>(alpha, weights, normType),
    m_weights(weights)
 {}
 
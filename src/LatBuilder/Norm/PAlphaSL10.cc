@@ -220,7 +220,7 @@ namespace SumHelperPAlphaSL10{
 }
 
 PAlphaSL10::PAlphaSL10(unsigned int alpha, const LatticeTester::Weights& weights, Real normType):
-   NormAlphaBase<PAlphaSL10>(alpha, normType),
+   NormAlphaBase<PAlphaSL10>(alpha, weights, normType),
    m_weights(weights)
 {}
 
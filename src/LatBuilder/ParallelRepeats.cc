@@ -0,0 +1,88 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/ParallelRepeats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace LatBuilder
+{
+
+//===============================================================================
+ParallelRepeats::ParallelRepeats(unsigned int numRuns):
+   m_bestRun(0)
+{
+   if (numRuns == 0)
+      throw std::invalid_argument("ParallelRepeats: the number of runs must be positive");
+
+   LFSR258 stream(LFSR258::default_seed);
+   m_seeds.reserve(numRuns);
+   for (unsigned int i = 0; i < numRuns; i++)
+      m_seeds.push_back(stream.split().seed());
+}
+
+//===============================================================================
+Real ParallelRepeats::quantile(Real p) const
+{
+   if (m_merits.empty())
+      throw std::logic_error("ParallelRepeats: the runs have not been executed");
+
+   std::vector<Real> sorted(m_merits);
+   std::sort(sorted.begin(), sorted.end());
+
+   const Real pos = std::min(std::max(p, Real(0)), Real(1)) * Real(sorted.size() - 1);
+   const size_t lower = (size_t) std::floor(pos);
+   const size_t upper = std::min(lower + 1, sorted.size() - 1);
+   return sorted[lower] + (pos - Real(lower)) * (sorted[upper] - sorted[lower]);
+}
+
+Real ParallelRepeats::mean() const
+{
+   if (m_merits.empty())
+      throw std::logic_error("ParallelRepeats: the runs have not been executed");
+
+   Real sum = 0;
+   for (const auto merit : m_merits)
+      sum += merit;
+   return sum / Real(m_merits.size());
+}
+
+//===============================================================================
+ParallelRepeats::SeedScope::SeedScope(const LFSR258::seed_type& seed):
+   m_previous(LFSR258::threadDefaultSeed())
+{ LFSR258::setThreadDefaultSeed(seed); }
+
+ParallelRepeats::SeedScope::~SeedScope()
+{ LFSR258::setThreadDefaultSeed(m_previous); }
+
+//===============================================================================
+std::ostream& operator<<(std::ostream& os, const ParallelRepeats& repeats)
+{
+   os << "Number of runs: " << repeats.numRuns() << std::endl;
+   os << "Merit values:" << std::endl;
+   for (unsigned int i = 0; i < repeats.numRuns(); i++)
+      os << "  Run " << i + 1 << ": " << repeats.merits()[i] << std::endl;
+   os << "Best run: " << repeats.bestRun() + 1 << std::endl;
+   os << "Mean: " << repeats.mean() << std::endl;
+   os << "Quantiles:" << std::endl;
+   for (const Real p : {0.0, 0.1, 0.25, 0.5, 0.75, 0.9, 1.0})
+      os << "  " << p << ": " << repeats.quantile(p) << std::endl;
+   return os;
+}
+
+}
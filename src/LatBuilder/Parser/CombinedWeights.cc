@@ -19,147 +19,343 @@
 #include "latticetester/ProjectionDependentWeights.h"
 #include "latticetester/OrderDependentWeights.h"
 
-#include <fstream>
-#include <iostream>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
-#include <boost/algorithm/string/split.hpp>
-
-using namespace std;
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 
 namespace LatBuilder { namespace Parser {
 
 namespace {
-   Real inputPowerScale = 1.0;
+   const char BINARY_MAGIC[8] = {'L', 'N', 'B', 'W', 'G', 'H', 'T', '1'};
 
    /**
-    * Helper function to check the next characters from an input stream.
-    *
-    * Returns \c true if the next characters in \c is are \c token.  Upon a match, the characters
-    * are removed from \c is; otherwise, they are left in \c is.
+    * Read-only memory mapping of a weights file.
     */
-   static bool check_next_chars(istream& is, const string& token)
-   {
-      string::const_iterator it = token.begin();
-      while (it != token.end()) {
-             int c = is.get();
-             if (c != *it) {
-                    is.putback(c);
-                    break;
-             }
-             ++it;
-      }
-      if (it == token.end())
-             return true;
-      while (it != token.begin())
-             is.putback(*(--it));
-      return false;
-   }
+   class MappedFile {
+   public:
+      explicit MappedFile(const std::string& fileName)
+      {
+         namespace bip = boost::interprocess;
+         if (!boost::filesystem::is_regular_file(fileName))
+            throw BadWeights("cannot open weights file " + fileName);
+         if (boost::filesystem::file_size(fileName) == 0)
+            return; // an empty region cannot be mapped
+         try {
+            m_file = bip::file_mapping(fileName.c_str(), bip::read_only);
+            m_region = bip::mapped_region(m_file, bip::read_only);
+         }
+         catch (bip::interprocess_exception&) {
+            throw BadWeights("cannot map weights file " + fileName);
+         }
+         m_region.advise(bip::mapped_region::advice_sequential);
+      }
+
+      const char* begin() const
+      { return static_cast<const char*>(m_region.get_address()); }
+
+      const char* end() const
+      { return begin() + m_region.get_size(); }
+
+   private:
+      boost::interprocess::file_mapping m_file;
+      boost::interprocess::mapped_region m_region;
+   };
 
    /**
-    * Helper function to skip all characters of a given class.
+    * Single-pass scanner of the text of a weights file, which parses the
+    * numbers in place, without copying the lines or the tokens.
     */
-   static void skip_any(istream& is, const string& characters)
+   class Scanner {
+   public:
+      Scanner(const char* begin, const char* end):
+         m_pos(begin), m_end(end)
+      {}
+
+      bool atEnd() const
+      { return m_pos == m_end; }
+
+      char peek() const
+      { return atEnd() ? '\0' : *m_pos; }
+
+      void get()
+      { ++m_pos; }
+
+      const char* position() const
+      { return m_pos; }
+
+      void skipAny(const char* characters)
+      {
+         while (not atEnd() and std::strchr(characters, *m_pos))
+            ++m_pos;
+      }
+
+      void skipLine()
+      {
+         while (not atEnd() and *m_pos != '\n')
+            ++m_pos;
+      }
+
+      /**
+       * Returns \c true if the next characters are \c token.
+       */
+      bool startsWith(const char* token) const
+      {
+         const size_t n = std::strlen(token);
+         return static_cast<size_t>(m_end - m_pos) >= n and std::strncmp(m_pos, token, n) == 0;
+      }
+
+      /**
+       * Skips the characters of \c token and returns \c true if they are
+       * next, returns \c false without moving otherwise.
+       */
+      bool checkNext(const char* token)
+      {
+         if (not startsWith(token))
+            return false;
+         m_pos += std::strlen(token);
+         return true;
+      }
+
+      /**
+       * Skips the characters up to the next whitespace character.
+       */
+      void skipToken()
+      {
+         while (not atEnd() and not std::strchr(" \t\r\n", *m_pos))
+            ++m_pos;
+      }
+
+      uInteger readUnsigned()
+      {
+         if (atEnd() or *m_pos < '0' or *m_pos > '9')
+            fail("expected a nonnegative integer");
+         uInteger x = 0;
+         while (not atEnd() and *m_pos >= '0' and *m_pos <= '9')
+            x = 10 * x + static_cast<uInteger>(*m_pos++ - '0');
+         return x;
+      }
+
+      Real readReal()
+      {
+         // strtod needs a terminated string: copy the few characters of the number
+         char buffer[64];
+         size_t n = 0;
+         while (not atEnd() and n + 1 < sizeof(buffer) and std::strchr("0123456789+-.eE", *m_pos))
+            buffer[n++] = *m_pos++;
+         buffer[n] = '\0';
+         char* last;
+         const Real x = std::strtod(buffer, &last);
+         if (n == 0 or *last != '\0')
+            fail("expected a number");
+         return x;
+      }
+
+      /**
+       * Reads a comma-separated list of coordinates, starting from 1, into
+       * the set of coordinates \c coords, starting from 0.
+       */
+      void readCoordinates(LatticeTester::Coordinates& coords)
+      {
+         coords.clear();
+         while (true) {
+            const uInteger coord = readUnsigned();
+            if (coord == 0)
+               fail("the coordinates start from 1");
+            coords.insert(coords.end(), coord - 1);
+            skipAny(" \t");
+            if (peek() != ',')
+               break;
+            get();
+            skipAny(" \t");
+         }
+      }
+
+      /**
+       * Skips a pair separator, one of <code>:</code>, <code>-></code> or
+       * <code>=></code>, surrounded by blanks.
+       */
+      void readPairSeparator()
+      {
+         skipAny(" \t");
+         if (not (checkNext(":") or checkNext("->") or checkNext("=>")))
+            fail("expected a separator between a projection and its weight");
+         skipAny(" \t");
+      }
+
+      [[noreturn]] void fail(const std::string& message) const
+      {
+         const char* lineEnd = m_pos;
+         while (lineEnd != m_end and *lineEnd != '\n')
+            ++lineEnd;
+         throw BadWeights(message + " before \"" + std::string(m_pos, lineEnd) + "\"");
+      }
+
+   private:
+      const char* m_pos;
+      const char* m_end;
+   };
+
+   /**
+    * Parses the token of projection-dependent weights <code>projection-dependent:proj:weight:...</code>
+    * at the position of \c scanner, after its <code>projection-dependent:</code> prefix.
+    */
+   std::unique_ptr<LatticeTester::Weights> parseProjectionDependentToken(Scanner& scanner, Real powerScale)
    {
-      while (characters.find(is.peek()) != string::npos)
-         is.get();
+      std::unique_ptr<LatticeTester::ProjectionDependentWeights> w(new LatticeTester::ProjectionDependentWeights);
+      LatticeTester::Coordinates coords;
+      while (not scanner.atEnd() and not std::strchr(" \t\r\n", scanner.peek())) {
+         scanner.readCoordinates(coords);
+         if (not scanner.checkNext(":"))
+            scanner.fail("expected a colon after a projection");
+         w->setWeight(coords, std::pow(scanner.readReal(), powerScale));
+         if (not scanner.checkNext(":"))
+            break;
+      }
+      return std::unique_ptr<LatticeTester::Weights>(std::move(w));
    }
+}
 
-   istream& operator>> (istream& is, LatBuilder::CombinedWeights& weights)
-   {
-      auto ow = new LatticeTester::OrderDependentWeights;
-      auto pw = new LatticeTester::ProjectionDependentWeights;
+bool
+CombinedWeights::parseFile(const std::string& arg, LatBuilder::CombinedWeights& weights, Real powerScale)
+{
+   auto ka = splitPair<>(arg, ':');
+   if (ka.first != "file") return false;
 
-      string whitespace = " \t\n\r";
-      string sep = whitespace + ",";
+   const MappedFile file(ka.second);
+   Scanner scanner(file.begin(), file.end());
 
-      // skip leading whitespace
-      skip_any(is, whitespace);
+   std::unique_ptr<LatticeTester::OrderDependentWeights> ow(new LatticeTester::OrderDependentWeights);
+   std::unique_ptr<LatticeTester::ProjectionDependentWeights> pw(new LatticeTester::ProjectionDependentWeights);
+   bool hasOrders = false;
+   bool hasProjections = false;
+   LatticeTester::Coordinates coords;
 
-      // check if coordinate set is enclosed in braces
-      bool with_braces = false;
-      if (is.peek() == '{') {
-         is.get();
-         with_braces = true;
-         skip_any(is, whitespace);
+   const char* whitespace = " \t\r\n";
+   const char* separators = " \t\r\n,";
+
+   scanner.skipAny(whitespace);
+   const bool withBraces = scanner.checkNext("{");
+   scanner.skipAny(whitespace);
+
+   while (not scanner.atEnd()) {
+
+      if (withBraces and scanner.checkNext("}"))
+         break;
+
+      const char c = scanner.peek();
+
+      if (c == '#') {
+         // comment
+         scanner.skipLine();
+      }
+      else if (c >= '0' and c <= '9') {
+         // coordinates: weight
+         scanner.readCoordinates(coords);
+         scanner.readPairSeparator();
+         pw->setWeight(coords, std::pow(scanner.readReal(), powerScale));
+         hasProjections = true;
+      }
+      else if (scanner.checkNext("default")) {
+         scanner.readPairSeparator();
+         ow->setDefaultWeight(std::pow(scanner.readReal(), powerScale));
+         hasOrders = true;
+      }
+      else if (scanner.startsWith("order") and not scanner.startsWith("order-dependent:")) {
+         scanner.checkNext("order");
+         scanner.skipAny(" \t");
+         const auto order = scanner.readUnsigned();
+         scanner.readPairSeparator();
+         ow->setWeightForOrder(order, std::pow(scanner.readReal(), powerScale));
+         hasOrders = true;
+      }
+      else if (scanner.checkNext("projection-dependent:")) {
+         // the most common weights specification, possibly very long
+         weights.add(parseProjectionDependentToken(scanner, powerScale));
+      }
+      else {
+         // any other weights specification, as on the command line
+         const char* token = scanner.position();
+         scanner.skipToken();
+         weights.add(Parser::Weights::parse(std::string(token, scanner.position()), powerScale));
       }
 
-      while (is.good()) {
+      scanner.skipAny(separators);
+   }
 
-         // exit on closing brace
-         if (with_braces && is.peek() == '}') {
-            is.get();
-            break;
-         }
+   if (hasOrders)
+      weights.add(std::unique_ptr<LatticeTester::Weights>(std::move(ow)));
+   if (hasProjections)
+      weights.add(std::unique_ptr<LatticeTester::Weights>(std::move(pw)));
+   return true;
+}
 
-         // skip comments
-         if (is.peek() == '#') {
-            while (is.get() != '\n');
-            skip_any(is, whitespace);
-            continue;
-         }
+bool
+CombinedWeights::parseBinaryFile(const std::string& arg, LatBuilder::CombinedWeights& weights, Real powerScale)
+{
+   auto ka = splitPair<>(arg, ':');
+   if (ka.first != "bin") return false;
 
-         // check if setting default weight
-         bool is_default = check_next_chars(is, "default");
+   const MappedFile file(ka.second);
 
-         // check if setting default weight for a specific order
-         bool is_order = check_next_chars(is, "order");
-         unsigned int order = 0;
-         if (is_order) {
-            skip_any(is, whitespace);
-            is >> order;
-         }
+   // the region is page-aligned, and so are the 64-bit words of the file
+   const size_t size = file.end() - file.begin();
+   if (size % sizeof(std::uint64_t) != 0 or size < 2 * sizeof(std::uint64_t) or std::memcmp(file.begin(), BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0)
+      throw BadWeights("not a binary weights file: " + ka.second);
+   const std::uint64_t* word = reinterpret_cast<const std::uint64_t*>(file.begin()) + 1;
+   const std::uint64_t* const end = reinterpret_cast<const std::uint64_t*>(file.end());
+
+   const auto next = [&]() -> std::uint64_t
+   {
+      if (word == end)
+         throw BadWeights("truncated binary weights file: " + ka.second);
+      return *word++;
+   };
+   const auto nextWeight = [&]() -> Real
+   {
+      const std::uint64_t bits = next();
+      double x;
+      std::memcpy(&x, &bits, sizeof(x));
+      return std::pow(Real(x), powerScale);
+   };
 
-         // read coordinates
-         LatticeTester::Coordinates coords;
-         if (!(is_default || is_order))
-            is >> coords;
-
-         // check for pair separator
-         skip_any(is, whitespace);
-         if (!(check_next_chars(is, ":") ||
-               check_next_chars(is, "->") ||
-               check_next_chars(is, "=>")))
-            throw invalid_argument("invalid characters while parsing "
-                  "ProjectionDependentWeights from input stream");
-         skip_any(is, whitespace);
-
-         // read weight
-         LatticeTester::Weight weight;
-         is >> weight;
-         weight = std::pow(weight, inputPowerScale);
-
-         if (is_default)
-            ow->setDefaultWeight(weight);
-         else if (is_order)
-            ow->setWeightForOrder(order, weight);
-         else
-            pw->setWeight(coords, weight);
-
-         // skip across-pairs separator
-         skip_any(is, sep);
-      }
-      weights.add(std::unique_ptr<LatticeTester::Weights>(ow));
-      weights.add(std::unique_ptr<LatticeTester::Weights>(pw));
-      return is;
+   std::unique_ptr<LatticeTester::OrderDependentWeights> ow(new LatticeTester::OrderDependentWeights);
+   ow->setDefaultWeight(nextWeight());
+   const std::uint64_t numOrders = next();
+   for (std::uint64_t order = 1; order <= numOrders; order++)
+      ow->setWeightForOrder(order, nextWeight());
+
+   std::unique_ptr<LatticeTester::ProjectionDependentWeights> pw(new LatticeTester::ProjectionDependentWeights);
+   const std::uint64_t numProjections = next();
+   LatticeTester::Coordinates coords;
+   for (std::uint64_t i = 0; i < numProjections; i++) {
+      const std::uint64_t order = next();
+      if (order == 0 or order > static_cast<std::uint64_t>(end - word))
+         throw BadWeights("invalid projection in binary weights file: " + ka.second);
+      coords.clear();
+      for (std::uint64_t j = 0; j < order; j++)
+         coords.insert(coords.end(), static_cast<LatticeTester::Coordinates::value_type>(next()));
+      pw->setWeight(coords, nextWeight());
    }
+   if (word != end)
+      throw BadWeights("trailing data in binary weights file: " + ka.second);
+
+   weights.add(std::unique_ptr<LatticeTester::Weights>(std::move(ow)));
+   weights.add(std::unique_ptr<LatticeTester::Weights>(std::move(pw)));
+   return true;
 }
 
 std::unique_ptr<LatBuilder::CombinedWeights>
 CombinedWeights::parse(const std::vector<std::string>& args, Real powerScale)
 {
-   std::vector<std::string> weightsStrings;
    auto w = new LatBuilder::CombinedWeights;
-   if (args.size() == 1 && args[0].compare(0, 4, "file") == 0){
-      std::ifstream t(args[0].substr(5));
-      std::stringstream buffer;
-      buffer << t.rdbuf();
-      std::string fileContent = buffer.str();
-      boost::split(weightsStrings, fileContent, boost::is_any_of(" "));
-   }
-   else{
-      weightsStrings = args;
-   }
-   for (const auto& s : weightsStrings) {
+   for (const auto& s : args) {
+      if (parseFile(s, *w, powerScale) or parseBinaryFile(s, *w, powerScale))
+         continue;
       w->add(Parser::Weights::parse(s, powerScale));
    }
    return std::unique_ptr<LatBuilder::CombinedWeights>(w);
@@ -21,6 +21,8 @@
 #include "latbuilder/Parser/FigureOfMerit.h"
 #include "latbuilder/Parser/MeritFilterList.h"
 #include "latbuilder/Parser/Search.h"
+#include "latbuilder/Module.h"
+#include "latbuilder/Trace.h"
 
 #include <boost/lexical_cast.hpp>
 
@@ -81,6 +83,7 @@ namespace {
 
       std::unique_ptr<LatBuilder::Task::Search<LR, ET>> search()
       {
+         Trace::Span span("task-setup", "task");
          Parser::FigureOfMerit<LR>::parse(
                m_args.normType,
                m_args.figure,
@@ -112,6 +115,7 @@ namespace {
 
 }
 
+#if LATBUILDER_WITH_LATTICE_ORDINARY
 template<>
 std::unique_ptr<LatBuilder::Task::Search<LatticeType::ORDINARY, LatBuilder::EmbeddingType::UNILEVEL>>
 CommandLine<LatticeType::ORDINARY, LatBuilder::EmbeddingType::UNILEVEL>::parse() const
@@ -121,7 +125,9 @@ template<>
 std::unique_ptr<LatBuilder::Task::Search<LatticeType::ORDINARY, LatBuilder::EmbeddingType::MULTILEVEL>>
 CommandLine<LatticeType::ORDINARY, LatBuilder::EmbeddingType::MULTILEVEL>::parse() const
 { return Parse<LatticeType::ORDINARY, LatBuilder::EmbeddingType::MULTILEVEL>(*this).search(); }
+#endif
 
+#if LATBUILDER_WITH_LATTICE_POLYNOMIAL
 template<>
 std::unique_ptr<LatBuilder::Task::Search<LatticeType::POLYNOMIAL, LatBuilder::EmbeddingType::UNILEVEL>>
 CommandLine<LatticeType::POLYNOMIAL, LatBuilder::EmbeddingType::UNILEVEL>::parse() const
@@ -131,6 +137,7 @@ template<>
 std::unique_ptr<LatBuilder::Task::Search<LatticeType::POLYNOMIAL, LatBuilder::EmbeddingType::MULTILEVEL>>
 CommandLine<LatticeType::POLYNOMIAL, LatBuilder::EmbeddingType::MULTILEVEL>::parse() const
 { return Parse<LatticeType::POLYNOMIAL, LatBuilder::EmbeddingType::MULTILEVEL>(*this).search(); }
+#endif
 
 /*
 template struct CommandLine<LatBuilder::LatticeType::ORDINARY, LatBuilder::EmbeddingType::UNILEVEL>;
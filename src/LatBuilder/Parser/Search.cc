@@ -15,13 +15,18 @@
 // limitations under the License.
 
 #include "latbuilder/Parser/Search.h"
+#include "latbuilder/Module.h"
 
 namespace LatBuilder { namespace Parser {
 
+#if LATBUILDER_WITH_LATTICE_ORDINARY
 template class Search<LatticeType::ORDINARY, LatBuilder::EmbeddingType::UNILEVEL>;
 template class Search<LatticeType::ORDINARY, LatBuilder::EmbeddingType::MULTILEVEL>;
+#endif
 
+#if LATBUILDER_WITH_LATTICE_POLYNOMIAL
 template class Search<LatticeType::POLYNOMIAL, LatBuilder::EmbeddingType::UNILEVEL>;
 template class Search<LatticeType::POLYNOMIAL, LatBuilder::EmbeddingType::MULTILEVEL>;
+#endif
 
 }}
@@ -0,0 +1,102 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/PointGenerator.h"
+
+#include <cmath>
+
+namespace LatBuilder
+{
+
+namespace {
+   // (x + y) mod n for x, y < n, without overflow
+   uInteger addMod(uInteger x, uInteger y, uInteger n)
+   { return x >= n - y ? x - (n - y) : x + y; }
+
+   // (x * y) mod n without overflow
+   uInteger mulMod(uInteger x, uInteger y, uInteger n)
+   {
+      uInteger res = 0;
+      x %= n;
+      for (; y; y >>= 1) {
+         if (y & 1)
+            res = addMod(res, x, n);
+         x = addMod(x, x, n);
+      }
+      return res;
+   }
+
+   const double twoPow32 = 4294967296.0;
+}
+
+//===============================================================================
+LatticePointGenerator::LatticePointGenerator(uInteger numPoints, std::vector<uInteger> gen, std::vector<Real> shift):
+   m_numPoints(numPoints),
+   m_gen(std::move(gen)),
+   m_shift(std::move(shift))
+{
+   if (m_numPoints == 0)
+      throw std::invalid_argument("LatticePointGenerator: the lattice has no points");
+   if (!m_shift.empty() && m_shift.size() != m_gen.size())
+      throw std::invalid_argument("LatticePointGenerator: the dimension of the shift does not match the dimension of the lattice");
+   for (auto& a : m_gen)
+      a %= m_numPoints;
+   for (auto& delta : m_shift)
+      delta -= std::floor(delta);
+}
+
+//===============================================================================
+template <typename T, typename CONVERT>
+void LatticePointGenerator::generateImpl(uInteger first, uInteger count, T* out, CONVERT convert) const
+{
+   const Dimension dim = dimension();
+   const double invN = 1.0 / m_numPoints;
+
+   std::vector<uInteger> numerators(dim);
+   for (Dimension j = 0; j < dim; ++j)
+      numerators[j] = mulMod(first, m_gen[j], m_numPoints);
+
+   for (uInteger i = 0; i < count; ++i) {
+      for (Dimension j = 0; j < dim; ++j) {
+         double x = numerators[j] * invN;
+         if (!m_shift.empty()) {
+            x += m_shift[j];
+            if (x >= 1.0)
+               x -= 1.0;
+         }
+         *out++ = convert(x);
+         numerators[j] = addMod(numerators[j], m_gen[j], m_numPoints);
+      }
+   }
+}
+
+//===============================================================================
+void LatticePointGenerator::generate(uInteger first, uInteger count, double* out) const
+{
+   generateImpl(first, count, out, [](double x) { return x; });
+}
+
+//===============================================================================
+void LatticePointGenerator::generate(uInteger first, uInteger count, uint32_t* out) const
+{
+   generateImpl(first, count, out, [](double x)
+         {
+            const double y = std::floor(x * twoPow32);
+            return y >= twoPow32 ? uint32_t(0xFFFFFFFFu) : uint32_t(y);
+         });
+}
+
+}
@@ -0,0 +1,159 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/PolynomialWord.h"
+
+#include <stdexcept>
+#include <utility>
+
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED && !defined(__PCLMUL__) && !defined(LATBUILDER__POLYNOMIAL_WORD_PMULL)
+#if defined(__x86_64__)
+#include <wmmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
+namespace LatBuilder
+{
+
+namespace {
+   // sum modulo 2 of the bits of x
+   inline PolynomialWord parity(PolynomialWord x)
+   {
+#if defined(__GNUC__)
+      return (PolynomialWord) __builtin_parityll(x);
+#else
+      x ^= x >> 32;
+      x ^= x >> 16;
+      x ^= x >> 8;
+      x ^= x >> 4;
+      x ^= x >> 2;
+      x ^= x >> 1;
+      return x & 1;
+#endif
+   }
+
+   // degree of the nonzero polynomial a
+   inline unsigned int degreeOf(PolynomialWord a)
+   {
+      unsigned int d = 0;
+      while (a >>= 1)
+         d++;
+      return d;
+   }
+}
+
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED && !defined(__PCLMUL__) && !defined(LATBUILDER__POLYNOMIAL_WORD_PMULL)
+//===============================================================================
+#if defined(__x86_64__)
+LATNETBUILDER_TARGET("pclmul")
+void carrylessMultiplyInstruction(PolynomialWord a, PolynomialWord b, PolynomialWord& low, PolynomialWord& high)
+{
+   const __m128i product = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long) a), _mm_cvtsi64_si128((long long) b), 0);
+   low = (PolynomialWord) _mm_cvtsi128_si64(product);
+   high = (PolynomialWord) _mm_cvtsi128_si64(_mm_unpackhi_epi64(product, product));
+}
+#else
+LATNETBUILDER_TARGET("+crypto")
+void carrylessMultiplyInstruction(PolynomialWord a, PolynomialWord b, PolynomialWord& low, PolynomialWord& high)
+{
+   const uint64x2_t product = vreinterpretq_u64_p128(vmull_p64((poly64_t) a, (poly64_t) b));
+   low = vgetq_lane_u64(product, 0);
+   high = vgetq_lane_u64(product, 1);
+}
+#endif
+#endif
+
+//===============================================================================
+const PolynomialWordModulus& PolynomialWordModulus::cached(const Polynomial& modulus)
+{
+   thread_local PolynomialWordModulus cache;
+   if (cache.modulus() != toPolynomialWord(modulus))
+      cache = PolynomialWordModulus(modulus);
+   return cache;
+}
+
+//===============================================================================
+PolynomialWordModulus::PolynomialWordModulus(const Polynomial& modulus)
+{
+   if (not fits(modulus))
+      throw std::invalid_argument("PolynomialWordModulus: the degree of the modulus must be between 1 and 63");
+
+   m_modulus = toPolynomialWord(modulus);
+   m_degree = (unsigned int) deg(modulus);
+   m_mask = (PolynomialWord(1) << m_degree) - 1;
+
+   Polynomial power;
+   NTL::SetCoeff(power, 2 * m_degree);
+   m_mu = toPolynomialWord(power / modulus); // of degree m
+
+   m_feedback = 0;
+   for (unsigned int d = 1; d <= m_degree; d++)
+      m_feedback |= ((m_modulus >> (m_degree - d)) & 1) << (d - 1);
+}
+
+//===============================================================================
+PolynomialWord PolynomialWordModulus::remainder(PolynomialWord a) const
+{
+   for (unsigned int i = 63; i >= m_degree; i--) {
+      if ((a >> i) & 1)
+         a ^= m_modulus << (i - m_degree);
+   }
+   return a;
+}
+
+//===============================================================================
+PolynomialWord PolynomialWordModulus::power(PolynomialWord base, uInteger exponent) const
+{
+   base = reduce(base);
+   PolynomialWord result = 1;
+   while (exponent) {
+      if (exponent % 2 == 1)
+         result = multiply(result, base);
+      exponent /= 2;
+      base = multiply(base, base);
+   }
+   return result;
+}
+
+//===============================================================================
+bool PolynomialWordModulus::isCoprime(PolynomialWord a) const
+{
+   // Euclid's algorithm, on the remainders of the long divisions
+   PolynomialWord b = m_modulus;
+   while (a != 0) {
+      const unsigned int degreeA = degreeOf(a);
+      while (b != 0 and degreeOf(b) >= degreeA)
+         b ^= a << (degreeOf(b) - degreeA);
+      std::swap(a, b);
+   }
+   return b == 1;
+}
+
+//===============================================================================
+uInteger PolynomialWordModulus::expansion(PolynomialWord h) const
+{
+   // when the coefficient w_i is computed, w_{i-d} is the bit d - 1 of res
+   PolynomialWord res = 0;
+   for (unsigned int i = 0; i < m_degree; i++) {
+      const PolynomialWord w = ((h >> (m_degree - i - 1)) & 1) ^ parity(res & m_feedback);
+      res = ((res << 1) | w) & m_mask;
+   }
+   return (uInteger) res;
+}
+
+}
@@ -0,0 +1,146 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Prefetcher.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <atomic>
+#include <deque>
+#include <thread>
+
+namespace LatBuilder
+{
+
+//===============================================================================
+bool Prefetcher::Task::start()
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   if (m_state != State::PENDING)
+      return false;
+   m_state = State::RUNNING;
+   return true;
+}
+
+void Prefetcher::Task::finish()
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_state = State::DONE;
+   }
+   m_done.notify_all();
+}
+
+void Prefetcher::Task::complete()
+{
+   if (start()) {
+      run();
+      finish();
+      return;
+   }
+   std::unique_lock<std::mutex> lock(m_mutex);
+   m_done.wait(lock, [this] { return m_state == State::DONE; });
+}
+
+void Prefetcher::Task::cancel()
+{
+   std::unique_lock<std::mutex> lock(m_mutex);
+   if (m_state == State::PENDING) {
+      m_state = State::DONE;
+      return;
+   }
+   m_done.wait(lock, [this] { return m_state == State::DONE; });
+}
+
+//===============================================================================
+namespace {
+   std::atomic<bool> prefetchEnabled{true};
+}
+
+// background thread, joined at the end of the process
+class Prefetcher::Worker
+{
+public:
+   Worker():
+      m_stop(false),
+      m_thread([this] { work(); })
+   {}
+
+   ~Worker()
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_stop = true;
+      }
+      m_wakeUp.notify_one();
+      m_thread.join();
+   }
+
+   void submit(std::shared_ptr<Task> task)
+   {
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_queue.push_back(std::move(task));
+      }
+      m_wakeUp.notify_one();
+   }
+
+private:
+   std::mutex m_mutex;
+   std::condition_variable m_wakeUp;
+   std::deque<std::shared_ptr<Task>> m_queue;
+   bool m_stop;
+   std::thread m_thread;
+
+   // runs the queued tasks which have not been completed nor withdrawn by
+   // their consumers
+   void work()
+   {
+      while (true) {
+         std::shared_ptr<Task> task;
+         {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait(lock, [this] { return m_stop or not m_queue.empty(); });
+            if (m_queue.empty())
+               return;
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+         }
+         if (task->start()) {
+            task->run();
+            task->finish();
+         }
+      }
+   }
+};
+
+//===============================================================================
+bool Prefetcher::enabled()
+{
+   return prefetchEnabled.load(std::memory_order_relaxed)
+      and std::thread::hardware_concurrency() > 1
+      and ThreadPool::global().size() == 1;
+}
+
+void Prefetcher::setEnabled(bool enabled)
+{ prefetchEnabled.store(enabled, std::memory_order_relaxed); }
+
+void Prefetcher::submit(std::shared_ptr<Task> task)
+{
+   static Worker worker;
+   worker.submit(std::move(task));
+}
+
+}
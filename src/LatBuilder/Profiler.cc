@@ -0,0 +1,286 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Memory.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+namespace LatBuilder
+{
+
+namespace {
+
+   struct State {
+      std::array<std::atomic<unsigned long long>, Profiler::NUM_TIMERS> calls;
+      std::array<std::atomic<unsigned long long>, Profiler::NUM_TIMERS> nanoseconds;
+      std::array<std::atomic<unsigned long long>, Profiler::NUM_COUNTERS> counters;
+
+      // values accumulated before the last reset
+      std::array<std::atomic<unsigned long long>, Profiler::NUM_TIMERS> pastCalls;
+      std::array<std::atomic<unsigned long long>, Profiler::NUM_TIMERS> pastNanoseconds;
+      std::array<std::atomic<unsigned long long>, Profiler::NUM_COUNTERS> pastCounters;
+
+      std::mutex mutex; // of the flags
+      bool requested = false;
+      bool monitored = false;
+
+      State()
+      {
+         for (auto& x : calls) x = 0;
+         for (auto& x : nanoseconds) x = 0;
+         for (auto& x : counters) x = 0;
+         for (auto& x : pastCalls) x = 0;
+         for (auto& x : pastNanoseconds) x = 0;
+         for (auto& x : pastCounters) x = 0;
+      }
+   };
+
+   State& state()
+   {
+      static State instance;
+      return instance;
+   }
+
+   const char* const timerNames[Profiler::NUM_TIMERS] = {
+      "kernel-setup", "candidate-construction", "evaluation", "fft"
+   };
+
+   const char* const counterNames[Profiler::NUM_COUNTERS] = {
+      "candidates", "early-aborts", "rank-operations", "screened-out",
+      "kernel-cache-hits", "kernel-cache-misses", "plan-cache-hits", "plan-cache-misses",
+      "tvalue-cache-hits", "tvalue-cache-misses", "result-cache-hits", "result-cache-misses"
+   };
+
+   // caches whose hit ratios are reported, with their hit and miss counters
+   const struct { const char* name; Profiler::Counter hits; Profiler::Counter misses; } caches[] = {
+      {"kernel", Profiler::Counter::KERNEL_CACHE_HITS, Profiler::Counter::KERNEL_CACHE_MISSES},
+      {"plan", Profiler::Counter::PLAN_CACHE_HITS, Profiler::Counter::PLAN_CACHE_MISSES},
+      {"tvalue", Profiler::Counter::TVALUE_CACHE_HITS, Profiler::Counter::TVALUE_CACHE_MISSES},
+      {"result", Profiler::Counter::RESULT_CACHE_HITS, Profiler::Counter::RESULT_CACHE_MISSES}
+   };
+
+   template <typename E>
+   unsigned int index(E e)
+   { return static_cast<unsigned int>(e); }
+
+   bool endsWith(const std::string& s, const std::string& suffix)
+   { return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0; }
+
+   // name of a metric in the Prometheus format, which does not allow dashes
+   std::string metricName(std::string name)
+   {
+      std::replace(name.begin(), name.end(), '-', '_');
+      return "latnetbuilder_" + name;
+   }
+
+   double ratio(unsigned long long numerator, unsigned long long denominator)
+   { return denominator ? double(numerator) / denominator : 0.0; }
+}
+
+std::atomic<bool> Profiler::s_enabled(false);
+
+//===============================================================================
+void Profiler::setEnabled(bool value)
+{
+   auto& s = state(); // constructed before the first instrumentation point
+   std::lock_guard<std::mutex> lock(s.mutex);
+   s.requested = value;
+   s_enabled.store(s.requested || s.monitored, std::memory_order_relaxed);
+}
+
+void Profiler::setMonitored(bool value)
+{
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   s.monitored = value;
+   s_enabled.store(s.requested || s.monitored, std::memory_order_relaxed);
+}
+
+void Profiler::add(Timer timer, Clock::duration duration)
+{
+   auto& s = state();
+   s.calls[index(timer)].fetch_add(1, std::memory_order_relaxed);
+   s.nanoseconds[index(timer)].fetch_add(
+         std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(),
+         std::memory_order_relaxed);
+}
+
+void Profiler::add(Counter counter, unsigned long long n)
+{ state().counters[index(counter)].fetch_add(n, std::memory_order_relaxed); }
+
+//===============================================================================
+unsigned long long Profiler::calls(Timer timer)
+{ return state().calls[index(timer)].load(); }
+
+double Profiler::seconds(Timer timer)
+{ return 1e-9 * state().nanoseconds[index(timer)].load(); }
+
+unsigned long long Profiler::value(Counter counter)
+{ return state().counters[index(counter)].load(); }
+
+unsigned long long Profiler::totalCalls(Timer timer)
+{ return state().pastCalls[index(timer)].load() + calls(timer); }
+
+double Profiler::totalSeconds(Timer timer)
+{ return 1e-9 * (state().pastNanoseconds[index(timer)].load() + state().nanoseconds[index(timer)].load()); }
+
+unsigned long long Profiler::totalValue(Counter counter)
+{ return state().pastCounters[index(counter)].load() + value(counter); }
+
+std::string Profiler::name(Timer timer)
+{ return timerNames[index(timer)]; }
+
+std::string Profiler::name(Counter counter)
+{ return counterNames[index(counter)]; }
+
+void Profiler::reset()
+{
+   auto& s = state();
+   for (unsigned int i = 0; i < NUM_TIMERS; i++) {
+      s.pastCalls[i] += s.calls[i].exchange(0);
+      s.pastNanoseconds[i] += s.nanoseconds[i].exchange(0);
+   }
+   for (unsigned int i = 0; i < NUM_COUNTERS; i++)
+      s.pastCounters[i] += s.counters[i].exchange(0);
+   Memory::resetPeaks();
+}
+
+//===============================================================================
+void Profiler::writeJson(std::ostream& os)
+{
+   // the times are accumulated in nanoseconds
+   const auto flags = os.flags();
+   const auto precision = os.precision(9);
+   os << std::fixed;
+   os << "{" << std::endl;
+   os << "  \"timers\": {" << std::endl;
+   for (unsigned int i = 0; i < NUM_TIMERS; i++) {
+      const auto timer = static_cast<Timer>(i);
+      os << "    \"" << name(timer) << "\": {\"calls\": " << calls(timer) << ", \"seconds\": " << seconds(timer) << "}";
+      os << (i + 1 < NUM_TIMERS ? "," : "") << std::endl;
+   }
+   os << "  }," << std::endl;
+   os << "  \"counters\": {" << std::endl;
+   for (unsigned int i = 0; i < NUM_COUNTERS; i++) {
+      const auto counter = static_cast<Counter>(i);
+      os << "    \"" << name(counter) << "\": " << value(counter);
+      os << (i + 1 < NUM_COUNTERS ? "," : "") << std::endl;
+   }
+   os << "  }," << std::endl;
+   os << "  \"memory\": {" << std::endl;
+   for (unsigned int i = 0; i < Memory::NUM_COMPONENTS; i++) {
+      const auto component = static_cast<Memory::Component>(i);
+      os << "    \"" << Memory::name(component) << "\": {\"bytes\": " << Memory::bytes(component)
+         << ", \"peak-bytes\": " << Memory::peakBytes(component) << "}," << std::endl;
+   }
+   os << "    \"total\": {\"bytes\": " << Memory::totalBytes() << ", \"peak-bytes\": " << Memory::peakTotalBytes() << "}" << std::endl;
+   os << "  }" << std::endl;
+   os << "}" << std::endl;
+   os.flags(flags);
+   os.precision(precision);
+}
+
+void Profiler::writeCsv(std::ostream& os)
+{
+   // the times are accumulated in nanoseconds
+   const auto flags = os.flags();
+   const auto precision = os.precision(9);
+   os << std::fixed;
+   os << "name,calls,seconds" << std::endl;
+   for (unsigned int i = 0; i < NUM_TIMERS; i++) {
+      const auto timer = static_cast<Timer>(i);
+      os << name(timer) << "," << calls(timer) << "," << seconds(timer) << std::endl;
+   }
+   for (unsigned int i = 0; i < NUM_COUNTERS; i++) {
+      const auto counter = static_cast<Counter>(i);
+      os << name(counter) << "," << value(counter) << "," << std::endl;
+   }
+   for (unsigned int i = 0; i < Memory::NUM_COMPONENTS; i++) {
+      const auto component = static_cast<Memory::Component>(i);
+      os << "peak-bytes:" << Memory::name(component) << "," << Memory::peakBytes(component) << "," << std::endl;
+   }
+   os << "peak-bytes:total," << Memory::peakTotalBytes() << "," << std::endl;
+   os.flags(flags);
+   os.precision(precision);
+}
+
+void Profiler::writeMetrics(std::ostream& os)
+{
+   const auto flags = os.flags();
+   const auto precision = os.precision(9);
+   os << std::fixed;
+   os << "# HELP latnetbuilder_phase_calls_total Number of calls of the timed phases." << std::endl;
+   os << "# TYPE latnetbuilder_phase_calls_total counter" << std::endl;
+   for (unsigned int i = 0; i < NUM_TIMERS; i++) {
+      const auto timer = static_cast<Timer>(i);
+      os << "latnetbuilder_phase_calls_total{phase=\"" << name(timer) << "\"} " << totalCalls(timer) << std::endl;
+   }
+   os << "# HELP latnetbuilder_phase_seconds_total Wall-clock time of the timed phases, over all threads." << std::endl;
+   os << "# TYPE latnetbuilder_phase_seconds_total counter" << std::endl;
+   for (unsigned int i = 0; i < NUM_TIMERS; i++) {
+      const auto timer = static_cast<Timer>(i);
+      os << "latnetbuilder_phase_seconds_total{phase=\"" << name(timer) << "\"} " << totalSeconds(timer) << std::endl;
+   }
+   for (unsigned int i = 0; i < NUM_COUNTERS; i++) {
+      const auto counter = static_cast<Counter>(i);
+      const std::string metric = metricName(name(counter)) + "_total";
+      os << "# TYPE " << metric << " counter" << std::endl;
+      os << metric << " " << totalValue(counter) << std::endl;
+   }
+   os << "# HELP latnetbuilder_early_abort_ratio Fraction of the candidates whose evaluation was stopped early." << std::endl;
+   os << "# TYPE latnetbuilder_early_abort_ratio gauge" << std::endl;
+   os << "latnetbuilder_early_abort_ratio " << ratio(totalValue(Counter::EARLY_ABORTS), totalValue(Counter::CANDIDATES)) << std::endl;
+   os << "# HELP latnetbuilder_cache_hit_ratio Fraction of the lookups answered by each cache." << std::endl;
+   os << "# TYPE latnetbuilder_cache_hit_ratio gauge" << std::endl;
+   for (const auto& cache : caches) {
+      const auto hits = totalValue(cache.hits);
+      os << "latnetbuilder_cache_hit_ratio{cache=\"" << cache.name << "\"} " << ratio(hits, hits + totalValue(cache.misses)) << std::endl;
+   }
+   os << "# HELP latnetbuilder_memory_bytes Size of the large data structures of each component." << std::endl;
+   os << "# TYPE latnetbuilder_memory_bytes gauge" << std::endl;
+   for (unsigned int i = 0; i < Memory::NUM_COMPONENTS; i++) {
+      const auto component = static_cast<Memory::Component>(i);
+      os << "latnetbuilder_memory_bytes{component=\"" << Memory::name(component) << "\"} " << Memory::bytes(component) << std::endl;
+   }
+   os << "# HELP latnetbuilder_memory_peak_bytes Largest size of the large data structures of each component since the start of the last task." << std::endl;
+   os << "# TYPE latnetbuilder_memory_peak_bytes gauge" << std::endl;
+   for (unsigned int i = 0; i < Memory::NUM_COMPONENTS; i++) {
+      const auto component = static_cast<Memory::Component>(i);
+      os << "latnetbuilder_memory_peak_bytes{component=\"" << Memory::name(component) << "\"} " << Memory::peakBytes(component) << std::endl;
+   }
+   os.flags(flags);
+   os.precision(precision);
+}
+
+void Profiler::write(const std::string& fileName)
+{
+   std::ofstream file(fileName);
+   if (!file)
+      throw std::runtime_error("cannot write profile file " + fileName);
+   if (endsWith(fileName, ".csv"))
+      writeCsv(file);
+   else
+      writeJson(file);
+   if (!file)
+      throw std::runtime_error("cannot write profile file " + fileName);
+}
+
+}
@@ -0,0 +1,176 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/ProgressFeed.h"
+#include "latbuilder/Budget.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace LatBuilder
+{
+
+namespace {
+
+   struct Counters {
+      std::atomic<Dimension> coordinate{0};
+      std::atomic<Dimension> dimension{0};
+      std::atomic<unsigned long long> candidate{0};
+      std::atomic<unsigned long long> candidates{0};
+      std::atomic<Real> bestMerit{std::numeric_limits<Real>::quiet_NaN()};
+   };
+
+   struct Writer {
+      std::mutex mutex;
+      std::condition_variable wakeUp;
+      bool stop = false;
+      std::ofstream file;
+      std::thread thread;
+      std::chrono::steady_clock::time_point start;
+      unsigned long long seq = 0;
+      std::string last; // counters of the last record
+   };
+
+   Counters& counters()
+   {
+      static Counters instance;
+      return instance;
+   }
+
+   Writer& writer()
+   {
+      static Writer instance;
+      return instance;
+   }
+
+   // the counters of a record, without seq, elapsed and done
+   std::string formatCounters()
+   {
+      const Counters& c = counters();
+      std::ostringstream os;
+      os.precision(std::numeric_limits<Real>::max_digits10);
+      os << "\"coordinate\": " << c.coordinate.load(std::memory_order_relaxed)
+         << ", \"dimension\": " << c.dimension.load(std::memory_order_relaxed)
+         << ", \"candidate\": " << c.candidate.load(std::memory_order_relaxed)
+         << ", \"candidates\": " << c.candidates.load(std::memory_order_relaxed)
+         << ", \"evaluated\": " << Budget::evaluations()
+         << ", \"best_merit\": ";
+      const Real merit = c.bestMerit.load(std::memory_order_relaxed);
+      if (std::isfinite(merit))
+         os << merit;
+      else
+         os << "null";
+      return os.str();
+   }
+
+   // requires the lock on the mutex of the writer
+   void writeRecord(Writer& w, bool done)
+   {
+      const std::string current = formatCounters();
+      if (current == w.last && !done)
+         return;
+      w.last = current;
+      const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - w.start).count();
+      w.file << "{\"seq\": " << w.seq++ << ", \"elapsed\": " << elapsed << ", " << current
+         << ", \"done\": " << (done ? "true" : "false") << "}\n";
+      w.file.flush();
+   }
+}
+
+//===============================================================================
+void ProgressFeed::start(const std::string& fileName, Real period)
+{
+   Writer& w = writer();
+   std::lock_guard<std::mutex> lock(w.mutex);
+   if (w.thread.joinable())
+      throw std::runtime_error("ProgressFeed: the feed is already started");
+   w.file.open(fileName, std::ios::out | std::ios::trunc);
+   if (!w.file)
+      throw std::runtime_error("cannot open the progress file " + fileName);
+   w.stop = false;
+   w.start = std::chrono::steady_clock::now();
+   w.seq = 0;
+   w.last.clear();
+   const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<Real>(period));
+   w.thread = std::thread([&w, interval]
+         {
+            std::unique_lock<std::mutex> lock(w.mutex);
+            while (!w.wakeUp.wait_for(lock, interval, [&w] { return w.stop; }))
+               writeRecord(w, false);
+         });
+}
+
+void ProgressFeed::stop()
+{
+   Writer& w = writer();
+   {
+      std::lock_guard<std::mutex> lock(w.mutex);
+      if (!w.thread.joinable())
+         return;
+      w.stop = true;
+   }
+   w.wakeUp.notify_all();
+   w.thread.join();
+   std::lock_guard<std::mutex> lock(w.mutex);
+   writeRecord(w, true);
+   w.file.close();
+}
+
+//===============================================================================
+ProgressFeed::Session::Session(const std::string& fileName, Real period):
+   m_started(!fileName.empty())
+{
+   if (m_started)
+      start(fileName, period);
+}
+
+ProgressFeed::Session::~Session()
+{
+   if (m_started)
+      stop();
+}
+
+//===============================================================================
+void ProgressFeed::setCoordinate(Dimension coordinate, Dimension dimension)
+{
+   Counters& c = counters();
+   c.coordinate.store(coordinate, std::memory_order_relaxed);
+   c.dimension.store(dimension, std::memory_order_relaxed);
+}
+
+void ProgressFeed::setCandidates(unsigned long long candidates)
+{
+   Counters& c = counters();
+   c.candidates.store(candidates, std::memory_order_relaxed);
+   c.candidate.store(0, std::memory_order_relaxed);
+}
+
+void ProgressFeed::setCandidate(unsigned long long candidate)
+{ counters().candidate.store(candidate, std::memory_order_relaxed); }
+
+void ProgressFeed::setBestMerit(Real merit)
+{ counters().bestMerit.store(merit, std::memory_order_relaxed); }
+
+}
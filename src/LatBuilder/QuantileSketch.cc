@@ -0,0 +1,178 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/QuantileSketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace LatBuilder
+{
+
+namespace {
+   const std::uint64_t SEED = 0x9e3779b97f4a7c15ULL;
+}
+
+//===============================================================================
+QuantileSketch::QuantileSketch(unsigned int k):
+   m_k(k)
+{
+   if (k < 2)
+      throw std::invalid_argument("QuantileSketch: the capacity must be at least 2");
+   clear();
+}
+
+//===============================================================================
+void QuantileSketch::clear()
+{
+   m_levels.assign(1, std::vector<Real>());
+   m_size = 0;
+   m_count = 0;
+   m_min = std::numeric_limits<Real>::infinity();
+   m_max = -std::numeric_limits<Real>::infinity();
+   m_randomState = SEED;
+   updateCapacity();
+}
+
+//===============================================================================
+void QuantileSketch::insert(Real value)
+{
+   m_levels[0].push_back(value);
+   ++m_size;
+   ++m_count;
+   m_min = std::min(m_min, value);
+   m_max = std::max(m_max, value);
+   if (m_size >= m_totalCapacity)
+      compress();
+}
+
+//===============================================================================
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+   if (m_levels.size() < other.m_levels.size()) {
+      m_levels.resize(other.m_levels.size());
+      updateCapacity();
+   }
+   for (size_t h = 0; h < other.m_levels.size(); h++)
+      m_levels[h].insert(m_levels[h].end(), other.m_levels[h].begin(), other.m_levels[h].end());
+   m_size += other.m_size;
+   m_count += other.m_count;
+   m_min = std::min(m_min, other.m_min);
+   m_max = std::max(m_max, other.m_max);
+   while (m_size >= m_totalCapacity)
+      compress();
+}
+
+//===============================================================================
+void QuantileSketch::updateCapacity()
+{
+   // the capacities only depend on the number of levels
+   m_capacities.resize(m_levels.size());
+   m_totalCapacity = 0;
+   for (size_t h = 0; h < m_levels.size(); h++) {
+      const size_t depth = m_levels.size() - 1 - h;
+      m_capacities[h] = std::max<size_t>(2, (size_t) std::ceil(m_k * std::pow(2.0 / 3.0, (double) depth)));
+      m_totalCapacity += m_capacities[h];
+   }
+}
+
+//===============================================================================
+void QuantileSketch::compress()
+{
+   for (size_t h = 0; h < m_levels.size(); h++) {
+      if (m_levels[h].size() < m_capacities[h])
+         continue;
+      if (h + 1 == m_levels.size()) {
+         m_levels.emplace_back();
+         updateCapacity();
+      }
+      auto& level = m_levels[h];
+      std::sort(level.begin(), level.end());
+      // an odd value out stays at its level
+      Real leftover = 0;
+      const bool odd = level.size() % 2 == 1;
+      if (odd) {
+         leftover = level.back();
+         level.pop_back();
+      }
+      auto& next = m_levels[h + 1];
+      for (size_t i = randomBit() ? 1 : 0; i < level.size(); i += 2)
+         next.push_back(level[i]);
+      m_size -= level.size() / 2;
+      level.clear();
+      if (odd)
+         level.push_back(leftover);
+      return;
+   }
+}
+
+//===============================================================================
+bool QuantileSketch::randomBit()
+{
+   // xorshift64*
+   m_randomState ^= m_randomState >> 12;
+   m_randomState ^= m_randomState << 25;
+   m_randomState ^= m_randomState >> 27;
+   return ((m_randomState * 0x2545f4914f6cdd1dULL) >> 63) != 0;
+}
+
+//===============================================================================
+Real QuantileSketch::quantile(Real p) const
+{
+   if (m_count == 0)
+      throw std::logic_error("QuantileSketch: no value was inserted");
+   if (p <= 0)
+      return m_min;
+   if (p >= 1)
+      return m_max;
+
+   std::vector<std::pair<Real, unsigned long long>> weighted;
+   weighted.reserve(m_size);
+   for (size_t h = 0; h < m_levels.size(); h++) {
+      for (const auto& value : m_levels[h])
+         weighted.emplace_back(value, 1ULL << h);
+   }
+   std::sort(weighted.begin(), weighted.end());
+
+   // the weights sum to the number of values of the stream
+   const Real target = p * m_count;
+   unsigned long long rank = 0;
+   for (const auto& x : weighted) {
+      rank += x.second;
+      if (rank >= target)
+         return x.first;
+   }
+   return m_max;
+}
+
+//===============================================================================
+Real QuantileSketch::cdf(Real value) const
+{
+   if (m_count == 0)
+      throw std::logic_error("QuantileSketch: no value was inserted");
+   unsigned long long rank = 0;
+   for (size_t h = 0; h < m_levels.size(); h++) {
+      for (const auto& x : m_levels[h]) {
+         if (x <= value)
+            rank += 1ULL << h;
+      }
+   }
+   return std::min<Real>(1, Real(rank) / m_count);
+}
+
+}
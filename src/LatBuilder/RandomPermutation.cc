@@ -0,0 +1,69 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/RandomPermutation.h"
+
+#include <stdexcept>
+
+namespace LatBuilder {
+
+namespace {
+   // finalizer of SplitMix64, a bijective mixing of the bits of a word
+   uint64_t mix(uint64_t x)
+   {
+      x ^= x >> 30;
+      x *= 0xbf58476d1ce4e5b9ULL;
+      x ^= x >> 27;
+      x *= 0x94d049bb133111ebULL;
+      x ^= x >> 31;
+      return x;
+   }
+}
+
+constexpr unsigned int RandomPermutation::rounds;
+
+//===========================================================================
+
+RandomPermutation::RandomPermutation(uint64_t size, uint64_t key):
+   m_size(size),
+   m_halfBits(1)
+{
+   if (size == 0)
+      throw std::invalid_argument("RandomPermutation: the number of indices must be positive");
+   while (m_halfBits < 32 && ((size - 1) >> (2 * m_halfBits)) != 0)
+      ++m_halfBits;
+   m_halfMask = (uint64_t(1) << m_halfBits) - 1;
+   for (unsigned int r = 0; r < rounds; r++) {
+      key += 0x9e3779b97f4a7c15ULL;
+      m_keys[r] = mix(key);
+   }
+}
+
+//===========================================================================
+
+uint64_t RandomPermutation::encrypt(uint64_t x) const
+{
+   uint64_t left = x >> m_halfBits;
+   uint64_t right = x & m_halfMask;
+   for (unsigned int r = 0; r < rounds; r++) {
+      const uint64_t next = left ^ (mix(right ^ m_keys[r]) & m_halfMask);
+      left = right;
+      right = next;
+   }
+   return (left << m_halfBits) | right;
+}
+
+}
@@ -0,0 +1,174 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/Shard.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace LatBuilder
+{
+
+namespace {
+   unsigned int shardIndex = 0;
+   unsigned int shardCount = 1;
+
+   const std::string shardTag = "# Shard: ";
+   const std::string coordinatesTag = "# Coordinates: ";
+   const std::string meritTag = "# Merit: ";
+
+   bool startsWith(const std::string& line, const std::string& prefix)
+   { return line.compare(0, prefix.size(), prefix) == 0; }
+
+   // parses "<index>/<count>"
+   bool parseShard(const std::string& str, unsigned int& index, unsigned int& count)
+   {
+      std::istringstream is(str);
+      char slash = 0;
+      return (is >> index >> slash >> count) && slash == '/' && (is >> std::ws).eof() && index < count;
+   }
+}
+
+//===============================================================================
+void Shard::set(unsigned int index, unsigned int count)
+{
+   if (index >= count)
+      throw std::runtime_error("the shard index must be smaller than the number of shards");
+   shardIndex = index;
+   shardCount = count;
+}
+
+void Shard::parse(const std::string& spec)
+{
+   unsigned int index, count;
+   if (!parseShard(spec, index, count))
+      throw std::runtime_error("invalid shard " + spec + ": expected <index>/<count>, with 0 <= <index> < <count>");
+   set(index, count);
+}
+
+void Shard::clear()
+{
+   shardIndex = 0;
+   shardCount = 1;
+}
+
+unsigned int Shard::index()
+{ return shardIndex; }
+
+unsigned int Shard::count()
+{ return shardCount; }
+
+//===============================================================================
+LFSR258 Shard::randomGenerator()
+{
+   LFSR258 rand;
+   for (unsigned int i = 0; i < index(); i++)
+      rand.nextStream();
+   return rand;
+}
+
+//===============================================================================
+void Shard::Result::write(const std::string& fileName) const
+{
+   const std::string tmpFileName = fileName + ".tmp";
+   {
+      std::ofstream file(tmpFileName);
+      if (!file)
+         throw std::runtime_error("cannot write shard result " + tmpFileName);
+      file.precision(std::numeric_limits<Real>::max_digits10);
+      file << shardTag << index << "/" << count << std::endl;
+      file << coordinatesTag << genValues.size() << std::endl;
+      file << meritTag << merit << std::endl;
+      for (const auto& genValue : genValues)
+         file << genValue << std::endl;
+      if (!file)
+         throw std::runtime_error("cannot write shard result " + tmpFileName);
+   }
+   if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+      throw std::runtime_error("cannot rename " + tmpFileName + " to " + fileName);
+}
+
+Shard::Result Shard::Result::read(const std::string& fileName)
+{
+   std::ifstream file(fileName);
+   if (!file)
+      throw std::runtime_error("cannot read shard result " + fileName);
+
+   Result result;
+   bool hasShard = false;
+   bool hasMerit = false;
+   bool hasDimension = false;
+   size_t dimension = 0;
+
+   std::string line;
+   while (std::getline(file, line)) {
+      if (startsWith(line, shardTag)) {
+         hasShard = parseShard(line.substr(shardTag.size()), result.index, result.count);
+      }
+      else if (startsWith(line, coordinatesTag)) {
+         std::istringstream is(line.substr(coordinatesTag.size()));
+         hasDimension = static_cast<bool>(is >> dimension);
+      }
+      else if (startsWith(line, meritTag)) {
+         // strtold() reads the merit with the precision of any Real type, and
+         // also the infinite merit of the shards without candidates
+         const std::string value = line.substr(meritTag.size());
+         char* end = nullptr;
+         result.merit = (Real) std::strtold(value.c_str(), &end);
+         hasMerit = end != value.c_str();
+      }
+      else if (!line.empty() && line[0] != '#') {
+         result.genValues.push_back(line);
+      }
+   }
+
+   if (!hasShard || !hasDimension || !hasMerit || dimension != result.genValues.size())
+      throw std::runtime_error("invalid shard result " + fileName);
+
+   return result;
+}
+
+//===============================================================================
+Shard::Result Shard::merge(const std::vector<Result>& results)
+{
+   if (results.empty())
+      throw std::runtime_error("no shard result to merge");
+
+   const unsigned int count = results.front().count;
+   std::vector<bool> seen(count, false);
+   const Result* best = nullptr;
+   for (const auto& result : results) {
+      if (result.count != count)
+         throw std::runtime_error("the shard results to merge were written for different numbers of shards");
+      if (seen[result.index])
+         throw std::runtime_error("shard " + std::to_string(result.index) + "/" + std::to_string(count) + " is given more than once");
+      seen[result.index] = true;
+      if (!best || result.merit < best->merit || (result.merit == best->merit && result.index < best->index))
+         best = &result;
+   }
+   if (results.size() != count)
+      throw std::runtime_error("only " + std::to_string(results.size()) + " of the " + std::to_string(count) + " shard results are given");
+   if (best->genValues.empty())
+      throw std::runtime_error("none of the shards found a candidate");
+   return *best;
+}
+
+}
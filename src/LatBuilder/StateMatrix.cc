@@ -0,0 +1,231 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/StateMatrix.h"
+#include "latbuilder/StateIO.h"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
+
+namespace LatBuilder
+{
+
+namespace {
+   struct Settings {
+      std::mutex mutex;
+      std::string directory;
+   };
+
+   Settings& settings()
+   {
+      static Settings instance;
+      return instance;
+   }
+
+   // number of elements in 32 bytes
+   const size_t ALIGNMENT = 32 / sizeof(Real) > 0 ? 32 / sizeof(Real) : 1;
+}
+
+//===============================================================================
+void StateMatrix::setDirectory(const std::string& directory)
+{
+   if (!directory.empty())
+      boost::filesystem::create_directories(directory);
+   auto& s = settings();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   s.directory = directory;
+}
+
+std::string StateMatrix::directory()
+{
+   auto& s = settings();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   return s.directory;
+}
+
+//===============================================================================
+StateMatrix::StateMatrix():
+   m_numColumns(0),
+   m_rowSize(0),
+   m_numRows(0),
+   m_data(nullptr),
+   m_usage(Memory::Component::STATES)
+{}
+
+StateMatrix::StateMatrix(const StateMatrix& other):
+   StateMatrix()
+{ *this = other; }
+
+StateMatrix& StateMatrix::operator=(const StateMatrix& other)
+{
+   if (this == &other)
+      return *this;
+   removeFile();
+   m_memory.clear();
+   m_numColumns = other.m_numColumns;
+   m_rowSize = other.m_rowSize;
+   m_numRows = 0;
+   m_data = nullptr;
+   if (other.mapped()) {
+      // a copy of a matrix kept in a file gets a file of its own, in the same
+      // directory
+      createFile(boost::filesystem::path(other.m_fileName).parent_path().string());
+      mapFile(other.m_numRows * m_rowSize * sizeof(Real));
+      m_numRows = other.m_numRows;
+   }
+   else {
+      m_memory = other.m_memory;
+      m_data = m_memory.data();
+      m_numRows = other.m_numRows;
+   }
+   if (m_numRows > 0)
+      std::copy(other.row(0), other.row(0) + m_numRows * m_rowSize, m_data);
+   account();
+   return *this;
+}
+
+StateMatrix::~StateMatrix()
+{ removeFile(); }
+
+//===============================================================================
+void StateMatrix::reset(size_t numColumns, Real value)
+{
+   removeFile();
+   m_memory.clear();
+   m_numColumns = numColumns;
+   m_rowSize = (numColumns + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+   m_numRows = 0;
+   m_data = nullptr;
+
+   const std::string dir = directory();
+   if (!dir.empty() && m_rowSize * sizeof(Real) >= HugePages::threshold)
+      createFile(dir);
+   resize(1, value);
+}
+
+void StateMatrix::appendRow(Real value)
+{ resize(m_numRows + 1, value); }
+
+//===============================================================================
+void StateMatrix::resize(size_t numRows, Real value)
+{
+   const size_t oldSize = m_numRows * m_rowSize;
+   const size_t newSize = numRows * m_rowSize;
+   if (mapped()) {
+      // the file is extended with zeros
+      mapFile(newSize * sizeof(Real));
+      if (value != 0.0 && newSize > oldSize)
+         std::fill(m_data + oldSize, m_data + newSize, value);
+   }
+   else {
+      m_memory.resize(newSize, value);
+      m_data = m_memory.data();
+   }
+   m_numRows = numRows;
+   account();
+}
+
+void StateMatrix::account()
+{ m_usage.set(mapped() ? 0 : m_memory.capacity() * sizeof(Real)); }
+
+void StateMatrix::createFile(const std::string& dir)
+{
+   const std::string fileName = (boost::filesystem::path(dir) / boost::filesystem::unique_path("state-%%%%-%%%%-%%%%-%%%%.bin")).string();
+   std::ofstream file(fileName, std::ios::binary);
+   if (!file)
+      throw std::runtime_error("cannot create state file in " + dir);
+   m_fileName = fileName;
+}
+
+void StateMatrix::mapFile(size_t bytes)
+{
+   namespace bip = boost::interprocess;
+   // the rows already written stay in the file while it is remapped
+   m_region = bip::mapped_region();
+   m_data = nullptr;
+   boost::filesystem::resize_file(m_fileName, bytes);
+   if (bytes == 0)
+      return;
+   m_file = bip::file_mapping(m_fileName.c_str(), bip::read_write);
+   m_region = bip::mapped_region(m_file, bip::read_write);
+   m_data = static_cast<Real*>(m_region.get_address());
+}
+
+void StateMatrix::removeFile()
+{
+   if (!mapped())
+      return;
+   namespace bip = boost::interprocess;
+   m_region = bip::mapped_region();
+   m_file = bip::file_mapping();
+   m_data = nullptr;
+   boost::system::error_code ec;
+   boost::filesystem::remove(m_fileName, ec);
+   m_fileName.clear();
+}
+
+//===============================================================================
+void StateMatrix::prefetch(size_t begin, size_t end) const
+{
+#if defined(__unix__) || defined(__APPLE__)
+   end = std::min(end, m_numColumns);
+   if (!mapped() || begin >= end)
+      return;
+   const std::uintptr_t page = boost::interprocess::mapped_region::get_page_size();
+   for (size_t r = 0; r < m_numRows; r++) {
+      const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(row(r) + begin) / page * page;
+      const std::uintptr_t last = reinterpret_cast<std::uintptr_t>(row(r) + end);
+      madvise(reinterpret_cast<void*>(first), last - first, MADV_WILLNEED);
+   }
+#else
+   (void) begin;
+   (void) end;
+#endif
+}
+
+//===============================================================================
+void StateMatrix::save(std::ostream& os) const
+{
+   StateIO::writeSize(os, m_numColumns);
+   StateIO::writeSize(os, m_numRows);
+   for (size_t r = 0; r < m_numRows; r++)
+      StateIO::writeArray(os, row(r), m_numColumns);
+}
+
+void StateMatrix::load(std::istream& is)
+{
+   const size_t numColumns = StateIO::readSize(is);
+   const size_t numRows = StateIO::readSize(is);
+   if (numRows == 0) {
+      *this = StateMatrix();
+      return;
+   }
+   reset(numColumns, 0.0);
+   resize(numRows, 0.0);
+   for (size_t r = 0; r < m_numRows; r++)
+      StateIO::readArray(is, row(r), m_numColumns);
+}
+
+}
@@ -0,0 +1,187 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/Task/EvalLevels.h"
+#include "latbuilder/PointGenerator.h"
+#include "latbuilder/CombinedWeights.h"
+#include "latbuilder/ExactSum.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/TextStream.h"
+
+#include "latticetester/ProductWeights.h"
+#include "latticetester/OrderDependentWeights.h"
+#include "latticetester/PODWeights.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace LatBuilder { namespace Task {
+
+namespace {
+   // number of points whose kernel values are computed at once
+   const uInteger blockSize = 1024;
+
+   // lowest level of embedding of the point of index i at level maxLevel
+   Level lowestLevel(uInteger i, uInteger base, Level maxLevel)
+   {
+      if (i == 0)
+         return 0;
+      Level level = maxLevel;
+      while (level > 0 and i % base == 0) {
+         i /= base;
+         level--;
+      }
+      return level;
+   }
+}
+
+//===========================================================================
+void EvalLevels::init(const LatticeTester::Weights& weights)
+{
+   if (const auto* w = dynamic_cast<const CombinedWeights*>(&weights)) {
+      for (const auto& component : w->list())
+         init(*component);
+      return;
+   }
+
+   Term term;
+   term.coordWeights.assign(dimension(), 1.0);
+   term.orderWeights.assign(dimension(), 1.0);
+   term.product = false;
+
+   if (const auto* w = dynamic_cast<const LatticeTester::PODWeights*>(&weights)) {
+      for (Dimension j = 0; j < dimension(); j++)
+         term.coordWeights[j] = w->getProductWeights().getWeightForCoordinate(j);
+      for (Dimension order = 0; order < dimension(); order++)
+         term.orderWeights[order] = w->getOrderDependentWeights().getWeightForOrder(order + 1);
+   }
+   else if (const auto* w = dynamic_cast<const LatticeTester::ProductWeights*>(&weights)) {
+      for (Dimension j = 0; j < dimension(); j++)
+         term.coordWeights[j] = w->getWeightForCoordinate(j);
+      term.product = true;
+   }
+   else if (const auto* w = dynamic_cast<const LatticeTester::OrderDependentWeights*>(&weights)) {
+      for (Dimension order = 0; order < dimension(); order++)
+         term.orderWeights[order] = w->getWeightForOrder(order + 1);
+   }
+   else
+      throw std::invalid_argument("the evaluation at every level supports only product, order-dependent and POD weights");
+
+   // the orders above the last one with a nonzero weight do not contribute
+   while (not term.product and not term.orderWeights.empty() and term.orderWeights.back() == 0.0)
+      term.orderWeights.pop_back();
+   m_terms.push_back(std::move(term));
+}
+
+//===========================================================================
+void EvalLevels::accumulate(uInteger first, uInteger last, ExactSum* sums) const
+{
+   const Dimension dim = dimension();
+   const uInteger base = m_sizeParam.base();
+   const Level maxLevel = m_sizeParam.maxLevel();
+
+   const LatticePointGenerator points(m_sizeParam.numPoints(), GeneratingVector(m_genVec.begin(), m_genVec.begin() + dim));
+
+   std::vector<Real> values(blockSize * dim);
+   std::vector<Real> elementary; // elementary symmetric polynomials of the weighted kernel values, by order
+
+   for (uInteger begin = first; begin < last; begin += blockSize) {
+      const uInteger count = std::min(blockSize, last - begin);
+      points.generate(begin, count, values.data());
+      if (count * dim > 0)
+         m_pointValues(values.data(), values.data(), count * dim);
+
+      for (uInteger i = 0; i < count; i++) {
+         const Real* const w = &values[i * dim];
+         Real contribution = 0.0;
+         for (const auto& term : m_terms) {
+            if (term.product) {
+               Real prod = 1.0;
+               for (Dimension j = 0; j < dim; j++)
+                  prod *= 1.0 + term.coordWeights[j] * w[j];
+               contribution += prod - 1.0;
+               continue;
+            }
+            const size_t maxOrder = term.orderWeights.size();
+            elementary.assign(maxOrder + 1, 0.0);
+            elementary[0] = 1.0;
+            for (Dimension j = 0; j < dim; j++) {
+               const Real x = term.coordWeights[j] * w[j];
+               // by decreasing order to avoid unwanted overwriting
+               for (size_t order = std::min<size_t>(maxOrder, j + 1); order > 0; order--)
+                  elementary[order] += x * elementary[order - 1];
+            }
+            for (size_t order = 1; order <= maxOrder; order++)
+               contribution += term.orderWeights[order - 1] * elementary[order];
+         }
+         sums[lowestLevel(begin + i, base, maxLevel)] += contribution;
+      }
+   }
+}
+
+//===========================================================================
+void EvalLevels::execute()
+{
+   if (dimension() > m_genVec.size())
+      throw std::runtime_error("dimension > generating vector size");
+
+   const uInteger numPoints = m_sizeParam.numPoints();
+   const Level maxLevel = m_sizeParam.maxLevel();
+
+   // each chunk of consecutive points accumulates its own sums by lowest level;
+   // the sums are exact, so that the merits do not depend on the number of
+   // chunks, hence on the number of threads
+   ThreadPool& pool = ThreadPool::global();
+   const size_t numChunks = (size_t) std::min<uInteger>(std::max<uInteger>(numPoints / (16 * blockSize), 1), 4 * pool.size());
+   std::vector<std::vector<ExactSum>> sums(numChunks, std::vector<ExactSum>(maxLevel + 1));
+   pool.parallelFor(numChunks, [&] (unsigned int, size_t chunk) {
+      const uInteger first = numPoints / numChunks * chunk + std::min<uInteger>(chunk, numPoints % numChunks);
+      const uInteger last = first + numPoints / numChunks + (chunk < numPoints % numChunks ? 1 : 0);
+      accumulate(first, last, sums[chunk].data());
+   });
+
+   // the points of a level are those of the level below and the points whose lowest level it is
+   m_levelMerits = RealVector(maxLevel + 1);
+   ExactSum cumulative;
+   for (Level level = 0; level <= maxLevel; level++) {
+      for (const auto& chunkSums : sums)
+         cumulative.merge(chunkSums[level]);
+      m_levelMerits[level] = cumulative.value();
+   }
+   m_sizeParam.normalize(m_levelMerits);
+
+   const auto lat = createLatDef(m_sizeParam, GeneratingVector(m_genVec.begin(), m_genVec.begin() + dimension()));
+   selectBestLattice(lat, filters().apply(m_levelMerits, lat), false);
+}
+
+//===========================================================================
+void EvalLevels::reset()
+{
+   Search<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>::reset();
+   m_levelMerits = RealVector();
+}
+
+//===========================================================================
+void EvalLevels::format(std::ostream& os) const
+{
+   os << "Task: LatBuilder Evaluation of an ordinary lattice at every level of embedding" << std::endl;
+   Search<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>::format(os);
+   os << "Modulus: " << m_sizeParam << std::endl;
+   os << "Figure of merit: " << figureOfMerit() << std::endl;
+}
+
+}}
@@ -19,5 +19,6 @@
 namespace LatBuilder { namespace Task {
 
 TASK_FOR_ALL_COORDSYM(TASK_BIND_TEMPLATE, CBCBasedSearch, FastCBC);
+TASK_FOR_ALL_COORDSYM_LATTICE_ORDINARY_UNILEVEL(TASK_BIND_TEMPLATE, CBCBasedSearch, FastGroupCBC);
 
 }}
@@ -0,0 +1,271 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Trace.h"
+
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace LatBuilder
+{
+
+//===============================================================================
+unsigned int ThreadPool::resolveNumThreads(unsigned int numThreads)
+{
+   if (numThreads > 0)
+      return numThreads;
+   unsigned int hw = std::thread::hardware_concurrency();
+   return hw > 0 ? hw : 1;
+}
+
+unsigned int ThreadPool::defaultNumThreads()
+{
+   const char* value = std::getenv("LATNETBUILDER_THREADS");
+   if (!value || !*value)
+      return 1;
+   char* end = nullptr;
+   const unsigned long numThreads = std::strtoul(value, &end, 10);
+   if (*end != '\0' || value[0] == '-' || numThreads > std::numeric_limits<unsigned int>::max())
+      return 1;
+   return static_cast<unsigned int>(numThreads);
+}
+
+//===============================================================================
+namespace {
+   thread_local bool insideLoop = false; // true while the thread runs a loop body
+
+   std::atomic<bool> pinThreads{false};
+
+   // indices of the processors the process may run on, in increasing order
+   std::vector<int> allowedProcessors()
+   {
+      std::vector<int> out;
+#ifdef __linux__
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+         for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set))
+               out.push_back(cpu);
+         }
+      }
+#endif
+      return out;
+   }
+
+   // pins the calling thread to processor cpu; failures are ignored, as the
+   // thread can run anywhere
+   void pinCurrentThread(int cpu)
+   {
+#ifdef __linux__
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpu, &set);
+      pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+      (void) cpu;
+#endif
+   }
+
+   // the shared pools of each size and pinning requested so far, kept until
+   // the end of the process so that a task still holding the previous shared
+   // pool can finish its loops when another one changes its size
+   struct GlobalPools {
+      std::mutex mutex;
+      std::map<std::pair<unsigned int, bool>, std::unique_ptr<ThreadPool>> pools;
+      std::atomic<ThreadPool*> current{nullptr};
+
+      GlobalPools()
+      {
+         const unsigned int size = ThreadPool::resolveNumThreads(ThreadPool::defaultNumThreads());
+         auto& pool = pools[std::make_pair(size, false)];
+         pool.reset(new ThreadPool(size));
+         current = pool.get();
+      }
+
+      // requires the lock on mutex
+      ThreadPool& get(unsigned int numThreads)
+      {
+         const unsigned int size = ThreadPool::resolveNumThreads(numThreads);
+         // a pool of size 1 has no thread to pin
+         auto& pool = pools[std::make_pair(size, size > 1 && ThreadPool::pinning())];
+         if (!pool)
+            pool.reset(new ThreadPool(size));
+         return *pool;
+      }
+   };
+
+   GlobalPools& globalPools()
+   {
+      static GlobalPools instance;
+      return instance;
+   }
+}
+
+ThreadPool& ThreadPool::global()
+{ return *globalPools().current.load(std::memory_order_acquire); }
+
+void ThreadPool::setGlobalSize(unsigned int numThreads)
+{
+   auto& global = globalPools();
+   std::lock_guard<std::mutex> lock(global.mutex);
+   global.current.store(&global.get(numThreads), std::memory_order_release);
+}
+
+ThreadPool& ThreadPool::shared(unsigned int numThreads)
+{
+   auto& global = globalPools();
+   std::lock_guard<std::mutex> lock(global.mutex);
+   return global.get(numThreads);
+}
+
+void ThreadPool::setPinning(bool pinned)
+{ pinThreads = pinned; }
+
+bool ThreadPool::pinning()
+{ return pinThreads; }
+
+//===============================================================================
+ThreadPool::ThreadPool(unsigned int numThreads):
+   m_size(resolveNumThreads(numThreads)),
+   m_pinned(false),
+   m_body(nullptr),
+   m_component(Memory::Component::OTHER),
+   m_n(0),
+   m_next(0),
+   m_generation(0),
+   m_busy(0),
+   m_stop(false),
+   m_running(false)
+{
+   if (m_size > 1 && pinning()) {
+      m_processors = allowedProcessors();
+      m_pinned = !m_processors.empty();
+   }
+   m_threads.reserve(m_size - 1);
+   for (unsigned int worker = 1; worker < m_size; ++worker)
+      m_threads.emplace_back(&ThreadPool::run, this, worker);
+}
+
+//===============================================================================
+ThreadPool::~ThreadPool()
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+   }
+   m_wakeUp.notify_all();
+   for (auto& thread : m_threads)
+      thread.join();
+}
+
+//===============================================================================
+void ThreadPool::work(unsigned int worker)
+{
+   Trace::Span span("work", "executor", "worker", worker);
+   Memory::Scope memory(m_component);
+   const bool wasInsideLoop = insideLoop;
+   insideLoop = true;
+   size_t i;
+   while ((i = m_next.fetch_add(1)) < m_n) {
+      try {
+         (*m_body)(worker, i);
+      }
+      catch (...) {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         if (!m_exception)
+            m_exception = std::current_exception();
+         m_next = m_n; // skip the remaining iterations
+      }
+   }
+   insideLoop = wasInsideLoop;
+}
+
+//===============================================================================
+void ThreadPool::run(unsigned int worker)
+{
+   if (m_pinned)
+      pinCurrentThread(m_processors[worker % m_processors.size()]);
+   Trace::setThreadName("worker " + std::to_string(worker) + "/" + std::to_string(m_size));
+   unsigned long generation = 0;
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock(m_mutex);
+         m_wakeUp.wait(lock, [&] { return m_stop || m_generation != generation; });
+         if (m_stop)
+            return;
+         generation = m_generation;
+      }
+      work(worker);
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         if (--m_busy == 0)
+            m_done.notify_one();
+      }
+   }
+}
+
+//===============================================================================
+void ThreadPool::parallelFor(size_t n, const Body& body)
+{
+   if (n == 0)
+      return;
+
+   Trace::Span span("parallel-for", "executor", "iterations", n);
+   if (m_size == 1 || n == 1 || insideLoop || m_running.exchange(true)) {
+      for (size_t i = 0; i < n; ++i)
+         body(0, i);
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_body = &body;
+      m_component = Memory::current();
+      m_n = n;
+      m_next = 0;
+      m_busy = m_size - 1;
+      m_exception = nullptr;
+      ++m_generation;
+   }
+   m_wakeUp.notify_all();
+
+   work(0);
+
+   std::exception_ptr exception;
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_done.wait(lock, [&] { return m_busy == 0; });
+      m_body = nullptr;
+      exception = m_exception;
+      m_exception = nullptr;
+   }
+   m_running = false;
+   if (exception)
+      std::rethrow_exception(exception);
+}
+
+}
@@ -0,0 +1,162 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/Trace.h"
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace LatBuilder
+{
+
+namespace {
+
+   struct Event {
+      const char* name;
+      const char* category;
+      const char* argName;
+      long long arg;
+      std::chrono::steady_clock::time_point start;
+      std::chrono::steady_clock::time_point end;
+   };
+
+   // spans of one thread; the lock is only contended while the trace is written
+   struct Buffer {
+      unsigned int thread;
+      std::string name;
+      std::mutex mutex;
+      std::vector<Event> events;
+   };
+
+   struct State {
+      std::mutex mutex;
+      std::vector<std::shared_ptr<Buffer>> buffers; // kept after their thread ends
+      std::chrono::steady_clock::time_point origin;
+   };
+
+   State& state()
+   {
+      static State instance;
+      return instance;
+   }
+
+   Buffer& threadBuffer()
+   {
+      thread_local std::shared_ptr<Buffer> buffer;
+      if (!buffer) {
+         auto& s = state();
+         std::lock_guard<std::mutex> lock(s.mutex);
+         buffer = std::make_shared<Buffer>();
+         buffer->thread = static_cast<unsigned int>(s.buffers.size()) + 1;
+         s.buffers.push_back(buffer);
+      }
+      return *buffer;
+   }
+
+   void writeString(std::ostream& os, const std::string& s)
+   {
+      os << '"';
+      for (const char c : s) {
+         if (c == '"' || c == '\\')
+            os << '\\' << c;
+         else if (static_cast<unsigned char>(c) < 0x20)
+            os << ' ';
+         else
+            os << c;
+      }
+      os << '"';
+   }
+
+   double microseconds(std::chrono::steady_clock::duration duration)
+   { return 1e-3 * std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(); }
+}
+
+std::atomic<bool> Trace::s_enabled(false);
+
+//===============================================================================
+void Trace::start()
+{
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   for (const auto& buffer : s.buffers) {
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+      buffer->events.clear();
+   }
+   s.origin = Clock::now();
+   s_enabled.store(true, std::memory_order_relaxed);
+}
+
+void Trace::stop()
+{ s_enabled.store(false, std::memory_order_relaxed); }
+
+void Trace::setThreadName(const std::string& name)
+{
+   auto& buffer = threadBuffer();
+   std::lock_guard<std::mutex> lock(buffer.mutex);
+   buffer.name = name;
+}
+
+void Trace::add(const char* name, const char* category, const char* argName, long long arg,
+      Clock::time_point start, Clock::time_point end)
+{
+   auto& buffer = threadBuffer();
+   std::lock_guard<std::mutex> lock(buffer.mutex);
+   buffer.events.push_back(Event{name, category, argName, arg, start, end});
+}
+
+//===============================================================================
+void Trace::write(const std::string& fileName)
+{
+   std::ofstream file(fileName);
+   if (!file)
+      throw std::runtime_error("cannot write trace file " + fileName);
+
+   auto& s = state();
+   std::lock_guard<std::mutex> lock(s.mutex);
+   file.precision(3);
+   file << std::fixed;
+   file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+   bool first = true;
+   for (const auto& buffer : s.buffers) {
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+      if (!buffer->name.empty()) {
+         file << (first ? "" : ",\n");
+         file << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": " << buffer->thread << ", \"args\": {\"name\": ";
+         writeString(file, buffer->name);
+         file << "}}";
+         first = false;
+      }
+      for (const auto& event : buffer->events) {
+         file << (first ? "" : ",\n");
+         file << "{\"ph\": \"X\", \"name\": \"" << event.name << "\", \"cat\": \"" << event.category << "\"";
+         file << ", \"pid\": 1, \"tid\": " << buffer->thread;
+         file << ", \"ts\": " << microseconds(event.start - s.origin) << ", \"dur\": " << microseconds(event.end - event.start);
+         if (event.argName)
+            file << ", \"args\": {\"" << event.argName << "\": " << event.arg << "}";
+         file << "}";
+         first = false;
+      }
+   }
+   file << std::endl << "]}" << std::endl;
+   if (!file)
+      throw std::runtime_error("cannot write trace file " + fileName);
+}
+
+}
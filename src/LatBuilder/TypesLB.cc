@@ -16,6 +16,7 @@
 
 #include "latbuilder/Types.h"
 #include "latbuilder/Util.h"
+#include "latbuilder/PolynomialWord.h"
 
 namespace LatBuilder {
 
@@ -42,6 +43,12 @@ LatticeTraits<LatticeType::POLYNOMIAL>::GenValue LatticeTraits<LatticeType::POLY
 uInteger LatticeTraits<LatticeType::POLYNOMIAL>::NumPoints(const LatticeTraits<LatticeType::POLYNOMIAL>::Modulus& modulus){return intPow(2,deg(modulus));}
 
 uInteger LatticeTraits<LatticeType::POLYNOMIAL>::ToKernelIndex(const size_t& index, const LatticeTraits<LatticeType::POLYNOMIAL>::Modulus& modulus)
-	{return Vm(PolynomialFromInt(index),modulus) ;}
+{
+   // the context of the modulus is built once per thread rather than for each index, and the index is used as a
+   // polynomial word without conversion to NTL
+   if (PolynomialWordModulus::fits(modulus))
+      return PolynomialWordModulus::cached(modulus).expansion(PolynomialWord(index));
+   return Vm(PolynomialFromInt(index),modulus);
+}
 
 } // namespace
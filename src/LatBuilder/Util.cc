@@ -15,10 +15,15 @@
 // limitations under the License.
 
 #include "latbuilder/Util.h"
+#include "latbuilder/MappedTable.h"
+#include "latbuilder/PolynomialWord.h"
 #include "netbuilder/Helpers/Path.h"
 #include <cmath>
 #include <cstdlib>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <boost/filesystem.hpp>
 
 #include <NTL/ZZ.h>
@@ -30,32 +35,29 @@ namespace LatBuilder
 Polynomial PolynomialFromInt(uInteger x)
 {
    Polynomial P;
-   P.SetLength(LENGTH_UINTEGER); 
-   uInteger y=x;
-   long i=0;
-    do{
-       P[i++] = y%2;
-   } while(y >>= 1);
-    
-    P.normalize();
-    return P;
+   fromPolynomialWord(P, x);
+   return P;
 }
 
 //================================================================================
 
 uInteger IndexOfPolynomial(Polynomial P)
 {
-   uInteger x=0;
-   uInteger q=1;
-   
-   for (int i = 0; i <= deg(P); i++)
-    { 
-        if(IsOne(coeff(P,i))){
-            x+= q;
-       }
-       q <<= 1;
-    }
-    return x;
+   // the coefficients of degree 64 and more do not fit in the integer
+   return toPolynomialWord(P);
+}
+
+//================================================================================
+
+Polynomial modularPow(const Polynomial& base, uInteger exponent, const Polynomial& modulus)
+{
+   if (PolynomialWordModulus::fits(modulus)) {
+      const PolynomialWordModulus& wordModulus = PolynomialWordModulus::cached(modulus);
+      Polynomial result;
+      fromPolynomialWord(result, wordModulus.power(toPolynomialWord(base % modulus), exponent));
+      return result;
+   }
+   return modularPow<Polynomial>(base, exponent, modulus);
 }
 
 
@@ -130,6 +132,8 @@ uInteger Vm(const Polynomial& h, const Polynomial& P)
 {
    
    long m = deg(P);
+   if (PolynomialWordModulus::fits(P))
+      return PolynomialWordModulus::cached(P).expansion(toPolynomialWord(h));
    NTL::vector<NTL::GF2> w;
    w.resize(m);
    uInteger res = 0;
@@ -182,32 +186,67 @@ inline std::string& trim(std::string& s, const char* t = ws)
       return ltrim(rtrim(s, t), t);
 }    
 
+namespace {
+   /**
+    * Returns the lines of the table of default polynomials, which is mapped
+    * from its binary table if it was generated and read from the CSV file
+    * otherwise, only once per process (and again only if the data folder
+    * changes).  The table is never modified once built, so that it can be
+    * used by concurrent tasks while another one loads the table of a new data
+    * folder.
+    */
+   std::shared_ptr<const std::vector<std::string>> defaultPolynomialTable()
+   {
+      static std::mutex mutex;
+      static std::string tablePath;
+      static std::shared_ptr<const std::vector<std::string>> cached;
+
+      std::string path = NetBuilder::GET_PATH_TO_LATNETBUILDER_DIR() + "/../share/latnetbuilder/data/default_polys";
+      std::lock_guard<std::mutex> lock(mutex);
+      if (cached && path == tablePath){
+         return cached;
+      }
+
+      auto table = std::make_shared<std::vector<std::string>>();
+      auto mapped = MappedTable::open(path + ".bin");
+      if (mapped){
+         for (size_t i = 0; i < mapped->size(); i++){
+            table->push_back(mapped->rowSize(i) > 0 ? std::to_string(mapped->row(i)[0]) : "");
+         }
+      }
+      else {
+         if (!boost::filesystem::exists(path + ".csv")){
+            throw std::runtime_error("Unable to locate data folder. The value of PATH_TO_LATNETBUILDER_DIR is probably incorrect. See netbuilder/Path.h.");
+         }
+
+         std::ifstream file(path + ".csv");
+         std::string sent;
+         do
+         {
+         getline(file,sent);
+         trim(sent);
+         }
+         while (sent != "###");
+
+         getline(file,sent);
+
+         while (getline(file,sent))
+         {
+            table->push_back(sent);
+         }
+      }
+      tablePath = path;
+      cached = std::move(table);
+      return cached;
+   }
+}
+
 std::string getDefaultPolynomial(unsigned int degree)
 {
     if (degree <= 32)
     {
-        std::string path = NetBuilder::PATH_TO_LATNETBUILDER_DIR + "/../share/latnetbuilder/data/default_polys.csv";
-        if (boost::filesystem::exists(path)){
-            std::ifstream file(path);
-            std::string sent;
-            do
-            {
-            getline(file,sent);
-            trim(sent);
-            }
-            while (sent != "###");
-        
-            getline(file,sent);
-
-            for(unsigned int d = 0; d <= degree; ++d)
-            {
-                getline(file,sent);
-            }
-            return sent;
-        }
-        else{
-            throw std::runtime_error("Unable to locate data folder. The value of PATH_TO_LATNETBUILDER_DIR is probably incorrect. See netbuilder/Path.h.");
-        }
+        const auto table = defaultPolynomialTable();
+        return degree < table->size() ? (*table)[degree] : "";
     }
     return "";
 }
@@ -0,0 +1,60 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/WeightedProjections.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace LatBuilder
+{
+
+std::atomic<Real> WeightedProjections::s_cutoff(0);
+
+//===============================================================================
+void WeightedProjections::applyCutoff(Real cutoff)
+{
+   if (!(cutoff > 0) or m_projections.empty())
+      return;
+
+   Real total = 0;
+   for (const auto& proj : m_projections)
+      total += proj.second;
+
+   // drop the smallest weights, the first projection first in case of ties
+   std::vector<size_t> order(m_projections.size());
+   std::iota(order.begin(), order.end(), 0);
+   std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b)
+         { return m_projections[a].second < m_projections[b].second; });
+
+   std::vector<bool> dropped(m_projections.size(), false);
+   Real droppedWeight = 0;
+   for (size_t i : order) {
+      droppedWeight += m_projections[i].second;
+      if (droppedWeight > cutoff * total)
+         break;
+      dropped[i] = true;
+   }
+
+   size_t n = 0;
+   for (size_t i = 0; i < m_projections.size(); i++) {
+      if (not dropped[i])
+         m_projections[n++] = std::move(m_projections[i]);
+   }
+   m_projections.resize(n);
+}
+
+}
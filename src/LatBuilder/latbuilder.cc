@@ -14,56 +14,35 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include "latbuilder/Parser/EmbeddingType.h"
+#include "latbuilder/LatBuilder.h"
 #include "latbuilder/Parser/Lattice.h"
-#include "latbuilder/Parser/CommandLine.h"   
+#include "latbuilder/Parser/PointFormat.h"
 #include "latbuilder/TextStream.h"
 #include "latbuilder/Types.h"
-
-#include "netbuilder/DigitalNet.h"
-#include "netbuilder/Types.h"
-
-#include "netbuilder/Parser/OutputStyleParser.h"
-
-#include <fstream>
-#include <chrono>
+#include "latbuilder/fftw++.h"
+#include "latbuilder/NTTConvolution.h"
+#include "latbuilder/WeightedProjections.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Distributed.h"
+#include "latbuilder/Kernel/ValueCache.h"
+#include "latbuilder/Kernel/OnTheFly.h"
+#include "latbuilder/StateMatrix.h"
+#include "latbuilder/Norm/BoundCache.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Trace.h"
+#include "latbuilder/ProgressFeed.h"
+#include "latbuilder/Budget.h"
+#include "latbuilder/Shard.h"
+#include "latbuilder/Module.h"
+#include "latbuilder/Execute.h"
+
+#include <limits>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/join.hpp>
 
 namespace LatBuilder{
 using TextStream::operator<<;
 
-static unsigned int merit_digits_displayed = 0; 
-
-template <LatticeType LR, EmbeddingType ET>
-void onLatticeSelected(const Task::Search<LR, ET>& s)
-   {
-     Dimension currentDim = s.bestLattice().dimension();
-     Dimension totalDim = s.dimension();
-      unsigned int old_precision = (unsigned int) std::cout.precision();
-      if (merit_digits_displayed){
-        std::cout.precision(merit_digits_displayed);
-      }
-      std::string lattice;
-      if (s.minObserver().totalCount() == 1){
-        lattice = " lattice";
-      }
-      else{
-        lattice = " lattices";
-      }
-      
-       std::cout << "End coordinate: " << currentDim << "/" << totalDim << " - "
-       << s.minObserver().totalCount() << lattice  << " explored (" << s.minObserver().acceptedCount() << " accepted)"
-       << " - partial merit value: " << s.bestMeritValue() << std::endl;
-     
-      if (merit_digits_displayed){
-        std::cout.precision(old_precision);
-      }
-      if (currentDim < totalDim){
-        std::cout << "Begin coordinate " << currentDim+1 << "/" << totalDim << std::endl;
-      }
-   }
-
 boost::program_options::options_description
 makeOptionsDescription()
 {
@@ -95,9 +74,12 @@ makeOptionsDescription()
    ("exploration-method,e", po::value<std::string>(),
     "(required) exploration method; possible values:\n"
     "  evaluation:<a1>,...,<as>\n"
+    "  evaluation-levels:<a1>,...,<as> (multilevel ordinary lattices, P-alpha kernels)\n"
     "  exhaustive\n"
+    "  exhaustive-DFS\n"
     "  random:<r>\n"
     "  Korobov\n"
+    "  fast-Korobov\n"
     "  random-Korobov:<r>\n"
     "  full-CBC\n"
     "  random-CBC:<r>\n"
@@ -154,9 +136,22 @@ makeOptionsDescription()
     "  low-pass:<threshold>\n"
     "where in the case of multilevel lattices, the optional parameter <levels> specifies the selected levels; possible values:\n"
     "  select[:<min-level>[:<max-level>]] (default)\n")
+   ("threads", po::value<unsigned int>()->default_value(ThreadPool::defaultNumThreads()),
+    "(optional) number of threads used to explore concurrently the lattices of exhaustive and Korobov explorations, "
+    "to evaluate concurrently the candidate generating values of CBC explorations, "
+    "to compute the per-level FFT products of fast-CBC explorations, "
+    "and to evaluate concurrently the projections of the spectral figure of merit in the other cases; "
+    "0 means the number of hardware threads (default: the value of the environment variable LATNETBUILDER_THREADS, or 1)\n")
+   ("pin-threads", po::bool_switch(),
+    "(optional) pin each thread given by --threads, except the main one, to its own processor among those the process may run on, "
+    "so that it stays on the NUMA node where it first wrote its part of the state vectors (Linux only)\n")
    ("repeat,r", po::value<unsigned int>()->default_value(1),
     "(optional) number of times the exploration must be executed\n"
    "(can be useful to obtain different results from random exploration)\n")
+   ("parallel-repeats", po::bool_switch(),
+    "(optional) execute the runs requested by --repeat concurrently on the threads given by --threads; "
+    "each run uses an independent stream of random numbers, and a summary of the merit values of the runs "
+    "is output with the result of the best run\n")
    ("verbose,v", po::value<int>()->default_value(0),
    "specify the verbosity of the program;\n"
    "ranges between 0 (default) and 3\n")
@@ -164,15 +159,91 @@ makeOptionsDescription()
     "(optional) path to the folder for the outputs of LatNeBuilder. The contents of the folder may be overwritten. If the folder does not exist, it is created. If no path is provided, no output folder is created.")
     ("output-style,O", po::value<std::string>()->default_value(""),
     "(optional) TBD")
+    ("resume", po::bool_switch(),
+    "(optional) resume a CBC exploration from the checkpoint written to the output folder after each completed coordinate "
+    "by a previous run with the same arguments; requires --output-folder\n")
+    ("shard", po::value<std::string>(),
+    "(optional) <index>/<count>: split the search into <count> independent jobs, and explore only the lattices of shard <index>, "
+    "with 0 <= <index> < <count>; the best lattice of the shard is written to shard.txt in the output folder, and the files of all "
+    "the shards are combined with latnetbuilder --merge-shards; exhaustive and Korobov explorations explore their range of the "
+    "generating values of the first varying coordinate, random explorations their share of the samples; requires --output-folder\n")
+    ("output-points", po::value<std::string>(),
+    "(optional) path to a binary file where the points of the resulting lattice are written, one point after the other, "
+    "without any header. For polynomial lattice rules with an interlacing factor larger than one, the points are those of the interlaced net.\n")
+    ("output-points-format", po::value<std::string>()->default_value("float64"),
+    "(optional) format of the coordinates written to the file given by --output-points; possible values:\n"
+    "  float64 (default): native double-precision numbers in [0,1)\n"
+    "  uint32: coordinates multiplied by 2^32 and truncated, as native 32-bit unsigned integers\n")
    ("merit-digits-displayed", po::value<unsigned int>()->default_value(0),
-    "(optional) number of significant figures to use when displaying merit values\n");
+    "(optional) number of significant figures to use when displaying merit values\n")
+   ("fftw-wisdom", po::value<std::string>(),
+    "(optional) path to a file of FFTW wisdom used by the fast CBC construction; "
+    "if the file exists, its wisdom is loaded, the FFT's are planned with FFTW_MEASURE "
+    "and the updated wisdom is saved to the file at the end of the search\n")
+   ("fast-cbc-transform", po::value<std::string>()->default_value("fft"),
+    "(optional) transform used by the fast CBC construction; possible values:\n"
+    "  fft: floating-point FFT's computed by FFTW (default)\n"
+    "  ntt: exact number-theoretic transforms of the values rounded to 44 significant bits; "
+    "slower, but the rounding errors do not grow with the number of points\n")
+   ("kernel-cache", po::value<std::string>(),
+    "(optional) path to a folder where the tables of kernel values are stored and reused by later runs "
+    "with the same kernel and size parameter; if the folder does not exist, it is created\n")
+   ("kernel-on-the-fly", po::bool_switch(),
+    "(optional) with coordinate-uniform figures of merit, ordinary lattices and flat storage, evaluate the kernel "
+    "at the permuted points of the candidates instead of gathering its values from a stored table, "
+    "which is faster when the table does not fit in cache; not for the fast-CBC explorations nor the R_alpha kernel\n")
+   ("state-folder", po::value<std::string>(),
+    "(optional) path to a folder where the state vectors of the POD weights are kept in memory-mapped temporary files, "
+    "for numbers of points whose states do not fit in memory; if the folder does not exist, it is created\n")
+   ("norm-cache", po::value<std::string>(),
+    "(optional) path to a file where the bounds computed by the normalizers of --filters are stored and reused "
+    "by later runs with the same norm, weights, size parameter and dimension\n")
+   ("weight-cutoff", po::value<Real>()->default_value(0),
+    "(optional) relative cutoff of the weights of the projection-dependent figures of merit: the projections of "
+    "smallest weights are skipped as long as the sum of their weights is at most the cutoff times the sum of all "
+    "the weights of the projections of the coordinate (for example 1e-12); 0 (default) evaluates all the projections "
+    "of nonzero weight\n")
+   ("time-budget", po::value<Real>(),
+    "(optional) maximal wall-clock time in seconds of each run of a search; the search stops when it is elapsed "
+    "and returns the best lattice found so far; CBC explorations divide the remaining time evenly between the remaining coordinates; "
+    "the runs of --parallel-repeats share the budget\n")
+   ("eval-budget", po::value<unsigned long long>(),
+    "(optional) maximal number of lattices evaluated by each run of a search; the search stops when it is reached "
+    "and returns the best lattice found so far; CBC explorations divide the remaining evaluations evenly between the remaining coordinates; "
+    "the runs of --parallel-repeats share the budget\n")
+   ("target-merit", po::value<Real>(),
+    "(optional) target merit value of the random, exhaustive, Korobov and CBC explorations; the search stops as soon as "
+    "a lattice has a merit value below the target, and CBC explorations move on to the next coordinate as soon as a "
+    "candidate has a partial merit value below the target; the target also seeds the bound of the early abortion of the "
+    "evaluations\n")
+   ("progress", po::value<std::string>(),
+    "(optional) path to a file, named pipe or file descriptor (e.g. /dev/fd/3) where the progress of the search is written "
+    "as JSON lines (coordinate, candidates visited, evaluations, best merit value so far), at most every --progress-period seconds\n")
+   ("progress-period", po::value<Real>()->default_value(0.5),
+    "(optional) minimal number of seconds between two lines written to the file given by --progress (default: 0.5)\n")
+   ("profile", po::value<std::string>(),
+    "(optional) write the timers and the counters of the phases of the search (kernel setup, candidate construction, "
+    "evaluation, FFT, number of candidates, early aborts, rank operations) to profile.<format> in the output folder "
+    "at the end of the program; possible values:\n"
+    "  json\n"
+    "  csv\n"
+    "requires --output-folder\n")
+   ("trace", po::value<std::string>(),
+    "(optional) path to a file where a timeline of the phases of the search (task setup, coordinates, FFT's, "
+    "parallel loops of each worker, output) is written at the end of the program, in the trace-event format "
+    "of Chrome (chrome://tracing, Perfetto)\n")
+   ("dry-run", po::bool_switch(),
+    "(optional) do not execute the search, but output the estimates of its peak memory by component (storage tables, "
+    "kernel values, states, FFT buffers), of its number of evaluated lattices and, for the coordinate-uniform figures of merit, "
+    "of its time on the threads given by --threads, calibrated on this machine; with --verbose 1 and above, the searches "
+    "output their actual peak memory by component\n");
 
    return desc;
 }
 
 
 boost::program_options::variables_map
-parse(int argc, const char* argv[])
+parseOptions(int argc, const char* argv[])
 {
    namespace po = boost::program_options;
 
@@ -184,7 +255,7 @@ parse(int argc, const char* argv[])
 
    if (opt.count("help")) {
       std::cout << desc << std::endl;
-      std::exit (0);
+      return opt;
    }
 
    for (const auto x : {"construction", "size-parameter", "exploration-method", "dimension", "figure-of-merit", "norm-type"}) {
@@ -199,233 +270,199 @@ parse(int argc, const char* argv[])
    if (opt.count("weights") < 1)
       throw std::runtime_error("--weights must be specified (try --help)");
 
-   return opt;
-}
-
-template <EmbeddingType ET>
-std::string helper(const SizeParam<LatticeType::ORDINARY, ET>& param);
-
-template<>
-std::string helper(const SizeParam<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>& param)
-{
-  return std::to_string(param.base()) + "  // Base\n" + std::to_string(param.maxLevel()) + "  // Maximum level\n";
-}
-
-template<>
-std::string helper(const SizeParam<LatticeType::ORDINARY, EmbeddingType::UNILEVEL>& param)
-{
-  return "0  // Base\n0  // Maximum level\n";
-}
+   if (opt["resume"].as<bool>() && opt.count("output-folder") < 1)
+      throw std::runtime_error("--resume requires --output-folder (try --help)");
+
+   if (opt["parallel-repeats"].as<bool>() && opt["resume"].as<bool>())
+      throw std::runtime_error("--parallel-repeats cannot be used with --resume (try --help)");
+
+   if (opt.count("shard") >= 1) {
+      if (opt.count("output-folder") < 1)
+         throw std::runtime_error("--shard requires --output-folder (try --help)");
+      const auto method = opt["exploration-method"].as<std::string>();
+      const auto name = method.substr(0, method.find(':'));
+      if (name != "exhaustive" && name != "Korobov" && name != "fast-Korobov" && name != "random" && name != "random-Korobov")
+         throw std::runtime_error("--shard requires an exhaustive, Korobov, fast-Korobov, random or random-Korobov exploration (try --help)");
+      if (opt["repeat"].as<unsigned int>() > 1 || opt["parallel-repeats"].as<bool>() || opt["resume"].as<bool>())
+         throw std::runtime_error("--shard cannot be used with --repeat, --parallel-repeats or --resume (try --help)");
+   }
 
+   const auto transform = opt["fast-cbc-transform"].as<std::string>();
+   if (transform != "fft" && transform != "ntt")
+      throw std::runtime_error("--fast-cbc-transform must be fft or ntt (try --help)");
 
-template <EmbeddingType ET>
-std::string helper2(const SizeParam<LatticeType::ORDINARY, ET>& param);
+   const auto weightCutoff = opt["weight-cutoff"].as<Real>();
+   if (!(weightCutoff >= 0 && weightCutoff < 1))
+      throw std::runtime_error("--weight-cutoff must be in [0, 1) (try --help)");
 
-template<>
-std::string helper2(const SizeParam<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL>& param)
-{
-  return ", embedded from " + std::to_string(param.base()) + " to " + std::to_string(param.maxLevel()) + "\n";
-}
+   if (opt.count("time-budget") >= 1 && !(opt["time-budget"].as<Real>() > 0))
+      throw std::runtime_error("--time-budget must be positive (try --help)");
 
-template<>
-std::string helper2(const SizeParam<LatticeType::ORDINARY, EmbeddingType::UNILEVEL>& param)
-{
-  return "\n";
-}
+   if (opt.count("eval-budget") >= 1 && opt["eval-budget"].as<unsigned long long>() == 0)
+      throw std::runtime_error("--eval-budget must be positive (try --help)");
 
+   if (opt.count("target-merit") >= 1 && std::isnan(opt["target-merit"].as<Real>()))
+      throw std::runtime_error("--target-merit must be a number (try --help)");
 
+   if (!(opt["progress-period"].as<Real>() > 0))
+      throw std::runtime_error("--progress-period must be positive (try --help)");
 
-template <EmbeddingType ET>
-void executeOrdinary(const Parser::CommandLine<LatticeType::ORDINARY, ET>& cmd, int verbose, unsigned int repeat, std::string outputFolder)
-{
-   const LatticeType LR = LatticeType::ORDINARY ;
-   using namespace std::chrono;
-
-   auto search = cmd.parse();
-
-   const std::string separator = "====================\n";
-  
-   std::cout << separator << "    Input" << std::endl << separator << *search << std::endl;
-    if (outputFolder != ""){
-      std::ofstream outFile;
-      std::string fileName = outputFolder + "/input.txt";
-      outFile.open(fileName);
-      outFile << "Input Command Line: " << cmd.originalCommandLine << std::endl << std::endl;
-      outFile << *search; 
-      outFile.close();
-    }
-
-   if (verbose > 0) {
-      search->onLatticeSelected().connect(onLatticeSelected<LR,ET>);
-      search->setObserverVerbosity(verbose-1);
-      search->setVerbose(verbose-2);
+   if (opt.count("profile") >= 1) {
+      if (opt.count("output-folder") < 1)
+         throw std::runtime_error("--profile requires --output-folder (try --help)");
+      const auto format = opt["profile"].as<std::string>();
+      if (format != "json" && format != "csv")
+         throw std::runtime_error("--profile must be json or csv (try --help)");
    }
 
-   for (unsigned int i = 0; i < repeat; i++) {
-        if (repeat > 1){
-          std::cout << separator << "      Run " << i+1 << std::endl << separator;
-        }
-        else{
-          std::cout << separator << "Running the task..." << std::endl << separator;
-        }
-
-      auto t0 = high_resolution_clock::now();
-      search->execute();
-      auto t1 = high_resolution_clock::now();
-
-      unsigned int old_precision = (unsigned int) std::cout.precision();
-      if (merit_digits_displayed)
-   std::cout.precision(merit_digits_displayed);
-     const auto lat = search->bestLattice();
-     
-   auto dt = duration_cast<duration<double>>(t1 - t0);
-         std::cout << std::endl;
-         std::cout << separator << "      Result" << std::endl << separator;
-        std::cout << lat;
-        std::cout << "Merit: " << search->bestMeritValue() << std::endl;
-        std::cout << std::endl;
-         std::cout << "ELAPSED CPU TIME: " << dt.count() << " seconds" << std::endl << std::endl;
-
-      if (outputFolder != ""){
-        std::ofstream outFile;
-        std::string fileName = outputFolder + "/output.txt";
-        outFile.open(fileName);
-        outFile << "# Input Command Line: " << cmd.originalCommandLine << std::endl;
-        outFile << "# Merit: " << search->bestMeritValue() << std::endl;
-        outFile << "# Parameters for a lattice rule";
-        outFile << helper2<ET>(lat.sizeParam());
-        outFile << lat.dimension() <<"    # s = "<< lat.dimension() << " dimensions\n";
-        outFile << lat.sizeParam().numPoints() <<"    # modulus = n = "<< lat.sizeParam().numPoints() << " points\n";
-        auto vec = lat.gen();
-        outFile << "# Coordinates of generating vector, starting at j=1" << std::endl;
-        for (unsigned int coord = 0; coord < vec.size(); coord++){
-          if (coord < vec.size() - 1){
-            outFile << vec[coord] << std::endl;
-          }
-          else{
-            outFile << vec[coord];
-          }
-        }
-        outFile.close();
-      }
-      
-      if (merit_digits_displayed)
-   std::cout.precision(old_precision);
-
-      search->reset();
-    }
+   return opt;
 }
 
-
-template <EmbeddingType ET>
-void executePolynomial(const Parser::CommandLine<LatticeType::POLYNOMIAL, ET>& cmd, int verbose, unsigned int repeat, std::string outputFolder, NetBuilder::OutputStyle outputStyle)
+template <LatticeType LR>
+Parser::CommandLine<LR, EmbeddingType::MULTILEVEL> makeCommandLine(const boost::program_options::variables_map& opt, const std::string& originalCommandLine)
 {
-   const LatticeType LR = LatticeType::POLYNOMIAL ;
-   using namespace std::chrono;
-
-   auto search = cmd.parse();
-   
-   unsigned int interlacingFactor = 1;
-    try{
-      interlacingFactor = boost::lexical_cast<unsigned int>(cmd.interlacingFactor);
-    }
-    catch (boost::bad_lexical_cast&) {}
-
-   const std::string separator = "====================\n";
-  
-   std::cout << separator << "    Input" << std::endl << separator << *search << std::endl;
-    if (outputFolder != ""){
-      std::ofstream outFile;
-      std::string fileName = outputFolder + "/input.txt";
-      outFile.open(fileName);
-      outFile << "Input Command Line: " << cmd.originalCommandLine << std::endl << std::endl;
-      outFile << *search;
-      outFile.close();
-    }
-
-   if (verbose > 0) {
-      search->onLatticeSelected().connect(onLatticeSelected<LR,ET>);
-      search->setObserverVerbosity(verbose-1);
-      search->setVerbose(verbose-2);
+   Parser::CommandLine<LR, EmbeddingType::MULTILEVEL> cmd;
+
+   cmd.originalCommandLine = originalCommandLine;
+   cmd.construction  = opt["exploration-method"].as<std::string>();
+   cmd.size          = opt["size-parameter"].as<std::string>();
+   cmd.dimension     = opt["dimension"].as<std::string>();
+   cmd.normType      = opt["norm-type"].as<std::string>();
+   cmd.figure        = opt["figure-of-merit"].as<std::string>();
+   cmd.weights       = opt["weights"].as<std::vector<std::string>>();
+
+   if (opt.count("combiner") == 1){
+     cmd.combiner      = opt["combiner"].as<std::string>();
+   }
+   else{
+     cmd.combiner = "level:max";
    }
 
-   for (unsigned int i = 0; i < repeat; i++) {
-        if (repeat > 1){
-          std::cout << separator << "      Run " << i+1 << std::endl << separator;
-        }
-        else{
-          std::cout << separator << "Running the task..." << std::endl << separator;
-        }
-
-        auto t0 = high_resolution_clock::now();
-        search->execute();
-        auto t1 = high_resolution_clock::now();
-
-        unsigned int old_precision = (unsigned int) std::cout.precision();
-        if (merit_digits_displayed){
-          std::cout.precision(merit_digits_displayed);
-        }
-       const auto lat = search->bestLattice();
-      
-        auto dt = duration_cast<duration<double>>(t1 - t0);
-           std::cout << std::endl;
-           std::cout << separator << "    Result" << std::endl << separator;
-           std::cout << lat;
-           std::cout << "Merit: " << search->bestMeritValue() << std::endl;
-           std::cout << std::endl;
-           std::cout << "ELAPSED CPU TIME: " << dt.count() << " seconds" << std::endl << std::endl;
-
-      if (outputFolder != ""){
-          NetBuilder::DigitalNet<NetBuilder::NetConstruction::POLYNOMIAL> net((unsigned int) lat.gen().size(), lat.sizeParam().modulus(),lat.gen());
-          
-          if (outputStyle != NetBuilder::OutputStyle::TERMINAL){
-            std::ofstream outFile;
-            std::string fileName = outputFolder + "/output.txt";
-            outFile.open(fileName);
-            outFile << "# Input Command Line: " << cmd.originalCommandLine << std::endl;
-            outFile << "# Merit: " << search->bestMeritValue() << std::endl;
-            outFile << net.format(outputStyle, interlacingFactor) ;
-            outFile.close();
-          }
+   if (LR == LatticeType::ORDINARY && opt["interlacing-factor"].as<std::string>() != "1")
+   {
+     throw std::runtime_error("Interlacing can only be used with polynomial lattice rules.");
+   }
+   cmd.interlacingFactor = opt["interlacing-factor"].as<std::string>();
+
+   cmd.weightsPowerScale = 1.0;
+   if (opt.count("weights-power") >= 1) {
+      // assume 1.0 if norm-type is `inf' or anything else
+      cmd.weightsPowerScale = 1.0;
+      try {
+         // start the value of norm-type as a default
+         if (cmd.normType != "inf")
+            cmd.weightsPowerScale = boost::lexical_cast<Real>(cmd.normType);
       }
+      catch (boost::bad_lexical_cast&) {}
+      // then scale down according to interpretation of input
+      cmd.weightsPowerScale /= opt["weights-power"].as<Real>();
+   }
 
-        
-        if (merit_digits_displayed){
-          std::cout.precision(old_precision);
-        }
-          
-        search->reset();
-    }
+   if (opt.count("filters") >= 1)
+      cmd.filters = opt["filters"].as<std::vector<std::string>>();
+
+   return cmd;
 }
 
-   
- 
+template Parser::CommandLine<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL> makeCommandLine<LatticeType::ORDINARY>(const boost::program_options::variables_map&, const std::string&);
+template Parser::CommandLine<LatticeType::POLYNOMIAL, EmbeddingType::MULTILEVEL> makeCommandLine<LatticeType::POLYNOMIAL>(const boost::program_options::variables_map&, const std::string&);
 
 
+void applySettings(const boost::program_options::variables_map& opt)
+{
+   const auto value = [&opt](const char* name) { return opt.count(name) >= 1 ? opt[name].as<std::string>() : std::string(); };
+
+   ThreadPool::setPinning(opt["pin-threads"].as<bool>());
+   ThreadPool::setGlobalSize(opt["threads"].as<unsigned int>());
+
+   Kernel::ValueCache::setDirectory(value("kernel-cache"));
+   Kernel::OnTheFly::setEnabled(opt["kernel-on-the-fly"].as<bool>());
+   StateMatrix::setDirectory(value("state-folder"));
+   Norm::BoundCache::setFile(value("norm-cache"));
+
+   Budget::clear();
+   if (opt.count("time-budget") >= 1 || opt.count("eval-budget") >= 1)
+      Budget::set(
+            opt.count("time-budget") >= 1 ? opt["time-budget"].as<Real>() : std::numeric_limits<Real>::infinity(),
+            opt.count("eval-budget") >= 1 ? opt["eval-budget"].as<unsigned long long>() : 0);
+   if (opt.count("target-merit") >= 1)
+      Budget::setTarget(opt["target-merit"].as<Real>());
+
+   // the plans are measured only when their wisdom is saved
+   fftw<Real>::set_planner_flags(opt.count("fftw-wisdom") >= 1 ? FFTW_MEASURE : FFTW_ESTIMATE);
+   NTTConvolution::setEnabled(opt["fast-cbc-transform"].as<std::string>() == "ntt");
+   WeightedProjections::setCutoff(opt["weight-cutoff"].as<Real>());
+
+   Shard::clear();
+   if (opt.count("shard") >= 1)
+      Shard::parse(opt["shard"].as<std::string>());
+}
 
 
-int main(int argc, const char *argv[])
+/// Runs the command and lets the exceptions propagate.
+int run(int argc, const char *argv[])
 {
+        auto opt = parseOptions(argc, argv);
+        if (opt.count("help"))
+          return 0;
 
-   try {
-        auto opt = parse(argc, argv);
+        ExecuteOptions options;
 
         // bool quiet = opt.count("quiet");
-        int verbose = opt["verbose"].as<int>();
+        options.verbose = opt["verbose"].as<int>();
         
-        auto repeat = opt["repeat"].as<unsigned int>();
+        options.repeat = opt["repeat"].as<unsigned int>();
 
         std::string outputFolder = "";
         if (opt.count("output-folder") >= 1){
           outputFolder = opt["output-folder"].as<std::string>();
           std::cout << "Writing in output folder: " << outputFolder << std::endl;
-          boost::filesystem::create_directories(outputFolder);
+          if (Distributed::isRoot())
+            boost::filesystem::create_directories(outputFolder);
         }        
+        options.outputFolder = outputFolder;
+
+        options.meritDigitsDisplayed = opt["merit-digits-displayed"].as<unsigned int>();
+
+        options.outputStyle = opt["output-style"].as<std::string>();
+
+        if (opt.count("output-points") >= 1)
+          options.outputPoints = opt["output-points"].as<std::string>();
+        options.pointFormat = Parser::PointFormat::parse(opt["output-points-format"].as<std::string>());
 
-        // global variable
-        merit_digits_displayed = opt["merit-digits-displayed"].as<unsigned int>();
+        options.resume = opt["resume"].as<bool>();
 
-        std::string outputstyle = opt["output-style"].as<std::string>();
+        options.dryRun = opt["dry-run"].as<bool>();
+
+        options.parallelRepeats = opt["parallel-repeats"].as<bool>();
+        if (options.parallelRepeats && Distributed::size() > 1)
+          throw std::runtime_error("--parallel-repeats cannot be used in an MPI job");
+
+        applySettings(opt);
+
+        std::string profileFile = "";
+        if (opt.count("profile") >= 1)
+          profileFile = outputFolder + "/profile." + opt["profile"].as<std::string>();
+        Profiler::reset();
+        Profiler::setEnabled(profileFile != "");
+
+        // in an MPI job, only the root process writes the trace
+        const std::string traceFile = opt.count("trace") >= 1 && Distributed::isRoot() ? opt["trace"].as<std::string>() : "";
+        if (traceFile != ""){
+          Trace::setThreadName("main");
+          Trace::start();
+        }
+
+        std::string fftwWisdom;
+        if (opt.count("fftw-wisdom") >= 1){
+          fftwWisdom = opt["fftw-wisdom"].as<std::string>();
+          if (boost::filesystem::exists(fftwWisdom) && !fftw<Real>::import_wisdom(fftwWisdom))
+            throw std::runtime_error("cannot read FFTW wisdom from " + fftwWisdom);
+        }
+
+        // in an MPI job, only the root process writes the progress
+        ProgressFeed::Session progress(opt.count("progress") >= 1 && Distributed::isRoot() ? opt["progress"].as<std::string>() : "",
+              opt["progress-period"].as<Real>());
 
        LatBuilder::LatticeType lattice = Parser::LatticeParser::parse(opt["construction"].as<std::string>());
 
@@ -433,116 +470,38 @@ int main(int argc, const char *argv[])
        if (argc > 1) {
           all_args.assign(argv + 1, argv + argc);
         }
+       options.originalCommandLine = boost::algorithm::join(all_args, " ");
 
+       // the searches of each lattice type are executed by its module
        if(lattice == LatticeType::ORDINARY){
-
-            Parser::CommandLine<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL> cmd;
-
-            
-            cmd.originalCommandLine = boost::algorithm::join(all_args, " ");
-            cmd.construction  = opt["exploration-method"].as<std::string>();
-            cmd.size          = opt["size-parameter"].as<std::string>();
-            cmd.dimension     = opt["dimension"].as<std::string>();
-            cmd.normType      = opt["norm-type"].as<std::string>();
-            cmd.figure        = opt["figure-of-merit"].as<std::string>();
-            cmd.weights       = opt["weights"].as<std::vector<std::string>>();
-
-            if (opt.count("combiner") == 1){
-              cmd.combiner      = opt["combiner"].as<std::string>();
-            }
-            else{
-              cmd.combiner = "level:max";
-            }
-
-            if (opt["interlacing-factor"].as<std::string>() != "1")
-            {
-              throw std::runtime_error("Interlacing can only be used with polynomial lattice rules.");
-            }
-            else
-            {
-              cmd.interlacingFactor = "1";
-            }
-
-            cmd.weightsPowerScale = 1.0;
-            if (opt.count("weights-power") >= 1) {
-               // assume 1.0 if norm-type is `inf' or anything else
-               cmd.weightsPowerScale = 1.0;
-               try {
-                  // start the value of norm-type as a default
-                  if (cmd.normType != "inf")
-                     cmd.weightsPowerScale = boost::lexical_cast<Real>(cmd.normType);
-               }
-               catch (boost::bad_lexical_cast&) {}
-               // then scale down according to interpretation of input
-               cmd.weightsPowerScale /= opt["weights-power"].as<Real>();
-            }
-
-            if (opt.count("filters") >= 1)
-               cmd.filters = opt["filters"].as<std::vector<std::string>>();
-
-            EmbeddingType latType = Parser::EmbeddingType::parse(opt["multilevel"].as<std::string>());
-
-            if (latType == EmbeddingType::UNILEVEL){
-               executeOrdinary<EmbeddingType::UNILEVEL> (cmd, verbose, repeat, outputFolder);
-               
-             }
-            else{
-               executeOrdinary<EmbeddingType::MULTILEVEL> (cmd, verbose, repeat, outputFolder);
-               
-             }
+          LATNETBUILDER_MODULE_ENTRY("lattice-ordinary", latbuilder_execute_ordinary)(opt, options);
+       }
+       else if(lattice == LatticeType::POLYNOMIAL){
+          LATNETBUILDER_MODULE_ENTRY("lattice-polynomial", latbuilder_execute_polynomial)(opt, options);
+       }
+
+      if (!fftwWisdom.empty() && !fftw<Real>::export_wisdom(fftwWisdom)){
+        std::cerr << "WARNING: cannot write FFTW wisdom to " << fftwWisdom << std::endl;
       }
 
-      else if(lattice == LatticeType::POLYNOMIAL){
-
-            Parser::CommandLine<LatticeType::POLYNOMIAL, EmbeddingType::MULTILEVEL> cmd;
-
-            
-            cmd.originalCommandLine = boost::algorithm::join(all_args, " ");
-            cmd.construction  = opt["exploration-method"].as<std::string>();
-            cmd.size          = opt["size-parameter"].as<std::string>();
-            cmd.dimension     = opt["dimension"].as<std::string>();
-            cmd.normType      = opt["norm-type"].as<std::string>();
-            cmd.figure        = opt["figure-of-merit"].as<std::string>();
-            cmd.weights       = opt["weights"].as<std::vector<std::string>>();
-            cmd.interlacingFactor = opt["interlacing-factor"].as<std::string>();
-            if (opt.count("combiner") == 1){
-              cmd.combiner      = opt["combiner"].as<std::string>();
-            }
-            else{
-              cmd.combiner = "level:max";
-            }
-
-            cmd.weightsPowerScale = 1.0;
-            if (opt.count("weights-power") >= 1) {
-               // assume 1.0 if norm-type is `inf' or anything else
-               cmd.weightsPowerScale = 1.0;
-               try {
-                  // start the value of norm-type as a default
-                  if (cmd.normType != "inf")
-                     cmd.weightsPowerScale = boost::lexical_cast<Real>(cmd.normType);
-               }
-               catch (boost::bad_lexical_cast&) {}
-               // then scale down according to interpretation of input
-               cmd.weightsPowerScale /= opt["weights-power"].as<Real>();
-            }
-
-            if (opt.count("filters") >= 1)
-               cmd.filters = opt["filters"].as<std::vector<std::string>>();
-
-            EmbeddingType latType = Parser::EmbeddingType::parse(opt["multilevel"].as<std::string>());
-
-            NetBuilder::OutputStyle outputStyle = NetBuilder::Parser::OutputStyleParser<NetBuilder::NetConstruction::POLYNOMIAL>::parse(outputstyle);
-
-
-            if (latType == EmbeddingType::UNILEVEL){
-              executePolynomial< EmbeddingType::UNILEVEL> (cmd, verbose, repeat, outputFolder, outputStyle);
-               
-             }
-            else{
-              executePolynomial<EmbeddingType::MULTILEVEL> (cmd, verbose, repeat, outputFolder, outputStyle);
-               
-             }
+      Profiler::setEnabled(false);
+      if (profileFile != "" && Distributed::isRoot()){
+        Profiler::write(profileFile);
+        std::cout << "Profile written to: " << profileFile << std::endl;
       }
+      if (traceFile != ""){
+        Trace::stop();
+        Trace::write(traceFile);
+        std::cout << "Trace written to: " << traceFile << std::endl;
+      }
+
+   return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+   try {
+      return run(argc, argv);
    }
    catch (Parser::ParserError& e) {
       std::cerr << "COMMAND LINE ERROR: " << e.what() << std::endl;
@@ -0,0 +1,246 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/FigureOfMerit/TValueComputation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <random>
+
+namespace NetBuilder {
+
+namespace {
+
+/**
+ * Computes the work of GaussMethod (\c rows) and of SchmidMethod (\c combinations) for the compositions of at most \c maxRows rows 
+ * in \c s parts.
+ */ 
+void estimateWork(unsigned int s, unsigned int maxRows, double& rows, double& combinations)
+{
+    rows = 0;
+    combinations = 0;
+    double numCompositions = 1; // number of compositions of k in s parts
+    for(unsigned int k = s; k <= maxRows; ++k)
+    {
+        rows += numCompositions * k;
+        combinations += numCompositions * std::ldexp(1.0, (int) k);
+        numCompositions = numCompositions * k / (k - s + 1);
+    }
+}
+
+/**
+ * Returns the work of DualMethod for a projection of cardinal \c s of matrices with \c m columns: the number of coordinates of its points.
+ */ 
+double dualWork(unsigned int s, unsigned int m)
+{
+    return std::ldexp((double) s, (int) m);
+}
+
+/**
+ * Returns a projection of cardinal \c s of random generating matrices with \c m rows and columns.
+ */ 
+std::vector<GeneratingMatrix> randomProjection(std::mt19937_64& generator, unsigned int s, unsigned int m)
+{
+    std::vector<GeneratingMatrix> matrices;
+    for(unsigned int coord = 0; coord < s; ++coord)
+    {
+        GeneratingMatrix matrix(m, m);
+        for(unsigned int i = 0; i < m; ++i)
+        {
+            matrix.setPackedRow(i, generator());
+        }
+        matrices.push_back(std::move(matrix));
+    }
+    return matrices;
+}
+
+/**
+ * Returns the smallest average time, over a few trials, of the t-value computations of the projections \c projections 
+ * with the method \c METHOD.
+ */ 
+template <typename METHOD>
+double timeTValues(const std::vector<std::vector<GeneratingMatrix>>& projections)
+{
+    constexpr unsigned int numTrials = 3;
+    double best = std::numeric_limits<double>::infinity();
+    volatile unsigned int sink = 0; // keeps the computations from being optimized away
+    for(unsigned int trial = 0; trial < numTrials; ++trial)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for(const auto& projection : projections)
+        {
+            sink = sink + METHOD::computeTValue(projection, 0, 0);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / (double) projections.size());
+    }
+    return best;
+}
+
+/// Unit of work of a method.
+enum class Work { ROWS, COMBINATIONS, COORDINATES };
+
+/**
+ * Fits the fixed cost and the cost per unit of work of the method \c METHOD on a small and a large family of random projections.
+ */ 
+template <typename METHOD>
+void calibrateMethod(Work work, double& fixedCost, double& unitCost)
+{
+    constexpr unsigned int numProjections = 8;
+    const unsigned int sizes[2][2] = {{2, 4}, {3, 12}}; // cardinals and numbers of columns of the small and large projections
+    std::mt19937_64 generator(0);
+    double times[2];
+    double works[2];
+    for(unsigned int i = 0; i < 2; ++i)
+    {
+        std::vector<std::vector<GeneratingMatrix>> projections;
+        for(unsigned int p = 0; p < numProjections; ++p)
+        {
+            projections.push_back(randomProjection(generator, sizes[i][0], sizes[i][1]));
+        }
+        double rows, combinations;
+        estimateWork(sizes[i][0], sizes[i][1], rows, combinations);
+        works[i] = (work == Work::ROWS) ? rows : (work == Work::COMBINATIONS) ? combinations : dualWork(sizes[i][0], sizes[i][1]);
+        times[i] = timeTValues<METHOD>(projections);
+    }
+    unitCost = std::max((times[1] - times[0]) / (works[1] - works[0]), 1e-12);
+    fixedCost = std::max(times[0] - unitCost * works[0], 0.0);
+}
+
+AutoMethod::Profile calibrate()
+{
+    AutoMethod::Profile profile;
+    calibrateMethod<GaussMethod>(Work::ROWS, profile.gaussFixed, profile.gaussPerRow);
+    calibrateMethod<SchmidMethod>(Work::COMBINATIONS, profile.schmidFixed, profile.schmidPerCombination);
+    calibrateMethod<DualMethod>(Work::COORDINATES, profile.dualFixed, profile.dualPerCoordinate);
+    return profile;
+}
+
+AutoMethod::Profile s_profile;
+std::atomic<bool> s_hasProfile(false);
+std::once_flag s_calibration;
+
+}
+
+AutoMethod::Profile AutoMethod::profile()
+{
+    if (!s_hasProfile.load(std::memory_order_acquire))
+    {
+        std::call_once(s_calibration, []()
+            {
+                s_profile = calibrate();
+                s_hasProfile.store(true, std::memory_order_release);
+            });
+    }
+    return s_profile;
+}
+
+void AutoMethod::setProfile(const Profile& profile)
+{
+    s_profile = profile;
+    s_hasProfile.store(true, std::memory_order_release);
+}
+
+bool AutoMethod::prefersSchmid(unsigned int s, unsigned int m, unsigned int maxTValuesSubProj)
+{
+    // the word-packed rows of SchmidMethod are those of the calibration
+    if (s < 2 || m > GeneratingMatrix::maxPackedCols || m < s + maxTValuesSubProj)
+    {
+        return false;
+    }
+    double rows, combinations;
+    estimateWork(s, m - maxTValuesSubProj, rows, combinations);
+    const Profile costs = profile();
+    return costs.schmidFixed + costs.schmidPerCombination * combinations < costs.gaussFixed + costs.gaussPerRow * rows;
+}
+
+bool AutoMethod::prefersDual(unsigned int s, unsigned int m, unsigned int maxTValuesSubProj)
+{
+    if (s < 2 || !DualMethod::fits(s, m))
+    {
+        return false;
+    }
+    if (m < s + maxTValuesSubProj)
+    {
+        return false; // the t-value is known without examining any composition
+    }
+    double rows, combinations;
+    estimateWork(s, m - maxTValuesSubProj, rows, combinations);
+    const Profile costs = profile();
+    const double dualCost = costs.dualFixed + costs.dualPerCoordinate * dualWork(s, m);
+    const double gaussCost = costs.gaussFixed + costs.gaussPerRow * rows;
+    const double schmidCost = costs.schmidFixed + costs.schmidPerCombination * combinations;
+    return dualCost < std::min(gaussCost, schmidCost);
+}
+
+unsigned int AutoMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, int verbose)
+{
+    if (prefersDual((unsigned int) baseMatrices.size(), baseMatrices[0].nCols(), maxTValuesSubProj))
+    {
+        return DualMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    if (prefersSchmid((unsigned int) baseMatrices.size(), baseMatrices[0].nCols(), maxTValuesSubProj))
+    {
+        return SchmidMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    return GaussMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+}
+
+unsigned int AutoMethod::computeBoundedTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, unsigned int cutoff, int verbose)
+{
+    if (prefersDual((unsigned int) baseMatrices.size(), baseMatrices[0].nCols(), maxTValuesSubProj))
+    {
+        return DualMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    if (prefersSchmid((unsigned int) baseMatrices.size(), baseMatrices[0].nCols(), maxTValuesSubProj))
+    {
+        return SchmidMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    return GaussMethod::computeBoundedTValue(std::move(baseMatrices), maxTValuesSubProj, cutoff, verbose);
+}
+
+std::vector<unsigned int> AutoMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose)
+{
+    if (prefersDual((unsigned int) baseMatrices.size(), baseMatrices[0].nCols(), maxTValuesSubProj.back()))
+    {
+        return DualMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    if (prefersSchmid((unsigned int) baseMatrices.size(), baseMatrices[0].nCols(), maxTValuesSubProj.back()))
+    {
+        return SchmidMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    return GaussMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+}
+
+std::vector<unsigned int> AutoMethod::computeBoundedTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj,
+                                                           const std::vector<unsigned int>& cutoffs, int verbose)
+{
+    if (prefersDual((unsigned int) baseMatrices.size(), baseMatrices[0].nCols(), maxTValuesSubProj.back()))
+    {
+        return DualMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    if (prefersSchmid((unsigned int) baseMatrices.size(), baseMatrices[0].nCols(), maxTValuesSubProj.back()))
+    {
+        return SchmidMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    return GaussMethod::computeBoundedTValue(std::move(baseMatrices), maxTValuesSubProj, cutoffs, verbose);
+}
+
+}
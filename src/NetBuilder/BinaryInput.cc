@@ -0,0 +1,147 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/BinaryInput.h"
+#include "netbuilder/BinaryOutput.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace NetBuilder {
+
+namespace {
+
+    const char magic[4] = {'L', 'N', 'B', 'N'};
+
+    // size of the header before the command line
+    constexpr size_t fixedHeaderSize = 48;
+
+    uint32_t readWord(const unsigned char* data)
+    {
+        return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+    }
+
+    double readDouble(const unsigned char* data)
+    {
+        const uint64_t bits = (uint64_t) readWord(data) | ((uint64_t) readWord(data + 4) << 32);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+bool BinaryInput::isBinary(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    char head[sizeof(magic)];
+    return file.read(head, sizeof(head)) && std::memcmp(head, magic, sizeof(magic)) == 0;
+}
+
+BinaryInput::BinaryInput(const std::string& fileName)
+{
+    namespace bip = boost::interprocess;
+
+    if (!boost::filesystem::exists(fileName))
+    {
+        throw std::runtime_error("the binary net file " + fileName + " does not exist");
+    }
+    try
+    {
+        m_file = bip::file_mapping(fileName.c_str(), bip::read_only);
+        m_region = bip::mapped_region(m_file, bip::read_only);
+    }
+    catch (bip::interprocess_exception& e)
+    {
+        throw std::runtime_error("cannot map the binary net file " + fileName + ": " + e.what());
+    }
+
+    const unsigned char* data = static_cast<const unsigned char*>(m_region.get_address());
+    const size_t size = m_region.get_size();
+    if (size < fixedHeaderSize || std::memcmp(data, magic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error(fileName + " is not a binary net file");
+    }
+    if (readWord(data + 4) != BinaryOutput::version)
+    {
+        throw std::runtime_error("unknown version " + std::to_string(readWord(data + 4)) + " of the binary net file " + fileName);
+    }
+    m_dimension = readWord(data + 8);
+    m_interlacingFactor = readWord(data + 12);
+    m_nRows = readWord(data + 16);
+    m_nCols = readWord(data + 20);
+    m_wordsPerColumn = readWord(data + 24);
+    m_merit = (Real) readDouble(data + 28);
+    const size_t commandLineSize = readWord(data + 44);
+    if (m_wordsPerColumn != (m_nRows + 31) / 32 || commandLineSize > size - fixedHeaderSize)
+    {
+        throw std::runtime_error("corrupted header in the binary net file " + fileName);
+    }
+    m_commandLine.assign(reinterpret_cast<const char*>(data + fixedHeaderSize), commandLineSize);
+    m_columns = data + fixedHeaderSize + commandLineSize;
+    const uint64_t columnBytes = (uint64_t) m_dimension * m_nCols * m_wordsPerColumn * 4;
+    if (columnBytes != size - fixedHeaderSize - commandLineSize)
+    {
+        throw std::runtime_error("the binary net file " + fileName + " does not have the size given by its header");
+    }
+}
+
+GeneratingMatrix BinaryInput::generatingMatrix(Dimension coord) const
+{
+    const unsigned char* columns = m_columns + (size_t) coord * m_nCols * m_wordsPerColumn * 4;
+    if (m_nRows <= GeneratingMatrix::maxPackedCols && m_nCols <= GeneratingMatrix::maxPackedCols)
+    {
+        GeneratingMatrix::PackedRow packed[GeneratingMatrix::maxPackedCols];
+        for (unsigned int j = 0; j < m_nCols; ++j)
+        {
+            const unsigned char* column = columns + (size_t) j * m_wordsPerColumn * 4;
+            packed[j] = readWord(column);
+            if (m_wordsPerColumn > 1)
+            {
+                packed[j] |= (GeneratingMatrix::PackedRow) readWord(column + 4) << 32;
+            }
+        }
+        return GeneratingMatrix::fromPackedColumns(m_nRows, m_nCols, packed);
+    }
+    GeneratingMatrix matrix(m_nRows, m_nCols);
+    for (unsigned int j = 0; j < m_nCols; ++j)
+    {
+        const unsigned char* column = columns + (size_t) j * m_wordsPerColumn * 4;
+        for (unsigned int w = 0; w < m_wordsPerColumn; ++w)
+        {
+            for (uint32_t word = readWord(column + 4 * w); word != 0; word &= word - 1)
+            {
+                matrix(32 * w + lowestSetBit(word), j) = 1;
+            }
+        }
+    }
+    return matrix;
+}
+
+std::vector<GeneratingMatrix> BinaryInput::generatingMatrices() const
+{
+    std::vector<GeneratingMatrix> matrices;
+    matrices.reserve(m_dimension);
+    for (Dimension coord = 0; coord < m_dimension; ++coord)
+    {
+        matrices.push_back(generatingMatrix(coord));
+    }
+    return matrices;
+}
+
+}
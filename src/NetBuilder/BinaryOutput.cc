@@ -0,0 +1,105 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/BinaryOutput.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace NetBuilder {
+
+namespace {
+
+    void append(std::vector<unsigned char>& buffer, uint32_t value)
+    {
+        for (unsigned int k = 0; k < 4; ++k)
+        {
+            buffer.push_back((unsigned char) (value >> (8 * k)));
+        }
+    }
+
+    void append(std::vector<unsigned char>& buffer, double value)
+    {
+        static_assert(sizeof(double) == sizeof(uint64_t), "double must have 64 bits");
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (unsigned int k = 0; k < 8; ++k)
+        {
+            buffer.push_back((unsigned char) (bits >> (8 * k)));
+        }
+    }
+
+    void flush(std::ostream& os, std::vector<unsigned char>& buffer)
+    {
+        os.write(reinterpret_cast<const char*>(buffer.data()), (std::streamsize) buffer.size());
+        if (!os)
+        {
+            throw std::runtime_error("cannot write the binary output");
+        }
+        buffer.clear();
+    }
+}
+
+constexpr uint32_t BinaryOutput::version;
+
+void BinaryOutput::write(std::ostream& os, const AbstractDigitalNet& net, Real merit, double elapsed,
+                         unsigned int interlacingFactor, const std::string& commandLine)
+{
+    const unsigned int nRows = net.numRows();
+    const unsigned int nCols = net.numColumns();
+    const unsigned int wordsPerColumn = (nRows + 31) / 32;
+
+    std::vector<unsigned char> buffer;
+    buffer.insert(buffer.end(), {'L', 'N', 'B', 'N'});
+    append(buffer, version);
+    append(buffer, (uint32_t) net.dimension());
+    append(buffer, (uint32_t) interlacingFactor);
+    append(buffer, (uint32_t) nRows);
+    append(buffer, (uint32_t) nCols);
+    append(buffer, (uint32_t) wordsPerColumn);
+    append(buffer, (double) merit);
+    append(buffer, elapsed);
+    append(buffer, (uint32_t) commandLine.size());
+    buffer.insert(buffer.end(), commandLine.begin(), commandLine.end());
+    flush(os, buffer);
+
+    std::vector<uint32_t> columns(nCols * wordsPerColumn);
+    buffer.reserve(4 * columns.size());
+    for (Dimension coord = 0; coord < net.dimension(); ++coord)
+    {
+        const GeneratingMatrix& matrix = net.generatingMatrix(coord);
+        std::fill(columns.begin(), columns.end(), 0);
+        for (unsigned int i = 0; i < nRows; ++i)
+        {
+            for (unsigned int j = 0; j < nCols; ++j)
+            {
+                if (matrix(i, j))
+                {
+                    columns[j * wordsPerColumn + i / 32] |= uint32_t(1) << (i % 32);
+                }
+            }
+        }
+        for (uint32_t word : columns)
+        {
+            append(buffer, word);
+        }
+        flush(os, buffer);
+    }
+}
+
+}
@@ -0,0 +1,221 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/FigureOfMerit/TValueComputation.h"
+#include "netbuilder/Types.h"
+#include "latbuilder/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace NetBuilder {
+
+namespace {
+
+// smallest number of points which are split between the workers of the shared thread pool
+constexpr size_t minPointsForParallelSum = size_t(1) << 16;
+
+/**
+ * Adds to \c acc the sums over the points of the projection of the products \f$\prod_j (1 - w^{\nu_j})\f$, truncated at degree \c m,
+ * where \f$\nu_j\f$ is one plus the index of the first nonzero coordinate of the image of the point by the first \c m rows of the
+ * \f$ j \f$-th matrix, or \f$ m+1 \f$ if the image is zero. The columns \c cols of the matrices are packed so that bit \f$ r \f$ of
+ * <code>cols[j][c]</code> is the entry of row \f$ r \f$ and column \f$ c \f$ of the \f$ j \f$-th matrix, and the points
+ * \f$ i \f$ from \c begin to \c end are generated in Gray code order.
+ */
+void sumProducts(const std::vector<std::vector<GeneratingMatrix::PackedRow>>& cols, unsigned int m, size_t begin, size_t end, std::vector<long>& acc)
+{
+    typedef GeneratingMatrix::PackedRow PackedRow;
+
+    const size_t s = cols.size();
+    std::vector<PackedRow> images(s, 0);
+    const size_t gray = begin ^ (begin >> 1);
+    for (size_t j = 0; j < s; ++j)
+    {
+        for (size_t bits = gray; bits != 0; bits &= bits - 1)
+        {
+            images[j] ^= cols[j][lowestSetBit(bits)];
+        }
+    }
+
+    std::vector<long> prod(m + 1);
+    for (size_t i = begin; i < end; ++i)
+    {
+        prod[0] = 1;
+        unsigned int degree = 0;
+        for (size_t j = 0; j < s; ++j)
+        {
+            if (i > begin)
+            {
+                images[j] ^= cols[j][lowestSetBit(i)]; // the Gray codes of i-1 and i differ by the lowest set bit of i
+            }
+            if (images[j] == 0)
+            {
+                continue; // the factor is 1 after truncation
+            }
+            const unsigned int v = lowestSetBit(images[j]) + 1;
+            const unsigned int newDegree = std::min(m, degree + v);
+            std::fill(prod.begin() + degree + 1, prod.begin() + newDegree + 1, 0);
+            degree = newDegree;
+            for (unsigned int d = degree; d >= v; --d)
+            {
+                prod[d] -= prod[d - v];
+            }
+        }
+        for (unsigned int d = 0; d <= degree; ++d)
+        {
+            acc[d] += prod[d];
+        }
+    }
+}
+
+/**
+ * Returns the t-value of the projection of the matrices \c baseMatrices restricted to their first \c m rows and columns.
+ * The sum of the products of the points is the weight enumerator of the dual net in \f$ w = 2z \f$, up to the auxiliary
+ * polynomial \f$ Q_m(z) \f$ of \cite rDIC13a: the t-value is \f$ m + 1 - \rho \f$, where \f$ \rho \f$ is the smallest positive
+ * degree of the product of the two polynomials with a nonzero coefficient, that is the minimum weight of the nonzero dual vectors.
+ */
+unsigned int dualTValue(const std::vector<GeneratingMatrix>& baseMatrices, unsigned int m)
+{
+    typedef GeneratingMatrix::PackedRow PackedRow;
+
+    if (m == 0)
+    {
+        return 0;
+    }
+    const Dimension s = (Dimension) baseMatrices.size();
+    std::vector<std::vector<PackedRow>> cols(s, std::vector<PackedRow>(m, 0));
+    for (Dimension j = 0; j < s; ++j)
+    {
+        for (unsigned int r = 0; r < m; ++r)
+        {
+            const PackedRow row = baseMatrices[j].packedRow(r);
+            for (unsigned int c = 0; c < m; ++c)
+            {
+                cols[j][c] |= ((row >> c) & 1) << r;
+            }
+        }
+    }
+
+    const size_t numPoints = size_t(1) << m;
+    std::vector<long> acc(m + 1, 0);
+    auto& pool = LatBuilder::ThreadPool::global();
+    if (pool.size() == 1 || numPoints < minPointsForParallelSum)
+    {
+        sumProducts(cols, m, 0, numPoints, acc);
+    }
+    else
+    {
+        const size_t numChunks = numPoints / minPointsForParallelSum;
+        std::vector<std::vector<long>> accs(pool.size(), std::vector<long>(m + 1, 0));
+        pool.parallelFor(numChunks, [&](unsigned int worker, size_t chunk)
+        {
+            sumProducts(cols, m, chunk * minPointsForParallelSum, (chunk + 1) * minPointsForParallelSum, accs[worker]);
+        });
+        for (const auto& workerAcc : accs)
+        {
+            for (unsigned int d = 0; d <= m; ++d)
+            {
+                acc[d] += workerAcc[d]; // the sums are exact, hence independent of the number of workers
+            }
+        }
+    }
+
+    IntPolynomial truncWeightPoly(0);
+    for (unsigned int d = 0; d <= m; ++d)
+    {
+        if (acc[d] != 0)
+        {
+            NTL::ZZ coefficient;
+            coefficient = acc[d];
+            coefficient <<= d;
+            NTL::SetCoeff(truncWeightPoly, d, coefficient);
+        }
+    }
+
+    IntPolynomial aux(1);
+    IntPolynomial base(1);
+    for (unsigned int j = 1; j <= m; ++j)
+    {
+        NTL::SetCoeff(base, j, NTL::ZZ(1) << (j - 1));
+    }
+    for (Dimension j = 0; j < s; ++j)
+    {
+        aux = NTL::MulTrunc(base, aux, m + 1);
+    }
+
+    const IntPolynomial poly = NTL::MulTrunc(aux, truncWeightPoly, m + 1);
+    unsigned int rho = 1;
+    while (rho <= m && NTL::coeff(poly, rho) == 0)
+    {
+        ++rho;
+    }
+    return m + 1 - rho;
+}
+
+}
+
+bool DualMethod::fits(unsigned int s, unsigned int m)
+{
+    if (m > maxColumns)
+    {
+        return false;
+    }
+    // the coefficients of the products of a point are bounded by the number of subsets of at most m coordinates
+    double numSubsets = 0;
+    double binomial = 1;
+    for (unsigned int j = 0; j <= std::min(m, s); ++j)
+    {
+        numSubsets += binomial;
+        binomial = binomial * (double) (s - j) / (j + 1);
+    }
+    return std::ldexp(numSubsets, (int) m) < std::ldexp(1.0, std::numeric_limits<long>::digits - 1);
+}
+
+bool DualMethod::fits(const std::vector<GeneratingMatrix>& baseMatrices)
+{
+    return !baseMatrices.empty() && baseMatrices[0].nRows() >= baseMatrices[0].nCols() &&
+        fits((unsigned int) baseMatrices.size(), baseMatrices[0].nCols());
+}
+
+unsigned int DualMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, int verbose)
+{
+    if (!fits(baseMatrices))
+    {
+        return GaussMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    return std::max(dualTValue(baseMatrices, baseMatrices[0].nCols()), maxTValuesSubProj);
+}
+
+std::vector<unsigned int> DualMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose)
+{
+    const unsigned int nCols = baseMatrices[0].nCols();
+    const unsigned int nLevels = (unsigned int) maxTValuesSubProj.size();
+    if (!fits(baseMatrices) || nLevels > nCols)
+    {
+        return GaussMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, verbose);
+    }
+    std::vector<unsigned int> result(nLevels);
+    for (unsigned int i = 0; i < nLevels; ++i)
+    {
+        // the levels of the t-values end with the level of all the columns
+        result[i] = std::max(dualTValue(baseMatrices, nCols - (nLevels - 1 - i)), maxTValuesSubProj[i]);
+    }
+    return result;
+}
+
+}
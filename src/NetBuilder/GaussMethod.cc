@@ -17,31 +17,111 @@
 #include <map>
 #include <fstream>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
 
 #include "netbuilder/FigureOfMerit/TValueComputation.h"
 #include "netbuilder/Helpers/RankComputer.h"
 #include "netbuilder/Helpers/CompositionMaker.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/ThreadPool.h"
 
 
 
 namespace NetBuilder {
 
+// smallest number of compositions which are split between the workers of the shared thread pool
+constexpr unsigned long long minCompositionsForParallelWalk = 1024;
+
+// Returns the binomial coefficient of n and p, or a number larger than minCompositionsForParallelWalk if it is too large.
+unsigned long long bounded_binomial(unsigned int n, unsigned int p)
+{
+    if (p > n)
+    {
+        return 0;
+    }
+    unsigned long long res = 1;
+    for (unsigned int i = 0; i < p && res <= minCompositionsForParallelWalk; ++i)
+    {
+        res = res * (n - i) / (i + 1);
+    }
+    return res;
+}
+
+// Same as iteration_on_k, with the compositions split by the number of rows of coordinate 1 between the workers of the shared thread pool. 
+// The workers stop as soon as one of them finds a composition whose rows are dependent. Requires s > 2.
+unsigned int parallel_iteration_on_k(const std::vector<GeneratingMatrix>& baseMatrices, unsigned int k, int verbose)
+{
+    const unsigned int nCols = baseMatrices[0].nCols();
+    const unsigned int s = (unsigned int) baseMatrices.size();
+
+    const unsigned int numBlocks = k - s + 1;
+    std::vector<unsigned int> blockIndices(numBlocks, 0);
+    std::atomic<bool> dependent(false);
+
+    LatBuilder::ThreadPool::global().parallelFor(numBlocks, [&](unsigned int, size_t block)
+        {
+            if (dependent.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+
+            // the block starts with the rows of coordinate 1, followed by the rows of the compositions of the other coordinates
+            const unsigned int firstRows = (unsigned int) block + 1;
+            RankComputer rankComputer(nCols);
+            for (unsigned int r = 0; r < firstRows; ++r)
+            {
+                rankComputer.addRow(baseMatrices[s-1], r);
+            }
+
+            // the rows of coordinate j of the walker are those of baseMatrices[s-1-j]
+            CompositionRowWalker walker(k - firstRows, s - 1);
+            for (const auto& slotRow : walker.initialRows())
+            {
+                rankComputer.addRow(baseMatrices[s-1-slotRow.coordinate], slotRow.row);
+            }
+
+            unsigned int smallestFullRankIndex = rankComputer.smallestFullRank() - 1;
+            while (smallestFullRankIndex < nCols && walker.next())
+            {
+                if (dependent.load(std::memory_order_relaxed))
+                {
+                    return;
+                }
+                const auto& rowChange = walker.lastChange();
+                rankComputer.replaceRow(firstRows + rowChange.slot, baseMatrices[s-1-rowChange.coordinate], rowChange.row, verbose-1);
+                smallestFullRankIndex = rankComputer.smallestFullRank() - 1;
+            }
+            if (smallestFullRankIndex == nCols)
+            {
+                dependent.store(true, std::memory_order_relaxed);
+            }
+            blockIndices[block] = smallestFullRankIndex;
+        });
+
+    if (dependent.load())
+    {
+        return nCols;
+    }
+    return *std::max_element(blockIndices.begin(), blockIndices.end());
+}
+
 unsigned int iteration_on_k(std::vector<GeneratingMatrix>& baseMatrices, unsigned int k, int verbose){
     unsigned int nCols = baseMatrices[0].nCols();
     unsigned int s = (unsigned int) baseMatrices.size();
+
+    if (s > 2 && LatBuilder::ThreadPool::global().size() > 1 && bounded_binomial(k - 1, s - 1) >= minCompositionsForParallelWalk){
+        return parallel_iteration_on_k(baseMatrices, k, verbose);
+    }
     
-    // Initialization of row map from original matrices to computation matrix
-    std::map<std::pair<int, int>, int> Origin_to_M;
+    // the rows of coordinate j are those of baseMatrices[s-j]
+    CompositionRowWalker walker(k, s);
 
     RankComputer rankComputer(nCols);
 
-    for (unsigned int i=0; i<k-s+1; i++){
-        Origin_to_M[{1, i+1}] = i;
-        rankComputer.addRow(baseMatrices[s-1].subMatrix(i, 0, 1, nCols));
-    }
-    for (unsigned int i=1; i<s; i++){
-        Origin_to_M[{i+1, 1}] = k-s+i;
-        rankComputer.addRow(baseMatrices[s-1-i].subMatrix(0, 0, 1, nCols));
+    for (const auto& slotRow : walker.initialRows()){
+        rankComputer.addRow(baseMatrices[s-slotRow.coordinate], slotRow.row);
     }
 
     unsigned int smallestFullRankIndex = rankComputer.smallestFullRank() - 1;
@@ -50,19 +130,11 @@ unsigned int iteration_on_k(std::vector<GeneratingMatrix>& baseMatrices, unsigne
         return nCols;
     }
 
-    CompositionMaker compositionMaker(k, s);
+    while (walker.next()) {
 
-    while (compositionMaker.goToNextComposition()) {
-
-        std::pair<std::pair<int, int>, std::pair<int, int>> rowChange = compositionMaker.changeFromPreviousComposition();
-
-        int ind_exchange = Origin_to_M[rowChange.first];
-        Origin_to_M[rowChange.second] = ind_exchange;
-        Origin_to_M.erase(rowChange.first);
+        const auto& rowChange = walker.lastChange();
         
-        GeneratingMatrix newRow = baseMatrices[s-rowChange.second.first].subMatrix(rowChange.second.second-1, 0, 1, nCols);
-
-        rankComputer.replaceRow(ind_exchange, std::move(newRow), verbose-1);
+        rankComputer.replaceRow(rowChange.slot, baseMatrices[s-rowChange.coordinate], rowChange.row, verbose-1);
 
         smallestFullRankIndex = rankComputer.smallestFullRank() - 1;
 
@@ -73,18 +145,439 @@ unsigned int iteration_on_k(std::vector<GeneratingMatrix>& baseMatrices, unsigne
     return smallestFullRankIndex;
 }
 
+// Cutoffs of the t-values of the levels, in terms of the walk over the compositions. The t-value of the level of c columns exceeds
+// its cutoff t if and only if, for k = c - t, some composition of k rows is not of full rank in the first c columns: the smallest
+// full rank index of the compositions of k rows is at least c. Since the rows of a composition of k rows contain those of a
+// composition of k - 1 rows, these indices only increase with k, and so does the lower bound given by the compositions walked so far.
+struct LevelCutoffs
+{
+    std::vector<unsigned int> columns; // columns[k]: smallest number of columns of a level which exceeds its cutoff if an index of k rows reaches it
+    std::vector<unsigned int> levels; // levels[k]: index of that level
+    unsigned int maxRows; // largest k for which columns[k] is set, or 0
+    std::atomic<unsigned int> exceededLevel; // index of a level known to exceed its cutoff, or the number of levels
+
+    bool exceeded(unsigned int nLevels) const
+    {
+        return exceededLevel.load(std::memory_order_relaxed) < nLevels;
+    }
+};
+
+// Walks depth-first over the compositions of fewer than dependentBound rows, one row at a time, and stores in smallestFullRankIndices[k] the largest
+// smallest full rank index (as returned by iteration_on_k) of the compositions of k rows. Each row is reduced against the rows of the selection
+// it extends and takes its lowest nonzero column as pivot, so that the rows of a selection restricted to their first c columns
+// are independent if and only if all their pivots are lower than c: the rows of each composition are reduced once for all the levels.
+// The selections whose rows are dependent are not extended and lower dependentBound to the smallest number of rows of a dependent composition.
+// If cutoffs is not null, the walk stops as soon as the t-value of a level of nLevels is known to exceed its cutoff.
+void walk_compositions(const std::vector<GeneratingMatrix>& baseMatrices, unsigned int matrix, unsigned int highestPivot,
+                       std::vector<GeneratingMatrix::PackedRow>& rows, std::vector<GeneratingMatrix::PackedRow>& pivots,
+                       std::vector<unsigned int>& smallestFullRankIndices, unsigned int& dependentBound,
+                       LevelCutoffs* cutoffs = nullptr, unsigned int nLevels = 0)
+{
+    const unsigned int depth = (unsigned int) rows.size();
+    const unsigned int remaining = (unsigned int) baseMatrices.size() - matrix - 1; // number of matrices which still need a row
+
+    // the compositions of dependentBound rows or more are known to contain a dependent one
+    for (unsigned int a = 1; depth + a + remaining < dependentBound; ++a)
+    {
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+        GeneratingMatrix::PackedRow row = baseMatrices[matrix].packedRow(a - 1);
+        for (unsigned int i = 0; i < rows.size(); ++i)
+        {
+            if (row & pivots[i])
+            {
+                row ^= rows[i];
+            }
+        }
+        if (row == 0)
+        {
+            dependentBound = std::min(dependentBound, depth + a + remaining);
+            if (cutoffs && dependentBound <= cutoffs->maxRows)
+            {
+                cutoffs->exceededLevel.store(cutoffs->levels[cutoffs->maxRows], std::memory_order_relaxed);
+            }
+            break;
+        }
+        const unsigned int pivot = lowestSetBit(row);
+        highestPivot = std::max(highestPivot, pivot);
+        rows.push_back(row);
+        pivots.push_back(GeneratingMatrix::PackedRow(1) << pivot);
+        if (remaining == 0)
+        {
+            const unsigned int k = depth + a;
+            smallestFullRankIndices[k] = std::max(smallestFullRankIndices[k], highestPivot);
+            if (cutoffs && smallestFullRankIndices[k] >= cutoffs->columns[k])
+            {
+                cutoffs->exceededLevel.store(cutoffs->levels[k], std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            walk_compositions(baseMatrices, matrix + 1, highestPivot, rows, pivots, smallestFullRankIndices, dependentBound, cutoffs, nLevels);
+        }
+        if (cutoffs && cutoffs->exceeded(nLevels))
+        {
+            break;
+        }
+    }
+    rows.resize(depth);
+    pivots.resize(depth);
+}
+
+// Same as walk_compositions for the two-dimensional projections, whose compositions of k rows are the pairs (a, k - a): the echelon
+// of the first a rows of the first matrix is extended row by row, and each of its prefixes is completed with the rows of the second
+// matrix in place, in fixed-size arrays of packed rows.
+void walk_pairs(const GeneratingMatrix& first, const GeneratingMatrix& second, std::vector<unsigned int>& smallestFullRankIndices,
+                unsigned int& dependentBound, LevelCutoffs* cutoffs = nullptr, unsigned int nLevels = 0)
+{
+    typedef GeneratingMatrix::PackedRow PackedRow;
+
+    // the reduced rows are independent, hence at most GeneratingMatrix::maxPackedCols of them
+    std::array<PackedRow, GeneratingMatrix::maxPackedCols> rows;
+    std::array<PackedRow, GeneratingMatrix::maxPackedCols> pivots;
+
+    auto reduce = [&rows, &pivots](PackedRow row, unsigned int numRows)
+    {
+        for (unsigned int i = 0; i < numRows; ++i)
+        {
+            if (row & pivots[i])
+            {
+                row ^= rows[i];
+            }
+        }
+        return row;
+    };
+
+    auto dependent = [&](unsigned int k)
+    {
+        dependentBound = std::min(dependentBound, k);
+        if (cutoffs && dependentBound <= cutoffs->maxRows)
+        {
+            cutoffs->exceededLevel.store(cutoffs->levels[cutoffs->maxRows], std::memory_order_relaxed);
+        }
+    };
+
+    unsigned int highestFirstPivot = 0;
+    for (unsigned int a = 1; a + 1 < dependentBound; ++a)
+    {
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+        const PackedRow row = reduce(first.packedRow(a - 1), a - 1);
+        if (row == 0)
+        {
+            dependent(a + 1);
+            break;
+        }
+        const unsigned int pivot = lowestSetBit(row);
+        highestFirstPivot = std::max(highestFirstPivot, pivot);
+        rows[a - 1] = row;
+        pivots[a - 1] = PackedRow(1) << pivot;
+
+        // the rows of the second matrix overwrite those of the previous prefix of the first one
+        unsigned int highestPivot = highestFirstPivot;
+        for (unsigned int b = 1; a + b < dependentBound; ++b)
+        {
+            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+            const unsigned int k = a + b;
+            const PackedRow secondRow = reduce(second.packedRow(b - 1), k - 1);
+            if (secondRow == 0)
+            {
+                dependent(k);
+                break;
+            }
+            const unsigned int secondPivot = lowestSetBit(secondRow);
+            highestPivot = std::max(highestPivot, secondPivot);
+            rows[k - 1] = secondRow;
+            pivots[k - 1] = PackedRow(1) << secondPivot;
+            smallestFullRankIndices[k] = std::max(smallestFullRankIndices[k], highestPivot);
+            if (cutoffs && smallestFullRankIndices[k] >= cutoffs->columns[k])
+            {
+                cutoffs->exceededLevel.store(cutoffs->levels[k], std::memory_order_relaxed);
+            }
+            if (cutoffs && cutoffs->exceeded(nLevels))
+            {
+                break;
+            }
+        }
+        if (cutoffs && cutoffs->exceeded(nLevels))
+        {
+            break;
+        }
+    }
+}
+
+// Returns the results of iteration_on_k for all k from 0 to maxRows with a single walk over the compositions. 
+// The matrices must have at most GeneratingMatrix::maxPackedCols columns. If cutoffs is not null and the walk finds
+// a level of nLevels which exceeds its cutoff, the results are incomplete.
+std::vector<unsigned int> smallest_full_rank_indices(const std::vector<GeneratingMatrix>& baseMatrices, unsigned int maxRows,
+                                                     LevelCutoffs* cutoffs = nullptr, unsigned int nLevels = 0)
+{
+    const unsigned int nCols = baseMatrices[0].nCols();
+    std::vector<unsigned int> smallestFullRankIndices(maxRows + 1, 0);
+    unsigned int dependentBound = maxRows + 1;
+    std::vector<GeneratingMatrix::PackedRow> rows;
+    std::vector<GeneratingMatrix::PackedRow> pivots;
+    rows.reserve(maxRows);
+    pivots.reserve(maxRows);
+
+    const unsigned int s = (unsigned int) baseMatrices.size();
+    if (s == 2)
+    {
+        walk_pairs(baseMatrices[0], baseMatrices[1], smallestFullRankIndices, dependentBound, cutoffs, nLevels);
+    }
+    else if (s < 3 || LatBuilder::ThreadPool::global().size() == 1 || bounded_binomial(maxRows, s) < minCompositionsForParallelWalk)
+    {
+        walk_compositions(baseMatrices, 0, 0, rows, pivots, smallestFullRankIndices, dependentBound, cutoffs, nLevels);
+    }
+    else
+    {
+        // the rows of the first matrix are reduced first, then the subtrees of its numbers of rows are walked concurrently
+        std::vector<unsigned int> highestPivots;
+        for (unsigned int a = 1; a + s - 1 < dependentBound; ++a)
+        {
+            GeneratingMatrix::PackedRow row = baseMatrices[0].packedRow(a - 1);
+            for (unsigned int i = 0; i < rows.size(); ++i)
+            {
+                if (row & pivots[i])
+                {
+                    row ^= rows[i];
+                }
+            }
+            if (row == 0)
+            {
+                dependentBound = a + s - 1;
+                if (cutoffs && dependentBound <= cutoffs->maxRows)
+                {
+                    cutoffs->exceededLevel.store(cutoffs->levels[cutoffs->maxRows], std::memory_order_relaxed);
+                }
+                break;
+            }
+            const unsigned int pivot = lowestSetBit(row);
+            highestPivots.push_back(highestPivots.empty() ? pivot : std::max(highestPivots.back(), pivot));
+            rows.push_back(row);
+            pivots.push_back(GeneratingMatrix::PackedRow(1) << pivot);
+        }
+
+        const size_t numBlocks = rows.size();
+        std::vector<std::vector<unsigned int>> blockIndices(numBlocks);
+        std::vector<unsigned int> blockBounds(numBlocks, dependentBound);
+        LatBuilder::ThreadPool::global().parallelFor(numBlocks, [&](unsigned int, size_t block)
+            {
+                std::vector<GeneratingMatrix::PackedRow> blockRows(rows.begin(), rows.begin() + block + 1);
+                std::vector<GeneratingMatrix::PackedRow> blockPivots(pivots.begin(), pivots.begin() + block + 1);
+                blockRows.reserve(maxRows);
+                blockPivots.reserve(maxRows);
+                blockIndices[block].assign(maxRows + 1, 0);
+                if (!cutoffs || !cutoffs->exceeded(nLevels))
+                {
+                    walk_compositions(baseMatrices, 1, highestPivots[block], blockRows, blockPivots, blockIndices[block], blockBounds[block],
+                                      cutoffs, nLevels);
+                }
+            });
+
+        for (size_t block = 0; block < numBlocks; ++block)
+        {
+            dependentBound = std::min(dependentBound, blockBounds[block]);
+            for (unsigned int k = 0; k <= maxRows; ++k)
+            {
+                smallestFullRankIndices[k] = std::max(smallestFullRankIndices[k], blockIndices[block][k]);
+            }
+        }
+    }
+
+    for (unsigned int k = dependentBound; k <= maxRows; ++k)
+    {
+        smallestFullRankIndices[k] = nCols; // some composition of k rows is dependent
+    }
+    return smallestFullRankIndices;
+}
+
 unsigned int GaussMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxSubProj, int verbose=0)
 {
+    return GaussMethod::computeBoundedTValue(std::move(baseMatrices), maxSubProj, std::numeric_limits<unsigned int>::max(), verbose);
+}
+
+unsigned int GaussMethod::computeBoundedTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxSubProj, unsigned int cutoff, int verbose)
+{
+    unsigned int nRows = baseMatrices[0].nRows();
+    unsigned int nCols = baseMatrices[0].nCols();
     unsigned int s = (unsigned int) baseMatrices.size();
+
     if (s == 1)
     {
         return 0;
     }
+    if (nCols < s || maxSubProj > cutoff)
+    {
+        return maxSubProj;
+    }
 
-    return GaussMethod::computeTValue(baseMatrices, baseMatrices[0].nCols()-1, {maxSubProj}, verbose)[0];
+    // the t-value is nCols - k for the largest k such that the rows of all the compositions of k are
+    // linearly independent, if it is larger than the t-values of the subprojections
+    if (s == 2 && nCols <= GeneratingMatrix::maxPackedCols && nRows >= maxSubProj + s)
+    {
+        // the pairs of all the numbers of rows are reduced in a single walk
+        const std::vector<unsigned int> smallestFullRankIndices = smallest_full_rank_indices(baseMatrices, nRows - maxSubProj);
+        for (unsigned int k=nRows-maxSubProj; k >= s; k--){
+            if (smallestFullRankIndices[k] < nCols){
+                return std::max(nCols - k, maxSubProj);
+            }
+        }
+        return std::max(nCols - s + 1, maxSubProj);
+    }
+    for (unsigned int k=nRows-maxSubProj; k >= s; k--){
+        if (k < nCols && nCols - k > cutoff){
+            return nCols - k; // all the larger values of k failed
+        }
+        if (iteration_on_k(baseMatrices, k, verbose-1) < nCols){
+            return std::max(nCols - k, maxSubProj);
+        }
+    }
+    return std::max(nCols - s + 1, maxSubProj);
 }
 
-std::vector<unsigned int> GaussMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxSubProj, int verbose=0)
+GaussMethod::Reduction::Reduction():
+    m_numMatrices(0),
+    m_nRows(0),
+    m_nCols(0),
+    m_dependentBound(0)
+{}
+
+GaussMethod::Reduction::Reduction(const std::vector<const GeneratingMatrix*>& baseMatrices):
+    m_numMatrices((unsigned int) baseMatrices.size()),
+    m_nRows(baseMatrices[0]->nRows()),
+    m_nCols(baseMatrices[0]->nCols()),
+    m_dependentBound(std::numeric_limits<unsigned int>::max())
+{
+    std::vector<Entry> path;
+    path.reserve(m_nRows);
+    extend(baseMatrices, 0, path);
+}
+
+bool GaussMethod::Reduction::fits(const std::vector<const GeneratingMatrix*>& baseMatrices)
+{
+    return !baseMatrices.empty() && baseMatrices[0]->nCols() <= GeneratingMatrix::maxPackedCols;
+}
+
+void GaussMethod::Reduction::extend(const std::vector<const GeneratingMatrix*>& baseMatrices, unsigned int matrix, std::vector<Entry>& path)
+{
+    const size_t pathSize = path.size();
+    const unsigned int depth = (unsigned int) pathSize;
+    const unsigned int remaining = m_numMatrices - matrix - 1; // number of matrices which still need a row
+    const bool last = (remaining == 0);
+
+    // the compositions complete the selection with at least one row of each remaining matrix, and select fewer than m_nRows rows
+    for (unsigned int a = 1; depth + a + remaining < m_nRows; ++a)
+    {
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+        PackedRow row = baseMatrices[matrix]->packedRow(a - 1);
+        for (const auto& entry : path)
+        {
+            if (row & entry.pivot)
+            {
+                row ^= entry.row;
+            }
+        }
+        if (row == 0)
+        {
+            // the smallest composition with this selection is dependent, and so are all the selections which extend it
+            m_dependentBound = std::min(m_dependentBound, depth + a + remaining);
+            break;
+        }
+        const Entry entry = {row, PackedRow(1) << lowestSetBit(row), depth + a, last};
+        m_entries.push_back(entry);
+        path.push_back(entry);
+        if (!last)
+        {
+            extend(baseMatrices, matrix + 1, path);
+        }
+    }
+    path.resize(pathSize);
+}
+
+unsigned int GaussMethod::computeBoundedTValue(const Reduction& reduction, const GeneratingMatrix& newMatrix, unsigned int maxSubProj, unsigned int cutoff)
+{
+    typedef GeneratingMatrix::PackedRow PackedRow;
+
+    const unsigned int nRows = reduction.m_nRows;
+    const unsigned int nCols = reduction.m_nCols;
+    const unsigned int s = reduction.m_numMatrices + 1;
+
+    if (nCols < s || maxSubProj > cutoff)
+    {
+        return maxSubProj;
+    }
+    if (nRows < s + maxSubProj)
+    {
+        return std::max(nCols - s + 1, maxSubProj);
+    }
+
+    // The rows of the composition (c, a) of k, where c is a composition of the other matrices, are independent if and only if
+    // the first a rows of the new matrix are independent of the rows of c. The largest k such that the rows of all the compositions 
+    // of k are independent is thus the minimum of |c| + a(c), where a(c) is the largest such a, which is lowered composition by composition.
+    unsigned int bound = std::min(nRows - maxSubProj, reduction.m_dependentBound);
+
+    std::vector<const Reduction::Entry*> path;
+    path.reserve(nRows);
+    std::vector<PackedRow> newRows(nRows);
+    std::vector<PackedRow> newPivots(nRows);
+
+    for (const auto& entry : reduction.m_entries)
+    {
+        if (entry.depth >= bound)
+        {
+            continue; // neither the composition nor the compositions which extend it can lower the bound
+        }
+        path.resize(entry.depth - 1);
+        path.push_back(&entry);
+        if (!entry.composition)
+        {
+            continue;
+        }
+
+        const unsigned int maxNewRows = bound - entry.depth;
+        unsigned int numNewRows = 0;
+        while (numNewRows < maxNewRows)
+        {
+            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+            PackedRow row = newMatrix.packedRow(numNewRows);
+            for (const Reduction::Entry* pathEntry : path)
+            {
+                if (row & pathEntry->pivot)
+                {
+                    row ^= pathEntry->row;
+                }
+            }
+            for (unsigned int i = 0; i < numNewRows; ++i)
+            {
+                if (row & newPivots[i])
+                {
+                    row ^= newRows[i];
+                }
+            }
+            if (row == 0)
+            {
+                break;
+            }
+            newRows[numNewRows] = row;
+            newPivots[numNewRows] = PackedRow(1) << lowestSetBit(row);
+            ++numNewRows;
+        }
+
+        if (numNewRows < maxNewRows)
+        {
+            bound = entry.depth + numNewRows;
+            if (bound < nCols && nCols - bound > cutoff)
+            {
+                return nCols - bound; // the t-value is at least nCols - bound
+            }
+        }
+    }
+    return std::max(nCols - bound, maxSubProj);
+}
+
+// Computes the multilevel t-values as GaussMethod::computeTValue(), or if levelCutoffs is not null, as GaussMethod::computeBoundedTValue():
+// as soon as the t-value of a level is known to exceed its cutoff, the lower bounds maxSubProj are returned, with that of the level raised above its cutoff.
+std::vector<unsigned int> multilevel_t_values(std::vector<GeneratingMatrix>& baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxSubProj,
+                                              const std::vector<unsigned int>* levelCutoffs, int verbose)
 {
     unsigned int nRows = baseMatrices[0].nRows();
     unsigned int nCols = baseMatrices[0].nCols();
@@ -95,7 +588,7 @@ std::vector<unsigned int> GaussMethod::computeTValue(std::vector<GeneratingMatri
     if (s == 1){
         RankComputer rankComputer(nCols);
         for (unsigned int r=0; r<nRows; r++){
-            rankComputer.addRow(baseMatrices[0].subMatrix(r, 0, 1, nCols));
+            rankComputer.addRow(baseMatrices[0], r);
         }
         std::map<unsigned int, unsigned int> pivotPos = rankComputer.getPivots();
         
@@ -131,10 +624,62 @@ std::vector<unsigned int> GaussMethod::computeTValue(std::vector<GeneratingMatri
         result[i+diff] = std::max(nCols-(nLevel-1-i)-s+1, maxSubProj[i+diff]);
     }
     unsigned int previousIndSmallestInvertible = nLevel;
-    
 
-    for (unsigned int k=nRows-maxSubProj.back(); k >= s; k--){
-        unsigned int smallestFullRankIndex = iteration_on_k(baseMatrices, k, verbose-1);
+    // with packed rows, the compositions of all the numbers of rows are reduced in a single walk
+    const unsigned int maxRows = nRows - maxSubProj.back();
+    const bool singleWalk = (nCols <= GeneratingMatrix::maxPackedCols && maxRows >= s);
+
+    const unsigned int nLevels = (unsigned int) maxSubProj.size();
+    auto exceeded = [&](unsigned int level)
+    {
+        std::vector<unsigned int> lowerBounds = maxSubProj;
+        lowerBounds[level] = std::max(lowerBounds[level], (*levelCutoffs)[level] + 1);
+        return lowerBounds;
+    };
+    LevelCutoffs cutoffs;
+    if (levelCutoffs)
+    {
+        cutoffs.columns.assign(maxRows + 1, nCols + 1);
+        cutoffs.levels.assign(maxRows + 1, 0);
+        cutoffs.maxRows = 0;
+        cutoffs.exceededLevel.store(nLevels);
+        for (unsigned int level = 0; level < nLevels; ++level)
+        {
+            if (maxSubProj[level] > (*levelCutoffs)[level])
+            {
+                return exceeded(level);
+            }
+        }
+        for (unsigned int i = 0; i < nLevel; i++){
+            const unsigned int cols = nCols-(nLevel-1-i);
+            const unsigned int cutoff = (*levelCutoffs)[i+diff];
+            if (cutoff + s > cols){
+                continue; // the t-value is at most cols - s + 1
+            }
+            const unsigned int k = cols - cutoff;
+            if (k > maxRows){
+                return exceeded(i+diff); // the t-value is at least cols - maxRows
+            }
+            if (cols < cutoffs.columns[k]){
+                cutoffs.columns[k] = cols;
+                cutoffs.levels[k] = i+diff;
+            }
+            cutoffs.maxRows = std::max(cutoffs.maxRows, k);
+        }
+    }
+
+    std::vector<unsigned int> smallestFullRankIndices;
+    if (singleWalk)
+    {
+        smallestFullRankIndices = smallest_full_rank_indices(baseMatrices, maxRows, levelCutoffs ? &cutoffs : nullptr, nLevels);
+        if (levelCutoffs && cutoffs.exceeded(nLevels))
+        {
+            return exceeded(cutoffs.exceededLevel.load());
+        }
+    }
+
+    for (unsigned int k=maxRows; k >= s; k--){
+        unsigned int smallestFullRankIndex = singleWalk ? smallestFullRankIndices[k] : iteration_on_k(baseMatrices, k, verbose-1);
         if (smallestFullRankIndex == nCols){
             continue;
         }
@@ -150,6 +695,17 @@ std::vector<unsigned int> GaussMethod::computeTValue(std::vector<GeneratingMatri
     return result;
 }
 
+std::vector<unsigned int> GaussMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxSubProj, int verbose=0)
+{
+    return multilevel_t_values(baseMatrices, mMin, maxSubProj, nullptr, verbose);
+}
+
+std::vector<unsigned int> GaussMethod::computeBoundedTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxSubProj,
+                                                            const std::vector<unsigned int>& cutoffs, int verbose)
+{
+    return multilevel_t_values(baseMatrices, 0, maxSubProj, &cutoffs, verbose);
+}
+
 }
  
 
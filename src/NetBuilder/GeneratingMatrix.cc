@@ -15,11 +15,21 @@
 // limitations under the License.
 
 #include "netbuilder/GeneratingMatrix.h"
+#include "latbuilder/CpuDispatch.h"
 
 #include <algorithm>
+#include <array>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__BMI2__) || (LATNETBUILDER_CPU_DISPATCH_ENABLED && defined(__x86_64__))
+#include <immintrin.h>
+#endif
 
 namespace NetBuilder {
 
+constexpr unsigned int GeneratingMatrix::maxPackedCols;
+
 GeneratingMatrix::GeneratingMatrix(unsigned int nRows, unsigned int nCols):
     m_data(nRows,boost::dynamic_bitset<>(nCols)),
     m_nRows(nRows),
@@ -42,12 +52,44 @@ unsigned int GeneratingMatrix::nCols() const { return m_nCols; }
 
 unsigned int GeneratingMatrix::nRows() const { return m_nRows; }
 
+namespace {
+
+    // transposes in place the 64x64 bit matrix whose row i is block[i], bit j of a row being its element in column j,
+    // by swapping the off-diagonal blocks of sizes 32, 16, ..., 1 with word operations
+    void transposeBlock(GeneratingMatrix::PackedRow (&block)[GeneratingMatrix::maxPackedCols])
+    {
+        GeneratingMatrix::PackedRow mask = 0x00000000FFFFFFFFULL;
+        for (unsigned int j = 32; j != 0; j >>= 1, mask ^= (mask << j))
+        {
+            for (unsigned int k = 0; k < GeneratingMatrix::maxPackedCols; k = ((k | j) + 1) & ~j)
+            {
+                const GeneratingMatrix::PackedRow t = ((block[k] >> j) ^ block[k | j]) & mask;
+                block[k | j] ^= t;
+                block[k] ^= t << j;
+            }
+        }
+    }
+}
+
 std::vector<unsigned long> GeneratingMatrix::getColsReverse() const{
     std::vector<unsigned long> res(nCols(), 0);
+    if (nRows() <= maxPackedCols && nCols() <= maxPackedCols)
+    {
+        // once row i is stored as the row nRows-1-i of a 64x64 block, the columns of the transposed block are the reversed columns
+        PackedRow block[maxPackedCols] = {};
+        for (unsigned int i=0; i<nRows(); i++){
+            block[nRows() - i - 1] = packedRow(i);
+        }
+        transposeBlock(block);
+        for (unsigned int j=0; j<nCols(); j++){
+            res[j] = (unsigned long) block[j];
+        }
+        return res;
+    }
     for (unsigned int j=0; j<nCols(); j++){
         unsigned long s = 0;
         for (unsigned int i=0; i<nRows(); i++){
-            s += (*this)(i, j) << (nRows() - i -1);
+            s += (unsigned long) (*this)(i, j) << (nRows() - i -1);
         }
         res[j] = s;
     }
@@ -55,26 +97,68 @@ std::vector<unsigned long> GeneratingMatrix::getColsReverse() const{
     
 }
 
+void GeneratingMatrix::setColsReverse(const std::vector<unsigned long>& cols){
+    assert(nRows() <= maxPackedCols && nCols() <= maxPackedCols && cols.size() == nCols());
+    // inverse of getColsReverse: the row i is the row nRows-1-i of the transposed block of the columns
+    PackedRow block[maxPackedCols] = {};
+    for (unsigned int j=0; j<nCols(); j++){
+        block[j] = (PackedRow) cols[j];
+    }
+    transposeBlock(block);
+    for (unsigned int i=0; i<nRows(); i++){
+        setPackedRow(i, block[nRows() - i - 1]);
+    }
+}
+
 GeneratingMatrix GeneratingMatrix::fromColsReverse(unsigned int nInputBits, unsigned int nOutputRows, std::vector<unsigned long> columns){
+    for (unsigned int c=0; c<columns.size(); c++){
+        if (nInputBits < 8 * sizeof(unsigned long) && (columns[c] >> nInputBits) != 0){
+            throw std::runtime_error("The column in integer representation " + std::to_string(columns[c]) + " has more than " + std::to_string(nInputBits) + " bits.");
+        }
+    }
+    if (nInputBits <= maxPackedCols && columns.size() <= maxPackedCols && nOutputRows <= nInputBits)
+    {
+        // the row r of the transposed block holds the bits of weight 2^r of the columns, that is the row nInputBits-1-r of the matrix
+        PackedRow block[maxPackedCols] = {};
+        for (unsigned int c=0; c<columns.size(); c++){
+            block[c] = (PackedRow) columns[c];
+        }
+        transposeBlock(block);
+        GeneratingMatrix result(nOutputRows, (unsigned int) columns.size());
+        for (unsigned int row=0; row<nOutputRows; row++){
+            result.setPackedRow(row, block[nInputBits - row - 1]);
+        }
+        return result;
+    }
     GeneratingMatrix result(nInputBits, columns.size());
     for (unsigned int c=0; c<columns.size(); c++){
         unsigned long s = columns[c];
-        unsigned long row = nInputBits - 1;
+        unsigned int row = nInputBits;
         while (s > 0){
+            row -= 1;
             if (s % 2 == 1){
-                if (row < 0){
-                    throw std::runtime_error("The column in integer representation " + std::to_string(columns[c]) + "has more than " + std::to_string(nInputBits) + " bits.");
-                }
                 result(row, c) = 1;
             }
             s = s / 2;
-            row -= 1;
         }
     }
     return result.subMatrix(0, 0, nOutputRows, columns.size());
     
 }
 
+GeneratingMatrix GeneratingMatrix::fromPackedColumns(unsigned int nRows, unsigned int nCols, const PackedRow* columns){
+    assert(nRows <= maxPackedCols && nCols <= maxPackedCols);
+    // the row i of the transposed block holds the bits of weight 2^i of the columns
+    PackedRow block[maxPackedCols] = {};
+    std::copy(columns, columns + nCols, block);
+    transposeBlock(block);
+    GeneratingMatrix result(nRows, nCols);
+    for (unsigned int i=0; i<nRows; i++){
+        result.setPackedRow(i, block[i]);
+    }
+    return result;
+}
+
 GeneratingMatrix::Row GeneratingMatrix::operator[](unsigned int i) const
 {
     return m_data[i];
@@ -85,6 +169,33 @@ GeneratingMatrix::Row& GeneratingMatrix::operator[](unsigned int i)
     return m_data[i];
 }
 
+GeneratingMatrix::PackedRow GeneratingMatrix::packedRow(unsigned int i) const
+{
+    assert(m_nCols <= maxPackedCols);
+    const Row& row = m_data[i];
+    if (sizeof(unsigned long) >= sizeof(PackedRow))
+    {
+        return (PackedRow) row.to_ulong();
+    }
+    PackedRow res = 0;
+    for (Row::size_type j = row.find_first(); j != Row::npos; j = row.find_next(j))
+    {
+        res |= PackedRow(1) << j;
+    }
+    return res;
+}
+
+void GeneratingMatrix::setPackedRow(unsigned int i, PackedRow row)
+{
+    assert(m_nCols <= maxPackedCols);
+    Row& res = m_data[i];
+    res.reset();
+    for (row &= lowBitsMask(m_nCols); row; row &= row - 1)
+    {
+        res.set(lowestSetBit(row));
+    }
+}
+
 bool GeneratingMatrix::operator()(unsigned int i, unsigned j) const
 {
     return m_data[i][j];
@@ -171,28 +282,86 @@ std::ostream& operator<<(std::ostream& os, const GeneratingMatrix& mat)
 
 std::string GeneratingMatrix::formatToColumnsReverse(unsigned int nBits) const
 {
-    const std::vector<unsigned long> columns =  getColsReverse();
-    std::string res;
-    for(unsigned int i = 0; i < (unsigned int) nCols(); ++i)
+    std::ostringstream stream;
+    formatToColumnsReverse(stream, nBits);
+    return stream.str();
+}
+
+void GeneratingMatrix::formatToColumnsReverse(std::ostream& os, unsigned int nBits) const
+{
+    const std::vector<unsigned long> columns = getColsReverse();
+    for(unsigned int j = 0; j < nCols(); ++j)
     {
-        res += std::to_string(columns[i] << (nBits - nRows())) + " ";
+        if (j > 0)
+        {
+            os << ' ';
+        }
+        os << (columns[j] << (nBits - nRows()));
     }
-    res.pop_back();
-    return res;
 }
 
 GeneratingMatrix GeneratingMatrix::operator*(const GeneratingMatrix& m) const
 {
     assert ((*this).nCols() == m.nRows());
-    GeneratingMatrix res(nRows(),m.nCols());
 
-    for (unsigned int i=0; i<(*this).nRows(); i++){
-        for (unsigned int j=0; j<(*this).nCols(); j++){
-            if ((*this)(i, j)){
-                res[i] ^= m[j];
+    if (nCols() <= maxPackedCols && m.nCols() <= maxPackedCols)
+    {
+        if (nRows() >= RightMultiplier::chunkSize) // the tables pay for themselves
+        {
+            return RightMultiplier(m).leftMultiply(*this);
+        }
+        // row i of the product is the XOR of the rows of m selected by the bits of row i
+        GeneratingMatrix res(nRows(),m.nCols());
+        for (unsigned int i = 0; i < nRows(); ++i)
+        {
+            PackedRow acc = 0;
+            for (PackedRow selected = packedRow(i); selected; selected &= selected - 1)
+            {
+                acc ^= m.packedRow(lowestSetBit(selected));
             }
+            res.setPackedRow(i, acc);
+        }
+        return res;
+    }
+
+    GeneratingMatrix res(nRows(),m.nCols());
+    for (unsigned int i = 0; i < nRows(); ++i)
+    {
+        const Row& row = m_data[i];
+        for (Row::size_type j = row.find_first(); j != Row::npos; j = row.find_next(j))
+        {
+            res.m_data[i] ^= m.m_data[j];
+        }
+    }
+    return res;
+}
+
+RightMultiplier::RightMultiplier(const GeneratingMatrix& matrix):
+    m_nRows(matrix.nRows()),
+    m_nCols(matrix.nCols())
+{
+    assert(m_nRows <= GeneratingMatrix::maxPackedCols && m_nCols <= GeneratingMatrix::maxPackedCols);
+    const unsigned int nChunks = (m_nRows + chunkBits - 1) / chunkBits;
+    for (unsigned int chunk = 0; chunk < nChunks; ++chunk)
+    {
+        PackedRow* table = m_tables.data() + chunk * chunkSize;
+        table[0] = 0;
+        for (unsigned int subset = 1; subset < chunkSize; ++subset)
+        {
+            const unsigned int row = chunk * chunkBits + lowestSetBit(subset);
+            table[subset] = table[subset & (subset - 1)] ^ (row < m_nRows ? matrix.packedRow(row) : 0);
         }
     }
+}
+
+GeneratingMatrix RightMultiplier::leftMultiply(const GeneratingMatrix& left) const
+{
+    assert(left.nCols() == m_nRows);
+    GeneratingMatrix res(left.nRows(), m_nCols);
+    for (unsigned int i = 0; i < left.nRows(); ++i)
+    {
+        res.setPackedRow(i, multiplyRow(left.packedRow(i)));
+    }
     return res;
 }
 
@@ -208,4 +377,95 @@ void GeneratingMatrix::stackRight(const GeneratingMatrix& block)
     }
 }
 
-}
\ No newline at end of file
+namespace {
+
+    constexpr unsigned int maxTabulatedFactor = 9; // the 8 digits of a byte span at most 64 digits
+
+    // interlaced bytes: the digit t of byte b, first digit in the most significant bit, at digit t * factor of a word
+    typedef std::array<GeneratingMatrix::PackedRow, 256> ByteTable;
+
+    const ByteTable& interlacedBytes(unsigned int factor)
+    {
+        static const std::array<ByteTable, maxTabulatedFactor> tables = [] {
+            std::array<ByteTable, maxTabulatedFactor> result;
+            for (unsigned int d = 1; d <= maxTabulatedFactor; ++d)
+            {
+                for (unsigned int b = 0; b < 256; ++b)
+                {
+                    GeneratingMatrix::PackedRow word = 0;
+                    for (unsigned int t = 0; t < 8; ++t)
+                    {
+                        if ((b >> (7 - t)) & 1)
+                        {
+                            word |= GeneratingMatrix::PackedRow(1) << (63 - t * d);
+                        }
+                    }
+                    result[d - 1][b] = word;
+                }
+            }
+            return result;
+        }();
+        return tables[factor - 1];
+    }
+
+#if defined(__BMI2__) || (LATNETBUILDER_CPU_DISPATCH_ENABLED && defined(__x86_64__))
+    // interlaceDigits() with the parallel deposit instruction, which the host must support
+    LATNETBUILDER_TARGET("bmi2")
+    GeneratingMatrix::PackedRow depositDigits(GeneratingMatrix::PackedRow digits, unsigned int factor, unsigned int offset)
+    {
+        // mask of the digits r * factor + offset, and number of digits of the coordinate it holds
+        GeneratingMatrix::PackedRow mask = 0;
+        unsigned int count = 0;
+        for (unsigned int digit = offset; digit < GeneratingMatrix::maxPackedCols; digit += factor, ++count)
+        {
+            mask |= GeneratingMatrix::PackedRow(1) << (63 - digit);
+        }
+        // the deposit fills the mask from its lowest bit, which receives the last digit kept
+        return _pdep_u64(digits >> (GeneratingMatrix::maxPackedCols - count), mask);
+    }
+#endif
+}
+
+GeneratingMatrix::PackedRow interlaceDigits(GeneratingMatrix::PackedRow digits, unsigned int factor, unsigned int offset)
+{
+    assert(factor >= 1 && offset < factor);
+    if (factor == 1)
+    {
+        return digits;
+    }
+#if defined(__BMI2__)
+    return depositDigits(digits, factor, offset);
+#else
+#if LATNETBUILDER_CPU_DISPATCH_ENABLED && defined(__x86_64__)
+    if (LatBuilder::cpuSupports(LatBuilder::CpuFeature::BMI2))
+    {
+        return depositDigits(digits, factor, offset);
+    }
+#endif
+    GeneratingMatrix::PackedRow result = 0;
+    if (factor <= maxTabulatedFactor)
+    {
+        const ByteTable& table = interlacedBytes(factor);
+        for (unsigned int i = 0; i < 8; ++i)
+        {
+            const unsigned int shift = 8 * i * factor + offset; // digit of the first digit of byte i
+            if (shift >= GeneratingMatrix::maxPackedCols)
+            {
+                break;
+            }
+            result |= table[(digits >> (56 - 8 * i)) & 0xFF] >> shift;
+        }
+        return result;
+    }
+    for (unsigned int r = 0; r * factor + offset < GeneratingMatrix::maxPackedCols; ++r)
+    {
+        if ((digits >> (63 - r)) & 1)
+        {
+            result |= GeneratingMatrix::PackedRow(1) << (63 - (r * factor + offset));
+        }
+    }
+    return result;
+#endif
+}
+
+}
@@ -26,6 +26,7 @@ Real MaxBinaryOperator::operator()(Real x, Real y){ return (x < y) ? y : x;}
 
 Accumulator::Accumulator(Real initialValue, Real normType):
             m_data(initialValue),
+            m_isSum(normType < std::numeric_limits<Real>::infinity()),
             m_op(realToBinOp(normType))
 {};
 
@@ -37,6 +38,18 @@ Real Accumulator::tryAccumulate(Real weight, Real value, Real power) const {
     return m_op(weight*std::pow(value,power), m_data);
 }
 
+Real Accumulator::maxAccumulableValue(Real weight, Real bound) const {
+    if (m_data > bound) // no value can be accumulated
+    {
+        return -std::numeric_limits<Real>::infinity();
+    }
+    if (weight <= 0)
+    {
+        return std::numeric_limits<Real>::infinity();
+    }
+    return (m_isSum ? (bound - m_data) : bound) / weight;
+}
+
 void Accumulator::set(Real value) { m_data = value; }
 
 Real Accumulator::value() const
@@ -147,3 +147,39 @@ const std::vector<unsigned int>& CompositionMaker::currentComposition() const
 {
     return m_composition;
 }
+
+CompositionRowWalker::CompositionRowWalker(unsigned int k, unsigned int s):
+    m_compositionMaker(k, s),
+    m_maxRows(k - s + 1),
+    m_slots(s * m_maxRows, 0),
+    m_lastChange{0, 0, 0}
+{
+    m_initialRows.reserve(k);
+    for(unsigned int i = 0; i < m_maxRows; ++i)
+    {
+        slotOf(1, i) = i;
+        m_initialRows.push_back(SlotRow{i, 1, i});
+    }
+    for(unsigned int j = 2; j <= s; ++j)
+    {
+        slotOf(j, 0) = (unsigned int) m_initialRows.size();
+        m_initialRows.push_back(SlotRow{(unsigned int) m_initialRows.size(), j, 0});
+    }
+}
+
+bool CompositionRowWalker::next()
+{
+    if (!m_compositionMaker.goToNextComposition())
+    {
+        return false;
+    }
+    const auto& change = m_compositionMaker.changeFromPreviousComposition();
+    // the coordinate change.first lost its row of index change.first.second - 1 and 
+    // the coordinate change.second gained its row of index change.second.second - 1
+    const unsigned int slot = slotOf(change.first.first, change.first.second - 1);
+    m_lastChange.slot = slot;
+    m_lastChange.coordinate = change.second.first;
+    m_lastChange.row = change.second.second - 1;
+    slotOf(m_lastChange.coordinate, m_lastChange.row) = slot;
+    return true;
+}
@@ -0,0 +1,115 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/Helpers/EquivalentNetFilter.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace NetBuilder {
+
+namespace {
+
+    typedef GeneratingMatrix::Row Column;
+
+    void appendColumn(std::string& canonicalForm, const Column& column)
+    {
+        std::vector<Column::block_type> blocks(column.num_blocks());
+        boost::to_block_range(column, blocks.begin());
+        canonicalForm.append(reinterpret_cast<const char*>(blocks.data()), blocks.size() * sizeof(Column::block_type));
+    }
+
+}
+
+EquivalentNetFilter::EquivalentNetFilter(EmbeddingType embeddingType):
+    m_embeddingType(embeddingType)
+{}
+
+std::string EquivalentNetFilter::canonicalForm(const AbstractDigitalNet& net) const
+{
+    const unsigned int nCols = net.numColumns();
+
+    // columns of the generating matrices stacked on top of each other
+    Column::size_type height = 0;
+    for(Dimension coord = 0; coord < net.dimension(); ++coord)
+    {
+        height += net.generatingMatrix(coord).nRows();
+    }
+    std::vector<Column> columns(nCols, Column(height));
+    Column::size_type offset = 0;
+    for(Dimension coord = 0; coord < net.dimension(); ++coord)
+    {
+        const GeneratingMatrix& matrix = net.generatingMatrix(coord);
+        for(unsigned int i = 0; i < matrix.nRows(); ++i)
+        {
+            const GeneratingMatrix::Row row = matrix[i];
+            for(auto j = row.find_first(); j != GeneratingMatrix::Row::npos && j < nCols; j = row.find_next(j))
+            {
+                columns[j].set(offset + i);
+            }
+        }
+        offset += matrix.nRows();
+    }
+
+    // reduced echelon basis of the span of the columns seen so far: each vector is the only one with a bit at its pivot,
+    // which is its lowest set bit
+    std::vector<std::pair<Column::size_type, Column>> basis;
+    std::string canonicalForm;
+    for(Column& column : columns)
+    {
+        for(const auto& vector : basis)
+        {
+            if (column[vector.first])
+            {
+                column ^= vector.second;
+            }
+        }
+        if (m_embeddingType == EmbeddingType::MULTILEVEL)
+        {
+            appendColumn(canonicalForm, column); // the same for all the columns equal modulo the previous ones
+        }
+        const auto pivot = column.find_first();
+        if (pivot != Column::npos)
+        {
+            for(auto& vector : basis) // the pivots of the other vectors are below the pivot of the column
+            {
+                if (vector.second[pivot])
+                {
+                    vector.second ^= column;
+                }
+            }
+            basis.emplace_back(pivot, std::move(column));
+        }
+    }
+
+    if (m_embeddingType == EmbeddingType::UNILEVEL)
+    {
+        std::sort(basis.begin(), basis.end(), [](const std::pair<Column::size_type, Column>& a, const std::pair<Column::size_type, Column>& b) { return a.first < b.first; });
+        for(const auto& vector : basis)
+        {
+            appendColumn(canonicalForm, vector.second);
+        }
+    }
+    return canonicalForm;
+}
+
+bool EquivalentNetFilter::seen(const AbstractDigitalNet& net)
+{
+    return !m_canonicalForms.insert(canonicalForm(net)).second;
+}
+
+}
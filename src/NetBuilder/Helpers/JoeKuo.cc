@@ -17,10 +17,15 @@
 
 #include "netbuilder/Helpers/JoeKuo.h"
 #include "netbuilder/Helpers/Path.h"
+#include "latbuilder/MappedTable.h"
 #include <cmath>
+#include <cstdint>
 
 #include <string>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 
@@ -72,13 +77,60 @@ inline std::string& trim(std::string& s, const char* t = ws)
       return ltrim(rtrim(s, t), t);
 }    
 
-std::vector<std::vector<uInteger>> readJoeKuoDirectionNumbers(Dimension dimension)
-{
-      assert(dimension >= 1 && dimension <= 21201);
-      std::string path = PATH_TO_LATNETBUILDER_DIR + "/../share/latnetbuilder/data/JoeKuoSobolNets.csv";
-      std::vector<std::vector<uInteger>> res(dimension);
-      if (boost::filesystem::exists(path)){
-            std::ifstream file(path);
+namespace {
+      /**
+       * Direction numbers of the whole data file, mapped from its binary table
+       * if it was generated, or parsed from the CSV file otherwise.
+       */
+      struct JoeKuoTable {
+            std::unique_ptr<LatBuilder::MappedTable> mapped;
+            std::vector<std::vector<uInteger>> parsed;
+
+            size_t size() const
+            { return mapped ? mapped->size() : parsed.size(); }
+
+            std::vector<uInteger> row(size_t i) const
+            {
+                  if (!mapped)
+                  {
+                        return parsed[i];
+                  }
+                  const std::uint64_t* values = mapped->row(i);
+                  return std::vector<uInteger>(values, values + mapped->rowSize(i));
+            }
+      };
+
+      /**
+       * Returns the direction numbers of the whole data file, which is mapped or
+       * read only once per process (and again only if the data folder changes).
+       * The table is never modified once built, so that it can be used by concurrent
+       * tasks while another one loads the table of a new data folder.
+       */
+      std::shared_ptr<const JoeKuoTable> joeKuoTable()
+      {
+            static std::mutex mutex;
+            static std::string tablePath;
+            static std::shared_ptr<const JoeKuoTable> cached;
+
+            std::string path = GET_PATH_TO_LATNETBUILDER_DIR() + "/../share/latnetbuilder/data/JoeKuoSobolNets";
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cached && path == tablePath){
+                  return cached;
+            }
+
+            auto mapped = LatBuilder::MappedTable::open(path + ".bin");
+            if (!mapped && !boost::filesystem::exists(path + ".csv")){
+                  throw runtime_error("Unable to locate data folder. The value of PATH_TO_LATNETBUILDER_DIR is probably incorrect. See netbuilder/Path.h.");
+            }
+            auto table = std::make_shared<JoeKuoTable>();
+            table->mapped = std::move(mapped);
+            if (table->mapped){
+                  tablePath = path;
+                  cached = std::move(table);
+                  return cached;
+            }
+
+            std::ifstream file(path + ".csv");
             std::string sent;
 
             do
@@ -90,25 +142,31 @@ std::vector<std::vector<uInteger>> readJoeKuoDirectionNumbers(Dimension dimensio
 
             getline(file,sent);
 
-            for(unsigned int i = 1; i <= dimension; ++i)
+            while (getline(file,sent))
             {
-                  if(getline(file,sent))
-                  {
-                        std::vector<std::string> fields;
-                        boost::split( fields, sent, boost::is_any_of( ";" ) );
-                        for( const auto& token : fields)
-                        {
-                              res[i-1].push_back(std::stol(token));
-                        }
-                  }
-                  else
+                  std::vector<std::string> fields;
+                  boost::split( fields, sent, boost::is_any_of( ";" ) );
+                  std::vector<uInteger> row;
+                  for( const auto& token : fields)
                   {
-                        break;
+                        row.push_back(std::stol(token));
                   }
+                  table->parsed.push_back(std::move(row));
             }
+            tablePath = path;
+            cached = std::move(table);
+            return cached;
       }
-      else{
-            throw runtime_error("Unable to locate data folder. The value of PATH_TO_LATNETBUILDER_DIR is probably incorrect. See netbuilder/Path.h.");
+}
+
+std::vector<std::vector<uInteger>> readJoeKuoDirectionNumbers(Dimension dimension)
+{
+      assert(dimension >= 1 && dimension <= 21201);
+      const auto table = joeKuoTable();
+      std::vector<std::vector<uInteger>> res(dimension);
+      for(unsigned int i = 0; i < dimension && i < table->size(); ++i)
+      {
+            res[i] = table->row(i);
       }
       return res;
 }
@@ -124,16 +182,36 @@ std::vector<DirectionNumbers> getJoeKuoDirectionNumbers(Dimension dimension)
       return genVals;
 }
 
+namespace {
+      /**
+       * Returns a Joe-Kuo Sobol' net of dimension at least \c dimension with generating matrices of size \c size.
+       * The nets are cached by data folder and size for the whole process, and rebuilt only for larger dimensions,
+       * so that the generating matrices of the standard direction numbers are computed once. The cached nets are
+       * never modified: a larger net replaces the smaller one, which stays valid for the tasks still using it.
+       */
+      std::shared_ptr<const DigitalNet<NetConstruction::SOBOL>> cachedJoeKuoSobolNet(Dimension dimension, MatrixSize size)
+      {
+            static std::mutex mutex;
+            static std::map<std::pair<std::string, MatrixSize>, std::shared_ptr<const DigitalNet<NetConstruction::SOBOL>>> nets;
+
+            const auto key = std::make_pair(GET_PATH_TO_LATNETBUILDER_DIR(), size);
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& net = nets[key];
+            if (!net || net->dimension() < dimension){
+                  net = std::make_shared<const DigitalNet<NetConstruction::SOBOL>>(dimension, size, getJoeKuoDirectionNumbers(dimension));
+            }
+            return net;
+      }
+}
+
 DigitalNet<NetConstruction::SOBOL> createJoeKuoSobolNet(Dimension dimension, MatrixSize size)
 {
-      auto genVals = getJoeKuoDirectionNumbers(dimension);
-      return DigitalNet<NetConstruction::SOBOL>(dimension, size, std::move(genVals));
+      return std::move(*createPtrToJoeKuoSobolNet(dimension, size));
 }
 
 std::unique_ptr<DigitalNet<NetConstruction::SOBOL>> createPtrToJoeKuoSobolNet(Dimension dimension, MatrixSize size)
 {
-      auto genVals = getJoeKuoDirectionNumbers(dimension);
-      return std::make_unique<DigitalNet<NetConstruction::SOBOL>>(dimension, size, std::move(genVals));
+      return cachedJoeKuoSobolNet(dimension, size)->restriction(dimension);
 }
 
 }} // namespace
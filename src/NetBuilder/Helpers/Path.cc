@@ -18,6 +18,7 @@
 #include <boost/filesystem.hpp>
 #include <cstdio>
 #include <array>
+#include <mutex>
 #include <stdexcept>
 
 namespace NetBuilder{
@@ -34,7 +35,28 @@ namespace NetBuilder{
         return result;
     }
 
-    std::string PATH_TO_LATNETBUILDER_DIR = ".";
+    namespace {
+        std::mutex pathMutex;
+        std::string PATH_TO_LATNETBUILDER_DIR = ".";
+
+        void checkPath(const std::string& path)
+        {
+            if(!boost::filesystem::exists(path + "/latnetbuilder" ))
+            {  
+                throw std::runtime_error("The path to the latnetbuilder executable is not correctly set.");
+            }
+            if(!boost::filesystem::exists(path + "/../share/latnetbuilder/data" ))
+            {  
+                throw std::runtime_error("The path to the latnetbuilder executable is not correctly set. 'share/latnebuilder/data' is missing");
+            }
+        }
+    }
+
+    std::string GET_PATH_TO_LATNETBUILDER_DIR()
+    {
+        std::lock_guard<std::mutex> lock(pathMutex);
+        return PATH_TO_LATNETBUILDER_DIR;
+    }
 
     void SET_PATH_TO_LATNETBUILDER_DIR_FROM_PROGRAM_NAME(const char* argv0)
     {
@@ -61,20 +83,14 @@ namespace NetBuilder{
 
     void SET_PATH_TO_LATNETBUILDER_DIR(const std::string& path)
     {
+        checkPath(path);
+        std::lock_guard<std::mutex> lock(pathMutex);
         PATH_TO_LATNETBUILDER_DIR = path;
-        CHECK_PATH_TO_LATNETBUILDER_DIR();
     }
 
     void CHECK_PATH_TO_LATNETBUILDER_DIR()
     {
-        if(!boost::filesystem::exists(PATH_TO_LATNETBUILDER_DIR+ "/latnetbuilder" ))
-        {  
-            throw std::runtime_error("The path to the latnetbuilder executable is not correctly set.");
-        }
-        if(!boost::filesystem::exists(PATH_TO_LATNETBUILDER_DIR+ "/../share/latnetbuilder/data" ))
-        {  
-            throw std::runtime_error("The path to the latnetbuilder executable is not correctly set. 'share/latnebuilder/data' is missing");
-        }
+        checkPath(GET_PATH_TO_LATNETBUILDER_DIR());
     }
 
 }
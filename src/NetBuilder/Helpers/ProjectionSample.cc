@@ -0,0 +1,123 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/Helpers/ProjectionSample.h"
+#include "netbuilder/Helpers/Projection.h"
+
+#include "latbuilder/LFSR258.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+namespace NetBuilder {
+
+ProjectionSample::ProjectionSample():
+    m_coord(Projection::npos),
+    m_sampleSize(0),
+    m_totalWeight(0),
+    m_exact(false)
+{}
+
+void ProjectionSample::draw(Dimension coord, const std::vector<Real>& weights, size_t sampleSize)
+{
+    m_coord = coord;
+    m_sampleSize = sampleSize;
+    m_indices.clear();
+    m_factors.clear();
+
+    std::vector<Real> cumulative(weights.size());
+    Real total = 0;
+    for (size_t i = 0; i < weights.size(); ++i)
+    {
+        total += weights[i];
+        cumulative[i] = total;
+    }
+    m_totalWeight = total;
+
+    m_exact = sampleSize >= weights.size();
+    if (m_exact)
+    {
+        for (size_t i = 0; i < weights.size(); ++i)
+        {
+            if (weights[i] != 0.0)
+            {
+                m_indices.push_back(i);
+                m_factors.push_back(weights[i]);
+            }
+        }
+        return;
+    }
+    if (total <= 0)
+    {
+        return;
+    }
+
+    LatBuilder::LFSR258 rng(LatBuilder::LFSR258::default_seed);
+    for (Dimension j = 0; j < coord; ++j)
+    {
+        rng.nextStream();
+    }
+
+    std::map<size_t, size_t> draws;
+    for (size_t k = 0; k < sampleSize; ++k)
+    {
+        const Real u = std::ldexp(Real(rng() >> 11), -53) * total;
+        const size_t i = std::min<size_t>(std::upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin(), weights.size() - 1);
+        ++draws[i];
+    }
+    for (const auto& draw : draws)
+    {
+        m_indices.push_back(draw.first);
+        m_factors.push_back(Real(draw.second));
+    }
+}
+
+MeritEstimate ProjectionSample::estimate(const std::vector<Real>& values, Real zScore) const
+{
+    if (m_exact)
+    {
+        Real sum = 0;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            sum += m_factors[i] * values[i];
+        }
+        return MeritEstimate{sum, 0};
+    }
+    if (m_indices.empty())
+    {
+        return MeritEstimate{0, 0};
+    }
+
+    Real sum = 0;
+    Real sumSquares = 0;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        sum += m_factors[i] * values[i];
+        sumSquares += m_factors[i] * values[i] * values[i];
+    }
+    const Real K = Real(m_sampleSize);
+    const Real mean = sum / K;
+    if (m_sampleSize < 2)
+    {
+        return MeritEstimate{m_totalWeight * mean, std::numeric_limits<Real>::infinity()};
+    }
+    const Real variance = std::max<Real>(sumSquares - K * mean * mean, 0) / (K - 1);
+    return MeritEstimate{m_totalWeight * mean, zScore * m_totalWeight * std::sqrt(variance / K)};
+}
+
+}
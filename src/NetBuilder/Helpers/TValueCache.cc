@@ -0,0 +1,231 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/Helpers/TValueCache.h"
+#include "latbuilder/Profiler.h"
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+
+namespace NetBuilder{
+
+namespace {
+
+    typedef std::vector<uint64_t> Key; // sizes and bits of the matrices
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const { return boost::hash_range(key.begin(), key.end()); }
+    };
+
+    struct Entry
+    {
+        std::vector<unsigned int> multilevel; // t-values of each level, empty if they were not computed
+        unsigned int unilevel; // t-value of the last level
+    };
+
+    struct State
+    {
+        std::mutex mutex;
+        std::atomic<size_t> capacity{0};
+        std::list<Key> order; // keys of the entries, oldest first
+        std::unordered_map<Key, Entry, KeyHash> entries;
+    };
+
+    State& state()
+    {
+        static State instance;
+        return instance;
+    }
+
+    Key makeKey(const std::vector<GeneratingMatrix>& matrices)
+    {
+        Key key;
+        key.push_back(matrices.size());
+        for(const auto& matrix : matrices)
+        {
+            key.push_back(matrix.nRows());
+            key.push_back(matrix.nCols());
+            for(unsigned int i = 0; i < matrix.nRows(); ++i)
+            {
+                if (matrix.nCols() <= GeneratingMatrix::maxPackedCols)
+                {
+                    key.push_back(matrix.packedRow(i));
+                    continue;
+                }
+                for(unsigned int j = 0; j < matrix.nCols(); j += GeneratingMatrix::maxPackedCols)
+                {
+                    uint64_t word = 0;
+                    for(unsigned int b = 0; b < GeneratingMatrix::maxPackedCols && j + b < matrix.nCols(); ++b)
+                    {
+                        word |= uint64_t(matrix(i, j + b)) << b;
+                    }
+                    key.push_back(word);
+                }
+            }
+        }
+        return key;
+    }
+
+    // must be called with the mutex locked
+    Entry& insert(State& s, Key&& key)
+    {
+        auto res = s.entries.emplace(key, Entry());
+        if (res.second)
+        {
+            s.order.push_back(std::move(key));
+            while (s.entries.size() > s.capacity && s.order.size() > 1)
+            {
+                s.entries.erase(s.order.front());
+                s.order.pop_front();
+            }
+        }
+        return res.first->second;
+    }
+}
+
+std::vector<unsigned int> TValueCache::multilevel(const std::vector<GeneratingMatrix>& matrices, const std::function<std::vector<unsigned int>()>& compute)
+{
+    auto& s = state();
+    if (s.capacity == 0)
+    {
+        return compute();
+    }
+
+    Key key = makeKey(matrices);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.entries.find(key);
+        if (it != s.entries.end() && !it->second.multilevel.empty())
+        {
+            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::TVALUE_CACHE_HITS);
+            return it->second.multilevel;
+        }
+    }
+    LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::TVALUE_CACHE_MISSES);
+
+    // computed without holding the lock: concurrent requests for the same projection may compute it more than once
+    std::vector<unsigned int> tValues = compute();
+    if (!tValues.empty())
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        Entry& entry = insert(s, std::move(key));
+        entry.multilevel = tValues;
+        entry.unilevel = tValues.back();
+    }
+    return tValues;
+}
+
+unsigned int TValueCache::unilevel(const std::vector<GeneratingMatrix>& matrices, const std::function<unsigned int()>& compute)
+{
+    auto& s = state();
+    if (s.capacity == 0)
+    {
+        return compute();
+    }
+
+    Key key = makeKey(matrices);
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        auto it = s.entries.find(key);
+        if (it != s.entries.end())
+        {
+            LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::TVALUE_CACHE_HITS);
+            return it->second.unilevel;
+        }
+    }
+    LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::TVALUE_CACHE_MISSES);
+
+    unsigned int tValue = compute();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    insert(s, std::move(key)).unilevel = tValue;
+    return tValue;
+}
+
+bool TValueCache::findUnilevel(const std::vector<GeneratingMatrix>& matrices, unsigned int& tValue)
+{
+    auto& s = state();
+    if (s.capacity == 0)
+    {
+        return false;
+    }
+
+    Key key = makeKey(matrices);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.entries.find(key);
+    if (it == s.entries.end())
+    {
+        return false;
+    }
+    tValue = it->second.unilevel;
+    return true;
+}
+
+bool TValueCache::findMultilevel(const std::vector<GeneratingMatrix>& matrices, std::vector<unsigned int>& tValues)
+{
+    auto& s = state();
+    if (s.capacity == 0)
+    {
+        return false;
+    }
+
+    Key key = makeKey(matrices);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.entries.find(key);
+    if (it == s.entries.end() || it->second.multilevel.empty())
+    {
+        return false;
+    }
+    tValues = it->second.multilevel;
+    return true;
+}
+
+void TValueCache::setCapacity(size_t numEntries)
+{
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.capacity = numEntries;
+    while (s.entries.size() > numEntries)
+    {
+        s.entries.erase(s.order.front());
+        s.order.pop_front();
+    }
+}
+
+bool TValueCache::enabled()
+{
+    return state().capacity > 0;
+}
+
+size_t TValueCache::capacity()
+{
+    return state().capacity;
+}
+
+void TValueCache::clear()
+{
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.entries.clear();
+    s.order.clear();
+}
+
+}
@@ -0,0 +1,254 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/Helpers/TValueProfile.h"
+#include "netbuilder/FigureOfMerit/TValueComputation.h"
+#include "netbuilder/Helpers/TValueCache.h"
+
+#include "latbuilder/ThreadPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace NetBuilder {
+
+namespace {
+
+    const char binaryMagic[4] = {'L', 'N', 'B', 'T'};
+
+    void writeWord(std::ostream& os, uint32_t value)
+    {
+        unsigned char bytes[4];
+        for (unsigned int k = 0; k < 4; ++k)
+        {
+            bytes[k] = (unsigned char) (value >> (8 * k));
+        }
+        os.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    }
+
+    uint32_t readWord(std::istream& is)
+    {
+        unsigned char bytes[4] = {};
+        is.read(reinterpret_cast<char*>(bytes), sizeof(bytes));
+        return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+    }
+
+    /**
+     * Appends to \c entries the t-values of the descendants of the projection \c projection of \c net, in prefix order.
+     * \c matrices holds the generating matrices of \c projection, whose highest coordinate is \c highest and whose t-value is \c tValue,
+     * and \c oneDimTValues holds the t-values of the one-dimensional projections.
+     */
+    void extendProjection(const AbstractDigitalNet& net, Dimension maxOrder, const std::vector<unsigned int>& oneDimTValues,
+                          Projection& projection, Dimension highest, unsigned int tValue,
+                          std::vector<const GeneratingMatrix*>& matrices, std::vector<TValueProfile::Entry>& entries)
+    {
+        if (matrices.size() >= maxOrder)
+        {
+            return;
+        }
+
+        // the rows of the projection are reduced once for all its children
+        GaussMethod::Reduction reduction;
+        if (GaussMethod::Reduction::fits(matrices))
+        {
+            reduction = GaussMethod::Reduction(matrices);
+        }
+
+        for (Dimension coord = highest + 1; coord < net.dimension(); ++coord)
+        {
+            const GeneratingMatrix& newMatrix = net.generatingMatrix(coord);
+            const unsigned int maxTValuesSubProj = std::max(tValue, oneDimTValues[coord]);
+            unsigned int childTValue;
+            if (reduction.valid())
+            {
+                childTValue = GaussMethod::computeBoundedTValue(reduction, newMatrix, maxTValuesSubProj, std::numeric_limits<unsigned int>::max());
+            }
+            else
+            {
+                std::vector<GeneratingMatrix> baseMatrices;
+                for (const GeneratingMatrix* matrix : matrices)
+                {
+                    baseMatrices.push_back(*matrix);
+                }
+                baseMatrices.push_back(newMatrix);
+                childTValue = GaussMethod::computeTValue(std::move(baseMatrices), maxTValuesSubProj, 0);
+            }
+
+            projection.insert(coord);
+            matrices.push_back(&newMatrix);
+            entries.push_back({projection, childTValue});
+            extendProjection(net, maxOrder, oneDimTValues, projection, coord, childTValue, matrices, entries);
+            matrices.pop_back();
+            projection.erase(coord);
+        }
+    }
+
+}
+
+constexpr uint32_t TValueProfile::binaryVersion;
+
+TValueProfile::TValueProfile(const AbstractDigitalNet& net, Dimension maxOrder):
+    m_dimension(net.dimension()),
+    m_maxOrder(maxOrder)
+{
+    if (maxOrder == 0)
+    {
+        throw std::invalid_argument("the largest order of the t-value profile must be positive");
+    }
+
+    const Dimension dimension = net.dimension();
+    auto& pool = LatBuilder::ThreadPool::global();
+
+    std::vector<unsigned int> oneDimTValues(dimension);
+    pool.parallelFor(dimension, [&net, &oneDimTValues](unsigned int, size_t coord)
+        {
+            oneDimTValues[coord] = GaussMethod::computeTValue({net.generatingMatrix((Dimension) coord)}, 0, 0);
+        });
+
+    // the tree of each first coordinate is enumerated by a single worker, and the trees are concatenated in order
+    std::vector<std::vector<Entry>> trees(dimension);
+    pool.parallelFor(dimension, [&](unsigned int, size_t first)
+        {
+            const Dimension coord = (Dimension) first;
+            Projection projection;
+            projection.insert(coord);
+            std::vector<const GeneratingMatrix*> matrices{&net.generatingMatrix(coord)};
+            trees[coord].push_back({projection, oneDimTValues[coord]});
+            extendProjection(net, maxOrder, oneDimTValues, projection, coord, oneDimTValues[coord], matrices, trees[coord]);
+        });
+
+    for (auto& tree : trees)
+    {
+        m_entries.insert(m_entries.end(), std::make_move_iterator(tree.begin()), std::make_move_iterator(tree.end()));
+    }
+}
+
+void TValueProfile::write(std::ostream& os) const
+{
+    for (const Entry& entry : m_entries)
+    {
+        bool first = true;
+        for (auto coord : entry.projection)
+        {
+            os << (first ? "" : ",") << coord + 1;
+            first = false;
+        }
+        os << ": " << entry.tValue << std::endl;
+    }
+}
+
+void TValueProfile::write(const std::string& fileName) const
+{
+    std::ofstream file(fileName);
+    if (!file)
+    {
+        throw std::runtime_error("cannot write the t-value profile to " + fileName);
+    }
+    write(file);
+}
+
+void TValueProfile::writeBinary(const std::string& fileName) const
+{
+    std::ofstream file(fileName, std::ios::binary);
+    if (!file)
+    {
+        throw std::runtime_error("cannot write the t-value profile to " + fileName);
+    }
+    file.write(binaryMagic, sizeof(binaryMagic));
+    writeWord(file, binaryVersion);
+    writeWord(file, (uint32_t) m_dimension);
+    writeWord(file, (uint32_t) m_maxOrder);
+    const uint64_t numEntries = m_entries.size();
+    writeWord(file, (uint32_t) numEntries);
+    writeWord(file, (uint32_t) (numEntries >> 32));
+    for (const Entry& entry : m_entries)
+    {
+        writeWord(file, (uint32_t) entry.projection.size());
+        for (auto coord : entry.projection)
+        {
+            writeWord(file, (uint32_t) coord);
+        }
+        writeWord(file, entry.tValue);
+    }
+    if (!file)
+    {
+        throw std::runtime_error("cannot write the t-value profile to " + fileName);
+    }
+}
+
+TValueProfile TValueProfile::readBinary(const std::string& fileName)
+{
+    std::ifstream file(fileName, std::ios::binary);
+    char magic[sizeof(binaryMagic)] = {};
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, binaryMagic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error(fileName + " is not a binary t-value profile");
+    }
+    const uint32_t version = readWord(file);
+    if (version != binaryVersion)
+    {
+        throw std::runtime_error("unknown version " + std::to_string(version) + " of the binary t-value profile " + fileName);
+    }
+    TValueProfile profile;
+    profile.m_dimension = readWord(file);
+    profile.m_maxOrder = readWord(file);
+    const uint64_t numEntries = (uint64_t) readWord(file) | ((uint64_t) readWord(file) << 32);
+    for (uint64_t i = 0; i < numEntries && file; ++i)
+    {
+        Entry entry;
+        const uint32_t order = readWord(file);
+        for (uint32_t k = 0; k < order && file; ++k)
+        {
+            const uint32_t coord = readWord(file);
+            if (coord >= profile.m_dimension)
+            {
+                throw std::runtime_error("corrupted binary t-value profile " + fileName);
+            }
+            entry.projection.insert(coord);
+        }
+        entry.tValue = readWord(file);
+        profile.m_entries.push_back(std::move(entry));
+    }
+    if (!file)
+    {
+        throw std::runtime_error("truncated binary t-value profile " + fileName);
+    }
+    return profile;
+}
+
+void TValueProfile::fillCache(const AbstractDigitalNet& net) const
+{
+    if (net.dimension() != m_dimension)
+    {
+        throw std::invalid_argument("the t-value profile is not that of a net of dimension " + std::to_string(net.dimension()));
+    }
+    for (const Entry& entry : m_entries)
+    {
+        std::vector<GeneratingMatrix> matrices;
+        for (auto coord : entry.projection)
+        {
+            matrices.push_back(net.generatingMatrix(coord));
+        }
+        const unsigned int tValue = entry.tValue;
+        TValueCache::unilevel(matrices, [tValue]() { return tValue; });
+    }
+}
+
+}
@@ -0,0 +1,96 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/Helpers/WeightTable.h"
+
+#include "latbuilder/CombinedWeights.h"
+
+#include "latticetester/OrderDependentWeights.h"
+#include "latticetester/ProductWeights.h"
+#include "latticetester/PODWeights.h"
+#include "latticetester/ProjectionDependentWeights.h"
+
+namespace NetBuilder {
+
+namespace {
+
+    void fillOrderWeights(const LatticeTester::OrderDependentWeights& weights, std::vector<Real>& table, Real& defaultWeight)
+    {
+        const size_t size = weights.getSize();
+        for (size_t order = 0; order < size; ++order)
+        {
+            table.push_back(weights.getWeightForOrder(order));
+        }
+        defaultWeight = weights.getWeightForOrder(size); // beyond the given orders
+    }
+
+    void fillCoordinateWeights(const LatticeTester::ProductWeights& weights, std::vector<Real>& table, Real& defaultWeight)
+    {
+        const size_t size = weights.getWeights().size();
+        for (size_t coord = 0; coord < size; ++coord)
+        {
+            table.push_back(weights.getWeightForCoordinate(coord));
+        }
+        defaultWeight = weights.getWeightForCoordinate(size); // beyond the given coordinates
+    }
+}
+
+WeightTable::WeightTable(const LatticeTester::Weights& weights):
+    m_weights(weights),
+    m_kind(Kind::OTHER),
+    m_defaultOrderWeight(0),
+    m_defaultCoordinateWeight(0)
+{
+    // POD weights are tried first, in case they derive from one of the other types
+    if (auto w = dynamic_cast<const LatticeTester::PODWeights*>(&weights))
+    {
+        m_kind = Kind::POD;
+        fillOrderWeights(w->getOrderDependentWeights(), m_orderWeights, m_defaultOrderWeight);
+        fillCoordinateWeights(w->getProductWeights(), m_coordinateWeights, m_defaultCoordinateWeight);
+    }
+    else if (auto w = dynamic_cast<const LatticeTester::OrderDependentWeights*>(&weights))
+    {
+        m_kind = Kind::ORDER_DEPENDENT;
+        fillOrderWeights(*w, m_orderWeights, m_defaultOrderWeight);
+    }
+    else if (auto w = dynamic_cast<const LatticeTester::ProductWeights*>(&weights))
+    {
+        m_kind = Kind::PRODUCT;
+        fillCoordinateWeights(*w, m_coordinateWeights, m_defaultCoordinateWeight);
+    }
+    else if (auto w = dynamic_cast<const LatticeTester::ProjectionDependentWeights*>(&weights))
+    {
+        m_kind = Kind::PROJECTION_DEPENDENT;
+        for (size_t largestIndex = 0; largestIndex < w->getSize(); ++largestIndex)
+        {
+            for (const auto& kv : w->getWeightsForLargestIndex(largestIndex))
+            {
+                m_projectionWeights.emplace(Projection(kv.first), kv.second);
+            }
+        }
+    }
+    else if (auto w = dynamic_cast<const LatBuilder::CombinedWeights*>(&weights))
+    {
+        m_kind = Kind::COMBINED;
+        m_components.reserve(w->list().size());
+        for (const auto& component : w->list())
+        {
+            m_components.emplace_back(*component);
+        }
+    }
+}
+
+}
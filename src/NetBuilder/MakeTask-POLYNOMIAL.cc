@@ -0,0 +1,33 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/MakeTask.h"
+#include "netbuilder/Parser/EmbeddingTypeParser.h"
+
+#include <stdexcept>
+
+namespace NetBuilder{
+
+void netbuilder_make_task_polynomial(const boost::program_options::variables_map& opt, const std::string& outputFolder,
+                                     unsigned int& interlacingFactor, OutputStyle& outputStyle, std::unique_ptr<Task::Task>& task)
+{
+    if (Parser::EmbeddingTypeParser::parse(opt["multilevel"].as<std::string>()) != EmbeddingType::UNILEVEL){
+        throw std::runtime_error("Unknown combination of NetConstruction and EmbeddingType");
+    }
+    task = buildTask<NetConstruction::POLYNOMIAL, EmbeddingType::UNILEVEL>(opt, outputFolder, interlacingFactor, outputStyle);
+}
+
+}
@@ -0,0 +1,76 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "netbuilder/MakeTask.h"
+
+#include <boost/algorithm/string/erase.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace NetBuilder{
+
+std::string resultCacheDescription(const boost::program_options::variables_map& opt)
+{
+  const auto canonical = [](std::string value){
+    boost::algorithm::erase_all(value, " ");
+    return value;
+  };
+  std::ostringstream os;
+  os.precision(std::numeric_limits<Real>::max_digits10);
+  for (const auto name : {"construction", "multilevel", "size-parameter", "exploration-method", "norm-type", "combiner"}){
+    if (opt.count(name) >= 1){
+      os << name << ": " << canonical(opt[name].as<std::string>()) << std::endl;
+    }
+  }
+  for (const auto& figure : opt["figure-of-merit"].as<std::vector<std::string>>()){
+    os << "figure-of-merit: " << canonical(figure) << std::endl;
+  }
+  std::vector<std::string> weights;
+  for (const auto& w : opt["weights"].as<std::vector<std::string>>()){
+    weights.push_back(canonical(w));
+  }
+  std::sort(weights.begin(), weights.end());
+  for (const auto& w : weights){
+    os << "weights: " << w << std::endl;
+  }
+  if (opt.count("weights-power") >= 1){
+    os << "weights-power: " << opt["weights-power"].as<Real>() << std::endl;
+  }
+  os << "interlacing-factor: " << opt["interlacing-factor"].as<unsigned int>() << std::endl;
+  return os.str();
+}
+
+bool extendsCachedNets(const boost::program_options::variables_map& opt)
+{
+  const std::string method = opt["exploration-method"].as<std::string>();
+  const std::string name = method.substr(0, method.find(':'));
+  if (name != "full-CBC" && name != "random-CBC" && name != "mixed-CBC" && name != "adaptive-CBC"){
+    return false;
+  }
+  // the weights read from the standard input cannot be read again for fewer coordinates
+  for (auto w : opt["weights"].as<std::vector<std::string>>()){
+    boost::algorithm::erase_all(w, " ");
+    boost::algorithm::erase_all(w, "\"");
+    if (w == "file:-"){
+      return false;
+    }
+  }
+  return true;
+}
+
+}
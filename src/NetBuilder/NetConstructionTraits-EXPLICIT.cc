@@ -16,6 +16,8 @@
 
 #include "netbuilder/NetConstructionTraits.h"
 
+#include <limits>
+#include <memory>
 #include <sstream>
 #include <boost/algorithm/string/erase.hpp>
 
@@ -44,30 +46,143 @@ namespace NetBuilder {
         return genMat;
     }
 
-    std::vector<GenValue> NetConstructionTraits<NetConstruction::EXPLICIT>::genValueSpaceCoord(Dimension coord, const SizeParameter& sizeParameter)
+    void NetConstructionTraits<NetConstruction::EXPLICIT>::fillGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParameter, GeneratingMatrix& buffer, const Dimension& dimension_j, const unsigned int nRows)
     {
-        throw std::logic_error("The space of all matrices is far too big to be exhautively explored.");
-        return std::vector<GenValue>{};
+        std::unique_ptr<GeneratingMatrix> genMat(createGeneratingMatrix(genValue, sizeParameter, dimension_j, nRows));
+        buffer = std::move(*genMat);
     }
 
-    std::vector<std::vector<GenValue>> NetConstructionTraits<NetConstruction::EXPLICIT>::genValueSpace(Dimension dimension, const SizeParameter& sizeParameter)
+    typedef NetConstructionTraits<NetConstruction::EXPLICIT>::GenValueSpaceCoordSeq GenValueSpaceCoordSeq;
+
+    GenValueSpaceCoordSeq::GenValueSpaceCoordSeq(const SizeParameter& sizeParameter):
+        m_nRows(sizeParameter.first),
+        m_nCols(sizeParameter.second),
+        m_size(1)
+    {
+        const unsigned int nBits = m_nRows * m_nCols;
+        if (nBits >= static_cast<unsigned int>(std::numeric_limits<size_t>::digits))
+        {
+            throw std::logic_error("The space of all matrices is far too big to be exhautively explored.");
+        }
+        m_size = size_t(1) << nBits;
+    };
+
+    GenValueSpaceCoordSeq::const_iterator::const_iterator(const GenValueSpaceCoordSeq& seq):
+        m_size(seq.m_size),
+        m_index(0),
+        m_value(seq[0])
+    {};
+
+    GenValueSpaceCoordSeq::const_iterator::const_iterator(const GenValueSpaceCoordSeq& seq, end_tag):
+        m_size(seq.m_size),
+        m_index(seq.m_size),
+        m_value(seq[0])
+    {};
+
+    size_t GenValueSpaceCoordSeq::const_iterator::index() const
+    {
+        return m_index;
+    }
+
+    bool GenValueSpaceCoordSeq::const_iterator::equal(const const_iterator& other) const
+    { 
+        return m_index == other.m_index;
+    }
+
+    const GenValueSpaceCoordSeq::const_iterator::value_type& GenValueSpaceCoordSeq::const_iterator::dereference() const
+    { 
+        return m_value;
+    }
+
+    void GenValueSpaceCoordSeq::const_iterator::increment()
+    {
+        if (m_index != m_size)
+        {
+            ++m_index;
+            if (m_index < m_size) // the Gray codes of m_index - 1 and m_index differ by the lowest set bit of m_index
+            {
+                const unsigned int bit = lowestSetBit(m_index);
+                m_value.flip(bit / m_value.nCols(), bit % m_value.nCols());
+            }
+        }
+    }
+
+    void GenValueSpaceCoordSeq::const_iterator::decrement()
+    {
+        --m_index;
+        update();
+    }
+
+    void GenValueSpaceCoordSeq::const_iterator::advance(std::ptrdiff_t n)
+    {
+        m_index += n;
+        update();
+    }
+
+    std::ptrdiff_t GenValueSpaceCoordSeq::const_iterator::distance_to(const const_iterator& other) const
+    {
+        return static_cast<std::ptrdiff_t>(other.m_index - m_index);
+    }
+
+    void GenValueSpaceCoordSeq::const_iterator::update()
+    {
+        if (m_index < m_size) // the value of the end iterator is irrelevant
+        {
+            decode(m_index, m_value);
+        }
+    }
+
+    GenValueSpaceCoordSeq::const_iterator GenValueSpaceCoordSeq::begin() const
+    {
+        return const_iterator(*this);
+    }
+
+    GenValueSpaceCoordSeq::const_iterator GenValueSpaceCoordSeq::end() const
+    {
+        return const_iterator(*this, typename const_iterator::end_tag{} );
+    }
+
+    size_t GenValueSpaceCoordSeq::size() const
+    {
+        return m_size;
+    }
+
+    GenValue GenValueSpaceCoordSeq::operator[](size_t i) const
+    {
+        GeneratingMatrix matrix(m_nRows, m_nCols);
+        decode(i, matrix);
+        return matrix;
+    }
+
+    void GenValueSpaceCoordSeq::decode(size_t index, GeneratingMatrix& matrix)
+    {
+        const size_t gray = index ^ (index >> 1);
+        const unsigned int nCols = matrix.nCols();
+        for (unsigned int bit = 0; bit < matrix.nRows() * nCols; ++bit)
+        {
+            matrix(bit / nCols, bit % nCols) = (gray >> bit) & 1;
+        }
+    }
+
+    GenValueSpaceCoordSeq NetConstructionTraits<NetConstruction::EXPLICIT>::genValueSpaceCoord(Dimension coord, const SizeParameter& sizeParameter)
+    {
+        return GenValueSpaceCoordSeq(sizeParameter);
+    }
+
+    typename NetConstructionTraits<NetConstruction::EXPLICIT>::GenValueSpaceSeq NetConstructionTraits<NetConstruction::EXPLICIT>::genValueSpace(Dimension dimension, const SizeParameter& sizeParameter)
     {
-        throw std::logic_error("The space of all matrices is far too big to be exhautively explored.");
-        return std::vector<std::vector<GenValue>>{};
+        return GenValueSpaceSeq(std::vector<GenValueSpaceCoordSeq>(dimension, genValueSpaceCoord(0, sizeParameter)));
     }
 
-    std::string NetConstructionTraits<NetConstruction::EXPLICIT>::format(const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor)
+    void NetConstructionTraits<NetConstruction::EXPLICIT>::format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor)
     {
-        std::ostringstream stream;
-        
         if (outputStyle == OutputStyle::TERMINAL){
-            stream << "Explicit Digital Net - Matrix size = " << sizeParameter.first << "x" << sizeParameter.second << std::endl;
+            os << "Explicit Digital Net - Matrix size = " << sizeParameter.first << "x" << sizeParameter.second << std::endl;
             for(Dimension dim = 0; dim < genMatrices.size(); ++dim)
             {
-                stream << "Coordinate " << dim << std::endl;
-                stream << *genMatrices[dim] << std::endl;
+                os << "Coordinate " << dim << std::endl;
+                os << *genMatrices[dim] << std::endl;
             }
         }
-        return stream.str();
     }  
 }
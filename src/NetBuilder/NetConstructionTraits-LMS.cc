@@ -17,6 +17,7 @@
 #include "netbuilder/NetConstructionTraits.h"
 #include "netbuilder/Helpers/JoeKuo.h"
 
+#include <memory>
 #include <sstream>
 #include <boost/algorithm/string/erase.hpp>
 
@@ -44,12 +45,22 @@ namespace NetBuilder {
 
     GeneratingMatrix*  NetConstructionTraits<NetConstruction::LMS>::createGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParameter, const Dimension& dimension_j, const unsigned int nRows)
     {
-        GeneratingMatrix* result = new GeneratingMatrix(genValue * *sizeParameter.second[dimension_j]);
         unsigned int finalnRows = (nRows == 0)? NetConstructionTraits<NetConstruction::LMS>::nRows(sizeParameter) : nRows;
+        const GeneratingMatrix& baseMatrix = *sizeParameter.second[dimension_j];
+        // the first rows of the scrambled matrix only depend on the first rows of the scrambling matrix
+        GeneratingMatrix* result = (finalnRows < genValue.nRows()) ?
+            new GeneratingMatrix(genValue.subMatrix(0, 0, finalnRows, genValue.nCols()) * baseMatrix) :
+            new GeneratingMatrix(genValue * baseMatrix);
         result->resize(finalnRows, nCols(sizeParameter));
         return result;
     }
 
+    void NetConstructionTraits<NetConstruction::LMS>::fillGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParameter, GeneratingMatrix& buffer, const Dimension& dimension_j, const unsigned int nRows)
+    {
+        std::unique_ptr<GeneratingMatrix> genMat(createGeneratingMatrix(genValue, sizeParameter, dimension_j, nRows));
+        buffer = std::move(*genMat);
+    }
+
     std::vector<GenValue> NetConstructionTraits<NetConstruction::LMS>::genValueSpaceCoord(Dimension coord, const SizeParameter& sizeParameter)
     {
         throw std::logic_error("The space of all matrices is far too big to be exhautively explored.");
@@ -62,71 +73,68 @@ namespace NetBuilder {
         return std::vector<std::vector<GenValue>>{};
     }
 
-    std::string NetConstructionTraits<NetConstruction::LMS>::format(const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor)
+    void NetConstructionTraits<NetConstruction::LMS>::format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor)
     {
-        std::ostringstream stream;
-        
         if (outputStyle == OutputStyle::TERMINAL){
-            stream << "Left-Matrix-Scrambled Digital Net - Matrix size = " << sizeParameter.first.first << "x" << sizeParameter.first.second << std::endl;
-            stream << "Printing only the scrambled generating matrices - see output.txt file for original matrices and scrambling matrices.\n";
+            os << "Left-Matrix-Scrambled Digital Net - Matrix size = " << sizeParameter.first.first << "x" << sizeParameter.first.second << std::endl;
+            os << "Printing only the scrambled generating matrices - see output.txt file for original matrices and scrambling matrices.\n";
             for (Dimension dim = 0; dim < genMatrices.size(); ++dim)
             {
-                stream << "Coordinate " << dim << std::endl;
-                stream << *genMatrices[dim] << std::endl;
+                os << "Coordinate " << dim << std::endl;
+                os << *genMatrices[dim] << std::endl;
             }
         }
 
         else if (outputStyle == OutputStyle::RANDOMIZED_NET){
             unsigned long dimension = genMatrices.size();
             unsigned int nb_col = sizeParameter.first.second;
-            stream << "# Parameters for a digital net in base 2\n";
-            stream << dimension / interlacingFactor << "    # s = " << dimension / interlacingFactor << " dimensions\n";
+            os << "# Parameters for a digital net in base 2\n";
+            os << dimension / interlacingFactor << "    # s = " << dimension / interlacingFactor << " dimensions\n";
             if (interlacingFactor > 1){
-                stream << interlacingFactor << "    # Interlacing factor" << "\n";
-                stream << dimension << "    # Number of components = interlacing factor x dimension" << "\n";
+                os << interlacingFactor << "    # Interlacing factor" << "\n";
+                os << dimension << "    # Number of components = interlacing factor x dimension" << "\n";
             }
-            stream << nb_col << "    # k = " << nb_col << ",  n = 2^" << nb_col << " = "; 
-            stream << (int)pow(2,nb_col) << " points"<< std::endl;
-            stream << "31    # r = 31 binary output digits\n";
+            os << nb_col << "    # k = " << nb_col << ",  n = 2^" << nb_col << " = "; 
+            os << (int)pow(2,nb_col) << " points"<< std::endl;
+            os << "31    # r = 31 binary output digits\n";
 
             if (interlacingFactor == 1){
-                stream << "# Columns of original gen. matrices C_1,...,C_s, one matrix per line\n";
+                os << "# Columns of original gen. matrices C_1,...,C_s, one matrix per line\n";
             }
             else {
-                stream << "# Columns of original gen. matrices C_1,...,C_{ds}, one matrix per line\n";
+                os << "# Columns of original gen. matrices C_1,...,C_{ds}, one matrix per line\n";
             }
             for(unsigned int coord = 0; coord < dimension; coord++)
             {
-                stream << sizeParameter.second[coord]->formatToColumnsReverse();
-                stream << "\n";
+                sizeParameter.second[coord]->formatToColumnsReverse(os);
+                os << "\n";
             }
 
             if (interlacingFactor == 1){
-                stream << "# Columns of scrambling matrices C_1,...,C_s, one matrix per line\n";
+                os << "# Columns of scrambling matrices C_1,...,C_s, one matrix per line\n";
             }
             else {
-                stream << "# Columns of scrambling matrices C_1,...,C_{ds}, one matrix per line\n";
+                os << "# Columns of scrambling matrices C_1,...,C_{ds}, one matrix per line\n";
             }
             for(unsigned int coord = 0; coord < dimension; coord++)
             {
-                stream << genVals[coord]->formatToColumnsReverse();
-                stream << "\n";
+                genVals[coord]->formatToColumnsReverse(os);
+                os << "\n";
             }
 
             if (interlacingFactor == 1){
-                stream << "# Columns of scrambled gen. matrices C_1,...,C_s, one matrix per line\n";
+                os << "# Columns of scrambled gen. matrices C_1,...,C_s, one matrix per line\n";
             }
             else {
-                stream << "# Columns of scrambled gen. matrices C_1,...,C_{ds}, one matrix per line\n";
+                os << "# Columns of scrambled gen. matrices C_1,...,C_{ds}, one matrix per line\n";
             }
             for(unsigned int coord = 0; coord < dimension; coord++)
             {
-                stream << genMatrices[coord]->formatToColumnsReverse();
+                genMatrices[coord]->formatToColumnsReverse(os);
                 if (coord < dimension - 1){
-                    stream << "\n";
+                    os << "\n";
                 }
             }
         }
-        return stream.str();
     }  
 }
@@ -36,6 +36,10 @@ namespace NetBuilder {
 
     bool NetConstructionTraits<NetConstruction::POLYNOMIAL>::checkGenValue(const GenValue& genValue, const SizeParameter& sizeParameter)
     {
+        if (LatBuilder::PolynomialWordModulus::fits(sizeParameter) && deg(genValue) <= LatBuilder::PolynomialWordModulus::maxDegree)
+        {
+            return LatBuilder::PolynomialWordModulus::cached(sizeParameter).isCoprime(LatBuilder::toPolynomialWord(genValue));
+        }
         return IsOne(GCD(genValue,sizeParameter));
     }
 
@@ -57,20 +61,90 @@ namespace NetBuilder {
     }
 
     GeneratingMatrix*  NetConstructionTraits<NetConstruction::POLYNOMIAL>::createGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParameter, const Dimension& dimension_j, const unsigned int nRows)
+    {
+        GeneratingMatrix* genMat = new GeneratingMatrix(0, 0);
+        fillGeneratingMatrix(genValue, sizeParameter, *genMat, dimension_j, nRows);
+        return genMat;
+    }
+
+    namespace {
+        // The coefficients e_1, e_2, ... of the expansion of genValue / sizeParameter in powers of 1/x satisfy
+        // e_l = coeff(genValue, m - l) + sum_{d = 1}^{min(l - 1, m)} e_{l - d} coeff(sizeParameter, m - d) and the row
+        // of index row is made of e_{row + 1}, ..., e_{row + m}. The m last coefficients are held in two words: in 
+        // history, e_{l - d} is the bit d - 1, and in window, the last coefficient is the bit m - 1. In feedback, the
+        // bit d - 1 is the coefficient of degree m - d of the modulus and in numerator, the bit i is the coefficient of
+        // degree i of genValue.
+        void fillPackedRows(GeneratingMatrix::PackedRow numerator, GeneratingMatrix::PackedRow feedback, unsigned int m, GeneratingMatrix& buffer, unsigned int nRows)
+        {
+            typedef GeneratingMatrix::PackedRow PackedRow;
+            const PackedRow mask = lowBitsMask(m);
+            PackedRow history = 0;
+            PackedRow window = 0;
+            for(unsigned int l = 1; l < nRows + m; ++l)
+            {
+                PackedRow e = (l <= m) ? (numerator >> (m - l)) & 1 : 0;
+                e ^= countSetBits(history & feedback) & 1;
+                history = ((history << 1) | e) & mask;
+                window = (window >> 1) | (e << (m - 1));
+                if (l >= m)
+                {
+                    buffer.setPackedRow(l - m, window);
+                }
+            }
+        }
+    }
+
+    void NetConstructionTraits<NetConstruction::POLYNOMIAL>::fillGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParameter, GeneratingMatrix& buffer, const Dimension& dimension_j, const unsigned int nRows)
     {
         unsigned int m = (unsigned int) (deg(sizeParameter));
+        if (LatBuilder::PolynomialWordModulus::fits(sizeParameter) && m <= GeneratingMatrix::maxPackedCols)
+        {
+            // the context is only rebuilt when the size parameter changes, not for each candidate
+            fillGeneratingMatrix(genValue, LatBuilder::PolynomialWordModulus::cached(sizeParameter), buffer, nRows);
+            return;
+        }
+
         unsigned int finalnRows = (nRows == 0)? m : nRows;
-        GeneratingMatrix* genMat = new GeneratingMatrix(finalnRows, m);
-        std::vector<unsigned int> expansion(finalnRows + m);
-        expandSeries(genValue, sizeParameter, expansion, finalnRows + m);
-        for(unsigned int c = 0; c < m; c++)
+        if (buffer.nRows() != finalnRows || buffer.nCols() != m)
         {
-            for(unsigned int row = 0; row < finalnRows; row++)
+            buffer = GeneratingMatrix(finalnRows, m);
+        }
+
+        if (m == 0 || m > GeneratingMatrix::maxPackedCols)
+        {
+            std::vector<unsigned int> expansion(finalnRows + m);
+            expandSeries(genValue, sizeParameter, expansion, finalnRows + m);
+            for(unsigned int c = 0; c < m; c++)
             {
-                (*genMat)(row,c) = expansion[c + row];
+                for(unsigned int row = 0; row < finalnRows; row++)
+                {
+                    buffer(row,c) = expansion[c + row];
+                }
             }
+            return;
         }
-        return genMat;
+
+        typedef GeneratingMatrix::PackedRow PackedRow;
+        PackedRow numerator = 0;
+        PackedRow feedback = 0;
+        for(unsigned int d = 1; d <= m; ++d)
+        {
+            numerator |= PackedRow(IsOne(coeff(genValue, m - d))) << (m - d);
+            feedback |= PackedRow(IsOne(coeff(sizeParameter, m - d))) << (d - 1);
+        }
+        fillPackedRows(numerator, feedback, m, buffer, finalnRows);
+    }
+
+    void NetConstructionTraits<NetConstruction::POLYNOMIAL>::fillGeneratingMatrix(const GenValue& genValue, const LatBuilder::PolynomialWordModulus& context, GeneratingMatrix& buffer, const unsigned int nRows)
+    {
+        unsigned int m = context.degree();
+        unsigned int finalnRows = (nRows == 0)? m : nRows;
+        if (buffer.nRows() != finalnRows || buffer.nCols() != m)
+        {
+            buffer = GeneratingMatrix(finalnRows, m);
+        }
+        // only the coefficients of degree smaller than m of genValue enter the expansion
+        fillPackedRows(LatBuilder::toPolynomialWord(genValue) & lowBitsMask(m), context.feedback(), m, buffer, finalnRows);
     }
 
     typename NetConstructionTraits<NetConstruction::POLYNOMIAL>::GenValueSpaceCoordSeq NetConstructionTraits<NetConstruction::POLYNOMIAL>::genValueSpaceCoord(Dimension coord, const SizeParameter& sizeParameter)
@@ -98,40 +172,34 @@ namespace NetBuilder {
         return GenValueSpaceSeq(seqs);
     }
 
-    std::string NetConstructionTraits<NetConstruction::POLYNOMIAL>::format(const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor)
+    void NetConstructionTraits<NetConstruction::POLYNOMIAL>::format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor)
     {
-        std::string res;
-        std::ostringstream stream;
-
         if (outputStyle == OutputStyle::TERMINAL){
-            stream << "Polynomial Digital Net - Modulus = " << LatBuilder::IndexOfPolynomial(sizeParameter) << " - GeneratingVector =" << std::endl;
+            os << "Polynomial Digital Net - Modulus = " << LatBuilder::IndexOfPolynomial(sizeParameter) << " - GeneratingVector =" << std::endl;
             for (unsigned int coord = 0; coord < genVals.size(); coord++){
-                stream << "  " << LatBuilder::IndexOfPolynomial(*(genVals[coord])) << std::endl;
+                os << "  " << LatBuilder::IndexOfPolynomial(*(genVals[coord])) << std::endl;
             }
         }
 
         else if (outputStyle == OutputStyle::LATTICE){
-            stream << "# Parameters for a polynomial lattice rule in base 2" << std::endl;
-            stream << genVals.size() / interlacingFactor << "      #  s =  " << genVals.size() / interlacingFactor << " dimensions" << std::endl;
+            os << "# Parameters for a polynomial lattice rule in base 2" << std::endl;
+            os << genVals.size() / interlacingFactor << "      #  s =  " << genVals.size() / interlacingFactor << " dimensions" << std::endl;
             if (interlacingFactor > 1){
-                stream << interlacingFactor << "    # Interlacing factor" << std::endl;
-                stream << genVals.size() << "    # Number of components = interlacing factor x dimension" << std::endl;
+                os << interlacingFactor << "    # Interlacing factor" << std::endl;
+                os << genVals.size() << "    # Number of components = interlacing factor x dimension" << std::endl;
             }
-            stream << (int) deg(sizeParameter) << "      # n = 2^";
-            stream <<  (int) deg(sizeParameter) << " = " << (int)pow(2,deg(sizeParameter) ) << " points"<< std::endl;
+            os << (int) deg(sizeParameter) << "      # n = 2^";
+            os <<  (int) deg(sizeParameter) << " = " << (int)pow(2,deg(sizeParameter) ) << " points"<< std::endl;
             
-            stream << LatBuilder::IndexOfPolynomial(sizeParameter) << "   # polynomial modulus" << std::endl;
-            stream << "# Coordinates of generating vector, starting at j=1" << std::endl;
-            std::string res;
+            os << LatBuilder::IndexOfPolynomial(sizeParameter) << "   # polynomial modulus" << std::endl;
+            os << "# Coordinates of generating vector, starting at j=1" << std::endl;
             for (unsigned int coord = 0; coord < genVals.size(); coord++){
-                res += std::to_string(LatBuilder::IndexOfPolynomial(*(genVals[coord]))) + "\n";
+                if (coord > 0){
+                    os << "\n";
+                }
+                os << LatBuilder::IndexOfPolynomial(*(genVals[coord]));
             }
-            res.pop_back();
-            stream << res;
         }
-
-        res += stream.str();
-        return res;
     }  
 }
 
@@ -20,6 +20,9 @@
 #include "latbuilder/Traversal.h"
 
 #include <boost/dynamic_bitset.hpp>
+#include <array>
+#include <limits>
+#include <memory>
 #include <vector>
 #include <list>
 
@@ -121,6 +124,13 @@ namespace NetBuilder {
 
     GeneratingMatrix*  NetConstructionTraits<NetConstruction::SOBOL>::createGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, const Dimension& dimension_j, const unsigned int nRows)
     {
+        if (nCols(sizeParam) <= GeneratingMatrix::maxPackedCols)
+        {
+            GeneratingMatrix* genMat = new GeneratingMatrix(0, 0);
+            fillGeneratingMatrix(genValue, sizeParam, *genMat, dimension_j, nRows);
+            return genMat;
+        }
+
         unsigned int m  = nCols(sizeParam);
         unsigned int finalnRows = (nRows == 0)? m : nRows;
         Dimension coord = genValue.first;
@@ -161,26 +171,123 @@ namespace NetBuilder {
         return tmp;
     }
 
-   NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::GenValueSpaceCoordSeq(Dimension coord):
-    m_coord(coord),
-    m_underlyingSeq(underlyingSeqs(coord))
-    {};
+    void NetConstructionTraits<NetConstruction::SOBOL>::fillGeneratingMatrix(const GenValue& genValue, const SizeParameter& sizeParam, GeneratingMatrix& buffer, const Dimension& dimension_j, const unsigned int nRows)
+    {
+        typedef GeneratingMatrix::PackedRow PackedRow;
+
+        unsigned int m  = nCols(sizeParam);
+        if (m > GeneratingMatrix::maxPackedCols)
+        {
+            std::unique_ptr<GeneratingMatrix> genMat(createGeneratingMatrix(genValue, sizeParam, dimension_j, nRows));
+            buffer = std::move(*genMat);
+            return;
+        }
+
+        unsigned int finalnRows = (nRows == 0)? m : nRows;
+        Dimension coord = genValue.first;
+
+        if (coord==0) // special case for the first dimension: the identity
+        {
+            if (buffer.nRows() != m || buffer.nCols() != m)
+            {
+                buffer = GeneratingMatrix(m, m);
+            }
+            for(unsigned int k = 0; k < m; ++k)
+            {
+                buffer.setPackedRow(k, PackedRow(1) << k);
+            }
+            return;
+        }
+
+        if (buffer.nRows() != finalnRows || buffer.nCols() != m)
+        {
+            buffer = GeneratingMatrix(finalnRows, m);
+        }
+
+        // direction numbers v_1, ..., v_m: the first ones are given, the next ones follow the linear recurrence 
+        // defined by the primitive polynomial; column k - 1 holds the k bits of v_k, the most significant one in the first row
+        PrimitivePolynomial p = nthPrimitivePolynomial(coord);
+        const unsigned int degree = p.first;
+        const uInteger poly_rep = p.second;
+        std::array<PackedRow, GeneratingMatrix::maxPackedCols> dirNums;
+        for(unsigned int k = 1; k <= m; ++k)
+        {
+            PackedRow v;
+            if (k <= degree)
+            {
+                v = genValue.second[k-1] & lowBitsMask(k);
+            }
+            else
+            {
+                v = dirNums[k-degree-1] ^ (dirNums[k-degree-1] << degree);
+                for(unsigned int j = 1; j < degree; ++j)
+                {
+                    if ((poly_rep >> (j-1)) & 1)
+                    {
+                        v ^= dirNums[k-degree-1+j] << (degree-j);
+                    }
+                }
+                v &= lowBitsMask(k);
+            }
+            dirNums[k-1] = v;
+        }
+
+        if (finalnRows > GeneratingMatrix::maxPackedCols)
+        {
+            for(unsigned int i = 0; i < finalnRows; ++i)
+            {
+                PackedRow row = 0;
+                for(unsigned int c = i; c < m; ++c)
+                {
+                    row |= ((dirNums[c] >> (c-i)) & 1) << c;
+                }
+                buffer.setPackedRow(i, row);
+            }
+            return;
+        }
+
+        // the direction number v_k, whose most significant bit is in the first row, is the reversed column k - 1 up to
+        // the number of rows, so that the rows are obtained by a single transposition of the block of the columns
+        std::vector<unsigned long> cols(m);
+        for(unsigned int c = 0; c < m; ++c)
+        {
+            cols[c] = c < finalnRows ? dirNums[c] << (finalnRows - 1 - c) : dirNums[c] >> (c + 1 - finalnRows);
+        }
+        buffer.setColsReverse(cols);
+    }
 
+    NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::GenValueSpaceCoordSeq(Dimension coord):
+        m_coord(coord),
+        m_degree(coord == 0 ? 0 : nthPrimitivePolynomialDegree(coord)),
+        m_size(1)
+    {
+        // m_k takes 2^(k-1) values, hence d(d-1)/2 bits for all the direction numbers
+        const unsigned int nBits = m_degree == 0 ? 0 : m_degree * (m_degree - 1) / 2;
+        m_size = nBits < static_cast<unsigned int>(std::numeric_limits<size_t>::digits) ? size_t(1) << nBits : std::numeric_limits<size_t>::max();
+    };
 
     NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::const_iterator(const GenValueSpaceCoordSeq& seq):
-        m_coord(seq.coord()),
-        m_underlyingIterator(seq.underlyingSeq().begin()),
-        m_value(GenValue(m_coord, *m_underlyingIterator))
+        m_degree(seq.m_degree),
+        m_size(seq.m_size),
+        m_index(0),
+        m_value(seq[0])
     {};
 
     NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::const_iterator(const GenValueSpaceCoordSeq& seq, end_tag):
-        m_coord(seq.coord()),
-        m_underlyingIterator(seq.underlyingSeq().end())
+        m_degree(seq.m_degree),
+        m_size(seq.m_size),
+        m_index(seq.m_size),
+        m_value(seq[0])
     {};
 
+    size_t NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::index() const
+    {
+        return m_index;
+    }
+
     bool NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::equal(const const_iterator& other) const
     { 
-        return m_underlyingIterator == other.m_underlyingIterator;
+        return m_index == other.m_index && m_value.first == other.m_value.first;
     }
 
     const NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::value_type& NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::dereference() const
@@ -190,10 +297,35 @@ namespace NetBuilder {
 
     void NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::increment()
     {
-        if (m_underlyingIterator != m_underlyingIterator.seq().end())
+        if (m_index != m_size)
         {
-            ++m_underlyingIterator;
-            m_value = GenValue(m_coord, *m_underlyingIterator);
+            ++m_index;
+            update();
+        }
+    }
+
+    void NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::decrement()
+    {
+        --m_index;
+        update();
+    }
+
+    void NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::advance(std::ptrdiff_t n)
+    {
+        m_index += n;
+        update();
+    }
+
+    std::ptrdiff_t NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::distance_to(const const_iterator& other) const
+    {
+        return static_cast<std::ptrdiff_t>(other.m_index - m_index);
+    }
+
+    void NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::const_iterator::update()
+    {
+        if (m_degree > 0 && m_index < m_size) // the value of the end iterator is irrelevant
+        {
+            decode(m_degree, m_index, m_value.second);
         }
     }
 
@@ -214,41 +346,31 @@ namespace NetBuilder {
 
     size_t  NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::size() const
     {
-        return m_underlyingSeq.size();
+        return m_size;
     }
 
-    const LatBuilder::SeqCombiner<std::vector<uInteger>,LatBuilder::CartesianProduct>& NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::underlyingSeq() const
+    NetConstructionTraits<NetConstruction::SOBOL>::GenValue NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::operator[](size_t i) const
     {
-        return m_underlyingSeq;
+        if (m_degree == 0)
+        {
+            return GenValue(m_coord, {0});
+        }
+        std::vector<uInteger> dirNums(m_degree);
+        decode(m_degree, i, dirNums);
+        return GenValue(m_coord, std::move(dirNums));
     }
 
-    std::vector<std::vector<uInteger>> NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::underlyingSeqs(Dimension coord)
+    void NetConstructionTraits<NetConstruction::SOBOL>::GenValueSpaceCoordSeq::decode(unsigned int degree, size_t index, std::vector<uInteger>& dirNums)
     {
-        if (coord == 0)
-        {
-            return {{0}};
-        }
-        else
+        // m_k is 2 d_k + 1, where d_k is the digit of radix 2^(k-1); the digits of the first direction numbers are
+        // beyond the range of the index for high degrees, and are then zero
+        unsigned int shift = 0;
+        for(unsigned int k = degree; k >= 1; --k)
         {
-            unsigned int size = nthPrimitivePolynomialDegree(coord);
-            std::vector<uInteger> dirNums{1};
-            dirNums.reserve( (1 << (size - 1))  - 1);
-
-            std::vector<std::vector<uInteger>> seqs;
-            seqs.reserve(size);
-            seqs.push_back(dirNums);
-
-            uInteger upperBound = 2;
-            for(unsigned int i = 1; i < size; ++i)
-            {
-                upperBound = 2 * upperBound;
-                for(uInteger k = dirNums.back() + 2; k < upperBound; k += 2)
-                {
-                    dirNums.push_back(k);
-                }
-                seqs.push_back(dirNums);
-            }
-            return seqs;
+            const unsigned int nBits = k - 1;
+            const size_t digit = shift < static_cast<unsigned int>(std::numeric_limits<size_t>::digits) ? (index >> shift) & ((size_t(1) << nBits) - 1) : 0;
+            dirNums[k-1] = 2 * digit + 1;
+            shift += nBits;
         }
     }
 
@@ -268,76 +390,61 @@ namespace NetBuilder {
         return GenValueSpaceSeq(seqs);
     }
 
-    std::string NetConstructionTraits<NetConstruction::SOBOL>::format(const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor)
+    void NetConstructionTraits<NetConstruction::SOBOL>::format(std::ostream& os, const std::vector<std::shared_ptr<GeneratingMatrix>>& genMatrices, const std::vector<std::shared_ptr<GenValue>>& genVals, const SizeParameter& sizeParameter, OutputStyle outputStyle, unsigned int interlacingFactor)
     {
-        std::string res;
-        std::string dimension = std::to_string(genVals.size()/interlacingFactor);
+        const size_t dimension = genVals.size()/interlacingFactor;
         unsigned int k = nCols(sizeParameter);
 
+        // writes the direction numbers of a coordinate separated by spaces
+        auto writeDirectionNumbers = [&os](const GenValue& genValue)
+        {
+            for (size_t i = 0; i < genValue.second.size(); i++){
+                if (i > 0){
+                    os << " ";
+                }
+                os << genValue.second[i];
+            }
+        };
+
         if (outputStyle == OutputStyle::TERMINAL){
-            res += "Sobol Digital Net - Direction numbers =\n";
+            os << "Sobol Digital Net - Direction numbers =\n";
             for (unsigned int coord = 0; coord < genVals.size(); coord++){
-                res+="  ";
-                for(const auto& dirNum : genVals[coord]->second)
-                {
-                    res+= std::to_string(dirNum);
-                    res+= " ";
-                }
-                res.pop_back();
-                res+="\n";
+                os << "  ";
+                writeDirectionNumbers(*genVals[coord]);
+                os << "\n";
             }
         }
 
         else if (outputStyle == OutputStyle::SOBOLJK){
-            res += "# Parameters for Sobol points, in JK format\n";
-            res += dimension + "    # s = " + dimension + " dimensions\n";
+            os << "# Parameters for Sobol points, in JK format\n";
+            os << dimension << "    # s = " << dimension << " dimensions\n";
             if (interlacingFactor > 1){
-                res+= std::to_string(interlacingFactor) + "    # Interlacing factor" + "\n";
-                res+= std::to_string(genVals.size()) + "    # Number of components = interlacing factor x dimension" + "\n";
+                os << interlacingFactor << "    # Interlacing factor" << "\n";
+                os << genVals.size() << "    # Number of components = interlacing factor x dimension" << "\n";
             }
-            res += std::to_string(k) + "    # k = " + std::to_string(k) + ",  n = 2^"+ std::to_string(k) + " = " + std::to_string((int)pow(2, k)) + " points\n";
-            res +="#  d  a  m_{j,c}\n";
+            os << k << "    # k = " << k << ",  n = 2^" << k << " = " << (int)pow(2, k) << " points\n";
+            os << "#  d  a  m_{j,c}";
             for (unsigned int coord = 1; coord < genVals.size(); coord++){
-                res+= std::to_string(coord +1) + "  ";
                 PrimitivePolynomial p = nthPrimitivePolynomial(coord);
-                auto degree = p.first;
-                auto poly_rep = p.second;
-                res+= std::to_string(degree) + "  ";
-                res+= std::to_string(poly_rep) + "  ";
-                for(const auto& dirNum : genVals[coord]->second)
-                {
-                    res+= std::to_string(dirNum);
-                    res+= " ";
-                }
-                res.pop_back();
-                res+="\n";
-                
+                os << "\n" << coord + 1 << "  " << p.first << "  " << p.second << "  ";
+                writeDirectionNumbers(*genVals[coord]);
             }
-            res.pop_back();
         }
 
         else if (outputStyle == OutputStyle::SOBOL){
-            res += "# Initial direction numbers m_{j,c} for Sobol points\n";
-            res += dimension + "    # s = " + dimension + " dimensions\n";
+            os << "# Initial direction numbers m_{j,c} for Sobol points\n";
+            os << dimension << "    # s = " << dimension << " dimensions\n";
             if (interlacingFactor > 1){
-                res+= std::to_string(interlacingFactor) + "    # Interlacing factor" + "\n";
-                res+= std::to_string(genVals.size()) + "    # Number of components = interlacing factor x dimension" + "\n";
+                os << interlacingFactor << "    # Interlacing factor" << "\n";
+                os << genVals.size() << "    # Number of components = interlacing factor x dimension" << "\n";
             }
-            res += std::to_string(k) + "    # k = " + std::to_string(k) + ",  n = 2^"+ std::to_string(k) + " = " + std::to_string((int)pow(2, k)) + " points\n";
-            res +="# m_{j,c}, starting from the second coordinate\n";
+            os << k << "    # k = " << k << ",  n = 2^" << k << " = " << (int)pow(2, k) << " points\n";
+            os << "# m_{j,c}, starting from the second coordinate";
             for (unsigned int coord = 1; coord < genVals.size(); coord++){
-                for(const auto& dirNum : genVals[coord]->second)
-                {
-                    res += std::to_string(dirNum);
-                    res += " ";
-                }
-                res.pop_back();
-                res+="\n";
-                
+                os << "\n";
+                writeDirectionNumbers(*genVals[coord]);
             }
-            res.pop_back();                
-        }  
-        return res;
+        }
     }  
 }
 
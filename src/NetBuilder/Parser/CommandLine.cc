@@ -20,6 +20,7 @@
 #include "netbuilder/Parser/SizeParameterParser.h"
 #include "netbuilder/Parser/FigureParser.h"
 #include "netbuilder/Parser/ExplorationMethodParser.h"
+#include "netbuilder/Module.h"
 
 namespace NetBuilder { namespace Parser {
 template <NetConstruction NC, EmbeddingType ET>
@@ -38,14 +39,31 @@ CommandLine<NC, ET>::parse()
       }
       m_verbose = boost::lexical_cast<int>(s_verbose);
       m_figure = FigureParser<NC, ET>::parse(*this); // m_combiner initialized and moved to m_figure as a side effect 
+      if (!s_additionalFigures.empty()){
+            const std::string figure = s_figure;
+            for (const auto& additionalFigure : s_additionalFigures){
+                  s_figure = additionalFigure;
+                  m_additionalFigures.push_back(FigureParser<NC, ET>::parse(*this)); // each figure has its own combiner
+            }
+            s_figure = figure;
+      }
       return ExplorationMethodParser<NC, ET>::parse(*this); // as a side effect, m_figure has been moved to task
 }
+
+#if NETBUILDER_WITH_CONSTRUCTION_LMS
 template struct CommandLine<NetConstruction::LMS, EmbeddingType::UNILEVEL>;
 template struct CommandLine<NetConstruction::LMS, EmbeddingType::MULTILEVEL>;
+#endif
+#if NETBUILDER_WITH_CONSTRUCTION_EXPLICIT
 template struct CommandLine<NetConstruction::EXPLICIT, EmbeddingType::UNILEVEL>;
 template struct CommandLine<NetConstruction::EXPLICIT, EmbeddingType::MULTILEVEL>;
+#endif
+#if NETBUILDER_WITH_CONSTRUCTION_POLYNOMIAL
 template struct CommandLine<NetConstruction::POLYNOMIAL, EmbeddingType::UNILEVEL>;
+#endif
+#if NETBUILDER_WITH_CONSTRUCTION_SOBOL
 template struct CommandLine<NetConstruction::SOBOL, EmbeddingType::UNILEVEL>;
 template struct CommandLine<NetConstruction::SOBOL, EmbeddingType::MULTILEVEL>;
+#endif
 
 }}
\ No newline at end of file
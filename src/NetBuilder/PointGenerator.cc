@@ -0,0 +1,231 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/PointGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+    // SplitMix64, the generator of the random matrices, shifts and seeds of the randomizations
+    class SplitMix64
+    {
+        public:
+            explicit SplitMix64(uint64_t state): m_state(state) {}
+
+            uint64_t operator()()
+            {
+                uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                return z ^ (z >> 31);
+            }
+
+        private:
+            uint64_t m_state;
+    };
+
+    uint64_t reverseBits(uint64_t x)
+    {
+        x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+        x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+        x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        x = ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+        x = ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+        return (x >> 32) | (x << 32);
+    }
+
+    // random lower-triangular invertible matrix on the digits: the column of the digit at bit p holds bit p and random lower bits
+    std::array<uint64_t, 64> randomLeftMatrix(SplitMix64& rng)
+    {
+        std::array<uint64_t, 64> matrix;
+        for(unsigned int p = 0; p < 64; ++p)
+        {
+            const uint64_t bit = uint64_t(1) << p;
+            matrix[p] = bit | (rng() & (bit - 1));
+        }
+        return matrix;
+    }
+
+    uint64_t leftMultiply(const std::array<uint64_t, 64>& matrix, uint64_t digits)
+    {
+        uint64_t res = 0;
+        for(; digits; digits &= digits - 1)
+        {
+            res ^= matrix[NetBuilder::lowestSetBit(digits)];
+        }
+        return res;
+    }
+
+    // With the first digit in the least significant bit, each step flips the bit k by a function of the seed and of the
+    // bits below k only, so that each digit is flipped by a hash of the previous digits: a nested scrambling.
+    inline uint64_t nestedUniformScramble(uint64_t digits, uint64_t seed)
+    {
+        uint64_t x = reverseBits(digits);
+        x ^= x * 0x9e3779b97f4a7c16ULL;
+        x += seed;
+        x *= (seed >> 32) | 1;
+        x ^= x * 0xbf58476d1ce4e5baULL;
+        x ^= x * 0x94d049bb133111eaULL;
+        return reverseBits(x);
+    }
+}
+
+namespace NetBuilder {
+
+    DigitalNetPointGenerator::DigitalNetPointGenerator(const AbstractDigitalNet& net, unsigned int interlacingFactor):
+        DigitalNetPointGenerator(net, interlacingFactor, Scrambling::NONE, 0)
+    {}
+
+    DigitalNetPointGenerator::DigitalNetPointGenerator(const AbstractDigitalNet& net, unsigned int interlacingFactor, Scrambling scrambling, uint64_t seed, unsigned int replicate):
+        m_numPoints(net.numPoints()),
+        m_nCols(net.numColumns())
+    {
+        if (interlacingFactor == 0 || net.dimension() % interlacingFactor != 0)
+        {
+            throw std::invalid_argument("The dimension of the net is not a multiple of the interlacing factor.");
+        }
+        if (scrambling == Scrambling::NESTED_UNIFORM && interlacingFactor != 1)
+        {
+            throw std::invalid_argument("Nested uniform scrambling requires an interlacing factor of one.");
+        }
+        m_dimension = net.dimension() / interlacingFactor;
+
+        // the stream of each replicate starts at a hash of the seed and of the replicate index
+        SplitMix64 rng(SplitMix64(SplitMix64(seed)() + replicate)());
+
+        std::vector<uint64_t> columns(m_nCols * m_dimension, 0);
+        for(Dimension coord = 0; coord < net.dimension(); ++coord)
+        {
+            const GeneratingMatrix& matrix = net.generatingMatrix(coord);
+            const Dimension j = coord / interlacingFactor;
+            const unsigned int l = (unsigned int) (coord % interlacingFactor);
+            // the digits beyond the 64th are beyond the precision of the points
+            const unsigned int nRows = std::min(matrix.nRows(), GeneratingMatrix::maxPackedCols);
+            const std::vector<unsigned long> matrixColumns = (nRows < matrix.nRows() ? matrix.upperLeftSubMatrix(nRows, m_nCols) : matrix).getColsReverse();
+            const std::array<uint64_t, 64> leftMatrix = (scrambling == Scrambling::LMS) ? randomLeftMatrix(rng) : std::array<uint64_t, 64>();
+            for(unsigned int k = 0; k < m_nCols; ++k)
+            {
+                if (nRows > 0)
+                {
+                    // first digit in the most significant bit, at position r * interlacingFactor + l once interlaced
+                    uint64_t digits = uint64_t(matrixColumns[k]) << (64 - nRows);
+                    if (scrambling == Scrambling::LMS)
+                    {
+                        digits = leftMultiply(leftMatrix, digits);
+                    }
+                    columns[k * m_dimension + j] |= interlaceDigits(digits, interlacingFactor, l);
+                }
+            }
+        }
+
+        m_prefixColumns = std::move(columns);
+        for(unsigned int k = 1; k < m_nCols; ++k)
+        {
+            for(Dimension j = 0; j < m_dimension; ++j)
+            {
+                m_prefixColumns[k * m_dimension + j] ^= m_prefixColumns[(k - 1) * m_dimension + j];
+            }
+        }
+
+        m_digitalShift.assign(m_dimension, 0);
+        if (scrambling == Scrambling::DIGITAL_SHIFT || scrambling == Scrambling::LMS)
+        {
+            for(auto& shift : m_digitalShift)
+            {
+                shift = rng();
+            }
+        }
+        else if (scrambling == Scrambling::NESTED_UNIFORM)
+        {
+            m_scrambleSeeds.resize(m_dimension);
+            for(auto& scrambleSeed : m_scrambleSeeds)
+            {
+                scrambleSeed = rng();
+            }
+        }
+    }
+
+    template <typename T, typename CONVERT>
+    void DigitalNetPointGenerator::generateImpl(uInteger first, uInteger count, T* out, CONVERT convert) const
+    {
+        // the branch on the randomization is taken once by block, outside the loops on the points
+        if (m_scrambleSeeds.empty())
+        {
+            generateDigits(first, count, out, [this, convert](uint64_t digits, Dimension j) { return convert(digits ^ m_digitalShift[j]); });
+        }
+        else
+        {
+            generateDigits(first, count, out, [this, convert](uint64_t digits, Dimension j) { return convert(nestedUniformScramble(digits, m_scrambleSeeds[j])); });
+        }
+    }
+
+    template <typename T, typename CONVERT>
+    void DigitalNetPointGenerator::generateDigits(uInteger first, uInteger count, T* out, CONVERT convert) const
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        // digits of the first point: the column k contributes if bit k of first is set
+        std::vector<uint64_t> point(m_dimension, 0);
+        for(unsigned int k = 0; k < m_nCols; ++k)
+        {
+            if ((first >> k) & 1)
+            {
+                const uint64_t* column = m_prefixColumns.data() + k * m_dimension;
+                const uint64_t* previous = (k > 0) ? column - m_dimension : nullptr;
+                for(Dimension j = 0; j < m_dimension; ++j)
+                {
+                    point[j] ^= previous ? (column[j] ^ previous[j]) : column[j];
+                }
+            }
+        }
+
+        for(uInteger i = first; ; )
+        {
+            for(Dimension j = 0; j < m_dimension; ++j)
+            {
+                *out++ = convert(point[j], j);
+            }
+            if (++i == first + count)
+            {
+                break;
+            }
+            const uint64_t* prefix = m_prefixColumns.data() + lowestSetBit(i) * m_dimension;
+            for(Dimension j = 0; j < m_dimension; ++j)
+            {
+                point[j] ^= prefix[j];
+            }
+        }
+    }
+
+    void DigitalNetPointGenerator::generate(uInteger first, uInteger count, double* out) const
+    {
+        const double scale = std::ldexp(1.0, -53);
+        generateImpl(first, count, out, [scale](uint64_t digits) { return (double) (digits >> 11) * scale; });
+    }
+
+    void DigitalNetPointGenerator::generate(uInteger first, uInteger count, uint32_t* out) const
+    {
+        generateImpl(first, count, out, [](uint64_t digits) { return (uint32_t) (digits >> 32); });
+    }
+
+}
@@ -16,124 +16,438 @@
 
 #include "netbuilder/Helpers/RankComputer.h"
 
+#include "latbuilder/Profiler.h"
+#include "latbuilder/CpuDispatch.h"
+
 #include <algorithm>
 #include <iterator>
+#include <stdexcept>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace NetBuilder{
 
+    namespace {
+
+        /*
+         * XORs the row and the row operations of index pivotRow into those of the first nRows rows which have the 
+         * bit pivotBit set, except the row pivotRow itself. The loop has no branches: it is vectorized by the compiler
+         * for the instruction sets selected at run time, and with NEON on AArch64.
+         */ 
+        LATNETBUILDER_TARGET_CLONES
+        void eliminatePackedColumn(GeneratingMatrix::PackedRow* redMat, GeneratingMatrix::PackedRow* rowOperations, unsigned int nRows, 
+                                   unsigned int pivotRow, GeneratingMatrix::PackedRow pivotBit)
+        {
+            typedef GeneratingMatrix::PackedRow PackedRow;
+            const PackedRow row = redMat[pivotRow];
+            const PackedRow operations = rowOperations[pivotRow];
+            unsigned int i = 0;
+#if defined(__aarch64__) && defined(__ARM_NEON)
+            const uint64x2_t bit = vdupq_n_u64(pivotBit);
+            const uint64x2_t rows = vdupq_n_u64(row);
+            const uint64x2_t ops = vdupq_n_u64(operations);
+            for(; i + 2 <= nRows; i += 2)
+            {
+                const uint64x2_t red = vld1q_u64(redMat + i);
+                const uint64x2_t mask = vtstq_u64(red, bit); // all ones where the pivot bit is set
+                vst1q_u64(redMat + i, veorq_u64(red, vandq_u64(rows, mask)));
+                vst1q_u64(rowOperations + i, veorq_u64(vld1q_u64(rowOperations + i), vandq_u64(ops, mask)));
+            }
+#endif
+            for(; i < nRows; ++i)
+            {
+                const PackedRow mask = PackedRow(0) - ((redMat[i] & pivotBit) != 0);
+                redMat[i] ^= row & mask;
+                rowOperations[i] ^= operations & mask;
+            }
+            // the pivot row was cleared by its own XOR
+            redMat[pivotRow] = row;
+            rowOperations[pivotRow] = operations;
+        }
+    }
+
     RankComputer::RankComputer(unsigned int nCols)
     {
         reset(nCols);
     };
 
+    constexpr unsigned int RankComputer::noPivot;
+
     void RankComputer::reset(unsigned int nCols)  
     {
+        discardCheckpoint();
         m_nCols = nCols;
         m_nRows = 0;
         m_smallestFullRank = nCols;
-        m_redMat = GeneratingMatrix(0, m_nCols);
+        m_pivotRowOfCol.clear();
+        m_pivotColOfRow.clear();
+        m_columnsWithoutPivot.clear();
+        m_rowsWithoutPivot.clear();
         #ifdef DEBUG_ROW_REDUCER
         m_baseMatrix = GeneratingMatrix(0, m_nCols);
+        m_packed = false;
+        #else
+        m_packed = (nCols <= GeneratingMatrix::maxPackedCols);
         #endif
-        m_columnsWithoutPivot.clear();
-        for(unsigned int j = 0; j < nCols; ++j)
+        if (m_packed)
         {
-            m_columnsWithoutPivot.insert(m_columnsWithoutPivot.end(), j);
+            m_redMat = GeneratingMatrix(0, 0);
+            m_rowOperations.resize(0, 0);
+            m_packedColumnsWithoutPivot = lowBitsMask(nCols);
+            m_packedRowsWithoutPivot = 0;
+            m_packedPivotColOfRow.fill(noPivot);
+            return;
         }
-        m_rowsWithoutPivot.clear();
-        m_pivotsColRowPositions.clear();
-        m_pivotsRowColPositions.clear();
+        m_redMat = GeneratingMatrix(0, m_nCols);
+        m_pivotRowOfCol.assign(nCols, noPivot);
+        m_columnsWithoutPivot.resize(nCols, true);
         m_rowOperations.resize(0,m_nCols);
     }
 
-    unsigned int RankComputer::computeRank() const
+    void RankComputer::unpack()
+    {
+        m_redMat = GeneratingMatrix(m_nRows, m_nCols);
+        m_rowOperations = GeneratingMatrix(m_nRows, m_nRows);
+        m_pivotRowOfCol.assign(m_nCols, noPivot);
+        m_pivotColOfRow.assign(m_nRows, noPivot);
+        m_columnsWithoutPivot.resize(m_nCols);
+        m_rowsWithoutPivot.resize(m_nRows);
+        for(unsigned int i = 0; i < m_nRows; ++i)
+        {
+            m_redMat.setPackedRow(i, m_packedRedMat[i]);
+            m_rowOperations.setPackedRow(i, m_packedRowOperations[i]);
+            if (m_packedPivotColOfRow[i] != noPivot)
+            {
+                m_pivotRowOfCol[m_packedPivotColOfRow[i]] = i;
+                m_pivotColOfRow[i] = m_packedPivotColOfRow[i];
+            }
+            else
+            {
+                m_rowsWithoutPivot.set(i);
+            }
+        }
+        for(unsigned int j = 0; j < m_nCols; ++j)
+        {
+            m_columnsWithoutPivot[j] = (m_packedColumnsWithoutPivot >> j) & 1;
+        }
+        m_packed = false;
+    }
+
+    void RankComputer::discardCheckpoint()
     {
-        return (unsigned int) m_pivotsColRowPositions.size();
+        m_checkpoints.clear();
+        m_packedJournal.clear();
+        m_journal.clear();
     }
 
-    std::vector<unsigned int> RankComputer::computeRanks(unsigned int firstCol, unsigned int numCol) const
+    void RankComputer::checkpoint()
     {
-        unsigned int rank = 0;
-        std::vector<unsigned int> ranks(numCol, rank);
-        unsigned int lastCol = firstCol;
+        discardCheckpoint();
+        pushCheckpoint();
+    }
 
-        for(const auto& colRow : m_pivotsColRowPositions)
+    void RankComputer::pushCheckpoint()
+    {
+        m_checkpoints.push_back({m_packed, m_nRows, m_smallestFullRank, m_packedColumnsWithoutPivot, m_packedRowsWithoutPivot, m_packedJournal.size(), m_journal.size()});
+    }
+
+    void RankComputer::rollback()
+    {
+        if (m_checkpoints.empty())
         {
-            if(colRow.first >= firstCol+numCol)
+            throw std::logic_error("Rollback of a rank computer without checkpoint.");
+        }
+        const Checkpoint& checkpoint = m_checkpoints.back();
+
+        if (checkpoint.packed && !m_packed) // the packed members were left untouched after unpacking
+        {
+            m_redMat = GeneratingMatrix(0, 0);
+            m_rowOperations.resize(0, 0);
+            m_pivotRowOfCol.clear();
+            m_pivotColOfRow.clear();
+            m_columnsWithoutPivot.clear();
+            m_rowsWithoutPivot.clear();
+            m_journal.clear();
+            m_packed = true;
+        }
+
+        if (m_packed)
+        {
+            while (m_packedJournal.size() > checkpoint.packedJournalSize)
             {
-                break;
+                const PackedJournalEntry& entry = m_packedJournal.back();
+                m_packedRedMat[entry.row] = entry.redRow;
+                m_packedRowOperations[entry.row] = entry.rowOperations;
+                m_packedJournal.pop_back();
             }
-
-            for(unsigned int col = lastCol; col < colRow.first ; ++col)
+            m_packedColumnsWithoutPivot = checkpoint.columnsWithoutPivot;
+            m_packedRowsWithoutPivot = checkpoint.rowsWithoutPivot;
+        }
+        else
+        {
+            while (m_journal.size() > checkpoint.journalSize)
+            {
+                JournalEntry& entry = m_journal.back();
+                m_redMat[entry.row] = std::move(entry.redRow);
+                m_rowOperations[entry.row] = std::move(entry.rowOperations);
+                m_journal.pop_back();
+            }
+            // the rows added since the checkpoint are the only ones which may have got a pivot
+            for(unsigned int row = checkpoint.nRows; row < m_nRows; ++row)
             {
-                ranks[col-firstCol] = rank;
+                if (m_pivotColOfRow[row] != noPivot)
+                {
+                    m_pivotRowOfCol[m_pivotColOfRow[row]] = noPivot;
+                    m_columnsWithoutPivot.set(m_pivotColOfRow[row]);
+                }
             }
+            m_pivotColOfRow.resize(checkpoint.nRows);
+            m_rowsWithoutPivot.resize(checkpoint.nRows);
+            m_redMat.resize(checkpoint.nRows, m_nCols);
+            m_rowOperations.resize(checkpoint.nRows, checkpoint.nRows);
+            #ifdef DEBUG_ROW_REDUCER
+            m_baseMatrix.resize(checkpoint.nRows, m_nCols);
+            #endif
+        }
 
-            rank+=1;
+        m_nRows = checkpoint.nRows;
+        m_smallestFullRank = checkpoint.smallestFullRank;
+    }
 
-            if (colRow.first >= firstCol)
+    void RankComputer::popCheckpoint()
+    {
+        rollback();
+        m_checkpoints.pop_back();
+    }
+
+    GeneratingMatrix RankComputer::reducedMatrix() const
+    {
+        if (!m_packed)
+        {
+            return m_redMat;
+        }
+        GeneratingMatrix res(m_nRows, m_nCols);
+        for(unsigned int i = 0; i < m_nRows; ++i)
+        {
+            res.setPackedRow(i, m_packedRedMat[i]);
+        }
+        return res;
+    }
+
+    GeneratingMatrix RankComputer::rowOperations() const
+    {
+        if (!m_packed)
+        {
+            return m_rowOperations;
+        }
+        GeneratingMatrix res(m_nRows, m_nRows);
+        for(unsigned int i = 0; i < m_nRows; ++i)
+        {
+            res.setPackedRow(i, m_packedRowOperations[i]);
+        }
+        return res;
+    }
+
+    std::map<unsigned int, unsigned int> RankComputer::getPivots() const
+    {
+        const unsigned int* pivotColOfRow = m_packed ? m_packedPivotColOfRow.data() : m_pivotColOfRow.data();
+        std::map<unsigned int, unsigned int> res;
+        for(unsigned int i = 0; i < m_nRows; ++i)
+        {
+            if (pivotColOfRow[i] != noPivot)
             {
-                lastCol = colRow.first;
+                res.emplace_hint(res.end(), i, pivotColOfRow[i]);
             }
         }
+        return res;
+    }
 
-        for(unsigned int col = lastCol; col < firstCol + numCol; ++col)
+    unsigned int RankComputer::computeRank() const
+    {
+        if (m_packed)
         {
-            ranks[col-firstCol] = rank;
+            return countSetBits(~m_packedColumnsWithoutPivot & lowBitsMask(m_nCols));
         }
+        return m_nCols - (unsigned int) m_columnsWithoutPivot.count();
+    }
 
+    std::vector<unsigned int> RankComputer::computeRanks(unsigned int firstCol, unsigned int numCol) const
+    {
+        std::vector<unsigned int> ranks;
+        computeRanks(firstCol, numCol, ranks);
         return ranks;
     }
 
-    unsigned int RankComputer::pivotRowAndFindNewPivot(unsigned int rowIndex)
+    void RankComputer::computeRanks(unsigned int firstCol, unsigned int numCol, std::vector<unsigned int>& ranks) const
     {
+        ranks.resize(numCol);
 
-        for( const auto& colRowPivot : m_pivotsColRowPositions)
+        if (m_packed)
         {
-            
-            if (m_redMat(rowIndex,colRowPivot.first)) // if required, use the pivot to flip this bit
+            const PackedRow pivotCols = ~m_packedColumnsWithoutPivot & lowBitsMask(m_nCols);
+            unsigned int rank = countSetBits(pivotCols & lowBitsMask(firstCol)); // number of pivots before the first column
+            for(unsigned int col = 0; col < numCol; ++col)
             {
-                m_rowOperations[rowIndex] = m_rowOperations[rowIndex] ^ m_rowOperations[colRowPivot.second];
-                m_redMat[rowIndex] = m_redMat[rowIndex] ^ m_redMat[colRowPivot.second];
+                if (firstCol + col < m_nCols)
+                {
+                    rank += (pivotCols >> (firstCol + col)) & 1;
+                }
+                ranks[col] = rank; // number of pivots up to this column
             }
+            return;
         }
 
-        unsigned int newPivotColPosition = m_nCols;
-        for(std::set<unsigned int>::iterator it = m_columnsWithoutPivot.begin(); it != m_columnsWithoutPivot.end(); ++it)
+        unsigned int rank = 0; // number of pivots before the first column
+        for(unsigned int col = 0; col < firstCol && col < m_nCols; ++col)
         {
-            if(m_redMat(rowIndex, *it))
+            rank += !m_columnsWithoutPivot[col];
+        }
+        for(unsigned int col = 0; col < numCol; ++col)
+        {
+            if (firstCol + col < m_nCols && !m_columnsWithoutPivot[firstCol + col])
             {
-                newPivotColPosition = *it;
-                m_columnsWithoutPivot.erase(it); // this column will have a pivot
-                break;
+                ++rank;
             }
+            ranks[col] = rank; // number of pivots up to this column
+        }
+    }
+
+    unsigned int RankComputer::pivotRowAndFindNewPivot(unsigned int rowIndex)
+    {
+        GeneratingMatrix::Row& row = m_redMat[rowIndex];
+        GeneratingMatrix::Row& rowOperations = m_rowOperations[rowIndex];
+
+        // pivot rows vanish on the other pivot columns, so the bits to flip can be read once
+        m_scratchRow = row;
+        m_scratchRow -= m_columnsWithoutPivot;
+        for(auto col = m_scratchRow.find_first(); col != GeneratingMatrix::Row::npos; col = m_scratchRow.find_next(col))
+        {
+            const unsigned int pivotRow = m_pivotRowOfCol[col];
+            row ^= m_redMat[pivotRow];
+            rowOperations ^= m_rowOperations[pivotRow];
         }
 
-        if (newPivotColPosition < m_nCols) // if such a pivot exists
+        m_scratchRow = row;
+        m_scratchRow &= m_columnsWithoutPivot;
+        const auto candidate = m_scratchRow.find_first();
+        if (candidate == GeneratingMatrix::Row::npos) // if no pivot exists
         {
-            
-            m_pivotsColRowPositions[newPivotColPosition] = rowIndex;
-            m_pivotsRowColPositions[rowIndex] = newPivotColPosition;
-            for(unsigned int i = 0; i < m_nRows; ++i) // for each rowIndex above the inserted rowIndex
+            m_rowsWithoutPivot.set(rowIndex);
+            return m_nCols;
+        }
+
+        const unsigned int newPivotColPosition = (unsigned int) candidate;
+        m_columnsWithoutPivot.reset(newPivotColPosition);
+        m_rowsWithoutPivot.reset(rowIndex);
+        m_pivotRowOfCol[newPivotColPosition] = rowIndex;
+        m_pivotColOfRow[rowIndex] = newPivotColPosition;
+        for(unsigned int i = 0; i < m_nRows; ++i) // use the row to flip this bit in the other rows
+        {
+            if(i != rowIndex && m_redMat(i, newPivotColPosition))
             {
-                if(i != rowIndex && m_redMat(i, newPivotColPosition)) // if required, use the rowIndex to flip this bit
+                if (!m_checkpoints.empty() && !m_checkpoints.back().packed && i < m_checkpoints.back().nRows)
                 {
-                    m_redMat[i] = m_redMat[i] ^ m_redMat[rowIndex];
-                    m_rowOperations[i] = m_rowOperations[i] ^ m_rowOperations[rowIndex];
+                    m_journal.push_back({i, m_redMat[i], m_rowOperations[i]});
                 }
+                m_redMat[i] ^= row;
+                m_rowOperations[i] ^= rowOperations;
             }
-            
         }
-        else // if not
+        return newPivotColPosition;
+    }
+
+
+    unsigned int RankComputer::pivotPackedRowAndFindNewPivot(unsigned int rowIndex)
+    {
+        PackedRow& row = m_packedRedMat[rowIndex];
+        PackedRow& rowOperations = m_packedRowOperations[rowIndex];
+
+        // pivot rows vanish on the other pivot columns, so the bits to flip can be read once
+        for(PackedRow toFlip = row & ~m_packedColumnsWithoutPivot & lowBitsMask(m_nCols); toFlip; toFlip &= toFlip - 1)
+        {
+            const unsigned int pivotRow = m_packedPivotRowOfCol[lowestSetBit(toFlip)];
+            row ^= m_packedRedMat[pivotRow];
+            rowOperations ^= m_packedRowOperations[pivotRow];
+        }
+
+        const PackedRow candidates = row & m_packedColumnsWithoutPivot;
+        if (!candidates) // if no pivot exists
+        {
+            m_packedRowsWithoutPivot |= PackedRow(1) << rowIndex;
+            return m_nCols;
+        }
+
+        const unsigned int newPivotColPosition = lowestSetBit(candidates);
+        const PackedRow pivotBit = PackedRow(1) << newPivotColPosition;
+        m_packedColumnsWithoutPivot &= ~pivotBit;
+        m_packedRowsWithoutPivot &= ~(PackedRow(1) << rowIndex);
+        m_packedPivotRowOfCol[newPivotColPosition] = rowIndex;
+        m_packedPivotColOfRow[rowIndex] = newPivotColPosition;
+        if (!m_checkpoints.empty()) // journal the rows of the checkpoint flipped below
         {
-            m_rowsWithoutPivot.push_back(rowIndex);
+            const unsigned int checkpointRows = std::min(m_nRows, m_checkpoints.back().nRows);
+            for(unsigned int i = 0; i < checkpointRows; ++i)
+            {
+                if (i != rowIndex && (m_packedRedMat[i] & pivotBit))
+                {
+                    m_packedJournal.push_back({i, m_packedRedMat[i], m_packedRowOperations[i]});
+                }
+            }
         }
+        // use the row to flip this bit in the other rows
+        eliminatePackedColumn(m_packedRedMat.data(), m_packedRowOperations.data(), m_nRows, rowIndex, pivotBit);
         return newPivotColPosition;
     }
 
+    void RankComputer::addPackedRow(PackedRow newRow)
+    {
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+        unsigned int row = m_nRows;
+        ++m_nRows;
+        m_packedRedMat[row] = newRow;
+        m_packedRowOperations[row] = PackedRow(1) << row;
+        m_packedPivotColOfRow[row] = noPivot;
+
+        pivotPackedRowAndFindNewPivot(row);
+
+        const PackedRow pivotCols = ~m_packedColumnsWithoutPivot & lowBitsMask(m_nCols);
+        if (countSetBits(pivotCols) < m_nRows)
+        {
+            m_smallestFullRank = m_nCols + 1;
+        }
+        else
+        {
+            m_smallestFullRank = highestSetBit(pivotCols) + 1;
+        }
+    }
+
+    void RankComputer::addRow(const GeneratingMatrix& matrix, unsigned int row)
+    {
+        if (m_packed && m_nRows < GeneratingMatrix::maxPackedCols && matrix.nCols() <= GeneratingMatrix::maxPackedCols)
+        {
+            addPackedRow(matrix.packedRow(row) & lowBitsMask(m_nCols));
+        }
+        else
+        {
+            addRow(matrix.subMatrix(row, 0, 1, m_nCols));
+        }
+    }
 
     void RankComputer::addRow(GeneratingMatrix newRow)
     {
+        if (m_packed)
+        {
+            if (m_nRows < GeneratingMatrix::maxPackedCols && newRow.nCols() <= GeneratingMatrix::maxPackedCols)
+            {
+                addPackedRow(newRow.packedRow(0) & lowBitsMask(m_nCols));
+                return;
+            }
+            unpack(); // the row operations no longer fit in packed rows
+        }
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+
         unsigned int row = m_nRows;
         ++m_nRows;
         m_rowOperations.resize(m_nRows, m_nRows);
@@ -146,21 +460,87 @@ namespace NetBuilder{
         m_redMat.stackBelow(std::move(newRow));
         #endif
 
+        m_pivotColOfRow.push_back(noPivot);
+        m_rowsWithoutPivot.push_back(false);
+
         pivotRowAndFindNewPivot(row);
 
-        if (m_pivotsColRowPositions.size() < m_nRows)
+        if (computeRank() < m_nRows)
         {
             m_smallestFullRank = m_nCols + 1;
         }
         else
         {
-            m_smallestFullRank = (*std::max_element(m_pivotsColRowPositions.begin(), m_pivotsColRowPositions.end())).first + 1;
+            unsigned int col = m_nCols;
+            while (m_columnsWithoutPivot[col - 1]) // a pivot exists since the rank is positive
+            {
+                --col;
+            }
+            m_smallestFullRank = col; // the highest pivot column plus one
         }
 
     }
 
     void RankComputer::addColumn(GeneratingMatrix newCol)
     {
+        discardCheckpoint();
+        if (m_packed && m_nCols < GeneratingMatrix::maxPackedCols)
+        {
+            PackedRow packedCol = 0;
+            for(unsigned int i = 0; i < m_nRows; ++i)
+            {
+                packedCol |= PackedRow(newCol(i, 0)) << i;
+            }
+
+            const unsigned int col = m_nCols;
+            const PackedRow colBit = PackedRow(1) << col;
+            ++m_nCols;
+
+            for(unsigned int i = 0; i < m_nRows; ++i) // apply the row operations to the new column
+            {
+                if (countSetBits(m_packedRowOperations[i] & packedCol) & 1)
+                {
+                    m_packedRedMat[i] |= colBit;
+                }
+            }
+
+            PackedRow candidates = 0;
+            for(unsigned int i = 0; i < m_nRows; ++i)
+            {
+                if (m_packedRedMat[i] & colBit)
+                {
+                    candidates |= PackedRow(1) << i;
+                }
+            }
+            candidates &= m_packedRowsWithoutPivot;
+
+            if (candidates)
+            {
+                const unsigned int newPivotRowPosition = lowestSetBit(candidates);
+                m_packedRowsWithoutPivot &= ~(PackedRow(1) << newPivotRowPosition);
+                m_packedPivotRowOfCol[col] = newPivotRowPosition;
+                m_packedPivotColOfRow[newPivotRowPosition] = col;
+
+                for(unsigned int i = 0; i < m_nRows; ++i)
+                {
+                    if (i != newPivotRowPosition && (m_packedRedMat[i] & colBit))
+                    {
+                        m_packedRedMat[i] ^= colBit;
+                        m_packedRowOperations[i] ^= m_packedRowOperations[newPivotRowPosition];
+                    }
+                }
+            }
+            else
+            {
+                m_packedColumnsWithoutPivot |= colBit;
+            }
+            return;
+        }
+        if (m_packed)
+        {
+            unpack(); // the new column does not fit in packed rows
+        }
+
         newCol = m_rowOperations * newCol; // apply the row operations to the new column
         m_redMat.stackRight(newCol); // stack right the new column
 
@@ -170,22 +550,24 @@ namespace NetBuilder{
 
         unsigned int col = m_nCols;
         ++m_nCols;
+        m_pivotRowOfCol.push_back(noPivot);
+        m_columnsWithoutPivot.push_back(false);
 
         unsigned int newPivotRowPosition = m_nRows;
-        for(std::list<unsigned int>::iterator it = m_rowsWithoutPivot.begin(); it != m_rowsWithoutPivot.end(); ++it)
+        for(auto row = m_rowsWithoutPivot.find_first(); row != GeneratingMatrix::Row::npos; row = m_rowsWithoutPivot.find_next(row))
         {
-            if(m_redMat(*it,col))
+            if(m_redMat((unsigned int) row, col))
             {
-                newPivotRowPosition = *it;
-                m_rowsWithoutPivot.erase(it); // this row will have a pivot
+                newPivotRowPosition = (unsigned int) row;
+                m_rowsWithoutPivot.reset(row); // this row will have a pivot
                 break;
             }
         }
 
         if(newPivotRowPosition < m_nRows)
         {
-            m_pivotsColRowPositions[col] = newPivotRowPosition;
-            m_pivotsRowColPositions[newPivotRowPosition] = col;
+            m_pivotRowOfCol[col] = newPivotRowPosition;
+            m_pivotColOfRow[newPivotRowPosition] = col;
 
             for(unsigned int i = 0; i < m_nRows; ++i)
             {
@@ -198,17 +580,99 @@ namespace NetBuilder{
         }
         else
         {
-            m_columnsWithoutPivot.insert(col);
+            m_columnsWithoutPivot.set(col);
+        }
+    }
+
+    void RankComputer::replacePackedRow(unsigned int rowIndex, PackedRow newRow)
+    {
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+        const PackedRow rowBit = PackedRow(1) << rowIndex;
+        const unsigned int colPositionPivot = m_packedPivotColOfRow[rowIndex];
+
+        if (colPositionPivot != noPivot)
+        {
+            unsigned int firstRowToDepivot = 0;
+            if (!(m_packedRowOperations[rowIndex] & rowBit))
+            {
+                for(unsigned int tmpIndex = 0; tmpIndex < m_nRows; ++tmpIndex)
+                {
+                    if (m_packedRowOperations[tmpIndex] & rowBit)
+                    {
+                        std::swap(m_packedRedMat[tmpIndex], m_packedRedMat[rowIndex]);
+                        std::swap(m_packedRowOperations[tmpIndex], m_packedRowOperations[rowIndex]);
+
+                        if (m_packedPivotColOfRow[tmpIndex] != noPivot)
+                        {
+                            m_packedColumnsWithoutPivot |= PackedRow(1) << m_packedPivotColOfRow[tmpIndex];
+                        }
+
+                        m_packedPivotColOfRow[rowIndex] = noPivot;
+                        m_packedPivotRowOfCol[colPositionPivot] = tmpIndex;
+                        m_packedPivotColOfRow[tmpIndex] = colPositionPivot;
+                        m_packedRowsWithoutPivot &= ~(PackedRow(1) << tmpIndex);
+
+                        firstRowToDepivot = tmpIndex+1;
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                m_packedPivotColOfRow[rowIndex] = noPivot;
+                m_packedColumnsWithoutPivot |= PackedRow(1) << colPositionPivot;
+            }
+
+            for(unsigned int i = firstRowToDepivot; i < m_nRows; ++i)
+            {
+                if (i != rowIndex && (m_packedRowOperations[i] & rowBit))
+                {
+                    m_packedRedMat[i] ^= m_packedRedMat[rowIndex];
+                    m_packedRowOperations[i] ^= m_packedRowOperations[rowIndex];
+                }
+            }
+        }
+
+        m_packedRedMat[rowIndex] = newRow;
+        m_packedRowOperations[rowIndex] = rowBit;
+        m_packedRowsWithoutPivot &= ~rowBit;
+
+        unsigned int newPivotPos = pivotPackedRowAndFindNewPivot(rowIndex);
+
+        m_smallestFullRank = std::max(m_smallestFullRank, newPivotPos + 1);
+    }
+
+    void RankComputer::replaceRow(unsigned int rowIndex, const GeneratingMatrix& matrix, unsigned int row, int verbose)
+    {
+        discardCheckpoint();
+        if (m_packed && matrix.nCols() <= GeneratingMatrix::maxPackedCols)
+        {
+            replacePackedRow(rowIndex, matrix.packedRow(row) & lowBitsMask(m_nCols));
+        }
+        else
+        {
+            replaceRow(rowIndex, matrix.subMatrix(row, 0, 1, m_nCols), verbose);
         }
     }
 
     void RankComputer::replaceRow(unsigned int rowIndex, GeneratingMatrix&& newRow, int verbose)
     {
-        auto rowIndexColPivPos = m_pivotsRowColPositions.find(rowIndex);
+        discardCheckpoint();
+        if (m_packed && newRow.nCols() <= GeneratingMatrix::maxPackedCols)
+        {
+            replacePackedRow(rowIndex, newRow.packedRow(0) & lowBitsMask(m_nCols));
+            return;
+        }
+        if (m_packed)
+        {
+            unpack();
+        }
+        LatBuilder::Profiler::count(LatBuilder::Profiler::Counter::RANK_OPERATIONS);
+
+        const unsigned int colPositionPivot = m_pivotColOfRow[rowIndex];
 
-        if (rowIndexColPivPos != m_pivotsRowColPositions.end())
+        if (colPositionPivot != noPivot)
         {
-            unsigned int colPositionPivot = (*rowIndexColPivPos).second;
             unsigned int firstRowToDepivot = 0;
             if (m_rowOperations(rowIndex, rowIndex) != 1){
                 for(unsigned int tmpIndex = 0; tmpIndex < m_nRows; ++tmpIndex)
@@ -217,18 +681,16 @@ namespace NetBuilder{
                         m_redMat.swapRows(tmpIndex, rowIndex);
                         m_rowOperations.swapRows(tmpIndex, rowIndex);
 
-                        auto tmpIndexPivPos = m_pivotsRowColPositions.find(tmpIndex);
-                        int tmpIndexColPivPos;
-                        if(tmpIndexPivPos != m_pivotsRowColPositions.end())
+                        if (m_pivotColOfRow[tmpIndex] != noPivot)
                         {
-                            tmpIndexColPivPos = (*tmpIndexPivPos).second;
-                            m_pivotsColRowPositions.erase(tmpIndexColPivPos);
-                            m_columnsWithoutPivot.insert(tmpIndexColPivPos);
+                            m_pivotRowOfCol[m_pivotColOfRow[tmpIndex]] = noPivot;
+                            m_columnsWithoutPivot.set(m_pivotColOfRow[tmpIndex]);
                         }
                         
-                        m_pivotsRowColPositions.erase(rowIndex);
-                        m_pivotsColRowPositions[colPositionPivot] = tmpIndex;
-                        m_pivotsRowColPositions[tmpIndex] = colPositionPivot;
+                        m_pivotColOfRow[rowIndex] = noPivot;
+                        m_pivotRowOfCol[colPositionPivot] = tmpIndex;
+                        m_pivotColOfRow[tmpIndex] = colPositionPivot;
+                        m_rowsWithoutPivot.reset(tmpIndex);
                         
                         firstRowToDepivot = tmpIndex+1;
                         break;
@@ -236,17 +698,17 @@ namespace NetBuilder{
                 }
             }
             else{
-                m_pivotsRowColPositions.erase(rowIndex);
-                m_pivotsColRowPositions.erase(colPositionPivot);
-                m_columnsWithoutPivot.insert(colPositionPivot);
+                m_pivotColOfRow[rowIndex] = noPivot;
+                m_pivotRowOfCol[colPositionPivot] = noPivot;
+                m_columnsWithoutPivot.set(colPositionPivot);
             }
 
             for(unsigned int i = firstRowToDepivot; i < m_nRows; ++i)
             {
                 if(i!=rowIndex && m_rowOperations(i,rowIndex))
                 {
-                    m_redMat[i] = m_redMat[i] ^ m_redMat[rowIndex];
-                    m_rowOperations[i] = m_rowOperations[i] ^ m_rowOperations[rowIndex];
+                    m_redMat[i] ^= m_redMat[rowIndex];
+                    m_rowOperations[i] ^= m_rowOperations[rowIndex];
                 }
             }
         }
@@ -260,6 +722,7 @@ namespace NetBuilder{
 
         m_rowOperations[rowIndex].reset();
         m_rowOperations(rowIndex, rowIndex) = 1;
+        m_rowsWithoutPivot.reset(rowIndex);
 
         unsigned int newPivotPos = pivotRowAndFindNewPivot(rowIndex);
 
@@ -311,7 +774,7 @@ void RankComputer::check(){
 
     if (!checkIfInvertible(m_rowOperations))
     {
-        throw std::runtime_error("Row operations matrix is not invertible.")
+        throw std::runtime_error("Row operations matrix is not invertible.");
     }
 
     std::vector<bool> check_row (m_nRows, 0);
@@ -326,43 +789,40 @@ void RankComputer::check(){
         }
     }
 
-    for (const auto& colRow : m_pivotsColRowPositions){
-        unsigned int col = colRow.first;
-        unsigned int row = colRow.second;
+    for (unsigned int col = 0; col < m_nCols; ++col){
+        unsigned int row = m_pivotRowOfCol[col];
+        if (row == noPivot){
+            if (!m_columnsWithoutPivot[col]){
+                throw std::runtime_error("Column without pivot missing from the columns without pivot.");
+            }
+            check_col[col] = 1;
+            continue;
+        }
+        if (m_columnsWithoutPivot[col]){
+            throw std::runtime_error("Column with pivot in the columns without pivot.");
+        }
+        if (m_pivotColOfRow[row] != col){
+            throw std::runtime_error("Pivot rows of columns and pivot columns of rows are incompatible.");
+        }
         for (unsigned int i=0; i < m_nRows; i++){
             if (m_redMat(i, col) != (i == row)){
                 throw std::runtime_error("A column containing a pivot has not the good property.");
             }
         }
+        if (check_row[row] != 0){
+            throw std::runtime_error("Row with several pivots.");
+        }
         check_row[row] = 1;
         check_col[col] = 1;
     }
 
-    for (const auto& rowCol : m_pivotsRowColPositions){
-        unsigned int row = rowCol.first;
-        unsigned int col = rowCol.second;
-        if (check_row[row] != 1 || check_col[col] != 1){
-            throw std::runtime_error("RowCol and ColRow maps are incompatible (1) .");
-        }
-        if (m_pivotsColRowPositions[col] != row){
-            throw std::runtime_error("RowCol and ColRow maps are incompatible (2) .");
-        }
-    }
-    if (m_pivotsColRowPositions.size() != m_pivotsRowColPositions.size()){
-        throw std::runtime_error("RowCol and ColRow maps are incompatible (3) .");
-    }
-
-    for (const auto& col: m_columnsWithoutPivot){
-        if (check_col[col] != 0){
-            throw std::runtime_error("Column without pivot in pivot map.");
+    for (unsigned int row = 0; row < m_nRows; ++row){
+        if ((m_pivotColOfRow[row] == noPivot) != m_rowsWithoutPivot[row]){
+            throw std::runtime_error("Rows without pivot are incompatible with the pivot columns of rows.");
         }
-        check_col[col] = 1;
-    }
-    for (const auto& row: m_rowsWithoutPivot){
-        if (check_row[row] != 0){
-            throw std::runtime_error("Row without pivot in pivot map.");
+        if (m_pivotColOfRow[row] == noPivot){
+            check_row[row] = 1;
         }
-        check_row[row] = 1;
     }
 
     for (const auto& r: check_row){
@@ -0,0 +1,118 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "netbuilder/ResultCache.h"
+
+#include "latbuilder/StateIO.h"
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+
+namespace NetBuilder {
+
+namespace {
+
+    /*
+     * File format: the magic string, the version, the description, the dimension, the key, the generating
+     * values and the merit values, written with LatBuilder::StateIO.
+     */
+    const std::string MAGIC = "LatNetBuilder result";
+    const std::uint32_t VERSION = 1;
+}
+
+ResultCache::ResultCache(std::string directory):
+    m_directory(std::move(directory))
+{
+    boost::filesystem::create_directories(m_directory);
+}
+
+std::string ResultCache::fileName(const std::string& description, Dimension dimension) const
+{
+    std::ostringstream os;
+    os << m_directory << "/result-" << std::hex << std::hash<std::string>()(description + "\n" + std::to_string(dimension)) << ".bin";
+    return os.str();
+}
+
+bool ResultCache::read(const std::string& description, Dimension dimension, Entry& entry) const
+{
+    using LatBuilder::StateIO::read;
+    std::ifstream file(fileName(description, dimension), std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    try
+    {
+        // the entries of another version, or of another description with the same hash, are ignored
+        std::string magic, savedDescription;
+        std::uint32_t version;
+        std::uint64_t savedDimension;
+        read(file, magic);
+        read(file, version);
+        if (magic != MAGIC || version != VERSION)
+        {
+            return false;
+        }
+        read(file, savedDescription);
+        read(file, savedDimension);
+        if (savedDescription != description || savedDimension != dimension)
+        {
+            return false;
+        }
+        read(file, entry.key);
+        read(file, entry.genValues);
+        read(file, entry.merits);
+    }
+    catch (const std::runtime_error&)
+    {
+        return false;
+    }
+    return true;
+}
+
+void ResultCache::write(const std::string& description, Dimension dimension, const Entry& entry) const
+{
+    using LatBuilder::StateIO::write;
+    const std::string name = fileName(description, dimension);
+    const std::string tmpName = name + ".tmp";
+    {
+        std::ofstream file(tmpName, std::ios::binary);
+        write(file, MAGIC);
+        write(file, VERSION);
+        write(file, description);
+        write(file, static_cast<std::uint64_t>(dimension));
+        write(file, entry.key);
+        write(file, entry.genValues);
+        write(file, entry.merits);
+        if (!file)
+        {
+            throw std::runtime_error("cannot write the result cache entry " + tmpName);
+        }
+    }
+    if (std::rename(tmpName.c_str(), name.c_str()) != 0)
+    {
+        throw std::runtime_error("cannot rename " + tmpName + " to " + name);
+    }
+}
+
+}
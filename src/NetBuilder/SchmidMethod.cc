@@ -18,6 +18,8 @@
 #include "netbuilder/Types.h"
 #include "netbuilder/Helpers/CompositionMaker.h"
 
+#include <algorithm>
+#include <array>
 #include <list>
 
 namespace NetBuilder {
@@ -31,15 +33,252 @@ getmsb (unsigned long long x)
     return r;
 }
 
-typedef GeneratingMatrix GeneratingMatrix;
+namespace {
 
-unsigned int SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices, unsigned int maxTValuesSubProj, int verbose=0)
+/**
+ * Access to the rows of the generating matrices as dynamic bitsets, for matrices of any size.
+ */ 
+class BitsetRows
 {
-    unsigned int m = matrices[0].nCols();
-    unsigned int s = (unsigned int)matrices.size();
+    public:
+        typedef GeneratingMatrix::Row Row;
 
-    if (s==1){ return 0; } 
+        BitsetRows(std::vector<GeneratingMatrix>& matrices):
+            m_matrices(matrices)
+        {};
+
+        const Row& operator()(Dimension coord, unsigned int j) const { return m_matrices[coord][j]; }
+
+        static Row zero(unsigned int m) { return Row(m); }
+
+        static bool none(const Row& v) { return v.none(); }
+
+        static unsigned int numberOfZeros(const Row& v, unsigned int m)
+        {
+            auto pos = v.find_first();
+            return (pos == Row::npos) ? m : (unsigned int) pos;
+        }
+
+    private:
+        std::vector<GeneratingMatrix>& m_matrices;
+};
+
+/**
+ * Access to the rows of the generating matrices as words, for matrices with at most 
+ * GeneratingMatrix::maxPackedCols columns.
+ */ 
+class PackedRows
+{
+    public:
+        typedef GeneratingMatrix::PackedRow Row;
+
+        PackedRows(const std::vector<GeneratingMatrix>& matrices):
+            m_rows(matrices.size())
+        {
+            for(Dimension coord = 0; coord < matrices.size(); ++coord)
+            {
+                m_rows[coord].resize(matrices[coord].nRows());
+                for(unsigned int j = 0; j < matrices[coord].nRows(); ++j)
+                {
+                    m_rows[coord][j] = matrices[coord].packedRow(j);
+                }
+            }
+        };
+
+        const Row& operator()(Dimension coord, unsigned int j) const { return m_rows[coord][j]; }
+
+        static Row zero(unsigned int m) { return 0; }
+
+        static bool none(Row v) { return !v; }
+
+        static unsigned int numberOfZeros(Row v, unsigned int m) { return v ? lowestSetBit(v) : m; }
+
+    private:
+        std::vector<std::vector<Row>> m_rows;
+};
+
+/**
+ * Enumeration of the linear combinations of at most GeneratingMatrix::maxPackedCols word-packed rows by blocks.
+ * 
+ * The \f$ 2^b \f$ combinations of the first \f$ b \f$ rows, with \f$ b \f$ at most #blockRows, are tabulated. The combinations of 
+ * the remaining rows are enumerated in the Gray code order and each of them is combined with the whole table at once, with 
+ * a loop of XORs and OR-reductions without branches which the compiler can vectorize.
+ */ 
+class PackedCombinationBlocks
+{
+    public:
+        typedef GeneratingMatrix::PackedRow Row;
+
+        /// Maximal number of rows in the table, so that each step processes 256 combinations.
+        static constexpr unsigned int blockRows = 8;
+
+        /**
+         * Constructs the enumeration of the combinations of the rows \c rows.
+         */ 
+        PackedCombinationBlocks(const std::vector<Row>& rows):
+            m_rows(rows),
+            m_blockRows(std::min((unsigned int) rows.size(), blockRows)),
+            m_blockSize(1u << m_blockRows)
+        {
+            m_table[0] = 0;
+            for(unsigned int i = 0; i < m_blockRows; ++i)
+            {
+                const unsigned int half = 1u << i;
+                for(unsigned int x = 0; x < half; ++x)
+                {
+                    m_table[half + x] = m_table[x] ^ m_rows[i];
+                }
+            }
+        }
 
+        /**
+         * Returns true if a non-trivial combination of the rows is zero, that is if the rows are linearly dependent.
+         */ 
+        bool hasZeroCombination() const
+        {
+            bool found = false;
+            forEachBlock([&found](const Row* table, unsigned int size, Row high)
+            {
+                Row zero = 0;
+                for(unsigned int x = 0; x < size; ++x)
+                {
+                    zero |= (table[x] == high);
+                }
+                found = (zero != 0);
+                return found;
+            });
+            return found;
+        }
+
+        /**
+         * Returns the maximal number of trailing zeros of the non-trivial combinations of the rows, 
+         * where the zero combination has \c m trailing zeros.
+         */ 
+        unsigned int maxNumberOfZeros(unsigned int m) const
+        {
+            Row lowestBits = 0; // union of the lowest set bits of the combinations
+            bool found = false;
+            forEachBlock([&lowestBits, &found](const Row* table, unsigned int size, Row high)
+            {
+                Row zero = 0;
+                Row bits = 0;
+                for(unsigned int x = 0; x < size; ++x)
+                {
+                    const Row v = table[x] ^ high;
+                    bits |= v & (~v + 1);
+                    zero |= (v == 0);
+                }
+                lowestBits |= bits;
+                found = (zero != 0);
+                return found;
+            });
+            return found ? m : highestSetBit(lowestBits);
+        }
+
+    private:
+        /*
+         * Calls f(table, size, high) for each combination high of the rows outside the table, where the combinations 
+         * high ^ table[x] for x < size are the next combinations to examine, until f returns true. The trivial combination 
+         * is skipped.
+         */ 
+        template<typename FUNC>
+        void forEachBlock(FUNC f) const
+        {
+            const unsigned int highRows = (unsigned int) m_rows.size() - m_blockRows;
+            if (f(m_table.data() + 1, m_blockSize - 1, 0))
+            {
+                return;
+            }
+            Row high = 0;
+            for(uInteger g = 1; g < (uInteger(1) << highRows); ++g)
+            {
+                high ^= m_rows[m_blockRows + lowestSetBit(g)];
+                if (f(m_table.data(), m_blockSize, high))
+                {
+                    return;
+                }
+            }
+        }
+
+        const std::vector<Row>& m_rows;
+        unsigned int m_blockRows;
+        unsigned int m_blockSize;
+        std::array<Row, 1u << blockRows> m_table;
+};
+
+constexpr unsigned int PackedCombinationBlocks::blockRows;
+
+/**
+ * Collects the rows of the composition \c comp: the first \c comp[coord] rows of each coordinate \c coord.
+ */ 
+void compositionRows(const PackedRows& rows, const std::vector<unsigned int>& comp, std::vector<GeneratingMatrix::PackedRow>& res)
+{
+    res.clear();
+    for(Dimension coord = 0; coord < comp.size(); ++coord)
+    {
+        for(unsigned int j = 0; j < comp[coord]; ++j)
+        {
+            res.push_back(rows(coord, j));
+        }
+    }
+}
+
+unsigned int computeTValueWithBlocks(const PackedRows& rows, unsigned int m, unsigned int s, unsigned int maxTValuesSubProj)
+{
+    std::vector<GeneratingMatrix::PackedRow> tmp;
+    for(unsigned int k = s ; k <= m-maxTValuesSubProj; ++k)
+    {
+        CompositionMaker compMaker(k,s);
+        do
+        { 
+            compositionRows(rows, compMaker.currentComposition(), tmp);
+            if (PackedCombinationBlocks(tmp).hasZeroCombination())
+            {
+                return m-(k-1);
+            }
+        }
+        while(compMaker.goToNextComposition());
+    }
+    return maxTValuesSubProj;
+}
+
+std::vector<unsigned int> computeTValueWithBlocks(const PackedRows& rows, unsigned int m, unsigned int s, const std::vector<unsigned int>& maxTValuesSubProj)
+{
+    std::vector<unsigned int> res = maxTValuesSubProj;
+    std::vector<GeneratingMatrix::PackedRow> tmp;
+
+    unsigned int nextToCompute = s-1;
+    for(unsigned int k = s ; k <= m-maxTValuesSubProj.back(); ++k)
+    {
+        CompositionMaker compMaker(k, s);
+        do
+        {
+            compositionRows(rows, compMaker.currentComposition(), tmp);
+            unsigned int numberOfZeros = PackedCombinationBlocks(tmp).maxNumberOfZeros(m);
+
+            for(unsigned int i = nextToCompute; i < numberOfZeros; ++i)
+            {
+                res[i] = std::max(i+1-(k-1), res[i]);
+            }
+
+            if (nextToCompute < numberOfZeros)
+            {
+                nextToCompute = numberOfZeros;
+            }
+
+            if (nextToCompute == m)
+            {
+                return res;
+            }
+        }
+        while(compMaker.goToNextComposition());
+    }
+    return res;
+}
+
+template<typename ROWS>
+unsigned int computeTValueWithRows(const ROWS& rows, unsigned int m, unsigned int s, unsigned int maxTValuesSubProj)
+{
     uInteger upperLimit = (1<<(m-maxTValuesSubProj))-1;
     std::vector<unsigned int> flipingOrder(upperLimit);
     for(uInteger r = 0; r < upperLimit; ++r)
@@ -53,21 +292,21 @@ unsigned int SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices,
         do
         { 
             std::vector<unsigned int> comp = compMaker.currentComposition();
-            std::vector<GeneratingMatrix::Row*> tmp(k);
+            std::vector<const typename ROWS::Row*> tmp(k);
             unsigned int idx = 0;
             for(Dimension coord = 0; coord < s; ++coord)
             {
                 for(unsigned int j = 0; j < comp[coord]; ++j)
                 {
-                    tmp[idx] = &(matrices[coord][j]);
+                    tmp[idx] = &rows(coord, j);
                     ++idx;
                 }
             }
-            boost::dynamic_bitset<> v(m);
+            typename ROWS::Row v = ROWS::zero(m);
             for(uInteger r = 0; r < (unsigned int) ((1 << k) - 1); ++r)
             {
                 v ^= *tmp[flipingOrder[r]];
-                if (v.none())
+                if (ROWS::none(v))
                 {
                     return m-(k-1);
                 }
@@ -78,13 +317,9 @@ unsigned int SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices,
     return maxTValuesSubProj;
 }
 
-std::vector<unsigned int> SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose=0)
+template<typename ROWS>
+std::vector<unsigned int> computeTValueWithRows(const ROWS& rows, unsigned int m, unsigned int s, const std::vector<unsigned int>& maxTValuesSubProj)
 {
-    unsigned int m = matrices[0].nCols();
-    unsigned int s = (unsigned int)matrices.size();
-
-    if (s==1){ return std::vector<unsigned int>(m, 0); } 
-
     uInteger upperLimit ;
     std::vector<unsigned int> res = maxTValuesSubProj;
 
@@ -103,39 +338,34 @@ std::vector<unsigned int> SchmidMethod::computeTValue(std::vector<GeneratingMatr
         do
         {
             std::vector<unsigned int> comp = compMaker.currentComposition();
-            std::vector<GeneratingMatrix::Row*> tmp(k);
+            std::vector<const typename ROWS::Row*> tmp(k);
             unsigned int idx = 0;
             for(Dimension coord = 0; coord < s; ++coord)
             {
                 for(unsigned int j = 0; j < comp[coord]; ++j)
                 {
-                    tmp[idx] = &(matrices[coord][j]);
+                    tmp[idx] = &rows(coord, j);
                     ++idx;
                 }
             }
 
-            boost::dynamic_bitset<> v(m);
+            typename ROWS::Row v = ROWS::zero(m);
             unsigned int r = 0;
             unsigned int currentLimit = (unsigned int) ((1 << k) - 1);
             for(unsigned int flip : flipingOrder)
             {
                 v ^= *tmp[flip];
 
-                auto numberOfZeros = v.find_first();
-                
-                if (numberOfZeros == GeneratingMatrix::Row::npos)
-                {
-                    numberOfZeros = m;
-                }
+                unsigned int numberOfZeros = ROWS::numberOfZeros(v, m);
 
                 for(unsigned int i = nextToCompute; i < numberOfZeros; ++i)
                 {
                     res[i] = std::max(i+1-(k-1), res[i]);
                 }
 
-                if (nextToCompute < (unsigned int) numberOfZeros)
+                if (nextToCompute < numberOfZeros)
                 {
-                    nextToCompute = (unsigned int) numberOfZeros;
+                    nextToCompute = numberOfZeros;
                 }
 
                 if (nextToCompute == m)
@@ -155,5 +385,35 @@ std::vector<unsigned int> SchmidMethod::computeTValue(std::vector<GeneratingMatr
     return res;
 }
 
+}
+
+unsigned int SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices, unsigned int maxTValuesSubProj, int verbose=0)
+{
+    unsigned int m = matrices[0].nCols();
+    unsigned int s = (unsigned int)matrices.size();
+
+    if (s==1){ return 0; } 
+
+    if (m <= GeneratingMatrix::maxPackedCols)
+    {
+        return computeTValueWithBlocks(PackedRows(matrices), m, s, maxTValuesSubProj);
+    }
+    return computeTValueWithRows(BitsetRows(matrices), m, s, maxTValuesSubProj);
+}
+
+std::vector<unsigned int> SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose=0)
+{
+    unsigned int m = matrices[0].nCols();
+    unsigned int s = (unsigned int)matrices.size();
+
+    if (s==1){ return std::vector<unsigned int>(m, 0); } 
+
+    if (m <= GeneratingMatrix::maxPackedCols)
+    {
+        return computeTValueWithBlocks(PackedRows(matrices), m, s, maxTValuesSubProj);
+    }
+    return computeTValueWithRows(BitsetRows(matrices), m, s, maxTValuesSubProj);
+}
+
 
 }
\ No newline at end of file
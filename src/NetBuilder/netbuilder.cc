@@ -21,18 +21,43 @@
 #include <boost/program_options.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string/join.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
+#include <sstream>
 
+#include "netbuilder/NetBuilder.h"
 #include "netbuilder/Types.h"
-#include "netbuilder/Parser/CommandLine.h"
 #include "netbuilder/Parser/EmbeddingTypeParser.h"
 #include "netbuilder/Parser/NetConstructionParser.h"
-#include "netbuilder/Parser/OutputStyleParser.h"
+#include "netbuilder/Parser/ScramblingParser.h"
+#include "netbuilder/BinaryOutput.h"
+#include "netbuilder/PointGenerator.h"
+#include "netbuilder/Helpers/TValueCache.h"
 #include "netbuilder/Task/Task.h"
+#include "netbuilder/MakeTask.h"
 
 #include "latbuilder/Parser/Common.h"
+#include "latbuilder/Parser/PointFormat.h"
 #include "latbuilder/SizeParam.h"
+#include "latbuilder/ThreadPool.h"
+#include "latbuilder/Distributed.h"
+#include "latbuilder/ParallelRepeats.h"
+#include "latbuilder/Kernel/ValueCache.h"
+#include "latbuilder/Kernel/OnTheFly.h"
+#include "latbuilder/Norm/BoundCache.h"
+#include "latbuilder/NTTConvolution.h"
+#include "latbuilder/WeightedProjections.h"
+#include "latbuilder/fftw++.h"
+#include "latbuilder/StateMatrix.h"
+#include "latbuilder/Profiler.h"
+#include "latbuilder/Trace.h"
+#include "latbuilder/ProgressFeed.h"
+#include "latbuilder/Budget.h"
+#include "latbuilder/Checkpoint.h"
+#include "latbuilder/Shard.h"
+#include "latbuilder/Module.h"
 
 // using namespace LatBuilder;
 // using TextStream::operator<<;
@@ -69,19 +94,32 @@ makeOptionsDescription()
    ("exploration-method,e", po::value<std::string>(),
     "(required) exploration method; possible values:\n"
     "  evaluation:<net_description>\n" 
+    "  evaluation-batch:<file>[:<table>]\n"
     "  exhaustive\n"
+    "  exhaustive-DFS\n"
     "  random:<r>\n"
     "  full-CBC\n"
+    "  fast-CBC\n"
     "  random-CBC:<r>\n"
     "  mixed-CBC:<r>:<nb_full>\n"
-    "where <net_description> is a net description (see documentation), <r> is the number of samples, and <nb_full> the number of coordinates for which full CBC exploration is used.")
-   ("figure-of-merit,f", po::value<std::string>(),
+    "  adaptive-CBC:<r>:<batch>:<tolerance>[:<window>]\n"
+    "  beam-CBC:<width>[:<r>]\n"
+    "where <net_description> is a net description (see documentation), <file> a file of net descriptions, one by line, evaluated in parallel and whose merit values are written as a CSV table to <table> (default: standard output), <r> is the number of samples, and <nb_full> the number of coordinates for which full CBC exploration is used. "
+    "Adaptive CBC draws at most <r> samples by coordinate, by batches of <batch> samples, and stops a coordinate when the best merit improved by less than the relative <tolerance> over the last <window> batches (default: 2). "
+    "Beam CBC keeps the <width> best partial nets for each coordinate, and extends them with all the generating values, or with <r> random ones. "
+    "Exhaustive DFS explores the same nets coordinate by coordinate, depth first, and skips the extensions of the partial nets whose merit is already not below the best one (requires a figure of merit evaluated coordinate by coordinate). "
+    "Fast CBC is a full CBC exploration of unilevel polynomial nets with the CU:R or CU:P<alpha> figure, whose modulus is a power of an irreducible polynomial.")
+   ("figure-of-merit,f", po::value<std::vector<std::string>>()->multitoken(),
     "(required) type of figure of merit; format: <merit>\n"
+    "  the evaluation task accepts a whitespace-separated list of figures, evaluated on the same net and reported separately\n"
     "  and where <merit> is one of:\n"
     "    CU:P<alpha>  (requires l_2 norm)\n"
     "    CU:R (requires l_2 norm)\n"
     "    t-value (weights and norm-type are ignored)\n"
     "    projdep:t-value\n"
+    "    projdep:t-value:schmid\n"
+    "    projdep:t-value:dual\n"
+    "    projdep:t-value:auto\n"
     "    projdep:t-value:starDisc\n"
     "    projdep:resolution-gap\n"
     "    CU:IA<alpha> (only for interlaced digital nets, requires l_1 norm)\n"
@@ -119,25 +157,138 @@ makeOptionsDescription()
     "  sum\n"
     "  max\n"
     "  level:{<level>|max}\n")
+   ("progressive-levels", po::bool_switch(),
+    "(optional) with early abortion and the sum, max or level combiner, stop computing the multilevel t-values of a projection "
+    "as soon as one of the levels makes the combined merit exceed the bound; only for the projdep:t-value and projdep:t-value:auto figures\n")
+   ("skip-equivalent-nets", po::bool_switch(),
+    "(optional) with the exhaustive and random explorations, skip the candidate nets whose generating matrices are those "
+    "of a net evaluated before multiplied on the right by the same invertible (upper-triangular for multilevel nets) matrix; "
+    "the selected net is the same\n")
+   ("tvalue-profile", po::value<unsigned int>(),
+    "(optional) <order>: with the evaluation task, also write the t-value of each projection of the net of order at most <order> "
+    "to tvalues.txt in the output folder, one line <coordinates>: <t-value> per projection; the projections are enumerated once, "
+    "each one followed by its extensions by higher coordinates; the same t-values are written to tvalues.bin for --tvalue-table; "
+    "requires --output-folder\n")
+   ("tvalue-table", po::value<std::string>(),
+    "(optional) <file>: with the evaluation task, read the t-values of the projections of the net from the file tvalues.bin "
+    "written by --tvalue-profile for the same net, so that the t-value figures of merit are evaluated with other weights "
+    "or norm types without computing these t-values again\n")
+   ("threads", po::value<unsigned int>()->default_value(LatBuilder::ThreadPool::defaultNumThreads()),
+    "(optional) number of threads used to evaluate the candidate nets of CBC and exhaustive explorations, "
+    "or the projections of each net for the other tasks and projection-dependent figures; "
+    "0 means the number of hardware threads (default: the value of the environment variable LATNETBUILDER_THREADS, or 1)\n")
+   ("pin-threads", po::bool_switch(),
+    "(optional) pin each thread given by --threads, except the main one, to its own processor among those the process may run on, "
+    "so that it stays on the NUMA node where it first wrote its part of the state vectors (Linux only)\n")
    ("repeat,r", po::value<unsigned int>()->default_value(1),
     "(optional) number of times the construction must be executed\n"
    "(can be useful to obtain different results from random constructions)\n")
+   ("parallel-repeats", po::bool_switch(),
+    "(optional) execute the runs requested by --repeat concurrently on the threads given by --threads; "
+    "each run uses an independent stream of random numbers, and a summary of the merit values of the runs "
+    "is output with the result of the best run\n")
     ("verbose,v", po::value<std::string>()->default_value("0"),
    "specify the verbosity of the program;\n"
-   "ranges between 0 (default) and 3\n")
+   "ranges between 0 (default) and 3; 4 also displays the rejected nets of the searches of digital nets\n")
     ("output-folder,o", po::value<std::string>(),
     "(optional) path to the folder for the outputs of LatNeBuilder. The contents of the folder may be overwritten. If the folder does not exist, it is created. If no path is provided, no output folder is created.")
     ("output-style,O", po::value<std::string>()->default_value(""),
     "(optional) TBD\n")
+    ("output-binary", po::bool_switch(),
+    "(optional) also write the resulting net to output.bin in the output folder, in a versioned little-endian binary format "
+    "holding the generating matrices as packed 32-bit columns, the merit value and the elapsed time (see documentation); "
+    "requires --output-folder\n")
+    ("resume", po::bool_switch(),
+    "(optional) resume a CBC exploration from the checkpoint written to the output folder after each completed coordinate "
+    "by a previous run with the same arguments; requires --output-folder\n")
+    ("save-state", po::bool_switch(),
+    "(optional) write the states of the evaluators for the net found by a CBC exploration to state.bin in the output folder, "
+    "so that --resume-state can extend the net to more coordinates without evaluating its coordinates again; requires --output-folder\n")
+    ("resume-state", po::value<std::string>(),
+    "(optional) path to a state file written with --save-state; the CBC exploration extends the net of the file to the "
+    "dimension of the search, with the same figure of merit, instead of starting from an empty net\n")
+    ("shard", po::value<std::string>(),
+    "(optional) <index>/<count>: split the search into <count> independent jobs, and explore only the candidates of shard <index>, "
+    "with 0 <= <index> < <count>; the best candidate of the shard is written to shard.txt in the output folder, and the files of all "
+    "the shards are combined with latnetbuilder --merge-shards; exhaustive and random explorations explore their range of the "
+    "candidates or their share of the samples; full, random and mixed CBC explorations add a single coordinate to the net given by "
+    "--base-net (or explore the first coordinate); requires --output-folder\n")
+    ("base-net", po::value<std::string>(),
+    "(optional) path to a checkpoint file, such as the file written by latnetbuilder --merge-shards, whose coordinates are kept by the "
+    "CBC exploration, which searches the remaining coordinates\n")
+    ("result-cache", po::value<std::string>(),
+    "(optional) path to a folder where the resulting nets and merit values of the tasks are stored; a task identical to one "
+    "already executed with the same folder is answered without being executed, and a CBC exploration starts from the net of the "
+    "same exploration for the largest smaller dimension in the folder; if the folder does not exist, it is created\n")
+    ("output-points", po::value<std::string>(),
+    "(optional) path to a binary file where the points of the resulting net are written, one point after the other, "
+    "without any header. With an interlacing factor larger than one, the points are those of the interlaced net.\n")
+    ("output-points-format", po::value<std::string>()->default_value("float64"),
+    "(optional) format of the coordinates written to the file given by --output-points; possible values:\n"
+    "  float64 (default): native double-precision numbers in [0,1)\n"
+    "  uint32: coordinates multiplied by 2^32 and truncated, as native 32-bit unsigned integers\n")
+    ("output-points-scrambling", po::value<std::string>()->default_value("none"),
+    "(optional) randomization of the points written to the file given by --output-points; possible values:\n"
+    "  none (default): the points of the net\n"
+    "  digital-shift: a random digital shift\n"
+    "  lms: a random left matrix scramble followed by a random digital shift\n"
+    "  nested-uniform: a hash-based nested uniform (Owen) scrambling; requires an interlacing factor of one\n")
+    ("output-points-seed", po::value<unsigned long long>()->default_value(0),
+    "(optional) seed of the randomization given by --output-points-scrambling\n")
+    ("output-points-replicates", po::value<unsigned int>()->default_value(1),
+    "(optional) number of independent randomizations of the points written to the file given by --output-points, "
+    "one after the other; each replicate depends only on the seed and on its index\n")
     ("merit-digits-displayed", po::value<unsigned int>()->default_value(0),
-    "(optional) number of significant figures to use when displaying merit values\n");
+    "(optional) number of significant figures to use when displaying merit values\n")
+    ("kernel-cache", po::value<std::string>(),
+    "(optional) path to a folder where the tables of kernel values of coordinate-uniform figures are stored "
+    "and reused by later runs with the same kernel and size parameter; if the folder does not exist, it is created\n")
+    ("state-folder", po::value<std::string>(),
+    "(optional) path to a folder where the state vectors of coordinate-uniform figures with POD weights are kept "
+    "in memory-mapped temporary files, for numbers of points whose states do not fit in memory; "
+    "if the folder does not exist, it is created\n")
+    ("tvalue-cache", po::value<size_t>(),
+    "(optional) maximal number of projections whose t-values are kept in memory and reused by the "
+    "evaluations of the same generating matrices, for the projection-dependent t-value figures; disabled by default\n")
+    ("time-budget", po::value<Real>(),
+    "(optional) maximal wall-clock time in seconds of each run of a search; the search stops when it is elapsed "
+    "and returns the best net found so far; CBC explorations divide the remaining time evenly between the remaining coordinates; "
+    "the runs of --parallel-repeats share the budget\n")
+    ("eval-budget", po::value<unsigned long long>(),
+    "(optional) maximal number of nets evaluated by each run of a search; the search stops when it is reached "
+    "and returns the best net found so far; CBC explorations divide the remaining evaluations evenly between the remaining coordinates; "
+    "the runs of --parallel-repeats share the budget\n")
+    ("target-merit", po::value<Real>(),
+    "(optional) target merit value of the random, exhaustive and CBC explorations; the search stops as soon as "
+    "a net has a merit value below the target, and CBC explorations move on to the next coordinate as soon as a "
+    "candidate has a partial merit value below the target; the target also seeds the bound of the early abortion of the "
+    "evaluations, so that the search fails if no net has a merit value below the target\n")
+    ("partial-period", po::value<Real>()->default_value(60),
+    "(optional) with --time-budget or --eval-budget and --output-folder, number of seconds between two writes of the best net "
+    "found so far to partial.txt in the output folder (default: 60)\n")
+    ("progress", po::value<std::string>(),
+    "(optional) path to a file, named pipe or file descriptor (e.g. /dev/fd/3) where the progress of the search is written "
+    "as JSON lines (coordinate, candidates visited, evaluations, best merit value so far), at most every --progress-period seconds\n")
+    ("progress-period", po::value<Real>()->default_value(0.5),
+    "(optional) minimal number of seconds between two lines written to the file given by --progress (default: 0.5)\n")
+    ("profile", po::value<std::string>(),
+    "(optional) write the timers and the counters of the phases of the search (kernel setup, candidate construction, "
+    "evaluation, FFT, number of candidates, early aborts, rank operations) to profile.<format> in the output folder "
+    "at the end of the program; possible values:\n"
+    "  json\n"
+    "  csv\n"
+    "requires --output-folder\n")
+    ("trace", po::value<std::string>(),
+    "(optional) path to a file where a timeline of the phases of the search (task setup, coordinates, batches of "
+    "candidates, projection evaluations, parallel loops of each worker, output) is written at the end of the program, "
+    "in the trace-event format of Chrome (chrome://tracing, Perfetto)\n");
 
    return desc;
 }
 
 
 boost::program_options::variables_map
-parse(int argc, const char* argv[])
+parseOptions(int argc, const char* argv[])
 {
    namespace po = boost::program_options;
 
@@ -149,7 +300,7 @@ parse(int argc, const char* argv[])
 
    if (opt.count("help")) {
       std::cout << desc << std::endl;
-      std::exit (0);
+      return opt;
    }
 
    if (opt.count("weights") < 1)
@@ -162,53 +313,160 @@ parse(int argc, const char* argv[])
     if (opt["multilevel"].as<std::string>() == "true" && ! opt.count("combiner")){
       throw std::runtime_error("--combiner must be specified for multilevel set type (try --help)");
     }
+
+    if (opt["resume"].as<bool>() && opt.count("output-folder") < 1){
+      throw std::runtime_error("--resume requires --output-folder (try --help)");
+    }
+
+    if (opt["save-state"].as<bool>() && opt.count("output-folder") < 1){
+      throw std::runtime_error("--save-state requires --output-folder (try --help)");
+    }
+
+    if (opt.count("resume-state") >= 1 && opt["resume"].as<bool>()){
+      throw std::runtime_error("--resume-state cannot be used with --resume (try --help)");
+    }
+
+    if (opt.count("tvalue-profile") >= 1 && opt.count("output-folder") < 1){
+      throw std::runtime_error("--tvalue-profile requires --output-folder (try --help)");
+    }
+
+    if (opt.count("tvalue-profile") >= 1 && opt["tvalue-profile"].as<unsigned int>() == 0){
+      throw std::runtime_error("--tvalue-profile must be positive (try --help)");
+    }
+
+    if (opt["output-binary"].as<bool>() && opt.count("output-folder") < 1){
+      throw std::runtime_error("--output-binary requires --output-folder (try --help)");
+    }
+
+    if (opt["parallel-repeats"].as<bool>() && opt["resume"].as<bool>()){
+      throw std::runtime_error("--parallel-repeats cannot be used with --resume (try --help)");
+    }
+
+    if (opt["parallel-repeats"].as<bool>() && opt["save-state"].as<bool>()){
+      throw std::runtime_error("--parallel-repeats cannot be used with --save-state (try --help)");
+    }
+
+    if (opt.count("shard") >= 1){
+      if (opt.count("output-folder") < 1){
+        throw std::runtime_error("--shard requires --output-folder (try --help)");
+      }
+      const std::string method = opt["exploration-method"].as<std::string>();
+      const std::string name = method.substr(0, method.find(':'));
+      if (name != "exhaustive" && name != "random" && name != "full-CBC" && name != "random-CBC" && name != "mixed-CBC"){
+        throw std::runtime_error("--shard requires an exhaustive, random, full-CBC, random-CBC or mixed-CBC exploration (try --help)");
+      }
+      if (opt["repeat"].as<unsigned int>() > 1 || opt["parallel-repeats"].as<bool>()){
+        throw std::runtime_error("--shard cannot be used with --repeat or --parallel-repeats (try --help)");
+      }
+      if (opt["resume"].as<bool>() || opt.count("resume-state") >= 1 || opt["save-state"].as<bool>()){
+        throw std::runtime_error("--shard cannot be used with --resume, --resume-state or --save-state (try --help)");
+      }
+    }
+
+    if (opt.count("base-net") >= 1 && (opt["resume"].as<bool>() || opt.count("resume-state") >= 1)){
+      throw std::runtime_error("--base-net cannot be used with --resume or --resume-state (try --help)");
+    }
+
+    if (opt.count("result-cache") >= 1){
+      if (opt.count("shard") >= 1 || opt.count("base-net") >= 1){
+        throw std::runtime_error("--result-cache cannot be used with --shard or --base-net (try --help)");
+      }
+      if (opt["repeat"].as<unsigned int>() > 1 || opt["parallel-repeats"].as<bool>()){
+        throw std::runtime_error("--result-cache cannot be used with --repeat or --parallel-repeats (try --help)");
+      }
+      if (opt.count("time-budget") >= 1 || opt.count("eval-budget") >= 1){
+        throw std::runtime_error("--result-cache cannot be used with --time-budget or --eval-budget (try --help)");
+      }
+      if (opt["resume"].as<bool>() || opt.count("resume-state") >= 1 || opt["save-state"].as<bool>()){
+        throw std::runtime_error("--result-cache cannot be used with --resume, --resume-state or --save-state (try --help)");
+      }
+      if (opt["exploration-method"].as<std::string>().compare(0, 16, "evaluation-batch") == 0){
+        throw std::runtime_error("--result-cache cannot be used with the evaluation-batch exploration (try --help)");
+      }
+    }
+
+    if (opt.count("time-budget") >= 1 && !(opt["time-budget"].as<Real>() > 0)){
+      throw std::runtime_error("--time-budget must be positive (try --help)");
+    }
+
+    if (opt.count("eval-budget") >= 1 && opt["eval-budget"].as<unsigned long long>() == 0){
+      throw std::runtime_error("--eval-budget must be positive (try --help)");
+    }
+
+    if (opt.count("target-merit") >= 1 && std::isnan(opt["target-merit"].as<Real>())){
+      throw std::runtime_error("--target-merit must be a number (try --help)");
+    }
+
+    if (!(opt["progress-period"].as<Real>() > 0)){
+      throw std::runtime_error("--progress-period must be positive (try --help)");
+    }
+
+    if (opt.count("profile") >= 1){
+      if (opt.count("output-folder") < 1){
+        throw std::runtime_error("--profile requires --output-folder (try --help)");
+      }
+      const auto format = opt["profile"].as<std::string>();
+      if (format != "json" && format != "csv"){
+        throw std::runtime_error("--profile must be json or csv (try --help)");
+      }
+    }
    return opt;
 }
 
 
-#define BUILD_TASK(net_construction, point_set_type)\
-NetBuilder::Parser::CommandLine<NetBuilder::NetConstruction::net_construction, NetBuilder::EmbeddingType::point_set_type> cmd;\
-\
-cmd.s_verbose = opt["verbose"].as<std::string>();\
-cmd.s_explorationMethod = opt["exploration-method"].as<std::string>();\
-cmd.s_size = opt["size-parameter"].as<std::string>();\
-cmd.s_dimension = opt["dimension"].as<std::string>();\
-cmd.s_figure = opt["figure-of-merit"].as<std::string>();\
-cmd.s_weights       = opt["weights"].as<std::vector<std::string>>();\
-cmd.m_normType = boost::lexical_cast<Real>(opt["norm-type"].as<std::string>());\
-cmd.m_interlacingFactor = opt["interlacing-factor"].as<unsigned int>(); \
-interlacingFactor = cmd.m_interlacingFactor;\
-if (opt.count("combiner") < 1){\
-  cmd.s_combiner = "";\
-}\
-else{\
-  cmd.s_combiner = opt["combiner"].as<std::string>();\
-}\
-if (opt.count("weight-power") == 1 ){\
-  cmd.m_weightPower = boost::lexical_cast<Real>(opt["weight-power"].as<std::string>());\
-}\
-else{\
-  if (cmd.m_normType < std::numeric_limits<Real>::infinity())\
-  {\
-    cmd.m_weightPower = cmd.m_normType;\
-  }\
-  else\
-  {\
-    cmd.m_weightPower = 1;\
-  }\
-}\
-task = cmd.parse();\
-outputStyle = NetBuilder::Parser::OutputStyleParser<NetBuilder::NetConstruction::net_construction>::parse(s_outputStyle);
-
-
-void TaskOutput(const Task::Task &task, std::string outputFolder, OutputStyle outputStyle, unsigned int interlacingFactor, std::vector<std::string> inputCL)
+void applySettings(const boost::program_options::variables_map& opt)
+{
+    const auto value = [&opt](const char* name) { return opt.count(name) >= 1 ? opt[name].as<std::string>() : std::string(); };
+
+    LatBuilder::ThreadPool::setPinning(opt["pin-threads"].as<bool>());
+    LatBuilder::ThreadPool::setGlobalSize(opt["threads"].as<unsigned int>());
+
+    LatBuilder::Kernel::ValueCache::setDirectory(value("kernel-cache"));
+    LatBuilder::StateMatrix::setDirectory(value("state-folder"));
+    TValueCache::setCapacity(opt.count("tvalue-cache") >= 1 ? opt["tvalue-cache"].as<size_t>() : 0);
+
+    // settings of the lattice searches, which have no option here
+    LatBuilder::Kernel::OnTheFly::setEnabled(false);
+    LatBuilder::Norm::BoundCache::setFile("");
+    fftw<Real>::set_planner_flags(FFTW_ESTIMATE);
+    LatBuilder::NTTConvolution::setEnabled(false);
+    LatBuilder::WeightedProjections::setCutoff(0);
+
+    LatBuilder::Budget::clear();
+    if (opt.count("time-budget") >= 1 || opt.count("eval-budget") >= 1){
+        LatBuilder::Budget::set(
+            opt.count("time-budget") >= 1 ? opt["time-budget"].as<Real>() : std::numeric_limits<Real>::infinity(),
+            opt.count("eval-budget") >= 1 ? opt["eval-budget"].as<unsigned long long>() : 0);
+    }
+    if (opt.count("target-merit") >= 1){
+        LatBuilder::Budget::setTarget(opt["target-merit"].as<Real>());
+    }
+
+    LatBuilder::Shard::clear();
+    if (opt.count("shard") >= 1){
+        LatBuilder::Shard::parse(opt["shard"].as<std::string>());
+    }
+}
+
+
+void TaskOutput(const Task::Task &task, std::string outputFolder, OutputStyle outputStyle, unsigned int interlacingFactor, std::vector<std::string> inputCL, bool outputBinary, double elapsed)
 {
   unsigned int old_precision = (unsigned int)std::cout.precision();
   if (merit_digits_displayed){
     std::cout.precision(merit_digits_displayed);
   }
   std::cout << "====================\n       Result\n====================" << std::endl;
-  std::cout << task.outputNet(OutputStyle::TERMINAL, interlacingFactor) << "Merit: " << task.outputMeritValue() << std::endl;
+  task.resultNet().format(std::cout, OutputStyle::TERMINAL, interlacingFactor);
+  std::cout << "Merit: " << task.outputMeritValue() << std::endl;
+  if (!std::isinf(LatBuilder::Budget::target()) && !(task.outputMeritValue() < LatBuilder::Budget::target())){
+    std::cout << "Target merit " << LatBuilder::Budget::target() << " not reached" << std::endl;
+  }
+  const std::vector<Real> meritValues = task.outputMeritValues();
+  if (meritValues.size() > 1){
+    for (size_t i = 0; i < meritValues.size(); i++){
+      std::cout << "Merit of figure " << i + 1 << ": " << meritValues[i] << std::endl;
+    }
+  }
 
   if (outputFolder != ""){
     std::ofstream outFile;
@@ -216,8 +474,22 @@ void TaskOutput(const Task::Task &task, std::string outputFolder, OutputStyle ou
     outFile.open(fileName);
     outFile << "# Input Command Line: " << boost::algorithm::join(inputCL, " ") << std::endl;
     outFile << "# Merit: " << task.outputMeritValue() << std::endl;
-    outFile << task.outputNet(outputStyle, interlacingFactor);
+    if (meritValues.size() > 1){
+      for (size_t i = 0; i < meritValues.size(); i++){
+        outFile << "# Merit of figure " << i + 1 << ": " << meritValues[i] << std::endl;
+      }
+    }
+    task.resultNet().format(outFile, outputStyle, interlacingFactor);
     outFile.close();
+
+    if (outputBinary){
+      std::string binaryFileName = outputFolder + "/output.bin";
+      std::ofstream binaryFile(binaryFileName, std::ios::binary);
+      if (!binaryFile){
+        throw std::runtime_error("cannot open " + binaryFileName);
+      }
+      BinaryOutput::write(binaryFile, task.resultNet(), task.outputMeritValue(), elapsed, interlacingFactor, boost::algorithm::join(inputCL, " "));
+    }
   }
   
   if (merit_digits_displayed){
@@ -225,24 +497,89 @@ void TaskOutput(const Task::Task &task, std::string outputFolder, OutputStyle ou
   }
 }
 
+void PointsOutput(const Task::Task &task, const std::string& fileName, LatBuilder::PointFormat format, unsigned int interlacingFactor,
+                  Scrambling scrambling, uint64_t seed, unsigned int replicates)
+{
+  std::ofstream outFile(fileName, std::ios::binary);
+  if (!outFile){
+    throw std::runtime_error("cannot open " + fileName);
+  }
+  for (unsigned int r = 0; r < (scrambling == Scrambling::NONE ? 1 : replicates); r++){
+    LatBuilder::writePoints(DigitalNetPointGenerator(task.resultNet(), interlacingFactor, scrambling, seed, r), outFile, format);
+  }
+  std::cout << "Points written to: " << fileName << std::endl;
+}
 
-int main(int argc, const char *argv[])
+
+std::unique_ptr<Task::Task> makeTask(const boost::program_options::variables_map& opt, const std::string& outputFolder, unsigned int& interlacingFactor, OutputStyle& outputStyle)
 {
+        LatBuilder::Trace::Span span("task-setup", "task");
+        std::string s_multilevel = opt["multilevel"].as<std::string>();
+        std::string s_construction = opt["construction"].as<std::string>();
 
-   try {
+        NetBuilder::EmbeddingType embeddingType = NetBuilder::Parser::EmbeddingTypeParser::parse(s_multilevel);
+
+        NetBuilder::NetConstruction netConstruction;
+
+        if (embeddingType==NetBuilder::EmbeddingType::UNILEVEL)
+        {
+          netConstruction =  NetBuilder::Parser::NetConstructionParser<NetBuilder::EmbeddingType::UNILEVEL>::parse(s_construction);
+        }
+        else
+        {
+          netConstruction =  NetBuilder::Parser::NetConstructionParser<NetBuilder::EmbeddingType::MULTILEVEL>::parse(s_construction);
+        }
+
+        std::unique_ptr<NetBuilder::Task::Task> task;
+
+       // the tasks of each net construction are parsed by its module
+       if(netConstruction == NetBuilder::NetConstruction::SOBOL){
+          LATNETBUILDER_MODULE_ENTRY("net-sobol", netbuilder_make_task_sobol)(opt, outputFolder, interlacingFactor, outputStyle, task);
+       }
+       else if(netConstruction == NetBuilder::NetConstruction::POLYNOMIAL){
+          LATNETBUILDER_MODULE_ENTRY("net-polynomial", netbuilder_make_task_polynomial)(opt, outputFolder, interlacingFactor, outputStyle, task);
+       }
+       else if(netConstruction == NetBuilder::NetConstruction::EXPLICIT){
+          LATNETBUILDER_MODULE_ENTRY("net-explicit", netbuilder_make_task_explicit)(opt, outputFolder, interlacingFactor, outputStyle, task);
+       }
+       else if(netConstruction == NetBuilder::NetConstruction::LMS){
+          LATNETBUILDER_MODULE_ENTRY("net-lms", netbuilder_make_task_lms)(opt, outputFolder, interlacingFactor, outputStyle, task);
+       }
+       else {
+         throw std::runtime_error("Unknown combination of NetConstruction and EmbeddingType");
+       }
+
+       return task;
+}
+
+
+/// Runs the command and lets the exceptions propagate.
+int run(int argc, const char *argv[])
+{
      using namespace std::chrono;
      const std::string separator = "\n--------------------------------------------------------------------------------\n";
 
 
-        auto opt = parse(argc, argv);
+        auto opt = parseOptions(argc, argv);
+        if (opt.count("help"))
+          return 0;
 
         auto repeat = opt["repeat"].as<unsigned int>();
 
+        bool parallelRepeats = opt["parallel-repeats"].as<bool>();
+        bool outputBinary = opt["output-binary"].as<bool>();
+        if (parallelRepeats && LatBuilder::Distributed::size() > 1){
+          throw std::runtime_error("--parallel-repeats cannot be used in an MPI job");
+        }
+        if (opt.count("result-cache") >= 1 && LatBuilder::Distributed::size() > 1){
+          throw std::runtime_error("--result-cache cannot be used in an MPI job");
+        }
+
         std::string outputFolder = "";
         if (opt.count("output-folder") >= 1){
           outputFolder = opt["output-folder"].as<std::string>();
           std::cout << "Writing in output folder: " << outputFolder << std::endl;
-          if (! boost::filesystem::is_directory(outputFolder)){
+          if (LatBuilder::Distributed::isRoot() && ! boost::filesystem::is_directory(outputFolder)){
             boost::filesystem::create_directories(outputFolder);
           }
         }
@@ -250,60 +587,60 @@ int main(int argc, const char *argv[])
         // global variable
         merit_digits_displayed = opt["merit-digits-displayed"].as<unsigned int>();
 
-        std::string s_multilevel = opt["multilevel"].as<std::string>();
-        std::string s_construction = opt["construction"].as<std::string>();
-        std::string s_outputStyle = opt["output-style"].as<std::string>();
-        NetBuilder::EmbeddingType embeddingType = NetBuilder::Parser::EmbeddingTypeParser::parse(s_multilevel);
-
-        NetBuilder::NetConstruction netConstruction;
+        applySettings(opt);
 
-        if (embeddingType==NetBuilder::EmbeddingType::UNILEVEL)
-        {
-          netConstruction =  NetBuilder::Parser::NetConstructionParser<NetBuilder::EmbeddingType::UNILEVEL>::parse(s_construction);
+        std::string profileFile = "";
+        if (opt.count("profile") >= 1){
+          profileFile = outputFolder + "/profile." + opt["profile"].as<std::string>();
         }
-        else
-        {
-          netConstruction =  NetBuilder::Parser::NetConstructionParser<NetBuilder::EmbeddingType::MULTILEVEL>::parse(s_construction);
+        LatBuilder::Profiler::reset();
+        LatBuilder::Profiler::setEnabled(profileFile != "");
+
+        // in an MPI job, only the root process writes the trace
+        const std::string traceFile = opt.count("trace") >= 1 && LatBuilder::Distributed::isRoot() ? opt["trace"].as<std::string>() : "";
+        if (traceFile != ""){
+          LatBuilder::Trace::setThreadName("main");
+          LatBuilder::Trace::start();
         }
 
+        std::string outputPoints = "";
+        if (opt.count("output-points") >= 1){
+          outputPoints = opt["output-points"].as<std::string>();
+        }
+        LatBuilder::PointFormat pointFormat = LatBuilder::Parser::PointFormat::parse(opt["output-points-format"].as<std::string>());
+        Scrambling pointScrambling = NetBuilder::Parser::ScramblingParser::parse(opt["output-points-scrambling"].as<std::string>());
+        const uint64_t pointSeed = opt["output-points-seed"].as<unsigned long long>();
+        const unsigned int pointReplicates = opt["output-points-replicates"].as<unsigned int>();
+
         std::chrono::time_point<std::chrono::high_resolution_clock> t0, t1;
         unsigned int interlacingFactor = 0;
-      
-        std::unique_ptr<NetBuilder::Task::Task> task;
         NetBuilder::OutputStyle outputStyle;
-
-       if(netConstruction == NetBuilder::NetConstruction::SOBOL && embeddingType == NetBuilder::EmbeddingType::UNILEVEL){
-          BUILD_TASK(SOBOL, UNILEVEL)
-       }
-       else if(netConstruction == NetBuilder::NetConstruction::SOBOL && embeddingType == NetBuilder::EmbeddingType::MULTILEVEL){
-          BUILD_TASK(SOBOL, MULTILEVEL)
-       }
-       else if(netConstruction == NetBuilder::NetConstruction::POLYNOMIAL && embeddingType == NetBuilder::EmbeddingType::UNILEVEL){
-          BUILD_TASK(POLYNOMIAL, UNILEVEL)
-       }
-       else if(netConstruction == NetBuilder::NetConstruction::EXPLICIT && embeddingType == NetBuilder::EmbeddingType::UNILEVEL){
-          BUILD_TASK(EXPLICIT, UNILEVEL)
-       }
-       else if(netConstruction == NetBuilder::NetConstruction::EXPLICIT && embeddingType == NetBuilder::EmbeddingType::MULTILEVEL){
-          BUILD_TASK(EXPLICIT, MULTILEVEL)
-       }
-       else if(netConstruction == NetBuilder::NetConstruction::LMS && embeddingType == NetBuilder::EmbeddingType::UNILEVEL){
-          BUILD_TASK(LMS, UNILEVEL)
-       }
-       else if(netConstruction == NetBuilder::NetConstruction::LMS && embeddingType == NetBuilder::EmbeddingType::MULTILEVEL){
-          BUILD_TASK(LMS, MULTILEVEL)
-       }
-       else {
-         throw std::runtime_error("Unknown combination of NetConstruction and EmbeddingType");
-       }
+        auto task = makeTask(opt, outputFolder, interlacingFactor, outputStyle);
+        if (outputFolder != "" && LatBuilder::Budget::limited()){
+          task->setPartialResultFile(outputFolder + "/partial.txt", outputStyle, interlacingFactor, opt["partial-period"].as<Real>());
+        }
 
       std::vector<std::string> inputCL;
       if (argc > 1) {
         inputCL.assign(argv + 1, argv + argc);
       }
 
+      // in an MPI job, only the root process writes the outputs
+      if (!LatBuilder::Distributed::isRoot()){
+        outputFolder = "";
+        outputPoints = "";
+      }
+
+      std::string progressFile = "";
+      if (opt.count("progress") >= 1 && LatBuilder::Distributed::isRoot()){
+        progressFile = opt["progress"].as<std::string>();
+      }
+      LatBuilder::ProgressFeed::Session progress(progressFile, opt["progress-period"].as<Real>());
+
 
-      for (unsigned i=0; i<repeat; i++){
+      // the parallel runs are executed at once and reported as a single one
+      const unsigned int numLoops = parallelRepeats ? 1 : repeat;
+      for (unsigned i=0; i<numLoops; i++){
         if (i == 0){
           std::cout << "====================\n       Input\n====================" << std::endl;
           std::cout << task->format();
@@ -319,24 +656,89 @@ int main(int argc, const char *argv[])
           }
         }
 
-          if (repeat > 1){
+          if (numLoops > 1){
             std::cout << "====================\n       Run " << i+1 << "\n====================" << std::endl;
           }
+          else if (parallelRepeats){
+            std::cout << "====================\nRunning " << repeat << " runs of the task... \n====================" << std::endl;
+          }
           else{
             std::cout << "====================\nRunning the task... \n====================" << std::endl;
           }
 
+          const std::string shardFile = LatBuilder::Shard::active() && outputFolder != "" ? outputFolder + "/shard.txt" : "";
+          if (shardFile != ""){
+            boost::filesystem::remove(shardFile); // written when the search selects a net
+          }
+
           t0 = high_resolution_clock::now();
-          task->execute();
+          LatBuilder::Budget::restart(); // each run has the whole budget
+          {
+            LatBuilder::Trace::Span span("execute", "task");
+            if (parallelRepeats){
+              // the first task was constructed with the default seed, that is, stream 0
+              LatBuilder::ParallelRepeats repeats(repeat);
+              task = repeats.execute<Task::Task>(
+                  [&](unsigned int run)
+                  {
+                    unsigned int runInterlacingFactor;
+                    OutputStyle runOutputStyle;
+                    auto runTask = run == 0 ? std::move(task) : makeTask(opt, "", runInterlacingFactor, runOutputStyle);
+                    runTask->execute();
+                    return runTask;
+                  },
+                  [](const Task::Task& runTask) { return runTask.outputMeritValue(); });
+              std::cout << "====================\n       Summary\n====================" << std::endl << repeats << std::endl;
+            }
+            else{
+              task->execute();
+            }
+          }
           t1 = high_resolution_clock::now();
           auto dt = duration_cast<duration<double>>(t1 - t0);
 
+          if (shardFile != "" && !boost::filesystem::exists(shardFile)){
+            // the range of the shard had no candidate, or none was accepted
+            LatBuilder::Shard::Result empty;
+            empty.index = LatBuilder::Shard::index();
+            empty.count = LatBuilder::Shard::count();
+            empty.merit = std::numeric_limits<Real>::infinity();
+            empty.write(shardFile);
+            std::cout << "The shard has no candidate" << std::endl;
+            continue;
+          }
+
           std::cout << std::endl;
-          TaskOutput(*task, outputFolder, outputStyle, interlacingFactor, inputCL);
+          {
+            LatBuilder::Trace::Span span("output", "task");
+            TaskOutput(*task, outputFolder, outputStyle, interlacingFactor, inputCL, outputBinary, dt.count());
+            if (outputPoints != "" && i == numLoops - 1){
+              PointsOutput(*task, outputPoints, pointFormat, interlacingFactor, pointScrambling, pointSeed, pointReplicates);
+            }
+          }
           std::cout << std::endl;
           std::cout << "ELAPSED CPU TIME: " << dt.count() << " seconds" << std::endl;
           task->reset();
       }
+
+      LatBuilder::Profiler::setEnabled(false);
+      if (profileFile != "" && LatBuilder::Distributed::isRoot()){
+        LatBuilder::Profiler::write(profileFile);
+        std::cout << "Profile written to: " << profileFile << std::endl;
+      }
+      if (traceFile != ""){
+        LatBuilder::Trace::stop();
+        LatBuilder::Trace::write(traceFile);
+        std::cout << "Trace written to: " << traceFile << std::endl;
+      }
+
+   return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+   try {
+      return run(argc, argv);
    }
    catch (LatBuilder::Parser::ParserError& e) {
       std::cerr << "COMMAND LINE ERROR: " << e.what() << std::endl;